@@ -1,11 +1,15 @@
 import React from 'react';
 import BenchChart from './BenchChart';
+import LiveStats from './LiveStats';
+
+// ?live=ws://127.0.0.1:9464/ opens the live view on a server's metrics.stream.
+const liveUrl = new URLSearchParams(window.location.search).get('live');
 
 function App() {
   return (
     <div style={{padding: 40}}>
       <h2>QWormhole Slice Sweep Dashboard</h2>
-      <BenchChart />
+      {liveUrl ? <LiveStats initialUrl={liveUrl} /> : <BenchChart />}
     </div>
   );
 }
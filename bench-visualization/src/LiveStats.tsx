@@ -0,0 +1,154 @@
+import { useEffect, useRef, useState } from 'react';
+import Plot from 'react-plotly.js';
+import {
+  openNativeStatsStream,
+  type NativeStatsFrame,
+} from '../../src/core/native-stats-stream';
+
+/** Seconds of history kept on screen. */
+const WINDOW_S = 30;
+const TOP_CONNECTIONS = 10;
+
+interface LivePoint {
+  t: number;
+  framesPerSec: number;
+  mbPerSec: number;
+  writesPerSec: number;
+  framesPerWrite: number;
+  queuedKiB: number;
+  tsfnPending: number;
+  serviceLagUs: number;
+  connections: number;
+}
+
+/** Rates between two frames; gauges as of the later one. */
+function toPoint(prev: NativeStatsFrame, next: NativeStatsFrame): LivePoint {
+  const dt = Math.max(next.atMs - prev.atMs, 1) / 1000;
+  const rate = (field: string) => (next.global[field] - prev.global[field]) / dt;
+  const frames = next.global.framesWritten - prev.global.framesWritten;
+  const writes = next.global.writeCalls - prev.global.writeCalls;
+  return {
+    t: next.atMs,
+    framesPerSec: rate('framesWritten'),
+    mbPerSec: rate('bytesWritten') / 1e6,
+    writesPerSec: rate('writeCalls'),
+    framesPerWrite: writes > 0 ? frames / writes : 0,
+    queuedKiB: next.global.queuedBytes / 1024,
+    tsfnPending: next.global.tsfnPending,
+    serviceLagUs: next.global.serviceLagNs / 1000,
+    connections: next.global.connections,
+  };
+}
+
+/**
+ * Live mode: subscribes to a native server's metrics.stream and plots
+ * throughput, write coalescing and queue depths while you retune
+ * QWORMHOLE_LWS_MAX_WRITES, QWORMHOLE_LWS_PT_SERV_BUF or flow modes.
+ */
+export default function LiveStats({ initialUrl }: { initialUrl: string }) {
+  const [url, setUrl] = useState(initialUrl);
+  const [status, setStatus] = useState('connecting');
+  const [points, setPoints] = useState<LivePoint[]>([]);
+  const [latest, setLatest] = useState<NativeStatsFrame>();
+  const prev = useRef<NativeStatsFrame | undefined>(undefined);
+
+  useEffect(() => {
+    prev.current = undefined;
+    setPoints([]);
+    setStatus('connecting');
+    const socket = openNativeStatsStream(url, frame => {
+      const before = prev.current;
+      prev.current = frame;
+      setLatest(frame);
+      if (!before) return;
+      const point = toPoint(before, frame);
+      setPoints(all => [...all.filter(p => p.t >= point.t - WINDOW_S * 1000), point]);
+    });
+    socket.addEventListener('open', () => setStatus('live'));
+    socket.addEventListener('close', () => setStatus('closed'));
+    socket.addEventListener('error', () => setStatus('error'));
+    return () => socket.close();
+  }, [url]);
+
+  const x = points.map(p => new Date(p.t));
+  const line = (y: number[], name: string, color: string, yaxis = 'y1') => ({
+    x, y, name, type: 'scatter' as const, mode: 'lines' as const, line: { color, width: 2 }, yaxis,
+  });
+  const top = latest
+    ? [...latest.connections]
+        .sort(([, a], [, b]) => b.queuedBytes - a.queuedBytes)
+        .slice(0, TOP_CONNECTIONS)
+    : [];
+
+  return (
+    <div style={{ background: '#f8fafc', borderRadius: 12, padding: 32, boxShadow: '0 2px 16px #0001', maxWidth: 1100, margin: '32px auto', color: '#1e293b' }}>
+      <h2 style={{ fontWeight: 700, fontSize: 28, marginBottom: 8 }}>Live native stats</h2>
+      <form
+        onSubmit={e => {
+          e.preventDefault();
+          setUrl(String(new FormData(e.currentTarget).get('url')));
+        }}
+        style={{ display: 'flex', gap: 8, marginBottom: 16 }}
+      >
+        <input name="url" defaultValue={url} style={{ flex: 1, padding: 6, color: '#1e293b' }} />
+        <button type="submit">Connect</button>
+        <span style={{ alignSelf: 'center', color: status === 'live' ? '#059669' : '#f43f5e' }}>{status}</span>
+      </form>
+      <Plot
+        data={[
+          line(points.map(p => p.framesPerSec), 'Frames/s', '#2563eb'),
+          line(points.map(p => p.writesPerSec), 'Writes/s', '#059669'),
+          line(points.map(p => p.mbPerSec), 'MB/s', '#a21caf', 'y2'),
+          line(points.map(p => p.framesPerWrite), 'Frames/write', '#f59e42', 'y2'),
+        ]}
+        layout={{
+          xaxis: { type: 'date' },
+          yaxis: { title: 'per second' },
+          yaxis2: { title: 'MB/s, frames/write', overlaying: 'y', side: 'right', showgrid: false },
+          legend: { orientation: 'h', y: 1.15 },
+          margin: { t: 24, l: 60, r: 60, b: 40 },
+          plot_bgcolor: '#f8fafc',
+          paper_bgcolor: '#f8fafc',
+        }}
+        style={{ width: '100%', height: '360px' }}
+        config={{ responsive: true }}
+      />
+      <Plot
+        data={[
+          line(points.map(p => p.queuedKiB), 'Queued KiB', '#f43f5e'),
+          line(points.map(p => p.tsfnPending), 'TSFN pending', '#6366f1'),
+          line(points.map(p => p.serviceLagUs), 'Service lag µs', '#eab308', 'y2'),
+        ]}
+        layout={{
+          xaxis: { type: 'date' },
+          yaxis: { title: 'queued' },
+          yaxis2: { title: 'µs', overlaying: 'y', side: 'right', showgrid: false },
+          legend: { orientation: 'h', y: 1.15 },
+          margin: { t: 24, l: 60, r: 60, b: 40 },
+          plot_bgcolor: '#f8fafc',
+          paper_bgcolor: '#f8fafc',
+        }}
+        style={{ width: '100%', height: '300px' }}
+        config={{ responsive: true }}
+      />
+      <div style={{ marginTop: 16 }}>
+        <b>{latest?.global.connections ?? 0} connections</b>; top {TOP_CONNECTIONS} by queued bytes:
+        <table style={{ width: '100%', marginTop: 8, fontSize: 14, textAlign: 'right' }}>
+          <thead>
+            <tr>
+              <th>handle</th><th>queued</th><th>sent</th><th>received</th><th>frames sent</th><th>expired</th><th>memory</th>
+            </tr>
+          </thead>
+          <tbody>
+            {top.map(([handle, c]) => (
+              <tr key={handle}>
+                <td>{handle}</td><td>{c.queuedBytes}</td><td>{c.bytesSent}</td><td>{c.bytesReceived}</td>
+                <td>{c.framesSent}</td><td>{c.framesExpired}</td><td>{c.memoryBytes}</td>
+              </tr>
+            ))}
+          </tbody>
+        </table>
+      </div>
+    </div>
+  );
+}
@@ -1,5 +1,7 @@
 // Auto-generated index for src
 export * from './App';
 export * from './BenchChart';
+export * from './LiveStats';
 export * from './main';
+export * from './trace';
 // export * from './react-plotly.js.d';
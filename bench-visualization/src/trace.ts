@@ -0,0 +1,34 @@
+import {
+  readTelemetryTrace,
+  type TelemetryTrace,
+  type TraceSchemaName,
+} from '../../src/telemetry/trace-format';
+
+/**
+ * A .qwtrace capture (bench QWORMHOLE_BENCH_TRACE, or a coherence
+ * pipeline's tracePath) as column views; no JSON parsing.
+ */
+export async function fetchTelemetryTrace(url: string): Promise<TelemetryTrace> {
+  const res = await fetch(url);
+  if (!res.ok) throw new Error(`trace fetch failed: ${res.status}`);
+  return readTelemetryTrace(await res.arrayBuffer());
+}
+
+/**
+ * One column per scenario label, for plotting: benchScenario by default,
+ * or benchLatency for the p50..max message latency of rate-driven runs.
+ */
+export function scenarioSeries(
+  trace: TelemetryTrace,
+  column: string,
+  schema: TraceSchemaName = 'benchScenario',
+): Map<string, number[]> {
+  const series = new Map<string, number[]>();
+  for (const block of trace.blocks) {
+    if (block.schema !== schema || !block.columns[column]) continue;
+    const values = series.get(block.label) ?? [];
+    values.push(...block.columns[column]);
+    series.set(block.label, values);
+  }
+  return series;
+}
@@ -1,4 +1,45 @@
 {
+  "variables": {
+    "qwormhole_combined%": "<!(node -p \"process.env.QWORMHOLE_BUILD_COMBINED || '0'\")",
+    "qwormhole_opt%": "<!(node -p \"process.env.QWORMHOLE_NATIVE_OPT || 'default'\")",
+    "qwormhole_march%": "<!(node -p \"process.env.QWORMHOLE_NATIVE_MARCH || ''\")",
+    "qwormhole_profile_dir%": "<!(node -p \"process.env.QWORMHOLE_NATIVE_PROFILE_DIR || require('path').resolve('.pgo')\")"
+  },
+  "target_defaults": {
+    "conditions": [
+      [
+        "OS=='linux' and qwormhole_opt in ('lto', 'pgo-gen', 'pgo-use')",
+        {
+          "cflags": ["-O3", "-flto=auto", "-ffat-lto-objects"],
+          "ldflags": ["-O3", "-flto=auto"]
+        }
+      ],
+      [
+        "OS=='linux' and qwormhole_opt=='pgo-gen'",
+        {
+          "cflags": ["-fprofile-generate=<(qwormhole_profile_dir)", "-fprofile-update=atomic"],
+          "ldflags": ["-fprofile-generate=<(qwormhole_profile_dir)"]
+        }
+      ],
+      [
+        "OS=='linux' and qwormhole_opt=='pgo-use'",
+        {
+          "cflags": [
+            "-fprofile-use=<(qwormhole_profile_dir)",
+            "-fprofile-partial-training",
+            "-Wno-missing-profile"
+          ],
+          "ldflags": ["-fprofile-use=<(qwormhole_profile_dir)"]
+        }
+      ],
+      [
+        "OS=='linux' and qwormhole_march!=''",
+        {
+          "cflags": ["-march=<(qwormhole_march)"]
+        }
+      ]
+    ]
+  },
   "targets": [
     {
       "target_name": "libsocket_internal",
@@ -32,7 +73,8 @@
               "libsocket/C++/unixclientstream.cpp",
               "libsocket/C++/unixdgram.cpp",
               "libsocket/C++/unixserverdgram.cpp",
-              "libsocket/C++/unixserverstream.cpp"
+              "libsocket/C++/unixserverstream.cpp",
+              "libsocket/C++/uring.cpp"
             ],
             "include_dirs": [
               "<(module_root_dir)/libsocket/headers",
@@ -136,6 +178,81 @@
           }
         ]
       ]
+    },
+    {
+      "target_name": "qwormhole_native",
+      "conditions": [
+        [
+          "qwormhole_combined!=1",
+          {
+            "type": "none",
+            "sources": []
+          },
+          {
+            "sources": ["c/qwormhole_native.cpp", "c/qwormhole_lws.cpp"],
+            "include_dirs": [
+              "<!@(node -p \"require('node-addon-api').include\")",
+              "<(module_root_dir)/libwebsockets/build/include",
+              "<(module_root_dir)/libwebsockets/build",
+              "<(module_root_dir)/libwebsockets/include"
+            ],
+            "dependencies": [
+              "<!(node -p \"require('node-addon-api').gyp\")"
+            ],
+            "cflags_cc!": ["-fno-exceptions"],
+            "cflags!": ["-fno-exceptions"],
+            "defines": ["NAPI_CPP_EXCEPTIONS", "QWORMHOLE_COMBINED_ADDON"],
+            "cflags_cc": ["-std=c++17"],
+            "conditions": [
+              [
+                "OS=='win'",
+                {
+                  "libraries": [
+                    "<(module_root_dir)/libwebsockets/build/lib/Release/websockets_static.lib",
+                    "libssl.lib",
+                    "libcrypto.lib",
+                    "ws2_32.lib",
+                    "userenv.lib",
+                    "crypt32.lib",
+                    "shlwapi.lib",
+                    "advapi32.lib",
+                    "ole32.lib",
+                    "secur32.lib",
+                    "iphlpapi.lib",
+                    "gdi32.lib",
+                    "msvcrt.lib",
+                    "ucrt.lib",
+                    "vcruntime.lib"
+                  ],
+                  "msvs_settings": {
+                    "VCCLCompilerTool": {
+                      "ExceptionHandling": 1
+                    },
+                    "VCLinkerTool": {
+                      "AdditionalLibraryDirectories": [
+                        "<!(node -p \"process.env.OPENSSL_LIB_DIR || 'C:/Program Files/OpenSSL-Win64/lib/VC/x64/MD' \")"
+                      ]
+                    }
+                  }
+                },
+                {
+                  "sources": ["c/qwormhole.cpp"],
+                  "include_dirs": ["<(module_root_dir)/libsocket/headers"],
+                  "dependencies": ["libsocket_internal"],
+                  "libraries": [
+                    "<(PRODUCT_DIR)/socket_internal.a",
+                    "<(module_root_dir)/libwebsockets/build/lib/libwebsockets.a",
+                    "-lz",
+                    "-lssl",
+                    "-lcrypto",
+                    "-lpthread"
+                  ]
+                }
+              ]
+            ]
+          }
+        ]
+      ]
     }
   ]
 }
@@ -0,0 +1,800 @@
+// Open-loop load generator for a length-prefixed QWormhole server, built from
+// the lws addon source (make loadgen-native) and run without Node:
+//
+//   qwormhole_loadgen --port 9000 [--host 127.0.0.1] [--connections 64]
+//                     [--threads 4] [--rate 100000] [--size 256]
+//                     [--duration-ms 5000] [--warmup-ms 1000] [--mode echo|sink]
+//                     [--drain-ms 2000] [--label name] [--out file.jsonl]
+//                     [--active N] [--sources N] [--start now|stdin]
+//   qwormhole_loadgen --port 9443 --mode handshake [--handshakes 1000]
+//                     [--threads 4] [--tls-version 1.2|1.3] [--resume 0|1]
+//                     [--ca file.pem] [--servername localhost]
+//
+// Each thread owns connections/threads sockets and schedules its share of
+// --rate on a fixed timeline: message k is due at start + k / rate whether or
+// not earlier ones have gone out. Frames carry their due time, so in echo mode
+// a reply's latency is measured from when the message should have been sent
+// and a stalled server shows up as latency instead of a slower send loop
+// (coordinated omission). --rate 0 sends as fast as the sockets take it,
+// stamped with the actual send time. The result is one JSONL record with
+// latency percentiles and the HDR bucket counts behind them.
+//
+// For connection-scaling runs, --active limits sending to the first N
+// connections and leaves the rest idle, --sources spreads the connections
+// over that many loopback source addresses (127.0.0.2 upwards) so they do not
+// run out of ephemeral ports, and --start stdin connects everything, prints a
+// {"event":"connected"} line and holds the connections idle until a line
+// arrives on stdin. Frames whose sequence is all ones are server broadcasts
+// stamped with the MonotonicNs they were sent at; their arrival is recorded
+// as fan-out latency.
+//
+// --mode handshake measures TLS connection setup instead: each thread
+// connects, handshakes, sends one frame, reads its echo and closes, until
+// --handshakes have run across the threads. The record splits handshake time
+// (connect() to handshake done) into full and resumed handshakes, reports
+// time to first byte (connect() to the echo) and the generator's own CPU per
+// handshake. With --resume 1 a thread offers every connection the session its
+// previous one ended with, so the server resumes it from a ticket or its
+// session cache.
+#define QWORMHOLE_NATIVE_BENCH 1
+#include "../qwormhole_lws.cpp"
+
+#ifdef _WIN32
+#error "qwormhole_loadgen needs POSIX sockets"
+#endif
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/resource.h>
+#ifndef __linux__
+#include <netinet/tcp.h>  // linux/tcp.h already came in with the addon
+#endif
+
+#include <cinttypes>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+
+// Payload prefix: u64 due time (MonotonicNs), u64 sequence, little-endian.
+constexpr size_t kLoadgenStampBytes = 16;
+// Per-connection unsent bytes past which due messages are shed, not queued.
+constexpr size_t kLoadgenMaxBacklog = 16 * 1024 * 1024;
+// Sequence marking a stamped server broadcast rather than an echo.
+constexpr uint64_t kLoadgenBroadcastSeq = ~0ull;
+
+struct LoadgenOptions {
+  std::string host = "127.0.0.1";
+  std::string port;
+  size_t connections = 64;
+  size_t threads = 4;
+  double rate = 100000.0;
+  size_t size = 256;
+  double duration_ms = 5000.0;
+  double warmup_ms = 1000.0;
+  double drain_ms = 2000.0;
+  bool echo = true;
+  std::string label;
+  std::string out;
+  size_t active = 0;   // 0: every connection sends
+  size_t sources = 0;  // 0: let the kernel pick the source address
+  bool start_on_stdin = false;
+  bool handshake = false;
+  size_t handshakes = 1000;
+  std::string tls_version = "1.3";
+  bool resume = false;
+  std::string ca;
+  std::string servername = "localhost";
+};
+
+struct LoadgenTotals {
+  std::atomic<uint64_t> sent{0};
+  std::atomic<uint64_t> received{0};
+  std::atomic<uint64_t> bytes_sent{0};
+  std::atomic<uint64_t> bytes_received{0};
+  std::atomic<uint64_t> shed{0};
+  std::atomic<uint64_t> errors{0};
+  AtomicHistogram latency_ns;   // due time -> echo decoded
+  AtomicHistogram send_lag_ns;  // due time -> frame fully written
+  AtomicHistogram fanout_ns;    // broadcast stamp -> frame decoded
+};
+
+struct LoadgenConnection {
+  int fd = -1;
+  std::vector<uint8_t> out;
+  size_t out_offset = 0;
+  // Due times of frames in `out`, oldest first, with each frame's end offset.
+  std::deque<std::pair<uint64_t, size_t>> pending;
+  FrameAssembler assembler;
+  bool open = true;
+  bool active = true;
+};
+
+// Binds an IPv4 loopback socket to 127.0.0.(2 + index % sources) before it
+// connects. IP_BIND_ADDRESS_NO_PORT leaves the port to connect(), so each
+// source address gets the whole ephemeral range towards the one server.
+bool BindSource(int fd, const addrinfo* ai, const LoadgenOptions& options, size_t index) {
+  if (options.sources == 0 || ai->ai_family != AF_INET) return true;
+  const auto* remote = reinterpret_cast<const sockaddr_in*>(ai->ai_addr);
+  if ((ntohl(remote->sin_addr.s_addr) >> 24) != 127) return true;
+#ifdef IP_BIND_ADDRESS_NO_PORT
+  const int one = 1;
+  setsockopt(fd, IPPROTO_IP, IP_BIND_ADDRESS_NO_PORT, &one, sizeof(one));
+#endif
+  sockaddr_in local{};
+  local.sin_family = AF_INET;
+  local.sin_addr.s_addr = htonl(0x7f000002u + static_cast<uint32_t>(index % options.sources));
+  return bind(fd, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) == 0;
+}
+
+int Connect(const LoadgenOptions& options, size_t index, std::string* error) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* found = nullptr;
+  const int rc = getaddrinfo(options.host.c_str(), options.port.c_str(), &hints, &found);
+  if (rc != 0) {
+    *error = gai_strerror(rc);
+    return -1;
+  }
+  int fd = -1;
+  for (addrinfo* ai = found; ai; ai = ai->ai_next) {
+    fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0) continue;
+    if (BindSource(fd, ai, options, index) &&
+        connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+      break;
+    }
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(found);
+  if (fd < 0) {
+    *error = std::strerror(errno);
+    return -1;
+  }
+  const int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  return fd;
+}
+
+void AppendFrame(LoadgenConnection* conn, size_t size, uint64_t due, uint64_t seq) {
+  const size_t at = conn->out.size();
+  conn->out.resize(at + kFrameHeaderBytes + size);
+  uint8_t* frame = conn->out.data() + at;
+  const uint32_t len = static_cast<uint32_t>(size);
+  frame[0] = static_cast<uint8_t>(len >> 24);
+  frame[1] = static_cast<uint8_t>(len >> 16);
+  frame[2] = static_cast<uint8_t>(len >> 8);
+  frame[3] = static_cast<uint8_t>(len);
+  uint8_t* payload = frame + kFrameHeaderBytes;
+  for (int i = 0; i < 8; ++i) {
+    payload[i] = static_cast<uint8_t>(due >> (8 * i));
+    payload[8 + i] = static_cast<uint8_t>(seq >> (8 * i));
+  }
+  std::memset(payload + kLoadgenStampBytes, 'q', size - kLoadgenStampBytes);
+  conn->pending.emplace_back(due, conn->out.size());
+}
+
+uint64_t ReadStampWord(const std::vector<uint8_t>& frame, size_t at) {
+  uint64_t word = 0;
+  for (int i = 0; i < 8; ++i) {
+    word |= static_cast<uint64_t>(frame[at + i]) << (8 * i);
+  }
+  return word;
+}
+
+// Writes what the socket takes; frames that finish count as sent.
+void Flush(LoadgenConnection* conn, uint64_t record_from, LoadgenTotals* totals) {
+  while (conn->open && conn->out_offset < conn->out.size()) {
+    const ssize_t n = send(conn->fd, conn->out.data() + conn->out_offset,
+                           conn->out.size() - conn->out_offset, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) break;
+      conn->open = false;
+      totals->errors.fetch_add(1, std::memory_order_relaxed);
+      break;
+    }
+    conn->out_offset += static_cast<size_t>(n);
+    totals->bytes_sent.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+  }
+  const uint64_t now = MonotonicNs();
+  while (!conn->pending.empty() && conn->pending.front().second <= conn->out_offset) {
+    const uint64_t due = conn->pending.front().first;
+    if (due >= record_from) {
+      totals->send_lag_ns.Record(now > due ? now - due : 0);
+    }
+    totals->sent.fetch_add(1, std::memory_order_relaxed);
+    conn->pending.pop_front();
+  }
+  if (conn->out_offset == conn->out.size()) {
+    conn->out.clear();
+    conn->out_offset = 0;
+    conn->pending.clear();
+  } else if (conn->out_offset > (1 << 20)) {
+    conn->out.erase(conn->out.begin(), conn->out.begin() + conn->out_offset);
+    for (auto& entry : conn->pending) entry.second -= conn->out_offset;
+    conn->out_offset = 0;
+  }
+}
+
+void Receive(LoadgenConnection* conn, const LoadgenOptions& options, uint64_t record_from,
+             LoadgenTotals* totals) {
+  uint8_t chunk[64 * 1024];
+  while (conn->open) {
+    const ssize_t n = recv(conn->fd, chunk, sizeof(chunk), 0);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) break;
+    if (n <= 0) {
+      conn->open = false;
+      if (n < 0) totals->errors.fetch_add(1, std::memory_order_relaxed);
+      break;
+    }
+    totals->bytes_received.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+    const uint64_t now = MonotonicNs();
+    const FrameFeedResult result = conn->assembler.Feed(
+        chunk, static_cast<size_t>(n), kDefaultMaxFrameLength,
+        [&](std::vector<uint8_t> frame) {
+          if (frame.size() >= kLoadgenStampBytes &&
+              ReadStampWord(frame, 8) == kLoadgenBroadcastSeq) {
+            const uint64_t stamp = ReadStampWord(frame, 0);
+            totals->fanout_ns.Record(now > stamp ? now - stamp : 0);
+            return true;
+          }
+          if (frame.size() != options.size) return true;  // not one of ours
+          totals->received.fetch_add(1, std::memory_order_relaxed);
+          const uint64_t due = ReadStampWord(frame, 0);
+          if (due >= record_from) {
+            totals->latency_ns.Record(now > due ? now - due : 0);
+          }
+          return true;
+        });
+    if (result != FrameFeedResult::kOk) {
+      conn->open = false;
+      totals->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+// poll() with a nanosecond timeout where the platform has one: a 1 ms
+// granularity would delay every message due inside the next millisecond.
+int WaitReady(std::vector<pollfd>* fds, uint64_t timeout_ns) {
+#ifdef __linux__
+  timespec ts{static_cast<time_t>(timeout_ns / 1000000000),
+              static_cast<long>(timeout_ns % 1000000000)};
+  return ppoll(fds->data(), fds->size(), &ts, nullptr);
+#else
+  return poll(fds->data(), fds->size(), static_cast<int>((timeout_ns + 999999) / 1000000));
+#endif
+}
+
+// Until `start` is set, only reads: broadcasts still arrive while held.
+void HoldIdle(std::deque<LoadgenConnection>* conns, const LoadgenOptions& options,
+              const std::atomic<uint64_t>& start, LoadgenTotals* totals) {
+  std::vector<pollfd> fds(conns->size());
+  while (start.load(std::memory_order_acquire) == 0) {
+    for (size_t i = 0; i < conns->size(); ++i) {
+      fds[i].fd = (*conns)[i].open ? (*conns)[i].fd : -1;
+      fds[i].events = POLLIN;
+      fds[i].revents = 0;
+    }
+    if (WaitReady(&fds, 10000000) <= 0) continue;
+    for (size_t i = 0; i < conns->size(); ++i) {
+      if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+        Receive(&(*conns)[i], options, UINT64_MAX, totals);
+      }
+    }
+  }
+}
+
+void RunThread(const LoadgenOptions& options, std::deque<LoadgenConnection>* conns,
+               const std::atomic<uint64_t>& start_at, size_t active_total,
+               LoadgenTotals* totals) {
+  HoldIdle(conns, options, start_at, totals);
+  const uint64_t start = start_at.load(std::memory_order_acquire);
+  // Only active connections are scheduled; the thread's share of --rate
+  // follows its share of them.
+  std::vector<size_t> senders;
+  for (size_t i = 0; i < conns->size(); ++i) {
+    if ((*conns)[i].active) senders.push_back(i);
+  }
+  const double thread_rate =
+      active_total > 0 ? options.rate * senders.size() / active_total : 0.0;
+  const double interval_ns = thread_rate > 0 ? 1e9 / thread_rate : 0.0;
+  const uint64_t record_from = start + static_cast<uint64_t>(options.warmup_ms * 1e6);
+  const uint64_t stop_at = record_from + static_cast<uint64_t>(options.duration_ms * 1e6);
+  const uint64_t drain_until = stop_at + static_cast<uint64_t>(options.drain_ms * 1e6);
+  const uint64_t expected_per_conn_bytes = kFrameHeaderBytes + options.size;
+  uint64_t scheduled = 0;
+  uint64_t seq = 0;
+  size_t next_conn = 0;
+  std::vector<pollfd> fds(conns->size());
+
+  while (true) {
+    const uint64_t now = MonotonicNs();
+    const bool sending = now < stop_at;
+    if (!sending && (!options.echo || now >= drain_until)) break;
+    if (sending && !senders.empty()) {
+      if (interval_ns > 0) {
+        // Everything due by now, each stamped with the time it was due.
+        while (true) {
+          const uint64_t due = start + static_cast<uint64_t>(scheduled * interval_ns);
+          if (due > now) break;
+          LoadgenConnection& conn = (*conns)[senders[next_conn]];
+          next_conn = (next_conn + 1) % senders.size();
+          ++scheduled;
+          if (!conn.open || conn.out.size() - conn.out_offset > kLoadgenMaxBacklog) {
+            if (due >= record_from) totals->shed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+          }
+          AppendFrame(&conn, options.size, due, seq++);
+        }
+      } else {
+        // Closed loop: top each socket up to one frame past what it holds.
+        for (size_t index : senders) {
+          LoadgenConnection& conn = (*conns)[index];
+          if (conn.open && conn.out.size() - conn.out_offset < expected_per_conn_bytes) {
+            AppendFrame(&conn, options.size, now, seq++);
+          }
+        }
+      }
+    }
+
+    size_t open = 0;
+    for (size_t i = 0; i < conns->size(); ++i) {
+      LoadgenConnection& conn = (*conns)[i];
+      if (conn.open && conn.out_offset < conn.out.size()) Flush(&conn, record_from, totals);
+      fds[i].fd = conn.open ? conn.fd : -1;
+      fds[i].events = static_cast<short>(
+          POLLIN | (conn.out_offset < conn.out.size() ? POLLOUT : 0));
+      fds[i].revents = 0;
+      if (conn.open) ++open;
+    }
+    if (open == 0) break;
+
+    // Sleep until the next message is due (1 ms at most, so drain notices
+    // the deadline); closed-loop sending does not sleep at all.
+    uint64_t timeout_ns = 1000000;
+    if (sending && interval_ns > 0) {
+      const uint64_t due = start + static_cast<uint64_t>(scheduled * interval_ns);
+      const uint64_t after = MonotonicNs();
+      timeout_ns = due > after ? std::min<uint64_t>(due - after, timeout_ns) : 0;
+    } else if (sending && !senders.empty()) {
+      timeout_ns = 0;
+    }
+    if (WaitReady(&fds, timeout_ns) <= 0) continue;
+    for (size_t i = 0; i < conns->size(); ++i) {
+      LoadgenConnection& conn = (*conns)[i];
+      if (!conn.open) continue;
+      if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) Receive(&conn, options, record_from, totals);
+      if (fds[i].revents & POLLOUT) Flush(&conn, record_from, totals);
+    }
+  }
+}
+
+struct HandshakeTotals {
+  std::atomic<uint64_t> next{0};
+  std::atomic<uint64_t> completed{0};
+  std::atomic<uint64_t> resumed{0};
+  std::atomic<uint64_t> errors{0};
+  AtomicHistogram full_ns;     // connect() -> full handshake done
+  AtomicHistogram resumed_ns;  // connect() -> resumed handshake done
+  AtomicHistogram ttfb_ns;     // connect() -> echo decoded
+};
+
+SSL_CTX* CreateHandshakeCtx(const LoadgenOptions& options, std::string* error) {
+  SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+  if (!ctx) {
+    *error = "SSL_CTX_new failed";
+    return nullptr;
+  }
+  const int version = options.tls_version == "1.2" ? TLS1_2_VERSION : TLS1_3_VERSION;
+  SSL_CTX_set_min_proto_version(ctx, version);
+  SSL_CTX_set_max_proto_version(ctx, version);
+  if (options.ca.empty()) {
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
+  } else if (SSL_CTX_load_verify_locations(ctx, options.ca.c_str(), nullptr) == 1) {
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
+  } else {
+    *error = "cannot load --ca " + options.ca;
+    SSL_CTX_free(ctx);
+    return nullptr;
+  }
+  return ctx;
+}
+
+// One connection from connect() to close; false if any step failed.
+bool HandshakeOnce(const LoadgenOptions& options, SSL_CTX* ctx, size_t index,
+                   SSL_SESSION** session, HandshakeTotals* totals) {
+  const uint64_t started = MonotonicNs();
+  std::string error;
+  const int fd = Connect(options, index, &error);
+  if (fd < 0) return false;
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+  SSL* ssl = SSL_new(ctx);
+  SSL_set_fd(ssl, fd);
+  SSL_set_tlsext_host_name(ssl, options.servername.c_str());
+  if (*session) SSL_set_session(ssl, *session);
+  bool echoed = false;
+  if (SSL_connect(ssl) == 1) {
+    const uint64_t done = MonotonicNs();
+    if (SSL_session_reused(ssl) == 1) {
+      totals->resumed_ns.Record(done - started);
+      totals->resumed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      totals->full_ns.Record(done - started);
+    }
+    LoadgenConnection frame;
+    AppendFrame(&frame, options.size, started, index);
+    bool ok = SSL_write(ssl, frame.out.data(), static_cast<int>(frame.out.size())) ==
+              static_cast<int>(frame.out.size());
+    uint8_t chunk[16 * 1024];
+    while (ok && !echoed) {
+      const int n = SSL_read(ssl, chunk, sizeof(chunk));
+      if (n <= 0) break;
+      ok = frame.assembler.Feed(chunk, static_cast<size_t>(n), kDefaultMaxFrameLength,
+                                [&](std::vector<uint8_t>) {
+                                  echoed = true;
+                                  return true;
+                                }) == FrameFeedResult::kOk;
+    }
+    if (echoed) {
+      totals->ttfb_ns.Record(MonotonicNs() - started);
+      // TLS 1.3 tickets follow the handshake, so the session is taken once
+      // the echo has been read past them.
+      if (options.resume) {
+        if (SSL_SESSION* next = SSL_get1_session(ssl)) {
+          if (*session) SSL_SESSION_free(*session);
+          *session = next;
+        }
+      }
+    }
+    SSL_shutdown(ssl);
+  }
+  SSL_free(ssl);
+  close(fd);
+  return echoed;
+}
+
+void RunHandshakes(const LoadgenOptions& options, SSL_CTX* ctx, HandshakeTotals* totals) {
+  SSL_SESSION* session = nullptr;
+  while (true) {
+    const uint64_t index = totals->next.fetch_add(1, std::memory_order_relaxed);
+    if (index >= options.handshakes) break;
+    if (HandshakeOnce(options, ctx, index, &session, totals)) {
+      totals->completed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      totals->errors.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  if (session) SSL_SESSION_free(session);
+}
+
+uint64_t CpuUs() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return static_cast<uint64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 +
+         static_cast<uint64_t>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+void AppendSummary(std::string* json, const char* key, const AtomicHistogram& histogram) {
+  const AtomicHistogram::Summary s = histogram.Summarize(1000.0);
+  char buf[320];
+  std::snprintf(buf, sizeof(buf),
+                "\"%s\":{\"count\":%.0f,\"min\":%.3f,\"max\":%.3f,\"mean\":%.3f,"
+                "\"p50\":%.3f,\"p90\":%.3f,\"p99\":%.3f,\"p999\":%.3f}",
+                key, s.count, s.min, s.max, s.mean, s.p50, s.p90, s.p99, s.p999);
+  *json += buf;
+}
+
+// [lowerUs, upperUs, count] per non-empty bucket: the trace histogram schema.
+void AppendBuckets(std::string* json, const char* key, const AtomicHistogram& histogram) {
+  *json += "\"";
+  *json += key;
+  *json += "\":[";
+  bool first = true;
+  histogram.ForEachBucket([&](uint64_t lower, uint64_t upper, uint64_t count) {
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "%s[%.3f,%.3f,%" PRIu64 "]", first ? "" : ",",
+                  lower / 1000.0, upper / 1000.0, count);
+    *json += buf;
+    first = false;
+  });
+  *json += "]";
+}
+
+std::string FormatResult(const LoadgenOptions& options, const LoadgenTotals& totals,
+                         double measured_ms, size_t active, double connect_ms) {
+  // Counts within the measured window; warmup and drain are left out.
+  const auto sent = static_cast<uint64_t>(totals.send_lag_ns.Summarize().count);
+  const auto received = static_cast<uint64_t>(totals.latency_ns.Summarize().count);
+  const uint64_t delivered = options.echo ? received : sent;
+  const double msgs_per_sec = measured_ms > 0 ? delivered * 1000.0 / measured_ms : 0.0;
+  std::string scenario = options.label;
+  if (scenario.empty()) {
+    char name[128];
+    std::snprintf(name, sizeof(name), "native-loadgen/%s/%zuc/%.0f", options.echo ? "echo" : "sink",
+                  options.connections, options.rate);
+    scenario = name;
+  }
+  char timestamp[32];
+  const std::time_t now = std::time(nullptr);
+  std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+  char head[768];
+  std::snprintf(
+      head, sizeof(head),
+      "{\"timestamp\":\"%s\",\"scenario\":\"%s\",\"mode\":\"%s\",\"connections\":%zu,"
+      "\"threads\":%zu,\"targetRate\":%.0f,\"payloadBytes\":%zu,\"durationMs\":%.1f,"
+      "\"sent\":%" PRIu64 ",\"received\":%" PRIu64 ",\"shed\":%" PRIu64 ",\"errors\":%" PRIu64
+      ",\"bytesSent\":%" PRIu64 ",\"bytesReceived\":%" PRIu64
+      ",\"msgsPerSec\":%.1f,\"mbPerSec\":%.3f,\"active\":%zu,\"connectMs\":%.1f,",
+      timestamp, scenario.c_str(), options.echo ? "echo" : "sink", options.connections,
+      options.threads, options.rate, options.size, measured_ms, sent, received,
+      totals.shed.load(), totals.errors.load(), totals.bytes_sent.load(),
+      totals.bytes_received.load(), msgs_per_sec,
+      msgs_per_sec * options.size / (1024.0 * 1024.0), active, connect_ms);
+  std::string json = head;
+  AppendSummary(&json, "latencyUs", totals.latency_ns);
+  json += ",";
+  AppendSummary(&json, "sendLagUs", totals.send_lag_ns);
+  json += ",";
+  AppendSummary(&json, "fanoutUs", totals.fanout_ns);
+  json += ",";
+  AppendBuckets(&json, "latencyHistogramUs", totals.latency_ns);
+  json += ",";
+  AppendBuckets(&json, "sendLagHistogramUs", totals.send_lag_ns);
+  json += "}";
+  return json;
+}
+
+std::string FormatHandshakeResult(const LoadgenOptions& options, const HandshakeTotals& totals,
+                                  double elapsed_ms, uint64_t cpu_us) {
+  const uint64_t completed = totals.completed.load();
+  std::string scenario = options.label;
+  if (scenario.empty()) {
+    char name[128];
+    std::snprintf(name, sizeof(name), "native-loadgen/handshake/tls%s/%s/%zut",
+                  options.tls_version.c_str(), options.resume ? "resume" : "full",
+                  options.threads);
+    scenario = name;
+  }
+  char timestamp[32];
+  const std::time_t now = std::time(nullptr);
+  std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+  char head[768];
+  std::snprintf(
+      head, sizeof(head),
+      "{\"timestamp\":\"%s\",\"scenario\":\"%s\",\"mode\":\"handshake\",\"tlsVersion\":\"%s\","
+      "\"resume\":%s,\"threads\":%zu,\"payloadBytes\":%zu,\"handshakes\":%zu,"
+      "\"completed\":%" PRIu64 ",\"resumed\":%" PRIu64 ",\"errors\":%" PRIu64
+      ",\"durationMs\":%.1f,\"handshakesPerSec\":%.1f,\"clientCpuUsPerHandshake\":%.1f,",
+      timestamp, scenario.c_str(), options.tls_version.c_str(), options.resume ? "true" : "false",
+      options.threads, options.size, options.handshakes, completed, totals.resumed.load(),
+      totals.errors.load(), elapsed_ms, elapsed_ms > 0 ? completed * 1000.0 / elapsed_ms : 0.0,
+      completed > 0 ? static_cast<double>(cpu_us) / completed : 0.0);
+  std::string json = head;
+  AppendSummary(&json, "fullHandshakeUs", totals.full_ns);
+  json += ",";
+  AppendSummary(&json, "resumedHandshakeUs", totals.resumed_ns);
+  json += ",";
+  AppendSummary(&json, "ttfbUs", totals.ttfb_ns);
+  json += ",";
+  AppendBuckets(&json, "ttfbHistogramUs", totals.ttfb_ns);
+  json += "}";
+  return json;
+}
+
+bool ParseArgs(int argc, char** argv, LoadgenOptions* options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (arg == "--help" || arg == "-h" || !value) {
+      return false;
+    }
+    ++i;
+    if (arg == "--host") {
+      options->host = value;
+    } else if (arg == "--port") {
+      options->port = value;
+    } else if (arg == "--connections") {
+      options->connections = static_cast<size_t>(std::max(1ll, std::atoll(value)));
+    } else if (arg == "--threads") {
+      options->threads = static_cast<size_t>(std::max(1ll, std::atoll(value)));
+    } else if (arg == "--rate") {
+      options->rate = std::max(0.0, std::atof(value));
+    } else if (arg == "--size") {
+      options->size = std::max<size_t>(kLoadgenStampBytes, std::atoll(value));
+    } else if (arg == "--duration-ms") {
+      options->duration_ms = std::max(1.0, std::atof(value));
+    } else if (arg == "--warmup-ms") {
+      options->warmup_ms = std::max(0.0, std::atof(value));
+    } else if (arg == "--drain-ms") {
+      options->drain_ms = std::max(0.0, std::atof(value));
+    } else if (arg == "--mode") {
+      const std::string mode = value;
+      if (mode != "echo" && mode != "sink" && mode != "handshake") return false;
+      options->echo = mode != "sink";
+      options->handshake = mode == "handshake";
+    } else if (arg == "--label") {
+      options->label = value;
+    } else if (arg == "--out") {
+      options->out = value;
+    } else if (arg == "--active") {
+      options->active = static_cast<size_t>(std::max(0ll, std::atoll(value)));
+    } else if (arg == "--sources") {
+      options->sources = static_cast<size_t>(std::max(0ll, std::min(250ll, std::atoll(value))));
+    } else if (arg == "--handshakes") {
+      options->handshakes = static_cast<size_t>(std::max(1ll, std::atoll(value)));
+    } else if (arg == "--tls-version") {
+      options->tls_version = value;
+      if (options->tls_version != "1.2" && options->tls_version != "1.3") return false;
+    } else if (arg == "--resume") {
+      options->resume = std::atoi(value) != 0;
+    } else if (arg == "--ca") {
+      options->ca = value;
+    } else if (arg == "--servername") {
+      options->servername = value;
+    } else if (arg == "--start") {
+      const std::string start = value;
+      if (start != "now" && start != "stdin") return false;
+      options->start_on_stdin = start == "stdin";
+    } else {
+      return false;
+    }
+  }
+  options->threads = std::min(options->threads, options->connections);
+  if (options->active == 0 || options->active > options->connections) {
+    options->active = options->connections;
+  }
+  return !options->port.empty();
+}
+
+int WriteRecord(const LoadgenOptions& options, const std::string& record) {
+  std::FILE* out = options.out.empty() ? stdout : std::fopen(options.out.c_str(), "a");
+  if (!out) {
+    std::fprintf(stderr, "cannot open %s: %s\n", options.out.c_str(), std::strerror(errno));
+    return 1;
+  }
+  std::fprintf(out, "%s\n", record.c_str());
+  if (out != stdout) std::fclose(out);
+  return 0;
+}
+
+int RunHandshakeMode(const LoadgenOptions& options) {
+  std::string error;
+  SSL_CTX* ctx = CreateHandshakeCtx(options, &error);
+  if (!ctx) {
+    std::fprintf(stderr, "%s\n", error.c_str());
+    return 1;
+  }
+  HandshakeTotals totals;
+  const uint64_t cpu_before = CpuUs();
+  const uint64_t started = MonotonicNs();
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < options.threads; ++t) {
+    threads.emplace_back([&options, ctx, &totals] { RunHandshakes(options, ctx, &totals); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const double elapsed_ms = (MonotonicNs() - started) / 1e6;
+  const uint64_t cpu_us = CpuUs() - cpu_before;
+  SSL_CTX_free(ctx);
+  if (WriteRecord(options, FormatHandshakeResult(options, totals, elapsed_ms, cpu_us)) != 0) {
+    return 1;
+  }
+  const AtomicHistogram::Summary ttfb = totals.ttfb_ns.Summarize(1000.0);
+  std::fprintf(stderr, "handshakes %" PRIu64 " resumed %" PRIu64 " errors %" PRIu64
+               " | %.0f/s | ttfb us p50 %.1f p99 %.1f\n",
+               totals.completed.load(), totals.resumed.load(), totals.errors.load(),
+               elapsed_ms > 0 ? totals.completed.load() * 1000.0 / elapsed_ms : 0.0, ttfb.p50,
+               ttfb.p99);
+  return totals.errors.load() > 0 ? 1 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  LoadgenOptions options;
+  if (!ParseArgs(argc, argv, &options)) {
+    std::fprintf(stderr,
+                 "usage: %s --port N [--host H] [--connections 64] [--threads 4] "
+                 "[--rate 100000] [--size 256] [--duration-ms 5000] [--warmup-ms 1000] "
+                 "[--mode echo|sink] [--drain-ms 2000] [--label name] [--out file.jsonl] "
+                 "[--active N] [--sources N] [--start now|stdin]\n"
+                 "       %s --port N --mode handshake [--handshakes 1000] [--threads 4] "
+                 "[--tls-version 1.2|1.3] [--resume 0|1] [--ca file.pem] "
+                 "[--servername localhost]\n",
+                 argv[0], argv[0]);
+    return 2;
+  }
+  std::signal(SIGPIPE, SIG_IGN);
+  // Tens of thousands of sockets need the hard descriptor limit.
+  rlimit files{};
+  if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur < files.rlim_max) {
+    files.rlim_cur = files.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &files);
+  }
+  if (options.handshake) {
+    return RunHandshakeMode(options);
+  }
+
+  // Connections are split across threads up front and each thread connects
+  // and then polls its own; connection i sends if i < --active. Deques,
+  // since a FrameAssembler (atomic checksum counters) cannot move.
+  std::vector<std::deque<LoadgenConnection>> groups(options.threads);
+  for (size_t i = 0; i < options.connections; ++i) {
+    groups[i % options.threads].emplace_back();
+    groups[i % options.threads].back().active = i < options.active;
+  }
+  std::atomic<bool> connect_failed{false};
+  const uint64_t connect_started = MonotonicNs();
+  std::vector<std::thread> connectors;
+  for (size_t t = 0; t < groups.size(); ++t) {
+    connectors.emplace_back([&options, &groups, &connect_failed, t] {
+      for (size_t j = 0; j < groups[t].size() && !connect_failed.load(); ++j) {
+        std::string error;
+        const int fd = Connect(options, j * options.threads + t, &error);
+        if (fd < 0) {
+          if (!connect_failed.exchange(true)) {
+            std::fprintf(stderr, "connect %s:%s failed after %zu: %s\n", options.host.c_str(),
+                         options.port.c_str(), j * options.threads + t, error.c_str());
+          }
+          return;
+        }
+        groups[t][j].fd = fd;
+      }
+    });
+  }
+  for (auto& connector : connectors) {
+    connector.join();
+  }
+  if (connect_failed.load()) {
+    for (auto& group : groups) {
+      for (auto& conn : group) {
+        if (conn.fd >= 0) close(conn.fd);
+      }
+    }
+    return 1;
+  }
+  const double connect_ms = (MonotonicNs() - connect_started) / 1e6;
+
+  LoadgenTotals totals;
+  std::atomic<uint64_t> start{0};
+  std::vector<std::thread> threads;
+  for (auto& group : groups) {
+    threads.emplace_back([&options, &group, &start, &totals] {
+      RunThread(options, &group, start, options.active, &totals);
+    });
+  }
+  if (options.start_on_stdin) {
+    std::printf("{\"event\":\"connected\",\"connections\":%zu,\"connectMs\":%.1f}\n",
+                options.connections, connect_ms);
+    std::fflush(stdout);
+    char line[64];
+    if (!std::fgets(line, sizeof(line), stdin)) {
+      // The driver went away; run anyway so the threads wind down.
+    }
+  }
+  start.store(MonotonicNs(), std::memory_order_release);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& group : groups) {
+    for (auto& conn : group) close(conn.fd);
+  }
+
+  const std::string record =
+      FormatResult(options, totals, options.duration_ms, options.active, connect_ms);
+  if (WriteRecord(options, record) != 0) {
+    return 1;
+  }
+  const AtomicHistogram::Summary latency = totals.latency_ns.Summarize(1000.0);
+  std::fprintf(stderr, "sent %" PRIu64 " received %" PRIu64 " shed %" PRIu64
+               " | latency us p50 %.1f p99 %.1f p999 %.1f max %.1f\n",
+               totals.sent.load(), totals.received.load(), totals.shed.load(), latency.p50,
+               latency.p99, latency.p999, latency.max);
+  return totals.errors.load() > 0 ? 1 : 0;
+}
@@ -0,0 +1,442 @@
+// Microbenchmarks for the lws addon's hot paths, built from the addon source
+// itself (make bench-native) and run without Node:
+//
+//   qwormhole_lws_bench [--filter substr] [--sizes 64,1024,16384]
+//                       [--min-time-ms 200] [--runs 5] [--out file.jsonl]
+//
+// Each case/size line is one JSONL record shaped like the bench:core ones
+// (scenario, msgsPerSec, repeatStats.msgsPerSec) so
+// scripts/generate-bench-delta-report.js can diff two runs; msgsPerSec is
+// operations per second. Records are appended to --out, else printed.
+#define QWORMHOLE_NATIVE_BENCH 1
+#include "../qwormhole_lws.cpp"
+
+#include <cstdio>
+#include <ctime>
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+// Keeps a result alive without the compiler proving it unused.
+template <typename T>
+void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchOptions {
+  std::string filter;
+  std::vector<size_t> sizes{64, 1024, 16384};
+  double min_time_ms = 200.0;
+  int runs = 5;
+  std::string out;
+};
+
+// One timed batch: the case runs `iterations` operations and reports how many
+// it did (fan-out and decode count deliveries/frames, not loop turns).
+using BenchBody = std::function<uint64_t(uint64_t iterations)>;
+
+struct BenchRun {
+  double ops_per_sec = 0.0;
+  double ns_per_op = 0.0;
+  uint64_t ops = 0;
+};
+
+std::vector<uint8_t> BenchPayload(size_t size, uint32_t seed) {
+  std::vector<uint8_t> out(size);
+  std::mt19937 rng(seed);
+  for (auto& byte : out) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  return out;
+}
+
+// Doubles the batch until it fills min_time_ms, so short cases are not
+// dominated by the clock read.
+BenchRun TimeBatch(const BenchBody& body, double min_time_ms) {
+  uint64_t iterations = 1;
+  while (true) {
+    const auto start = BenchClock::now();
+    const uint64_t ops = body(iterations);
+    const double elapsed_ms =
+        std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+    if (elapsed_ms >= min_time_ms || iterations >= (1ull << 40)) {
+      BenchRun run;
+      run.ops = ops;
+      run.ops_per_sec = elapsed_ms > 0.0 ? ops * 1000.0 / elapsed_ms : 0.0;
+      run.ns_per_op = ops > 0 ? elapsed_ms * 1e6 / ops : 0.0;
+      return run;
+    }
+    const double scale = elapsed_ms > 0.0 ? (min_time_ms * 1.2) / elapsed_ms : 8.0;
+    iterations = std::max<uint64_t>(iterations * 2,
+                                    static_cast<uint64_t>(iterations * std::min(scale, 64.0)));
+  }
+}
+
+// --- frames ------------------------------------------------------------------
+
+BenchBody FrameEncode(size_t size, size_t* bytes_per_op) {
+  auto payload = std::make_shared<std::vector<uint8_t>>(BenchPayload(size, 1));
+  *bytes_per_op = size;
+  return [payload](uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; ++i) {
+      QueuedWrite write = BuildLengthPrefixedWrite(payload->data(), payload->size());
+      DoNotOptimize(write.buffer->data());
+    }
+    return iterations;
+  };
+}
+
+// Back-to-back frames filling a 64 KiB RX chunk. `chunk` > 0 feeds it in
+// pieces of that size so frames straddle reads (the partial_ path);
+// `checksum` trails each with a CRC32C the assembler checks (integrity).
+BenchBody FrameDecode(size_t size, size_t chunk, bool checksum, size_t* bytes_per_op) {
+  const auto payload = BenchPayload(size, 2);
+  const size_t frames = std::max<size_t>(1, (64 * 1024) / (size + kFrameHeaderBytes));
+  auto stream = std::make_shared<std::vector<uint8_t>>();
+  for (size_t i = 0; i < frames; ++i) {
+    QueuedWrite write = BuildLengthPrefixedWrite(payload.data(), payload.size());
+    if (checksum) ChecksumQueuedWrite(&write);
+    stream->insert(stream->end(), write.buffer->begin() + LWS_PRE, write.buffer->end());
+  }
+  *bytes_per_op = size;
+  auto assembler = std::make_shared<FrameAssembler>();
+  if (checksum) assembler->VerifyChecksums(nullptr);
+  const size_t step = chunk > 0 ? chunk : stream->size();
+  return [stream, assembler, step](uint64_t iterations) {
+    uint64_t decoded = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+      for (size_t at = 0; at < stream->size(); at += step) {
+        const size_t len = std::min(step, stream->size() - at);
+        assembler->Feed(stream->data() + at, len, kDefaultMaxFrameLength,
+                        [&decoded](std::vector<uint8_t> frame) {
+                          DoNotOptimize(frame.data());
+                          ++decoded;
+                          return true;
+                        });
+      }
+    }
+    return decoded;
+  };
+}
+
+// CRC32C over one payload: the dispatched implementation (SSE4.2 or ARMv8
+// CRC where the CPU has it), or the slicing-by-8 tables it falls back to.
+BenchBody Crc32cCase(size_t size, bool tables, size_t* bytes_per_op) {
+  auto payload = std::make_shared<std::vector<uint8_t>>(BenchPayload(size, 8));
+  *bytes_per_op = size;
+  return [payload, tables](uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(tables ? ~Crc32cSoftware(~0u, payload->data(), payload->size())
+                           : Crc32c(payload->data(), payload->size()));
+    }
+    return iterations;
+  };
+}
+
+// --- queues --------------------------------------------------------------------
+
+// `producers` threads push shared QueuedWrites while the calling thread pops,
+// as app threads feed a service thread. Every push is popped before returning.
+BenchBody QueueContention(size_t producers, size_t* bytes_per_op) {
+  const auto payload = BenchPayload(256, 6);
+  auto write =
+      std::make_shared<QueuedWrite>(BuildLengthPrefixedWrite(payload.data(), payload.size()));
+  *bytes_per_op = 256;
+  return [producers, write](uint64_t iterations) {
+    MpscWriteQueue queue;
+    const uint64_t per_producer = std::max<uint64_t>(1, iterations / producers);
+    const uint64_t total = per_producer * producers;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    threads.reserve(producers);
+    for (size_t p = 0; p < producers; ++p) {
+      threads.emplace_back([&queue, &go, per_producer, write] {
+        while (!go.load(std::memory_order_acquire)) {
+          std::this_thread::yield();
+        }
+        for (uint64_t i = 0; i < per_producer; ++i) {
+          queue.Push(*write);
+        }
+      });
+    }
+    go.store(true, std::memory_order_release);
+    uint64_t popped = 0;
+    QueuedWrite out;
+    while (popped < total) {
+      if (queue.TryPop(&out)) {
+        ++popped;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    return popped;
+  };
+}
+
+// One frame, queued once per connection and drained by each connection's
+// service pass, as broadcast() shares a single buffer across recipients.
+BenchBody BroadcastFanout(size_t size, size_t connections, size_t* bytes_per_op) {
+  auto payload = std::make_shared<std::vector<uint8_t>>(BenchPayload(size, 3));
+  auto queues = std::make_shared<std::vector<std::unique_ptr<MpscWriteQueue>>>();
+  for (size_t i = 0; i < connections; ++i) {
+    queues->push_back(std::make_unique<MpscWriteQueue>());
+  }
+  *bytes_per_op = size;
+  return [payload, queues](uint64_t iterations) {
+    uint64_t delivered = 0;
+    QueuedWrite out;
+    for (uint64_t i = 0; i < iterations; ++i) {
+      QueuedWrite write = BuildLengthPrefixedWrite(payload->data(), payload->size());
+      for (auto& queue : *queues) {
+        queue->Push(write);
+      }
+      for (auto& queue : *queues) {
+        while (queue->TryPop(&out)) {
+          DoNotOptimize(out.write_ptr());
+          ++delivered;
+        }
+      }
+    }
+    return delivered;
+  };
+}
+
+// --- handshakes ----------------------------------------------------------------
+
+// The client side of a negantropic handshake carrying `size` bytes of tags,
+// as createNegentropicHandshake() and connect({ handshake }) send it.
+std::shared_ptr<const HandshakeFrameBuilder> BenchHandshakeBuilder(size_t size) {
+  JsonValue tags;
+  tags.type = JsonType::Object;
+  size_t bytes = 0;
+  for (size_t i = 0; bytes < size; ++i) {
+    std::string name = "tag" + std::to_string(i);
+    std::string value(24, static_cast<char>('a' + i % 26));
+    bytes += name.size() + value.size() + 6;
+    tags.object_value[std::move(name)] = MakeJsonString(std::move(value));
+  }
+  return HandshakeFrameBuilder::Create(LoadEd25519PrivateKey(BenchPayload(32, 4)), "1.0.0",
+                                       std::move(tags));
+}
+
+std::string SignedHandshake(size_t size) {
+  return *BenchHandshakeBuilder(size)->Build(WallClockMs());
+}
+
+// Building and signing one handshake frame: what each connect costs a
+// client that preloaded its key.
+BenchBody HandshakeSign(size_t size, size_t* bytes_per_op) {
+  auto builder = BenchHandshakeBuilder(size);
+  *bytes_per_op = builder->Build(0)->size();
+  return [builder](uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(builder->Build(static_cast<double>(i))->size());
+    }
+    return iterations;
+  };
+}
+
+BenchBody HandshakeParse(size_t size, size_t* bytes_per_op) {
+  auto frame = std::make_shared<std::string>(SignedHandshake(size));
+  *bytes_per_op = frame->size();
+  return [frame](uint64_t iterations) {
+    std::string error;
+    for (uint64_t i = 0; i < iterations; ++i) {
+      HandshakeFields fields(8 * frame->size() + 2048);
+      HandshakeScanner(*frame, &fields).Scan(&error);
+      DoNotOptimize(fields.canonical.data());
+    }
+    return iterations;
+  };
+}
+
+// Scan plus VerifyNegantropicHandshake; `cached` reuses the key cache across
+// handshakes as a long-lived server does, otherwise every one decodes the key.
+BenchBody HandshakeVerify(size_t size, bool cached, size_t* bytes_per_op) {
+  auto frame = std::make_shared<std::string>(SignedHandshake(size));
+  auto cache = std::make_shared<VerifiedKeyCache>(64);
+  *bytes_per_op = frame->size();
+  return [frame, cache, cached](uint64_t iterations) {
+    std::string error;
+    uint64_t verified = 0;
+    for (uint64_t i = 0; i < iterations; ++i) {
+      HandshakeFields fields(8 * frame->size() + 2048);
+      HandshakeMetadata meta;
+      if (HandshakeScanner(*frame, &fields).Scan(&error) &&
+          VerifyNegantropicHandshake(fields, cached ? cache.get() : nullptr, &meta, &error)) {
+        ++verified;
+      }
+    }
+    return verified;
+  };
+}
+
+// --- entropy -------------------------------------------------------------------
+
+BenchBody Entropy(size_t size, size_t* bytes_per_op) {
+  auto payload = std::make_shared<std::vector<uint8_t>>(BenchPayload(size, 5));
+  *bytes_per_op = size;
+  return [payload](uint64_t iterations) {
+    for (uint64_t i = 0; i < iterations; ++i) {
+      DoNotOptimize(ComputeByteEntropy(payload->data(), payload->size()));
+    }
+    return iterations;
+  };
+}
+
+// A case's setup builds its inputs once and reports the payload bytes each
+// operation moves (for mbPerSec).
+using BenchCases = std::vector<std::pair<std::string, std::function<BenchBody(size_t*)>>>;
+
+BenchCases CasesFor(size_t size) {
+  const std::string s = std::to_string(size);
+  return {
+      {"frame-encode/" + s, [size](size_t* b) { return FrameEncode(size, b); }},
+      {"frame-decode/" + s, [size](size_t* b) { return FrameDecode(size, 0, false, b); }},
+      {"frame-decode-straddled/" + s,
+       [size](size_t* b) { return FrameDecode(size, 1460, false, b); }},
+      {"frame-decode-checksummed/" + s,
+       [size](size_t* b) { return FrameDecode(size, 0, true, b); }},
+      {"crc32c/" + s, [size](size_t* b) { return Crc32cCase(size, false, b); }},
+      {"crc32c-tables/" + s, [size](size_t* b) { return Crc32cCase(size, true, b); }},
+      {"broadcast-fanout-64/" + s, [size](size_t* b) { return BroadcastFanout(size, 64, b); }},
+      {"handshake-sign/" + s, [size](size_t* b) { return HandshakeSign(size, b); }},
+      {"handshake-parse/" + s, [size](size_t* b) { return HandshakeParse(size, b); }},
+      {"handshake-verify/" + s, [size](size_t* b) { return HandshakeVerify(size, false, b); }},
+      {"handshake-verify-cached/" + s,
+       [size](size_t* b) { return HandshakeVerify(size, true, b); }},
+      {"entropy/" + s, [size](size_t* b) { return Entropy(size, b); }},
+  };
+}
+
+// Queue contention does not vary with payload size; it runs once per
+// producer count instead.
+BenchCases FixedCases() {
+  BenchCases cases;
+  for (size_t producers : {1, 2, 4}) {
+    cases.emplace_back("queue-mpsc-" + std::to_string(producers) + "p",
+                       [producers](size_t* b) { return QueueContention(producers, b); });
+  }
+  return cases;
+}
+
+template <typename Field>
+double Median(const std::vector<BenchRun>& runs, Field field) {
+  std::vector<double> values;
+  for (const auto& run : runs) values.push_back(run.*field);
+  std::sort(values.begin(), values.end());
+  const size_t n = values.size();
+  return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0;
+}
+
+std::string FormatRecord(const std::string& name, size_t bytes_per_op,
+                         const std::vector<BenchRun>& runs) {
+  std::vector<double> rates;
+  double sum = 0.0;
+  for (const auto& run : runs) {
+    rates.push_back(run.ops_per_sec);
+    sum += run.ops_per_sec;
+  }
+  const double median = Median(runs, &BenchRun::ops_per_sec);
+  const double avg = sum / rates.size();
+  const auto [worst, best] = std::minmax_element(rates.begin(), rates.end());
+  char timestamp[32];
+  const std::time_t now = std::time(nullptr);
+  std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+  char line[768];
+  std::snprintf(line, sizeof(line),
+                "{\"timestamp\":\"%s\",\"scenario\":\"native-micro/%s\",\"bytesPerOp\":%zu,"
+                "\"msgsPerSec\":%.1f,\"mbPerSec\":%.3f,\"nsPerOp\":%.2f,\"runs\":%zu,"
+                "\"repeatStats\":{\"msgsPerSec\":{\"median\":%.1f,\"avg\":%.1f,"
+                "\"best\":%.1f,\"worst\":%.1f}}}",
+                timestamp, name.c_str(), bytes_per_op, median,
+                median * bytes_per_op / (1024.0 * 1024.0), median > 0 ? 1e9 / median : 0.0,
+                runs.size(), median, avg, *best, *worst);
+  return line;
+}
+
+bool ParseArgs(int argc, char** argv, BenchOptions* options) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (arg == "--help" || arg == "-h" || !value) {
+      return false;
+    }
+    ++i;
+    if (arg == "--filter") {
+      options->filter = value;
+    } else if (arg == "--min-time-ms") {
+      options->min_time_ms = std::max(1.0, std::atof(value));
+    } else if (arg == "--runs") {
+      options->runs = std::max(1, std::atoi(value));
+    } else if (arg == "--out") {
+      options->out = value;
+    } else if (arg == "--sizes") {
+      options->sizes.clear();
+      std::stringstream list(value);
+      std::string item;
+      while (std::getline(list, item, ',')) {
+        const long long size = std::atoll(item.c_str());
+        if (size > 0) options->sizes.push_back(static_cast<size_t>(size));
+      }
+    } else {
+      return false;
+    }
+  }
+  return !options->sizes.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  BenchOptions options;
+  if (!ParseArgs(argc, argv, &options)) {
+    std::fprintf(stderr,
+                 "usage: %s [--filter substr] [--sizes 64,1024,16384] [--min-time-ms 200] "
+                 "[--runs 5] [--out file.jsonl]\n",
+                 argv[0]);
+    return 2;
+  }
+  std::FILE* out = stdout;
+  if (!options.out.empty()) {
+    out = std::fopen(options.out.c_str(), "a");
+    if (!out) {
+      std::fprintf(stderr, "cannot open %s: %s\n", options.out.c_str(), std::strerror(errno));
+      return 1;
+    }
+  }
+
+  auto cases = FixedCases();
+  for (size_t size : options.sizes) {
+    for (auto& entry : CasesFor(size)) {
+      cases.push_back(std::move(entry));
+    }
+  }
+  for (const auto& [name, setup] : cases) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+    size_t bytes_per_op = 0;
+    const BenchBody body = setup(&bytes_per_op);
+    TimeBatch(body, options.min_time_ms / 4);  // warm caches and allocators
+    std::vector<BenchRun> runs;
+    for (int r = 0; r < options.runs; ++r) {
+      runs.push_back(TimeBatch(body, options.min_time_ms));
+    }
+    const std::string record = FormatRecord(name, bytes_per_op, runs);
+    std::fprintf(out, "%s\n", record.c_str());
+    std::fflush(out);
+    if (out != stdout) {
+      std::fprintf(stderr, "%-36s %14.0f ops/s %10.1f ns/op\n", name.c_str(),
+                   Median(runs, &BenchRun::ops_per_sec), Median(runs, &BenchRun::ns_per_op));
+    }
+  }
+  if (out != stdout) {
+    std::fclose(out);
+  }
+  return 0;
+}
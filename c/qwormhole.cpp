@@ -1,30 +1,1170 @@
 #include <napi.h>
-#include <inetclientstream.hpp>
-#include <exception.hpp>
 #include <libinetsocket.h>
+#include <libunixsocket.h>
+#include <exception.hpp>
+#include <inetserverdgram.hpp>
+#include <unixclientdgram.hpp>
+#include <unixserverdgram.hpp>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <linux/errqueue.h>
+#include <linux/filter.h>
+#include <linux/genetlink.h>
+#include <linux/net_tstamp.h>
+#include <linux/netlink.h>
+#include <linux/pkt_sched.h>
+#include <linux/rtnetlink.h>
+#include <linux/wireguard.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__)
+#include <tmmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 namespace {
+
+constexpr size_t kDefaultMaxBackpressureBytes = 8 * 1024 * 1024;
+// Client connects, RFC 8305: resolved addresses are reused for
+// dnsCacheTtlMs (getaddrinfo() reports no TTL), and the next address is
+// tried happyEyeballsDelayMs after the previous attempt started.
+constexpr uint32_t kDefaultDnsCacheTtlMs = 30 * 1000;
+constexpr uint32_t kDefaultHappyEyeballsDelayMs = 250;
+constexpr uint32_t kMinHappyEyeballsDelayMs = 10;
+constexpr uint32_t kMaxHappyEyeballsDelayMs = 2000;
+constexpr uint32_t kDefaultConnectRaceTimeoutMs = 30 * 1000;
+constexpr size_t kDefaultRxHighWaterMark = 4 * 1024 * 1024;
+constexpr size_t kReadChunkBytes = 64 * 1024;
+// Reads per readiness event before other sockets get a turn.
+constexpr int kMaxReadsPerEvent = 16;
+constexpr int kMaxIovPerWrite = 64;
+constexpr size_t kFrameHeaderBytes = 4;
+// timestamping: a stamped send not ACKed by then stops holding up the next.
+constexpr uint64_t kTxStampTimeoutNs = 1000000000ull;
+constexpr size_t kDefaultMaxFrameLength = 4 * 1024 * 1024;
+constexpr size_t kDefaultUdpBatch = 32;
+constexpr size_t kMaxUdpDatagram = 64 * 1024;
+// Resolved send destinations kept per UDP socket before the cache resets.
+constexpr size_t kMaxUdpPeerCache = 4096;
+// Idle receive blocks a UDP socket keeps for reuse; larger blocks are freed.
+constexpr size_t kUdpBlockPoolSize = 16;
+constexpr size_t kMaxPooledUdpBlockBytes = 1024 * 1024;
+// KCP wire format shared with src/transports/kcp: type, conv, seq, ack, len.
+constexpr size_t kKcpHeaderBytes = 17;
+constexpr uint8_t kKcpData = 0;
+constexpr uint8_t kKcpAck = 1;
+constexpr uint8_t kKcpPing = 2;
+constexpr uint32_t kKcpRtoNoDelayMin = 30;
+constexpr uint32_t kKcpRtoMin = 100;
+constexpr uint32_t kKcpRtoDefault = 200;
+constexpr uint32_t kKcpRtoMax = 60000;
+constexpr uint32_t kKcpDeadLink = 20;
+// Past this many transmissions a segment waits for its RTO, so a burst of
+// holes cannot fast-resend the same segment into the dead-link limit.
+constexpr uint32_t kKcpFastAckLimit = 5;
+constexpr size_t kKcpWheelSlots = 512;
+// fec, between native engines that both enable it (KcpSession drops the
+// type): a parity datagram's seq is its group's first data seq, and its
+// payload opens with kind, data count, parity count, parity index and the
+// group serial. A report carries the loss the receiver measured.
+constexpr uint8_t kKcpFec = 3;
+constexpr uint8_t kKcpFecParity = 0;
+constexpr uint8_t kKcpFecReport = 1;
+constexpr size_t kKcpFecHeaderBytes = 8;
+constexpr size_t kKcpFecLengthBytes = 2;
+constexpr size_t kKcpFecParityBase = 128;
+constexpr uint32_t kKcpFecMaxData = 64;
+constexpr uint32_t kKcpFecMaxParity = 32;
+// Parity datagrams per loss sample, and groups held waiting for shards.
+constexpr uint32_t kKcpFecLossSample = 64;
+constexpr size_t kKcpFecMaxGroups = 64;
+
+#include "qwormhole_socket_tuning.h"
+
+class TcpClientWrapper;
+class ShmLink;
+
+// interfaceName / localAddress / localPort for an outgoing socket.
+struct LocalBinding {
+  std::string interface_name;
+  std::string address;
+  uint16_t port = 0;
+
+  bool any() const { return !interface_name.empty() || !address.empty() || port != 0; }
+};
+
+// How the latest connect went: lookup, the address race, the winner.
+struct ConnectTrace {
+  double dns_ms = 0;
+  bool dns_cached = false;
+  double tcp_ms = -1;
+  double total_ms = -1;
+  uint32_t attempts = 0;
+  std::string address;
+};
+
+// One connection's state, shared by the JS-side wrapper and the reactor.
+// fd and the *_pending fields belong to the reactor thread; JS hands data
+// over through tx under mutex and hears back through tsfn.
+struct SocketChannel {
+  // Written by the reactor under mutex; the JS thread writes to it directly
+  // (under mutex) while nothing is queued.
+  int fd = -1;
+  bool attached = false;
+  bool connected_io = false;
+  bool finished = false;
+  bool want_write = false;
+  bool rx_paused = false;
+  std::deque<std::vector<uint8_t>> tx_pending;
+  size_t tx_offset = 0;
+
+  std::atomic<bool> connected{false};
+  std::atomic<bool> closing{false};
+  // Guards tx and fd against the reactor closing it.
+  std::mutex mutex;
+  std::deque<std::vector<uint8_t>> tx;
+  std::atomic<size_t> queued_bytes{0};
+  std::atomic<bool> backpressured{false};
+  size_t max_backpressure_bytes = kDefaultMaxBackpressureBytes;
+  // Bytes read but not yet delivered on the JS thread; reading pauses above
+  // rx_high_water and resumes below half of it.
+  std::atomic<size_t> rx_inflight{0};
+  size_t rx_high_water = kDefaultRxHighWaterMark;
+  // Set by connect(); the report lands under mutex once the socket exists.
+  SocketTuning tuning;
+  std::optional<SocketTuningReport> socket_report;
+  uint32_t dns_cache_ttl_ms = kDefaultDnsCacheTtlMs;
+  uint32_t happy_eyeballs_delay_ms = kDefaultHappyEyeballsDelayMs;
+  uint32_t connect_timeout_ms = kDefaultConnectRaceTimeoutMs;
+  LocalBinding local;
+  // sharedMemory: the ring size connect() asked for, then the link, set
+  // before the reactor attaches; the stream runs through it, not the socket.
+  size_t shm_ring_bytes = 0;
+  std::shared_ptr<ShmLink> shm;
+  // getConnectTimings(); written under mutex by the connecting thread.
+  std::chrono::steady_clock::time_point connect_started;
+  std::optional<ConnectTrace> connect_trace;
+
+  // Guards tsfn against calls racing its release by the reactor.
+  std::mutex events_mutex;
+  bool events_closed = false;
+  Napi::ThreadSafeFunction tsfn;
+  // JS thread only; cleared when the wrapper is destroyed first.
+  TcpClientWrapper* owner = nullptr;
+};
+
+// One epoll thread shared by every libsocket client, so a slow peer never
+// blocks the Node event loop and connections do not each cost a thread.
+// Everything that touches an fd runs here; other threads Post() to it.
+class SocketReactor {
+ public:
+  static SocketReactor& Instance() {
+    static SocketReactor* reactor = new SocketReactor();
+    return *reactor;
+  }
+
+  void Post(std::function<void()> command) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      commands_.push_back(std::move(command));
+    }
+    const uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fd_, &one, sizeof one);
+    (void)ignored;
+  }
+
+  // Reactor thread only.
+  void Attach(const std::shared_ptr<SocketChannel>& channel);
+  void Update(SocketChannel* channel);
+  void Teardown(const std::shared_ptr<SocketChannel>& channel,
+                std::optional<std::string> error);
+  void Flush(const std::shared_ptr<SocketChannel>& channel);
+  void RingReady(const std::shared_ptr<SocketChannel>& channel);
+  // drain ignores the per-event cap and rxHighWaterMark, for a closing peer.
+  void ReadRing(const std::shared_ptr<SocketChannel>& channel, bool drain = false);
+
+ private:
+  SocketReactor() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+    thread_ = std::thread(&SocketReactor::Run, this);
+    thread_.detach();
+  }
+
+  void Run();
+  void RunCommands();
+  void Dispatch(const std::shared_ptr<SocketChannel>& channel, uint32_t events);
+  void FinishConnect(const std::shared_ptr<SocketChannel>& channel);
+  void ReadAvailable(const std::shared_ptr<SocketChannel>& channel);
+
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::deque<std::function<void()>> commands_;
+  std::unordered_map<int, std::shared_ptr<SocketChannel>> channels_;
+};
+
 class TcpClientWrapper : public Napi::ObjectWrap<TcpClientWrapper> {
  public:
   static Napi::Object Init(Napi::Env env, Napi::Object exports);
   explicit TcpClientWrapper(const Napi::CallbackInfo& info);
+  ~TcpClientWrapper() override;
+
+  // JS thread; called from a channel's tsfn, possibly one already replaced
+  // by a reconnect.
+  void DeliverEvent(SocketChannel* from,
+                    const std::string& type,
+                    std::vector<uint8_t> data,
+                    std::optional<std::string> error,
+                    bool had_error,
+                    size_t queued_bytes);
 
  private:
-  libsocket::inet_stream client_;
+  std::shared_ptr<SocketChannel> channel_;
+  Napi::FunctionReference handler_;
+  std::optional<Napi::Promise::Deferred> pending_connect_;
+  std::deque<std::vector<uint8_t>> recv_queue_;
+  size_t recv_offset_ = 0;
 
   Napi::Value Connect(const Napi::CallbackInfo& info);
   Napi::Value Send(const Napi::CallbackInfo& info);
+  Napi::Value SendMany(const Napi::CallbackInfo& info);
+  Napi::Value SendV(const Napi::CallbackInfo& info);
   Napi::Value Recv(const Napi::CallbackInfo& info);
+  Napi::Value RecvInto(const Napi::CallbackInfo& info);
+  Napi::Value IsConnected(const Napi::CallbackInfo& info);
+  Napi::Value SetEventHandler(const Napi::CallbackInfo& info);
+  Napi::Value GetSocketOptions(const Napi::CallbackInfo& info);
+  Napi::Value GetConnectTimings(const Napi::CallbackInfo& info);
   Napi::Value Close(const Napi::CallbackInfo& info);
+
+  void Write(const struct iovec* iov, size_t count);
+  Napi::Value SendArray(const Napi::CallbackInfo& info, const char* usage, bool count_entries);
+  bool UpdateBackpressure();
+  size_t Buffered(size_t limit) const;
+  size_t DrainInto(uint8_t* out, size_t capacity);
+};
+
+// Marks received bytes as consumed on the JS thread and resumes a paused
+// reader once they fall below half the high-water mark.
+void ReleaseRx(const std::shared_ptr<SocketChannel>& channel, size_t bytes) {
+  if (bytes == 0) return;
+  const size_t before = channel->rx_inflight.fetch_sub(bytes);
+  const size_t low_water = channel->rx_high_water / 2;
+  if (before > low_water && before - bytes <= low_water) {
+    SocketReactor::Instance().Post([channel]() {
+      if (channel->rx_paused && !channel->finished) {
+        channel->rx_paused = false;
+        SocketReactor::Instance().Update(channel.get());
+        // What waits in a ring raises no new wakeup.
+        if (channel->shm) SocketReactor::Instance().ReadRing(channel);
+      }
+    });
+  }
+}
+
+void PostEvent(const std::shared_ptr<SocketChannel>& channel,
+               std::string type,
+               std::vector<uint8_t> data = {},
+               std::optional<std::string> error = std::nullopt,
+               bool had_error = false,
+               size_t queued_bytes = 0) {
+  auto callback = [channel, type = std::move(type), data = std::move(data),
+                   error = std::move(error), had_error,
+                   queued_bytes](Napi::Env, Napi::Function) mutable {
+    if (channel->owner) {
+      channel->owner->DeliverEvent(channel.get(), type, std::move(data), std::move(error),
+                                   had_error, queued_bytes);
+    } else if (type == "data") {
+      ReleaseRx(channel, data.size());
+    }
+  };
+  std::lock_guard<std::mutex> lock(channel->events_mutex);
+  if (!channel->events_closed) {
+    channel->tsfn.NonBlockingCall(callback);
+  }
+}
+
+// Node's net module names an abstract socket by its exact length, while
+// libsocket pads the name to the whole sun_path; the two would never meet.
+// Abstract names therefore bypass libsocket; filesystem paths go through it.
+bool FillAbstractAddress(const std::string& name, struct sockaddr_un* addr, socklen_t* len) {
+  if (name.size() < 2 || name.size() > sizeof(addr->sun_path)) {
+    errno = name.size() < 2 ? EINVAL : ENAMETOOLONG;
+    return false;
+  }
+  std::memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  std::memcpy(addr->sun_path, name.data(), name.size());
+  *len = static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + name.size());
+  return true;
+}
+
+int ConnectUnixStream(const std::string& path) {
+  if (path[0] != '\0') {
+    return create_unix_stream_socket(path.c_str(), SOCK_NONBLOCK | SOCK_CLOEXEC);
+  }
+  struct sockaddr_un addr;
+  socklen_t len = 0;
+  if (!FillAbstractAddress(path, &addr, &len)) return -1;
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+  if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), len) != 0) {
+    const int saved_errno = errno;
+    ::close(fd);
+    errno = saved_errno;
+    return -1;
+  }
+  return fd;
+}
+
+// sharedMemory: two byte rings in one sealed memfd, one per direction, for
+// peers on the same host. The client creates the segment and an eventfd for
+// each side and passes all three with the first bytes it sends on the Unix
+// socket it connected; from then on the stream runs through the rings and
+// the socket only tells each side when the other one is gone. An eventfd is
+// written only when a write makes its ring non-empty or frees room a stalled
+// producer is waiting for, so a busy pair moves frames without syscalls.
+constexpr char kShmHelloMagic[8] = {'Q', 'W', 'S', 'H', 'M', '0', '0', '1'};
+constexpr size_t kShmHelloBytes = 16;
+constexpr size_t kDefaultShmRingBytes = 1024 * 1024;
+constexpr size_t kMinShmRingBytes = 64 * 1024;
+constexpr size_t kMaxShmRingBytes = 256 * 1024 * 1024;
+
+class ShmLink {
+ public:
+  // Client side: a new segment with two rings of ring_bytes (a power of two).
+  static std::unique_ptr<ShmLink> Create(size_t ring_bytes);
+  // Server side: maps a client's segment. Owns the fds even on failure.
+  static std::unique_ptr<ShmLink> Adopt(int memfd, int server_wake, int client_wake,
+                                        size_t ring_bytes);
+  ~ShmLink();
+
+  // Client side: the hello, carrying the segment and both eventfds.
+  bool SendHello(int fd) const;
+  // Producer. Copies what fits and returns it; 0 means the ring is full and
+  // the consumer wakes this side once it has made room.
+  size_t Write(const struct iovec* iov, int count);
+  // Consumer. Up to capacity bytes; 0 when the ring is empty.
+  size_t Read(uint8_t* out, size_t capacity);
+  // This side's eventfd; cleared before the rings are looked at.
+  int wake_fd() const { return own_wake_; }
+  void ClearWake() const;
+
+ private:
+  // Positions count bytes since the segment was made; the peer's half is
+  // untrusted, so every access is masked into the ring.
+  struct RingHeader {
+    alignas(64) std::atomic<uint64_t> tail{0};
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint32_t> producer_waiting{0};
+  };
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared rings need lock-free atomics");
+
+  struct Ring {
+    RingHeader* header = nullptr;
+    uint8_t* data = nullptr;
+  };
+
+  ShmLink(int memfd, int own_wake, int peer_wake)
+      : memfd_(memfd), own_wake_(own_wake), peer_wake_(peer_wake) {}
+  static size_t SegmentBytes(size_t ring_bytes) { return 2 * (sizeof(RingHeader) + ring_bytes); }
+  bool Map(size_t ring_bytes, bool client);
+
+  void* base_ = MAP_FAILED;
+  size_t mapped_bytes_ = 0;
+  size_t mask_ = 0;
+  int memfd_ = -1;
+  int own_wake_ = -1;
+  int peer_wake_ = -1;
+  Ring tx_;
+  Ring rx_;
+};
+
+void SignalEventFd(int fd) {
+  const uint64_t one = 1;
+  ssize_t ignored = ::write(fd, &one, sizeof one);
+  (void)ignored;
+}
+
+std::unique_ptr<ShmLink> ShmLink::Create(size_t ring_bytes) {
+  const int memfd = memfd_create("qwormhole-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  const int server_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  const int client_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  std::unique_ptr<ShmLink> link(new ShmLink(memfd, client_wake, server_wake));
+  // Sealed, so the server can map it without fearing SIGBUS from a shrink.
+  if (memfd < 0 || server_wake < 0 || client_wake < 0 ||
+      ::ftruncate(memfd, static_cast<off_t>(SegmentBytes(ring_bytes))) != 0 ||
+      fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0 ||
+      !link->Map(ring_bytes, true)) {
+    return nullptr;
+  }
+  new (link->tx_.header) RingHeader();
+  new (link->rx_.header) RingHeader();
+  return link;
+}
+
+std::unique_ptr<ShmLink> ShmLink::Adopt(int memfd, int server_wake, int client_wake,
+                                        size_t ring_bytes) {
+  std::unique_ptr<ShmLink> link(new ShmLink(memfd, server_wake, client_wake));
+  struct stat st {};
+  const int seals = fcntl(memfd, F_GET_SEALS);
+  if (ring_bytes < kMinShmRingBytes || ring_bytes > kMaxShmRingBytes ||
+      (ring_bytes & (ring_bytes - 1)) != 0 || seals < 0 || (seals & F_SEAL_SHRINK) == 0 ||
+      fstat(memfd, &st) != 0 || static_cast<size_t>(st.st_size) != SegmentBytes(ring_bytes) ||
+      !link->Map(ring_bytes, false)) {
+    return nullptr;
+  }
+  return link;
+}
+
+// Ring 0 carries client to server, ring 1 the other way.
+bool ShmLink::Map(size_t ring_bytes, bool client) {
+  mapped_bytes_ = SegmentBytes(ring_bytes);
+  base_ = ::mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, memfd_, 0);
+  if (base_ == MAP_FAILED) return false;
+  mask_ = ring_bytes - 1;
+  auto* bytes = static_cast<uint8_t*>(base_);
+  Ring rings[2];
+  for (size_t i = 0; i < 2; ++i) {
+    uint8_t* at = bytes + i * (sizeof(RingHeader) + ring_bytes);
+    rings[i].header = reinterpret_cast<RingHeader*>(at);
+    rings[i].data = at + sizeof(RingHeader);
+  }
+  tx_ = rings[client ? 0 : 1];
+  rx_ = rings[client ? 1 : 0];
+  return true;
+}
+
+ShmLink::~ShmLink() {
+  if (base_ != MAP_FAILED) ::munmap(base_, mapped_bytes_);
+  for (int fd : {memfd_, own_wake_, peer_wake_}) {
+    if (fd >= 0) ::close(fd);
+  }
+}
+
+bool ShmLink::SendHello(int fd) const {
+  uint8_t hello[kShmHelloBytes] = {};
+  std::memcpy(hello, kShmHelloMagic, sizeof kShmHelloMagic);
+  const uint32_t ring_bytes = static_cast<uint32_t>(mask_ + 1);
+  std::memcpy(hello + sizeof kShmHelloMagic, &ring_bytes, sizeof ring_bytes);
+  const int fds[3] = {memfd_, peer_wake_, own_wake_};
+  struct iovec iov {hello, sizeof hello};
+  alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof fds)] = {};
+  struct msghdr msg {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof control;
+  struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+  cm->cmsg_level = SOL_SOCKET;
+  cm->cmsg_type = SCM_RIGHTS;
+  cm->cmsg_len = CMSG_LEN(sizeof fds);
+  std::memcpy(CMSG_DATA(cm), fds, sizeof fds);
+  for (;;) {
+    const ssize_t sent = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR) continue;
+    return sent == static_cast<ssize_t>(sizeof hello);
+  }
+}
+
+// The fences pair each side's store of its own position with its load of
+// the other's, so a consumer that found the ring empty is always woken by
+// the write that fills it, and a stalled producer by the read that drains it.
+size_t ShmLink::Write(const struct iovec* iov, int count) {
+  RingHeader& ring = *tx_.header;
+  const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+  const size_t capacity = mask_ + 1;
+  auto room = [&]() {
+    const uint64_t used = tail - ring.head.load(std::memory_order_acquire);
+    return used >= capacity ? size_t{0} : static_cast<size_t>(capacity - used);
+  };
+  size_t free_bytes = room();
+  if (free_bytes == 0) {
+    ring.producer_waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    free_bytes = room();
+    if (free_bytes == 0) return 0;
+  }
+  size_t written = 0;
+  for (int i = 0; i < count && written < free_bytes; ++i) {
+    const auto* src = static_cast<const uint8_t*>(iov[i].iov_base);
+    const size_t len = std::min(iov[i].iov_len, free_bytes - written);
+    const size_t at = static_cast<size_t>(tail + written) & mask_;
+    const size_t first = std::min(len, capacity - at);
+    std::memcpy(tx_.data + at, src, first);
+    std::memcpy(tx_.data, src + first, len - first);
+    written += len;
+  }
+  ring.tail.store(tail + written, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (ring.head.load(std::memory_order_relaxed) == tail) SignalEventFd(peer_wake_);
+  return written;
+}
+
+size_t ShmLink::Read(uint8_t* out, size_t capacity) {
+  RingHeader& ring = *rx_.header;
+  const uint64_t head = ring.head.load(std::memory_order_relaxed);
+  const uint64_t available = ring.tail.load(std::memory_order_acquire) - head;
+  const size_t len = static_cast<size_t>(std::min<uint64_t>({available, capacity, mask_ + 1}));
+  if (len == 0) return 0;
+  const size_t at = static_cast<size_t>(head) & mask_;
+  const size_t first = std::min(len, mask_ + 1 - at);
+  std::memcpy(out, rx_.data + at, first);
+  std::memcpy(out + first, rx_.data, len - first);
+  ring.head.store(head + len, std::memory_order_release);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (ring.producer_waiting.load(std::memory_order_relaxed) != 0 &&
+      ring.producer_waiting.exchange(0) != 0) {
+    SignalEventFd(peer_wake_);
+  }
+  return len;
+}
+
+void ShmLink::ClearWake() const {
+  uint64_t count = 0;
+  ssize_t ignored = ::read(own_wake_, &count, sizeof count);
+  (void)ignored;
+}
+
+#include "qwormhole_resolver_cache.h"
+
+// The interface's first address of a family, global before link-local.
+bool InterfaceAddress(const std::string& name, int family, struct sockaddr_storage* out) {
+  struct ifaddrs* list = nullptr;
+  if (getifaddrs(&list) != 0) return false;
+  bool found = false;
+  for (struct ifaddrs* it = list; it != nullptr; it = it->ifa_next) {
+    if (!it->ifa_addr || it->ifa_addr->sa_family != family || name != it->ifa_name) continue;
+    const bool link_local =
+        family == AF_INET6 &&
+        IN6_IS_ADDR_LINKLOCAL(&reinterpret_cast<struct sockaddr_in6*>(it->ifa_addr)->sin6_addr);
+    if (found && link_local) continue;
+    std::memcpy(out, it->ifa_addr,
+                family == AF_INET6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in));
+    found = true;
+    if (!link_local) break;
+  }
+  freeifaddrs(list);
+  return found;
+}
+
+// Called between socket() and connect(). An interface gets SO_BINDTODEVICE
+// where the process may set it (CAP_NET_RAW) and its address as the source
+// either way, which keeps routing on it; localAddress wins over that
+// address. False with errno set, e.g. EAFNOSUPPORT for a localAddress of
+// the other family, so the race moves on to the next address.
+bool BindLocal(int fd, int family, const LocalBinding& local) {
+  if (!local.any()) return true;
+  struct sockaddr_storage addr {};
+  addr.ss_family = static_cast<sa_family_t>(family);
+  if (!local.interface_name.empty()) {
+#if defined(SO_BINDTODEVICE)
+    setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, local.interface_name.c_str(),
+               static_cast<socklen_t>(local.interface_name.size()));
+#endif
+    if (local.address.empty() && !InterfaceAddress(local.interface_name, family, &addr)) {
+      errno = EADDRNOTAVAIL;
+      return false;
+    }
+  }
+  if (!local.address.empty()) {
+    void* raw = family == AF_INET6
+                    ? static_cast<void*>(&reinterpret_cast<struct sockaddr_in6*>(&addr)->sin6_addr)
+                    : static_cast<void*>(&reinterpret_cast<struct sockaddr_in*>(&addr)->sin_addr);
+    if (inet_pton(family, local.address.c_str(), raw) != 1) {
+      errno = EAFNOSUPPORT;
+      return false;
+    }
+  }
+  socklen_t len = sizeof(struct sockaddr_in);
+  if (family == AF_INET6) {
+    auto* in6 = reinterpret_cast<struct sockaddr_in6*>(&addr);
+    in6->sin6_port = htons(local.port);
+    if (IN6_IS_ADDR_LINKLOCAL(&in6->sin6_addr) && in6->sin6_scope_id == 0 &&
+        !local.interface_name.empty()) {
+      in6->sin6_scope_id = if_nametoindex(local.interface_name.c_str());
+    }
+    len = sizeof(struct sockaddr_in6);
+  } else {
+    reinterpret_cast<struct sockaddr_in*>(&addr)->sin_port = htons(local.port);
+  }
+  return ::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), len) == 0;
+}
+
+// RFC 8305 connection racing: a non-blocking connect to each address in
+// order, the next one delay_ms after the previous started (at once when it
+// fails), until one completes. The winner is returned connected; the
+// others are closed. Gives up on timeout_ms or once cancelled is set.
+// With fast_open, connect() returns at once and the SYN waits for the
+// first write, so the first address that takes a socket wins unraced.
+int HappyEyeballsConnect(std::vector<ResolvedAddress> addresses, uint16_t port,
+                         uint32_t delay_ms, uint32_t timeout_ms,
+                         const std::atomic<bool>& cancelled, const LocalBinding& local,
+                         bool fast_open, ConnectTrace* trace) {
+  using Clock = std::chrono::steady_clock;
+  const auto started = Clock::now();
+  const auto deadline = started + std::chrono::milliseconds(timeout_ms);
+  std::vector<struct pollfd> pending;
+  std::vector<size_t> pending_index;
+  auto close_pending = [&]() {
+    for (const auto& entry : pending) ::close(entry.fd);
+    pending.clear();
+    pending_index.clear();
+  };
+  auto won = [&](int fd, size_t index) {
+    trace->tcp_ms = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+    trace->address = FormatAddress(addresses[index]);
+    return fd;
+  };
+  int last_error = ECONNREFUSED;
+  size_t next = 0;
+  auto next_start = started;
+  for (;;) {
+    if (cancelled.load()) {
+      close_pending();
+      errno = ECANCELED;
+      return -1;
+    }
+    auto now = Clock::now();
+    if (next < addresses.size() && (now >= next_start || pending.empty())) {
+      ResolvedAddress& address = addresses[next];
+      if (address.addr.ss_family == AF_INET) {
+        reinterpret_cast<struct sockaddr_in*>(&address.addr)->sin_port = htons(port);
+      } else {
+        reinterpret_cast<struct sockaddr_in6*>(&address.addr)->sin6_port = htons(port);
+      }
+      trace->attempts += 1;
+      const int fd =
+          ::socket(address.addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+      // Best effort; ApplySocketTuning() reports whether the kernel took it.
+      if (fd >= 0 && fast_open) SetSocketInt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, 1);
+      if (fd < 0) {
+        last_error = errno;
+      } else if (!BindLocal(fd, address.addr.ss_family, local)) {
+        last_error = errno;
+        ::close(fd);
+        next_start = now;
+      } else if (::connect(fd, reinterpret_cast<struct sockaddr*>(&address.addr),
+                           address.len) == 0) {
+        close_pending();
+        return won(fd, next);
+      } else if (errno == EINPROGRESS) {
+        pending.push_back({fd, POLLOUT, 0});
+        pending_index.push_back(next);
+        next_start = now + std::chrono::milliseconds(delay_ms);
+      } else {
+        last_error = errno;
+        ::close(fd);
+        next_start = now;
+      }
+      next += 1;
+      continue;
+    }
+    if (pending.empty()) {
+      errno = last_error;
+      return -1;
+    }
+    if (now >= deadline) {
+      close_pending();
+      errno = ETIMEDOUT;
+      return -1;
+    }
+    // Short waits so a close() during the race is noticed promptly.
+    auto wake = std::min(deadline, now + std::chrono::milliseconds(50));
+    if (next < addresses.size()) wake = std::min(wake, next_start);
+    const int wait_ms = static_cast<int>(
+        std::chrono::ceil<std::chrono::milliseconds>(wake - now).count());
+    const int ready = ::poll(pending.data(), pending.size(), std::max(wait_ms, 0));
+    if (ready < 0 && errno != EINTR) {
+      last_error = errno;
+      close_pending();
+      errno = last_error;
+      return -1;
+    }
+    for (size_t i = 0; ready > 0 && i < pending.size();) {
+      if (pending[i].revents == 0) {
+        ++i;
+        continue;
+      }
+      int so_error = 0;
+      socklen_t len = sizeof so_error;
+      if (getsockopt(pending[i].fd, SOL_SOCKET, SO_ERROR, &so_error, &len) != 0) {
+        so_error = errno;
+      }
+      if (so_error == 0) {
+        const int fd = pending[i].fd;
+        const size_t index = pending_index[i];
+        pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(i));
+        pending_index.erase(pending_index.begin() + static_cast<std::ptrdiff_t>(i));
+        close_pending();
+        return won(fd, index);
+      }
+      last_error = so_error;
+      ::close(pending[i].fd);
+      pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(i));
+      pending_index.erase(pending_index.begin() + static_cast<std::ptrdiff_t>(i));
+      next_start = Clock::now();
+    }
+  }
+}
+
+// listenBacklog / tcpFastOpen / deferAcceptSecs: the listen(2) backlog
+// (the kernel caps it at net.core.somaxconn), the TCP_FASTOPEN queue for
+// SYNs carrying data, and how long TCP_DEFER_ACCEPT holds a connection
+// back until its first bytes arrive. 0 leaves the last two off.
+struct ListenTuning {
+  int backlog = SOMAXCONN;
+  int fast_open_queue = 0;
+  int defer_accept_secs = 0;
 };
 
+ListenTuning ParseListenTuning(const Napi::Object& options) {
+  ListenTuning tuning;
+  const auto read_int = [&options](const char* key, int* out, int64_t min) {
+    if (options.Has(key) && options.Get(key).IsNumber()) {
+      *out = static_cast<int>(
+          std::clamp<int64_t>(options.Get(key).As<Napi::Number>().Int64Value(), min, INT32_MAX));
+    }
+  };
+  read_int("listenBacklog", &tuning.backlog, 1);
+  read_int("tcpFastOpen", &tuning.fast_open_queue, 0);
+  read_int("deferAcceptSecs", &tuning.defer_accept_secs, 0);
+  return tuning;
+}
+
+int ListenUnixStream(const std::string& path, int backlog) {
+  if (path[0] != '\0') {
+    // Unlinks a stale socket file first.
+    const int fd = create_unix_server_socket(path.c_str(), LIBSOCKET_STREAM,
+                                             SOCK_NONBLOCK | SOCK_CLOEXEC);
+    // listen() again only resizes the queue libsocket set up.
+    if (fd >= 0) ::listen(fd, backlog);
+    return fd;
+  }
+  struct sockaddr_un addr;
+  socklen_t len = 0;
+  if (!FillAbstractAddress(path, &addr, &len)) return -1;
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+  if (::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), len) != 0 ||
+      ::listen(fd, backlog) != 0) {
+    const int saved_errno = errno;
+    ::close(fd);
+    errno = saved_errno;
+    return -1;
+  }
+  return fd;
+}
+
+// create_inet_server_socket() binds before a caller could set SO_REUSEADDR,
+// so a restarted server would trip over its own TIME_WAIT sockets.
+// reusePortSteering: "cpu". Picks group member `cpu % group_size`, so a
+// connection lands on the shard pinned to the CPU that took its interrupt
+// rather than wherever the 4-tuple hash sends it. Attaching to one member
+// applies to the whole group.
+bool AttachReusePortCpuSteering(int fd, uint32_t group_size) {
+#if defined(SO_ATTACH_REUSEPORT_CBPF)
+  struct sock_filter code[] = {
+      {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+      {BPF_ALU | BPF_MOD | BPF_K, 0, 0, group_size},
+      {BPF_RET | BPF_A, 0, 0, 0},
+  };
+  struct sock_fprog prog {};
+  prog.len = static_cast<unsigned short>(sizeof code / sizeof code[0]);
+  prog.filter = code;
+  return setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof prog) == 0;
+#else
+  (void)fd;
+  (void)group_size;
+  return false;
+#endif
+}
+
+// host "" listens on "::" (falling back to 0.0.0.0 without kernel IPv6),
+// "0.0.0.0" stays IPv4 only, as in Node. An IPv6 listener is dual-stack
+// unless ipv6_only, set explicitly so net.ipv6.bindv6only does not decide.
+// Fast open and deferred accept are best effort, set before listen(): a
+// kernel without them still gets a working listener.
+int ListenInetStream(const std::string& host, uint16_t port, bool reuse_port,
+                     const ListenTuning& tuning, uint32_t cpu_steering_group = 0,
+                     bool ipv6_only = false) {
+  if (host.empty()) {
+    const int fd =
+        ListenInetStream("::", port, reuse_port, tuning, cpu_steering_group, ipv6_only);
+    if (fd >= 0 || ipv6_only || errno != EAFNOSUPPORT) return fd;
+    return ListenInetStream("0.0.0.0", port, reuse_port, tuning, cpu_steering_group);
+  }
+  struct addrinfo hints {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+  struct addrinfo* result = nullptr;
+  const std::string service = std::to_string(port);
+  const int rc = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &result);
+  if (rc != 0) {
+    errno = EADDRNOTAVAIL;
+    return -1;
+  }
+  int fd = -1;
+  int saved_errno = EADDRNOTAVAIL;
+  for (struct addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+    fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                  ai->ai_protocol);
+    if (fd < 0) {
+      saved_errno = errno;
+      continue;
+    }
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof one);
+    if (reuse_port) {
+      setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof one);
+    }
+    if (ai->ai_family == AF_INET6) {
+      const int v6only = ipv6_only ? 1 : 0;
+      setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof v6only);
+    }
+    if (tuning.fast_open_queue > 0) {
+      SetSocketInt(fd, IPPROTO_TCP, TCP_FASTOPEN, tuning.fast_open_queue);
+    }
+    if (tuning.defer_accept_secs > 0) {
+      SetSocketInt(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, tuning.defer_accept_secs);
+    }
+    if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, tuning.backlog) == 0) {
+      // Best effort, like SO_REUSEPORT itself: without it the hash decides.
+      if (reuse_port && cpu_steering_group > 0) {
+        AttachReusePortCpuSteering(fd, cpu_steering_group);
+      }
+      break;
+    }
+    saved_errno = errno;
+    ::close(fd);
+    fd = -1;
+  }
+  ::freeaddrinfo(result);
+  if (fd < 0) errno = saved_errno;
+  return fd;
+}
+
+void SocketReactor::Run() {
+  std::vector<struct epoll_event> events(256);
+  for (;;) {
+    const int ready = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), -1);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+    for (int i = 0; i < ready; ++i) {
+      const int fd = events[i].data.fd;
+      if (fd == wake_fd_) {
+        uint64_t count = 0;
+        ssize_t ignored = ::read(wake_fd_, &count, sizeof count);
+        (void)ignored;
+        continue;
+      }
+      auto it = channels_.find(fd);
+      if (it == channels_.end()) continue;
+      std::shared_ptr<SocketChannel> channel(it->second);
+      if (channel->shm && fd == channel->shm->wake_fd()) {
+        RingReady(channel);
+      } else {
+        Dispatch(channel, events[i].events);
+      }
+    }
+    RunCommands();
+  }
+}
+
+void SocketReactor::RunCommands() {
+  std::deque<std::function<void()>> ready;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready.swap(commands_);
+  }
+  for (auto& command : ready) {
+    command();
+  }
+}
+
+void SocketReactor::Attach(const std::shared_ptr<SocketChannel>& channel) {
+  channel->attached = true;
+  // A connect that is still in progress reports completion as writable.
+  channel->want_write = true;
+  struct epoll_event ev {};
+  ev.events = EPOLLOUT;
+  ev.data.fd = channel->fd;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, channel->fd, &ev) != 0) {
+    Teardown(channel, std::string("epoll_ctl failed: ") + std::strerror(errno));
+    return;
+  }
+  channels_[channel->fd] = channel;
+  if (channel->shm) {
+    struct epoll_event wake {};
+    wake.events = EPOLLIN;
+    wake.data.fd = channel->shm->wake_fd();
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake.data.fd, &wake) != 0) {
+      Teardown(channel, std::string("epoll_ctl failed: ") + std::strerror(errno));
+      return;
+    }
+    channels_[wake.data.fd] = channel;
+  }
+}
+
+void SocketReactor::Update(SocketChannel* channel) {
+  if (!channel->attached || channel->finished) return;
+  struct epoll_event ev {};
+  if (channel->connected_io && !channel->rx_paused) ev.events |= EPOLLIN | EPOLLRDHUP;
+  // A full ring is waited out on the wake eventfd instead.
+  if (channel->want_write && !(channel->shm && channel->connected_io)) ev.events |= EPOLLOUT;
+  ev.data.fd = channel->fd;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, channel->fd, &ev);
+}
+
+void SocketReactor::Teardown(const std::shared_ptr<SocketChannel>& channel,
+                             std::optional<std::string> error) {
+  if (channel->finished) return;
+  channel->finished = true;
+  channel->connected = false;
+  channel->closing = true;
+  if (channel->attached) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, channel->fd, nullptr);
+    channels_.erase(channel->fd);
+    if (channel->shm) {
+      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, channel->shm->wake_fd(), nullptr);
+      channels_.erase(channel->shm->wake_fd());
+    }
+    std::lock_guard<std::mutex> lock(channel->mutex);
+    ::close(channel->fd);
+    channel->fd = -1;
+    channel->shm.reset();
+  }
+  const bool had_error = error.has_value();
+  if (error) {
+    PostEvent(channel, "error", {}, std::move(error));
+  }
+  PostEvent(channel, "close", {}, std::nullopt, had_error);
+  std::lock_guard<std::mutex> lock(channel->events_mutex);
+  channel->events_closed = true;
+  channel->tsfn.Release();
+}
+
+void SocketReactor::Dispatch(const std::shared_ptr<SocketChannel>& channel,
+                             uint32_t events) {
+  if (!channel->connected_io) {
+    FinishConnect(channel);
+    return;
+  }
+  if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+    ReadAvailable(channel);
+  }
+  if (!channel->finished && (events & EPOLLOUT)) {
+    Flush(channel);
+  }
+}
+
+void SocketReactor::FinishConnect(const std::shared_ptr<SocketChannel>& channel) {
+  int so_error = 0;
+  socklen_t len = sizeof so_error;
+  if (getsockopt(channel->fd, SOL_SOCKET, SO_ERROR, &so_error, &len) != 0) {
+    so_error = errno;
+  }
+  if (so_error != 0) {
+    Teardown(channel, std::string("connect failed: ") + std::strerror(so_error));
+    return;
+  }
+  channel->connected_io = true;
+  channel->connected = true;
+  Update(channel.get());
+  PostEvent(channel, "connect");
+  // Sends issued while connecting go out now.
+  if (channel->shm) {
+    RingReady(channel);
+  } else {
+    Flush(channel);
+  }
+}
+
+void SocketReactor::ReadAvailable(const std::shared_ptr<SocketChannel>& channel) {
+  for (int i = 0; i < kMaxReadsPerEvent; ++i) {
+    if (channel->rx_inflight.load() >= channel->rx_high_water) {
+      channel->rx_paused = true;
+      Update(channel.get());
+      return;
+    }
+    std::vector<uint8_t> chunk(kReadChunkBytes);
+    const ssize_t n = ::recv(channel->fd, chunk.data(), chunk.size(), 0);
+    if (n > 0) {
+      if (channel->tuning.quick_ack) SetSocketInt(channel->fd, IPPROTO_TCP, TCP_QUICKACK, 1);
+      chunk.resize(static_cast<size_t>(n));
+      channel->rx_inflight.fetch_add(chunk.size());
+      PostEvent(channel, "data", std::move(chunk));
+      if (static_cast<size_t>(n) < kReadChunkBytes) return;
+      continue;
+    }
+    if (n == 0) {
+      // The server is gone; what it left in the ring is still delivered.
+      if (channel->shm) ReadRing(channel, true);
+      Teardown(channel, std::nullopt);
+      return;
+    }
+    if (errno == EINTR) continue;
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      Teardown(channel, std::string("recv failed: ") + std::strerror(errno));
+    }
+    return;
+  }
+}
+
+// sharedMemory: the server wrote into an empty ring or made room in a full one.
+void SocketReactor::RingReady(const std::shared_ptr<SocketChannel>& channel) {
+  channel->shm->ClearWake();
+  if (!channel->connected_io || channel->finished) return;
+  ReadRing(channel);
+  if (!channel->finished) Flush(channel);
+}
+
+// ReadAvailable for the ring: the same chunks, per-event cap and
+// rxHighWaterMark pause; past the cap the rest waits for the next pass.
+void SocketReactor::ReadRing(const std::shared_ptr<SocketChannel>& channel, bool drain) {
+  for (int i = 0; drain || i < kMaxReadsPerEvent; ++i) {
+    if (channel->finished) return;
+    if (!drain && channel->rx_inflight.load() >= channel->rx_high_water) {
+      channel->rx_paused = true;
+      Update(channel.get());
+      return;
+    }
+    std::vector<uint8_t> chunk(kReadChunkBytes);
+    const size_t n = channel->shm->Read(chunk.data(), chunk.size());
+    if (n == 0) return;
+    chunk.resize(n);
+    channel->rx_inflight.fetch_add(n);
+    PostEvent(channel, "data", std::move(chunk));
+  }
+  Post([this, channel]() {
+    if (channel->shm && !channel->rx_paused) ReadRing(channel);
+  });
+}
+
+void SocketReactor::Flush(const std::shared_ptr<SocketChannel>& channel) {
+  if (!channel->connected_io || channel->finished) return;
+  {
+    std::lock_guard<std::mutex> lock(channel->mutex);
+    while (!channel->tx.empty()) {
+      channel->tx_pending.push_back(std::move(channel->tx.front()));
+      channel->tx.pop_front();
+    }
+  }
+  while (!channel->tx_pending.empty()) {
+    struct iovec iov[kMaxIovPerWrite];
+    int count = 0;
+    size_t offset = channel->tx_offset;
+    for (auto it = channel->tx_pending.begin();
+         it != channel->tx_pending.end() && count < kMaxIovPerWrite; ++it, ++count) {
+      iov[count].iov_base = it->data() + offset;
+      iov[count].iov_len = it->size() - offset;
+      offset = 0;
+    }
+    ssize_t sent = 0;
+    if (channel->shm) {
+      // Full: the server's next read wakes RingReady.
+      sent = static_cast<ssize_t>(channel->shm->Write(iov, count));
+      if (sent == 0) break;
+    } else {
+      struct msghdr msg {};
+      msg.msg_iov = iov;
+      msg.msg_iovlen = static_cast<size_t>(count);
+      sent = ::sendmsg(channel->fd, &msg, MSG_NOSIGNAL);
+      if (sent < 0) {
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        Teardown(channel, std::string("send failed: ") + std::strerror(errno));
+        return;
+      }
+    }
+    channel->queued_bytes.fetch_sub(static_cast<size_t>(sent));
+    size_t remaining = static_cast<size_t>(sent);
+    while (remaining > 0) {
+      auto& front = channel->tx_pending.front();
+      const size_t left = front.size() - channel->tx_offset;
+      if (remaining < left) {
+        channel->tx_offset += remaining;
+        break;
+      }
+      remaining -= left;
+      channel->tx_pending.pop_front();
+      channel->tx_offset = 0;
+    }
+  }
+  const bool want_write = !channel->tx_pending.empty();
+  if (want_write != channel->want_write) {
+    channel->want_write = want_write;
+    Update(channel.get());
+  }
+  if (!want_write && channel->backpressured.load() &&
+      channel->queued_bytes.load() < channel->max_backpressure_bytes &&
+      channel->backpressured.exchange(false)) {
+    PostEvent(channel, "drain");
+  }
+}
+
 Napi::Object TcpClientWrapper::Init(Napi::Env env, Napi::Object exports) {
   Napi::Function func = DefineClass(
       env, "TcpClientWrapper",
       {
           InstanceMethod<&TcpClientWrapper::Connect>("connect"),
           InstanceMethod<&TcpClientWrapper::Send>("send"),
+          InstanceMethod<&TcpClientWrapper::SendMany>("sendMany"),
+          InstanceMethod<&TcpClientWrapper::SendV>("sendv"),
           InstanceMethod<&TcpClientWrapper::Recv>("recv"),
+          InstanceMethod<&TcpClientWrapper::RecvInto>("recvInto"),
+          InstanceMethod<&TcpClientWrapper::IsConnected>("isConnected"),
+          InstanceMethod<&TcpClientWrapper::SetEventHandler>("setEventHandler"),
+          InstanceMethod<&TcpClientWrapper::GetSocketOptions>("getSocketOptions"),
+          InstanceMethod<&TcpClientWrapper::GetConnectTimings>("getConnectTimings"),
           InstanceMethod<&TcpClientWrapper::Close>("close"),
       });
 
@@ -35,100 +1175,6875 @@ Napi::Object TcpClientWrapper::Init(Napi::Env env, Napi::Object exports) {
 TcpClientWrapper::TcpClientWrapper(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<TcpClientWrapper>(info) {}
 
+// Only reached without a live connection (one holds a reference), or at
+// environment teardown.
+TcpClientWrapper::~TcpClientWrapper() {
+  if (channel_) {
+    channel_->owner = nullptr;
+    if (!channel_->closing.exchange(true)) {
+      auto channel = channel_;
+      SocketReactor::Instance().Post(
+          [channel]() { SocketReactor::Instance().Teardown(channel, std::nullopt); });
+    }
+  }
+}
+
+// Resolves once the connection is up; DNS and the TCP handshake never block
+// the JS thread. Also emits "connect", or "error" + "close" on failure.
+// Hosts resolve through ResolverCache (dnsCacheTtlMs, 0 to bypass it) and
+// their IPv6 and IPv4 addresses race per RFC 8305 (happyEyeballsDelayMs
+// between attempts, connectTimeoutMs for the whole race).
+// options.path connects a Unix stream socket instead; a leading "@" or NUL
+// names a socket in the Linux abstract namespace.
 Napi::Value TcpClientWrapper::Connect(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+  std::string host;
+  std::string unix_path;
+  uint32_t port_num = 0;
+  auto channel = std::make_shared<SocketChannel>();
+  if (info.Length() >= 1 && info[0].IsObject() && !info[0].IsString()) {
+    Napi::Object obj = info[0].As<Napi::Object>();
+    if (obj.Has("path") && obj.Get("path").IsString()) {
+      unix_path = obj.Get("path").As<Napi::String>().Utf8Value();
+      if (unix_path.empty()) {
+        Napi::TypeError::New(env, "options.path must not be empty").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      if (unix_path[0] == '@') unix_path[0] = '\0';
+    } else if (!obj.Has("host") || !obj.Get("host").IsString() || !obj.Has("port") ||
+               !obj.Get("port").IsNumber()) {
+      Napi::TypeError::New(env, "options.host and options.port (or options.path) required")
+          .ThrowAsJavaScriptException();
+      return env.Null();
+    } else {
+      host = obj.Get("host").As<Napi::String>().Utf8Value();
+      port_num = obj.Get("port").As<Napi::Number>().Uint32Value();
+    }
+    if (obj.Has("maxBackpressureBytes") && obj.Get("maxBackpressureBytes").IsNumber()) {
+      const auto limit = obj.Get("maxBackpressureBytes").As<Napi::Number>().Int64Value();
+      if (limit > 0) channel->max_backpressure_bytes = static_cast<size_t>(limit);
+    }
+    if (obj.Has("rxHighWaterMark") && obj.Get("rxHighWaterMark").IsNumber()) {
+      const auto mark = obj.Get("rxHighWaterMark").As<Napi::Number>().Int64Value();
+      if (mark > 0) channel->rx_high_water = static_cast<size_t>(mark);
+    }
+    if (obj.Has("dnsCacheTtlMs") && obj.Get("dnsCacheTtlMs").IsNumber()) {
+      const double ttl = obj.Get("dnsCacheTtlMs").As<Napi::Number>().DoubleValue();
+      channel->dns_cache_ttl_ms =
+          ttl > 0 ? static_cast<uint32_t>(std::min(ttl, 86400.0 * 1000)) : 0;
+    }
+    if (obj.Has("happyEyeballsDelayMs") && obj.Get("happyEyeballsDelayMs").IsNumber()) {
+      const double delay = obj.Get("happyEyeballsDelayMs").As<Napi::Number>().DoubleValue();
+      channel->happy_eyeballs_delay_ms = static_cast<uint32_t>(
+          std::clamp(delay, double{kMinHappyEyeballsDelayMs}, double{kMaxHappyEyeballsDelayMs}));
+    }
+    if (obj.Has("connectTimeoutMs") && obj.Get("connectTimeoutMs").IsNumber()) {
+      const double timeout = obj.Get("connectTimeoutMs").As<Napi::Number>().DoubleValue();
+      if (timeout > 0) {
+        channel->connect_timeout_ms = static_cast<uint32_t>(std::min(timeout, 3600.0 * 1000));
+      }
+    }
+    if (obj.Has("interfaceName") && obj.Get("interfaceName").IsString()) {
+      channel->local.interface_name = obj.Get("interfaceName").As<Napi::String>().Utf8Value();
+    }
+    if (obj.Has("localAddress") && obj.Get("localAddress").IsString()) {
+      channel->local.address = obj.Get("localAddress").As<Napi::String>().Utf8Value();
+    }
+    if (obj.Has("localPort") && obj.Get("localPort").IsNumber()) {
+      channel->local.port =
+          static_cast<uint16_t>(obj.Get("localPort").As<Napi::Number>().Uint32Value());
+    }
+    channel->tuning = ParseSocketTuning(obj);
+    // sharedMemory: true or { ringBytes }, rounded up to a power of two.
+    Napi::Value shm = obj.Get("sharedMemory");
+    if (!unix_path.empty() && (shm.IsObject() || (shm.IsBoolean() && shm.As<Napi::Boolean>()))) {
+      size_t ring_bytes = kDefaultShmRingBytes;
+      if (shm.IsObject() && shm.As<Napi::Object>().Get("ringBytes").IsNumber()) {
+        const double asked = shm.As<Napi::Object>().Get("ringBytes").As<Napi::Number>().DoubleValue();
+        ring_bytes = static_cast<size_t>(
+            std::clamp(asked, double{kMinShmRingBytes}, double{kMaxShmRingBytes}));
+      }
+      channel->shm_ring_bytes = kMinShmRingBytes;
+      while (channel->shm_ring_bytes < ring_bytes) channel->shm_ring_bytes <<= 1;
+    }
+  } else if (info.Length() >= 2 && info[0].IsString() && info[1].IsNumber()) {
+    host = info[0].As<Napi::String>().Utf8Value();
+    port_num = info[1].As<Napi::Number>().Uint32Value();
+  } else {
     Napi::TypeError::New(env, "connect(host: string, port: number) required").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  std::string host = info[0].As<Napi::String>();
-  auto port_num = info[1].As<Napi::Number>().Uint32Value();
-  std::string port = std::to_string(port_num);
+  if (channel_ && !channel_->closing) {
+    Napi::Error::New(env, "Client already connected").ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
-  try {
-    client_.connect(host, port, LIBSOCKET_IPv4, 0);
-  } catch (const libsocket::socket_exception& ex) {
-    Napi::Error::New(env, ex.mesg).ThrowAsJavaScriptException();
-  } catch (const std::exception& ex) {
-    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+  channel->owner = this;
+  channel->tsfn = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+      "QWormholeLibsocketEvents", 0, 1);
+  channel_ = channel;
+  recv_queue_.clear();
+  recv_offset_ = 0;
+  // Held until "close" is delivered so GC cannot collect a live socket.
+  Ref();
+
+  if (pending_connect_) {
+    pending_connect_->Reject(Napi::Error::New(env, "Client closed during connect").Value());
   }
+  auto deferred = Napi::Promise::Deferred::New(env);
+  pending_connect_ = deferred;
 
-  return env.Undefined();
+  std::string target;
+  if (unix_path.empty()) {
+    target = host + ":" + std::to_string(port_num);
+  } else {
+    target = unix_path[0] == '\0' ? "@" + unix_path.substr(1) : unix_path;
+  }
+  channel->connect_started = std::chrono::steady_clock::now();
+  std::thread([channel, host, port = static_cast<uint16_t>(port_num), unix_path, target]() {
+    // A Unix connect completes (or fails) immediately.
+    errno = 0;
+    int fd = -1;
+    std::string resolve_error;
+    if (unix_path.empty()) {
+      ConnectTrace trace;
+      const auto started = std::chrono::steady_clock::now();
+      ResolverCache::Result resolved =
+          ResolverCache::Instance().Resolve(host, channel->dns_cache_ttl_ms);
+      trace.dns_ms =
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started)
+              .count();
+      trace.dns_cached = resolved.cached;
+      const std::string& interface_name = channel->local.interface_name;
+      if (resolved.addresses.empty()) {
+        resolve_error = gai_strerror(resolved.error);
+      } else if (!interface_name.empty() && if_nametoindex(interface_name.c_str()) == 0) {
+        resolve_error = "interface " + interface_name + " not found";
+      } else {
+        fd = HappyEyeballsConnect(std::move(resolved.addresses), port,
+                                  channel->happy_eyeballs_delay_ms, channel->connect_timeout_ms,
+                                  channel->closing, channel->local,
+                                  channel->tuning.fast_open, &trace);
+      }
+      const int race_errno = errno;
+      trace.total_ms = std::chrono::duration<double, std::milli>(
+                           std::chrono::steady_clock::now() - channel->connect_started)
+                           .count();
+      {
+        std::lock_guard<std::mutex> lock(channel->mutex);
+        channel->connect_trace = std::move(trace);
+      }
+      errno = race_errno;
+    } else {
+      fd = ConnectUnixStream(unix_path);
+      if (fd >= 0 && channel->shm_ring_bytes > 0) {
+        std::shared_ptr<ShmLink> link = ShmLink::Create(channel->shm_ring_bytes);
+        if (!link || !link->SendHello(fd)) {
+          resolve_error = std::string("shared memory setup failed: ") + std::strerror(errno);
+          ::close(fd);
+          fd = -1;
+        } else {
+          std::lock_guard<std::mutex> lock(channel->mutex);
+          channel->shm = std::move(link);
+        }
+      }
+    }
+    const int saved_errno = errno;
+    // The SYN is already out, so buffer sizes no longer shape the window
+    // scale; the rest applies as it would have before connect().
+    if (fd >= 0 && unix_path.empty() && channel->tuning.any()) {
+      SocketTuningReport report = ApplySocketTuning(fd, channel->tuning);
+      std::lock_guard<std::mutex> lock(channel->mutex);
+      channel->socket_report = std::move(report);
+    }
+    SocketReactor::Instance().Post([channel, fd, saved_errno, target, resolve_error]() {
+      auto& reactor = SocketReactor::Instance();
+      if (fd < 0) {
+        std::string error = "Could not connect to " + target;
+        if (!resolve_error.empty()) {
+          error += ": " + resolve_error;
+        } else if (saved_errno != 0) {
+          error += std::string(": ") + std::strerror(saved_errno);
+        }
+        reactor.Teardown(channel, error);
+        return;
+      }
+      if (channel->finished) {
+        ::close(fd);
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(channel->mutex);
+        channel->fd = fd;
+      }
+      reactor.Attach(channel);
+    });
+  }).detach();
+
+  return deferred.Promise();
 }
 
-Napi::Value TcpClientWrapper::Send(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+void TcpClientWrapper::DeliverEvent(SocketChannel* from,
+                                    const std::string& type,
+                                    std::vector<uint8_t> data,
+                                    std::optional<std::string> error,
+                                    bool had_error,
+                                    size_t queued_bytes) {
+  // Each connection holds one reference until its "close" arrives.
+  if (type == "close") {
+    Unref();
+  }
+  if (from != channel_.get()) {
+    return;
+  }
+  Napi::Env env = Value().Env();
+  if (type == "connect" && pending_connect_) {
+    pending_connect_->Resolve(env.Undefined());
+    pending_connect_.reset();
+  } else if ((type == "error" || type == "close") && pending_connect_) {
+    pending_connect_->Reject(
+        Napi::Error::New(env, error.value_or("Client closed during connect")).Value());
+    pending_connect_.reset();
+  }
 
-  if (info.Length() < 1) {
-    Napi::TypeError::New(env, "send(data: Buffer|string) required").ThrowAsJavaScriptException();
-    return env.Null();
+  if (type == "data" && handler_.IsEmpty()) {
+    // Counted against rxHighWaterMark until recv() takes it.
+    recv_queue_.push_back(std::move(data));
+    return;
+  }
+  if (type == "data") {
+    ReleaseRx(channel_, data.size());
   }
 
-  try {
-    if (info[0].IsBuffer()) {
-      auto buf = info[0].As<Napi::Buffer<char>>();
-      client_.snd(buf.Data(), buf.Length());
-    } else {
-      std::string data = info[0].ToString();
-      client_.snd(data.data(), data.size());
+  if (!handler_.IsEmpty()) {
+    Napi::Object evt = Napi::Object::New(env);
+    evt.Set("type", Napi::String::New(env, type));
+    if (type == "data") {
+      evt.Set("data", Napi::Buffer<uint8_t>::Copy(env, data.data(), data.size()));
+    }
+    if (error) {
+      evt.Set("error", Napi::String::New(env, *error));
     }
-  } catch (const libsocket::socket_exception& ex) {
-    Napi::Error::New(env, ex.mesg).ThrowAsJavaScriptException();
-  } catch (const std::exception& ex) {
-    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    if (type == "close") {
+      evt.Set("hadError", Napi::Boolean::New(env, had_error));
+    }
+    if (type == "backpressure") {
+      evt.Set("queuedBytes", static_cast<double>(queued_bytes));
+      evt.Set("threshold", static_cast<double>(channel_->max_backpressure_bytes));
+    }
+    handler_.Value().Call({evt});
   }
-
-  return env.Undefined();
 }
 
-Napi::Value TcpClientWrapper::Recv(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+// Writes straight from the caller's memory while the socket is idle; only
+// what the kernel does not take is copied into the queue for the reactor.
+void TcpClientWrapper::Write(const struct iovec* iov, size_t count) {
+  size_t skip = 0;
+  bool first = false;
+  {
+    std::lock_guard<std::mutex> lock(channel_->mutex);
+    if (channel_->fd >= 0 && channel_->connected && channel_->queued_bytes.load() == 0) {
+      size_t index = 0;
+      while (index < count) {
+        struct iovec batch[kMaxIovPerWrite];
+        const size_t n = std::min<size_t>(count - index, kMaxIovPerWrite);
+        for (size_t i = 0; i < n; ++i) {
+          batch[i] = iov[index + i];
+        }
+        if (skip > 0) {
+          batch[0].iov_base = static_cast<uint8_t*>(batch[0].iov_base) + skip;
+          batch[0].iov_len -= skip;
+        }
+        ssize_t sent = 0;
+        if (channel_->shm) {
+          sent = static_cast<ssize_t>(channel_->shm->Write(batch, static_cast<int>(n)));
+          if (sent == 0) break;
+        } else {
+          struct msghdr msg {};
+          msg.msg_iov = batch;
+          msg.msg_iovlen = n;
+          sent = ::sendmsg(channel_->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+          if (sent < 0) {
+            if (errno == EINTR) continue;
+            // EAGAIN, or an error the reactor reports when it retries.
+            break;
+          }
+        }
+        size_t remaining = static_cast<size_t>(sent) + skip;
+        while (index < count && remaining >= iov[index].iov_len) {
+          remaining -= iov[index].iov_len;
+          index++;
+        }
+        skip = remaining;
+      }
+      iov += index;
+      count -= index;
+      if (count == 0) return;
+    }
+    first = channel_->tx.empty();
+    for (size_t i = 0; i < count; ++i) {
+      const auto* data = static_cast<const uint8_t*>(iov[i].iov_base) + (i == 0 ? skip : 0);
+      const size_t len = iov[i].iov_len - (i == 0 ? skip : 0);
+      if (len == 0) continue;
+      channel_->queued_bytes.fetch_add(len);
+      channel_->tx.emplace_back(data, data + len);
+    }
+  }
+  // Later sends ride on the flush the first one scheduled.
+  if (first) {
+    auto channel = channel_;
+    SocketReactor::Instance().Post([channel]() { SocketReactor::Instance().Flush(channel); });
+  }
+}
 
-  size_t length = 4096;
-  if (info.Length() >= 1 && info[0].IsNumber()) {
-    length = info[0].As<Napi::Number>().Uint32Value();
+// Mirrors the lws client: false once queued bytes reach maxBackpressureBytes,
+// with "backpressure" now and "drain" once the queue is flushed.
+bool TcpClientWrapper::UpdateBackpressure() {
+  const size_t queued = channel_->queued_bytes.load();
+  if (queued < channel_->max_backpressure_bytes) {
+    return true;
   }
+  if (!channel_->backpressured.exchange(true)) {
+    PostEvent(channel_, "backpressure", {}, std::nullopt, false, queued);
+  }
+  return false;
+}
 
-  std::string buffer;
-  buffer.resize(length);
+Napi::Value TcpClientWrapper::Send(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
 
-  ssize_t received = 0;
-  try {
-    received = client_.rcv(&buffer[0], length, 0);
-  } catch (const libsocket::socket_exception& ex) {
-    Napi::Error::New(env, ex.mesg).ThrowAsJavaScriptException();
+  if (!channel_ || channel_->closing) {
+    Napi::Error::New(env, "Client is not connected").ThrowAsJavaScriptException();
     return env.Null();
-  } catch (const std::exception& ex) {
-    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+  }
+
+  if (info.Length() < 1) {
+    Napi::TypeError::New(env, "send(data: Buffer|string) required").ThrowAsJavaScriptException();
     return env.Null();
   }
 
-  if (received <= 0) {
-    return Napi::Buffer<char>::New(env, 0);
+  std::string text;
+  struct iovec iov {};
+  if (info[0].IsBuffer()) {
+    auto buf = info[0].As<Napi::Buffer<uint8_t>>();
+    iov.iov_base = buf.Data();
+    iov.iov_len = buf.Length();
+  } else {
+    text = info[0].ToString().Utf8Value();
+    iov.iov_base = text.data();
+    iov.iov_len = text.size();
+  }
+  if (iov.iov_len > 0) {
+    Write(&iov, 1);
   }
 
-  return Napi::Buffer<char>::Copy(env, buffer.data(), received);
+  return Napi::Boolean::New(env, UpdateBackpressure());
 }
 
-Napi::Value TcpClientWrapper::Close(const Napi::CallbackInfo& info) {
+// sendMany(list) and sendv(list): one gathered sendmsg over the entries'
+// own memory (strings are converted first). Every entry is accepted;
+// sendMany returns the count, sendv whether the queue is under its limit.
+Napi::Value TcpClientWrapper::SendArray(const Napi::CallbackInfo& info,
+                                        const char* usage,
+                                        bool count_entries) {
   Napi::Env env = info.Env();
 
-  try {
-    client_.destroy();
-  } catch (const libsocket::socket_exception& ex) {
-    Napi::Error::New(env, ex.mesg).ThrowAsJavaScriptException();
-  } catch (const std::exception& ex) {
-    Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+  if (!channel_ || channel_->closing) {
+    Napi::Error::New(env, "Client is not connected").ThrowAsJavaScriptException();
+    return env.Null();
   }
 
-  return env.Undefined();
-}
-
-Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
-  return TcpClientWrapper::Init(env, exports);
-}
-}  // namespace
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, usage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
 
+  Napi::Array list = info[0].As<Napi::Array>();
+  const uint32_t length = list.Length();
+  std::vector<struct iovec> iov;
+  iov.reserve(length);
+  // Pins converted strings; a deque never moves its elements.
+  std::deque<std::string> texts;
+  for (uint32_t i = 0; i < length; ++i) {
+    Napi::Value item = list.Get(i);
+    struct iovec entry {};
+    if (item.IsBuffer()) {
+      auto buf = item.As<Napi::Buffer<uint8_t>>();
+      entry.iov_base = buf.Data();
+      entry.iov_len = buf.Length();
+    } else {
+      texts.push_back(item.ToString().Utf8Value());
+      entry.iov_base = texts.back().data();
+      entry.iov_len = texts.back().size();
+    }
+    if (entry.iov_len > 0) {
+      iov.push_back(entry);
+    }
+  }
+  if (!iov.empty()) {
+    Write(iov.data(), iov.size());
+  }
+
+  const bool under_limit = UpdateBackpressure();
+  if (count_entries) {
+    return Napi::Number::New(env, length);
+  }
+  return Napi::Boolean::New(env, under_limit);
+}
+
+Napi::Value TcpClientWrapper::SendMany(const Napi::CallbackInfo& info) {
+  return SendArray(info, "sendMany(data: Array<Buffer|string>) required", true);
+}
+
+Napi::Value TcpClientWrapper::SendV(const Napi::CallbackInfo& info) {
+  return SendArray(info, "sendv(buffers: Array<Buffer|string>) required", false);
+}
+
+// Never blocks: returns up to length buffered bytes (possibly none). Data is
+// only buffered here while no event handler is set.
+Napi::Value TcpClientWrapper::Recv(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  size_t length = 4096;
+  if (info.Length() >= 1 && info[0].IsNumber()) {
+    length = info[0].As<Napi::Number>().Uint32Value();
+  }
+
+  auto out = Napi::Buffer<uint8_t>::New(env, Buffered(length));
+  DrainInto(out.Data(), out.Length());
+  return out;
+}
+
+// recvInto(buffer, offset?): like recv() but fills buffer[offset..] and
+// returns the byte count, so a reused slab makes polling garbage-free.
+Napi::Value TcpClientWrapper::RecvInto(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsBuffer()) {
+    Napi::TypeError::New(env, "recvInto(buffer: Buffer, offset?: number) required")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  auto buf = info[0].As<Napi::Buffer<uint8_t>>();
+  size_t offset = 0;
+  if (info.Length() >= 2 && info[1].IsNumber()) {
+    offset = info[1].As<Napi::Number>().Uint32Value();
+  }
+  if (offset > buf.Length()) {
+    Napi::RangeError::New(env, "recvInto offset is past the end of the buffer")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  return Napi::Number::New(env, DrainInto(buf.Data() + offset, buf.Length() - offset));
+}
+
+size_t TcpClientWrapper::Buffered(size_t limit) const {
+  size_t total = 0;
+  size_t offset = recv_offset_;
+  for (const auto& chunk : recv_queue_) {
+    total += chunk.size() - offset;
+    offset = 0;
+    if (total >= limit) return limit;
+  }
+  return total;
+}
+
+size_t TcpClientWrapper::DrainInto(uint8_t* out, size_t capacity) {
+  size_t copied = 0;
+  while (!recv_queue_.empty() && copied < capacity) {
+    auto& front = recv_queue_.front();
+    const size_t take = std::min(capacity - copied, front.size() - recv_offset_);
+    std::memcpy(out + copied, front.data() + recv_offset_, take);
+    copied += take;
+    recv_offset_ += take;
+    if (recv_offset_ == front.size()) {
+      recv_queue_.pop_front();
+      recv_offset_ = 0;
+    }
+  }
+  if (channel_) {
+    ReleaseRx(channel_, copied);
+  }
+  return copied;
+}
+
+Napi::Value TcpClientWrapper::IsConnected(const Napi::CallbackInfo& info) {
+  return Napi::Boolean::New(info.Env(),
+                            channel_ && channel_->connected && !channel_->closing);
+}
+
+Napi::Value TcpClientWrapper::SetEventHandler(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsFunction()) {
+    Napi::TypeError::New(env, "setEventHandler(fn) requires a function")
+        .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  handler_ = Napi::Persistent(info[0].As<Napi::Function>());
+  return env.Undefined();
+}
+
+// getSocketOptions(): effective socketOptions, undefined before the socket
+// exists or without socketOptions.
+Napi::Value TcpClientWrapper::GetSocketOptions(const Napi::CallbackInfo& info) {
+  if (!channel_) return info.Env().Undefined();
+  std::lock_guard<std::mutex> lock(channel_->mutex);
+  if (!channel_->socket_report) return info.Env().Undefined();
+  return SocketTuningObject(info.Env(), *channel_->socket_report);
+}
+
+// getConnectTimings(): { dnsMs, dnsCached, attempts } and, once a race was
+// won, address, tcpMs (first attempt to the winning handshake) and totalMs
+// (connect() call to connected). Undefined for Unix sockets and before the
+// lookup finishes.
+Napi::Value TcpClientWrapper::GetConnectTimings(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (!channel_) return env.Undefined();
+  std::lock_guard<std::mutex> lock(channel_->mutex);
+  if (!channel_->connect_trace) return env.Undefined();
+  const ConnectTrace& trace = *channel_->connect_trace;
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("dnsMs", trace.dns_ms);
+  out.Set("dnsCached", trace.dns_cached);
+  out.Set("attempts", static_cast<double>(trace.attempts));
+  if (trace.tcp_ms >= 0) {
+    out.Set("address", trace.address);
+    out.Set("tcpMs", trace.tcp_ms);
+    out.Set("connectMs", trace.tcp_ms);
+    out.Set("totalMs", trace.total_ms);
+  }
+  return out;
+}
+
+Napi::Value TcpClientWrapper::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (channel_ && !channel_->closing.exchange(true)) {
+    auto channel = channel_;
+    SocketReactor::Instance().Post(
+        [channel]() { SocketReactor::Instance().Teardown(channel, std::nullopt); });
+  }
+
+  return env.Undefined();
+}
+
+// One accepted peer of a SocketServerWrapper. The loop thread owns the rx
+// state; tx is shared with the JS thread under mutex, which also guards fd
+// against the loop closing it.
+// timestamping: the receive times SCM_TIMESTAMPING gave the latest read,
+// in CLOCK_REALTIME ns (hardware in the NIC's clock), and when the read
+// returned. Zero where the kernel left one out.
+struct RxStamp {
+  uint64_t kernel_ns = 0;
+  uint64_t hardware_ns = 0;
+  uint64_t native_ns = 0;
+};
+
+// syncClock(): NTP's four times per probe exchange, filtered the way NTP's
+// clock filter is: of the last kWindow samples, the one with the shortest
+// round trip queued least, so its offset is the one reported. t2 and t3
+// are on the peer's clock; the offset is peer minus local.
+class ClockOffsetEstimator {
+ public:
+  static constexpr size_t kWindow = 8;
+
+  struct Sample {
+    int64_t offset_ns = 0;
+    int64_t rtt_ns = 0;
+  };
+
+  void Add(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+    Sample sample;
+    sample.rtt_ns = std::max<int64_t>(0, (t4 - t1) - (t3 - t2));
+    sample.offset_ns = ((t2 - t1) + (t3 - t4)) / 2;
+    samples_[count_++ % kWindow] = sample;
+  }
+
+  Sample Best() const {
+    Sample best;
+    const size_t held = std::min<uint64_t>(count_, kWindow);
+    for (size_t i = 0; i < held; ++i) {
+      if (i == 0 || samples_[i].rtt_ns < best.rtt_ns) best = samples_[i];
+    }
+    return best;
+  }
+
+  uint64_t count() const { return count_; }
+
+ private:
+  std::array<Sample, kWindow> samples_{};
+  uint64_t count_ = 0;
+};
+
+struct ServerConnection {
+  uint64_t handle = 0;
+  std::string id;
+  std::string remote_address;
+  uint16_t remote_port = 0;
+  // "IPv4" or "IPv6"; v4 peers of a dual-stack listener count as IPv4.
+  const char* remote_family = "";
+
+  // Loop thread only.
+  bool finished = false;
+  bool rx_again = false;
+  bool close_after_flush = false;
+  std::vector<uint8_t> rx_partial;
+  RxStamp rx_stamp;
+
+  std::mutex mutex;
+  int fd = -1;
+  std::deque<std::shared_ptr<const std::vector<uint8_t>>> tx;
+  size_t tx_offset = 0;
+  size_t queued_bytes = 0;
+  bool backpressured = false;
+  // zeroCopyMinBytes: SO_ZEROCOPY is on, and the frames the kernel may
+  // still read from, each behind the id of the last MSG_ZEROCOPY send that
+  // covered it. They are released as the error queue reports those ids.
+  bool zerocopy = false;
+  uint32_t zerocopy_next_id = 0;
+  std::deque<std::pair<uint32_t, std::shared_ptr<const std::vector<uint8_t>>>> zerocopy_held;
+  // sharedMemory: until a Unix peer's first bytes say whether it brought
+  // rings, writes wait; then the link, set and reset by the loop thread.
+  bool awaiting_hello = false;
+  std::unique_ptr<ShmLink> shm;
+  // timestamping: SO_TIMESTAMPING is on. tx_bytes counts what sendmsg took,
+  // which is how OPT_ID keys a TCP send: its last byte. One send at a time
+  // asks for SCHED/SND/ACK stamps, which bounds the error queue to a few
+  // reports a round trip. clock_probe is the syncClock() frame in flight
+  // and when the last of it went to the kernel.
+  bool timestamping = false;
+  uint32_t tx_bytes = 0;
+  bool tx_stamp_pending = false;
+  uint32_t tx_stamp_key = 0;
+  uint64_t tx_stamp_ns = 0;
+  uint32_t clock_probe = 0;
+  std::shared_ptr<const std::vector<uint8_t>> clock_probe_frame;
+  uint64_t clock_probe_sent_ns = 0;
+  ClockOffsetEstimator clock;
+  std::atomic<bool> closing{false};
+};
+
+uint64_t WallClockNs() {
+  struct timespec ts {};
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t TimespecNs(const struct timespec& ts) {
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+// timestamping / getTimestampStats(): the reads that carried a receive
+// stamp and the stamped sends the kernel reported on, with the mean of
+// each delay. Delays are against WallClockNs() taken around the syscall,
+// so they hold the kernel's share of the path and not the NIC's. The loop
+// thread records; the JS thread reads.
+class TimestampMeter {
+ public:
+  // Read returned minus segment stamped; then a stamped send's queueing
+  // discipline entry, driver hand-off and peer ACK, each from its sendmsg.
+  enum Delay { kKernelToNative, kSched, kSoftware, kAck, kDelays };
+
+  void RecordRead(const RxStamp& stamp) {
+    if (stamp.kernel_ns == 0) return;
+    rx_stamped_.fetch_add(1, std::memory_order_relaxed);
+    if (stamp.hardware_ns != 0) rx_hardware_.fetch_add(1, std::memory_order_relaxed);
+    RecordDelay(kKernelToNative, static_cast<int64_t>(stamp.native_ns - stamp.kernel_ns));
+  }
+
+  void RecordDelay(Delay which, int64_t ns) {
+    if (ns < 0) return;
+    sums_[which].fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+    counts_[which].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void RecordTxHardware() { tx_hardware_.fetch_add(1, std::memory_order_relaxed); }
+  void RecordTxExpired() { tx_expired_.fetch_add(1, std::memory_order_relaxed); }
+
+  Napi::Object ToObject(Napi::Env env, bool hardware) const {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("mode", hardware ? "hardware" : "software");
+    out.Set("rxStamped", static_cast<double>(rx_stamped_.load(std::memory_order_relaxed)));
+    out.Set("rxHardware", static_cast<double>(rx_hardware_.load(std::memory_order_relaxed)));
+    out.Set("kernelToNativeUs", MeanUs(kKernelToNative));
+    out.Set("txStamped", static_cast<double>(counts_[kAck].load(std::memory_order_relaxed)));
+    out.Set("txHardware", static_cast<double>(tx_hardware_.load(std::memory_order_relaxed)));
+    out.Set("txExpired", static_cast<double>(tx_expired_.load(std::memory_order_relaxed)));
+    out.Set("txSchedUs", MeanUs(kSched));
+    out.Set("txSoftwareUs", MeanUs(kSoftware));
+    out.Set("txAckUs", MeanUs(kAck));
+    return out;
+  }
+
+ private:
+  double MeanUs(Delay which) const {
+    const uint64_t count = counts_[which].load(std::memory_order_relaxed);
+    if (count == 0) return 0.0;
+    return static_cast<double>(sums_[which].load(std::memory_order_relaxed)) / 1000.0 /
+           static_cast<double>(count);
+  }
+
+  std::atomic<uint64_t> rx_stamped_{0};
+  std::atomic<uint64_t> rx_hardware_{0};
+  std::atomic<uint64_t> tx_hardware_{0};
+  std::atomic<uint64_t> tx_expired_{0};
+  std::array<std::atomic<uint64_t>, kDelays> sums_{};
+  std::array<std::atomic<uint64_t>, kDelays> counts_{};
+};
+
+using SharedFrame = std::shared_ptr<const std::vector<uint8_t>>;
+
+// getAcceptStats(): what the listener took, in batches of one drained
+// backlog, and the accept rate over the last window of at least a second.
+// The loop thread records; the JS thread reads.
+class AcceptMeter {
+ public:
+  static constexpr uint64_t kWindowNs = 1000000000ull;
+
+  void Record(uint64_t accepted) {
+    if (accepted == 0) return;
+    accepted_.fetch_add(accepted, std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    if (accepted > max_batch_.load(std::memory_order_relaxed)) {
+      max_batch_.store(accepted, std::memory_order_relaxed);
+    }
+    const uint64_t now = NowNs();
+    const uint64_t start = window_start_ns_.load(std::memory_order_relaxed);
+    if (start == 0) {
+      window_start_ns_.store(now, std::memory_order_relaxed);
+    } else if (now - start >= kWindowNs) {
+      const uint64_t in_window = window_accepts_.exchange(0, std::memory_order_relaxed);
+      rate_.store(static_cast<double>(in_window) * 1e9 / static_cast<double>(now - start),
+                  std::memory_order_relaxed);
+      window_start_ns_.store(now, std::memory_order_relaxed);
+    }
+    window_accepts_.fetch_add(accepted, std::memory_order_relaxed);
+  }
+
+  // accept4() failures other than an empty backlog: EMFILE, ENOBUFS and the like.
+  void RecordError() { errors_.fetch_add(1, std::memory_order_relaxed); }
+
+  Napi::Object ToObject(Napi::Env env) const {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("accepted", static_cast<double>(accepted_.load(std::memory_order_relaxed)));
+    out.Set("batches", static_cast<double>(batches_.load(std::memory_order_relaxed)));
+    out.Set("maxBatch", static_cast<double>(max_batch_.load(std::memory_order_relaxed)));
+    out.Set("errors", static_cast<double>(errors_.load(std::memory_order_relaxed)));
+    // A window that has run past a second without closing counts as closed now.
+    const uint64_t start = window_start_ns_.load(std::memory_order_relaxed);
+    const uint64_t now = NowNs();
+    double rate = rate_.load(std::memory_order_relaxed);
+    if (start != 0 && now - start >= kWindowNs) {
+      rate = static_cast<double>(window_accepts_.load(std::memory_order_relaxed)) * 1e9 /
+             static_cast<double>(now - start);
+    }
+    out.Set("acceptsPerSec", rate);
+    return out;
+  }
+
+ private:
+  static uint64_t NowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+  }
+
+  std::atomic<uint64_t> accepted_{0};
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> max_batch_{0};
+  std::atomic<uint64_t> errors_{0};
+  std::atomic<uint64_t> window_start_ns_{0};
+  std::atomic<uint64_t> window_accepts_{0};
+  std::atomic<double> rate_{0};
+};
+
+// Lean Linux server: one edge-triggered epoll thread per server, accept4()
+// until EAGAIN, and every socket registered once for IN|OUT so nothing is
+// re-armed per write. Speaks the same length-prefixed framing and event
+// surface as the lws QWormholeServerWrapper, without TLS or handshakes.
+class SocketServerWrapper : public Napi::ObjectWrap<SocketServerWrapper> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  explicit SocketServerWrapper(const Napi::CallbackInfo& info);
+  ~SocketServerWrapper() override;
+
+ private:
+  struct Options {
+    std::string host;
+    uint16_t port = 0;
+    // Unix stream socket instead of TCP; leading NUL for the abstract namespace.
+    std::string path;
+    bool reuse_port = false;
+    // ipv6Only: IPV6_V6ONLY on an IPv6 listener; otherwise it is dual-stack.
+    bool ipv6_only = false;
+    // reusePortSteering: "cpu"; members in the SO_REUSEPORT group, 0 = off.
+    uint32_t reuse_port_cpu_group = 0;
+    ListenTuning listen;
+    bool length_prefixed = true;
+    size_t max_frame_length = kDefaultMaxFrameLength;
+    size_t max_backpressure_bytes = kDefaultMaxBackpressureBytes;
+    // zeroCopyMinBytes: writes carrying a frame at least this large go out
+    // with MSG_ZEROCOPY; 0 = off.
+    size_t zero_copy_min_bytes = 0;
+    // sharedMemory: Unix peers may move their stream onto shared rings.
+    bool shared_memory = false;
+    // timestamping: "software" or "hardware" SO_TIMESTAMPING on TCP peers.
+    bool timestamping = false;
+    bool hardware_timestamps = false;
+  };
+
+  struct PendingMessage {
+    std::shared_ptr<ServerConnection> conn;
+    std::vector<uint8_t> data;
+    RxStamp stamp;
+  };
+
+  static constexpr uint64_t kWakeToken = 0;
+  static constexpr uint64_t kListenToken = 1;
+  // Set on a connection's handle for its ring wake eventfd.
+  static constexpr uint64_t kRingTokenBit = uint64_t{1} << 63;
+
+  Napi::Value Listen(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+  Napi::Value Broadcast(const Napi::CallbackInfo& info);
+  Napi::Value BroadcastTo(const Napi::CallbackInfo& info);
+  Napi::Value SendTo(const Napi::CallbackInfo& info);
+  Napi::Value GetConnection(const Napi::CallbackInfo& info);
+  Napi::Value GetConnectionCount(const Napi::CallbackInfo& info);
+  Napi::Value CloseConnection(const Napi::CallbackInfo& info);
+  Napi::Value GetWriteStats(const Napi::CallbackInfo& info);
+  Napi::Value GetAcceptStats(const Napi::CallbackInfo& info);
+  Napi::Value GetTimestampStats(const Napi::CallbackInfo& info);
+  Napi::Value SendClockProbe(const Napi::CallbackInfo& info);
+  Napi::Value AddClockSample(const Napi::CallbackInfo& info);
+
+  // Loop thread.
+  void Run();
+  void RunCommands();
+  void AcceptReady();
+  void ReadReady(const std::shared_ptr<ServerConnection>& conn);
+  void WriteReady(const std::shared_ptr<ServerConnection>& conn);
+  void ReapZeroCopy(const std::shared_ptr<ServerConnection>& conn);
+  void ApplyTxStamp(ServerConnection* conn,
+                    const struct sock_extended_err& err,
+                    const struct scm_timestamping& stamps);
+  ssize_t RecvStamped(ServerConnection* conn);
+  bool ReadHello(const std::shared_ptr<ServerConnection>& conn);
+  void RingReady(const std::shared_ptr<ServerConnection>& conn);
+  void ReadRing(const std::shared_ptr<ServerConnection>& conn, bool drain = false);
+  bool Deliver(const std::shared_ptr<ServerConnection>& conn, const uint8_t* data, size_t len);
+  bool SplitFrames(const std::shared_ptr<ServerConnection>& conn,
+                   const uint8_t* data,
+                   size_t len,
+                   size_t* consumed);
+  void Teardown(const std::shared_ptr<ServerConnection>& conn, bool had_error);
+  void FlushMessages();
+
+  // Any thread.
+  void Post(std::function<void()> command);
+  bool FlushLocked(ServerConnection* conn);
+
+  // JS thread.
+  void Stop();
+  SharedFrame BuildFrame(Napi::Env env, const Napi::Value& value);
+  void Enqueue(const std::shared_ptr<ServerConnection>& conn, const SharedFrame& frame);
+  std::shared_ptr<ServerConnection> FindConnection(const Napi::Value& key) const;
+  std::vector<std::shared_ptr<ServerConnection>> SnapshotConnections() const;
+  Napi::Value ClientObjectFor(Napi::Env env, const std::shared_ptr<ServerConnection>& conn);
+  Napi::Object AddressObject(Napi::Env env) const;
+
+  void Emit(std::function<void(Napi::Env, Napi::Object, Napi::Function)> build);
+  void EmitFlow(const std::shared_ptr<ServerConnection>& conn, bool backpressure,
+                size_t queued_bytes);
+
+  Options options_;
+  std::string id_prefix_;
+  int listen_fd_ = -1;
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  uint16_t listen_port_ = 0;
+  std::string listen_family_;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+
+  std::mutex commands_mutex_;
+  std::deque<std::function<void()>> commands_;
+
+  // Written by the loop thread under table_mutex_; the loop reads it without.
+  mutable std::mutex table_mutex_;
+  std::unordered_map<uint64_t, std::shared_ptr<ServerConnection>> connections_;
+  uint64_t next_handle_ = kListenToken + 1;
+  std::vector<std::shared_ptr<ServerConnection>> rx_again_;
+  std::vector<PendingMessage> messages_;
+  std::vector<uint8_t> rx_scratch_;
+
+  std::atomic<uint64_t> write_calls_{0};
+  std::atomic<uint64_t> frames_written_{0};
+  std::atomic<uint64_t> bytes_written_{0};
+  // zeroCopyMinBytes: MSG_ZEROCOPY sends, the send ids the kernel has
+  // completed and how many of those it copied after all (loopback always
+  // does), and writes or sockets that fell back to a plain copy.
+  std::atomic<uint64_t> zero_copy_sends_{0};
+  std::atomic<uint64_t> zero_copy_completions_{0};
+  std::atomic<uint64_t> zero_copy_copied_{0};
+  std::atomic<uint64_t> zero_copy_fallbacks_{0};
+  AcceptMeter accept_meter_;
+  TimestampMeter timestamp_meter_;
+
+  // JS thread only.
+  Napi::ThreadSafeFunction tsfn_;
+  bool tsfn_ready_ = false;
+  Napi::ObjectReference self_ref_;
+  std::unordered_map<uint64_t, Napi::ObjectReference> client_cache_;
+};
+
+uint32_t DecodeFrameLength(const uint8_t* header) {
+  return (static_cast<uint32_t>(header[0]) << 24) |
+         (static_cast<uint32_t>(header[1]) << 16) |
+         (static_cast<uint32_t>(header[2]) << 8) |
+         static_cast<uint32_t>(header[3]);
+}
+
+Napi::Object SocketServerWrapper::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "QWormholeServerWrapper",
+      {
+          InstanceMethod<&SocketServerWrapper::Listen>("listen"),
+          InstanceMethod<&SocketServerWrapper::Close>("close"),
+          InstanceMethod<&SocketServerWrapper::Broadcast>("broadcast"),
+          InstanceMethod<&SocketServerWrapper::BroadcastTo>("broadcastTo"),
+          InstanceMethod<&SocketServerWrapper::SendTo>("sendTo"),
+          InstanceMethod<&SocketServerWrapper::GetConnection>("getConnection"),
+          InstanceMethod<&SocketServerWrapper::GetConnectionCount>("getConnectionCount"),
+          InstanceMethod<&SocketServerWrapper::CloseConnection>("closeConnection"),
+          InstanceMethod<&SocketServerWrapper::GetWriteStats>("getWriteStats"),
+          InstanceMethod<&SocketServerWrapper::GetAcceptStats>("getAcceptStats"),
+          InstanceMethod<&SocketServerWrapper::GetTimestampStats>("getTimestampStats"),
+          InstanceMethod<&SocketServerWrapper::SendClockProbe>("sendClockProbe"),
+          InstanceMethod<&SocketServerWrapper::AddClockSample>("addClockSample"),
+      });
+
+  exports.Set("QWormholeServerWrapper", func);
+  return exports;
+}
+
+SocketServerWrapper::SocketServerWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SocketServerWrapper>(info) {
+  if (info.Length() >= 1 && info[0].IsObject()) {
+    Napi::Object obj = info[0].As<Napi::Object>();
+    if (obj.Has("host") && obj.Get("host").IsString()) {
+      options_.host = obj.Get("host").As<Napi::String>().Utf8Value();
+    }
+    if (obj.Has("port") && obj.Get("port").IsNumber()) {
+      options_.port = static_cast<uint16_t>(obj.Get("port").As<Napi::Number>().Uint32Value());
+    }
+    if (obj.Has("path") && obj.Get("path").IsString()) {
+      options_.path = obj.Get("path").As<Napi::String>().Utf8Value();
+      if (!options_.path.empty() && options_.path[0] == '@') options_.path[0] = '\0';
+    }
+    if (obj.Has("reusePort") && obj.Get("reusePort").IsBoolean()) {
+      options_.reuse_port = obj.Get("reusePort").As<Napi::Boolean>().Value();
+    }
+    if (obj.Has("ipv6Only") && obj.Get("ipv6Only").IsBoolean()) {
+      options_.ipv6_only = obj.Get("ipv6Only").As<Napi::Boolean>().Value();
+    }
+    if (obj.Has("reusePortSteering") && obj.Get("reusePortSteering").IsString() &&
+        obj.Get("reusePortSteering").As<Napi::String>().Utf8Value() == "cpu") {
+      uint32_t group = std::max(1u, std::thread::hardware_concurrency());
+      if (obj.Has("reusePortGroupSize") && obj.Get("reusePortGroupSize").IsNumber()) {
+        group = std::max(1u, obj.Get("reusePortGroupSize").As<Napi::Number>().Uint32Value());
+      }
+      options_.reuse_port_cpu_group = group;
+    }
+    if (obj.Has("framing") && obj.Get("framing").IsString()) {
+      options_.length_prefixed = obj.Get("framing").As<Napi::String>().Utf8Value() != "none";
+    }
+    options_.listen = ParseListenTuning(obj);
+    if (obj.Has("maxFrameLength") && obj.Get("maxFrameLength").IsNumber()) {
+      const auto limit = obj.Get("maxFrameLength").As<Napi::Number>().Int64Value();
+      if (limit > 0) options_.max_frame_length = static_cast<size_t>(limit);
+    }
+    if (obj.Has("maxBackpressureBytes") && obj.Get("maxBackpressureBytes").IsNumber()) {
+      const auto limit = obj.Get("maxBackpressureBytes").As<Napi::Number>().Int64Value();
+      if (limit > 0) options_.max_backpressure_bytes = static_cast<size_t>(limit);
+    }
+    if (obj.Has("zeroCopyMinBytes") && obj.Get("zeroCopyMinBytes").IsNumber()) {
+      const auto limit = obj.Get("zeroCopyMinBytes").As<Napi::Number>().Int64Value();
+      if (limit > 0) options_.zero_copy_min_bytes = static_cast<size_t>(limit);
+    }
+    if (obj.Has("sharedMemory") && obj.Get("sharedMemory").IsBoolean()) {
+      options_.shared_memory = obj.Get("sharedMemory").As<Napi::Boolean>().Value();
+    }
+    if (obj.Has("timestamping")) {
+      const Napi::Value mode = obj.Get("timestamping");
+      if (mode.IsString()) {
+        const std::string name = mode.As<Napi::String>().Utf8Value();
+        options_.timestamping = name == "software" || name == "hardware";
+        options_.hardware_timestamps = name == "hardware";
+      } else if (mode.IsBoolean()) {
+        options_.timestamping = mode.As<Napi::Boolean>().Value();
+      }
+    }
+  }
+  char prefix[32];
+  snprintf(prefix, sizeof(prefix), "conn-%08x-",
+           static_cast<unsigned int>(std::random_device{}()));
+  id_prefix_ = prefix;
+}
+
+SocketServerWrapper::~SocketServerWrapper() {
+  Stop();
+  if (tsfn_ready_) {
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+}
+
+Napi::Object SocketServerWrapper::AddressObject(Napi::Env env) const {
+  Napi::Object address = Napi::Object::New(env);
+  if (!options_.path.empty()) {
+    const std::string& path = options_.path;
+    address.Set("address", path[0] == '\0' ? "@" + path.substr(1) : path);
+    address.Set("port", 0);
+    address.Set("family", "unix");
+    return address;
+  }
+  const bool any_v6 = options_.host.empty() && listen_family_ == "IPv6";
+  address.Set("address", !options_.host.empty() ? options_.host : any_v6 ? "::" : "0.0.0.0");
+  address.Set("port", listen_port_);
+  address.Set("family", listen_family_);
+  return address;
+}
+
+Napi::Value SocketServerWrapper::Listen(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  auto deferred = Napi::Promise::Deferred::New(env);
+
+  if (running_) {
+    deferred.Reject(Napi::Error::New(env, "Server already listening").Value());
+    return deferred.Promise();
+  }
+
+  errno = 0;
+  listen_fd_ = options_.path.empty()
+                   ? ListenInetStream(options_.host, options_.port, options_.reuse_port,
+                                      options_.listen, options_.reuse_port_cpu_group,
+                                      options_.ipv6_only)
+                   : ListenUnixStream(options_.path, options_.listen.backlog);
+  if (listen_fd_ < 0) {
+    std::string error = "Could not listen on ";
+    error += options_.path.empty()
+                 ? (options_.host.empty() ? "0.0.0.0" : options_.host) + ":" +
+                       std::to_string(options_.port)
+                 : options_.path;
+    if (errno != 0) error += std::string(": ") + std::strerror(errno);
+    deferred.Reject(Napi::Error::New(env, error).Value());
+    return deferred.Promise();
+  }
+
+  listen_port_ = options_.port;
+  listen_family_ = "IPv4";
+  if (options_.path.empty()) {
+    struct sockaddr_storage bound {};
+    socklen_t len = sizeof bound;
+    if (getsockname(listen_fd_, reinterpret_cast<struct sockaddr*>(&bound), &len) == 0) {
+      if (bound.ss_family == AF_INET6) {
+        listen_port_ = ntohs(reinterpret_cast<struct sockaddr_in6*>(&bound)->sin6_port);
+        listen_family_ = "IPv6";
+      } else {
+        listen_port_ = ntohs(reinterpret_cast<struct sockaddr_in*>(&bound)->sin_port);
+      }
+    }
+  }
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  struct epoll_event wake {};
+  wake.events = EPOLLIN;
+  wake.data.u64 = kWakeToken;
+  struct epoll_event accept {};
+  accept.events = EPOLLIN | EPOLLET;
+  accept.data.u64 = kListenToken;
+  if (epoll_fd_ < 0 || wake_fd_ < 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake) != 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &accept) != 0) {
+    const std::string error = std::string("epoll setup failed: ") + std::strerror(errno);
+    Stop();
+    deferred.Reject(Napi::Error::New(env, error).Value());
+    return deferred.Promise();
+  }
+
+  if (self_ref_.IsEmpty()) {
+    // Keeps the wrapper alive while events can still reach it.
+    self_ref_ = Napi::ObjectReference::New(info.This().As<Napi::Object>(), 1);
+  }
+  tsfn_ = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+      "QWormholeLibsocketServerEvents", 0, 1);
+  tsfn_ready_ = true;
+  rx_scratch_.resize(kReadChunkBytes);
+  running_ = true;
+  thread_ = std::thread(&SocketServerWrapper::Run, this);
+
+  Emit([this](Napi::Env env, Napi::Object self, Napi::Function emit) {
+    emit.Call(self, {Napi::String::New(env, "listening"), AddressObject(env)});
+  });
+  deferred.Resolve(AddressObject(env));
+  return deferred.Promise();
+}
+
+// Joins the loop, then closes every socket without per-connection events,
+// as the lws backend does on close().
+void SocketServerWrapper::Stop() {
+  if (running_.exchange(false)) {
+    Post([]() {});
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  {
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    for (auto& entry : connections_) {
+      auto& conn = entry.second;
+      std::lock_guard<std::mutex> conn_lock(conn->mutex);
+      conn->closing = true;
+      if (conn->fd >= 0) {
+        ::close(conn->fd);
+        conn->fd = -1;
+      }
+      conn->shm.reset();
+      conn->tx.clear();
+      conn->queued_bytes = 0;
+    }
+    connections_.clear();
+  }
+  rx_again_.clear();
+  messages_.clear();
+  if (listen_fd_ >= 0) {
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+    // Node removes its socket file on close too; abstract names vanish with the fd.
+    if (!options_.path.empty() && options_.path[0] != '\0') {
+      ::unlink(options_.path.c_str());
+    }
+  }
+  if (epoll_fd_ >= 0) {
+    ::close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+  if (wake_fd_ >= 0) {
+    ::close(wake_fd_);
+    wake_fd_ = -1;
+  }
+}
+
+Napi::Value SocketServerWrapper::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Stop();
+  client_cache_.clear();
+  if (tsfn_ready_) {
+    Emit([this](Napi::Env env, Napi::Object self, Napi::Function emit) {
+      emit.Call(self, {Napi::String::New(env, "close"), env.Undefined()});
+      if (!running_) self_ref_.Reset();
+    });
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+
+  auto deferred = Napi::Promise::Deferred::New(env);
+  deferred.Resolve(env.Undefined());
+  return deferred.Promise();
+}
+
+void SocketServerWrapper::Post(std::function<void()> command) {
+  {
+    std::lock_guard<std::mutex> lock(commands_mutex_);
+    commands_.push_back(std::move(command));
+  }
+  const uint64_t one = 1;
+  ssize_t ignored = ::write(wake_fd_, &one, sizeof one);
+  (void)ignored;
+}
+
+void SocketServerWrapper::RunCommands() {
+  std::deque<std::function<void()>> ready;
+  {
+    std::lock_guard<std::mutex> lock(commands_mutex_);
+    ready.swap(commands_);
+  }
+  for (auto& command : ready) {
+    command();
+  }
+}
+
+void SocketServerWrapper::Run() {
+  std::vector<struct epoll_event> events(256);
+  while (running_) {
+    // Connections cut off by the per-event read cap keep the loop from sleeping.
+    const int timeout = rx_again_.empty() ? -1 : 0;
+    const int ready = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), timeout);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    for (int i = 0; i < ready; ++i) {
+      const uint64_t token = events[i].data.u64;
+      if (token == kWakeToken) {
+        uint64_t count = 0;
+        ssize_t ignored = ::read(wake_fd_, &count, sizeof count);
+        (void)ignored;
+        continue;
+      }
+      if (token == kListenToken) {
+        AcceptReady();
+        continue;
+      }
+      auto it = connections_.find(token & ~kRingTokenBit);
+      if (it == connections_.end()) continue;
+      std::shared_ptr<ServerConnection> conn = it->second;
+      if (token & kRingTokenBit) {
+        if (conn->shm) RingReady(conn);
+        continue;
+      }
+      // Completions and send stamps arrive on the error queue, which
+      // signals EPOLLERR.
+      if ((conn->zerocopy || conn->timestamping) && (events[i].events & EPOLLERR)) {
+        ReapZeroCopy(conn);
+      }
+      if (!conn->finished && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+        ReadReady(conn);
+      }
+      if (!conn->finished && (events[i].events & EPOLLOUT)) {
+        WriteReady(conn);
+      }
+    }
+    if (!rx_again_.empty()) {
+      std::vector<std::shared_ptr<ServerConnection>> again;
+      again.swap(rx_again_);
+      for (auto& conn : again) {
+        conn->rx_again = false;
+        if (conn->finished) continue;
+        if (conn->shm) {
+          ReadRing(conn);
+        } else {
+          ReadReady(conn);
+        }
+      }
+    }
+    RunCommands();
+    FlushMessages();
+  }
+}
+
+void SocketServerWrapper::AcceptReady() {
+  // Edge-triggered: drain the backlog, or the next connection never wakes us.
+  uint64_t accepted = 0;
+  for (;;) {
+    struct sockaddr_storage peer {};
+    socklen_t len = sizeof peer;
+    const int fd = ::accept4(listen_fd_, reinterpret_cast<struct sockaddr*>(&peer), &len,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) accept_meter_.RecordError();
+      break;
+    }
+    ++accepted;
+
+    auto conn = std::make_shared<ServerConnection>();
+    conn->handle = next_handle_++;
+    char suffix[24];
+    auto result = std::to_chars(suffix, suffix + sizeof(suffix), conn->handle, 16);
+    conn->id = id_prefix_ + std::string(suffix, result.ptr);
+    char host[INET6_ADDRSTRLEN] = {};
+    if (peer.ss_family == AF_INET) {
+      auto* in = reinterpret_cast<struct sockaddr_in*>(&peer);
+      inet_ntop(AF_INET, &in->sin_addr, host, sizeof host);
+      conn->remote_port = ntohs(in->sin_port);
+      conn->remote_family = "IPv4";
+    } else if (peer.ss_family == AF_INET6) {
+      auto* in6 = reinterpret_cast<struct sockaddr_in6*>(&peer);
+      conn->remote_port = ntohs(in6->sin6_port);
+      if (IN6_IS_ADDR_V4MAPPED(&in6->sin6_addr)) {
+        inet_ntop(AF_INET, in6->sin6_addr.s6_addr + 12, host, sizeof host);
+        conn->remote_family = "IPv4";
+      } else {
+        inet_ntop(AF_INET6, &in6->sin6_addr, host, sizeof host);
+        conn->remote_family = "IPv6";
+      }
+    }
+    conn->remote_address = host;
+    conn->awaiting_hello = peer.ss_family == AF_UNIX && options_.shared_memory;
+    if (peer.ss_family != AF_UNIX) {
+      const int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+      if (options_.zero_copy_min_bytes > 0) {
+        conn->zerocopy = SetSocketInt(fd, SOL_SOCKET, SO_ZEROCOPY, 1);
+        if (!conn->zerocopy) zero_copy_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+      }
+      if (options_.timestamping) {
+        // Receive stamps on every segment; send stamps are asked for per
+        // sendmsg. Hardware stamps need the NIC switched on already
+        // (SIOCSHWTSTAMP, e.g. hwstamp_ctl); without that they stay zero.
+        int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+                    SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+        if (options_.hardware_timestamps) {
+          flags |= SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+        }
+        conn->timestamping = SetSocketInt(fd, SOL_SOCKET, SO_TIMESTAMPING, flags);
+      }
+    }
+    conn->fd = fd;
+
+    struct epoll_event ev {};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.u64 = conn->handle;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+      ::close(fd);
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(table_mutex_);
+      connections_.emplace(conn->handle, conn);
+    }
+    Emit([this, conn](Napi::Env env, Napi::Object self, Napi::Function emit) {
+      Napi::Value client = ClientObjectFor(env, conn);
+      emit.Call(self, {Napi::String::New(env, "connection"), client});
+    });
+  }
+  accept_meter_.Record(accepted);
+}
+
+void SocketServerWrapper::ReadReady(const std::shared_ptr<ServerConnection>& conn) {
+  if (conn->awaiting_hello && !ReadHello(conn)) return;
+  for (int i = 0; i < kMaxReadsPerEvent; ++i) {
+    const ssize_t n = conn->timestamping
+                          ? RecvStamped(conn.get())
+                          : ::recv(conn->fd, rx_scratch_.data(), rx_scratch_.size(), 0);
+    if (n > 0) {
+      if (!Deliver(conn, rx_scratch_.data(), static_cast<size_t>(n))) {
+        Teardown(conn, true);
+        return;
+      }
+      // A short read emptied the socket; more data raises a fresh edge.
+      if (static_cast<size_t>(n) < rx_scratch_.size()) return;
+      continue;
+    }
+    if (n == 0) {
+      // The client is gone; what it left in the ring still counts.
+      if (conn->shm) ReadRing(conn, true);
+      if (!conn->finished) Teardown(conn, false);
+      return;
+    }
+    if (errno == EINTR) continue;
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      Teardown(conn, true);
+    }
+    return;
+  }
+  // Still readable, and no new edge will say so.
+  if (!conn->rx_again) {
+    conn->rx_again = true;
+    rx_again_.push_back(conn);
+  }
+}
+
+// sharedMemory: the first read of a Unix connection. A hello carrying the
+// client's segment and both eventfds moves the stream onto the rings;
+// anything else starts an ordinary stream. Either way held writes go out.
+// False once there is nothing more to read from the socket now.
+bool SocketServerWrapper::ReadHello(const std::shared_ptr<ServerConnection>& conn) {
+  uint8_t hello[kShmHelloBytes];
+  struct iovec iov {hello, sizeof hello};
+  alignas(struct cmsghdr) char control[CMSG_SPACE(3 * sizeof(int))];
+  struct msghdr msg {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof control;
+  ssize_t n = 0;
+  do {
+    n = ::recvmsg(conn->fd, &msg, MSG_CMSG_CLOEXEC);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK) Teardown(conn, true);
+    return false;
+  }
+  std::vector<int> fds;
+  for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+    if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+    const size_t count = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    for (size_t i = 0; i < count; ++i) {
+      int fd = -1;
+      std::memcpy(&fd, CMSG_DATA(cm) + i * sizeof(int), sizeof fd);
+      fds.push_back(fd);
+    }
+  }
+  const bool offered = n == static_cast<ssize_t>(sizeof hello) && fds.size() == 3 &&
+                       (msg.msg_flags & MSG_CTRUNC) == 0 &&
+                       std::memcmp(hello, kShmHelloMagic, sizeof kShmHelloMagic) == 0;
+  if (!offered) {
+    for (int fd : fds) ::close(fd);
+    {
+      std::lock_guard<std::mutex> lock(conn->mutex);
+      conn->awaiting_hello = false;
+    }
+    if (n == 0) {
+      Teardown(conn, false);
+      return false;
+    }
+    if (!Deliver(conn, hello, static_cast<size_t>(n))) {
+      Teardown(conn, true);
+      return false;
+    }
+    WriteReady(conn);
+    return !conn->finished;
+  }
+  uint32_t ring_bytes = 0;
+  std::memcpy(&ring_bytes, hello + sizeof kShmHelloMagic, sizeof ring_bytes);
+  std::unique_ptr<ShmLink> link = ShmLink::Adopt(fds[0], fds[1], fds[2], ring_bytes);
+  struct epoll_event ev {};
+  ev.events = EPOLLIN;
+  ev.data.u64 = conn->handle | kRingTokenBit;
+  if (!link || epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, link->wake_fd(), &ev) != 0) {
+    Teardown(conn, true);
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    conn->shm = std::move(link);
+    conn->awaiting_hello = false;
+  }
+  // The client may have written before this side was listening.
+  RingReady(conn);
+  return !conn->finished;
+}
+
+void SocketServerWrapper::RingReady(const std::shared_ptr<ServerConnection>& conn) {
+  conn->shm->ClearWake();
+  ReadRing(conn);
+  if (!conn->finished) WriteReady(conn);
+}
+
+// ReadReady for the ring, with the same per-event cap. drain ignores it
+// for a client that has gone.
+void SocketServerWrapper::ReadRing(const std::shared_ptr<ServerConnection>& conn, bool drain) {
+  for (int i = 0; drain || i < kMaxReadsPerEvent; ++i) {
+    const size_t n = conn->shm->Read(rx_scratch_.data(), rx_scratch_.size());
+    if (n == 0) return;
+    if (!Deliver(conn, rx_scratch_.data(), n)) {
+      Teardown(conn, true);
+      return;
+    }
+  }
+  if (!conn->rx_again) {
+    conn->rx_again = true;
+    rx_again_.push_back(conn);
+  }
+}
+
+void SocketServerWrapper::WriteReady(const std::shared_ptr<ServerConnection>& conn) {
+  bool failed = false;
+  bool drained = false;
+  bool close_now = false;
+  {
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    failed = !FlushLocked(conn.get());
+    if (!failed && conn->tx.empty()) {
+      drained = conn->backpressured;
+      conn->backpressured = false;
+      // Closing now could hand frames the kernel still reads to the allocator.
+      close_now = conn->close_after_flush && conn->zerocopy_held.empty();
+    }
+  }
+  if (failed) {
+    Teardown(conn, true);
+    return;
+  }
+  if (drained) EmitFlow(conn, false, 0);
+  if (close_now) Teardown(conn, false);
+}
+
+// Loop thread. Drains the error queue and releases every held frame up to
+// the highest completed id: TCP completes its sends in order, and the
+// kernel merges consecutive ids into one notification. Send stamps come
+// the same way, their times in an SCM_TIMESTAMPING ahead of the error.
+void SocketServerWrapper::ReapZeroCopy(const std::shared_ptr<ServerConnection>& conn) {
+  bool close_now = false;
+  {
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    for (;;) {
+      alignas(struct cmsghdr) char control[256];
+      struct msghdr msg {};
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof control;
+      if (conn->fd < 0 || ::recvmsg(conn->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) break;
+      struct scm_timestamping stamps {};
+      for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPING) {
+          std::memcpy(&stamps, CMSG_DATA(cm), sizeof stamps);
+          continue;
+        }
+        const bool recverr = (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                             (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR);
+        if (!recverr) continue;
+        struct sock_extended_err err;
+        std::memcpy(&err, CMSG_DATA(cm), sizeof err);
+        if (err.ee_origin == SO_EE_ORIGIN_TIMESTAMPING) {
+          ApplyTxStamp(conn.get(), err, stamps);
+          continue;
+        }
+        if (err.ee_origin != SO_EE_ORIGIN_ZEROCOPY || err.ee_errno != 0) continue;
+        const uint64_t ids = static_cast<uint32_t>(err.ee_data - err.ee_info) + 1ull;
+        zero_copy_completions_.fetch_add(ids, std::memory_order_relaxed);
+        if (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+          zero_copy_copied_.fetch_add(ids, std::memory_order_relaxed);
+        }
+        auto& held = conn->zerocopy_held;
+        while (!held.empty() && static_cast<int32_t>(held.front().first - err.ee_data) <= 0) {
+          held.pop_front();
+        }
+      }
+    }
+    close_now = conn->close_after_flush && conn->tx.empty() && conn->zerocopy_held.empty();
+  }
+  if (close_now) Teardown(conn, false);
+}
+
+// Caller holds conn->mutex. Reports for anything but the send in flight
+// (one that expired, say) are dropped; the ACK report ends it.
+void SocketServerWrapper::ApplyTxStamp(ServerConnection* conn,
+                                       const struct sock_extended_err& err,
+                                       const struct scm_timestamping& stamps) {
+  if (!conn->tx_stamp_pending || err.ee_data != conn->tx_stamp_key) return;
+  const auto since_send = static_cast<int64_t>(TimespecNs(stamps.ts[0]) - conn->tx_stamp_ns);
+  switch (err.ee_info) {
+    case SCM_TSTAMP_SCHED:
+      timestamp_meter_.RecordDelay(TimestampMeter::kSched, since_send);
+      break;
+    case SCM_TSTAMP_SND:
+      if (stamps.ts[2].tv_sec != 0 || stamps.ts[2].tv_nsec != 0) {
+        timestamp_meter_.RecordTxHardware();
+      }
+      if (stamps.ts[0].tv_sec != 0) {
+        timestamp_meter_.RecordDelay(TimestampMeter::kSoftware, since_send);
+      }
+      break;
+    case SCM_TSTAMP_ACK:
+      timestamp_meter_.RecordDelay(TimestampMeter::kAck, since_send);
+      conn->tx_stamp_pending = false;
+      break;
+    default:
+      break;
+  }
+}
+
+// timestamping: recv() plus what SCM_TIMESTAMPING says of the last segment
+// read. A read without one (nothing stamped yet) keeps zeros.
+ssize_t SocketServerWrapper::RecvStamped(ServerConnection* conn) {
+  struct iovec iov {rx_scratch_.data(), rx_scratch_.size()};
+  alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(struct scm_timestamping))];
+  struct msghdr msg {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof control;
+  const ssize_t n = ::recvmsg(conn->fd, &msg, 0);
+  if (n <= 0) return n;
+  RxStamp stamp;
+  stamp.native_ns = WallClockNs();
+  for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+    if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_TIMESTAMPING) continue;
+    struct scm_timestamping stamps;
+    std::memcpy(&stamps, CMSG_DATA(cm), sizeof stamps);
+    stamp.kernel_ns = TimespecNs(stamps.ts[0]);
+    stamp.hardware_ns = TimespecNs(stamps.ts[2]);
+  }
+  timestamp_meter_.RecordRead(stamp);
+  conn->rx_stamp = stamp;
+  return n;
+}
+
+bool SocketServerWrapper::Deliver(const std::shared_ptr<ServerConnection>& conn,
+                                  const uint8_t* data,
+                                  size_t len) {
+  if (!options_.length_prefixed) {
+    messages_.push_back(
+        PendingMessage{conn, std::vector<uint8_t>(data, data + len), conn->rx_stamp});
+    return true;
+  }
+  size_t consumed = 0;
+  if (conn->rx_partial.empty()) {
+    if (!SplitFrames(conn, data, len, &consumed)) return false;
+    conn->rx_partial.assign(data + consumed, data + len);
+    return true;
+  }
+  conn->rx_partial.insert(conn->rx_partial.end(), data, data + len);
+  const bool ok = SplitFrames(conn, conn->rx_partial.data(), conn->rx_partial.size(), &consumed);
+  conn->rx_partial.erase(conn->rx_partial.begin(),
+                         conn->rx_partial.begin() + static_cast<std::ptrdiff_t>(consumed));
+  return ok;
+}
+
+// Queues each whole frame in data; a frame above maxFrameLength fails the stream.
+bool SocketServerWrapper::SplitFrames(const std::shared_ptr<ServerConnection>& conn,
+                                      const uint8_t* data,
+                                      size_t len,
+                                      size_t* consumed) {
+  size_t offset = 0;
+  while (len - offset >= kFrameHeaderBytes) {
+    const size_t frame_length = DecodeFrameLength(data + offset);
+    if (frame_length > options_.max_frame_length) {
+      *consumed = offset;
+      return false;
+    }
+    if (len - offset - kFrameHeaderBytes < frame_length) break;
+    const uint8_t* payload = data + offset + kFrameHeaderBytes;
+    messages_.push_back(PendingMessage{
+        conn, std::vector<uint8_t>(payload, payload + frame_length), conn->rx_stamp});
+    offset += kFrameHeaderBytes + frame_length;
+  }
+  *consumed = offset;
+  return true;
+}
+
+void SocketServerWrapper::Teardown(const std::shared_ptr<ServerConnection>& conn,
+                                   bool had_error) {
+  if (conn->finished) return;
+  conn->finished = true;
+  conn->closing = true;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+  if (conn->shm) epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn->shm->wake_fd(), nullptr);
+  {
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    ::close(conn->fd);
+    conn->fd = -1;
+    conn->shm.reset();
+    conn->tx.clear();
+    conn->zerocopy_held.clear();
+    conn->queued_bytes = 0;
+  }
+  {
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    connections_.erase(conn->handle);
+  }
+  // Frames read before the close reach JS ahead of "clientClosed".
+  FlushMessages();
+  Emit([this, conn, had_error](Napi::Env env, Napi::Object self, Napi::Function emit) {
+    client_cache_.erase(conn->handle);
+    Napi::Object client = Napi::Object::New(env);
+    client.Set("id", conn->id);
+    client.Set("handle", static_cast<double>(conn->handle));
+    Napi::Object payload = Napi::Object::New(env);
+    payload.Set("client", client);
+    payload.Set("hadError", had_error);
+    emit.Call(self, {Napi::String::New(env, "clientClosed"), payload});
+  });
+}
+
+// One event per loop pass: "message" for a single frame, else "messages".
+void SocketServerWrapper::FlushMessages() {
+  if (messages_.empty()) return;
+  std::vector<PendingMessage> batch;
+  batch.swap(messages_);
+  const uint64_t emitted_ns = options_.timestamping ? WallClockNs() : 0;
+  Emit([this, batch = std::move(batch), emitted_ns](Napi::Env env, Napi::Object self,
+                                                    Napi::Function emit) {
+    auto payload_for = [this, env, emitted_ns](const PendingMessage& message) {
+      Napi::Object payload = Napi::Object::New(env);
+      payload.Set("client", ClientObjectFor(env, message.conn));
+      payload.Set("data",
+                  Napi::Buffer<uint8_t>::Copy(env, message.data.data(), message.data.size()));
+      // timestamping: microseconds since the epoch, which a double holds
+      // to a fraction of one; the frame's stamps are those of the read
+      // that completed it, and emittedUs is when the batch left the loop.
+      if (message.stamp.native_ns != 0) {
+        Napi::Object stamps = Napi::Object::New(env);
+        if (message.stamp.kernel_ns != 0) {
+          stamps.Set("kernelUs", static_cast<double>(message.stamp.kernel_ns) / 1000.0);
+        }
+        if (message.stamp.hardware_ns != 0) {
+          stamps.Set("hardwareUs", static_cast<double>(message.stamp.hardware_ns) / 1000.0);
+        }
+        stamps.Set("nativeUs", static_cast<double>(message.stamp.native_ns) / 1000.0);
+        stamps.Set("emittedUs", static_cast<double>(emitted_ns) / 1000.0);
+        payload.Set("timestamps", stamps);
+      }
+      return payload;
+    };
+    if (batch.size() == 1) {
+      emit.Call(self, {Napi::String::New(env, "message"), payload_for(batch.front())});
+      return;
+    }
+    Napi::Array payloads = Napi::Array::New(env, batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+      payloads.Set(static_cast<uint32_t>(i), payload_for(batch[i]));
+    }
+    emit.Call(self, {Napi::String::New(env, "messages"), payloads});
+  });
+}
+
+// Caller holds conn->mutex. Writes until the queue empties or the kernel
+// pushes back; false once the socket has failed.
+bool SocketServerWrapper::FlushLocked(ServerConnection* conn) {
+  if (conn->awaiting_hello) return true;
+  while (conn->fd >= 0 && !conn->tx.empty()) {
+    struct iovec iov[kMaxIovPerWrite];
+    int count = 0;
+    size_t offset = conn->tx_offset;
+    for (auto it = conn->tx.begin(); it != conn->tx.end() && count < kMaxIovPerWrite;
+         ++it, ++count) {
+      iov[count].iov_base = const_cast<uint8_t*>((*it)->data()) + offset;
+      iov[count].iov_len = (*it)->size() - offset;
+      offset = 0;
+    }
+    ssize_t sent = 0;
+    bool zerocopy = false;
+    if (conn->shm) {
+      // Full: the client's next read wakes RingReady.
+      sent = static_cast<ssize_t>(conn->shm->Write(iov, count));
+      if (sent == 0) return true;
+    } else {
+      for (int i = 0; conn->zerocopy && !zerocopy && i < count; ++i) {
+        zerocopy = iov[i].iov_len >= options_.zero_copy_min_bytes;
+      }
+      struct msghdr msg {};
+      msg.msg_iov = iov;
+      msg.msg_iovlen = static_cast<size_t>(count);
+      alignas(struct cmsghdr) char control[CMSG_SPACE(sizeof(uint32_t))] = {};
+      bool stamp = false;
+      uint64_t stamp_ns = 0;
+      if (conn->timestamping) {
+        stamp_ns = WallClockNs();
+        if (conn->tx_stamp_pending && stamp_ns - conn->tx_stamp_ns > kTxStampTimeoutNs) {
+          // Its reports were lost with a reset or never came; ask again.
+          conn->tx_stamp_pending = false;
+          timestamp_meter_.RecordTxExpired();
+        }
+        stamp = !conn->tx_stamp_pending;
+      }
+      if (stamp) {
+        uint32_t flags = SOF_TIMESTAMPING_TX_SCHED | SOF_TIMESTAMPING_TX_SOFTWARE |
+                         SOF_TIMESTAMPING_TX_ACK;
+        if (options_.hardware_timestamps) flags |= SOF_TIMESTAMPING_TX_HARDWARE;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof control;
+        struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SO_TIMESTAMPING;
+        cm->cmsg_len = CMSG_LEN(sizeof flags);
+        std::memcpy(CMSG_DATA(cm), &flags, sizeof flags);
+      }
+      sent = ::sendmsg(conn->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT | (zerocopy ? MSG_ZEROCOPY : 0));
+      if (sent < 0 && zerocopy && errno == ENOBUFS) {
+        // Too many completions outstanding (optmem_max); this one is copied.
+        zero_copy_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+        zerocopy = false;
+        sent = ::sendmsg(conn->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+      }
+      if (sent < 0) {
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+      if (stamp && sent > 0) {
+        conn->tx_stamp_pending = true;
+        conn->tx_stamp_key = conn->tx_bytes + static_cast<uint32_t>(sent) - 1;
+        conn->tx_stamp_ns = stamp_ns;
+      }
+      conn->tx_bytes += static_cast<uint32_t>(sent);
+    }
+    if (zerocopy) {
+      // Every frame this send reached stays alive until its id completes.
+      const uint32_t id = conn->zerocopy_next_id++;
+      zero_copy_sends_.fetch_add(1, std::memory_order_relaxed);
+      size_t covered = 0;
+      size_t skip = conn->tx_offset;
+      for (auto it = conn->tx.begin(); it != conn->tx.end() && covered < static_cast<size_t>(sent);
+           ++it) {
+        conn->zerocopy_held.emplace_back(id, *it);
+        covered += (*it)->size() - skip;
+        skip = 0;
+      }
+    }
+    write_calls_.fetch_add(1, std::memory_order_relaxed);
+    bytes_written_.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+    conn->queued_bytes -= static_cast<size_t>(sent);
+    size_t remaining = static_cast<size_t>(sent);
+    uint64_t frames = 0;
+    while (remaining > 0) {
+      const size_t left = conn->tx.front()->size() - conn->tx_offset;
+      if (remaining < left) {
+        conn->tx_offset += remaining;
+        break;
+      }
+      remaining -= left;
+      if (conn->clock_probe_frame && conn->tx.front() == conn->clock_probe_frame) {
+        conn->clock_probe_sent_ns = WallClockNs();
+        conn->clock_probe_frame.reset();
+      }
+      conn->tx.pop_front();
+      conn->tx_offset = 0;
+      frames++;
+    }
+    frames_written_.fetch_add(frames, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+SharedFrame SocketServerWrapper::BuildFrame(Napi::Env env, const Napi::Value& value) {
+  const uint8_t* data = nullptr;
+  size_t len = 0;
+  std::string text;
+  if (value.IsBuffer()) {
+    auto buf = value.As<Napi::Buffer<uint8_t>>();
+    data = buf.Data();
+    len = buf.Length();
+  } else if (value.IsString()) {
+    text = value.As<Napi::String>().Utf8Value();
+    data = reinterpret_cast<const uint8_t*>(text.data());
+    len = text.size();
+  } else {
+    // Lets nativeCodec callers fall back to the JS serializer.
+    Napi::TypeError::New(env, "libsocket server sends Buffers or strings")
+        .ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  const size_t header = options_.length_prefixed ? kFrameHeaderBytes : 0;
+  auto frame = std::make_shared<std::vector<uint8_t>>(header + len);
+  if (header) {
+    const uint32_t length = static_cast<uint32_t>(len);
+    (*frame)[0] = static_cast<uint8_t>(length >> 24);
+    (*frame)[1] = static_cast<uint8_t>(length >> 16);
+    (*frame)[2] = static_cast<uint8_t>(length >> 8);
+    (*frame)[3] = static_cast<uint8_t>(length);
+  }
+  if (len > 0) std::memcpy(frame->data() + header, data, len);
+  return frame;
+}
+
+// Writes on the JS thread while nothing is queued, so an idle connection
+// costs one sendmsg and no loop wakeup. A partial write leaves the rest to
+// the loop: EAGAIN guarantees an EPOLLOUT edge once the socket drains.
+void SocketServerWrapper::Enqueue(const std::shared_ptr<ServerConnection>& conn,
+                                  const SharedFrame& frame) {
+  bool failed = false;
+  bool backpressure = false;
+  size_t queued = 0;
+  {
+    std::lock_guard<std::mutex> lock(conn->mutex);
+    if (conn->fd < 0 || conn->closing) return;
+    conn->tx.push_back(frame);
+    conn->queued_bytes += frame->size();
+    if (conn->tx.size() == 1) {
+      failed = !FlushLocked(conn.get());
+    }
+    if (!failed && !conn->backpressured &&
+        conn->queued_bytes > options_.max_backpressure_bytes) {
+      conn->backpressured = true;
+      backpressure = true;
+      queued = conn->queued_bytes;
+    }
+  }
+  if (failed) {
+    Post([this, conn]() { Teardown(conn, true); });
+    return;
+  }
+  if (backpressure) EmitFlow(conn, true, queued);
+}
+
+std::vector<std::shared_ptr<ServerConnection>> SocketServerWrapper::SnapshotConnections() const {
+  std::lock_guard<std::mutex> lock(table_mutex_);
+  std::vector<std::shared_ptr<ServerConnection>> out;
+  out.reserve(connections_.size());
+  for (const auto& entry : connections_) {
+    out.push_back(entry.second);
+  }
+  return out;
+}
+
+// Accepts the numeric handle or the "conn-<prefix>-<hex handle>" id.
+std::shared_ptr<ServerConnection> SocketServerWrapper::FindConnection(
+    const Napi::Value& key) const {
+  uint64_t handle = 0;
+  if (key.IsNumber()) {
+    handle = static_cast<uint64_t>(key.As<Napi::Number>().Int64Value());
+  } else if (key.IsString()) {
+    const std::string id = key.As<Napi::String>().Utf8Value();
+    if (id.size() <= id_prefix_.size() || id.compare(0, id_prefix_.size(), id_prefix_) != 0) {
+      return nullptr;
+    }
+    const char* begin = id.data() + id_prefix_.size();
+    const char* end = id.data() + id.size();
+    auto result = std::from_chars(begin, end, handle, 16);
+    if (result.ec != std::errc() || result.ptr != end) return nullptr;
+  } else {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(table_mutex_);
+  auto it = connections_.find(handle);
+  return it == connections_.end() ? nullptr : it->second;
+}
+
+Napi::Value SocketServerWrapper::ClientObjectFor(Napi::Env env,
+                                                 const std::shared_ptr<ServerConnection>& conn) {
+  auto cached = client_cache_.find(conn->handle);
+  if (cached != client_cache_.end()) {
+    return cached->second.Value();
+  }
+  Napi::Object client = Napi::Object::New(env);
+  client.Set("id", conn->id);
+  client.Set("handle", static_cast<double>(conn->handle));
+  client.Set("remoteAddress", conn->remote_address);
+  client.Set("remotePort", conn->remote_port);
+  client.Set("remoteFamily", conn->remote_family);
+  client_cache_.emplace(conn->handle, Napi::ObjectReference::New(client, 1));
+  return client;
+}
+
+void SocketServerWrapper::Emit(
+    std::function<void(Napi::Env, Napi::Object, Napi::Function)> build) {
+  if (!tsfn_ready_) return;
+  tsfn_.NonBlockingCall([this, build = std::move(build)](Napi::Env env, Napi::Function) {
+    if (self_ref_.IsEmpty()) return;
+    Napi::Object self = self_ref_.Value();
+    if (self.Has("emit") && self.Get("emit").IsFunction()) {
+      build(env, self, self.Get("emit").As<Napi::Function>());
+    }
+  });
+}
+
+void SocketServerWrapper::EmitFlow(const std::shared_ptr<ServerConnection>& conn,
+                                   bool backpressure,
+                                   size_t queued_bytes) {
+  const size_t threshold = options_.max_backpressure_bytes;
+  Emit([conn, backpressure, queued_bytes, threshold](Napi::Env env, Napi::Object self,
+                                                     Napi::Function emit) {
+    Napi::Object client = Napi::Object::New(env);
+    client.Set("id", conn->id);
+    Napi::Object payload = Napi::Object::New(env);
+    payload.Set("client", client);
+    if (backpressure) {
+      payload.Set("queuedBytes", static_cast<double>(queued_bytes));
+      payload.Set("threshold", static_cast<double>(threshold));
+    }
+    emit.Call(self, {Napi::String::New(env, backpressure ? "backpressure" : "drain"), payload});
+  });
+}
+
+Napi::Value SocketServerWrapper::Broadcast(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1) {
+    Napi::TypeError::New(env, "broadcast(data) required").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  // Framed once; every recipient queues a reference to the same buffer.
+  SharedFrame frame = BuildFrame(env, info[0]);
+  if (!frame) return env.Undefined();
+  for (const auto& conn : SnapshotConnections()) {
+    Enqueue(conn, frame);
+  }
+  return env.Undefined();
+}
+
+Napi::Value SocketServerWrapper::BroadcastTo(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "broadcastTo(ids, data) requires an array of connection ids")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  Napi::Array ids = info[0].As<Napi::Array>();
+  std::vector<std::shared_ptr<ServerConnection>> targets;
+  targets.reserve(ids.Length());
+  for (uint32_t i = 0; i < ids.Length(); ++i) {
+    if (auto conn = FindConnection(ids.Get(i))) {
+      targets.push_back(std::move(conn));
+    }
+  }
+
+  SharedFrame frame = BuildFrame(env, info[1]);
+  if (!frame) return env.Undefined();
+  for (const auto& conn : targets) {
+    Enqueue(conn, frame);
+  }
+  return Napi::Number::New(env, static_cast<double>(targets.size()));
+}
+
+// sendTo(id, data): one FIFO per connection; the lws priority lanes have no
+// counterpart here, so options.priority is ignored.
+Napi::Value SocketServerWrapper::SendTo(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !(info[0].IsString() || info[0].IsNumber())) {
+    Napi::TypeError::New(env, "sendTo(id, data) requires connection id or handle")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::shared_ptr<ServerConnection> target = FindConnection(info[0]);
+  if (!target) return env.Undefined();
+  SharedFrame frame = BuildFrame(env, info[1]);
+  if (!frame) return env.Undefined();
+  Enqueue(target, frame);
+  return env.Undefined();
+}
+
+Napi::Value SocketServerWrapper::GetConnection(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1) return env.Undefined();
+  std::shared_ptr<ServerConnection> target = FindConnection(info[0]);
+  if (!target) return env.Undefined();
+
+  Napi::Object conn = Napi::Object::New(env);
+  conn.Set("id", target->id);
+  conn.Set("handle", static_cast<double>(target->handle));
+  conn.Set("remoteAddress", target->remote_address);
+  conn.Set("remotePort", target->remote_port);
+  conn.Set("remoteFamily", target->remote_family);
+  return conn;
+}
+
+Napi::Value SocketServerWrapper::GetConnectionCount(const Napi::CallbackInfo& info) {
+  std::lock_guard<std::mutex> lock(table_mutex_);
+  return Napi::Number::New(info.Env(), static_cast<double>(connections_.size()));
+}
+
+// Closes once what is already queued has been written.
+Napi::Value SocketServerWrapper::CloseConnection(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !(info[0].IsString() || info[0].IsNumber())) {
+    Napi::TypeError::New(env, "closeConnection(id) requires connection id or handle")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  std::shared_ptr<ServerConnection> target = FindConnection(info[0]);
+  if (!target || target->closing.exchange(true)) return env.Undefined();
+  Post([this, target]() {
+    if (target->finished) return;
+    bool idle = false;
+    {
+      std::lock_guard<std::mutex> lock(target->mutex);
+      idle = target->tx.empty() && target->zerocopy_held.empty();
+    }
+    if (idle) {
+      Teardown(target, false);
+    } else {
+      target->close_after_flush = true;
+    }
+  });
+  return env.Undefined();
+}
+
+Napi::Value SocketServerWrapper::GetWriteStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  const uint64_t syscalls = write_calls_.load(std::memory_order_relaxed);
+  const uint64_t frames = frames_written_.load(std::memory_order_relaxed);
+  Napi::Object stats = Napi::Object::New(env);
+  stats.Set("writeCalls", static_cast<double>(syscalls));
+  stats.Set("framesWritten", static_cast<double>(frames));
+  stats.Set("bytesWritten", static_cast<double>(bytes_written_.load(std::memory_order_relaxed)));
+  stats.Set("framesPerWrite",
+            syscalls ? static_cast<double>(frames) / static_cast<double>(syscalls) : 0.0);
+  if (options_.zero_copy_min_bytes > 0) {
+    stats.Set("zeroCopySends",
+              static_cast<double>(zero_copy_sends_.load(std::memory_order_relaxed)));
+    stats.Set("zeroCopyCompletions",
+              static_cast<double>(zero_copy_completions_.load(std::memory_order_relaxed)));
+    stats.Set("zeroCopyCopied",
+              static_cast<double>(zero_copy_copied_.load(std::memory_order_relaxed)));
+    stats.Set("zeroCopyFallbacks",
+              static_cast<double>(zero_copy_fallbacks_.load(std::memory_order_relaxed)));
+  }
+  return stats;
+}
+
+Napi::Value SocketServerWrapper::GetAcceptStats(const Napi::CallbackInfo& info) {
+  return accept_meter_.ToObject(info.Env());
+}
+
+Napi::Value SocketServerWrapper::GetTimestampStats(const Napi::CallbackInfo& info) {
+  if (!options_.timestamping) return info.Env().Undefined();
+  return timestamp_meter_.ToObject(info.Env(), options_.hardware_timestamps);
+}
+
+// sendClockProbe(id, probe, data): sends data as a frame and notes when the
+// last of it reaches the kernel, t1 of the exchange addClockSample() ends.
+// A newer probe replaces one still unanswered. Undefined for an unknown id.
+Napi::Value SocketServerWrapper::SendClockProbe(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 3 || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "sendClockProbe(id, probe, data) requires a probe number")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::shared_ptr<ServerConnection> target = FindConnection(info[0]);
+  if (!target) return env.Undefined();
+  SharedFrame frame = BuildFrame(env, info[2]);
+  if (!frame) return env.Undefined();
+  {
+    std::lock_guard<std::mutex> lock(target->mutex);
+    target->clock_probe = info[1].As<Napi::Number>().Uint32Value();
+    target->clock_probe_frame = frame;
+    target->clock_probe_sent_ns = 0;
+  }
+  Enqueue(target, frame);
+  return Napi::Boolean::New(env, true);
+}
+
+// addClockSample(id, probe, t2Us, t3Us, t4Us): the peer's receive and reply
+// times for `probe` and when its reply arrived here, all in microseconds
+// since the epoch. Returns the filtered { offsetUs, rttUs, samples }, or
+// undefined when `probe` is not the one last sent.
+Napi::Value SocketServerWrapper::AddClockSample(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 5 || !info[1].IsNumber() || !info[2].IsNumber() || !info[3].IsNumber() ||
+      !info[4].IsNumber()) {
+    Napi::TypeError::New(env, "addClockSample(id, probe, t2Us, t3Us, t4Us) requires numbers")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::shared_ptr<ServerConnection> target = FindConnection(info[0]);
+  if (!target) return env.Undefined();
+  auto ns = [&info](size_t index) {
+    return static_cast<int64_t>(info[index].As<Napi::Number>().DoubleValue() * 1000.0);
+  };
+  ClockOffsetEstimator::Sample best;
+  uint64_t samples = 0;
+  {
+    std::lock_guard<std::mutex> lock(target->mutex);
+    if (target->clock_probe != info[1].As<Napi::Number>().Uint32Value() ||
+        target->clock_probe_sent_ns == 0) {
+      return env.Undefined();
+    }
+    target->clock.Add(static_cast<int64_t>(target->clock_probe_sent_ns), ns(2), ns(3), ns(4));
+    target->clock_probe_sent_ns = 0;
+    best = target->clock.Best();
+    samples = target->clock.count();
+  }
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("offsetUs", static_cast<double>(best.offset_ns) / 1000.0);
+  out.Set("rttUs", static_cast<double>(best.rtt_ns) / 1000.0);
+  out.Set("samples", static_cast<double>(samples));
+  return out;
+}
+
+// Blocks a UDP batch is compacted into. Datagram Buffers are slices of a
+// block, and the block returns here once the last of them is collected, so
+// steady traffic reuses a few allocations instead of one per packet.
+class PacketBlockPool : public std::enable_shared_from_this<PacketBlockPool> {
+ public:
+  using Block = std::shared_ptr<std::vector<uint8_t>>;
+
+  // Loop thread.
+  Block Acquire(size_t reserve) {
+    std::unique_ptr<std::vector<uint8_t>> block;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!idle_.empty()) {
+        block = std::move(idle_.back());
+        idle_.pop_back();
+        ++reused_;
+      } else {
+        ++allocated_;
+      }
+    }
+    if (!block) block = std::make_unique<std::vector<uint8_t>>();
+    block->clear();
+    block->reserve(reserve);
+    std::weak_ptr<PacketBlockPool> pool = weak_from_this();
+    return Block(block.release(), [pool](std::vector<uint8_t>* released) {
+      if (auto owner = pool.lock()) {
+        owner->Recycle(released);
+      } else {
+        delete released;
+      }
+    });
+  }
+
+  uint64_t allocated() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocated_;
+  }
+
+  uint64_t reused() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reused_;
+  }
+
+ private:
+  // Any thread: the last Buffer finalizer or the loop thread's own ref.
+  void Recycle(std::vector<uint8_t>* block) {
+    std::unique_ptr<std::vector<uint8_t>> owned(block);
+    if (owned->capacity() > kMaxPooledUdpBlockBytes) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (idle_.size() < kUdpBlockPoolSize) idle_.push_back(std::move(owned));
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<std::vector<uint8_t>>> idle_;
+  uint64_t allocated_ = 0;
+  uint64_t reused_ = 0;
+};
+
+void ReleasePacketBlockHint(Napi::Env, uint8_t*, PacketBlockPool::Block* hint) {
+  delete hint;
+}
+
+// A datagram as an external slice of its block; copies where external
+// buffers are disallowed.
+Napi::Buffer<uint8_t> WrapPacket(Napi::Env env, const PacketBlockPool::Block& block,
+                                 size_t offset, size_t length) {
+  if (length == 0) return Napi::Buffer<uint8_t>::New(env, 0);
+  return Napi::Buffer<uint8_t>::NewOrCopy(env, block->data() + offset, length,
+                                          ReleasePacketBlockHint,
+                                          new PacketBlockPool::Block(block));
+}
+
+// UDP socket for datagram transports such as KCP. A loop thread receives
+// with recvmmsg and emits each batch as one event; sends go out from the JS
+// thread as one sendmmsg per batch, or as one GSO send for equal segments.
+class UdpSocketWrapper : public Napi::ObjectWrap<UdpSocketWrapper> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  explicit UdpSocketWrapper(const Napi::CallbackInfo& info);
+  ~UdpSocketWrapper() override;
+
+ private:
+  struct Options {
+    std::string host;
+    uint16_t port = 0;
+    bool ipv6 = false;
+    bool gro = false;
+    size_t batch = kDefaultUdpBatch;
+    size_t max_datagram = kMaxUdpDatagram;
+  };
+
+  struct Datagram {
+    size_t offset = 0;
+    size_t length = 0;
+    std::string address;
+    uint16_t port = 0;
+  };
+
+  struct Peer {
+    struct sockaddr_storage addr;
+    socklen_t len = 0;
+  };
+
+  static constexpr uint64_t kWakeToken = 0;
+  static constexpr uint64_t kSocketToken = 1;
+
+  Napi::Value Bind(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+  Napi::Value Send(const Napi::CallbackInfo& info);
+  Napi::Value SendBatch(const Napi::CallbackInfo& info);
+  Napi::Value SendSegments(const Napi::CallbackInfo& info);
+  Napi::Value Address(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+  // Loop thread.
+  void Run();
+  void ReceiveReady();
+
+  // JS thread.
+  void Stop();
+  const Peer* PeerFor(Napi::Env env, const Napi::Value& port, const Napi::Value& address);
+  Napi::Object AddressObject(Napi::Env env) const;
+  void Emit(std::function<void(Napi::Env, Napi::Object, Napi::Function)> build);
+
+  Options options_;
+  std::unique_ptr<libsocket::inet_dgram_server> socket_;
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  uint16_t bound_port_ = 0;
+  bool gro_active_ = false;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+
+  // Loop thread only.
+  std::vector<uint8_t> rx_slab_;
+  std::vector<libsocket::dgram_message> rx_slots_;
+  std::shared_ptr<PacketBlockPool> rx_pool_ = std::make_shared<PacketBlockPool>();
+  std::atomic<uint64_t> datagrams_in_{0};
+  std::atomic<uint64_t> batches_in_{0};
+  uint64_t datagrams_out_ = 0;
+
+  // JS thread only.
+  std::vector<libsocket::dgram_message> tx_batch_;
+  std::unordered_map<std::string, Peer> peers_;
+  Napi::ThreadSafeFunction tsfn_;
+  bool tsfn_ready_ = false;
+  Napi::ObjectReference self_ref_;
+};
+
+void FormatPeer(const struct sockaddr_storage& addr, std::string* host, uint16_t* port) {
+  char text[INET6_ADDRSTRLEN] = {0};
+  if (addr.ss_family == AF_INET6) {
+    const auto* in6 = reinterpret_cast<const struct sockaddr_in6*>(&addr);
+    inet_ntop(AF_INET6, &in6->sin6_addr, text, sizeof text);
+    *port = ntohs(in6->sin6_port);
+  } else {
+    const auto* in4 = reinterpret_cast<const struct sockaddr_in*>(&addr);
+    inet_ntop(AF_INET, &in4->sin_addr, text, sizeof text);
+    *port = ntohs(in4->sin_port);
+  }
+  host->assign(text);
+}
+
+Napi::Object UdpSocketWrapper::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "QWormholeUdpSocket",
+      {
+          InstanceMethod<&UdpSocketWrapper::Bind>("bind"),
+          InstanceMethod<&UdpSocketWrapper::Close>("close"),
+          InstanceMethod<&UdpSocketWrapper::Send>("send"),
+          InstanceMethod<&UdpSocketWrapper::SendBatch>("sendBatch"),
+          InstanceMethod<&UdpSocketWrapper::SendSegments>("sendSegments"),
+          InstanceMethod<&UdpSocketWrapper::Address>("address"),
+          InstanceMethod<&UdpSocketWrapper::GetStats>("getStats"),
+      });
+
+  exports.Set("QWormholeUdpSocket", func);
+  return exports;
+}
+
+UdpSocketWrapper::UdpSocketWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<UdpSocketWrapper>(info) {
+  if (info.Length() >= 1 && info[0].IsObject()) {
+    Napi::Object obj = info[0].As<Napi::Object>();
+    if (obj.Has("host") && obj.Get("host").IsString()) {
+      options_.host = obj.Get("host").As<Napi::String>().Utf8Value();
+    }
+    if (obj.Has("port") && obj.Get("port").IsNumber()) {
+      options_.port = static_cast<uint16_t>(obj.Get("port").As<Napi::Number>().Uint32Value());
+    }
+    if (obj.Has("type") && obj.Get("type").IsString()) {
+      options_.ipv6 = obj.Get("type").As<Napi::String>().Utf8Value() == "udp6";
+    }
+    if (obj.Has("gro") && obj.Get("gro").IsBoolean()) {
+      options_.gro = obj.Get("gro").As<Napi::Boolean>().Value();
+    }
+    if (obj.Has("batchSize") && obj.Get("batchSize").IsNumber()) {
+      const auto size = obj.Get("batchSize").As<Napi::Number>().Int64Value();
+      if (size > 0) options_.batch = std::min<size_t>(static_cast<size_t>(size), 1024);
+    }
+    if (obj.Has("maxDatagramBytes") && obj.Get("maxDatagramBytes").IsNumber()) {
+      const auto size = obj.Get("maxDatagramBytes").As<Napi::Number>().Int64Value();
+      if (size > 0) options_.max_datagram = std::min<size_t>(static_cast<size_t>(size), kMaxUdpDatagram);
+    }
+  }
+  if (options_.host.empty()) options_.host = options_.ipv6 ? "::" : "0.0.0.0";
+  // A merged GRO datagram can fill a whole slot.
+  if (options_.gro) options_.max_datagram = kMaxUdpDatagram;
+}
+
+UdpSocketWrapper::~UdpSocketWrapper() {
+  Stop();
+  if (tsfn_ready_) {
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+}
+
+Napi::Object UdpSocketWrapper::AddressObject(Napi::Env env) const {
+  Napi::Object address = Napi::Object::New(env);
+  address.Set("address", options_.host);
+  address.Set("port", bound_port_);
+  address.Set("family", options_.ipv6 ? "IPv6" : "IPv4");
+  return address;
+}
+
+Napi::Value UdpSocketWrapper::Bind(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  auto deferred = Napi::Promise::Deferred::New(env);
+
+  if (running_) {
+    deferred.Reject(Napi::Error::New(env, "Socket already bound").Value());
+    return deferred.Promise();
+  }
+
+  try {
+    socket_.reset(new libsocket::inet_dgram_server(
+        options_.host, std::to_string(options_.port),
+        options_.ipv6 ? LIBSOCKET_IPv6 : LIBSOCKET_IPv4, SOCK_NONBLOCK | SOCK_CLOEXEC));
+  } catch (const libsocket::socket_exception& e) {
+    deferred.Reject(Napi::Error::New(env, "Could not bind " + options_.host + ":" +
+                                              std::to_string(options_.port) + ": " + e.mesg)
+                        .Value());
+    return deferred.Promise();
+  }
+  gro_active_ = options_.gro && socket_->enable_gro();
+
+  bound_port_ = options_.port;
+  struct sockaddr_storage bound {};
+  socklen_t len = sizeof bound;
+  if (getsockname(socket_->getfd(), reinterpret_cast<struct sockaddr*>(&bound), &len) == 0) {
+    std::string ignored;
+    FormatPeer(bound, &ignored, &bound_port_);
+  }
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  struct epoll_event wake {};
+  wake.events = EPOLLIN;
+  wake.data.u64 = kWakeToken;
+  struct epoll_event readable {};
+  readable.events = EPOLLIN;
+  readable.data.u64 = kSocketToken;
+  if (epoll_fd_ < 0 || wake_fd_ < 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake) != 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, socket_->getfd(), &readable) != 0) {
+    const std::string error = std::string("epoll setup failed: ") + std::strerror(errno);
+    Stop();
+    deferred.Reject(Napi::Error::New(env, error).Value());
+    return deferred.Promise();
+  }
+
+  if (self_ref_.IsEmpty()) {
+    // Keeps the wrapper alive while events can still reach it.
+    self_ref_ = Napi::ObjectReference::New(info.This().As<Napi::Object>(), 1);
+  }
+  tsfn_ = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+      "QWormholeUdpSocketEvents", 0, 1);
+  tsfn_ready_ = true;
+  rx_slab_.resize(options_.batch * options_.max_datagram);
+  rx_slots_.resize(options_.batch);
+  running_ = true;
+  thread_ = std::thread(&UdpSocketWrapper::Run, this);
+
+  Emit([this](Napi::Env env, Napi::Object self, Napi::Function emit) {
+    emit.Call(self, {Napi::String::New(env, "listening"), AddressObject(env)});
+  });
+  deferred.Resolve(AddressObject(env));
+  return deferred.Promise();
+}
+
+void UdpSocketWrapper::Stop() {
+  if (running_.exchange(false) && wake_fd_ >= 0) {
+    const uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fd_, &one, sizeof one);
+    (void)ignored;
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  socket_.reset();
+  if (epoll_fd_ >= 0) {
+    ::close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+  if (wake_fd_ >= 0) {
+    ::close(wake_fd_);
+    wake_fd_ = -1;
+  }
+  peers_.clear();
+}
+
+Napi::Value UdpSocketWrapper::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Stop();
+  if (tsfn_ready_) {
+    Emit([this](Napi::Env env, Napi::Object self, Napi::Function emit) {
+      emit.Call(self, {Napi::String::New(env, "close"), env.Undefined()});
+      if (!running_) self_ref_.Reset();
+    });
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+  return env.Undefined();
+}
+
+Napi::Value UdpSocketWrapper::Address(const Napi::CallbackInfo& info) {
+  return AddressObject(info.Env());
+}
+
+void UdpSocketWrapper::Run() {
+  struct epoll_event events[2];
+  while (running_) {
+    const int ready = epoll_wait(epoll_fd_, events, 2, -1);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    for (int i = 0; i < ready; ++i) {
+      if (events[i].data.u64 == kWakeToken) {
+        uint64_t count = 0;
+        ssize_t ignored = ::read(wake_fd_, &count, sizeof count);
+        (void)ignored;
+        continue;
+      }
+      ReceiveReady();
+    }
+  }
+}
+
+// Level-triggered: after kMaxReadsPerEvent full batches the next wait
+// reports the socket again, so the wake fd is never starved.
+void UdpSocketWrapper::ReceiveReady() {
+  const size_t slot_bytes = options_.max_datagram;
+  for (int round = 0; round < kMaxReadsPerEvent && running_; ++round) {
+    for (size_t i = 0; i < rx_slots_.size(); ++i) {
+      rx_slots_[i] = libsocket::dgram_message(rx_slab_.data() + i * slot_bytes, slot_bytes);
+    }
+    // The non-throwing form: a drained socket (EAGAIN) ends most passes.
+    const int received = socket_->try_rcvmmsg(rx_slots_.data(), rx_slots_.size());
+    if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      const std::string message = std::string("recvmmsg failed: ") + std::strerror(errno);
+      Emit([message](Napi::Env env, Napi::Object self, Napi::Function emit) {
+        emit.Call(self, {Napi::String::New(env, "error"), Napi::Error::New(env, message).Value()});
+      });
+      return;
+    }
+    if (received <= 0) return;
+
+    size_t received_bytes = 0;
+    for (int i = 0; i < received; ++i) received_bytes += rx_slots_[i].len;
+    PacketBlockPool::Block block = rx_pool_->Acquire(received_bytes);
+    std::vector<Datagram> batch;
+    batch.reserve(static_cast<size_t>(received));
+    for (int i = 0; i < received; ++i) {
+      const libsocket::dgram_message& slot = rx_slots_[i];
+      // A datagram cut short by the slot is useless to a transport.
+      if (slot.truncated) continue;
+      Datagram head;
+      FormatPeer(slot.peer, &head.address, &head.port);
+      const size_t segment = slot.segment_size > 0 ? slot.segment_size : slot.len;
+      const uint8_t* data = static_cast<const uint8_t*>(slot.data);
+      if (slot.len == 0) {
+        head.offset = block->size();
+        batch.push_back(std::move(head));
+        continue;
+      }
+      // GRO hands over runs of equal datagrams; split them back apart.
+      for (size_t off = 0; off < slot.len; off += segment) {
+        Datagram datagram = head;
+        datagram.offset = block->size();
+        datagram.length = std::min(segment, slot.len - off);
+        block->insert(block->end(), data + off, data + off + datagram.length);
+        batch.push_back(std::move(datagram));
+      }
+    }
+
+    if (!batch.empty()) {
+      datagrams_in_.fetch_add(batch.size(), std::memory_order_relaxed);
+      batches_in_.fetch_add(1, std::memory_order_relaxed);
+      Emit([block = std::move(block), batch = std::move(batch)](
+               Napi::Env env, Napi::Object self, Napi::Function emit) {
+        auto payload_for = [&](const Datagram& datagram) {
+          Napi::Object payload = Napi::Object::New(env);
+          payload.Set("data", WrapPacket(env, block, datagram.offset, datagram.length));
+          payload.Set("address", datagram.address);
+          payload.Set("port", datagram.port);
+          return payload;
+        };
+        if (batch.size() == 1) {
+          emit.Call(self, {Napi::String::New(env, "message"), payload_for(batch.front())});
+          return;
+        }
+        Napi::Array payloads = Napi::Array::New(env, batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+          payloads.Set(static_cast<uint32_t>(i), payload_for(batch[i]));
+        }
+        emit.Call(self, {Napi::String::New(env, "messages"), payloads});
+      });
+    }
+    if (static_cast<size_t>(received) < rx_slots_.size()) return;
+  }
+}
+
+// Resolves "address:port" once; KCP talks to the same few peers all the time.
+const UdpSocketWrapper::Peer* UdpSocketWrapper::PeerFor(Napi::Env env,
+                                                        const Napi::Value& port,
+                                                        const Napi::Value& address) {
+  if (!port.IsNumber()) {
+    Napi::TypeError::New(env, "port required").ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  const std::string host = address.IsString() ? address.As<Napi::String>().Utf8Value()
+                                              : (options_.ipv6 ? "::1" : "127.0.0.1");
+  const std::string service = std::to_string(port.As<Napi::Number>().Uint32Value());
+  const std::string key = host + ":" + service;
+  auto it = peers_.find(key);
+  if (it != peers_.end()) return &it->second;
+
+  Peer peer;
+  try {
+    peer.len = socket_->resolve(host, service, &peer.addr);
+  } catch (const libsocket::socket_exception& e) {
+    Napi::Error::New(env, e.mesg).ThrowAsJavaScriptException();
+    return nullptr;
+  }
+  if (peers_.size() >= kMaxUdpPeerCache) peers_.clear();
+  return &peers_.emplace(key, peer).first->second;
+}
+
+Napi::Value UdpSocketWrapper::Send(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!socket_) {
+    Napi::Error::New(env, "Socket not bound").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 2 || !info[0].IsBuffer()) {
+    Napi::TypeError::New(env, "send(data, port, address?) required").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  const Peer* peer = PeerFor(env, info[1], info.Length() > 2 ? info[2] : env.Undefined());
+  if (peer == nullptr) return env.Undefined();
+
+  auto buf = info[0].As<Napi::Buffer<uint8_t>>();
+  tx_batch_.assign(1, libsocket::dgram_message(buf.Data(), buf.Length()));
+  std::memcpy(&tx_batch_[0].peer, &peer->addr, peer->len);
+  tx_batch_[0].peerlen = peer->len;
+  const int sent = socket_->try_sndmmsg(tx_batch_.data(), 1);
+  if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+    Napi::Error::New(env, std::string("sendmmsg failed: ") + std::strerror(errno))
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (sent == 1) ++datagrams_out_;
+  return Napi::Boolean::New(env, sent == 1);
+}
+
+// sendBatch(datagrams, port?, address?): each entry is a Buffer for the
+// given peer or { data, port, address }. Returns how many the kernel took.
+Napi::Value UdpSocketWrapper::SendBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!socket_) {
+    Napi::Error::New(env, "Socket not bound").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "sendBatch(datagrams, port?, address?) requires an array")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Array items = info[0].As<Napi::Array>();
+  const Napi::Value default_port = info.Length() > 1 ? info[1] : env.Undefined();
+  const Napi::Value default_address = info.Length() > 2 ? info[2] : env.Undefined();
+
+  tx_batch_.clear();
+  tx_batch_.reserve(items.Length());
+  for (uint32_t i = 0; i < items.Length(); ++i) {
+    Napi::Value item = items.Get(i);
+    Napi::Value data = item;
+    Napi::Value port = default_port;
+    Napi::Value address = default_address;
+    if (!item.IsBuffer() && item.IsObject()) {
+      Napi::Object entry = item.As<Napi::Object>();
+      data = entry.Get("data");
+      if (entry.Has("port")) port = entry.Get("port");
+      if (entry.Has("address")) address = entry.Get("address");
+    }
+    if (!data.IsBuffer()) {
+      Napi::TypeError::New(env, "sendBatch datagrams must be Buffers")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    const Peer* peer = PeerFor(env, port, address);
+    if (peer == nullptr) return env.Undefined();
+    auto buf = data.As<Napi::Buffer<uint8_t>>();
+    tx_batch_.emplace_back(buf.Data(), buf.Length());
+    std::memcpy(&tx_batch_.back().peer, &peer->addr, peer->len);
+    tx_batch_.back().peerlen = peer->len;
+  }
+  if (tx_batch_.empty()) return Napi::Number::New(env, 0);
+
+  const int sent = socket_->try_sndmmsg(tx_batch_.data(), tx_batch_.size());
+  if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+    Napi::Error::New(env, std::string("sendmmsg failed: ") + std::strerror(errno))
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (sent > 0) datagrams_out_ += static_cast<uint64_t>(sent);
+  return Napi::Number::New(env, sent < 0 ? 0 : sent);
+}
+
+// sendSegments(data, segmentSize, port, address?): sends data as datagrams
+// of segmentSize bytes, with UDP GSO where available. Returns bytes taken.
+Napi::Value UdpSocketWrapper::SendSegments(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!socket_) {
+    Napi::Error::New(env, "Socket not bound").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 3 || !info[0].IsBuffer() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "sendSegments(data, segmentSize, port, address?) required")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  const Peer* peer = PeerFor(env, info[2], info.Length() > 3 ? info[3] : env.Undefined());
+  if (peer == nullptr) return env.Undefined();
+
+  auto buf = info[0].As<Napi::Buffer<uint8_t>>();
+  const size_t segment = info[1].As<Napi::Number>().Uint32Value();
+  try {
+    const ssize_t sent = socket_->sndsegments(buf.Data(), buf.Length(), segment,
+                                              reinterpret_cast<const struct sockaddr*>(&peer->addr),
+                                              peer->len);
+    return Napi::Number::New(env, sent < 0 ? 0.0 : static_cast<double>(sent));
+  } catch (const libsocket::socket_exception& e) {
+    Napi::Error::New(env, e.mesg).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+}
+
+// getStats(): receive batching and block reuse; sendSegments is not counted.
+Napi::Value UdpSocketWrapper::GetStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("datagramsIn", static_cast<double>(datagrams_in_.load(std::memory_order_relaxed)));
+  out.Set("batchesIn", static_cast<double>(batches_in_.load(std::memory_order_relaxed)));
+  out.Set("datagramsOut", static_cast<double>(datagrams_out_));
+  out.Set("blocksAllocated", static_cast<double>(rx_pool_->allocated()));
+  out.Set("blocksReused", static_cast<double>(rx_pool_->reused()));
+  out.Set("gro", gro_active_);
+  return out;
+}
+
+void UdpSocketWrapper::Emit(std::function<void(Napi::Env, Napi::Object, Napi::Function)> build) {
+  if (!tsfn_ready_) return;
+  tsfn_.NonBlockingCall([this, build = std::move(build)](Napi::Env env, Napi::Function) {
+    if (self_ref_.IsEmpty()) return;
+    Napi::Object self = self_ref_.Value();
+    if (self.Has("emit") && self.Get("emit").IsFunction()) {
+      build(env, self, self.Get("emit").As<Napi::Function>());
+    }
+  });
+}
+
+// Unix datagram socket for local fan-in, e.g. many producers on a host
+// reporting to one aggregator. Each datagram is a message, so there is no
+// framing. A bound socket receives on a loop thread with recvmmsg and
+// emits each batch as one event, as UdpSocketWrapper does. Sends go out
+// from the JS thread as one sendmmsg per batch. Paths starting with a NUL
+// byte are Linux abstract names.
+class UnixDgramSocketWrapper : public Napi::ObjectWrap<UnixDgramSocketWrapper> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  explicit UnixDgramSocketWrapper(const Napi::CallbackInfo& info);
+  ~UnixDgramSocketWrapper() override;
+
+ private:
+  struct Options {
+    // Bound and received on when set; otherwise the socket only sends.
+    std::string path;
+    // connect(2)ed peer: sends without a path go here, with no name lookup.
+    std::string connect;
+    size_t batch = kDefaultUdpBatch;
+    size_t max_datagram = kMaxUdpDatagram;
+    std::optional<int> receive_buffer;
+    std::optional<int> send_buffer;
+  };
+
+  struct Datagram {
+    size_t offset = 0;
+    size_t length = 0;
+    std::string path;
+  };
+
+  struct Peer {
+    struct sockaddr_un addr;
+    socklen_t len = 0;
+  };
+
+  static constexpr uint64_t kWakeToken = 0;
+  static constexpr uint64_t kSocketToken = 1;
+
+  Napi::Value Bind(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+  Napi::Value Send(const Napi::CallbackInfo& info);
+  Napi::Value SendBatch(const Napi::CallbackInfo& info);
+  Napi::Value Address(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+  // Loop thread.
+  void Run();
+  void ReceiveReady();
+
+  // JS thread.
+  void Stop();
+  void ApplyBuffers();
+  bool PeerFor(Napi::Env env, const Napi::Value& path, struct mmsghdr* msg);
+  int SendQueued(Napi::Env env);
+  Napi::Object AddressObject(Napi::Env env) const;
+  void Emit(std::function<void(Napi::Env, Napi::Object, Napi::Function)> build);
+
+  Options options_;
+  std::unique_ptr<libsocket::unix_dgram> socket_;
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+  int receive_buffer_ = 0;
+  int send_buffer_ = 0;
+
+  // Loop thread only.
+  std::vector<uint8_t> rx_slab_;
+  std::vector<struct mmsghdr> rx_msgs_;
+  std::vector<struct iovec> rx_iov_;
+  std::vector<struct sockaddr_un> rx_names_;
+  std::shared_ptr<PacketBlockPool> rx_pool_ = std::make_shared<PacketBlockPool>();
+  std::atomic<uint64_t> datagrams_in_{0};
+  std::atomic<uint64_t> batches_in_{0};
+  std::atomic<uint64_t> truncated_{0};
+
+  // JS thread only.
+  std::vector<struct mmsghdr> tx_msgs_;
+  std::vector<struct iovec> tx_iov_;
+  std::unordered_map<std::string, Peer> peers_;
+  uint64_t datagrams_out_ = 0;
+  uint64_t would_block_ = 0;
+  uint64_t no_receiver_ = 0;
+  Napi::ThreadSafeFunction tsfn_;
+  bool tsfn_ready_ = false;
+  Napi::ObjectReference self_ref_;
+};
+
+// The name in a received sockaddr_un: "" for an unbound sender, a leading
+// NUL for an abstract one.
+std::string FormatUnixPeer(const struct sockaddr_un& addr, socklen_t len) {
+  const size_t offset = offsetof(struct sockaddr_un, sun_path);
+  if (len <= offset) return std::string();
+  const size_t max = std::min<size_t>(len - offset, sizeof addr.sun_path);
+  if (addr.sun_path[0] != '\0') {
+    return std::string(addr.sun_path, strnlen(addr.sun_path, max));
+  }
+  // libsocket binds abstract names over the whole sun_path, NUL padded.
+  return std::string(addr.sun_path, 1 + strnlen(addr.sun_path + 1, max - 1));
+}
+
+Napi::Object UnixDgramSocketWrapper::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "QWormholeUnixDgram",
+      {
+          InstanceMethod<&UnixDgramSocketWrapper::Bind>("bind"),
+          InstanceMethod<&UnixDgramSocketWrapper::Close>("close"),
+          InstanceMethod<&UnixDgramSocketWrapper::Send>("send"),
+          InstanceMethod<&UnixDgramSocketWrapper::SendBatch>("sendBatch"),
+          InstanceMethod<&UnixDgramSocketWrapper::Address>("address"),
+          InstanceMethod<&UnixDgramSocketWrapper::GetStats>("getStats"),
+      });
+
+  exports.Set("QWormholeUnixDgram", func);
+  return exports;
+}
+
+UnixDgramSocketWrapper::UnixDgramSocketWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<UnixDgramSocketWrapper>(info) {
+  if (info.Length() >= 1 && info[0].IsObject()) {
+    Napi::Object obj = info[0].As<Napi::Object>();
+    if (obj.Has("path") && obj.Get("path").IsString()) {
+      options_.path = obj.Get("path").As<Napi::String>().Utf8Value();
+    }
+    if (obj.Has("connect") && obj.Get("connect").IsString()) {
+      options_.connect = obj.Get("connect").As<Napi::String>().Utf8Value();
+    }
+    if (obj.Has("batchSize") && obj.Get("batchSize").IsNumber()) {
+      const auto size = obj.Get("batchSize").As<Napi::Number>().Int64Value();
+      if (size > 0) options_.batch = std::min<size_t>(static_cast<size_t>(size), 1024);
+    }
+    if (obj.Has("maxDatagramBytes") && obj.Get("maxDatagramBytes").IsNumber()) {
+      const auto size = obj.Get("maxDatagramBytes").As<Napi::Number>().Int64Value();
+      if (size > 0) options_.max_datagram = std::min<size_t>(static_cast<size_t>(size), kMaxUdpDatagram);
+    }
+    const auto read_buffer = [&obj](const char* key, std::optional<int>* out) {
+      if (obj.Has(key) && obj.Get(key).IsNumber()) {
+        const auto bytes = obj.Get(key).As<Napi::Number>().Int64Value();
+        if (bytes > 0) *out = static_cast<int>(std::min<int64_t>(bytes, INT32_MAX / 2));
+      }
+    };
+    read_buffer("receiveBufferBytes", &options_.receive_buffer);
+    read_buffer("sendBufferBytes", &options_.send_buffer);
+  }
+}
+
+UnixDgramSocketWrapper::~UnixDgramSocketWrapper() {
+  Stop();
+  if (tsfn_ready_) {
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+}
+
+Napi::Object UnixDgramSocketWrapper::AddressObject(Napi::Env env) const {
+  Napi::Object address = Napi::Object::New(env);
+  address.Set("path", options_.path);
+  if (!options_.connect.empty()) address.Set("connect", options_.connect);
+  address.Set("receiveBufferBytes", static_cast<double>(receive_buffer_));
+  address.Set("sendBufferBytes", static_cast<double>(send_buffer_));
+  return address;
+}
+
+// SO_RCVBUFFORCE/SO_SNDBUFFORCE pass net.core.*mem_max with CAP_NET_ADMIN;
+// without it the plain option clamps there. The kernel doubles what it
+// takes; the effective sizes are read back for address() and getStats().
+void UnixDgramSocketWrapper::ApplyBuffers() {
+  const int fd = socket_->getfd();
+  const auto apply = [fd](const std::optional<int>& bytes, int forced, int plain) {
+    if (bytes && !SetSocketInt(fd, SOL_SOCKET, forced, *bytes)) {
+      SetSocketInt(fd, SOL_SOCKET, plain, *bytes);
+    }
+  };
+  apply(options_.receive_buffer, SO_RCVBUFFORCE, SO_RCVBUF);
+  apply(options_.send_buffer, SO_SNDBUFFORCE, SO_SNDBUF);
+  receive_buffer_ = GetSocketInt(fd, SOL_SOCKET, SO_RCVBUF);
+  send_buffer_ = GetSocketInt(fd, SOL_SOCKET, SO_SNDBUF);
+}
+
+Napi::Value UnixDgramSocketWrapper::Bind(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  auto deferred = Napi::Promise::Deferred::New(env);
+
+  if (socket_) {
+    deferred.Reject(Napi::Error::New(env, "Socket already bound").Value());
+    return deferred.Promise();
+  }
+
+  const int flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+  const bool receives = !options_.path.empty();
+  try {
+    if (receives && options_.connect.empty()) {
+      socket_.reset(new libsocket::unix_dgram_server(options_.path, flags));
+    } else {
+      auto* client = receives ? new libsocket::unix_dgram_client(options_.path, flags)
+                              : new libsocket::unix_dgram_client(flags);
+      socket_.reset(client);
+      if (!options_.connect.empty()) client->connect(options_.connect);
+    }
+  } catch (const libsocket::socket_exception& e) {
+    socket_.reset();
+    const std::string target = options_.connect.empty() ? options_.path : options_.connect;
+    deferred.Reject(Napi::Error::New(env, "Could not open " + target + ": " + e.mesg).Value());
+    return deferred.Promise();
+  }
+  ApplyBuffers();
+
+  if (receives) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event wake {};
+    wake.events = EPOLLIN;
+    wake.data.u64 = kWakeToken;
+    struct epoll_event readable {};
+    readable.events = EPOLLIN;
+    readable.data.u64 = kSocketToken;
+    if (epoll_fd_ < 0 || wake_fd_ < 0 ||
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake) != 0 ||
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, socket_->getfd(), &readable) != 0) {
+      const std::string error = std::string("epoll setup failed: ") + std::strerror(errno);
+      Stop();
+      deferred.Reject(Napi::Error::New(env, error).Value());
+      return deferred.Promise();
+    }
+  }
+
+  if (self_ref_.IsEmpty()) {
+    // Keeps the wrapper alive while events can still reach it.
+    self_ref_ = Napi::ObjectReference::New(info.This().As<Napi::Object>(), 1);
+  }
+  tsfn_ = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+      "QWormholeUnixDgramEvents", 0, 1);
+  tsfn_ready_ = true;
+  if (receives) {
+    const size_t slot_bytes = options_.max_datagram;
+    rx_slab_.resize(options_.batch * slot_bytes);
+    rx_msgs_.resize(options_.batch);
+    rx_iov_.resize(options_.batch);
+    rx_names_.resize(options_.batch);
+    running_ = true;
+    thread_ = std::thread(&UnixDgramSocketWrapper::Run, this);
+  }
+
+  Emit([this](Napi::Env env, Napi::Object self, Napi::Function emit) {
+    emit.Call(self, {Napi::String::New(env, "listening"), AddressObject(env)});
+  });
+  deferred.Resolve(AddressObject(env));
+  return deferred.Promise();
+}
+
+void UnixDgramSocketWrapper::Stop() {
+  if (running_.exchange(false) && wake_fd_ >= 0) {
+    const uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fd_, &one, sizeof one);
+    (void)ignored;
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (socket_ && !options_.path.empty() && options_.path[0] != '\0') {
+    // The bound path outlives the socket otherwise.
+    ::unlink(options_.path.c_str());
+  }
+  socket_.reset();
+  if (epoll_fd_ >= 0) {
+    ::close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+  if (wake_fd_ >= 0) {
+    ::close(wake_fd_);
+    wake_fd_ = -1;
+  }
+  peers_.clear();
+}
+
+Napi::Value UnixDgramSocketWrapper::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Stop();
+  if (tsfn_ready_) {
+    Emit([this](Napi::Env env, Napi::Object self, Napi::Function emit) {
+      emit.Call(self, {Napi::String::New(env, "close"), env.Undefined()});
+      if (!running_) self_ref_.Reset();
+    });
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+  return env.Undefined();
+}
+
+Napi::Value UnixDgramSocketWrapper::Address(const Napi::CallbackInfo& info) {
+  return AddressObject(info.Env());
+}
+
+void UnixDgramSocketWrapper::Run() {
+  struct epoll_event events[2];
+  while (running_) {
+    const int ready = epoll_wait(epoll_fd_, events, 2, -1);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    for (int i = 0; i < ready; ++i) {
+      if (events[i].data.u64 == kWakeToken) {
+        uint64_t count = 0;
+        ssize_t ignored = ::read(wake_fd_, &count, sizeof count);
+        (void)ignored;
+        continue;
+      }
+      ReceiveReady();
+    }
+  }
+}
+
+// As UdpSocketWrapper::ReceiveReady(): up to kMaxReadsPerEvent recvmmsg
+// calls per wakeup, each batch compacted into one pooled block.
+void UnixDgramSocketWrapper::ReceiveReady() {
+  const size_t slot_bytes = options_.max_datagram;
+  for (int round = 0; round < kMaxReadsPerEvent && running_; ++round) {
+    for (size_t i = 0; i < rx_msgs_.size(); ++i) {
+      rx_iov_[i] = {rx_slab_.data() + i * slot_bytes, slot_bytes};
+      rx_msgs_[i] = {};
+      rx_msgs_[i].msg_hdr.msg_name = &rx_names_[i];
+      rx_msgs_[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_un);
+      rx_msgs_[i].msg_hdr.msg_iov = &rx_iov_[i];
+      rx_msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+    const int received = recvmmsg(socket_->getfd(), rx_msgs_.data(),
+                                  static_cast<unsigned int>(rx_msgs_.size()), MSG_DONTWAIT,
+                                  nullptr);
+    if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      const std::string message = std::string("recvmmsg failed: ") + std::strerror(errno);
+      Emit([message](Napi::Env env, Napi::Object self, Napi::Function emit) {
+        emit.Call(self, {Napi::String::New(env, "error"), Napi::Error::New(env, message).Value()});
+      });
+      return;
+    }
+    if (received <= 0) return;
+
+    size_t received_bytes = 0;
+    for (int i = 0; i < received; ++i) received_bytes += rx_msgs_[i].msg_len;
+    PacketBlockPool::Block block = rx_pool_->Acquire(received_bytes);
+    std::vector<Datagram> batch;
+    batch.reserve(static_cast<size_t>(received));
+    for (int i = 0; i < received; ++i) {
+      const struct mmsghdr& msg = rx_msgs_[i];
+      if (msg.msg_hdr.msg_flags & MSG_TRUNC) {
+        truncated_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      Datagram datagram;
+      datagram.offset = block->size();
+      datagram.length = msg.msg_len;
+      datagram.path = FormatUnixPeer(rx_names_[i], msg.msg_hdr.msg_namelen);
+      const uint8_t* data = rx_slab_.data() + static_cast<size_t>(i) * slot_bytes;
+      block->insert(block->end(), data, data + msg.msg_len);
+      batch.push_back(std::move(datagram));
+    }
+
+    if (!batch.empty()) {
+      datagrams_in_.fetch_add(batch.size(), std::memory_order_relaxed);
+      batches_in_.fetch_add(1, std::memory_order_relaxed);
+      Emit([block = std::move(block), batch = std::move(batch)](
+               Napi::Env env, Napi::Object self, Napi::Function emit) {
+        // Producers send runs of datagrams; their path string is made once.
+        const std::string* last_path = nullptr;
+        Napi::Value path_value;
+        auto payload_for = [&](const Datagram& datagram) {
+          if (!last_path || *last_path != datagram.path) {
+            last_path = &datagram.path;
+            path_value = Napi::String::New(env, datagram.path);
+          }
+          Napi::Object payload = Napi::Object::New(env);
+          payload.Set("data", WrapPacket(env, block, datagram.offset, datagram.length));
+          payload.Set("path", path_value);
+          return payload;
+        };
+        if (batch.size() == 1) {
+          emit.Call(self, {Napi::String::New(env, "message"), payload_for(batch.front())});
+          return;
+        }
+        Napi::Array payloads = Napi::Array::New(env, batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+          payloads.Set(static_cast<uint32_t>(i), payload_for(batch[i]));
+        }
+        emit.Call(self, {Napi::String::New(env, "messages"), payloads});
+      });
+    }
+    if (static_cast<size_t>(received) < rx_msgs_.size()) return;
+  }
+}
+
+// Points msg at `path`'s address, built once per path the way libsocket
+// binds it; undefined uses the connected peer.
+bool UnixDgramSocketWrapper::PeerFor(Napi::Env env, const Napi::Value& path,
+                                     struct mmsghdr* msg) {
+  if (!path.IsString()) {
+    if (!options_.connect.empty()) return true;
+    Napi::TypeError::New(env, "path required").ThrowAsJavaScriptException();
+    return false;
+  }
+  const std::string key = path.As<Napi::String>().Utf8Value();
+  auto it = peers_.find(key);
+  if (it == peers_.end()) {
+    Peer peer;
+    std::memset(&peer.addr, 0, sizeof peer.addr);
+    peer.addr.sun_family = AF_UNIX;
+    if (key.empty() || key.size() >= sizeof peer.addr.sun_path ||
+        (key[0] == '\0' && key.size() < 2)) {
+      Napi::TypeError::New(env, "Invalid unix socket path").ThrowAsJavaScriptException();
+      return false;
+    }
+    std::memcpy(peer.addr.sun_path, key.data(), key.size());
+    peer.len = static_cast<socklen_t>(
+        offsetof(struct sockaddr_un, sun_path) +
+        (key[0] == '\0' ? sizeof peer.addr.sun_path : key.size()));
+    if (peers_.size() >= kMaxUdpPeerCache) peers_.clear();
+    it = peers_.emplace(key, peer).first;
+  }
+  msg->msg_hdr.msg_name = &it->second.addr;
+  msg->msg_hdr.msg_namelen = it->second.len;
+  return true;
+}
+
+// One sendmmsg for tx_msgs_; the kernel stops at the first datagram it
+// refuses. A full receiver (EAGAIN) or none at the path (ECONNREFUSED,
+// ENOENT) is counted rather than thrown, since telemetry is lossy by
+// design. Returns the datagrams taken, or -1 after throwing.
+int UnixDgramSocketWrapper::SendQueued(Napi::Env env) {
+  for (size_t i = 0; i < tx_msgs_.size(); ++i) {
+    tx_msgs_[i].msg_hdr.msg_iov = &tx_iov_[i];
+    tx_msgs_[i].msg_hdr.msg_iovlen = 1;
+  }
+  const int sent = sendmmsg(socket_->getfd(), tx_msgs_.data(),
+                            static_cast<unsigned int>(tx_msgs_.size()), MSG_DONTWAIT);
+  const size_t taken = sent > 0 ? static_cast<size_t>(sent) : 0;
+  datagrams_out_ += taken;
+  if (taken < tx_msgs_.size()) {
+    if (sent >= 0 || errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+      would_block_ += tx_msgs_.size() - taken;
+    } else if (errno == ECONNREFUSED || errno == ENOENT) {
+      no_receiver_ += tx_msgs_.size() - taken;
+    } else {
+      Napi::Error::New(env, std::string("sendmmsg failed: ") + std::strerror(errno))
+          .ThrowAsJavaScriptException();
+      return -1;
+    }
+  }
+  return static_cast<int>(taken);
+}
+
+Napi::Value UnixDgramSocketWrapper::Send(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!socket_) {
+    Napi::Error::New(env, "Socket not bound").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 1 || !info[0].IsBuffer()) {
+    Napi::TypeError::New(env, "send(data, path?) required").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  tx_msgs_.assign(1, {});
+  if (!PeerFor(env, info.Length() > 1 ? info[1] : env.Undefined(), &tx_msgs_[0])) {
+    return env.Undefined();
+  }
+  auto buf = info[0].As<Napi::Buffer<uint8_t>>();
+  tx_iov_.assign(1, {buf.Data(), buf.Length()});
+  const int sent = SendQueued(env);
+  if (sent < 0) return env.Undefined();
+  return Napi::Boolean::New(env, sent == 1);
+}
+
+// sendBatch(datagrams, path?): each entry is a Buffer for `path` (or the
+// connected peer) or { data, path }. Returns how many the kernel took.
+Napi::Value UnixDgramSocketWrapper::SendBatch(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!socket_) {
+    Napi::Error::New(env, "Socket not bound").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    Napi::TypeError::New(env, "sendBatch(datagrams, path?) requires an array")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Array items = info[0].As<Napi::Array>();
+  const Napi::Value default_path = info.Length() > 1 ? info[1] : env.Undefined();
+
+  tx_msgs_.assign(items.Length(), {});
+  tx_iov_.resize(items.Length());
+  for (uint32_t i = 0; i < items.Length(); ++i) {
+    Napi::Value item = items.Get(i);
+    Napi::Value data = item;
+    Napi::Value path = default_path;
+    if (!item.IsBuffer() && item.IsObject()) {
+      Napi::Object entry = item.As<Napi::Object>();
+      data = entry.Get("data");
+      if (entry.Has("path")) path = entry.Get("path");
+    }
+    if (!data.IsBuffer()) {
+      Napi::TypeError::New(env, "sendBatch datagrams must be Buffers")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!PeerFor(env, path, &tx_msgs_[i])) return env.Undefined();
+    auto buf = data.As<Napi::Buffer<uint8_t>>();
+    tx_iov_[i] = {buf.Data(), buf.Length()};
+  }
+  if (tx_msgs_.empty()) return Napi::Number::New(env, 0);
+  const int sent = SendQueued(env);
+  if (sent < 0) return env.Undefined();
+  return Napi::Number::New(env, sent);
+}
+
+// net.unix.max_dgram_qlen: how many datagrams queue at a receiver before
+// senders see EAGAIN, whatever its receive buffer. -1 when unreadable.
+int UnixMaxDgramQlen() {
+  FILE* file = std::fopen("/proc/sys/net/unix/max_dgram_qlen", "r");
+  if (!file) return -1;
+  int qlen = -1;
+  if (std::fscanf(file, "%d", &qlen) != 1) qlen = -1;
+  std::fclose(file);
+  return qlen;
+}
+
+// getStats(): receive batching, block reuse and the datagrams the kernel
+// did not take.
+Napi::Value UnixDgramSocketWrapper::GetStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("datagramsIn", static_cast<double>(datagrams_in_.load(std::memory_order_relaxed)));
+  out.Set("batchesIn", static_cast<double>(batches_in_.load(std::memory_order_relaxed)));
+  out.Set("truncated", static_cast<double>(truncated_.load(std::memory_order_relaxed)));
+  out.Set("datagramsOut", static_cast<double>(datagrams_out_));
+  out.Set("wouldBlock", static_cast<double>(would_block_));
+  out.Set("noReceiver", static_cast<double>(no_receiver_));
+  out.Set("blocksAllocated", static_cast<double>(rx_pool_->allocated()));
+  out.Set("blocksReused", static_cast<double>(rx_pool_->reused()));
+  out.Set("receiveBufferBytes", static_cast<double>(receive_buffer_));
+  out.Set("sendBufferBytes", static_cast<double>(send_buffer_));
+  out.Set("maxDgramQlen", static_cast<double>(UnixMaxDgramQlen()));
+  return out;
+}
+
+void UnixDgramSocketWrapper::Emit(
+    std::function<void(Napi::Env, Napi::Object, Napi::Function)> build) {
+  if (!tsfn_ready_) return;
+  tsfn_.NonBlockingCall([this, build = std::move(build)](Napi::Env env, Napi::Function) {
+    if (self_ref_.IsEmpty()) return;
+    Napi::Object self = self_ref_.Value();
+    if (self.Has("emit") && self.Get("emit").IsFunction()) {
+      build(env, self, self.Get("emit").As<Napi::Function>());
+    }
+  });
+}
+
+// Hashed timing wheel for the KCP engine. Entries are lazy: rescheduling a
+// session leaves its old entry behind, and the caller skips entries whose
+// deadline no longer matches the session's when they fire.
+class TimerWheel {
+ public:
+  TimerWheel(uint32_t tick_ms, size_t slots) : tick_ms_(std::max<uint32_t>(1, tick_ms)), slots_(slots) {}
+
+  void Reset(uint64_t now_ms) {
+    current_tick_ = now_ms / tick_ms_;
+    for (auto& slot : slots_) slot.clear();
+    count_ = 0;
+  }
+
+  void Schedule(uint64_t handle, uint64_t deadline_ms) {
+    const uint64_t tick = std::max(current_tick_, (deadline_ms + tick_ms_ - 1) / tick_ms_);
+    slots_[tick % slots_.size()].push_back({handle, deadline_ms, tick});
+    ++count_;
+  }
+
+  // Calls fire(handle, deadline) for every entry due at or before now_ms.
+  template <typename F>
+  void Advance(uint64_t now_ms, F&& fire) {
+    const uint64_t target = now_ms / tick_ms_;
+    if (count_ == 0) {
+      current_tick_ = target;
+      return;
+    }
+    // After a long stall one lap over the slots covers everything due.
+    const uint64_t laps = std::min<uint64_t>(target - std::min(target, current_tick_), slots_.size() - 1);
+    for (uint64_t tick = target - laps; tick <= target; ++tick) {
+      auto& slot = slots_[tick % slots_.size()];
+      size_t kept = 0;
+      for (size_t i = 0; i < slot.size(); ++i) {
+        if (slot[i].tick <= target) {
+          --count_;
+          fire(slot[i].handle, slot[i].deadline);
+        } else {
+          slot[kept++] = slot[i];
+        }
+      }
+      slot.resize(kept);
+    }
+    current_tick_ = target;
+  }
+
+  // Milliseconds until the next entry due within one lap, -1 when nothing
+  // is scheduled. Entries further out wake the loop once per lap.
+  int NextTimeoutMs(uint64_t now_ms) const {
+    if (count_ == 0) return -1;
+    for (size_t step = 0; step < slots_.size(); ++step) {
+      const uint64_t tick = current_tick_ + step;
+      for (const Entry& entry : slots_[tick % slots_.size()]) {
+        if (entry.tick > tick) continue;
+        const uint64_t at = tick * tick_ms_;
+        return at > now_ms ? static_cast<int>(at - now_ms) : 0;
+      }
+    }
+    return static_cast<int>(slots_.size() * tick_ms_);
+  }
+
+ private:
+  struct Entry {
+    uint64_t handle;
+    uint64_t deadline;
+    uint64_t tick;
+  };
+
+  uint32_t tick_ms_;
+  uint64_t current_tick_ = 0;
+  size_t count_ = 0;
+  std::vector<std::vector<Entry>> slots_;
+};
+
+// Sequence comparison that survives 32-bit wraparound.
+inline int32_t SeqDiff(uint32_t a, uint32_t b) {
+  return static_cast<int32_t>(a - b);
+}
+
+void PutU32(uint8_t* out, uint32_t value) {
+  out[0] = static_cast<uint8_t>(value >> 24);
+  out[1] = static_cast<uint8_t>(value >> 16);
+  out[2] = static_cast<uint8_t>(value >> 8);
+  out[3] = static_cast<uint8_t>(value);
+}
+
+uint32_t GetU32(const uint8_t* in) {
+  return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+         (static_cast<uint32_t>(in[2]) << 8) | static_cast<uint32_t>(in[3]);
+}
+
+uint64_t SteadyNowMs() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now().time_since_epoch())
+                                   .count());
+}
+
+// GF(2^8) over x^8+x^4+x^3+x^2+1 (0x11d) for the KCP engine's FEC parity.
+// lo/hi hold each constant's products with every low and high nibble, the
+// tables the shuffle kernels look up sixteen bytes at a time.
+struct Gf256Tables {
+  uint8_t exp[512];
+  uint8_t log[256];
+  alignas(16) uint8_t lo[256][16];
+  alignas(16) uint8_t hi[256][16];
+
+  Gf256Tables() {
+    uint32_t x = 1;
+    for (int i = 0; i < 255; ++i) {
+      exp[i] = static_cast<uint8_t>(x);
+      log[x] = static_cast<uint8_t>(i);
+      x <<= 1;
+      if (x & 0x100) x ^= 0x11d;
+    }
+    for (int i = 255; i < 512; ++i) exp[i] = exp[i - 255];
+    log[0] = 0;
+    for (int c = 0; c < 256; ++c) {
+      for (int n = 0; n < 16; ++n) {
+        lo[c][n] = Mul(static_cast<uint8_t>(c), static_cast<uint8_t>(n));
+        hi[c][n] = Mul(static_cast<uint8_t>(c), static_cast<uint8_t>(n << 4));
+      }
+    }
+  }
+
+  uint8_t Mul(uint8_t a, uint8_t b) const {
+    if (a == 0 || b == 0) return 0;
+    return exp[log[a] + log[b]];
+  }
+
+  uint8_t Inv(uint8_t a) const { return exp[255 - log[a]]; }
+};
+
+const Gf256Tables& Gf256() {
+  static const Gf256Tables tables;
+  return tables;
+}
+
+void GfMulAddScalar(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len) {
+  const uint8_t* lo = Gf256().lo[c];
+  const uint8_t* hi = Gf256().hi[c];
+  for (size_t i = 0; i < len; ++i) {
+    dst[i] ^= lo[src[i] & 0x0f] ^ hi[src[i] >> 4];
+  }
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+__attribute__((target("ssse3"))) void GfMulAddVector(uint8_t c, const uint8_t* src,
+                                                     uint8_t* dst, size_t len) {
+  const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(Gf256().lo[c]));
+  const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(Gf256().hi[c]));
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i product =
+        _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(s, mask)),
+                      _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(s, 4), mask)));
+    __m128i* out = reinterpret_cast<__m128i*>(dst + i);
+    _mm_storeu_si128(out, _mm_xor_si128(_mm_loadu_si128(out), product));
+  }
+  GfMulAddScalar(c, src + i, dst + i, len - i);
+}
+
+bool HasGfVector() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("ssse3");
+}
+#define QWORMHOLE_GF_VECTOR "ssse3"
+#elif defined(__aarch64__)
+void GfMulAddVector(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len) {
+  const uint8x16_t lo = vld1q_u8(Gf256().lo[c]);
+  const uint8x16_t hi = vld1q_u8(Gf256().hi[c]);
+  const uint8x16_t mask = vdupq_n_u8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    const uint8x16_t s = vld1q_u8(src + i);
+    const uint8x16_t product =
+        veorq_u8(vqtbl1q_u8(lo, vandq_u8(s, mask)), vqtbl1q_u8(hi, vshrq_n_u8(s, 4)));
+    vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), product));
+  }
+  GfMulAddScalar(c, src + i, dst + i, len - i);
+}
+
+bool HasGfVector() { return true; }
+#define QWORMHOLE_GF_VECTOR "neon"
+#endif
+
+bool GfUsesVector() {
+#if defined(QWORMHOLE_GF_VECTOR)
+  static const bool vector = HasGfVector();
+  return vector;
+#else
+  return false;
+#endif
+}
+
+// Which kernel getStats() reports under fec.kernel.
+const char* GfKernel() {
+#if defined(QWORMHOLE_GF_VECTOR)
+  if (GfUsesVector()) return QWORMHOLE_GF_VECTOR;
+#endif
+  return "scalar";
+}
+
+// dst ^= c * src over GF(2^8).
+void GfMulAdd(uint8_t c, const uint8_t* src, uint8_t* dst, size_t len) {
+  if (c == 0 || len == 0) return;
+#if defined(QWORMHOLE_GF_VECTOR)
+  if (GfUsesVector()) {
+    GfMulAddVector(c, src, dst, len);
+    return;
+  }
+#endif
+  GfMulAddScalar(c, src, dst, len);
+}
+
+// Systematic Cauchy Reed-Solomon: parity shard i is the sum over data
+// shards j of 1 / (x_i + y_j), with x_i = 128 + i and y_j = j, so every
+// square submatrix is invertible and any k of a group's k + m shards
+// rebuild its data. A data shard is its payload length (2 bytes) then the
+// payload, zero-padded to the group's longest.
+uint8_t KcpFecCoefficient(size_t parity_index, size_t data_index) {
+  return Gf256().Inv(static_cast<uint8_t>((kKcpFecParityBase + parity_index) ^ data_index));
+}
+
+// Adds data shard j to parity shard i, growing the parity to cover it.
+void KcpFecAccumulate(size_t parity_index, size_t data_index, const uint8_t* payload,
+                      size_t len, std::vector<uint8_t>* parity) {
+  if (parity->size() < kKcpFecLengthBytes + len) parity->resize(kKcpFecLengthBytes + len, 0);
+  const uint8_t prefix[kKcpFecLengthBytes] = {static_cast<uint8_t>(len >> 8),
+                                              static_cast<uint8_t>(len)};
+  const uint8_t c = KcpFecCoefficient(parity_index, data_index);
+  GfMulAdd(c, prefix, parity->data(), kKcpFecLengthBytes);
+  GfMulAdd(c, payload, parity->data() + kKcpFecLengthBytes, len);
+}
+
+// Rebuilds a group's missing data shards. data[j] is null for a missing
+// shard and parity[i] for a lost one; every parity is shard_len bytes.
+// False when more shards are missing than parity arrived. Otherwise each
+// missing j gets recovered[j], its length prefix included.
+bool KcpFecRecover(const std::vector<const uint8_t*>& data, const std::vector<size_t>& data_len,
+                   const std::vector<const uint8_t*>& parity, size_t shard_len,
+                   std::vector<std::vector<uint8_t>>* recovered) {
+  std::vector<size_t> missing;
+  for (size_t j = 0; j < data.size(); ++j) {
+    if (!data[j]) missing.push_back(j);
+  }
+  std::vector<size_t> rows;
+  for (size_t i = 0; i < parity.size() && rows.size() < missing.size(); ++i) {
+    if (parity[i]) rows.push_back(i);
+  }
+  if (rows.size() < missing.size()) return false;
+  const size_t e = missing.size();
+  const Gf256Tables& gf = Gf256();
+
+  // Syndromes: each used parity less the known shards' contributions.
+  std::vector<std::vector<uint8_t>> syndromes(e);
+  for (size_t r = 0; r < e; ++r) {
+    syndromes[r].assign(parity[rows[r]], parity[rows[r]] + shard_len);
+    for (size_t j = 0; j < data.size(); ++j) {
+      if (!data[j]) continue;
+      if (kKcpFecLengthBytes + data_len[j] > shard_len) return false;
+      KcpFecAccumulate(rows[r], j, data[j], data_len[j], &syndromes[r]);
+    }
+  }
+
+  // Gauss-Jordan over the e x e Cauchy submatrix, inverse alongside.
+  std::vector<uint8_t> a(e * e);
+  std::vector<uint8_t> inv(e * e, 0);
+  for (size_t r = 0; r < e; ++r) {
+    for (size_t c = 0; c < e; ++c) a[r * e + c] = KcpFecCoefficient(rows[r], missing[c]);
+    inv[r * e + r] = 1;
+  }
+  for (size_t col = 0; col < e; ++col) {
+    size_t pivot = col;
+    while (pivot < e && a[pivot * e + col] == 0) ++pivot;
+    if (pivot == e) return false;
+    if (pivot != col) {
+      for (size_t c = 0; c < e; ++c) {
+        std::swap(a[col * e + c], a[pivot * e + c]);
+        std::swap(inv[col * e + c], inv[pivot * e + c]);
+      }
+    }
+    const uint8_t scale = gf.Inv(a[col * e + col]);
+    for (size_t c = 0; c < e; ++c) {
+      a[col * e + c] = gf.Mul(a[col * e + c], scale);
+      inv[col * e + c] = gf.Mul(inv[col * e + c], scale);
+    }
+    for (size_t r = 0; r < e; ++r) {
+      const uint8_t factor = a[r * e + col];
+      if (r == col || factor == 0) continue;
+      for (size_t c = 0; c < e; ++c) {
+        a[r * e + c] ^= gf.Mul(factor, a[col * e + c]);
+        inv[r * e + c] ^= gf.Mul(factor, inv[col * e + c]);
+      }
+    }
+  }
+
+  recovered->resize(data.size());
+  for (size_t m = 0; m < e; ++m) {
+    auto& shard = (*recovered)[missing[m]];
+    shard.assign(shard_len, 0);
+    for (size_t r = 0; r < e; ++r) {
+      GfMulAdd(inv[m * e + r], syndromes[r].data(), shard.data(), shard_len);
+    }
+  }
+  return true;
+}
+
+struct KcpSegment {
+  uint32_t seq = 0;
+  uint32_t rto = 0;
+  uint32_t xmit = 0;
+  uint32_t fastack = 0;
+  // Selectively acked; dropped once the cumulative ack passes it.
+  bool acked = false;
+  uint64_t sent_at = 0;
+  uint64_t resend_at = 0;
+  // The encoded packet; seq is filled in when the segment enters the window
+  // and ack is refreshed on every transmission.
+  std::vector<uint8_t> wire;
+};
+
+// A received parity group still missing data shards; parity[i] is empty
+// until parity i arrives.
+struct KcpFecGroup {
+  uint32_t first = 0;
+  uint32_t count = 0;
+  size_t shard_len = 0;
+  std::vector<std::vector<uint8_t>> parity;
+};
+
+struct KcpSessionStats {
+  uint32_t srtt = 0;
+  uint32_t rto = 0;
+  uint32_t cwnd = 0;
+  uint32_t in_flight = 0;
+  uint32_t queued = 0;
+  uint32_t snd_una = 0;
+  uint32_t snd_nxt = 0;
+  uint32_t rcv_nxt = 0;
+  uint64_t retransmits = 0;
+  uint64_t fast_resends = 0;
+  uint64_t bytes_sent = 0;
+  uint64_t bytes_received = 0;
+  uint32_t fec_parity = 0;
+  uint32_t fec_loss_ppm = 0;
+  uint32_t fec_receive_loss_ppm = 0;
+  uint64_t fec_recovered = 0;
+};
+
+struct KcpSession {
+  uint64_t handle = 0;
+  std::string key;
+  std::string address;
+  uint16_t port = 0;
+  std::string peer_id;
+  struct sockaddr_storage peer {};
+  socklen_t peerlen = 0;
+  bool outbound = false;
+
+  uint32_t snd_nxt = 1;
+  uint32_t snd_una = 1;
+  uint32_t rcv_nxt = 1;
+  std::deque<KcpSegment> snd_queue;
+  std::deque<KcpSegment> snd_buf;
+  // Out-of-order arrivals, indexed by seq modulo the receive window.
+  std::vector<std::vector<uint8_t>> rcv_ring;
+  std::vector<uint8_t> rcv_has;
+  std::vector<uint8_t> delivered;
+
+  // Every data arrival is acked by seq; they leave with the next sendmmsg.
+  std::vector<uint32_t> ack_list;
+  uint32_t srtt = 0;
+  uint32_t rttvar = 0;
+  uint32_t rto = 0;
+  uint32_t cwnd = 1;
+  uint32_t ssthresh = 2;
+  uint32_t cwnd_acked = 0;
+  uint64_t last_recv = 0;
+  uint64_t last_send = 0;
+  uint64_t deadline = 0;
+  bool flush_queued = false;
+  bool deliver_queued = false;
+  bool dead = false;
+  uint64_t retransmits = 0;
+  uint64_t fast_resends = 0;
+  uint64_t bytes_sent = 0;
+  uint64_t bytes_received = 0;
+
+  // fec, send side: the open group (first seq, shards so far, its parity
+  // count) and its parity so far. fec_parity is the count new groups open
+  // with; adaptive fec sets it from the peer's loss reports.
+  uint32_t fec_first = 0;
+  uint32_t fec_count = 0;
+  uint32_t fec_group_parity = 0;
+  uint32_t fec_serial = 0;
+  uint32_t fec_parity = 0;
+  uint32_t fec_loss_ppm = 0;
+  std::vector<std::vector<uint8_t>> fec_tx;
+  // Receive side: recent data payloads by seq (the received shards a
+  // recovery needs), groups missing shards, and the parity-loss estimate.
+  std::vector<std::vector<uint8_t>> fec_rx;
+  std::vector<uint32_t> fec_rx_seq;
+  std::vector<uint8_t> fec_rx_has;
+  std::vector<KcpFecGroup> fec_groups;
+  bool fec_seen = false;
+  bool fec_sampled = false;
+  uint32_t fec_serial_high = 0;
+  uint32_t fec_expected = 0;
+  uint32_t fec_received = 0;
+  uint32_t fec_receive_loss_ppm = 0;
+  uint64_t fec_recovered = 0;
+
+  // Copied from the fields above by the loop thread under the engine's
+  // table mutex, for getSession().
+  KcpSessionStats stats;
+};
+
+// KCP engine: owns a UDP socket and runs ARQ for every peer on one loop
+// thread. Segments, acks, retransmission and fast resend never reach JS;
+// only each session's in-order bytes do, once per receive batch. The wire
+// format matches KcpSession/KcpServer in src/transports/kcp.
+class KcpEngineWrapper : public Napi::ObjectWrap<KcpEngineWrapper> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  explicit KcpEngineWrapper(const Napi::CallbackInfo& info);
+  ~KcpEngineWrapper() override;
+
+ private:
+  struct Options {
+    std::string host;
+    uint16_t port = 0;
+    bool ipv6 = false;
+    uint32_t conv = 1;
+    size_t mtu = 1350;
+    uint32_t snd_wnd = 512;
+    uint32_t rcv_wnd = 512;
+    uint32_t interval = 10;
+    bool nodelay = true;
+    uint32_t resend = 2;
+    bool no_cwnd = true;
+    uint32_t dead_link = 20;
+    uint32_t idle_timeout_ms = 30000;
+    uint32_t keepalive_ms = 5000;
+    size_t batch = kDefaultUdpBatch;
+    // impairment.loss: the fraction of staged datagrams dropped before
+    // sendmmsg, drawn from a generator seeded with impairment.seed.
+    double loss = 0;
+    uint64_t loss_seed = 1;
+    // fec: Reed-Solomon parity over every fec_data first transmissions.
+    bool fec = false;
+    uint32_t fec_data = 8;
+    uint32_t fec_parity = 2;
+    bool fec_adaptive = false;
+    uint32_t fec_max_parity = 0;
+  };
+
+  struct PendingMessage {
+    std::string key;
+    std::string address;
+    uint16_t port = 0;
+    std::vector<uint8_t> data;
+  };
+
+  static constexpr uint64_t kWakeToken = 0;
+  static constexpr uint64_t kSocketToken = 1;
+
+  Napi::Value Bind(const Napi::CallbackInfo& info);
+  Napi::Value Connect(const Napi::CallbackInfo& info);
+  Napi::Value Send(const Napi::CallbackInfo& info);
+  Napi::Value CloseSession(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+  Napi::Value GetSession(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+  // Loop thread.
+  void Run();
+  void RunCommands();
+  void ReceiveReady(uint64_t now);
+  void HandlePacket(const libsocket::dgram_message& datagram, uint64_t now);
+  void AcceptSegment(const std::shared_ptr<KcpSession>& session, uint32_t seq,
+                     const uint8_t* payload, size_t len);
+  void HandleFec(const std::shared_ptr<KcpSession>& session, uint32_t first, const uint8_t* body,
+                 size_t len, uint64_t now);
+  void RecoverGroup(const std::shared_ptr<KcpSession>& session, size_t index);
+  void FecAdd(KcpSession* session, const KcpSegment& segment, uint64_t now);
+  void FecClose(KcpSession* session, uint64_t now);
+  void StageFec(KcpSession* session, std::vector<uint8_t> wire, uint64_t now);
+  uint32_t FecParityFor(uint32_t loss_ppm) const;
+  std::shared_ptr<KcpSession> OpenSession(const struct sockaddr_storage& peer, socklen_t len,
+                                          bool outbound, uint64_t now);
+  void ProcessAck(KcpSession* session, uint32_t ack, uint32_t trigger, uint64_t now);
+  void UpdateRtt(KcpSession* session, uint32_t sample);
+  void QueueFlush(const std::shared_ptr<KcpSession>& session);
+  void Flush(KcpSession* session, uint64_t now);
+  void StageControl(KcpSession* session, uint8_t type, uint32_t seq, uint64_t now);
+  void SendStaged();
+  void Deliver();
+  void EndSession(const std::shared_ptr<KcpSession>& session, const char* reason);
+  std::vector<uint8_t> TakeWire();
+
+  // Any thread.
+  void Post(std::function<void()> command);
+
+  // JS thread.
+  void Stop();
+  Napi::Object AddressObject(Napi::Env env) const;
+  void Emit(std::function<void(Napi::Env, Napi::Object, Napi::Function)> build);
+
+  Options options_;
+  std::unique_ptr<libsocket::inet_dgram_server> socket_;
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  uint16_t bound_port_ = 0;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+
+  std::mutex commands_mutex_;
+  std::deque<std::function<void()>> commands_;
+
+  // Written by the loop thread under table_mutex_; the loop reads without.
+  mutable std::mutex table_mutex_;
+  std::unordered_map<uint64_t, std::shared_ptr<KcpSession>> sessions_;
+  std::unordered_map<std::string, uint64_t> by_key_;
+
+  // Loop thread only.
+  std::unordered_map<std::string, uint64_t> by_peer_;
+  uint64_t next_handle_ = 1;
+  TimerWheel wheel_{10, 512};
+  std::vector<uint8_t> rx_slab_;
+  std::vector<libsocket::dgram_message> rx_slots_;
+  std::vector<std::shared_ptr<KcpSession>> flush_queue_;
+  std::vector<std::shared_ptr<KcpSession>> deliver_queue_;
+  std::vector<std::shared_ptr<KcpSession>> ended_;
+  std::vector<libsocket::dgram_message> tx_;
+  std::deque<std::array<uint8_t, kKcpHeaderBytes>> control_;
+  // Parity and reports staged for this iteration's sendmmsg.
+  std::deque<std::vector<uint8_t>> fec_out_;
+  std::vector<std::vector<uint8_t>> wire_pool_;
+  std::mt19937_64 loss_random_;
+
+  std::atomic<uint64_t> datagrams_in_{0};
+  std::atomic<uint64_t> datagrams_out_{0};
+  std::atomic<uint64_t> send_calls_{0};
+  std::atomic<uint64_t> retransmits_{0};
+  std::atomic<uint64_t> fast_resends_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> impaired_drops_{0};
+  std::atomic<uint64_t> fec_parity_out_{0};
+  std::atomic<uint64_t> fec_parity_in_{0};
+  std::atomic<uint64_t> fec_recovered_{0};
+
+  // JS thread only.
+  Napi::ThreadSafeFunction tsfn_;
+  bool tsfn_ready_ = false;
+  Napi::ObjectReference self_ref_;
+};
+
+Napi::Object KcpEngineWrapper::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(
+      env, "QWormholeKcpEngine",
+      {
+          InstanceMethod<&KcpEngineWrapper::Bind>("bind"),
+          InstanceMethod<&KcpEngineWrapper::Connect>("connect"),
+          InstanceMethod<&KcpEngineWrapper::Send>("send"),
+          InstanceMethod<&KcpEngineWrapper::CloseSession>("closeSession"),
+          InstanceMethod<&KcpEngineWrapper::Close>("close"),
+          InstanceMethod<&KcpEngineWrapper::GetSession>("getSession"),
+          InstanceMethod<&KcpEngineWrapper::GetStats>("getStats"),
+      });
+
+  exports.Set("QWormholeKcpEngine", func);
+  return exports;
+}
+
+KcpEngineWrapper::KcpEngineWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<KcpEngineWrapper>(info) {
+  auto read_u32 = [](const Napi::Object& obj, const char* name, uint32_t* out) {
+    if (obj.Has(name) && obj.Get(name).IsNumber()) {
+      const auto value = obj.Get(name).As<Napi::Number>().Int64Value();
+      if (value >= 0) *out = static_cast<uint32_t>(value);
+    }
+  };
+
+  if (info.Length() >= 1 && info[0].IsObject()) {
+    Napi::Object obj = info[0].As<Napi::Object>();
+    if (obj.Has("host") && obj.Get("host").IsString()) {
+      options_.host = obj.Get("host").As<Napi::String>().Utf8Value();
+    }
+    uint32_t port = 0;
+    read_u32(obj, "port", &port);
+    options_.port = static_cast<uint16_t>(port);
+    if (obj.Has("type") && obj.Get("type").IsString()) {
+      options_.ipv6 = obj.Get("type").As<Napi::String>().Utf8Value() == "udp6";
+    }
+    read_u32(obj, "conv", &options_.conv);
+    uint32_t mtu = static_cast<uint32_t>(options_.mtu);
+    read_u32(obj, "mtu", &mtu);
+    options_.mtu = std::min<size_t>(std::max<size_t>(mtu, kKcpHeaderBytes + 1), kMaxUdpDatagram);
+    read_u32(obj, "sndWnd", &options_.snd_wnd);
+    read_u32(obj, "rcvWnd", &options_.rcv_wnd);
+    read_u32(obj, "deadLink", &options_.dead_link);
+    read_u32(obj, "idleTimeoutMs", &options_.idle_timeout_ms);
+    read_u32(obj, "keepaliveMs", &options_.keepalive_ms);
+    if (obj.Has("nodelay") && obj.Get("nodelay").IsObject()) {
+      Napi::Object nodelay = obj.Get("nodelay").As<Napi::Object>();
+      uint32_t flag = options_.nodelay ? 1 : 0;
+      uint32_t nc = options_.no_cwnd ? 1 : 0;
+      read_u32(nodelay, "nodelay", &flag);
+      read_u32(nodelay, "interval", &options_.interval);
+      read_u32(nodelay, "resend", &options_.resend);
+      read_u32(nodelay, "nc", &nc);
+      options_.nodelay = flag != 0;
+      options_.no_cwnd = nc != 0;
+    }
+    if (obj.Has("impairment") && obj.Get("impairment").IsObject()) {
+      Napi::Object impairment = obj.Get("impairment").As<Napi::Object>();
+      if (impairment.Has("loss") && impairment.Get("loss").IsNumber()) {
+        options_.loss =
+            std::clamp(impairment.Get("loss").As<Napi::Number>().DoubleValue(), 0.0, 1.0);
+      }
+      if (impairment.Has("seed") && impairment.Get("seed").IsNumber()) {
+        options_.loss_seed =
+            static_cast<uint64_t>(impairment.Get("seed").As<Napi::Number>().Int64Value());
+      }
+    }
+    if (obj.Has("fec")) {
+      Napi::Value fec = obj.Get("fec");
+      if (fec.IsBoolean()) {
+        options_.fec = fec.As<Napi::Boolean>().Value();
+      } else if (fec.IsObject()) {
+        Napi::Object fec_obj = fec.As<Napi::Object>();
+        options_.fec = true;
+        read_u32(fec_obj, "dataShards", &options_.fec_data);
+        read_u32(fec_obj, "parityShards", &options_.fec_parity);
+        read_u32(fec_obj, "maxParityShards", &options_.fec_max_parity);
+        options_.fec_adaptive = fec_obj.Has("adaptive") && fec_obj.Get("adaptive").ToBoolean();
+      }
+    }
+  }
+  if (options_.host.empty()) options_.host = options_.ipv6 ? "::" : "0.0.0.0";
+  if (options_.fec) {
+    options_.fec_data = std::clamp<uint32_t>(options_.fec_data, 1, kKcpFecMaxData);
+    options_.fec_parity = std::clamp<uint32_t>(options_.fec_parity, 1, kKcpFecMaxParity);
+    if (options_.fec_max_parity == 0) options_.fec_max_parity = options_.fec_data;
+    options_.fec_max_parity =
+        std::clamp<uint32_t>(options_.fec_max_parity, options_.fec_parity, kKcpFecMaxParity);
+    // Room for the parity header and length prefix on top of a full segment.
+    options_.mtu = std::max(options_.mtu,
+                            kKcpHeaderBytes + kKcpFecHeaderBytes + kKcpFecLengthBytes + 1);
+  }
+  options_.snd_wnd = std::max<uint32_t>(1, options_.snd_wnd);
+  options_.rcv_wnd = std::max<uint32_t>(1, options_.rcv_wnd);
+  options_.interval = std::min<uint32_t>(std::max<uint32_t>(1, options_.interval), 5000);
+  if (options_.dead_link == 0) options_.dead_link = kKcpDeadLink;
+  wheel_ = TimerWheel(options_.interval, kKcpWheelSlots);
+  loss_random_.seed(options_.loss_seed);
+}
+
+KcpEngineWrapper::~KcpEngineWrapper() {
+  Stop();
+  if (tsfn_ready_) {
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+}
+
+Napi::Object KcpEngineWrapper::AddressObject(Napi::Env env) const {
+  Napi::Object address = Napi::Object::New(env);
+  address.Set("address", options_.host);
+  address.Set("port", bound_port_);
+  address.Set("family", options_.ipv6 ? "IPv6" : "IPv4");
+  return address;
+}
+
+Napi::Value KcpEngineWrapper::Bind(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  auto deferred = Napi::Promise::Deferred::New(env);
+
+  if (running_) {
+    deferred.Reject(Napi::Error::New(env, "KCP engine already bound").Value());
+    return deferred.Promise();
+  }
+
+  try {
+    socket_.reset(new libsocket::inet_dgram_server(
+        options_.host, std::to_string(options_.port),
+        options_.ipv6 ? LIBSOCKET_IPv6 : LIBSOCKET_IPv4, SOCK_NONBLOCK | SOCK_CLOEXEC));
+  } catch (const libsocket::socket_exception& e) {
+    deferred.Reject(Napi::Error::New(env, "Could not bind " + options_.host + ":" +
+                                              std::to_string(options_.port) + ": " + e.mesg)
+                        .Value());
+    return deferred.Promise();
+  }
+
+  bound_port_ = options_.port;
+  struct sockaddr_storage bound {};
+  socklen_t len = sizeof bound;
+  if (getsockname(socket_->getfd(), reinterpret_cast<struct sockaddr*>(&bound), &len) == 0) {
+    std::string ignored;
+    FormatPeer(bound, &ignored, &bound_port_);
+  }
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  struct epoll_event wake {};
+  wake.events = EPOLLIN;
+  wake.data.u64 = kWakeToken;
+  struct epoll_event readable {};
+  readable.events = EPOLLIN;
+  readable.data.u64 = kSocketToken;
+  if (epoll_fd_ < 0 || wake_fd_ < 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake) != 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, socket_->getfd(), &readable) != 0) {
+    const std::string error = std::string("epoll setup failed: ") + std::strerror(errno);
+    Stop();
+    deferred.Reject(Napi::Error::New(env, error).Value());
+    return deferred.Promise();
+  }
+
+  if (self_ref_.IsEmpty()) {
+    // Keeps the wrapper alive while events can still reach it.
+    self_ref_ = Napi::ObjectReference::New(info.This().As<Napi::Object>(), 1);
+  }
+  tsfn_ = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+      "QWormholeKcpEngineEvents", 0, 1);
+  tsfn_ready_ = true;
+  // Peers fragment at the shared MTU; anything larger is truncated and dropped.
+  const size_t slot_bytes = std::max<size_t>(options_.mtu, 2048);
+  rx_slab_.resize(options_.batch * slot_bytes);
+  rx_slots_.resize(options_.batch);
+  wheel_.Reset(SteadyNowMs());
+  running_ = true;
+  thread_ = std::thread(&KcpEngineWrapper::Run, this);
+
+  Emit([this](Napi::Env env, Napi::Object self, Napi::Function emit) {
+    emit.Call(self, {Napi::String::New(env, "listening"), AddressObject(env)});
+  });
+  deferred.Resolve(AddressObject(env));
+  return deferred.Promise();
+}
+
+void KcpEngineWrapper::Stop() {
+  if (running_.exchange(false)) {
+    Post([]() {});
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  {
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    sessions_.clear();
+    by_key_.clear();
+  }
+  by_peer_.clear();
+  flush_queue_.clear();
+  deliver_queue_.clear();
+  ended_.clear();
+  tx_.clear();
+  control_.clear();
+  socket_.reset();
+  if (epoll_fd_ >= 0) {
+    ::close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+  if (wake_fd_ >= 0) {
+    ::close(wake_fd_);
+    wake_fd_ = -1;
+  }
+}
+
+Napi::Value KcpEngineWrapper::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Stop();
+  if (tsfn_ready_) {
+    Emit([this](Napi::Env env, Napi::Object self, Napi::Function emit) {
+      emit.Call(self, {Napi::String::New(env, "close"), env.Undefined()});
+      if (!running_) self_ref_.Reset();
+    });
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+  return env.Undefined();
+}
+
+void KcpEngineWrapper::Post(std::function<void()> command) {
+  {
+    std::lock_guard<std::mutex> lock(commands_mutex_);
+    commands_.push_back(std::move(command));
+  }
+  const uint64_t one = 1;
+  ssize_t ignored = ::write(wake_fd_, &one, sizeof one);
+  (void)ignored;
+}
+
+void KcpEngineWrapper::RunCommands() {
+  std::deque<std::function<void()>> ready;
+  {
+    std::lock_guard<std::mutex> lock(commands_mutex_);
+    ready.swap(commands_);
+  }
+  for (auto& command : ready) {
+    command();
+  }
+}
+
+// connect(address, port): opens an outbound session and returns its key.
+// The key is usable right away; sends queue behind the open.
+Napi::Value KcpEngineWrapper::Connect(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (!running_) {
+    Napi::Error::New(env, "KCP engine not bound").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+    Napi::TypeError::New(env, "connect(address, port) required").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+
+  struct sockaddr_storage peer {};
+  socklen_t len = 0;
+  try {
+    len = socket_->resolve(info[0].As<Napi::String>().Utf8Value(),
+                           std::to_string(info[1].As<Napi::Number>().Uint32Value()), &peer);
+  } catch (const libsocket::socket_exception& e) {
+    Napi::Error::New(env, e.mesg).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::string address;
+  uint16_t port = 0;
+  FormatPeer(peer, &address, &port);
+
+  Post([this, peer, len]() { OpenSession(peer, len, true, SteadyNowMs()); });
+  return Napi::String::New(env, address + ":" + std::to_string(port));
+}
+
+// send(key, data): queues bytes on a session. They are cut into MTU-sized
+// segments on the loop thread and leave with its next flush.
+Napi::Value KcpEngineWrapper::Send(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsBuffer()) {
+    Napi::TypeError::New(env, "send(session, data) required").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!running_) return Napi::Boolean::New(env, false);
+
+  auto buf = info[1].As<Napi::Buffer<uint8_t>>();
+  std::string key = info[0].As<Napi::String>().Utf8Value();
+  std::vector<uint8_t> data(buf.Data(), buf.Data() + buf.Length());
+  Post([this, key = std::move(key), data = std::move(data)]() {
+    auto it = by_key_.find(key);
+    if (it == by_key_.end()) {
+      dropped_ += 1;
+      return;
+    }
+    auto session = sessions_.at(it->second);
+    // A parity datagram is a full segment plus its own header and length
+    // prefix, so fec segments leave room for both under the MTU.
+    const size_t max_payload =
+        options_.mtu - kKcpHeaderBytes -
+        (options_.fec ? kKcpFecHeaderBytes + kKcpFecLengthBytes : 0);
+    for (size_t offset = 0; offset < data.size();) {
+      const size_t chunk = std::min(max_payload, data.size() - offset);
+      KcpSegment segment;
+      segment.wire = TakeWire();
+      segment.wire.resize(kKcpHeaderBytes + chunk);
+      uint8_t* header = segment.wire.data();
+      header[0] = kKcpData;
+      PutU32(header + 1, options_.conv);
+      PutU32(header + 13, static_cast<uint32_t>(chunk));
+      std::memcpy(header + kKcpHeaderBytes, data.data() + offset, chunk);
+      session->snd_queue.push_back(std::move(segment));
+      offset += chunk;
+    }
+    QueueFlush(session);
+  });
+  return Napi::Boolean::New(env, true);
+}
+
+Napi::Value KcpEngineWrapper::CloseSession(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "closeSession(session) required").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!running_) return env.Undefined();
+  Post([this, key = info[0].As<Napi::String>().Utf8Value()]() {
+    auto it = by_key_.find(key);
+    if (it == by_key_.end()) return;
+    EndSession(sessions_.at(it->second), "closed");
+  });
+  return env.Undefined();
+}
+
+Napi::Value KcpEngineWrapper::GetSession(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsString()) return env.Undefined();
+  KcpSessionStats stats;
+  {
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    auto it = by_key_.find(info[0].As<Napi::String>().Utf8Value());
+    if (it == by_key_.end()) return env.Undefined();
+    stats = sessions_.at(it->second)->stats;
+  }
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("srttMs", static_cast<double>(stats.srtt));
+  out.Set("rtoMs", static_cast<double>(stats.rto));
+  out.Set("cwnd", static_cast<double>(stats.cwnd));
+  out.Set("inFlight", static_cast<double>(stats.in_flight));
+  out.Set("queued", static_cast<double>(stats.queued));
+  out.Set("sndUna", static_cast<double>(stats.snd_una));
+  out.Set("sndNxt", static_cast<double>(stats.snd_nxt));
+  out.Set("rcvNxt", static_cast<double>(stats.rcv_nxt));
+  out.Set("retransmits", static_cast<double>(stats.retransmits));
+  out.Set("fastResends", static_cast<double>(stats.fast_resends));
+  out.Set("bytesWritten", static_cast<double>(stats.bytes_sent));
+  out.Set("bytesRead", static_cast<double>(stats.bytes_received));
+  if (options_.fec) {
+    Napi::Object fec = Napi::Object::New(env);
+    fec.Set("parityShards", static_cast<double>(stats.fec_parity));
+    fec.Set("lossRate", static_cast<double>(stats.fec_loss_ppm) / 1e6);
+    fec.Set("receiveLossRate", static_cast<double>(stats.fec_receive_loss_ppm) / 1e6);
+    fec.Set("recovered", static_cast<double>(stats.fec_recovered));
+    out.Set("fec", fec);
+  }
+  return out;
+}
+
+Napi::Value KcpEngineWrapper::GetStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::Object stats = Napi::Object::New(env);
+  size_t sessions = 0;
+  {
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    sessions = sessions_.size();
+  }
+  const uint64_t out = datagrams_out_.load();
+  const uint64_t calls = send_calls_.load();
+  stats.Set("sessions", static_cast<double>(sessions));
+  stats.Set("datagramsIn", static_cast<double>(datagrams_in_.load()));
+  stats.Set("datagramsOut", static_cast<double>(out));
+  stats.Set("sendCalls", static_cast<double>(calls));
+  stats.Set("datagramsPerSend", calls ? static_cast<double>(out) / static_cast<double>(calls) : 0.0);
+  stats.Set("retransmits", static_cast<double>(retransmits_.load()));
+  stats.Set("fastResends", static_cast<double>(fast_resends_.load()));
+  stats.Set("dropped", static_cast<double>(dropped_.load()));
+  if (options_.loss > 0) {
+    stats.Set("impairedDrops", static_cast<double>(impaired_drops_.load()));
+  }
+  if (options_.fec) {
+    Napi::Object fec = Napi::Object::New(env);
+    fec.Set("dataShards", static_cast<double>(options_.fec_data));
+    fec.Set("adaptive", options_.fec_adaptive);
+    fec.Set("parityOut", static_cast<double>(fec_parity_out_.load()));
+    fec.Set("parityIn", static_cast<double>(fec_parity_in_.load()));
+    fec.Set("recovered", static_cast<double>(fec_recovered_.load()));
+    fec.Set("kernel", GfKernel());
+    stats.Set("fec", fec);
+  }
+  return stats;
+}
+
+void KcpEngineWrapper::Run() {
+  struct epoll_event events[2];
+  while (running_) {
+    const int timeout = flush_queue_.empty() ? wheel_.NextTimeoutMs(SteadyNowMs()) : 0;
+    const int ready = epoll_wait(epoll_fd_, events, 2, timeout);
+    if (ready < 0 && errno != EINTR) break;
+    uint64_t now = SteadyNowMs();
+    for (int i = 0; i < ready; ++i) {
+      if (events[i].data.u64 == kWakeToken) {
+        uint64_t count = 0;
+        ssize_t ignored = ::read(wake_fd_, &count, sizeof count);
+        (void)ignored;
+        continue;
+      }
+      ReceiveReady(now);
+    }
+    RunCommands();
+    now = SteadyNowMs();
+    wheel_.Advance(now, [this](uint64_t handle, uint64_t deadline) {
+      auto it = sessions_.find(handle);
+      if (it != sessions_.end() && it->second->deadline == deadline) {
+        it->second->deadline = 0;
+        QueueFlush(it->second);
+      }
+    });
+    std::vector<std::shared_ptr<KcpSession>> flushing;
+    flushing.swap(flush_queue_);
+    for (auto& session : flushing) {
+      session->flush_queued = false;
+      if (!session->dead) Flush(session.get(), now);
+    }
+    SendStaged();
+    Deliver();
+    for (auto& session : ended_) {
+      std::lock_guard<std::mutex> lock(table_mutex_);
+      sessions_.erase(session->handle);
+      // A new packet from the same peer may already own the key.
+      auto key = by_key_.find(session->key);
+      if (key != by_key_.end() && key->second == session->handle) by_key_.erase(key);
+    }
+    ended_.clear();
+  }
+}
+
+void KcpEngineWrapper::ReceiveReady(uint64_t now) {
+  const size_t slot_bytes = rx_slab_.size() / rx_slots_.size();
+  for (int round = 0; round < kMaxReadsPerEvent; ++round) {
+    for (size_t i = 0; i < rx_slots_.size(); ++i) {
+      rx_slots_[i] = libsocket::dgram_message(rx_slab_.data() + i * slot_bytes, slot_bytes);
+    }
+    const int received = socket_->try_rcvmmsg(rx_slots_.data(), rx_slots_.size());
+    if (received <= 0) return;
+    datagrams_in_ += static_cast<uint64_t>(received);
+    for (int i = 0; i < received; ++i) {
+      HandlePacket(rx_slots_[i], now);
+    }
+    if (static_cast<size_t>(received) < rx_slots_.size()) return;
+  }
+}
+
+std::shared_ptr<KcpSession> KcpEngineWrapper::OpenSession(const struct sockaddr_storage& peer,
+                                                          socklen_t len,
+                                                          bool outbound,
+                                                          uint64_t now) {
+  std::string peer_id(reinterpret_cast<const char*>(&peer), len);
+  auto found = by_peer_.find(peer_id);
+  if (found != by_peer_.end()) return sessions_.at(found->second);
+
+  auto session = std::make_shared<KcpSession>();
+  session->handle = next_handle_++;
+  session->peer_id = std::move(peer_id);
+  session->peer = peer;
+  session->peerlen = len;
+  session->outbound = outbound;
+  FormatPeer(peer, &session->address, &session->port);
+  session->key = session->address + ":" + std::to_string(session->port);
+  session->rcv_ring.resize(options_.rcv_wnd);
+  session->rcv_has.assign(options_.rcv_wnd, 0);
+  session->rto = options_.nodelay ? kKcpRtoNoDelayMin : kKcpRtoDefault;
+  session->cwnd = options_.no_cwnd ? options_.snd_wnd : 1;
+  if (options_.fec) {
+    // Covers the receive window and a group reaching back behind it.
+    const size_t ring = options_.rcv_wnd + kKcpFecMaxData;
+    session->fec_rx.resize(ring);
+    session->fec_rx_seq.assign(ring, 0);
+    session->fec_rx_has.assign(ring, 0);
+    session->fec_parity = options_.fec_parity;
+  }
+  session->last_recv = now;
+  session->last_send = now;
+  by_peer_[session->peer_id] = session->handle;
+  {
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    sessions_[session->handle] = session;
+    by_key_[session->key] = session->handle;
+  }
+  QueueFlush(session);
+
+  Emit([key = session->key, address = session->address, port = session->port, outbound](
+           Napi::Env env, Napi::Object self, Napi::Function emit) {
+    Napi::Object payload = Napi::Object::New(env);
+    payload.Set("key", key);
+    payload.Set("address", address);
+    payload.Set("port", port);
+    payload.Set("outbound", outbound);
+    emit.Call(self, {Napi::String::New(env, "session"), payload});
+  });
+  return session;
+}
+
+void KcpEngineWrapper::HandlePacket(const libsocket::dgram_message& datagram, uint64_t now) {
+  const uint8_t* data = static_cast<const uint8_t*>(datagram.data);
+  if (datagram.truncated || datagram.len < kKcpHeaderBytes) {
+    dropped_ += 1;
+    return;
+  }
+  const uint8_t type = data[0];
+  const uint32_t conv = GetU32(data + 1);
+  const uint32_t seq = GetU32(data + 5);
+  const uint32_t ack = GetU32(data + 9);
+  const uint32_t len = GetU32(data + 13);
+  const uint8_t last_type = options_.fec ? kKcpFec : kKcpPing;
+  if (type > last_type || conv != options_.conv || len > datagram.len - kKcpHeaderBytes) {
+    dropped_ += 1;
+    return;
+  }
+
+  auto session = OpenSession(datagram.peer, datagram.peerlen, false, now);
+  if (session->dead) return;
+  session->last_recv = now;
+  session->bytes_received += len;
+
+  if (type == kKcpData) {
+    // Data carries the sender's cumulative ack too.
+    ProcessAck(session.get(), ack, 0, now);
+    AcceptSegment(session, seq, data + kKcpHeaderBytes, len);
+    session->ack_list.push_back(seq);
+  } else if (type == kKcpAck) {
+    ProcessAck(session.get(), ack, seq, now);
+  } else if (type == kKcpFec) {
+    ProcessAck(session.get(), ack, 0, now);
+    HandleFec(session, seq, data + kKcpHeaderBytes, len, now);
+  } else {
+    StageControl(session.get(), kKcpAck, seq, now);
+  }
+  QueueFlush(session);
+}
+
+void KcpEngineWrapper::AcceptSegment(const std::shared_ptr<KcpSession>& session, uint32_t seq,
+                                     const uint8_t* payload, size_t len) {
+  const uint32_t window = options_.rcv_wnd;
+  if (SeqDiff(seq, session->rcv_nxt) < 0 ||
+      SeqDiff(seq, session->rcv_nxt) >= static_cast<int32_t>(window)) {
+    return;
+  }
+  const size_t slot = seq % window;
+  if (!session->rcv_has[slot]) {
+    session->rcv_ring[slot].assign(payload, payload + len);
+    session->rcv_has[slot] = 1;
+  }
+  for (;;) {
+    const size_t next = session->rcv_nxt % window;
+    if (!session->rcv_has[next]) break;
+    auto& ready = session->rcv_ring[next];
+    session->delivered.insert(session->delivered.end(), ready.begin(), ready.end());
+    ready.clear();
+    session->rcv_has[next] = 0;
+    session->rcv_nxt += 1;
+  }
+  if (!session->delivered.empty() && !session->deliver_queued) {
+    session->deliver_queued = true;
+    deliver_queue_.push_back(session);
+  }
+
+  if (!options_.fec || len == 0) return;
+  const size_t shard = seq % session->fec_rx.size();
+  if (!session->fec_rx_has[shard] || session->fec_rx_seq[shard] != seq) {
+    session->fec_rx[shard].assign(payload, payload + len);
+    session->fec_rx_seq[shard] = seq;
+    session->fec_rx_has[shard] = 1;
+  }
+  for (size_t i = 0; i < session->fec_groups.size(); ++i) {
+    const KcpFecGroup& group = session->fec_groups[i];
+    const int32_t offset = SeqDiff(seq, group.first);
+    if (offset >= 0 && offset < static_cast<int32_t>(group.count)) {
+      RecoverGroup(session, i);
+      break;
+    }
+  }
+}
+
+void KcpEngineWrapper::HandleFec(const std::shared_ptr<KcpSession>& session, uint32_t first,
+                                 const uint8_t* body, size_t len, uint64_t now) {
+  if (len < kKcpFecHeaderBytes) {
+    dropped_ += 1;
+    return;
+  }
+  if (body[0] == kKcpFecReport) {
+    session->fec_loss_ppm = std::min<uint32_t>(GetU32(body + 4), 1000000);
+    if (options_.fec_adaptive) session->fec_parity = FecParityFor(session->fec_loss_ppm);
+    return;
+  }
+  const uint32_t count = body[1];
+  const uint32_t parity = body[2];
+  const uint32_t index = body[3];
+  const uint32_t serial = GetU32(body + 4);
+  if (body[0] != kKcpFecParity || count == 0 || count > kKcpFecMaxData || parity == 0 ||
+      parity > kKcpFecMaxParity || index >= parity || len == kKcpFecHeaderBytes) {
+    dropped_ += 1;
+    return;
+  }
+  fec_parity_in_ += 1;
+
+  // Parity is never resent, so the share of it that arrives samples the
+  // path's loss; groups skipped in the serials lost all of theirs.
+  if (!session->fec_seen) {
+    session->fec_seen = true;
+    session->fec_serial_high = serial;
+    session->fec_expected += parity;
+  } else if (SeqDiff(serial, session->fec_serial_high) > 0) {
+    const uint32_t advanced =
+        std::min<uint32_t>(serial - session->fec_serial_high, kKcpFecLossSample);
+    session->fec_expected += parity * advanced;
+    session->fec_serial_high = serial;
+  }
+  session->fec_received += 1;
+  if (session->fec_expected >= kKcpFecLossSample) {
+    const uint32_t arrived = std::min(session->fec_received, session->fec_expected);
+    const auto sample = static_cast<uint32_t>(
+        static_cast<uint64_t>(session->fec_expected - arrived) * 1000000 / session->fec_expected);
+    session->fec_receive_loss_ppm =
+        session->fec_sampled ? (3 * session->fec_receive_loss_ppm + sample) / 4 : sample;
+    session->fec_sampled = true;
+    session->fec_expected = 0;
+    session->fec_received = 0;
+    std::vector<uint8_t> wire = TakeWire();
+    wire.assign(kKcpHeaderBytes + kKcpFecHeaderBytes, 0);
+    wire[0] = kKcpFec;
+    PutU32(wire.data() + 1, options_.conv);
+    PutU32(wire.data() + 9, session->rcv_nxt - 1);
+    PutU32(wire.data() + 13, static_cast<uint32_t>(kKcpFecHeaderBytes));
+    wire[kKcpHeaderBytes] = kKcpFecReport;
+    PutU32(wire.data() + kKcpHeaderBytes + 4, session->fec_receive_loss_ppm);
+    StageFec(session.get(), std::move(wire), now);
+  }
+
+  auto& groups = session->fec_groups;
+  groups.erase(std::remove_if(groups.begin(), groups.end(),
+                              [&](const KcpFecGroup& group) {
+                                return SeqDiff(group.first + group.count, session->rcv_nxt) <= 0;
+                              }),
+               groups.end());
+  if (SeqDiff(first + count, session->rcv_nxt) <= 0 ||
+      SeqDiff(first, session->rcv_nxt) >= static_cast<int32_t>(options_.rcv_wnd)) {
+    return;
+  }
+  const size_t shard_len = len - kKcpFecHeaderBytes;
+  size_t at = 0;
+  while (at < groups.size() && groups[at].first != first) ++at;
+  if (at == groups.size()) {
+    if (groups.size() >= kKcpFecMaxGroups) groups.erase(groups.begin());
+    KcpFecGroup group;
+    group.first = first;
+    group.count = count;
+    group.shard_len = shard_len;
+    group.parity.resize(parity);
+    groups.push_back(std::move(group));
+    at = groups.size() - 1;
+  }
+  KcpFecGroup& group = groups[at];
+  if (group.count != count || group.shard_len != shard_len || group.parity.size() != parity) {
+    dropped_ += 1;
+    return;
+  }
+  if (!group.parity[index].empty()) return;
+  group.parity[index].assign(body + kKcpFecHeaderBytes, body + len);
+  RecoverGroup(session, at);
+}
+
+// Rebuilds the group's missing shards once enough parity is in, and feeds
+// them in as if they had arrived. The group goes either way once every
+// shard is accounted for.
+void KcpEngineWrapper::RecoverGroup(const std::shared_ptr<KcpSession>& session, size_t index) {
+  KcpFecGroup& group = session->fec_groups[index];
+  std::vector<const uint8_t*> data(group.count, nullptr);
+  std::vector<size_t> lens(group.count, 0);
+  size_t missing = 0;
+  for (uint32_t j = 0; j < group.count; ++j) {
+    const uint32_t seq = group.first + j;
+    const size_t slot = seq % session->fec_rx.size();
+    if (session->fec_rx_has[slot] && session->fec_rx_seq[slot] == seq) {
+      data[j] = session->fec_rx[slot].data();
+      lens[j] = session->fec_rx[slot].size();
+    } else {
+      ++missing;
+    }
+  }
+  std::vector<const uint8_t*> parity(group.parity.size(), nullptr);
+  size_t present = 0;
+  for (size_t i = 0; i < group.parity.size(); ++i) {
+    if (!group.parity[i].empty()) {
+      parity[i] = group.parity[i].data();
+      ++present;
+    }
+  }
+  if (missing > present) return;
+
+  std::vector<std::vector<uint8_t>> recovered;
+  const bool rebuilt =
+      missing > 0 && KcpFecRecover(data, lens, parity, group.shard_len, &recovered);
+  const uint32_t first = group.first;
+  session->fec_groups.erase(session->fec_groups.begin() + static_cast<std::ptrdiff_t>(index));
+  if (!rebuilt) return;
+  for (size_t j = 0; j < recovered.size(); ++j) {
+    const auto& shard = recovered[j];
+    if (shard.empty()) continue;
+    const size_t len = (static_cast<size_t>(shard[0]) << 8) | shard[1];
+    const uint32_t seq = first + static_cast<uint32_t>(j);
+    if (len == 0 || kKcpFecLengthBytes + len > shard.size() ||
+        SeqDiff(seq, session->rcv_nxt) < 0) {
+      continue;
+    }
+    AcceptSegment(session, seq, shard.data() + kKcpFecLengthBytes, len);
+    // Acked like an arrival, so the sender never resends it.
+    session->ack_list.push_back(seq);
+    session->fec_recovered += 1;
+    fec_recovered_ += 1;
+  }
+}
+
+// Adds a first transmission to the open parity group, opening one if
+// needed; a full group's parity is staged behind it.
+void KcpEngineWrapper::FecAdd(KcpSession* session, const KcpSegment& segment, uint64_t now) {
+  if (session->fec_count > 0 && segment.seq != session->fec_first + session->fec_count) {
+    FecClose(session, now);
+  }
+  if (session->fec_count == 0) {
+    session->fec_first = segment.seq;
+    session->fec_group_parity = session->fec_parity;
+    session->fec_tx.resize(session->fec_group_parity);
+    for (auto& shard : session->fec_tx) shard.clear();
+  }
+  const uint8_t* payload = segment.wire.data() + kKcpHeaderBytes;
+  const size_t len = segment.wire.size() - kKcpHeaderBytes;
+  for (uint32_t i = 0; i < session->fec_group_parity; ++i) {
+    KcpFecAccumulate(i, session->fec_count, payload, len, &session->fec_tx[i]);
+  }
+  session->fec_count += 1;
+  if (session->fec_count == options_.fec_data) FecClose(session, now);
+}
+
+// Stages the open group's parity. A short group sends no more parity
+// than it has data shards.
+void KcpEngineWrapper::FecClose(KcpSession* session, uint64_t now) {
+  if (session->fec_count == 0) return;
+  const uint32_t parity = std::min(session->fec_group_parity, session->fec_count);
+  const uint32_t serial = session->fec_serial++;
+  for (uint32_t i = 0; i < parity; ++i) {
+    const auto& shard = session->fec_tx[i];
+    std::vector<uint8_t> wire = TakeWire();
+    wire.resize(kKcpHeaderBytes + kKcpFecHeaderBytes + shard.size());
+    uint8_t* header = wire.data();
+    header[0] = kKcpFec;
+    PutU32(header + 1, options_.conv);
+    PutU32(header + 5, session->fec_first);
+    PutU32(header + 9, session->rcv_nxt - 1);
+    PutU32(header + 13, static_cast<uint32_t>(kKcpFecHeaderBytes + shard.size()));
+    uint8_t* body = header + kKcpHeaderBytes;
+    body[0] = kKcpFecParity;
+    body[1] = static_cast<uint8_t>(session->fec_count);
+    body[2] = static_cast<uint8_t>(parity);
+    body[3] = static_cast<uint8_t>(i);
+    PutU32(body + 4, serial);
+    std::memcpy(body + kKcpFecHeaderBytes, shard.data(), shard.size());
+    StageFec(session, std::move(wire), now);
+    fec_parity_out_ += 1;
+  }
+  session->fec_count = 0;
+}
+
+void KcpEngineWrapper::StageFec(KcpSession* session, std::vector<uint8_t> wire, uint64_t now) {
+  fec_out_.push_back(std::move(wire));
+  auto& staged = fec_out_.back();
+  tx_.emplace_back(staged.data(), staged.size());
+  std::memcpy(&tx_.back().peer, &session->peer, session->peerlen);
+  tx_.back().peerlen = session->peerlen;
+  session->last_send = now;
+}
+
+// Adaptive fec: parity for twice the losses a group should see at the
+// peer's reported rate, plus one so the estimate keeps getting samples.
+uint32_t KcpEngineWrapper::FecParityFor(uint32_t loss_ppm) const {
+  const uint64_t lost = 2ull * options_.fec_data * loss_ppm;
+  const auto parity = static_cast<uint32_t>((lost + 999999) / 1000000) + 1;
+  return std::clamp<uint32_t>(parity, 1, options_.fec_max_parity);
+}
+
+void KcpEngineWrapper::ProcessAck(KcpSession* session, uint32_t ack, uint32_t trigger,
+                                  uint64_t now) {
+  uint32_t acked = 0;
+  auto& snd_buf = session->snd_buf;
+
+  // An ack's seq names the segment that triggered it: a selective ack that
+  // spares everything behind a hole from timing out.
+  if (trigger != 0 && SeqDiff(trigger, ack) > 0) {
+    auto it = std::lower_bound(snd_buf.begin(), snd_buf.end(), trigger,
+                               [](const KcpSegment& segment, uint32_t seq) {
+                                 return SeqDiff(segment.seq, seq) < 0;
+                               });
+    if (it != snd_buf.end() && it->seq == trigger && !it->acked) {
+      it->acked = true;
+      // Karn: only first transmissions give unambiguous samples.
+      if (it->xmit == 1) UpdateRtt(session, static_cast<uint32_t>(now - it->sent_at));
+      ++acked;
+    }
+    for (auto& segment : snd_buf) {
+      if (SeqDiff(segment.seq, trigger) >= 0) break;
+      if (!segment.acked) segment.fastack += 1;
+    }
+  }
+
+  while (!snd_buf.empty() &&
+         (snd_buf.front().acked || SeqDiff(snd_buf.front().seq, ack) <= 0)) {
+    KcpSegment& segment = snd_buf.front();
+    if (!segment.acked) {
+      if (segment.xmit == 1) UpdateRtt(session, static_cast<uint32_t>(now - segment.sent_at));
+      ++acked;
+    }
+    if (wire_pool_.size() < 4096) wire_pool_.push_back(std::move(segment.wire));
+    snd_buf.pop_front();
+  }
+  session->snd_una = snd_buf.empty() ? session->snd_nxt : snd_buf.front().seq;
+
+  if (acked == 0 || options_.no_cwnd) return;
+  if (session->cwnd < session->ssthresh) {
+    session->cwnd += acked;
+  } else {
+    session->cwnd_acked += acked;
+    if (session->cwnd_acked >= session->cwnd) {
+      session->cwnd_acked -= session->cwnd;
+      session->cwnd += 1;
+    }
+  }
+  session->cwnd = std::min(session->cwnd, options_.snd_wnd);
+}
+
+void KcpEngineWrapper::UpdateRtt(KcpSession* session, uint32_t sample) {
+  if (sample == 0) sample = 1;
+  if (session->srtt == 0) {
+    session->srtt = sample;
+    session->rttvar = sample / 2;
+  } else {
+    const uint32_t delta = sample > session->srtt ? sample - session->srtt : session->srtt - sample;
+    session->rttvar = (3 * session->rttvar + delta) / 4;
+    session->srtt = std::max<uint32_t>(1, (7 * session->srtt + sample) / 8);
+  }
+  const uint32_t floor = options_.nodelay ? kKcpRtoNoDelayMin : kKcpRtoMin;
+  const uint32_t rto = session->srtt + std::max(options_.interval, 4 * session->rttvar);
+  session->rto = std::min(kKcpRtoMax, std::max(floor, rto));
+}
+
+void KcpEngineWrapper::QueueFlush(const std::shared_ptr<KcpSession>& session) {
+  if (session->flush_queued || session->dead) return;
+  session->flush_queued = true;
+  flush_queue_.push_back(session);
+}
+
+std::vector<uint8_t> KcpEngineWrapper::TakeWire() {
+  if (wire_pool_.empty()) {
+    std::vector<uint8_t> wire;
+    wire.reserve(options_.mtu);
+    return wire;
+  }
+  std::vector<uint8_t> wire = std::move(wire_pool_.back());
+  wire_pool_.pop_back();
+  return wire;
+}
+
+void KcpEngineWrapper::StageControl(KcpSession* session, uint8_t type, uint32_t seq,
+                                    uint64_t now) {
+  control_.emplace_back();
+  uint8_t* header = control_.back().data();
+  header[0] = type;
+  PutU32(header + 1, options_.conv);
+  PutU32(header + 5, seq);
+  PutU32(header + 9, session->rcv_nxt - 1);
+  PutU32(header + 13, 0);
+  tx_.emplace_back(header, kKcpHeaderBytes);
+  std::memcpy(&tx_.back().peer, &session->peer, session->peerlen);
+  tx_.back().peerlen = session->peerlen;
+  session->last_send = now;
+}
+
+// One pass of the KCP flush: pending ack, window fill, then first sends,
+// timeouts and fast resends over the in-flight list. Everything staged here
+// leaves in this loop iteration's sendmmsg.
+void KcpEngineWrapper::Flush(KcpSession* session, uint64_t now) {
+  if (now - session->last_recv >= options_.idle_timeout_ms) {
+    EndSession(sessions_.at(session->handle), "idle");
+    return;
+  }
+
+  for (uint32_t seq : session->ack_list) {
+    StageControl(session, kKcpAck, seq, now);
+  }
+  session->ack_list.clear();
+
+  const uint32_t limit = options_.no_cwnd ? options_.snd_wnd
+                                          : std::min(options_.snd_wnd, session->cwnd);
+  while (!session->snd_queue.empty() &&
+         SeqDiff(session->snd_nxt, session->snd_una) < static_cast<int32_t>(limit)) {
+    KcpSegment segment = std::move(session->snd_queue.front());
+    session->snd_queue.pop_front();
+    segment.seq = session->snd_nxt++;
+    PutU32(segment.wire.data() + 5, segment.seq);
+    session->snd_buf.push_back(std::move(segment));
+  }
+
+  bool lost = false;
+  bool fast = false;
+  uint64_t next = now + options_.idle_timeout_ms;
+  for (auto& segment : session->snd_buf) {
+    if (segment.acked) continue;
+    bool send = false;
+    if (segment.xmit == 0) {
+      send = true;
+      segment.rto = session->rto;
+      segment.resend_at = now + segment.rto;
+    } else if (now >= segment.resend_at) {
+      send = true;
+      lost = true;
+      segment.rto = options_.nodelay ? segment.rto + segment.rto / 2 : segment.rto * 2;
+      segment.rto = std::min(segment.rto, kKcpRtoMax);
+      segment.resend_at = now + segment.rto;
+      session->retransmits += 1;
+      retransmits_ += 1;
+    } else if (options_.resend > 0 && segment.fastack >= options_.resend &&
+               segment.xmit <= kKcpFastAckLimit) {
+      send = true;
+      fast = true;
+      segment.fastack = 0;
+      segment.resend_at = now + segment.rto;
+      session->fast_resends += 1;
+      fast_resends_ += 1;
+    }
+    if (send) {
+      segment.xmit += 1;
+      segment.sent_at = now;
+      PutU32(segment.wire.data() + 9, session->rcv_nxt - 1);
+      tx_.emplace_back(segment.wire.data(), segment.wire.size());
+      std::memcpy(&tx_.back().peer, &session->peer, session->peerlen);
+      tx_.back().peerlen = session->peerlen;
+      session->last_send = now;
+      session->bytes_sent += segment.wire.size() - kKcpHeaderBytes;
+      if (segment.xmit > options_.dead_link) session->dead = true;
+      if (options_.fec && segment.xmit == 1) FecAdd(session, segment, now);
+    }
+    next = std::min(next, segment.resend_at);
+  }
+  // A group closes short once nothing is queued behind it, so the tail of
+  // a burst is covered too.
+  if (options_.fec && session->snd_queue.empty()) FecClose(session, now);
+
+  if (!options_.no_cwnd) {
+    if (fast) {
+      const uint32_t in_flight = session->snd_nxt - session->snd_una;
+      session->ssthresh = std::max<uint32_t>(2, in_flight / 2);
+      session->cwnd = session->ssthresh + options_.resend;
+    }
+    if (lost) {
+      session->ssthresh = std::max<uint32_t>(2, session->cwnd / 2);
+      session->cwnd = 1;
+    }
+  }
+
+  if (session->outbound && options_.keepalive_ms > 0) {
+    if (now - session->last_send >= options_.keepalive_ms) StageControl(session, kKcpPing, 0, now);
+    next = std::min(next, session->last_send + options_.keepalive_ms);
+  }
+  next = std::min(next, session->last_recv + options_.idle_timeout_ms);
+
+  {
+    std::lock_guard<std::mutex> lock(table_mutex_);
+    KcpSessionStats& stats = session->stats;
+    stats.srtt = session->srtt;
+    stats.rto = session->rto;
+    stats.cwnd = session->cwnd;
+    stats.in_flight = static_cast<uint32_t>(session->snd_buf.size());
+    stats.queued = static_cast<uint32_t>(session->snd_queue.size());
+    stats.snd_una = session->snd_una;
+    stats.snd_nxt = session->snd_nxt;
+    stats.rcv_nxt = session->rcv_nxt;
+    stats.retransmits = session->retransmits;
+    stats.fast_resends = session->fast_resends;
+    stats.bytes_sent = session->bytes_sent;
+    stats.bytes_received = session->bytes_received;
+    stats.fec_parity = session->fec_parity;
+    stats.fec_loss_ppm = session->fec_loss_ppm;
+    stats.fec_receive_loss_ppm = session->fec_receive_loss_ppm;
+    stats.fec_recovered = session->fec_recovered;
+  }
+
+  if (session->dead) {
+    EndSession(sessions_.at(session->handle), "dead-link");
+    return;
+  }
+  if (session->deadline == 0 || next < session->deadline) {
+    session->deadline = next;
+    wheel_.Schedule(session->handle, next);
+  }
+}
+
+void KcpEngineWrapper::SendStaged() {
+  if (options_.loss > 0 && !tx_.empty()) {
+    // Lost on the way out, as far as the peer can tell; the ARQ recovers
+    // them like any other loss. The threshold compares the generator's
+    // raw output, which the standard fixes, so a seed replays exactly.
+    const auto threshold =
+        static_cast<uint64_t>(options_.loss * static_cast<double>(std::mt19937_64::max()));
+    const auto kept = std::remove_if(tx_.begin(), tx_.end(), [&](const libsocket::dgram_message&) {
+      return loss_random_() < threshold;
+    });
+    impaired_drops_ += static_cast<uint64_t>(tx_.end() - kept);
+    tx_.erase(kept, tx_.end());
+  }
+  size_t offset = 0;
+  while (offset < tx_.size()) {
+    int sent = socket_->try_sndmmsg(tx_.data() + offset, tx_.size() - offset);
+    if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      // Only the first datagram failed; skip that peer.
+      sent = 1;
+    }
+    send_calls_ += 1;
+    // A full send buffer drops the rest; the ARQ resends what mattered.
+    if (sent <= 0) break;
+    datagrams_out_ += static_cast<uint64_t>(sent);
+    offset += static_cast<size_t>(sent);
+  }
+  tx_.clear();
+  control_.clear();
+  for (auto& wire : fec_out_) {
+    if (wire_pool_.size() < 4096) wire_pool_.push_back(std::move(wire));
+  }
+  fec_out_.clear();
+}
+
+void KcpEngineWrapper::Deliver() {
+  if (deliver_queue_.empty()) return;
+  std::vector<PendingMessage> batch;
+  batch.reserve(deliver_queue_.size());
+  for (auto& session : deliver_queue_) {
+    session->deliver_queued = false;
+    PendingMessage message;
+    message.key = session->key;
+    message.address = session->address;
+    message.port = session->port;
+    message.data.swap(session->delivered);
+    batch.push_back(std::move(message));
+  }
+  deliver_queue_.clear();
+
+  Emit([batch = std::move(batch)](Napi::Env env, Napi::Object self, Napi::Function emit) {
+    auto payload_for = [env](const PendingMessage& message) {
+      Napi::Object payload = Napi::Object::New(env);
+      payload.Set("session", message.key);
+      payload.Set("address", message.address);
+      payload.Set("port", message.port);
+      payload.Set("data",
+                  Napi::Buffer<uint8_t>::Copy(env, message.data.data(), message.data.size()));
+      return payload;
+    };
+    if (batch.size() == 1) {
+      emit.Call(self, {Napi::String::New(env, "message"), payload_for(batch.front())});
+      return;
+    }
+    Napi::Array payloads = Napi::Array::New(env, batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+      payloads.Set(static_cast<uint32_t>(i), payload_for(batch[i]));
+    }
+    emit.Call(self, {Napi::String::New(env, "messages"), payloads});
+  });
+}
+
+// Unlinks the peer at once so a new packet opens a fresh session; the table
+// entry goes after this iteration's sends and deliveries.
+void KcpEngineWrapper::EndSession(const std::shared_ptr<KcpSession>& session, const char* reason) {
+  if (std::find(ended_.begin(), ended_.end(), session) != ended_.end()) return;
+  session->dead = true;
+  by_peer_.erase(session->peer_id);
+  ended_.push_back(session);
+  Emit([key = session->key, why = std::string(reason)](Napi::Env env, Napi::Object self,
+                                                      Napi::Function emit) {
+    Napi::Object payload = Napi::Object::New(env);
+    payload.Set("key", key);
+    payload.Set("reason", why);
+    emit.Call(self, {Napi::String::New(env, "session:end"), payload});
+  });
+}
+
+void KcpEngineWrapper::Emit(std::function<void(Napi::Env, Napi::Object, Napi::Function)> build) {
+  if (!tsfn_ready_) return;
+  tsfn_.NonBlockingCall([this, build = std::move(build)](Napi::Env env, Napi::Function) {
+    if (self_ref_.IsEmpty()) return;
+    Napi::Object self = self_ref_.Value();
+    if (self.Has("emit") && self.Get("emit").IsFunction()) {
+      build(env, self, self.Get("emit").As<Napi::Function>());
+    }
+  });
+}
+
+// LAN discovery on a multicast group (src/node/discovery.ts). A loop thread
+// joins the group with libsocket's create_multicast_socket, re-sends this
+// node's announcement every interval and reads announcements with
+// recvmmsg. Datagrams without the magic prefix are dropped before JS sees
+// them; the rest are deduplicated by a bloom filter over their content
+// (the "ts" field aside), cleared every dedupe window, so an unchanged peer
+// is reported once per window and a changed one at once. What is left goes
+// to JS as one "peers" event per batch.
+class DiscoveryWrapper : public Napi::ObjectWrap<DiscoveryWrapper> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  explicit DiscoveryWrapper(const Napi::CallbackInfo& info);
+  ~DiscoveryWrapper() override;
+
+ private:
+  struct Options {
+    std::string group = "239.255.67.71";
+    uint16_t port = 43221;
+    std::string interface_name;
+    std::string prefix;
+    bool loopback = true;
+    uint64_t interval_ms = 5000;
+    uint64_t batch_ms = 50;
+    size_t max_batch = 64;
+    uint64_t dedupe_window_ms = 30000;
+    size_t bloom_bits = size_t{1} << 16;
+  };
+
+  struct Announcement {
+    std::vector<uint8_t> data;
+    std::string address;
+    uint16_t port = 0;
+  };
+
+  static constexpr uint64_t kWakeToken = 0;
+  static constexpr uint64_t kSocketToken = 1;
+  static constexpr size_t kSlots = 32;
+  static constexpr size_t kSlotBytes = 2048;
+  static constexpr int kBloomHashes = 3;
+
+  Napi::Value Start(const Napi::CallbackInfo& info);
+  Napi::Value Announce(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+  // Loop thread.
+  void Run();
+  void ReceiveReady(uint64_t now_ms);
+  void SendAnnouncement();
+  void FlushBatch();
+  // True when `hash` was already seen this window; records it either way.
+  bool SeenThisWindow(uint64_t hash, uint64_t now_ms);
+
+  // JS thread.
+  void Stop();
+  void Emit(std::function<void(Napi::Env, Napi::Object, Napi::Function)> build);
+
+  Options options_;
+  int fd_ = -1;
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  struct sockaddr_storage group_addr_ {};
+  socklen_t group_len_ = 0;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+
+  // Set from JS, sent by the loop thread.
+  std::mutex announce_mutex_;
+  std::vector<uint8_t> announcement_;
+  bool announce_now_ = false;
+
+  // Loop thread only.
+  std::vector<uint8_t> rx_slab_;
+  std::vector<uint64_t> bloom_;
+  uint64_t window_started_ms_ = 0;
+  uint64_t next_announce_ms_ = 0;
+  uint64_t batch_deadline_ms_ = 0;
+  std::vector<Announcement> pending_;
+
+  std::atomic<uint64_t> datagrams_in_{0};
+  std::atomic<uint64_t> filtered_{0};
+  std::atomic<uint64_t> duplicates_{0};
+  std::atomic<uint64_t> self_echoes_{0};
+  std::atomic<uint64_t> emitted_{0};
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> announcements_{0};
+
+  Napi::ThreadSafeFunction tsfn_;
+  bool tsfn_ready_ = false;
+  Napi::ObjectReference self_ref_;
+};
+
+// FNV-1a over an announcement, skipping the digits of its "ts" field so a
+// re-sent announcement hashes the same.
+uint64_t AnnouncementHash(const uint8_t* data, size_t length) {
+  static constexpr char kTs[] = "\"ts\":";
+  const uint8_t* end = data + length;
+  const uint8_t* ts = std::search(data, end, kTs, kTs + sizeof(kTs) - 1);
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (const uint8_t* p = data; p < end; ++p) {
+    if (p == ts) {
+      p += sizeof(kTs) - 1;
+      while (p < end && ((*p >= '0' && *p <= '9') || *p == '.' || *p == '-')) ++p;
+      if (p == end) break;
+    }
+    hash = (hash ^ *p) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+Napi::Object DiscoveryWrapper::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "QWormholeDiscovery",
+                                    {
+                                        InstanceMethod<&DiscoveryWrapper::Start>("start"),
+                                        InstanceMethod<&DiscoveryWrapper::Announce>("announce"),
+                                        InstanceMethod<&DiscoveryWrapper::Close>("close"),
+                                        InstanceMethod<&DiscoveryWrapper::GetStats>("getStats"),
+                                    });
+  exports.Set("QWormholeDiscovery", func);
+  return exports;
+}
+
+DiscoveryWrapper::DiscoveryWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<DiscoveryWrapper>(info) {
+  if (info.Length() < 1 || !info[0].IsObject()) return;
+  Napi::Object obj = info[0].As<Napi::Object>();
+  auto number = [&](const char* key, uint64_t fallback) {
+    Napi::Value value = obj.Get(key);
+    if (!value.IsNumber()) return fallback;
+    return static_cast<uint64_t>(std::max<int64_t>(0, value.As<Napi::Number>().Int64Value()));
+  };
+  if (obj.Get("group").IsString()) options_.group = obj.Get("group").As<Napi::String>().Utf8Value();
+  if (obj.Get("interface").IsString()) {
+    options_.interface_name = obj.Get("interface").As<Napi::String>().Utf8Value();
+  }
+  if (obj.Get("prefix").IsString()) options_.prefix = obj.Get("prefix").As<Napi::String>().Utf8Value();
+  if (obj.Get("loopback").IsBoolean()) options_.loopback = obj.Get("loopback").As<Napi::Boolean>().Value();
+  options_.port = static_cast<uint16_t>(number("port", options_.port));
+  options_.interval_ms = std::max<uint64_t>(100, number("intervalMs", options_.interval_ms));
+  options_.batch_ms = number("batchMs", options_.batch_ms);
+  options_.max_batch = static_cast<size_t>(std::max<uint64_t>(1, number("maxBatch", options_.max_batch)));
+  options_.dedupe_window_ms = std::max<uint64_t>(1, number("dedupeWindowMs", options_.dedupe_window_ms));
+  // Whole words, at least 1024 bits.
+  options_.bloom_bits =
+      static_cast<size_t>(std::max<uint64_t>(1024, number("bloomBits", options_.bloom_bits)) + 63) / 64 * 64;
+}
+
+DiscoveryWrapper::~DiscoveryWrapper() {
+  Stop();
+  if (tsfn_ready_) {
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+}
+
+Napi::Value DiscoveryWrapper::Start(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  auto deferred = Napi::Promise::Deferred::New(env);
+  if (running_) {
+    deferred.Reject(Napi::Error::New(env, "Discovery already started").Value());
+    return deferred.Promise();
+  }
+  const std::string port = std::to_string(options_.port);
+  fd_ = create_multicast_socket(options_.group.c_str(), port.c_str(),
+                                options_.interface_name.empty() ? nullptr
+                                                                : options_.interface_name.c_str());
+  if (fd_ < 0) {
+    deferred.Reject(Napi::Error::New(env, "Could not join " + options_.group + ":" + port + ": " +
+                                              std::strerror(errno))
+                        .Value());
+    return deferred.Promise();
+  }
+  struct addrinfo hints {};
+  hints.ai_socktype = SOCK_DGRAM;
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(options_.group.c_str(), port.c_str(), &hints, &result) != 0 || !result) {
+    Stop();
+    deferred.Reject(Napi::Error::New(env, "Could not resolve " + options_.group).Value());
+    return deferred.Promise();
+  }
+  std::memcpy(&group_addr_, result->ai_addr, result->ai_addrlen);
+  group_len_ = result->ai_addrlen;
+  const bool ipv6 = result->ai_family == AF_INET6;
+  freeaddrinfo(result);
+  const int loop = options_.loopback ? 1 : 0;
+  setsockopt(fd_, ipv6 ? IPPROTO_IPV6 : IPPROTO_IP, ipv6 ? IPV6_MULTICAST_LOOP : IP_MULTICAST_LOOP,
+             &loop, sizeof loop);
+  fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK);
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  struct epoll_event wake {};
+  wake.events = EPOLLIN;
+  wake.data.u64 = kWakeToken;
+  struct epoll_event readable {};
+  readable.events = EPOLLIN;
+  readable.data.u64 = kSocketToken;
+  if (epoll_fd_ < 0 || wake_fd_ < 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake) != 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd_, &readable) != 0) {
+    const std::string error = std::string("epoll setup failed: ") + std::strerror(errno);
+    Stop();
+    deferred.Reject(Napi::Error::New(env, error).Value());
+    return deferred.Promise();
+  }
+
+  if (self_ref_.IsEmpty()) {
+    self_ref_ = Napi::ObjectReference::New(info.This().As<Napi::Object>(), 1);
+  }
+  tsfn_ = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+      "QWormholeDiscoveryEvents", 0, 1);
+  tsfn_ready_ = true;
+  rx_slab_.resize(kSlots * kSlotBytes);
+  bloom_.assign(options_.bloom_bits / 64, 0);
+  running_ = true;
+  thread_ = std::thread(&DiscoveryWrapper::Run, this);
+
+  Napi::Object address = Napi::Object::New(env);
+  address.Set("group", options_.group);
+  address.Set("port", options_.port);
+  address.Set("family", ipv6 ? "IPv6" : "IPv4");
+  deferred.Resolve(address);
+  return deferred.Promise();
+}
+
+// announce(data): this node's announcement, sent now and every interval.
+Napi::Value DiscoveryWrapper::Announce(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsBuffer()) {
+    Napi::TypeError::New(env, "announce(data: Buffer) required").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  auto buf = info[0].As<Napi::Buffer<uint8_t>>();
+  {
+    std::lock_guard<std::mutex> lock(announce_mutex_);
+    announcement_.assign(buf.Data(), buf.Data() + buf.Length());
+    announce_now_ = true;
+  }
+  if (running_ && wake_fd_ >= 0) {
+    const uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fd_, &one, sizeof one);
+    (void)ignored;
+  }
+  return env.Undefined();
+}
+
+void DiscoveryWrapper::Stop() {
+  if (running_.exchange(false) && wake_fd_ >= 0) {
+    const uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fd_, &one, sizeof one);
+    (void)ignored;
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  for (int* fd : {&fd_, &epoll_fd_, &wake_fd_}) {
+    if (*fd >= 0) {
+      ::close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+Napi::Value DiscoveryWrapper::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Stop();
+  if (tsfn_ready_) {
+    Emit([this](Napi::Env env, Napi::Object self, Napi::Function emit) {
+      emit.Call(self, {Napi::String::New(env, "close"), env.Undefined()});
+      if (!running_) self_ref_.Reset();
+    });
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+  return env.Undefined();
+}
+
+void DiscoveryWrapper::Run() {
+  struct epoll_event events[2];
+  while (running_) {
+    uint64_t now = SteadyNowMs();
+    bool announce_now = false;
+    {
+      std::lock_guard<std::mutex> lock(announce_mutex_);
+      std::swap(announce_now, announce_now_);
+    }
+    if (announce_now || (next_announce_ms_ != 0 && now >= next_announce_ms_)) {
+      SendAnnouncement();
+      next_announce_ms_ = now + options_.interval_ms;
+    }
+    if (!pending_.empty() && now >= batch_deadline_ms_) FlushBatch();
+
+    uint64_t wake_at = next_announce_ms_;
+    if (!pending_.empty()) wake_at = wake_at ? std::min(wake_at, batch_deadline_ms_) : batch_deadline_ms_;
+    const int timeout = wake_at == 0 ? -1 : static_cast<int>(wake_at > now ? wake_at - now : 0);
+    const int ready = epoll_wait(epoll_fd_, events, 2, timeout);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    for (int i = 0; i < ready; ++i) {
+      if (events[i].data.u64 == kWakeToken) {
+        uint64_t count = 0;
+        ssize_t ignored = ::read(wake_fd_, &count, sizeof count);
+        (void)ignored;
+        continue;
+      }
+      ReceiveReady(SteadyNowMs());
+    }
+  }
+}
+
+void DiscoveryWrapper::SendAnnouncement() {
+  std::vector<uint8_t> packet;
+  {
+    std::lock_guard<std::mutex> lock(announce_mutex_);
+    packet = announcement_;
+  }
+  if (packet.empty()) return;
+  if (::sendto(fd_, packet.data(), packet.size(), 0,
+               reinterpret_cast<const struct sockaddr*>(&group_addr_), group_len_) >= 0) {
+    announcements_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+bool DiscoveryWrapper::SeenThisWindow(uint64_t hash, uint64_t now_ms) {
+  if (now_ms - window_started_ms_ >= options_.dedupe_window_ms) {
+    std::fill(bloom_.begin(), bloom_.end(), 0);
+    window_started_ms_ = now_ms;
+  }
+  // Double hashing: bit i is h1 + i * h2.
+  const uint64_t h1 = hash;
+  const uint64_t h2 = (hash >> 32) | 1;
+  const size_t bits = bloom_.size() * 64;
+  bool seen = true;
+  for (int i = 0; i < kBloomHashes; ++i) {
+    const size_t bit = static_cast<size_t>((h1 + static_cast<uint64_t>(i) * h2) % bits);
+    const uint64_t mask = uint64_t{1} << (bit % 64);
+    if ((bloom_[bit / 64] & mask) == 0) {
+      seen = false;
+      bloom_[bit / 64] |= mask;
+    }
+  }
+  return seen;
+}
+
+void DiscoveryWrapper::ReceiveReady(uint64_t now_ms) {
+  std::array<struct mmsghdr, kSlots> msgs {};
+  std::array<struct iovec, kSlots> iovs {};
+  std::array<struct sockaddr_storage, kSlots> peers {};
+  std::vector<uint8_t> own;
+  {
+    std::lock_guard<std::mutex> lock(announce_mutex_);
+    own = announcement_;
+  }
+  for (int round = 0; round < kMaxReadsPerEvent && running_; ++round) {
+    for (size_t i = 0; i < kSlots; ++i) {
+      iovs[i] = {rx_slab_.data() + i * kSlotBytes, kSlotBytes};
+      msgs[i].msg_hdr = {};
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_name = &peers[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+    }
+    const int received = recvmmsg(fd_, msgs.data(), kSlots, MSG_DONTWAIT, nullptr);
+    if (received <= 0) return;
+    datagrams_in_.fetch_add(static_cast<uint64_t>(received), std::memory_order_relaxed);
+    for (int i = 0; i < received; ++i) {
+      const uint8_t* data = rx_slab_.data() + static_cast<size_t>(i) * kSlotBytes;
+      const size_t length = msgs[i].msg_len;
+      if ((msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0 || length < options_.prefix.size() ||
+          std::memcmp(data, options_.prefix.data(), options_.prefix.size()) != 0) {
+        filtered_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      if (length == own.size() && std::memcmp(data, own.data(), length) == 0) {
+        self_echoes_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      if (SeenThisWindow(AnnouncementHash(data, length), now_ms)) {
+        duplicates_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      Announcement announcement;
+      announcement.data.assign(data, data + length);
+      FormatPeer(peers[i], &announcement.address, &announcement.port);
+      if (pending_.empty()) batch_deadline_ms_ = now_ms + options_.batch_ms;
+      pending_.push_back(std::move(announcement));
+      if (pending_.size() >= options_.max_batch) FlushBatch();
+    }
+    if (static_cast<size_t>(received) < kSlots) return;
+  }
+}
+
+void DiscoveryWrapper::FlushBatch() {
+  if (pending_.empty()) return;
+  emitted_.fetch_add(pending_.size(), std::memory_order_relaxed);
+  batches_.fetch_add(1, std::memory_order_relaxed);
+  Emit([batch = std::move(pending_)](Napi::Env env, Napi::Object self, Napi::Function emit) {
+    Napi::Array payloads = Napi::Array::New(env, batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+      Napi::Object payload = Napi::Object::New(env);
+      payload.Set("data", Napi::Buffer<uint8_t>::Copy(env, batch[i].data.data(), batch[i].data.size()));
+      payload.Set("address", batch[i].address);
+      payload.Set("port", batch[i].port);
+      payloads.Set(static_cast<uint32_t>(i), payload);
+    }
+    emit.Call(self, {Napi::String::New(env, "peers"), payloads});
+  });
+  pending_.clear();
+}
+
+// getStats(): what the loop thread kept away from JS, and what it let through.
+Napi::Value DiscoveryWrapper::GetStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("datagramsIn", static_cast<double>(datagrams_in_.load(std::memory_order_relaxed)));
+  out.Set("filtered", static_cast<double>(filtered_.load(std::memory_order_relaxed)));
+  out.Set("duplicates", static_cast<double>(duplicates_.load(std::memory_order_relaxed)));
+  out.Set("selfEchoes", static_cast<double>(self_echoes_.load(std::memory_order_relaxed)));
+  out.Set("emitted", static_cast<double>(emitted_.load(std::memory_order_relaxed)));
+  out.Set("batches", static_cast<double>(batches_.load(std::memory_order_relaxed)));
+  out.Set("announcements", static_cast<double>(announcements_.load(std::memory_order_relaxed)));
+  return out;
+}
+
+void DiscoveryWrapper::Emit(std::function<void(Napi::Env, Napi::Object, Napi::Function)> build) {
+  if (!tsfn_ready_) return;
+  tsfn_.NonBlockingCall([this, build = std::move(build)](Napi::Env env, Napi::Function) {
+    if (self_ref_.IsEmpty()) return;
+    Napi::Object self = self_ref_.Value();
+    if (self.Has("emit") && self.Get("emit").IsFunction()) {
+      build(env, self, self.Get("emit").As<Napi::Function>());
+    }
+  });
+}
+
+// Reliable multicast fan-out (src/transports/udp/multicast-channel.ts), NORM
+// style. A send is one datagram to the group, numbered per source and kept
+// in a retransmit window. Sources send from a unicast socket of their own,
+// so receivers know where to NACK: a receiver that sees a gap waits
+// nack_delay_ms for reordering, then NACKs the missing ranges to the
+// source, which repairs each frame unicast to that receiver alone. Once a
+// frame draws repair_group_after NACKs (the source itself dropped it, not
+// one slow peer), it is repaired to the group instead. A NACK for frames
+// the window no longer holds is answered with a gap, and the receiver
+// reports them lost and moves on. Heartbeats after the last send (doubling
+// from heartbeat_ms, for about a second) carry the next sequence number,
+// so a lost tail is noticed too. Frames reach JS in order per source, one
+// "messages" event per read burst.
+class MulticastChannelWrapper : public Napi::ObjectWrap<MulticastChannelWrapper> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  explicit MulticastChannelWrapper(const Napi::CallbackInfo& info);
+  ~MulticastChannelWrapper() override;
+
+ private:
+  struct Options {
+    std::string group = "239.255.67.72";
+    uint16_t port = 43222;
+    std::string interface_name;
+    bool loopback = true;
+    int ttl = 1;
+    size_t max_payload = 1400;
+    size_t window_frames = 4096;
+    size_t window_bytes = 8 * 1024 * 1024;
+    uint64_t nack_delay_ms = 5;
+    uint64_t nack_interval_ms = 40;
+    uint32_t max_nacks = 5;
+    uint32_t repair_group_after = 3;
+    uint64_t heartbeat_ms = 100;
+    size_t max_held = 1024;
+    uint64_t source_timeout_ms = 30000;
+  };
+
+  // Wire: 'Q' 'M', version, kind, then the sending node's id (u32); all
+  // integers big endian.
+  enum Kind : uint8_t {
+    kData = 1,    // seq u32, payload
+    kRepair = 2,  // a kData frame sent again
+    kHeartbeat = 3,  // the next seq the source will use
+    kNack = 4,    // source id u32, count u8, count x (first u32, length u16)
+    kGap = 5,     // first u32, count u32: no longer in the window
+  };
+  static constexpr size_t kHeaderBytes = 8;
+  static constexpr size_t kDataHeaderBytes = kHeaderBytes + 4;
+  static constexpr uint8_t kVersion = 1;
+  static constexpr size_t kMaxNackRanges = 64;
+  static constexpr uint16_t kMaxNackRange = 1024;
+  static constexpr uint64_t kMaxHeartbeatGapMs = 1000;
+  static constexpr uint64_t kWakeToken = 0;
+  static constexpr uint64_t kGroupToken = 1;
+  static constexpr uint64_t kUnicastToken = 2;
+  static constexpr size_t kSlots = 32;
+
+  struct WindowEntry {
+    uint32_t seq = 0;
+    std::vector<uint8_t> payload;
+    // NACKs since the last group repair, and when that was.
+    uint32_t nacks = 0;
+    uint64_t group_repair_ms = 0;
+  };
+
+  // A sender heard on the group. Sequence numbers are widened to 64 bits
+  // around `next`, starting 2^32 in so that none goes below zero.
+  struct Source {
+    uint32_t id = 0;
+    struct sockaddr_storage addr {};
+    socklen_t addr_len = 0;
+    std::string address;
+    uint16_t port = 0;
+    uint64_t next = 0;
+    uint64_t highest = 0;
+    std::map<uint64_t, std::vector<uint8_t>> held;
+    uint64_t nack_at_ms = 0;
+    uint64_t nack_head = 0;
+    uint32_t nacks = 0;
+    uint64_t heard_ms = 0;
+  };
+
+  struct Delivery {
+    uint32_t source = 0;
+    std::string address;
+    uint16_t port = 0;
+    uint32_t seq = 0;
+    std::vector<uint8_t> data;
+  };
+
+  Napi::Value Start(const Napi::CallbackInfo& info);
+  Napi::Value Send(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+  Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+  // Any thread.
+  void PutHeader(uint8_t* out, Kind kind) const;
+  bool SendFrame(Kind kind, uint32_t seq, const uint8_t* data, size_t length,
+                 const struct sockaddr_storage& to, socklen_t to_len);
+
+  // Loop thread.
+  void Run();
+  void ReceiveReady(int fd, uint64_t now_ms);
+  void OnPacket(const uint8_t* data, size_t length, const struct sockaddr_storage& from,
+                socklen_t from_len, uint64_t now_ms);
+  void OnData(Source* source, uint64_t wide, const uint8_t* payload, size_t length,
+              uint64_t now_ms);
+  void OnNack(const uint8_t* body, size_t length, const struct sockaddr_storage& from,
+              socklen_t from_len, uint64_t now_ms);
+  // Skips `source` past every frame before `to`, reporting them lost.
+  void GiveUp(Source* source, uint64_t to);
+  void Deliver(Source* source);
+  void ScheduleNack(Source* source, uint64_t now_ms);
+  void SendNack(Source* source, uint64_t now_ms);
+  void Heartbeat(uint64_t now_ms);
+  uint64_t NextTimerMs(uint64_t now_ms);
+  void FlushDeliveries();
+
+  // JS thread.
+  void Stop();
+  void Emit(std::function<void(Napi::Env, Napi::Object, Napi::Function)> build);
+
+  Options options_;
+  uint32_t node_id_ = 0;
+  int fd_ = -1;    // joined to the group; receives what is sent to it
+  int ufd_ = -1;   // sends everything; receives NACKs, repairs and gaps
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
+  struct sockaddr_storage group_addr_ {};
+  socklen_t group_len_ = 0;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+
+  // Filled by send() on the JS thread, read for repairs by the loop thread.
+  std::mutex window_mutex_;
+  std::deque<WindowEntry> window_;
+  size_t window_bytes_ = 0;
+  uint32_t next_seq_ = 0;
+  // send() wakes the loop when it is not already counting heartbeats.
+  std::atomic<uint64_t> last_send_ms_{0};
+  std::atomic<bool> heartbeat_armed_{false};
+
+  // Loop thread only.
+  std::vector<uint8_t> rx_slab_;
+  size_t slot_bytes_ = 0;
+  std::unordered_map<uint32_t, Source> sources_;
+  std::vector<Delivery> deliveries_;
+  uint64_t heartbeat_epoch_ms_ = 0;
+  uint64_t heartbeat_gap_ms_ = 0;
+  uint64_t next_heartbeat_ms_ = 0;
+  uint64_t next_sweep_ms_ = 0;
+
+  std::atomic<uint64_t> frames_sent_{0};
+  std::atomic<uint64_t> bytes_sent_{0};
+  std::atomic<uint64_t> send_failures_{0};
+  std::atomic<uint64_t> frames_received_{0};
+  std::atomic<uint64_t> frames_delivered_{0};
+  std::atomic<uint64_t> duplicates_{0};
+  std::atomic<uint64_t> filtered_{0};
+  std::atomic<uint64_t> nacks_sent_{0};
+  std::atomic<uint64_t> nacks_received_{0};
+  std::atomic<uint64_t> repairs_sent_{0};
+  std::atomic<uint64_t> group_repairs_sent_{0};
+  std::atomic<uint64_t> repairs_received_{0};
+  std::atomic<uint64_t> gaps_sent_{0};
+  std::atomic<uint64_t> frames_lost_{0};
+  std::atomic<uint64_t> heartbeats_sent_{0};
+  std::atomic<size_t> source_count_{0};
+
+  Napi::ThreadSafeFunction tsfn_;
+  bool tsfn_ready_ = false;
+  Napi::ObjectReference self_ref_;
+};
+
+Napi::Object MulticastChannelWrapper::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func =
+      DefineClass(env, "QWormholeMulticast",
+                  {
+                      InstanceMethod<&MulticastChannelWrapper::Start>("start"),
+                      InstanceMethod<&MulticastChannelWrapper::Send>("send"),
+                      InstanceMethod<&MulticastChannelWrapper::Close>("close"),
+                      InstanceMethod<&MulticastChannelWrapper::GetStats>("getStats"),
+                  });
+  exports.Set("QWormholeMulticast", func);
+  return exports;
+}
+
+MulticastChannelWrapper::MulticastChannelWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<MulticastChannelWrapper>(info) {
+  std::random_device entropy;
+  do {
+    node_id_ = entropy();
+  } while (node_id_ == 0);
+  if (info.Length() < 1 || !info[0].IsObject()) return;
+  Napi::Object obj = info[0].As<Napi::Object>();
+  auto number = [&](const char* key, uint64_t fallback) {
+    Napi::Value value = obj.Get(key);
+    if (!value.IsNumber()) return fallback;
+    return static_cast<uint64_t>(std::max<int64_t>(0, value.As<Napi::Number>().Int64Value()));
+  };
+  if (obj.Get("group").IsString()) options_.group = obj.Get("group").As<Napi::String>().Utf8Value();
+  if (obj.Get("interface").IsString()) {
+    options_.interface_name = obj.Get("interface").As<Napi::String>().Utf8Value();
+  }
+  if (obj.Get("loopback").IsBoolean()) options_.loopback = obj.Get("loopback").As<Napi::Boolean>().Value();
+  options_.port = static_cast<uint16_t>(number("port", options_.port));
+  options_.ttl = static_cast<int>(std::clamp<uint64_t>(number("ttl", 1), 1, 255));
+  options_.max_payload = static_cast<size_t>(
+      std::clamp<uint64_t>(number("maxPayloadBytes", options_.max_payload), 64, 65507 - kDataHeaderBytes));
+  options_.window_frames =
+      static_cast<size_t>(std::max<uint64_t>(1, number("windowFrames", options_.window_frames)));
+  options_.window_bytes = static_cast<size_t>(
+      std::max<uint64_t>(options_.max_payload, number("windowBytes", options_.window_bytes)));
+  options_.nack_delay_ms = number("nackDelayMs", options_.nack_delay_ms);
+  options_.nack_interval_ms = std::max<uint64_t>(1, number("nackIntervalMs", options_.nack_interval_ms));
+  options_.max_nacks = static_cast<uint32_t>(std::max<uint64_t>(1, number("maxNacks", options_.max_nacks)));
+  options_.repair_group_after = static_cast<uint32_t>(
+      std::max<uint64_t>(1, number("repairGroupAfter", options_.repair_group_after)));
+  options_.heartbeat_ms = std::max<uint64_t>(1, number("heartbeatMs", options_.heartbeat_ms));
+  options_.max_held = static_cast<size_t>(std::max<uint64_t>(1, number("maxHeldFrames", options_.max_held)));
+  options_.source_timeout_ms =
+      std::max<uint64_t>(1000, number("sourceTimeoutMs", options_.source_timeout_ms));
+}
+
+MulticastChannelWrapper::~MulticastChannelWrapper() {
+  Stop();
+  if (tsfn_ready_) {
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+}
+
+Napi::Value MulticastChannelWrapper::Start(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  auto deferred = Napi::Promise::Deferred::New(env);
+  if (running_) {
+    deferred.Reject(Napi::Error::New(env, "Multicast channel already started").Value());
+    return deferred.Promise();
+  }
+  const std::string port = std::to_string(options_.port);
+  struct addrinfo hints {};
+  hints.ai_socktype = SOCK_DGRAM;
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(options_.group.c_str(), port.c_str(), &hints, &result) != 0 || !result) {
+    deferred.Reject(Napi::Error::New(env, "Could not resolve " + options_.group).Value());
+    return deferred.Promise();
+  }
+  std::memcpy(&group_addr_, result->ai_addr, result->ai_addrlen);
+  group_len_ = result->ai_addrlen;
+  const bool ipv6 = result->ai_family == AF_INET6;
+  freeaddrinfo(result);
+
+  fd_ = create_multicast_socket(options_.group.c_str(), port.c_str(),
+                                options_.interface_name.empty() ? nullptr
+                                                                : options_.interface_name.c_str());
+  if (fd_ < 0) {
+    deferred.Reject(Napi::Error::New(env, "Could not join " + options_.group + ":" + port + ": " +
+                                              std::strerror(errno))
+                        .Value());
+    return deferred.Promise();
+  }
+  // The group socket is bound to the group address, so unicast replies
+  // need a socket of their own; it sends to the group as well.
+  ufd_ = create_inet_server_socket(ipv6 ? "::" : "0.0.0.0", "0", LIBSOCKET_UDP,
+                                   ipv6 ? LIBSOCKET_IPv6 : LIBSOCKET_IPv4, 0);
+  if (ufd_ < 0) {
+    const std::string error = std::string("Could not open the unicast socket: ") + std::strerror(errno);
+    Stop();
+    deferred.Reject(Napi::Error::New(env, error).Value());
+    return deferred.Promise();
+  }
+  const int loop = options_.loopback ? 1 : 0;
+  const unsigned int ifindex =
+      options_.interface_name.empty() ? 0 : if_nametoindex(options_.interface_name.c_str());
+  if (ipv6) {
+    setsockopt(ufd_, IPPROTO_IPV6, IPV6_MULTICAST_LOOP, &loop, sizeof loop);
+    setsockopt(ufd_, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &options_.ttl, sizeof options_.ttl);
+    if (ifindex != 0) setsockopt(ufd_, IPPROTO_IPV6, IPV6_MULTICAST_IF, &ifindex, sizeof ifindex);
+  } else {
+    setsockopt(ufd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof loop);
+    setsockopt(ufd_, IPPROTO_IP, IP_MULTICAST_TTL, &options_.ttl, sizeof options_.ttl);
+    if (ifindex != 0) {
+      struct ip_mreqn mreq {};
+      mreq.imr_ifindex = static_cast<int>(ifindex);
+      setsockopt(ufd_, IPPROTO_IP, IP_MULTICAST_IF, &mreq, sizeof mreq);
+    }
+  }
+  for (int fd : {fd_, ufd_}) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  struct epoll_event wake {};
+  wake.events = EPOLLIN;
+  wake.data.u64 = kWakeToken;
+  struct epoll_event group {};
+  group.events = EPOLLIN;
+  group.data.u64 = kGroupToken;
+  struct epoll_event unicast {};
+  unicast.events = EPOLLIN;
+  unicast.data.u64 = kUnicastToken;
+  if (epoll_fd_ < 0 || wake_fd_ < 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &wake) != 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd_, &group) != 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, ufd_, &unicast) != 0) {
+    const std::string error = std::string("epoll setup failed: ") + std::strerror(errno);
+    Stop();
+    deferred.Reject(Napi::Error::New(env, error).Value());
+    return deferred.Promise();
+  }
+
+  if (self_ref_.IsEmpty()) {
+    self_ref_ = Napi::ObjectReference::New(info.This().As<Napi::Object>(), 1);
+  }
+  tsfn_ = Napi::ThreadSafeFunction::New(
+      env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+      "QWormholeMulticastEvents", 0, 1);
+  tsfn_ready_ = true;
+  slot_bytes_ = kDataHeaderBytes + options_.max_payload;
+  rx_slab_.resize(kSlots * slot_bytes_);
+  running_ = true;
+  thread_ = std::thread(&MulticastChannelWrapper::Run, this);
+
+  Napi::Object address = Napi::Object::New(env);
+  address.Set("group", options_.group);
+  address.Set("port", options_.port);
+  address.Set("family", ipv6 ? "IPv6" : "IPv4");
+  address.Set("sourceId", static_cast<double>(node_id_));
+  deferred.Resolve(address);
+  return deferred.Promise();
+}
+
+void MulticastChannelWrapper::PutHeader(uint8_t* out, Kind kind) const {
+  out[0] = 'Q';
+  out[1] = 'M';
+  out[2] = kVersion;
+  out[3] = kind;
+  PutU32(out + 4, node_id_);
+}
+
+bool MulticastChannelWrapper::SendFrame(Kind kind, uint32_t seq, const uint8_t* data,
+                                        size_t length, const struct sockaddr_storage& to,
+                                        socklen_t to_len) {
+  uint8_t header[kDataHeaderBytes];
+  PutHeader(header, kind);
+  PutU32(header + kHeaderBytes, seq);
+  struct iovec iov[2] = {{header, sizeof header}, {const_cast<uint8_t*>(data), length}};
+  struct msghdr msg {};
+  msg.msg_name = const_cast<struct sockaddr_storage*>(&to);
+  msg.msg_namelen = to_len;
+  msg.msg_iov = iov;
+  msg.msg_iovlen = length > 0 ? 2 : 1;
+  if (::sendmsg(ufd_, &msg, MSG_DONTWAIT) < 0) {
+    send_failures_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+// send(data): one frame to the group; its sequence number, or false once
+// closed. It stays in the window for repairs until evicted.
+Napi::Value MulticastChannelWrapper::Send(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsBuffer()) {
+    Napi::TypeError::New(env, "send(data: Buffer) required").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!running_) return Napi::Boolean::New(env, false);
+  auto buf = info[0].As<Napi::Buffer<uint8_t>>();
+  if (buf.Length() > options_.max_payload) {
+    Napi::RangeError::New(env, "Multicast frame exceeds maxPayloadBytes").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  uint32_t seq = 0;
+  {
+    std::lock_guard<std::mutex> lock(window_mutex_);
+    seq = next_seq_++;
+    WindowEntry entry;
+    entry.seq = seq;
+    entry.payload.assign(buf.Data(), buf.Data() + buf.Length());
+    window_bytes_ += entry.payload.size();
+    window_.push_back(std::move(entry));
+    while (window_.size() > options_.window_frames ||
+           (window_bytes_ > options_.window_bytes && window_.size() > 1)) {
+      window_bytes_ -= window_.front().payload.size();
+      window_.pop_front();
+    }
+  }
+  if (SendFrame(kData, seq, buf.Data(), buf.Length(), group_addr_, group_len_)) {
+    frames_sent_.fetch_add(1, std::memory_order_relaxed);
+    bytes_sent_.fetch_add(buf.Length(), std::memory_order_relaxed);
+  }
+  last_send_ms_.store(SteadyNowMs());
+  if (!heartbeat_armed_.exchange(true) && wake_fd_ >= 0) {
+    const uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fd_, &one, sizeof one);
+    (void)ignored;
+  }
+  return Napi::Number::New(env, seq);
+}
+
+void MulticastChannelWrapper::Stop() {
+  if (running_.exchange(false) && wake_fd_ >= 0) {
+    const uint64_t one = 1;
+    ssize_t ignored = ::write(wake_fd_, &one, sizeof one);
+    (void)ignored;
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  for (int* fd : {&fd_, &ufd_, &epoll_fd_, &wake_fd_}) {
+    if (*fd >= 0) {
+      ::close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+Napi::Value MulticastChannelWrapper::Close(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Stop();
+  if (tsfn_ready_) {
+    Emit([this](Napi::Env env, Napi::Object self, Napi::Function emit) {
+      emit.Call(self, {Napi::String::New(env, "close"), env.Undefined()});
+      if (!running_) self_ref_.Reset();
+    });
+    tsfn_.Release();
+    tsfn_ready_ = false;
+  }
+  return env.Undefined();
+}
+
+void MulticastChannelWrapper::Run() {
+  struct epoll_event events[3];
+  while (running_) {
+    const uint64_t now = SteadyNowMs();
+    Heartbeat(now);
+    for (auto& [id, source] : sources_) {
+      if (source.nack_at_ms != 0 && now >= source.nack_at_ms) SendNack(&source, now);
+    }
+    if (now >= next_sweep_ms_) {
+      for (auto it = sources_.begin(); it != sources_.end();) {
+        if (now - it->second.heard_ms >= options_.source_timeout_ms) {
+          it = sources_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      source_count_.store(sources_.size(), std::memory_order_relaxed);
+      next_sweep_ms_ = now + 1000;
+    }
+    FlushDeliveries();
+
+    const uint64_t wake_at = NextTimerMs(now);
+    const int timeout = static_cast<int>(wake_at > now ? wake_at - now : 0);
+    const int ready = epoll_wait(epoll_fd_, events, 3, timeout);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    for (int i = 0; i < ready; ++i) {
+      if (events[i].data.u64 == kWakeToken) {
+        uint64_t count = 0;
+        ssize_t ignored = ::read(wake_fd_, &count, sizeof count);
+        (void)ignored;
+        continue;
+      }
+      ReceiveReady(events[i].data.u64 == kGroupToken ? fd_ : ufd_, SteadyNowMs());
+    }
+  }
+}
+
+uint64_t MulticastChannelWrapper::NextTimerMs(uint64_t now_ms) {
+  uint64_t wake_at = next_sweep_ms_;
+  if (next_heartbeat_ms_ != 0) wake_at = std::min(wake_at, next_heartbeat_ms_);
+  for (const auto& [id, source] : sources_) {
+    if (source.nack_at_ms != 0) wake_at = std::min(wake_at, source.nack_at_ms);
+  }
+  return std::max(wake_at, now_ms);
+}
+
+// Heartbeats follow the last send at heartbeat_ms, 2x, 4x... up to about a
+// second, then stop until send() arms them again.
+void MulticastChannelWrapper::Heartbeat(uint64_t now_ms) {
+  if (!heartbeat_armed_.load()) return;
+  const uint64_t last = last_send_ms_.load();
+  if (last != heartbeat_epoch_ms_) {
+    heartbeat_epoch_ms_ = last;
+    heartbeat_gap_ms_ = options_.heartbeat_ms;
+    next_heartbeat_ms_ = last + heartbeat_gap_ms_;
+  }
+  if (now_ms < next_heartbeat_ms_) return;
+  uint32_t next_seq = 0;
+  {
+    std::lock_guard<std::mutex> lock(window_mutex_);
+    next_seq = next_seq_;
+  }
+  if (SendFrame(kHeartbeat, next_seq, nullptr, 0, group_addr_, group_len_)) {
+    heartbeats_sent_.fetch_add(1, std::memory_order_relaxed);
+  }
+  heartbeat_gap_ms_ *= 2;
+  if (heartbeat_gap_ms_ <= kMaxHeartbeatGapMs) {
+    next_heartbeat_ms_ = now_ms + heartbeat_gap_ms_;
+    return;
+  }
+  next_heartbeat_ms_ = 0;
+  // Disarmed before the last look, so a send() in between wakes the loop.
+  heartbeat_armed_.store(false);
+  if (last_send_ms_.load() != heartbeat_epoch_ms_) heartbeat_armed_.store(true);
+}
+
+void MulticastChannelWrapper::ReceiveReady(int fd, uint64_t now_ms) {
+  std::array<struct mmsghdr, kSlots> msgs {};
+  std::array<struct iovec, kSlots> iovs {};
+  std::array<struct sockaddr_storage, kSlots> peers {};
+  for (int round = 0; round < kMaxReadsPerEvent && running_; ++round) {
+    for (size_t i = 0; i < kSlots; ++i) {
+      iovs[i] = {rx_slab_.data() + i * slot_bytes_, slot_bytes_};
+      msgs[i].msg_hdr = {};
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_name = &peers[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+    }
+    const int received = recvmmsg(fd, msgs.data(), kSlots, MSG_DONTWAIT, nullptr);
+    if (received <= 0) return;
+    for (int i = 0; i < received; ++i) {
+      const uint8_t* data = rx_slab_.data() + static_cast<size_t>(i) * slot_bytes_;
+      if ((msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+        filtered_.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      OnPacket(data, msgs[i].msg_len, peers[i], msgs[i].msg_hdr.msg_namelen, now_ms);
+    }
+    if (static_cast<size_t>(received) < kSlots) return;
+  }
+}
+
+void MulticastChannelWrapper::OnPacket(const uint8_t* data, size_t length,
+                                       const struct sockaddr_storage& from, socklen_t from_len,
+                                       uint64_t now_ms) {
+  if (length < kHeaderBytes || data[0] != 'Q' || data[1] != 'M' || data[2] != kVersion) {
+    filtered_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  const Kind kind = static_cast<Kind>(data[3]);
+  const uint32_t sender = GetU32(data + 4);
+  // Our own frames, looped back.
+  if (sender == node_id_) return;
+  if (kind == kNack) {
+    OnNack(data + kHeaderBytes, length - kHeaderBytes, from, from_len, now_ms);
+    return;
+  }
+  if ((kind != kData && kind != kRepair && kind != kHeartbeat && kind != kGap) ||
+      length < kDataHeaderBytes || (kind == kGap && length < kDataHeaderBytes + 4)) {
+    filtered_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  const uint32_t seq = GetU32(data + kHeaderBytes);
+  auto found = sources_.find(sender);
+  if (found == sources_.end()) {
+    // Only the group introduces a source; it is joined where it is now.
+    if (kind != kData && kind != kHeartbeat) return;
+    Source created;
+    created.id = sender;
+    created.next = (uint64_t{1} << 32) + seq;
+    created.highest = kind == kData ? created.next : created.next - 1;
+    found = sources_.emplace(sender, std::move(created)).first;
+    source_count_.store(sources_.size(), std::memory_order_relaxed);
+  }
+  Source& source = found->second;
+  source.heard_ms = now_ms;
+  if (kind == kData || kind == kHeartbeat) {
+    // The source's unicast socket, where NACKs go.
+    std::memcpy(&source.addr, &from, sizeof from);
+    source.addr_len = from_len;
+    if (source.address.empty()) FormatPeer(from, &source.address, &source.port);
+  }
+  const int32_t ahead = static_cast<int32_t>(seq - static_cast<uint32_t>(source.next));
+  const uint64_t wide = source.next + static_cast<uint64_t>(static_cast<int64_t>(ahead));
+  if (kind == kHeartbeat) {
+    if (wide > source.next && wide - 1 > source.highest) {
+      source.highest = wide - 1;
+      ScheduleNack(&source, now_ms);
+    }
+    return;
+  }
+  if (kind == kGap) {
+    const uint64_t end = wide + GetU32(data + kDataHeaderBytes);
+    if (wide <= source.next && end > source.next) {
+      GiveUp(&source, end);
+      Deliver(&source);
+    }
+    return;
+  }
+  if (kind == kRepair) repairs_received_.fetch_add(1, std::memory_order_relaxed);
+  frames_received_.fetch_add(1, std::memory_order_relaxed);
+  OnData(&source, wide, data + kDataHeaderBytes, length - kDataHeaderBytes, now_ms);
+}
+
+void MulticastChannelWrapper::OnData(Source* source, uint64_t wide, const uint8_t* payload,
+                                     size_t length, uint64_t now_ms) {
+  if (wide < source->next || source->held.count(wide) != 0) {
+    duplicates_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  source->highest = std::max(source->highest, wide);
+  source->held.emplace(wide, std::vector<uint8_t>(payload, payload + length));
+  Deliver(source);
+  if (source->held.size() > options_.max_held) {
+    // Too far behind to wait any longer: the oldest gap is lost.
+    GiveUp(source, source->held.begin()->first);
+    Deliver(source);
+  }
+  ScheduleNack(source, now_ms);
+}
+
+void MulticastChannelWrapper::Deliver(Source* source) {
+  while (!source->held.empty() && source->held.begin()->first == source->next) {
+    auto node = source->held.extract(source->held.begin());
+    Delivery delivery;
+    delivery.source = source->id;
+    delivery.address = source->address;
+    delivery.port = source->port;
+    delivery.seq = static_cast<uint32_t>(source->next);
+    delivery.data = std::move(node.mapped());
+    deliveries_.push_back(std::move(delivery));
+    ++source->next;
+  }
+  if (source->next > source->highest) {
+    source->nack_at_ms = 0;
+    source->nacks = 0;
+  }
+}
+
+void MulticastChannelWrapper::GiveUp(Source* source, uint64_t to) {
+  if (to <= source->next) return;
+  const uint64_t from = source->next;
+  uint64_t lost = to - from;
+  for (auto it = source->held.begin(); it != source->held.end() && it->first < to;) {
+    it = source->held.erase(it);
+    --lost;
+  }
+  source->next = to;
+  source->highest = std::max(source->highest, to - 1);
+  source->nacks = 0;
+  source->nack_at_ms = 0;
+  frames_lost_.fetch_add(lost, std::memory_order_relaxed);
+  FlushDeliveries();
+  Emit([id = source->id, address = source->address, port = source->port,
+        first = static_cast<uint32_t>(from), lost](Napi::Env env, Napi::Object self,
+                                                   Napi::Function emit) {
+    Napi::Object payload = Napi::Object::New(env);
+    payload.Set("source", static_cast<double>(id));
+    payload.Set("address", address);
+    payload.Set("port", port);
+    payload.Set("from", static_cast<double>(first));
+    payload.Set("count", static_cast<double>(lost));
+    emit.Call(self, {Napi::String::New(env, "loss"), payload});
+  });
+}
+
+void MulticastChannelWrapper::ScheduleNack(Source* source, uint64_t now_ms) {
+  if (source->next > source->highest || source->nack_at_ms != 0) return;
+  if (source->nack_head != source->next) {
+    source->nack_head = source->next;
+    source->nacks = 0;
+  }
+  source->nack_at_ms = now_ms + (source->nacks == 0 ? options_.nack_delay_ms : options_.nack_interval_ms);
+  if (source->nack_at_ms == 0) source->nack_at_ms = 1;
+}
+
+void MulticastChannelWrapper::SendNack(Source* source, uint64_t now_ms) {
+  source->nack_at_ms = 0;
+  if (source->next > source->highest) return;
+  if (source->nack_head != source->next) {
+    source->nack_head = source->next;
+    source->nacks = 0;
+  }
+  if (source->nacks >= options_.max_nacks) {
+    // Unanswered: skip to what is held, or past all that was announced.
+    GiveUp(source, source->held.empty() ? source->highest + 1 : source->held.begin()->first);
+    Deliver(source);
+    ScheduleNack(source, now_ms);
+    return;
+  }
+  uint8_t packet[kHeaderBytes + 5 + kMaxNackRanges * 6];
+  PutHeader(packet, kNack);
+  PutU32(packet + kHeaderBytes, source->id);
+  size_t ranges = 0;
+  uint8_t* cursor = packet + kHeaderBytes + 5;
+  uint64_t at = source->next;
+  auto held = source->held.begin();
+  while (at <= source->highest && ranges < kMaxNackRanges) {
+    const uint64_t end =
+        std::min<uint64_t>(held == source->held.end() ? source->highest + 1 : held->first,
+                           at + kMaxNackRange);
+    if (end > at) {
+      PutU32(cursor, static_cast<uint32_t>(at));
+      cursor[4] = static_cast<uint8_t>((end - at) >> 8);
+      cursor[5] = static_cast<uint8_t>(end - at);
+      cursor += 6;
+      ++ranges;
+      at = end;
+      continue;
+    }
+    // Past a run of held frames.
+    while (held != source->held.end() && held->first == at) {
+      ++held;
+      ++at;
+    }
+  }
+  packet[kHeaderBytes + 4] = static_cast<uint8_t>(ranges);
+  if (ranges > 0 && ::sendto(ufd_, packet, static_cast<size_t>(cursor - packet), MSG_DONTWAIT,
+                             reinterpret_cast<const struct sockaddr*>(&source->addr),
+                             source->addr_len) >= 0) {
+    nacks_sent_.fetch_add(1, std::memory_order_relaxed);
+  }
+  ++source->nacks;
+  ScheduleNack(source, now_ms);
+}
+
+// A receiver's NACK, to this node as a source: each frame still in the
+// window goes back to that receiver, or to the group once enough of them
+// asked; anything older is answered with one gap.
+void MulticastChannelWrapper::OnNack(const uint8_t* body, size_t length,
+                                     const struct sockaddr_storage& from, socklen_t from_len,
+                                     uint64_t now_ms) {
+  if (length < 5 || GetU32(body) != node_id_) return;
+  const size_t ranges = std::min<size_t>(body[4], (length - 5) / 6);
+  nacks_received_.fetch_add(1, std::memory_order_relaxed);
+  uint32_t gap_first = 0;
+  uint32_t gap_count = 0;
+  std::lock_guard<std::mutex> lock(window_mutex_);
+  const uint32_t front = window_.empty() ? next_seq_ : window_.front().seq;
+  for (size_t r = 0; r < ranges; ++r) {
+    const uint32_t first = GetU32(body + 5 + r * 6);
+    const uint16_t count = static_cast<uint16_t>((body[5 + r * 6 + 4] << 8) | body[5 + r * 6 + 5]);
+    for (uint32_t k = 0; k < count; ++k) {
+      const uint32_t seq = first + k;
+      const uint32_t offset = seq - front;
+      // Ahead of anything sent: a confused receiver.
+      if (static_cast<int32_t>(seq - next_seq_) >= 0) break;
+      if (offset >= window_.size()) {
+        // Evicted: everything from here to the window's front is gone.
+        if (gap_count == 0) {
+          gap_first = seq;
+          gap_count = front - seq;
+        }
+        k += front - seq - 1;
+        continue;
+      }
+      WindowEntry& entry = window_[offset];
+      if (entry.group_repair_ms != 0 && now_ms - entry.group_repair_ms < options_.nack_interval_ms) {
+        continue;
+      }
+      if (++entry.nacks >= options_.repair_group_after) {
+        entry.nacks = 0;
+        entry.group_repair_ms = now_ms;
+        if (SendFrame(kRepair, seq, entry.payload.data(), entry.payload.size(), group_addr_,
+                      group_len_)) {
+          group_repairs_sent_.fetch_add(1, std::memory_order_relaxed);
+        }
+      } else if (SendFrame(kRepair, seq, entry.payload.data(), entry.payload.size(), from,
+                           from_len)) {
+        repairs_sent_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  }
+  if (gap_count > 0) {
+    uint8_t count[4];
+    PutU32(count, gap_count);
+    if (SendFrame(kGap, gap_first, count, sizeof count, from, from_len)) {
+      gaps_sent_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+void MulticastChannelWrapper::FlushDeliveries() {
+  if (deliveries_.empty()) return;
+  frames_delivered_.fetch_add(deliveries_.size(), std::memory_order_relaxed);
+  Emit([batch = std::move(deliveries_)](Napi::Env env, Napi::Object self, Napi::Function emit) {
+    Napi::Array payloads = Napi::Array::New(env, batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+      Napi::Object payload = Napi::Object::New(env);
+      payload.Set("data", Napi::Buffer<uint8_t>::Copy(env, batch[i].data.data(), batch[i].data.size()));
+      payload.Set("source", static_cast<double>(batch[i].source));
+      payload.Set("address", batch[i].address);
+      payload.Set("port", batch[i].port);
+      payload.Set("seq", static_cast<double>(batch[i].seq));
+      payloads.Set(static_cast<uint32_t>(i), payload);
+    }
+    emit.Call(self, {Napi::String::New(env, "messages"), payloads});
+  });
+  deliveries_.clear();
+}
+
+Napi::Value MulticastChannelWrapper::GetStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::Object out = Napi::Object::New(env);
+  const auto set = [&out](const char* key, const std::atomic<uint64_t>& value) {
+    out.Set(key, static_cast<double>(value.load(std::memory_order_relaxed)));
+  };
+  set("framesSent", frames_sent_);
+  set("bytesSent", bytes_sent_);
+  set("sendFailures", send_failures_);
+  set("framesReceived", frames_received_);
+  set("framesDelivered", frames_delivered_);
+  set("duplicates", duplicates_);
+  set("filtered", filtered_);
+  set("nacksSent", nacks_sent_);
+  set("nacksReceived", nacks_received_);
+  set("repairsSent", repairs_sent_);
+  set("groupRepairsSent", group_repairs_sent_);
+  set("repairsReceived", repairs_received_);
+  set("gapsSent", gaps_sent_);
+  set("framesLost", frames_lost_);
+  set("heartbeatsSent", heartbeats_sent_);
+  out.Set("sources", static_cast<double>(source_count_.load(std::memory_order_relaxed)));
+  {
+    std::lock_guard<std::mutex> lock(window_mutex_);
+    out.Set("windowFrames", static_cast<double>(window_.size()));
+    out.Set("windowBytes", static_cast<double>(window_bytes_));
+  }
+  return out;
+}
+
+void MulticastChannelWrapper::Emit(std::function<void(Napi::Env, Napi::Object, Napi::Function)> build) {
+  if (!tsfn_ready_) return;
+  tsfn_.NonBlockingCall([this, build = std::move(build)](Napi::Env env, Napi::Function) {
+    if (self_ref_.IsEmpty()) return;
+    Napi::Object self = self_ref_.Value();
+    if (self.Has("emit") && self.Get("emit").IsFunction()) {
+      build(env, self, self.Get("emit").As<Napi::Function>());
+    }
+  });
+}
+
+// WireGuard over generic netlink (src/adapters/wireguard-adapter.ts). One
+// GET_DEVICE dump carries every peer's byte counters, last handshake,
+// endpoint and allowed IPs, so a poll costs a sendto and a few recvs rather
+// than a `wg show` process. SET_DEVICE changes one peer at a time. The
+// "wireguard" family id is resolved on first use, so the module may be
+// loaded after the addon. Private and preshared keys are never read back.
+class NetlinkRequest {
+ public:
+  NetlinkRequest(uint16_t type, uint16_t flags, const void* header, size_t header_len)
+      : buf_(NLMSG_HDRLEN) {
+    auto* nlh = reinterpret_cast<struct nlmsghdr*>(buf_.data());
+    nlh->nlmsg_type = type;
+    nlh->nlmsg_flags = flags;
+    buf_.resize(NLMSG_HDRLEN + NLMSG_ALIGN(header_len), 0);
+    std::memcpy(buf_.data() + NLMSG_HDRLEN, header, header_len);
+  }
+
+  void Put(uint16_t type, const void* data, size_t len) {
+    const size_t at = buf_.size();
+    buf_.resize(at + NLA_ALIGN(NLA_HDRLEN + len), 0);
+    auto* attr = reinterpret_cast<struct nlattr*>(buf_.data() + at);
+    attr->nla_type = type;
+    attr->nla_len = static_cast<uint16_t>(NLA_HDRLEN + len);
+    if (len > 0) std::memcpy(buf_.data() + at + NLA_HDRLEN, data, len);
+  }
+  template <typename T>
+  void PutValue(uint16_t type, T value) {
+    Put(type, &value, sizeof value);
+  }
+  void PutString(uint16_t type, const std::string& value) {
+    Put(type, value.c_str(), value.size() + 1);
+  }
+  size_t BeginNest(uint16_t type) {
+    const size_t at = buf_.size();
+    Put(type | NLA_F_NESTED, nullptr, 0);
+    return at;
+  }
+  void EndNest(size_t at) {
+    reinterpret_cast<struct nlattr*>(buf_.data() + at)->nla_len =
+        static_cast<uint16_t>(buf_.size() - at);
+  }
+
+  const std::vector<uint8_t>& Finish(uint32_t seq) {
+    auto* nlh = reinterpret_cast<struct nlmsghdr*>(buf_.data());
+    nlh->nlmsg_len = static_cast<uint32_t>(buf_.size());
+    nlh->nlmsg_seq = seq;
+    return buf_;
+  }
+
+ private:
+  std::vector<uint8_t> buf_;
+};
+
+// Calls fn(type, payload, length) for each attribute in [data, data + len).
+template <typename Fn>
+void ForEachNetlinkAttr(const uint8_t* data, size_t len, Fn&& fn) {
+  while (len >= NLA_HDRLEN) {
+    struct nlattr attr;
+    std::memcpy(&attr, data, sizeof attr);
+    if (attr.nla_len < NLA_HDRLEN || attr.nla_len > len) return;
+    fn(static_cast<uint16_t>(attr.nla_type & NLA_TYPE_MASK), data + NLA_HDRLEN,
+       static_cast<size_t>(attr.nla_len - NLA_HDRLEN));
+    const size_t step = NLA_ALIGN(attr.nla_len);
+    if (step >= len) return;
+    data += step;
+    len -= step;
+  }
+}
+
+template <typename T>
+T NetlinkAttrValue(const uint8_t* data, size_t len) {
+  T value{};
+  if (len >= sizeof value) std::memcpy(&value, data, sizeof value);
+  return value;
+}
+
+class WireGuardWrapper : public Napi::ObjectWrap<WireGuardWrapper> {
+ public:
+  static Napi::Object Init(Napi::Env env, Napi::Object exports);
+  explicit WireGuardWrapper(const Napi::CallbackInfo& info);
+  ~WireGuardWrapper() override;
+
+ private:
+  using Key = std::array<uint8_t, WG_KEY_LEN>;
+
+  struct AllowedIp {
+    uint16_t family = 0;
+    uint8_t address[16] = {0};
+    uint8_t cidr = 0;
+  };
+
+  struct Peer {
+    Key public_key{};
+    struct sockaddr_storage endpoint {};
+    uint64_t last_handshake_ms = 0;
+    uint64_t rx_bytes = 0;
+    uint64_t tx_bytes = 0;
+    uint16_t keepalive_secs = 0;
+    uint32_t protocol_version = 0;
+    std::vector<AllowedIp> allowed_ips;
+  };
+
+  struct Device {
+    std::string name;
+    uint32_t ifindex = 0;
+    Key public_key{};
+    bool has_public_key = false;
+    uint16_t listen_port = 0;
+    uint32_t fwmark = 0;
+    std::vector<Peer> peers;
+  };
+
+  // Large enough that a dump part is never truncated: the kernel sizes
+  // its parts by the largest read the socket has seen.
+  static constexpr size_t kRxBytes = 64 * 1024;
+
+  Napi::Value ListDevices(const Napi::CallbackInfo& info);
+  Napi::Value GetDevice(const Napi::CallbackInfo& info);
+  Napi::Value SetPeer(const Napi::CallbackInfo& info);
+  Napi::Value Close(const Napi::CallbackInfo& info);
+
+  bool Open(int protocol, int* fd, std::string* error);
+  bool ResolveFamily(std::string* error);
+  // Sends the request and reads until NLMSG_DONE or the ack, handing each
+  // reply with this sequence number to on_message.
+  bool Transact(int fd, NetlinkRequest* request,
+                const std::function<void(const struct nlmsghdr*)>& on_message,
+                std::string* error);
+  bool ReadDevice(const std::string& name, Device* device, std::string* error);
+  static void ParsePeer(const uint8_t* data, size_t len, Peer* peer);
+
+  int genl_fd_ = -1;
+  int route_fd_ = -1;
+  uint16_t family_id_ = 0;
+  uint32_t seq_ = 0;
+  std::vector<uint8_t> rx_;
+};
+
+Napi::Object WireGuardWrapper::Init(Napi::Env env, Napi::Object exports) {
+  Napi::Function func = DefineClass(env, "QWormholeWireGuard",
+                                    {
+                                        InstanceMethod<&WireGuardWrapper::ListDevices>("listDevices"),
+                                        InstanceMethod<&WireGuardWrapper::GetDevice>("getDevice"),
+                                        InstanceMethod<&WireGuardWrapper::SetPeer>("setPeer"),
+                                        InstanceMethod<&WireGuardWrapper::Close>("close"),
+                                    });
+  exports.Set("QWormholeWireGuard", func);
+  return exports;
+}
+
+WireGuardWrapper::WireGuardWrapper(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<WireGuardWrapper>(info) {}
+
+WireGuardWrapper::~WireGuardWrapper() {
+  if (genl_fd_ >= 0) ::close(genl_fd_);
+  if (route_fd_ >= 0) ::close(route_fd_);
+}
+
+bool WireGuardWrapper::Open(int protocol, int* fd, std::string* error) {
+  if (*fd >= 0) return true;
+  const int sock = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, protocol);
+  if (sock < 0) {
+    *error = std::string("netlink socket failed: ") + std::strerror(errno);
+    return false;
+  }
+  struct sockaddr_nl local {};
+  local.nl_family = AF_NETLINK;
+  // The kernel always answers; the timeout only bounds a wedged read.
+  struct timeval timeout {};
+  timeout.tv_sec = 1;
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+  if (bind(sock, reinterpret_cast<struct sockaddr*>(&local), sizeof local) != 0) {
+    *error = std::string("netlink bind failed: ") + std::strerror(errno);
+    ::close(sock);
+    return false;
+  }
+  *fd = sock;
+  return true;
+}
+
+bool WireGuardWrapper::Transact(int fd, NetlinkRequest* request,
+                                const std::function<void(const struct nlmsghdr*)>& on_message,
+                                std::string* error) {
+  const uint32_t seq = ++seq_;
+  const std::vector<uint8_t>& bytes = request->Finish(seq);
+  struct sockaddr_nl kernel {};
+  kernel.nl_family = AF_NETLINK;
+  if (sendto(fd, bytes.data(), bytes.size(), 0, reinterpret_cast<struct sockaddr*>(&kernel),
+             sizeof kernel) < 0) {
+    *error = std::string("netlink send failed: ") + std::strerror(errno);
+    return false;
+  }
+  if (rx_.empty()) rx_.resize(kRxBytes);
+  for (;;) {
+    const ssize_t n = recv(fd, rx_.data(), rx_.size(), 0);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      *error = std::string("netlink recv failed: ") + std::strerror(errno);
+      return false;
+    }
+    int left = static_cast<int>(n);
+    for (auto* nlh = reinterpret_cast<const struct nlmsghdr*>(rx_.data()); NLMSG_OK(nlh, left);
+         nlh = NLMSG_NEXT(nlh, left)) {
+      if (nlh->nlmsg_seq != seq) continue;
+      if (nlh->nlmsg_type == NLMSG_DONE || nlh->nlmsg_type == NLMSG_ERROR) {
+        // DONE may carry a dump's error; ERROR is the ack, 0 on success.
+        int code = 0;
+        if (nlh->nlmsg_len >= NLMSG_LENGTH(sizeof(int))) {
+          std::memcpy(&code, NLMSG_DATA(nlh), sizeof code);
+        }
+        if (code == 0) return true;
+        *error = std::strerror(-code);
+        errno = -code;
+        return false;
+      }
+      on_message(nlh);
+    }
+  }
+}
+
+bool WireGuardWrapper::ResolveFamily(std::string* error) {
+  if (family_id_ != 0) return true;
+  if (!Open(NETLINK_GENERIC, &genl_fd_, error)) return false;
+  struct genlmsghdr genl {};
+  genl.cmd = CTRL_CMD_GETFAMILY;
+  genl.version = 1;
+  NetlinkRequest request(GENL_ID_CTRL, NLM_F_REQUEST | NLM_F_ACK, &genl, sizeof genl);
+  request.PutString(CTRL_ATTR_FAMILY_NAME, WG_GENL_NAME);
+  const bool ok = Transact(
+      genl_fd_, &request,
+      [this](const struct nlmsghdr* nlh) {
+        const auto* data = static_cast<const uint8_t*>(NLMSG_DATA(nlh)) + GENL_HDRLEN;
+        ForEachNetlinkAttr(data, nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN),
+                           [this](uint16_t type, const uint8_t* value, size_t len) {
+                             if (type == CTRL_ATTR_FAMILY_ID) {
+                               family_id_ = NetlinkAttrValue<uint16_t>(value, len);
+                             }
+                           });
+      },
+      error);
+  if (!ok && errno == ENOENT) {
+    *error = "no wireguard netlink family (is the wireguard module loaded?)";
+  }
+  return ok && family_id_ != 0;
+}
+
+void WireGuardWrapper::ParsePeer(const uint8_t* data, size_t len, Peer* peer) {
+  ForEachNetlinkAttr(data, len, [peer](uint16_t type, const uint8_t* value, size_t size) {
+    switch (type) {
+      case WGPEER_A_PUBLIC_KEY:
+        if (size == WG_KEY_LEN) std::memcpy(peer->public_key.data(), value, WG_KEY_LEN);
+        break;
+      case WGPEER_A_ENDPOINT:
+        if (size == sizeof(struct sockaddr_in) || size == sizeof(struct sockaddr_in6)) {
+          std::memcpy(&peer->endpoint, value, size);
+        }
+        break;
+      case WGPEER_A_LAST_HANDSHAKE_TIME: {
+        const auto stamp = NetlinkAttrValue<struct __kernel_timespec>(value, size);
+        peer->last_handshake_ms = static_cast<uint64_t>(stamp.tv_sec) * 1000 +
+                                  static_cast<uint64_t>(stamp.tv_nsec) / 1000000;
+        break;
+      }
+      case WGPEER_A_RX_BYTES:
+        peer->rx_bytes = NetlinkAttrValue<uint64_t>(value, size);
+        break;
+      case WGPEER_A_TX_BYTES:
+        peer->tx_bytes = NetlinkAttrValue<uint64_t>(value, size);
+        break;
+      case WGPEER_A_PERSISTENT_KEEPALIVE_INTERVAL:
+        peer->keepalive_secs = NetlinkAttrValue<uint16_t>(value, size);
+        break;
+      case WGPEER_A_PROTOCOL_VERSION:
+        peer->protocol_version = NetlinkAttrValue<uint32_t>(value, size);
+        break;
+      case WGPEER_A_ALLOWEDIPS:
+        ForEachNetlinkAttr(value, size, [peer](uint16_t, const uint8_t* entry, size_t entry_len) {
+          AllowedIp ip;
+          ForEachNetlinkAttr(entry, entry_len,
+                             [&ip](uint16_t field, const uint8_t* bytes, size_t bytes_len) {
+                               if (field == WGALLOWEDIP_A_FAMILY) {
+                                 ip.family = NetlinkAttrValue<uint16_t>(bytes, bytes_len);
+                               } else if (field == WGALLOWEDIP_A_IPADDR && bytes_len <= 16) {
+                                 std::memcpy(ip.address, bytes, bytes_len);
+                               } else if (field == WGALLOWEDIP_A_CIDR_MASK) {
+                                 ip.cidr = NetlinkAttrValue<uint8_t>(bytes, bytes_len);
+                               }
+                             });
+          if (ip.family == AF_INET || ip.family == AF_INET6) peer->allowed_ips.push_back(ip);
+        });
+        break;
+      default:
+        break;
+    }
+  });
+}
+
+bool WireGuardWrapper::ReadDevice(const std::string& name, Device* device, std::string* error) {
+  if (!ResolveFamily(error)) return false;
+  struct genlmsghdr genl {};
+  genl.cmd = WG_CMD_GET_DEVICE;
+  genl.version = WG_GENL_VERSION;
+  NetlinkRequest request(family_id_, NLM_F_REQUEST | NLM_F_DUMP, &genl, sizeof genl);
+  request.PutString(WGDEVICE_A_IFNAME, name);
+  return Transact(
+      genl_fd_, &request,
+      [device](const struct nlmsghdr* nlh) {
+        const auto* data = static_cast<const uint8_t*>(NLMSG_DATA(nlh)) + GENL_HDRLEN;
+        ForEachNetlinkAttr(
+            data, nlh->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN),
+            [device](uint16_t type, const uint8_t* value, size_t len) {
+              switch (type) {
+                case WGDEVICE_A_IFINDEX:
+                  device->ifindex = NetlinkAttrValue<uint32_t>(value, len);
+                  break;
+                case WGDEVICE_A_IFNAME:
+                  device->name.assign(reinterpret_cast<const char*>(value), strnlen(reinterpret_cast<const char*>(value), len));
+                  break;
+                case WGDEVICE_A_PUBLIC_KEY:
+                  if (len == WG_KEY_LEN) {
+                    std::memcpy(device->public_key.data(), value, WG_KEY_LEN);
+                    device->has_public_key = true;
+                  }
+                  break;
+                case WGDEVICE_A_LISTEN_PORT:
+                  device->listen_port = NetlinkAttrValue<uint16_t>(value, len);
+                  break;
+                case WGDEVICE_A_FWMARK:
+                  device->fwmark = NetlinkAttrValue<uint32_t>(value, len);
+                  break;
+                case WGDEVICE_A_PEERS: {
+                  // A peer whose allowed IPs spill over is continued at the
+                  // top of the next part, under the same key.
+                  bool first = true;
+                  ForEachNetlinkAttr(value, len, [device, &first](uint16_t, const uint8_t* entry,
+                                                                 size_t entry_len) {
+                    Peer peer;
+                    ParsePeer(entry, entry_len, &peer);
+                    if (first && !device->peers.empty() &&
+                        device->peers.back().public_key == peer.public_key) {
+                      Peer& last = device->peers.back();
+                      last.allowed_ips.insert(last.allowed_ips.end(), peer.allowed_ips.begin(),
+                                              peer.allowed_ips.end());
+                    } else {
+                      device->peers.push_back(std::move(peer));
+                    }
+                    first = false;
+                  });
+                  break;
+                }
+                default:
+                  break;
+              }
+            });
+      },
+      error);
+}
+
+// listDevices(): names of the WireGuard interfaces, from one RTM_GETLINK dump.
+Napi::Value WireGuardWrapper::ListDevices(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  std::string error;
+  std::vector<std::string> names;
+  struct ifinfomsg link {};
+  link.ifi_family = AF_UNSPEC;
+  NetlinkRequest request(RTM_GETLINK, NLM_F_REQUEST | NLM_F_DUMP, &link, sizeof link);
+  const bool ok =
+      Open(NETLINK_ROUTE, &route_fd_, &error) &&
+      Transact(
+          route_fd_, &request,
+          [&names](const struct nlmsghdr* nlh) {
+            if (nlh->nlmsg_type != RTM_NEWLINK) return;
+            std::string name;
+            bool wireguard = false;
+            const auto* data =
+                static_cast<const uint8_t*>(NLMSG_DATA(nlh)) + NLMSG_ALIGN(sizeof(struct ifinfomsg));
+            ForEachNetlinkAttr(
+                data, nlh->nlmsg_len - NLMSG_LENGTH(NLMSG_ALIGN(sizeof(struct ifinfomsg))),
+                [&](uint16_t type, const uint8_t* value, size_t len) {
+                  if (type == IFLA_IFNAME) {
+                    name.assign(reinterpret_cast<const char*>(value),
+                                strnlen(reinterpret_cast<const char*>(value), len));
+                  } else if (type == IFLA_LINKINFO) {
+                    ForEachNetlinkAttr(value, len, [&](uint16_t field, const uint8_t* kind, size_t kind_len) {
+                      wireguard = wireguard ||
+                                  (field == IFLA_INFO_KIND &&
+                                   std::string(reinterpret_cast<const char*>(kind),
+                                               strnlen(reinterpret_cast<const char*>(kind), kind_len)) ==
+                                       "wireguard");
+                    });
+                  }
+                });
+            if (wireguard && !name.empty()) names.push_back(std::move(name));
+          },
+          &error);
+  if (!ok) {
+    Napi::Error::New(env, "WireGuard listDevices failed: " + error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Array out = Napi::Array::New(env, names.size());
+  for (size_t i = 0; i < names.size(); ++i) out.Set(static_cast<uint32_t>(i), names[i]);
+  return out;
+}
+
+// getDevice(name): the device and every peer, keys as 32-byte Buffers.
+Napi::Value WireGuardWrapper::GetDevice(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "getDevice(name: string) required").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  const std::string name = info[0].As<Napi::String>().Utf8Value();
+  Device device;
+  std::string error;
+  if (!ReadDevice(name, &device, &error)) {
+    Napi::Error::New(env, "WireGuard getDevice(" + name + ") failed: " + error)
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("name", device.name.empty() ? name : device.name);
+  out.Set("ifindex", static_cast<double>(device.ifindex));
+  if (device.has_public_key) {
+    out.Set("publicKey", Napi::Buffer<uint8_t>::Copy(env, device.public_key.data(), WG_KEY_LEN));
+  }
+  out.Set("listenPort", device.listen_port);
+  out.Set("fwmark", static_cast<double>(device.fwmark));
+  Napi::Array peers = Napi::Array::New(env, device.peers.size());
+  for (size_t i = 0; i < device.peers.size(); ++i) {
+    const Peer& peer = device.peers[i];
+    Napi::Object entry = Napi::Object::New(env);
+    entry.Set("publicKey", Napi::Buffer<uint8_t>::Copy(env, peer.public_key.data(), WG_KEY_LEN));
+    if (peer.endpoint.ss_family == AF_INET || peer.endpoint.ss_family == AF_INET6) {
+      std::string host;
+      uint16_t port = 0;
+      FormatPeer(peer.endpoint, &host, &port);
+      Napi::Object endpoint = Napi::Object::New(env);
+      endpoint.Set("address", host);
+      endpoint.Set("port", port);
+      endpoint.Set("family", peer.endpoint.ss_family == AF_INET6 ? "IPv6" : "IPv4");
+      entry.Set("endpoint", endpoint);
+    }
+    entry.Set("lastHandshakeMs", static_cast<double>(peer.last_handshake_ms));
+    entry.Set("rxBytes", static_cast<double>(peer.rx_bytes));
+    entry.Set("txBytes", static_cast<double>(peer.tx_bytes));
+    entry.Set("persistentKeepaliveSecs", peer.keepalive_secs);
+    entry.Set("protocolVersion", static_cast<double>(peer.protocol_version));
+    Napi::Array allowed = Napi::Array::New(env, peer.allowed_ips.size());
+    for (size_t j = 0; j < peer.allowed_ips.size(); ++j) {
+      const AllowedIp& ip = peer.allowed_ips[j];
+      char text[INET6_ADDRSTRLEN] = {0};
+      inet_ntop(ip.family, ip.address, text, sizeof text);
+      allowed.Set(static_cast<uint32_t>(j), std::string(text) + "/" + std::to_string(ip.cidr));
+    }
+    entry.Set("allowedIps", allowed);
+    peers.Set(static_cast<uint32_t>(i), entry);
+  }
+  out.Set("peers", peers);
+  return out;
+}
+
+// setPeer(name, { publicKey, endpoint?, persistentKeepaliveSecs?,
+// allowedIps?, replaceAllowedIps?, remove?, updateOnly? }). Needs
+// CAP_NET_ADMIN; endpoints and allowed IPs must be numeric.
+Napi::Value WireGuardWrapper::SetPeer(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsObject()) {
+    Napi::TypeError::New(env, "setPeer(name: string, peer: object) required")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  const std::string name = info[0].As<Napi::String>().Utf8Value();
+  Napi::Object config = info[1].As<Napi::Object>();
+  Napi::Value key = config.Get("publicKey");
+  if (!key.IsBuffer() || key.As<Napi::Buffer<uint8_t>>().Length() != WG_KEY_LEN) {
+    Napi::TypeError::New(env, "setPeer: publicKey must be a 32-byte Buffer")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  std::string error;
+  if (!ResolveFamily(&error)) {
+    Napi::Error::New(env, "WireGuard setPeer failed: " + error).ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  auto flag = [&config](const char* field) {
+    return config.Get(field).IsBoolean() && config.Get(field).As<Napi::Boolean>().Value();
+  };
+
+  struct genlmsghdr genl {};
+  genl.cmd = WG_CMD_SET_DEVICE;
+  genl.version = WG_GENL_VERSION;
+  NetlinkRequest request(family_id_, NLM_F_REQUEST | NLM_F_ACK, &genl, sizeof genl);
+  request.PutString(WGDEVICE_A_IFNAME, name);
+  const size_t peers = request.BeginNest(WGDEVICE_A_PEERS);
+  const size_t peer = request.BeginNest(0);
+  request.Put(WGPEER_A_PUBLIC_KEY, key.As<Napi::Buffer<uint8_t>>().Data(), WG_KEY_LEN);
+  uint32_t flags = 0;
+  if (flag("remove")) flags |= WGPEER_F_REMOVE_ME;
+  if (flag("replaceAllowedIps")) flags |= WGPEER_F_REPLACE_ALLOWEDIPS;
+  if (flag("updateOnly")) flags |= WGPEER_F_UPDATE_ONLY;
+  request.PutValue<uint32_t>(WGPEER_A_FLAGS, flags);
+
+  Napi::Value endpoint = config.Get("endpoint");
+  if (endpoint.IsObject()) {
+    Napi::Object where = endpoint.As<Napi::Object>();
+    const std::string address =
+        where.Get("address").IsString() ? where.Get("address").As<Napi::String>().Utf8Value() : "";
+    const auto port = static_cast<uint16_t>(
+        where.Get("port").IsNumber() ? where.Get("port").As<Napi::Number>().Uint32Value() : 0);
+    struct sockaddr_in in4 {};
+    struct sockaddr_in6 in6 {};
+    if (inet_pton(AF_INET, address.c_str(), &in4.sin_addr) == 1) {
+      in4.sin_family = AF_INET;
+      in4.sin_port = htons(port);
+      request.Put(WGPEER_A_ENDPOINT, &in4, sizeof in4);
+    } else if (inet_pton(AF_INET6, address.c_str(), &in6.sin6_addr) == 1) {
+      in6.sin6_family = AF_INET6;
+      in6.sin6_port = htons(port);
+      request.Put(WGPEER_A_ENDPOINT, &in6, sizeof in6);
+    } else {
+      Napi::TypeError::New(env, "setPeer: endpoint.address must be an IP address")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
+  if (config.Get("persistentKeepaliveSecs").IsNumber()) {
+    request.PutValue<uint16_t>(
+        WGPEER_A_PERSISTENT_KEEPALIVE_INTERVAL,
+        static_cast<uint16_t>(config.Get("persistentKeepaliveSecs").As<Napi::Number>().Uint32Value()));
+  }
+  if (config.Get("allowedIps").IsArray()) {
+    Napi::Array list = config.Get("allowedIps").As<Napi::Array>();
+    const size_t allowed = request.BeginNest(WGPEER_A_ALLOWEDIPS);
+    for (uint32_t i = 0; i < list.Length(); ++i) {
+      const std::string cidr =
+          list.Get(i).IsString() ? list.Get(i).As<Napi::String>().Utf8Value() : "";
+      const size_t slash = cidr.find('/');
+      const std::string address = cidr.substr(0, slash);
+      uint8_t bytes[16] = {0};
+      const uint16_t family = inet_pton(AF_INET, address.c_str(), bytes) == 1    ? AF_INET
+                              : inet_pton(AF_INET6, address.c_str(), bytes) == 1 ? AF_INET6
+                                                                                 : 0;
+      const int max_mask = family == AF_INET ? 32 : 128;
+      int mask = max_mask;
+      if (slash != std::string::npos) {
+        const char* first = cidr.c_str() + slash + 1;
+        const char* last = cidr.c_str() + cidr.size();
+        const auto parsed = std::from_chars(first, last, mask);
+        if (parsed.ec != std::errc() || parsed.ptr != last) mask = -1;
+      }
+      if (family == 0 || mask < 0 || mask > max_mask) {
+        Napi::TypeError::New(env, "setPeer: allowedIps entry \"" + cidr + "\" is not an IP/CIDR")
+            .ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      const size_t entry = request.BeginNest(0);
+      request.PutValue<uint16_t>(WGALLOWEDIP_A_FAMILY, family);
+      request.Put(WGALLOWEDIP_A_IPADDR, bytes, family == AF_INET ? 4 : 16);
+      request.PutValue<uint8_t>(WGALLOWEDIP_A_CIDR_MASK, static_cast<uint8_t>(mask));
+      request.EndNest(entry);
+    }
+    request.EndNest(allowed);
+  }
+  request.EndNest(peer);
+  request.EndNest(peers);
+
+  if (!Transact(genl_fd_, &request, [](const struct nlmsghdr*) {}, &error)) {
+    Napi::Error::New(env, "WireGuard setPeer(" + name + ") failed: " + error)
+        .ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+
+Napi::Value WireGuardWrapper::Close(const Napi::CallbackInfo& info) {
+  if (genl_fd_ >= 0) ::close(genl_fd_);
+  if (route_fd_ >= 0) ::close(route_fd_);
+  genl_fd_ = -1;
+  route_fd_ = -1;
+  family_id_ = 0;
+  return info.Env().Undefined();
+}
+
+Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+  TcpClientWrapper::Init(env, exports);
+  UdpSocketWrapper::Init(env, exports);
+  UnixDgramSocketWrapper::Init(env, exports);
+  KcpEngineWrapper::Init(env, exports);
+  DiscoveryWrapper::Init(env, exports);
+  MulticastChannelWrapper::Init(env, exports);
+  WireGuardWrapper::Init(env, exports);
+  return SocketServerWrapper::Init(env, exports);
+}
+}  // namespace
+
+// c/qwormhole_native.cpp links this file with the lws backend into one addon.
+#if defined(QWORMHOLE_COMBINED_ADDON)
+Napi::Object QWormholeInitLibsocketBackend(Napi::Env env, Napi::Object exports) {
+  return InitAll(env, exports);
+}
+#else
 NODE_API_MODULE(qwormhole, InitAll)
+#endif
@@ -0,0 +1,166 @@
+// Generated by scripts/generate-handshake-schema.ts from src/schema/scp.ts.
+// Do not edit; run `pnpm run native:handshake-schema` instead.
+//
+// Node 0 accepts any value and node 1 none. A node with types 0 accepts
+// every type; each present property, additional member, array item and
+// anyOf alternative is another node.
+
+#pragma once
+
+constexpr HandshakeSchemaNode kHandshakeSchemaNodes[] = {
+    {0x0, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {kSchemaNoType, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 7, 11, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 0, 1, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 7, 0, 0, 0},
+    {0x0, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 5},
+    {0x2, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x10, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 7, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 7, 0, 0, 0},
+    {0x0, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 5, 2},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 3, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, 0.0, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x10, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 19, 0, 0},
+    {0x4, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x4, kSchemaInteger, 0.0, 9007199254740991.0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 23, 0, 0, 0},
+    {0x0, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 7, 2},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 3, 4, 0, 0, 0, 0},
+    {0x4, 0, 0.0, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 1, 4, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 5, 4, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, 0.0, 1.0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 25, 14, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 9, 1, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 38, 0, 0, 0},
+    {0x0, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 9, 5},
+    {0x2, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x10, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 38, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 38, 0, 0, 0},
+    {0x0, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 14, 2},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 18, 3, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, 0.0, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x10, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 50, 0, 0},
+    {0x4, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x4, kSchemaInteger, 0.0, 9007199254740991.0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 54, 0, 0, 0},
+    {0x0, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 16, 2},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 21, 4, 0, 0, 0, 0},
+    {0x4, 0, 0.0, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 10, 4, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 14, 4, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, 0.0, 1.0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 1, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x20, 0, -kSchemaInf, kSchemaInf, 0, 0, 0, 39, 4, 0, 0, 0, 0},
+    {0x4, 0, 0.0, kSchemaInf, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 18, 4, 0, 0, 0, 0, 0, 0},
+    {0x8, 0, -kSchemaInf, kSchemaInf, 0, 22, 4, 0, 0, 0, 0, 0, 0},
+    {0x4, 0, 0.0, 1.0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+};
+
+constexpr HandshakeSchemaProperty kHandshakeSchemaProperties[] = {
+    {"hash", 16, false},
+    {"entropy", 17, false},
+    {"vector", 18, false},
+    {"entropy", 29, false},
+    {"entropyVelocity", 30, false},
+    {"coherence", 31, false},
+    {"negIndex", 32, false},
+    {"type", 3, true},
+    {"version", 4, false},
+    {"sid", 5, false},
+    {"caps", 6, false},
+    {"nv", 13, false},
+    {"ts", 20, false},
+    {"sig", 21, false},
+    {"tags", 22, false},
+    {"nIndex", 26, false},
+    {"negHash", 27, false},
+    {"entropyMetrics", 28, false},
+    {"hash", 47, false},
+    {"entropy", 48, false},
+    {"vector", 49, false},
+    {"entropy", 60, false},
+    {"entropyVelocity", 61, false},
+    {"coherence", 62, false},
+    {"negIndex", 63, false},
+    {"type", 34, true},
+    {"version", 35, false},
+    {"sid", 36, false},
+    {"caps", 37, false},
+    {"nv", 44, false},
+    {"ts", 51, true},
+    {"sig", 52, false},
+    {"tags", 53, false},
+    {"nIndex", 57, true},
+    {"negHash", 58, true},
+    {"entropyMetrics", 59, false},
+    {"nonce", 64, true},
+    {"publicKey", 65, true},
+    {"signature", 66, true},
+    {"entropy", 68, false},
+    {"entropyVelocity", 69, false},
+    {"coherence", 70, false},
+    {"negIndex", 71, false},
+};
+
+constexpr std::string_view kHandshakeSchemaEnums[] = {
+    "handshake",
+    "low",
+    "stable",
+    "rising",
+    "spiking",
+    "high",
+    "medium",
+    "low",
+    "chaos",
+    "handshake",
+    "low",
+    "stable",
+    "rising",
+    "spiking",
+    "high",
+    "medium",
+    "low",
+    "chaos",
+    "low",
+    "stable",
+    "rising",
+    "spiking",
+    "high",
+    "medium",
+    "low",
+    "chaos",
+};
+
+constexpr uint16_t kHandshakeSchemaAnyOf[] = {
+    8, 9, 10, 11, 12, 14, 15, 24, 25, 39, 40, 41, 42, 43, 45, 46, 55, 56,
+};
+
+constexpr uint16_t kHandshakeSchemaHandshake = 2;
+constexpr uint16_t kHandshakeSchemaNegentropic = 33;
+constexpr uint16_t kHandshakeSchemaEntropyMetrics = 67;
@@ -0,0 +1,29 @@
+// Both socket backends in one addon. qwormhole_lws.cpp and qwormhole.cpp are
+// compiled into it with QWORMHOLE_COMBINED_ADDON, which swaps their
+// NODE_API_MODULE for the entry points below; each keeps its own anonymous
+// namespace, and its exports land under its backend name so the JS loaders
+// pick one at runtime from a single dlopen.
+#include <napi.h>
+
+Napi::Object QWormholeInitLwsBackend(Napi::Env env, Napi::Object exports);
+#if !defined(_WIN32)
+Napi::Object QWormholeInitLibsocketBackend(Napi::Env env, Napi::Object exports);
+#endif
+
+namespace {
+
+Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+  Napi::Array backends = Napi::Array::New(env);
+  exports.Set("lws", QWormholeInitLwsBackend(env, Napi::Object::New(env)));
+  backends.Set(backends.Length(), Napi::String::New(env, "lws"));
+#if !defined(_WIN32)
+  exports.Set("libsocket", QWormholeInitLibsocketBackend(env, Napi::Object::New(env)));
+  backends.Set(backends.Length(), Napi::String::New(env, "libsocket"));
+#endif
+  exports.Set("backends", backends);
+  return exports;
+}
+
+}  // namespace
+
+NODE_API_MODULE(qwormhole_native, InitAll)
@@ -0,0 +1,148 @@
+// The clients' DNS layer, shared by both native addons. Included inside each
+// addon's anonymous namespace after its system headers.
+
+#pragma once
+
+// Hosts ResolverCache keeps before it starts over.
+constexpr size_t kResolverCacheMax = 1024;
+
+struct ResolvedAddress {
+  struct sockaddr_storage addr;
+  socklen_t len = 0;
+};
+
+// Process-wide host -> addresses cache for the clients, so a reconnect storm
+// pays for one lookup rather than one per connect. Concurrent lookups of the
+// same host wait for the first instead of each calling getaddrinfo().
+// Addresses come back in RFC 8305 section 4 order: getaddrinfo()'s RFC 6724
+// preference within each family, alternating families from the first.
+class ResolverCache {
+ public:
+  struct Result {
+    std::vector<ResolvedAddress> addresses;
+    bool cached = false;
+    int error = 0;
+  };
+
+  static ResolverCache& Instance() {
+    static ResolverCache* cache = new ResolverCache();
+    return *cache;
+  }
+
+  // Blocks on a miss. ttl_ms 0 skips the cache but still joins a lookup
+  // already in flight. Ports are left 0.
+  Result Resolve(const std::string& host, uint32_t ttl_ms) {
+    Result numeric;
+    numeric.addresses = Run(host, AI_NUMERICHOST, &numeric.error);
+    if (!numeric.addresses.empty()) {
+      return numeric;
+    }
+    std::shared_ptr<Lookup> lookup;
+    bool owner = false;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = entries_.find(host);
+      if (ttl_ms > 0 && it != entries_.end() &&
+          it->second.expires > std::chrono::steady_clock::now()) {
+        return Result{it->second.addresses, true, 0};
+      }
+      auto& slot = inflight_[host];
+      if (!slot) {
+        slot = std::make_shared<Lookup>();
+        owner = true;
+      }
+      lookup = slot;
+    }
+    if (!owner) {
+      std::unique_lock<std::mutex> lock(lookup->mutex);
+      lookup->done_cv.wait(lock, [&]() { return lookup->done; });
+      Result result = lookup->result;
+      result.cached = true;
+      return result;
+    }
+
+    Result result;
+    result.addresses = Run(host, AI_ADDRCONFIG, &result.error);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      inflight_.erase(host);
+      if (ttl_ms > 0 && !result.addresses.empty()) {
+        if (entries_.size() >= kResolverCacheMax) entries_.clear();
+        entries_[host] = Entry{result.addresses, std::chrono::steady_clock::now() +
+                                                     std::chrono::milliseconds(ttl_ms)};
+      }
+    }
+    {
+      std::lock_guard<std::mutex> lock(lookup->mutex);
+      lookup->result = result;
+      lookup->done = true;
+    }
+    lookup->done_cv.notify_all();
+    return result;
+  }
+
+ private:
+  struct Entry {
+    std::vector<ResolvedAddress> addresses;
+    std::chrono::steady_clock::time_point expires;
+  };
+
+  struct Lookup {
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    bool done = false;
+    Result result;
+  };
+
+  static std::vector<ResolvedAddress> Run(const std::string& host, int flags, int* error) {
+    struct addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = flags;
+    struct addrinfo* list = nullptr;
+    *error = ::getaddrinfo(host.c_str(), nullptr, &hints, &list);
+    std::vector<ResolvedAddress> v4;
+    std::vector<ResolvedAddress> v6;
+    int first_family = AF_UNSPEC;
+    for (struct addrinfo* ai = *error == 0 ? list : nullptr; ai != nullptr; ai = ai->ai_next) {
+      if ((ai->ai_family != AF_INET && ai->ai_family != AF_INET6) ||
+          ai->ai_addrlen > sizeof(struct sockaddr_storage)) {
+        continue;
+      }
+      auto& family = ai->ai_family == AF_INET ? v4 : v6;
+      const bool seen = std::any_of(family.begin(), family.end(), [ai](const ResolvedAddress& a) {
+        return a.len == ai->ai_addrlen && std::memcmp(&a.addr, ai->ai_addr, a.len) == 0;
+      });
+      if (seen) continue;
+      ResolvedAddress address;
+      std::memcpy(&address.addr, ai->ai_addr, ai->ai_addrlen);
+      address.len = static_cast<socklen_t>(ai->ai_addrlen);
+      family.push_back(address);
+      if (first_family == AF_UNSPEC) first_family = ai->ai_family;
+    }
+    if (list != nullptr) ::freeaddrinfo(list);
+    const auto& first = first_family == AF_INET ? v4 : v6;
+    const auto& second = first_family == AF_INET ? v6 : v4;
+    std::vector<ResolvedAddress> ordered;
+    for (size_t i = 0; i < first.size() || i < second.size(); ++i) {
+      if (i < first.size()) ordered.push_back(first[i]);
+      if (i < second.size()) ordered.push_back(second[i]);
+    }
+    if (ordered.empty() && *error == 0) *error = EAI_NONAME;
+    return ordered;
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> entries_;
+  std::unordered_map<std::string, std::shared_ptr<Lookup>> inflight_;
+};
+
+// Numeric text for a resolved address; an IPv6 scope id stays on as %name,
+// so a link-local address can be handed on to a connect as a string.
+std::string FormatAddress(const ResolvedAddress& address) {
+  char text[NI_MAXHOST] = {0};
+  return ::getnameinfo(reinterpret_cast<const struct sockaddr*>(&address.addr), address.len, text,
+                       sizeof text, nullptr, 0, NI_NUMERICHOST) == 0
+             ? text
+             : "";
+}
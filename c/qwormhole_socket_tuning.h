@@ -0,0 +1,312 @@
+// socketOptions, shared by both native addons: the options, what the kernel
+// reports once they are applied, and the setsockopt() calls in between.
+// Included inside each addon's anonymous namespace after its system headers
+// and napi.h.
+//
+// Applied to client sockets before or while they connect and to server
+// sockets as they are accepted or adopted. Unset fields keep the kernel
+// default. quickAck is re-armed after every read, since the kernel drops
+// back to delayed ACKs on its own.
+
+#pragma once
+
+struct SocketTuning {
+  std::optional<bool> no_delay;
+  std::optional<int> send_buffer;
+  std::optional<int> receive_buffer;
+  std::optional<int> busy_poll_us;
+  std::optional<int> not_sent_lowat;
+  std::optional<int> priority;
+  std::optional<int> dscp;
+  // SO_MAX_PACING_RATE, bytes per second.
+  std::optional<uint64_t> pacing_rate;
+  bool quick_ack = false;
+  // TCP_FASTOPEN_CONNECT: only means anything on a client socket before
+  // connect(). The libsocket client sets it on each Happy Eyeballs attempt,
+  // the lws client from LWS_CALLBACK_CONNECTING.
+  bool fast_open = false;
+
+  bool any() const {
+    return no_delay || send_buffer || receive_buffer || busy_poll_us || not_sent_lowat ||
+           priority || dscp || pacing_rate || quick_ack || fast_open;
+  }
+};
+
+// What the kernel reports once a SocketTuning is applied (buffer sizes come
+// back doubled on Linux), and the options it refused.
+struct SocketTuningReport {
+  bool no_delay = false;
+  int send_buffer = 0;
+  int receive_buffer = 0;
+  int busy_poll_us = 0;
+  int not_sent_lowat = 0;
+  int priority = 0;
+  int dscp = 0;
+  // 0: unlimited. pacing_qdisc is the egress root qdisc, read when a rate
+  // is set: fq enforces the rate per flow, anything else leaves it to TCP's
+  // own pacing.
+  uint64_t pacing_rate = 0;
+  std::string pacing_qdisc;
+  bool quick_ack = false;
+  bool fast_open = false;
+  std::vector<std::string> rejected;
+};
+
+bool SetSocketInt(int fd, int level, int name, int value) {
+  return setsockopt(fd, level, name, reinterpret_cast<const char*>(&value), sizeof(value)) == 0;
+}
+
+int GetSocketInt(int fd, int level, int name) {
+  int value = 0;
+  socklen_t len = sizeof(value);
+  return getsockopt(fd, level, name, reinterpret_cast<char*>(&value), &len) == 0 ? value : 0;
+}
+
+#if defined(__linux__)
+// SO_MAX_PACING_RATE takes 32 bits, or 64 from Linux 4.20; a rate that
+// fits goes as 32 so older kernels read it right.
+bool SetPacingRate(int fd, uint64_t rate) {
+  if (rate < UINT32_MAX) {
+    const uint32_t narrow = static_cast<uint32_t>(rate);
+    return setsockopt(fd, SOL_SOCKET, SO_MAX_PACING_RATE, &narrow, sizeof(narrow)) == 0;
+  }
+  return setsockopt(fd, SOL_SOCKET, SO_MAX_PACING_RATE, &rate, sizeof(rate)) == 0;
+}
+
+// The socket's pacing cap; 0 when unlimited or unreadable.
+uint64_t GetPacingRate(int fd) {
+  uint8_t raw[sizeof(uint64_t)] = {};
+  socklen_t len = sizeof(raw);
+  if (getsockopt(fd, SOL_SOCKET, SO_MAX_PACING_RATE, raw, &len) != 0) return 0;
+  uint64_t rate = 0;
+  if (len == sizeof(uint32_t)) {
+    uint32_t narrow = 0;
+    std::memcpy(&narrow, raw, sizeof(narrow));
+    rate = narrow == UINT32_MAX ? ~0ull : narrow;
+  } else {
+    std::memcpy(&rate, raw, sizeof(rate));
+  }
+  return rate == ~0ull ? 0 : rate;
+}
+
+// The root qdisc of the interface that owns fd's local address, from one
+// RTM_GETQDISC dump. A multiqueue root is followed by its per-queue
+// children's kind, "mq:fq" say. Empty when the lookup fails. Cached per
+// interface for a few seconds, since a server asks on every adopt and a
+// paced client on every connect.
+std::string EgressQdisc(int fd) {
+  struct sockaddr_storage local {};
+  socklen_t local_len = sizeof(local);
+  if (getsockname(fd, reinterpret_cast<struct sockaddr*>(&local), &local_len) != 0) return {};
+  std::string name;
+  struct ifaddrs* addresses = nullptr;
+  if (getifaddrs(&addresses) != 0) return {};
+  for (const struct ifaddrs* it = addresses; it != nullptr && name.empty(); it = it->ifa_next) {
+    if (it->ifa_addr == nullptr || it->ifa_addr->sa_family != local.ss_family) continue;
+    bool match = false;
+    if (local.ss_family == AF_INET) {
+      match = reinterpret_cast<const struct sockaddr_in*>(it->ifa_addr)->sin_addr.s_addr ==
+              reinterpret_cast<const struct sockaddr_in*>(&local)->sin_addr.s_addr;
+    } else if (local.ss_family == AF_INET6) {
+      match = std::memcmp(&reinterpret_cast<const struct sockaddr_in6*>(it->ifa_addr)->sin6_addr,
+                          &reinterpret_cast<const struct sockaddr_in6*>(&local)->sin6_addr,
+                          sizeof(struct in6_addr)) == 0;
+    }
+    if (match) name = it->ifa_name;
+  }
+  freeifaddrs(addresses);
+  const unsigned ifindex = name.empty() ? 0 : if_nametoindex(name.c_str());
+  if (ifindex == 0) return {};
+
+  static std::mutex cache_mutex;
+  static std::unordered_map<unsigned, std::pair<std::chrono::steady_clock::time_point, std::string>>
+      cache;
+  const auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(ifindex);
+    if (it != cache.end() && now < it->second.first) return it->second.second;
+  }
+
+  const int nl = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if (nl < 0) return {};
+  struct timeval timeout {0, 200 * 1000};
+  setsockopt(nl, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  struct {
+    struct nlmsghdr header;
+    struct tcmsg tc;
+  } request {};
+  request.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct tcmsg));
+  request.header.nlmsg_type = RTM_GETQDISC;
+  request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  request.header.nlmsg_seq = 1;
+  request.tc.tcm_family = AF_UNSPEC;
+  request.tc.tcm_ifindex = static_cast<int>(ifindex);
+  std::string root;
+  uint32_t root_handle = 0;
+  std::vector<std::pair<uint32_t, std::string>> children;
+  if (send(nl, &request, request.header.nlmsg_len, 0) >= 0) {
+    std::vector<uint8_t> buffer(32 * 1024);
+    bool done = false;
+    while (!done) {
+      const ssize_t got = recv(nl, buffer.data(), buffer.size(), 0);
+      if (got <= 0) break;
+      size_t left = static_cast<size_t>(got);
+      for (auto* header = reinterpret_cast<struct nlmsghdr*>(buffer.data());
+           NLMSG_OK(header, left); header = NLMSG_NEXT(header, left)) {
+        if (header->nlmsg_type == NLMSG_DONE || header->nlmsg_type == NLMSG_ERROR) {
+          done = true;
+          break;
+        }
+        if (header->nlmsg_type != RTM_NEWQDISC) continue;
+        const auto* tc = static_cast<const struct tcmsg*>(NLMSG_DATA(header));
+        if (tc->tcm_ifindex != static_cast<int>(ifindex)) continue;
+        std::string kind;
+        int attr_len = static_cast<int>(header->nlmsg_len - NLMSG_LENGTH(sizeof(struct tcmsg)));
+        for (auto* attr = reinterpret_cast<const struct rtattr*>(
+                 reinterpret_cast<const uint8_t*>(tc) + NLMSG_ALIGN(sizeof(struct tcmsg)));
+             RTA_OK(attr, attr_len); attr = RTA_NEXT(attr, attr_len)) {
+          if (attr->rta_type == TCA_KIND) {
+            const auto* value = static_cast<const char*>(RTA_DATA(attr));
+            kind.assign(value, strnlen(value, RTA_PAYLOAD(attr)));
+          }
+        }
+        if (tc->tcm_parent == TC_H_ROOT) {
+          root = std::move(kind);
+          root_handle = tc->tcm_handle;
+        } else {
+          children.emplace_back(tc->tcm_parent, std::move(kind));
+        }
+      }
+    }
+  }
+  close(nl);
+  if ((root == "mq" || root == "mqprio") && root_handle != 0) {
+    for (const auto& [parent, kind] : children) {
+      if (TC_H_MAJ(parent) == TC_H_MAJ(root_handle)) {
+        root += ":" + kind;
+        break;
+      }
+    }
+  }
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  cache[ifindex] = {now + std::chrono::seconds(5), root};
+  return root;
+}
+#endif
+
+// Reads options.socketOptions.
+SocketTuning ParseSocketTuning(const Napi::Object& options) {
+  SocketTuning tuning;
+  if (!options.Has("socketOptions") || !options.Get("socketOptions").IsObject()) {
+    return tuning;
+  }
+  Napi::Object obj = options.Get("socketOptions").As<Napi::Object>();
+  const auto read_int = [&obj](const char* key, std::optional<int>* out, int64_t max) {
+    if (obj.Has(key) && obj.Get(key).IsNumber()) {
+      *out = static_cast<int>(
+          std::clamp<int64_t>(obj.Get(key).As<Napi::Number>().Int64Value(), 0, max));
+    }
+  };
+  if (obj.Has("noDelay") && obj.Get("noDelay").IsBoolean()) {
+    tuning.no_delay = obj.Get("noDelay").As<Napi::Boolean>().Value();
+  }
+  read_int("sendBufferBytes", &tuning.send_buffer, INT32_MAX / 2);
+  read_int("receiveBufferBytes", &tuning.receive_buffer, INT32_MAX / 2);
+  read_int("busyPollUs", &tuning.busy_poll_us, INT32_MAX);
+  read_int("notSentLowatBytes", &tuning.not_sent_lowat, INT32_MAX);
+  read_int("priority", &tuning.priority, 6);
+  read_int("dscp", &tuning.dscp, 63);
+  if (obj.Has("quickAck") && obj.Get("quickAck").IsBoolean()) {
+    tuning.quick_ack = obj.Get("quickAck").As<Napi::Boolean>().Value();
+  }
+  if (obj.Has("fastOpen") && obj.Get("fastOpen").IsBoolean()) {
+    tuning.fast_open = obj.Get("fastOpen").As<Napi::Boolean>().Value();
+  }
+  if (obj.Has("pacingRateBytesPerSec") && obj.Get("pacingRateBytesPerSec").IsNumber()) {
+    const double rate = obj.Get("pacingRateBytesPerSec").As<Napi::Number>().DoubleValue();
+    if (std::isfinite(rate) && rate >= 1) {
+      tuning.pacing_rate = static_cast<uint64_t>(std::min(rate, 1e15));
+    }
+  }
+  return tuning;
+}
+
+SocketTuningReport ApplySocketTuning(int fd, const SocketTuning& tuning) {
+  SocketTuningReport report;
+  const auto apply = [&](const std::optional<int>& value, int level, int name, const char* key) {
+    if (value && !SetSocketInt(fd, level, name, *value)) report.rejected.emplace_back(key);
+  };
+  if (tuning.no_delay) {
+    apply(std::optional<int>(*tuning.no_delay ? 1 : 0), IPPROTO_TCP, TCP_NODELAY, "noDelay");
+  }
+  apply(tuning.send_buffer, SOL_SOCKET, SO_SNDBUF, "sendBufferBytes");
+  apply(tuning.receive_buffer, SOL_SOCKET, SO_RCVBUF, "receiveBufferBytes");
+  struct sockaddr_storage local {};
+  socklen_t local_len = sizeof(local);
+  const bool ipv6 = getsockname(fd, reinterpret_cast<struct sockaddr*>(&local), &local_len) == 0 &&
+                    local.ss_family == AF_INET6;
+  const int tos_level = ipv6 ? IPPROTO_IPV6 : IPPROTO_IP;
+  const int tos_name = ipv6 ? IPV6_TCLASS : IP_TOS;
+  if (tuning.dscp) {
+    apply(std::optional<int>(*tuning.dscp << 2), tos_level, tos_name, "dscp");
+  }
+#if defined(__linux__)
+  apply(tuning.busy_poll_us, SOL_SOCKET, SO_BUSY_POLL, "busyPollUs");
+  apply(tuning.not_sent_lowat, IPPROTO_TCP, TCP_NOTSENT_LOWAT, "notSentLowatBytes");
+  apply(tuning.priority, SOL_SOCKET, SO_PRIORITY, "priority");
+  if (tuning.quick_ack) {
+    apply(std::optional<int>(1), IPPROTO_TCP, TCP_QUICKACK, "quickAck");
+  }
+  report.busy_poll_us = GetSocketInt(fd, SOL_SOCKET, SO_BUSY_POLL);
+  report.not_sent_lowat = GetSocketInt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT);
+  report.priority = GetSocketInt(fd, SOL_SOCKET, SO_PRIORITY);
+  report.quick_ack = tuning.quick_ack;
+  // Already set when the caller armed it before connect(); setting it on a
+  // connected socket fails, which is the rejection to report.
+  if (tuning.fast_open && GetSocketInt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT) == 0) {
+    apply(std::optional<int>(1), IPPROTO_TCP, TCP_FASTOPEN_CONNECT, "fastOpen");
+  }
+  report.fast_open = GetSocketInt(fd, IPPROTO_TCP, TCP_FASTOPEN_CONNECT) != 0;
+  if (tuning.pacing_rate) {
+    if (!SetPacingRate(fd, *tuning.pacing_rate)) {
+      report.rejected.emplace_back("pacingRateBytesPerSec");
+    }
+    report.pacing_qdisc = EgressQdisc(fd);
+  }
+  report.pacing_rate = GetPacingRate(fd);
+#else
+  if (tuning.pacing_rate) report.rejected.emplace_back("pacingRateBytesPerSec");
+  if (tuning.busy_poll_us) report.rejected.emplace_back("busyPollUs");
+  if (tuning.not_sent_lowat) report.rejected.emplace_back("notSentLowatBytes");
+  if (tuning.priority) report.rejected.emplace_back("priority");
+  if (tuning.quick_ack) report.rejected.emplace_back("quickAck");
+  if (tuning.fast_open) report.rejected.emplace_back("fastOpen");
+#endif
+  report.no_delay = GetSocketInt(fd, IPPROTO_TCP, TCP_NODELAY) != 0;
+  report.send_buffer = GetSocketInt(fd, SOL_SOCKET, SO_SNDBUF);
+  report.receive_buffer = GetSocketInt(fd, SOL_SOCKET, SO_RCVBUF);
+  report.dscp = GetSocketInt(fd, tos_level, tos_name) >> 2;
+  return report;
+}
+
+Napi::Object SocketTuningObject(Napi::Env env, const SocketTuningReport& report) {
+  Napi::Object out = Napi::Object::New(env);
+  out.Set("noDelay", report.no_delay);
+  out.Set("sendBufferBytes", static_cast<double>(report.send_buffer));
+  out.Set("receiveBufferBytes", static_cast<double>(report.receive_buffer));
+  out.Set("busyPollUs", static_cast<double>(report.busy_poll_us));
+  out.Set("notSentLowatBytes", static_cast<double>(report.not_sent_lowat));
+  out.Set("priority", static_cast<double>(report.priority));
+  out.Set("dscp", static_cast<double>(report.dscp));
+  out.Set("quickAck", report.quick_ack);
+  out.Set("fastOpen", report.fast_open);
+  out.Set("pacingRateBytesPerSec", static_cast<double>(report.pacing_rate));
+  out.Set("pacingQdisc", report.pacing_qdisc);
+  Napi::Array rejected = Napi::Array::New(env, report.rejected.size());
+  for (size_t i = 0; i < report.rejected.size(); ++i) {
+    rejected.Set(static_cast<uint32_t>(i), report.rejected[i]);
+  }
+  out.Set("rejected", rejected);
+  return out;
+}
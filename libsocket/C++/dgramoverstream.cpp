@@ -35,6 +35,13 @@
  * @{
  */
 
+#include <errno.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <algorithm>
+
 #include <dgramoverstream.hpp>
 #include <exception.hpp>
 
@@ -42,13 +49,15 @@ namespace libsocket {
 
 dgram_over_stream::dgram_over_stream(stream_client_socket socket)
     : inner(std::unique_ptr<stream_client_socket>(
-          new stream_client_socket(std::move(socket)))) {
+          new stream_client_socket(std::move(socket)))),
+      read_head(0),
+      read_tail(0) {
     enable_nagle(false);
 }
 
 dgram_over_stream::dgram_over_stream(
     std::unique_ptr<stream_client_socket> inner_)
-    : inner(std::move(inner_)) {
+    : inner(std::move(inner_)), read_head(0), read_tail(0) {
     enable_nagle(false);
 }
 
@@ -69,6 +78,30 @@ void dgram_over_stream::enable_nagle(bool enabled) const {
                         sizeof(int));
 }
 
+/**
+ * @brief Read the stream in chunks of up to `capacity` bytes.
+ *
+ * Once enabled, headers and small frames are served from a buffer that is
+ * refilled with one `recv` whenever it runs dry, instead of issuing one
+ * `recv` per header and per payload. Payloads at least `capacity` long are
+ * still read straight into the destination. The buffer grows when
+ * rcvmsgs() meets a frame that does not fit.
+ *
+ * Bytes already buffered are kept when called again; read-ahead cannot be
+ * switched off, since buffered bytes would then be lost.
+ */
+void dgram_over_stream::enable_read_ahead(size_t capacity) {
+    if (capacity < FRAMING_PREFIX_LENGTH) capacity = FRAMING_PREFIX_LENGTH;
+
+    const size_t buffered = read_tail - read_head;
+
+    if (buffered > 0 && read_head > 0)
+        memmove(read_ahead.data(), read_ahead.data() + read_head, buffered);
+    read_head = 0;
+    read_tail = buffered;
+    read_ahead.resize(std::max(capacity, buffered));
+}
+
 ssize_t dgram_over_stream::sndmsg(const std::string& msg) {
     return sndmsg(msg.c_str(), msg.size());
 }
@@ -84,27 +117,15 @@ ssize_t dgram_over_stream::rcvmsg(std::string* dst) {
     if (expected <= dst->size()) dst->resize(expected);
 
     size_t to_receive = dst->size();
-    size_t received = 0;
+    size_t received = to_receive > 0 ? receive_into(&(*dst)[0], to_receive) : 0;
 
-    while (received < to_receive) {
-        ssize_t result = receive_bytes(to_receive - received);
-
-        if (result < 0)
-            throw socket_exception(
-                __FILE__, __LINE__,
-                "dgram_over_stream::rcvmsg(): Could not receive message!",
-                false);
-
-        dst->replace(received, result, RECV_BUF);
-
-        received += (size_t)result;
-    }
+    if (received < to_receive)
+        throw socket_exception(
+            __FILE__, __LINE__,
+            "dgram_over_stream::rcvmsg(): Could not receive message!", false);
 
     // Consume remaining frame that doesn't fit into dst.
-    ssize_t rest = expected - to_receive;
-    while (rest > 0) {
-        rest -= receive_bytes(rest);
-    }
+    discard(expected - to_receive);
 
     return received;
 }
@@ -132,49 +153,87 @@ ssize_t dgram_over_stream::rcvmsg(std::vector<uint8_t>* dst) {
     if (expected <= dst->size()) dst->resize(expected);
 
     size_t to_receive = dst->size();
-    size_t received = 0;
-    std::vector<uint8_t>::iterator dst_iter = dst->begin();
+    size_t received =
+        to_receive > 0
+            ? receive_into(reinterpret_cast<char*>(dst->data()), to_receive)
+            : 0;
 
-    while (received < to_receive) {
-        ssize_t result = receive_bytes(to_receive - received);
-
-        if (result < 0)
-            throw socket_exception(
-                __FILE__, __LINE__,
-                "dgram_over_stream::rcvmsg(): Could not receive message!",
-                false);
-
-        for (ssize_t i = 0; i < result; i++, dst_iter++)
-            *dst_iter = RECV_BUF[i];
-
-        received += result;
-    }
+    if (received < to_receive)
+        throw socket_exception(
+            __FILE__, __LINE__,
+            "dgram_over_stream::rcvmsg(): Could not receive message!", false);
 
     // Consume remaining frame that doesn't fit into dst.
-    ssize_t rest = expected - to_receive;
-    while (rest > 0) {
-        rest -= receive_bytes(rest);
-    }
+    discard(expected - to_receive);
 
     return received;
 }
 
 /**
  * @brief Send the message in buf with length len as one frame.
- * @returns The total number of bytes sent.
+ *
+ * Prefix and payload leave in one `sendmsg`, so with Nagle disabled a small
+ * message is one segment rather than two.
+ *
+ * @returns The number of payload bytes sent; `len`.
  * @throws A socket_exception.
  */
 ssize_t dgram_over_stream::sndmsg(const void* buf, size_t len) {
+    struct iovec iov[2];
+
     encode_uint32(uint32_t(len), prefix_buffer);
-    ssize_t result = inner->snd(prefix_buffer, FRAMING_PREFIX_LENGTH, 0);
+    iov[0].iov_base = prefix_buffer;
+    iov[0].iov_len = FRAMING_PREFIX_LENGTH;
+    iov[1].iov_base = const_cast<void*>(buf);
+    iov[1].iov_len = len;
+
+    send_gathered(iov, len > 0 ? 2 : 1);
+
+    return len;
+}
 
-    if (result < 0) return result;
+/**
+ * @brief Send several messages, one frame each, in as few syscalls as
+ * possible.
+ *
+ * All prefixes and payloads go into one iovec array, written with `sendmsg`
+ * in chunks of up to `IOV_MAX` entries. Nothing is copied.
+ *
+ * @returns The number of payload bytes sent.
+ * @throws A socket_exception.
+ */
+size_t dgram_over_stream::sndmsgs(const frame_view* frames, size_t count) {
+    size_t payload = 0;
+
+    send_prefixes.resize(count * FRAMING_PREFIX_LENGTH);
+    send_iov.clear();
+    send_iov.reserve(2 * count);
+
+    for (size_t i = 0; i < count; i++) {
+        char* prefix = send_prefixes.data() + i * FRAMING_PREFIX_LENGTH;
+        struct iovec iov;
+
+        encode_uint32(uint32_t(frames[i].size), prefix);
+        iov.iov_base = prefix;
+        iov.iov_len = FRAMING_PREFIX_LENGTH;
+        send_iov.push_back(iov);
+        if (frames[i].size > 0) {
+            iov.iov_base = const_cast<char*>(frames[i].data);
+            iov.iov_len = frames[i].size;
+            send_iov.push_back(iov);
+        }
+        payload += frames[i].size;
+    }
 
-    result = inner->snd(buf, len, 0);
+    for (size_t pos = 0; pos < send_iov.size(); pos += IOV_MAX)
+        send_gathered(send_iov.data() + pos,
+                      std::min<size_t>(IOV_MAX, send_iov.size() - pos));
 
-    if (result < 0) return result;
+    return payload;
+}
 
-    return result;
+size_t dgram_over_stream::sndmsgs(const std::vector<frame_view>& frames) {
+    return sndmsgs(frames.data(), frames.size());
 }
 
 /**
@@ -188,48 +247,135 @@ ssize_t dgram_over_stream::rcvmsg(void* dst, size_t len) {
     uint32_t expected = receive_header();
 
     size_t to_receive = len < expected ? len : expected;
-    size_t received = 0;
+    size_t received =
+        to_receive > 0 ? receive_into(static_cast<char*>(dst), to_receive) : 0;
 
-    while (received < to_receive) {
-        ssize_t result = receive_bytes(to_receive - received);
+    if (received < to_receive)
+        throw socket_exception(
+            __FILE__, __LINE__,
+            "dgram_over_stream::rcvmsg(): Could not receive message!", false);
+
+    // Consume remaining frame that doesn't fit into dst.
+    discard(expected - to_receive);
 
-        if (result < 0)
+    return received;
+}
+
+/**
+ * @brief Receive every complete frame that is available.
+ *
+ * Blocks until at least one whole frame has arrived, then returns it and all
+ * further complete frames already buffered (up to `max_frames`) without
+ * reading the stream again. Enables read-ahead with the default capacity if
+ * it is not on yet.
+ *
+ * @param frames Cleared, then filled with views into the read-ahead buffer.
+ * They stay valid until the next receive call on this object.
+ * @param max_frames Upper bound on the frames returned.
+ *
+ * @returns The number of frames; 0 if the peer closed the stream between
+ * frames.
+ * @throws socket_exception on errors and when the stream ends inside a
+ * frame.
+ */
+size_t dgram_over_stream::rcvmsgs(std::vector<frame_view>* frames,
+                                  size_t max_frames) {
+    frames->clear();
+    if (max_frames == 0) return 0;
+    if (read_ahead.empty()) enable_read_ahead();
+
+    for (;;) {
+        size_t pos = read_head;
+
+        while (frames->size() < max_frames &&
+               read_tail - pos >= FRAMING_PREFIX_LENGTH) {
+            const size_t len = decode_uint32(read_ahead.data() + pos);
+
+            if (read_tail - pos - FRAMING_PREFIX_LENGTH < len) {
+                // Make room for the whole frame before reading on.
+                if (pos == read_head &&
+                    FRAMING_PREFIX_LENGTH + len > read_ahead.size())
+                    enable_read_ahead(FRAMING_PREFIX_LENGTH + len);
+                break;
+            }
+            frames->push_back(
+                frame_view{read_ahead.data() + pos + FRAMING_PREFIX_LENGTH, len});
+            pos += FRAMING_PREFIX_LENGTH + len;
+        }
+
+        if (!frames->empty()) {
+            read_head = pos;
+            return frames->size();
+        }
+
+        if (read_some() == 0) {
+            if (read_tail == read_head) return 0;
             throw socket_exception(
                 __FILE__, __LINE__,
-                "dgram_over_stream::rcvmsg(): Could not receive message!",
+                "dgram_over_stream::rcvmsgs(): Stream ended inside a frame!",
                 false);
-
-        memcpy(dst, RECV_BUF, result);
-        dst = static_cast<void*>(static_cast<char*>(dst) + result);
-        received += result;
-    }
-
-    // Consume remaining frame that doesn't fit into dst.
-    ssize_t rest = expected - to_receive;
-    while (rest > 0) {
-        rest -= receive_bytes(rest);
+        }
     }
-    return received;
 }
 
-// Places up to n bytes into this->RECV_BUF.
-ssize_t dgram_over_stream::receive_bytes(size_t n) {
-    if (n == 0) return 0;
-
-    // Ignore rest of message.
-    ssize_t rest_len = n > RECV_BUF_SIZE ? RECV_BUF_SIZE : n;
-    size_t pos = 0;
+/*
+ * Places exactly n bytes into dst, unless the stream ends first. Buffered
+ * bytes are copied out; in read-ahead mode short remainders are served by
+ * refilling the buffer and long ones are read straight into dst.
+ */
+size_t dgram_over_stream::receive_into(char* dst, size_t n) {
+    size_t got = 0;
+
+    if (!read_ahead.empty()) {
+        got = std::min(n, read_tail - read_head);
+        memcpy(dst, read_ahead.data() + read_head, got);
+        read_head += got;
+
+        while (got < n) {
+            const size_t left = n - got;
+
+            if (left >= read_ahead.size()) {
+                const size_t recvd = recv_direct(dst + got, left);
+                if (recvd == 0) break;
+                got += recvd;
+                continue;
+            }
+            if (read_some() == 0) break;
+
+            const size_t take = std::min(left, read_tail - read_head);
+            memcpy(dst + got, read_ahead.data() + read_head, take);
+            read_head += take;
+            got += take;
+        }
+
+        return got;
+    }
 
-    while (rest_len > 0) {
-        ssize_t recvd = inner->rcv(RECV_BUF + pos, rest_len, 0);
+    while (got < n) {
+        const size_t recvd = recv_direct(dst + got, n - got);
+        if (recvd == 0) break;
+        got += recvd;
+    }
 
-        if (recvd <= 0) return n - rest_len;
+    return got;
+}
 
-        rest_len -= recvd;
-        pos += recvd;
+// Drops the next n bytes of the stream.
+void dgram_over_stream::discard(size_t n) {
+    while (n > 0) {
+        size_t dropped;
+
+        if (!read_ahead.empty()) {
+            if (read_head == read_tail && read_some() == 0) return;
+            dropped = std::min(n, read_tail - read_head);
+            read_head += dropped;
+        } else {
+            dropped = recv_direct(RECV_BUF, n < RECV_BUF_SIZE ? n : RECV_BUF_SIZE);
+            if (dropped == 0) return;
+        }
+
+        n -= dropped;
     }
-
-    return pos;
 }
 
 /**
@@ -238,22 +384,96 @@ ssize_t dgram_over_stream::receive_bytes(size_t n) {
  * @throws socket_exception
  */
 uint32_t dgram_over_stream::receive_header(void) {
-    ssize_t pos = 0;
+    if (receive_into(prefix_buffer, FRAMING_PREFIX_LENGTH) <
+        FRAMING_PREFIX_LENGTH)
+        throw socket_exception(__FILE__, __LINE__,
+                               "dgram_over_stream::receive_header(): Could "
+                               "not receive length prefix!",
+                               false);
 
-    do {
-        ssize_t result =
-            inner->rcv(prefix_buffer + pos, FRAMING_PREFIX_LENGTH, 0);
+    return decode_uint32(prefix_buffer);
+}
 
-        if (result < 0)
+/*
+ * One recv(2) on the inner socket; 0 at end of stream. Bypasses rcv(), which
+ * zeroes the whole destination first -- the full read-ahead buffer, here.
+ */
+size_t dgram_over_stream::recv_direct(char* dst, size_t n) {
+    if (inner->shut_rd)
+        throw socket_exception(__FILE__, __LINE__,
+                               "dgram_over_stream: Socket has already been "
+                               "shut down!",
+                               false);
+
+    for (;;) {
+        ssize_t recvd = ::recv(inner->getfd(), dst, n, 0);
+
+        if (recvd >= 0) return static_cast<size_t>(recvd);
+        if (errno != EINTR)
             throw socket_exception(__FILE__, __LINE__,
-                                   "dgram_over_stream::receive_header(): Could "
-                                   "not receive length prefix!",
-                                   false);
+                                   "dgram_over_stream: Error while reading!");
+    }
+}
 
-        pos += result;
-    } while (pos < 4);
+/*
+ * Writes all of iov[0..count), resuming after short writes. Modifies the
+ * entries it has partly sent.
+ */
+size_t dgram_over_stream::send_gathered(struct iovec* iov, size_t count) {
+    size_t total = 0;
 
-    return decode_uint32(prefix_buffer);
+    if (inner->shut_wr)
+        throw socket_exception(__FILE__, __LINE__,
+                               "dgram_over_stream: Socket has already been "
+                               "shut down!",
+                               false);
+
+    while (count > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+
+        ssize_t sent = ::sendmsg(inner->getfd(), &msg, 0);
+
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            throw socket_exception(__FILE__, __LINE__,
+                                   "dgram_over_stream: Error while sending");
+        }
+        total += static_cast<size_t>(sent);
+
+        size_t left = static_cast<size_t>(sent);
+        while (count > 0 && left >= iov->iov_len) {
+            left -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + left;
+            iov->iov_len -= left;
+        }
+    }
+
+    return total;
+}
+
+// Refills the read-ahead buffer with one recv; returns the bytes read.
+size_t dgram_over_stream::read_some(void) {
+    if (read_head == read_tail) {
+        read_head = read_tail = 0;
+    } else if (read_tail == read_ahead.size()) {
+        memmove(read_ahead.data(), read_ahead.data() + read_head,
+                read_tail - read_head);
+        read_tail -= read_head;
+        read_head = 0;
+    }
+
+    const size_t recvd = recv_direct(read_ahead.data() + read_tail,
+                                     read_ahead.size() - read_tail);
+    read_tail += recvd;
+
+    return recvd;
 }
 }  // namespace libsocket
 
@@ -1,6 +1,7 @@
 #include <string.h>
 #include <iostream>
 #include <memory>
+#include <new>
 #include <string>
 
 #include <stdio.h>
@@ -48,6 +49,10 @@
 #include <exception.hpp>
 #include <inetdgram.hpp>
 
+#include <limits.h>
+#include <netdb.h>
+#include <netinet/udp.h>
+
 namespace libsocket {
 using std::string;
 
@@ -272,4 +277,423 @@ ssize_t inet_dgram::sndto(const string& buf, const string& dsthost,
 
     return bytes;
 }
+
+// Batched I/O
+
+namespace {
+// Largest UDP payload the kernel builds for one GSO send (IPv4 bound), and
+// the most segments it accepts in one (UDP_MAX_SEGMENTS).
+const size_t gso_max_bytes = 65507;
+const size_t gso_max_segments = 64;
+}  // namespace
+
+/**
+ * @brief Send several datagrams with one `sendmmsg(2)`
+ *
+ * Every entry is sent as its own datagram to its own `peer` (or to the
+ * connected peer if `peerlen` is 0). If the kernel takes only part of the
+ * batch, the rest is resubmitted until everything is sent or, on a
+ * non-blocking socket, the send buffer is full.
+ *
+ * @param msgs The datagrams
+ * @param count Number of entries in `msgs`
+ * @param flags Flags for `sendmmsg(2)`
+ *
+ * @retval >=0 Number of datagrams sent, from the start of `msgs`.
+ * @retval -1 Socket is non-blocking and nothing could be sent.
+ *
+ * An error on the first datagram makes the function throw an exception; an
+ * error after some were sent returns their count, so the caller can resume
+ * past the datagram that failed.
+ */
+int inet_dgram::sndmmsg(dgram_message* msgs, size_t count, int flags) {
+    if (-1 == sfd)
+        throw socket_exception(__FILE__, __LINE__,
+                               "inet_dgram::sndmmsg() - Socket already closed!",
+                               false);
+
+    const int sent = try_sndmmsg(msgs, count, flags);
+    if (sent < 0 && !(is_nonblocking && errno == EWOULDBLOCK))
+        throw socket_exception(__FILE__, __LINE__,
+                               "inet_dgram::sndmmsg() - Error at sendmmsg");
+    return sent;
+}
+
+/**
+ * @brief `sndmmsg()` without exceptions
+ *
+ * Same batching and partial-send rules, for send loops where a full send
+ * buffer is routine.
+ *
+ * @retval >=0 Number of datagrams sent, from the start of `msgs`.
+ * @retval -1 Nothing was sent; `errno` says why (`EWOULDBLOCK` on a full
+ * non-blocking socket, `EBADF` once closed).
+ */
+int inet_dgram::try_sndmmsg(dgram_message* msgs, size_t count,
+                            int flags) noexcept {
+    if (-1 == sfd) {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (tx_mmsg.size() < count) {
+        try {
+            tx_mmsg.resize(count);
+            tx_iov.resize(count);
+        } catch (const std::bad_alloc&) {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        struct mmsghdr& hdr = tx_mmsg[i];
+        memset(&hdr, 0, sizeof(hdr));
+        tx_iov[i].iov_base = msgs[i].data;
+        tx_iov[i].iov_len = msgs[i].len;
+        hdr.msg_hdr.msg_iov = &tx_iov[i];
+        hdr.msg_hdr.msg_iovlen = 1;
+        if (msgs[i].peerlen > 0) {
+            hdr.msg_hdr.msg_name = &msgs[i].peer;
+            hdr.msg_hdr.msg_namelen = msgs[i].peerlen;
+        }
+    }
+
+    size_t sent = 0;
+    while (sent < count) {
+        size_t chunk = count - sent;
+        if (chunk > IOV_MAX) chunk = IOV_MAX;
+        int n = sendmmsg(sfd, &tx_mmsg[sent],
+                         static_cast<unsigned int>(chunk), flags);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return sent > 0 ? static_cast<int>(sent) : -1;
+        }
+        sent += n;
+    }
+
+    return static_cast<int>(sent);
+}
+
+/**
+ * @brief Receive several datagrams with one `recvmmsg(2)`
+ *
+ * Waits for the first datagram (unless the socket is non-blocking), then
+ * takes whatever else is already queued, up to `count`. Each entry's `len`
+ * is its buffer capacity on entry and the datagram size on return; `peer`
+ * and `peerlen` are filled with the sender.
+ *
+ * With `enable_gro()`, one entry may hold several merged datagrams of the
+ * same sender; see `dgram_message::segment_size`. Buffers should then be
+ * 64 KiB, or the merged datagram is truncated.
+ *
+ * @param msgs Receive slots
+ * @param count Number of slots
+ * @param flags Flags for `recvmmsg(2)`; `MSG_WAITFORONE` is always added.
+ *
+ * @retval >0 Number of slots filled, from the start of `msgs`.
+ * @retval -1 Socket is non-blocking and no datagram was queued.
+ *
+ * Every error makes the function throw an exception.
+ */
+int inet_dgram::rcvmmsg(dgram_message* msgs, size_t count, int flags) {
+    if (-1 == sfd)
+        throw socket_exception(__FILE__, __LINE__,
+                               "inet_dgram::rcvmmsg() - Socket is closed!",
+                               false);
+
+    const int n = try_rcvmmsg(msgs, count, flags);
+    if (n < 0 && !(is_nonblocking && errno == EWOULDBLOCK))
+        throw socket_exception(__FILE__, __LINE__,
+                               "inet_dgram::rcvmmsg() - recvmmsg() failed "
+                               "-- could not receive data from peer!");
+    return n;
+}
+
+/**
+ * @brief `rcvmmsg()` without exceptions
+ *
+ * Same slots and GRO handling, for receive loops that drain a socket
+ * until it would block.
+ *
+ * @retval >0 Number of slots filled, from the start of `msgs`.
+ * @retval -1 Nothing was received; `errno` says why (`EWOULDBLOCK` when
+ * nothing was queued on a non-blocking socket, `EBADF` once closed).
+ */
+int inet_dgram::try_rcvmmsg(dgram_message* msgs, size_t count,
+                            int flags) noexcept {
+    if (-1 == sfd) {
+        errno = EBADF;
+        return -1;
+    }
+
+    if (count > IOV_MAX) count = IOV_MAX;
+    const size_t cmsg_space = CMSG_SPACE(sizeof(int));
+    try {
+        if (rx_mmsg.size() < count) {
+            rx_mmsg.resize(count);
+            rx_iov.resize(count);
+        }
+        if (gro_enabled && rx_cmsg.size() < count * cmsg_space)
+            rx_cmsg.resize(count * cmsg_space);
+    } catch (const std::bad_alloc&) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        struct mmsghdr& hdr = rx_mmsg[i];
+        memset(&hdr, 0, sizeof(hdr));
+        rx_iov[i].iov_base = msgs[i].data;
+        rx_iov[i].iov_len = msgs[i].len;
+        hdr.msg_hdr.msg_iov = &rx_iov[i];
+        hdr.msg_hdr.msg_iovlen = 1;
+        hdr.msg_hdr.msg_name = &msgs[i].peer;
+        hdr.msg_hdr.msg_namelen = sizeof(msgs[i].peer);
+        if (gro_enabled) {
+            hdr.msg_hdr.msg_control = &rx_cmsg[i * cmsg_space];
+            hdr.msg_hdr.msg_controllen = cmsg_space;
+        }
+    }
+
+    int n;
+    do {
+        n = recvmmsg(sfd, rx_mmsg.data(), static_cast<unsigned int>(count),
+                     flags | MSG_WAITFORONE, nullptr);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0) return -1;
+
+    for (int i = 0; i < n; i++) {
+        struct msghdr& hdr = rx_mmsg[i].msg_hdr;
+        msgs[i].len = rx_mmsg[i].msg_len;
+        msgs[i].peerlen = hdr.msg_namelen;
+        msgs[i].truncated = (hdr.msg_flags & MSG_TRUNC) != 0;
+        msgs[i].segment_size = 0;
+#ifdef UDP_GRO
+        if (gro_enabled) {
+            for (struct cmsghdr* cm = CMSG_FIRSTHDR(&hdr); cm != nullptr;
+                 cm = CMSG_NXTHDR(&hdr, cm)) {
+                if (cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO) {
+                    int size;
+                    memcpy(&size, CMSG_DATA(cm), sizeof(size));
+                    msgs[i].segment_size = static_cast<uint16_t>(size);
+                }
+            }
+        }
+#endif
+    }
+
+    return n;
+}
+
+/**
+ * @brief Send a buffer as a train of equally sized datagrams
+ *
+ * `buf` is cut into datagrams of `segment_size` bytes (the last one may be
+ * shorter), all addressed to `peer`. Where the kernel supports UDP GSO
+ * (`UDP_SEGMENT`, Linux 4.18+), up to 64 of them leave in one `sendmsg(2)`
+ * and are split by the kernel or the NIC. Otherwise, or when the route's
+ * device refuses segmentation offload, the same datagrams are sent with
+ * `sndmmsg()`; the receiver cannot tell the difference.
+ *
+ * @param buf The data
+ * @param len Its length
+ * @param segment_size Payload bytes per datagram
+ * @param peer Destination, or nullptr for the connected peer
+ * @param peerlen Length of `peer`, 0 if `peer` is nullptr
+ * @param flags Flags for `sendmsg(2)`
+ *
+ * @retval >=0 Bytes sent, always a whole number of datagrams.
+ * @retval -1 Socket is non-blocking and nothing could be sent.
+ *
+ * Every error makes the function throw an exception.
+ */
+ssize_t inet_dgram::sndsegments(const void* buf, size_t len,
+                                size_t segment_size,
+                                const struct sockaddr* peer, socklen_t peerlen,
+                                int flags) {
+    if (-1 == sfd)
+        throw socket_exception(
+            __FILE__, __LINE__,
+            "inet_dgram::sndsegments() - Socket already closed!", false);
+    if (segment_size == 0 || segment_size > gso_max_bytes)
+        throw socket_exception(
+            __FILE__, __LINE__,
+            "inet_dgram::sndsegments() - Invalid segment size!", false);
+
+    const char* data = static_cast<const char*>(buf);
+    size_t sent = 0;
+
+#ifdef UDP_SEGMENT
+    size_t per_call = gso_max_bytes / segment_size;
+    if (per_call > gso_max_segments) per_call = gso_max_segments;
+    per_call *= segment_size;
+
+    while (!gso_unsupported && sent < len) {
+        size_t chunk = len - sent < per_call ? len - sent : per_call;
+
+        // A single short segment needs no offload.
+        if (chunk <= segment_size) break;
+
+        struct iovec iov;
+        iov.iov_base = const_cast<char*>(data + sent);
+        iov.iov_len = chunk;
+
+        char control[CMSG_SPACE(sizeof(uint16_t))];
+        memset(control, 0, sizeof(control));
+
+        struct msghdr hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.msg_name = const_cast<struct sockaddr*>(peer);
+        hdr.msg_namelen = peer != nullptr ? peerlen : 0;
+        hdr.msg_iov = &iov;
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = control;
+        hdr.msg_controllen = sizeof(control);
+
+        struct cmsghdr* cm = CMSG_FIRSTHDR(&hdr);
+        cm->cmsg_level = SOL_UDP;
+        cm->cmsg_type = UDP_SEGMENT;
+        cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        uint16_t gso_size = static_cast<uint16_t>(segment_size);
+        memcpy(CMSG_DATA(cm), &gso_size, sizeof(gso_size));
+
+        ssize_t n = sendmsg(sfd, &hdr, flags);
+        if (n >= 0) {
+            sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (errno == EINTR) continue;
+        if (is_nonblocking && errno == EWOULDBLOCK)
+            return sent > 0 ? static_cast<ssize_t>(sent) : -1;
+        // EIO: the device cannot checksum-offload; the others: no GSO here.
+        if (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT ||
+            errno == EOPNOTSUPP) {
+            gso_unsupported = true;
+            break;
+        }
+        throw socket_exception(__FILE__, __LINE__,
+                               "inet_dgram::sndsegments() - Error at sendmsg");
+    }
+#endif
+
+    if (sent >= len) return static_cast<ssize_t>(sent);
+
+    ssize_t rest = send_segmented(data + sent, len - sent, segment_size, peer,
+                                  peerlen, flags);
+    if (rest < 0) return sent > 0 ? static_cast<ssize_t>(sent) : -1;
+    return static_cast<ssize_t>(sent) + rest;
+}
+
+// sndsegments() without offload: one sndmmsg() entry per segment.
+ssize_t inet_dgram::send_segmented(const void* buf, size_t len,
+                                   size_t segment_size,
+                                   const struct sockaddr* peer,
+                                   socklen_t peerlen, int flags) {
+    const char* data = static_cast<const char*>(buf);
+    const size_t count = (len + segment_size - 1) / segment_size;
+
+    tx_segments.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const size_t offset = i * segment_size;
+        dgram_message& msg = tx_segments[i];
+        msg.data = const_cast<char*>(data + offset);
+        msg.len = len - offset < segment_size ? len - offset : segment_size;
+        msg.peerlen = 0;
+        if (peer != nullptr && peerlen > 0 && peerlen <= sizeof(msg.peer)) {
+            memcpy(&msg.peer, peer, peerlen);
+            msg.peerlen = peerlen;
+        }
+    }
+
+    int n = sndmmsg(tx_segments.data(), count, flags);
+    if (n < 0) return -1;
+    if (static_cast<size_t>(n) == count) return static_cast<ssize_t>(len);
+    return static_cast<ssize_t>(n * segment_size);
+}
+
+/**
+ * @brief Let the kernel merge received datagrams (UDP GRO)
+ *
+ * With GRO on, consecutive datagrams from one sender of the same size may
+ * arrive as one `rcvmmsg()` entry; `segment_size` then tells where to cut.
+ * Needs Linux 5.0+. `rcvfrom()` cannot report segment sizes, so only use
+ * GRO with `rcvmmsg()`.
+ *
+ * @param enable Turn GRO on or off
+ *
+ * @retval true The setting was applied.
+ * @retval false The kernel or the system headers do not know UDP GRO.
+ */
+bool inet_dgram::enable_gro(bool enable) {
+    if (-1 == sfd)
+        throw socket_exception(
+            __FILE__, __LINE__,
+            "inet_dgram::enable_gro() - Socket already closed!", false);
+#ifdef UDP_GRO
+    int value = enable ? 1 : 0;
+    if (0 != setsockopt(sfd, SOL_UDP, UDP_GRO, &value, sizeof(value)))
+        return false;
+    gro_enabled = enable;
+    return true;
+#else
+    (void)enable;
+    return false;
+#endif
+}
+
+/**
+ * @brief Resolve a peer once for the batched calls
+ *
+ * `sndto()` resolves its destination on every call; `sndmmsg()` and
+ * `sndsegments()` take socket addresses instead. This looks up `host` and
+ * `port` in the socket's own address family (IPv4 peers are mapped on an
+ * IPv6 socket).
+ *
+ * @param host Peer host
+ * @param port Peer port
+ * @param addr Where to store the address
+ *
+ * @returns The length of the address in `addr`.
+ *
+ * Every error makes the function throw an exception.
+ */
+socklen_t inet_dgram::resolve(const string& host, const string& port,
+                              struct sockaddr_storage* addr) const {
+    if (-1 == sfd)
+        throw socket_exception(__FILE__, __LINE__,
+                               "inet_dgram::resolve() - Socket is closed!",
+                               false);
+
+    struct sockaddr_storage local;
+    socklen_t local_len = sizeof(local);
+    memset(&local, 0, sizeof(local));
+    if (0 != getsockname(sfd, reinterpret_cast<struct sockaddr*>(&local),
+                         &local_len))
+        throw socket_exception(
+            __FILE__, __LINE__,
+            "inet_dgram::resolve() - getsockname() failed");
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = local.ss_family;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (local.ss_family == AF_INET6) hints.ai_flags = AI_V4MAPPED;
+
+    struct addrinfo* result = nullptr;
+    int rc = getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+    if (rc != 0 || result == nullptr) {
+        string message = "inet_dgram::resolve() - could not resolve " + host +
+                         ":" + port + ": ";
+        message += gai_strerror(rc);
+        throw socket_exception(__FILE__, __LINE__, message, false);
+    }
+
+    socklen_t len = result->ai_addrlen;
+    memcpy(addr, result->ai_addr, len);
+    freeaddrinfo(result);
+
+    return len;
+}
 }  // namespace libsocket
@@ -94,6 +94,42 @@ ssize_t stream_client_socket::rcv(void* buf, size_t len, int flags) {
     return recvd;
 }
 
+/**
+ * @brief Receive data without exceptions
+ *
+ * Like `rcv()`, for loops where a would-block is the common case: nothing
+ * throws and `buf` is not cleared first. `EINTR` is retried.
+ *
+ * @param buf A writable memory buffer of length `len`
+ * @param len Length of `buf`
+ * @param flags Flags for `recv(2)`
+ *
+ * @retval >0 Bytes received.
+ * @retval 0 The peer shut the connection down.
+ * @retval -1 Failure; `errno` says why (`EWOULDBLOCK` when nothing was
+ * queued, `EPIPE` after `shutdown()`, `ENOTCONN`, `EINVAL`).
+ */
+ssize_t stream_client_socket::try_rcv(void* buf, size_t len,
+                                      int flags) noexcept {
+    if (shut_rd) {
+        errno = EPIPE;
+        return -1;
+    }
+    if (sfd == -1) {
+        errno = ENOTCONN;
+        return -1;
+    }
+    if (buf == NULL || len == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    ssize_t recvd;
+    do {
+        recvd = ::recv(sfd, buf, len, flags);
+    } while (recvd < 0 && errno == EINTR);
+    return recvd;
+}
+
 /**
  * @brief Receive data from socket to a string
  *
@@ -265,6 +301,41 @@ ssize_t stream_client_socket::snd(const void* buf, size_t len, int flags) {
     return snd_bytes;
 }
 
+/**
+ * @brief Send data without exceptions
+ *
+ * Like `snd()`, for loops where a full send buffer is the common case:
+ * nothing throws. `EINTR` is retried.
+ *
+ * @param buf Data to be sent
+ * @param len Length of `buf`
+ * @param flags Flags for `send(2)`
+ *
+ * @retval >=0 Bytes sent.
+ * @retval -1 Failure; `errno` says why (`EWOULDBLOCK` when the send buffer
+ * is full, `EPIPE` after `shutdown()`, `ENOTCONN`, `EINVAL`).
+ */
+ssize_t stream_client_socket::try_snd(const void* buf, size_t len,
+                                      int flags) noexcept {
+    if (shut_wr) {
+        errno = EPIPE;
+        return -1;
+    }
+    if (sfd == -1) {
+        errno = ENOTCONN;
+        return -1;
+    }
+    if (buf == NULL || len == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    ssize_t sent;
+    do {
+        sent = ::send(sfd, buf, len, flags);
+    } while (sent < 0 && errno == EINTR);
+    return sent;
+}
+
 /**
  * @brief Shut a socket down
  *
@@ -0,0 +1,741 @@
+/*
+   The committers of the libsocket project, all rights reserved
+   (c) 2012, dermesser <lbo@spheniscida.de>
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS” AND ANY
+   EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+
+/**
+ * @file uring.cpp
+ *
+ * @brief io_uring engine for stream sockets (see uring.hpp).
+ *
+ * Talks to the kernel through the raw `io_uring_setup`/`io_uring_enter`/
+ * `io_uring_register` syscalls, so liburing is not needed.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+#include <exception.hpp>
+#include <uring.hpp>
+
+namespace libsocket {
+using std::string;
+
+#if LIBSOCKET_HAVE_URING
+
+namespace {
+// user_data layout: kind (8 bits) | generation (24) | slot (16) | buffer (16).
+enum op_kind : uint64_t { OP_RECV = 1, OP_WRITE = 2, OP_CANCEL = 3 };
+
+uint64_t encode(op_kind kind, uint32_t generation, int slot, int buf) {
+    return (static_cast<uint64_t>(kind) << 56) |
+           (static_cast<uint64_t>(generation & 0xffffff) << 32) |
+           (static_cast<uint64_t>(slot & 0xffff) << 16) |
+           static_cast<uint64_t>(buf & 0xffff);
+}
+
+op_kind kind_of(uint64_t user_data) {
+    return static_cast<op_kind>(user_data >> 56);
+}
+uint32_t generation_of(uint64_t user_data) {
+    return static_cast<uint32_t>(user_data >> 32) & 0xffffff;
+}
+int slot_of(uint64_t user_data) {
+    return static_cast<int>((user_data >> 16) & 0xffff);
+}
+int buf_of(uint64_t user_data) { return static_cast<int>(user_data & 0xffff); }
+
+int sys_setup(unsigned entries, struct io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return static_cast<int>(
+        syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+void* map_anonymous(size_t len) {
+    void* mem = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return mem == MAP_FAILED ? nullptr : mem;
+}
+}  // namespace
+
+/**
+ * @brief Whether this kernel and process can run a `uring_engine`.
+ *
+ * Creates a minimal engine once and caches the answer. False on kernels
+ * without buffer rings and where io_uring is disabled (e.g. by seccomp or
+ * `kernel.io_uring_disabled`).
+ */
+bool uring_engine::available(void) {
+    static int cached = -1;
+
+    if (cached < 0) {
+        params probe;
+        probe.entries = 4;
+        probe.max_sockets = 1;
+        probe.recv_buffers = 1;
+        probe.recv_buffer_size = 64;
+        probe.send_buffers = 1;
+        probe.send_buffer_size = 64;
+        try {
+            uring_engine engine(probe);
+            cached = 1;
+        } catch (const socket_exception&) {
+            cached = 0;
+        }
+    }
+
+    return cached == 1;
+}
+
+/**
+ * @brief Create the ring and register its files and buffers.
+ *
+ * @param p Ring and buffer sizes. `recv_buffers` must be a power of two.
+ *
+ * Throws a `socket_exception` if io_uring or any registration is
+ * unavailable; see `available()`.
+ */
+uring_engine::uring_engine(const params& p)
+    : cfg(p),
+      totals(),
+      ring_fd(-1),
+      sq_map(nullptr),
+      sq_map_len(0),
+      cq_map(nullptr),
+      cq_map_len(0),
+      sqes(nullptr),
+      sqes_len(0),
+      sq_head(nullptr),
+      sq_tail(nullptr),
+      sq_mask(0),
+      sq_array(nullptr),
+      cq_head(nullptr),
+      cq_tail(nullptr),
+      cq_mask(0),
+      cqes(nullptr),
+      pending(0),
+      recv_ring(nullptr),
+      recv_ring_len(0),
+      recv_memory(nullptr),
+      recv_mask(0),
+      recv_tail(0),
+      send_memory(nullptr) {
+    if (cfg.recv_buffers == 0 || cfg.recv_buffers > 32768 ||
+        (cfg.recv_buffers & (cfg.recv_buffers - 1)) != 0)
+        throw socket_exception(
+            __FILE__, __LINE__,
+            "uring_engine: recv_buffers must be a power of two <= 32768",
+            false);
+    if (cfg.max_sockets == 0 || cfg.max_sockets > 0xffff ||
+        cfg.send_buffers == 0 || cfg.send_buffers > 0xffff)
+        throw socket_exception(
+            __FILE__, __LINE__,
+            "uring_engine: max_sockets and send_buffers must be 1..65535",
+            false);
+
+    struct io_uring_params ring_params;
+    memset(&ring_params, 0, sizeof(ring_params));
+    // Only this thread submits, and completions are reaped in poll(), so the
+    // kernel need not interrupt us to run task work.
+    ring_params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN;
+    ring_fd = sys_setup(cfg.entries, &ring_params);
+    if (ring_fd < 0 && errno == EINVAL) {
+        memset(&ring_params, 0, sizeof(ring_params));
+        ring_fd = sys_setup(cfg.entries, &ring_params);
+    }
+    if (ring_fd < 0)
+        throw socket_exception(
+            __FILE__, __LINE__,
+            string("uring_engine: io_uring_setup failed: ") + strerror(errno));
+
+    try {
+        sq_map_len = ring_params.sq_off.array +
+                     ring_params.sq_entries * sizeof(unsigned);
+        cq_map_len = ring_params.cq_off.cqes +
+                     ring_params.cq_entries * sizeof(struct io_uring_cqe);
+        if (ring_params.features & IORING_FEAT_SINGLE_MMAP)
+            sq_map_len = cq_map_len = std::max(sq_map_len, cq_map_len);
+
+        sq_map = mmap(nullptr, sq_map_len, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) {
+            sq_map = nullptr;
+            throw socket_exception(__FILE__, __LINE__,
+                                   "uring_engine: mmap of SQ ring failed");
+        }
+        if (ring_params.features & IORING_FEAT_SINGLE_MMAP) {
+            cq_map = sq_map;
+        } else {
+            cq_map =
+                mmap(nullptr, cq_map_len, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+            if (cq_map == MAP_FAILED) {
+                cq_map = nullptr;
+                throw socket_exception(__FILE__, __LINE__,
+                                       "uring_engine: mmap of CQ ring failed");
+            }
+        }
+        sqes_len = ring_params.sq_entries * sizeof(struct io_uring_sqe);
+        void* sqe_map = mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        if (sqe_map == MAP_FAILED)
+            throw socket_exception(__FILE__, __LINE__,
+                                   "uring_engine: mmap of SQEs failed");
+        sqes = static_cast<struct io_uring_sqe*>(sqe_map);
+
+        char* sq = static_cast<char*>(sq_map);
+        char* cq = static_cast<char*>(cq_map);
+        sq_head = reinterpret_cast<unsigned*>(sq + ring_params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + ring_params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + ring_params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + ring_params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + ring_params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + ring_params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + ring_params.cq_off.ring_mask);
+        cqes = reinterpret_cast<struct io_uring_cqe*>(cq + ring_params.cq_off.cqes);
+        // SQE i always sits in array slot i; only the tail moves.
+        for (unsigned i = 0; i < ring_params.sq_entries; i++) sq_array[i] = i;
+
+        // Fixed files: a sparse table filled in by add_socket().
+        std::vector<int> files(cfg.max_sockets, -1);
+        totals.register_calls++;
+        if (0 > sys_register(ring_fd, IORING_REGISTER_FILES, files.data(),
+                             cfg.max_sockets))
+            throw socket_exception(__FILE__, __LINE__,
+                                   "uring_engine: registering files failed");
+
+        // Registered send buffers, one write in flight per buffer.
+        send_memory = static_cast<char*>(
+            map_anonymous(cfg.send_buffers * cfg.send_buffer_size));
+        if (send_memory == nullptr)
+            throw socket_exception(__FILE__, __LINE__,
+                                   "uring_engine: allocating send buffers failed");
+        std::vector<struct iovec> iovs(cfg.send_buffers);
+        for (unsigned i = 0; i < cfg.send_buffers; i++) {
+            iovs[i].iov_base = send_memory + i * cfg.send_buffer_size;
+            iovs[i].iov_len = cfg.send_buffer_size;
+            free_send_bufs.push_back(static_cast<int>(cfg.send_buffers - 1 - i));
+        }
+        totals.register_calls++;
+        if (0 > sys_register(ring_fd, IORING_REGISTER_BUFFERS, iovs.data(),
+                             cfg.send_buffers))
+            throw socket_exception(__FILE__, __LINE__,
+                                   "uring_engine: registering send buffers failed");
+
+        // Provided buffer ring (group 0) for multishot receives.
+        recv_ring_len = cfg.recv_buffers * sizeof(struct io_uring_buf);
+        recv_ring = static_cast<struct io_uring_buf_ring*>(
+            map_anonymous(recv_ring_len));
+        recv_memory = static_cast<char*>(
+            map_anonymous(cfg.recv_buffers * cfg.recv_buffer_size));
+        if (recv_ring == nullptr || recv_memory == nullptr)
+            throw socket_exception(__FILE__, __LINE__,
+                                   "uring_engine: allocating recv buffers failed");
+        struct io_uring_buf_reg reg;
+        memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<uint64_t>(recv_ring);
+        reg.ring_entries = cfg.recv_buffers;
+        reg.bgid = 0;
+        totals.register_calls++;
+        if (0 > sys_register(ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1))
+            throw socket_exception(__FILE__, __LINE__,
+                                   "uring_engine: registering buffer ring failed");
+        recv_mask = cfg.recv_buffers - 1;
+        for (unsigned i = 0; i < cfg.recv_buffers; i++)
+            recycle(static_cast<uint16_t>(i));
+        __atomic_store_n(&recv_ring->tail, static_cast<uint16_t>(recv_tail),
+                         __ATOMIC_RELEASE);
+    } catch (...) {
+        release();
+        throw;
+    }
+
+    conns.resize(cfg.max_sockets);
+    for (connection& conn : conns) {
+        conn.fd = -1;
+        conn.generation = 0;
+        conn.open = false;
+        conn.recv_armed = false;
+        conn.inflight_buf = -1;
+        conn.inflight_off = conn.inflight_len = 0;
+        conn.backlog_head = 0;
+    }
+}
+
+/**
+ * @brief Tear down the ring. Registered sockets are not closed.
+ */
+uring_engine::~uring_engine(void) { release(); }
+
+void uring_engine::release(void) {
+    // Closing the ring cancels whatever is still in flight.
+    if (ring_fd >= 0) close(ring_fd);
+    ring_fd = -1;
+    if (sqes != nullptr) munmap(sqes, sqes_len);
+    if (cq_map != nullptr && cq_map != sq_map) munmap(cq_map, cq_map_len);
+    if (sq_map != nullptr) munmap(sq_map, sq_map_len);
+    if (recv_ring != nullptr) munmap(recv_ring, recv_ring_len);
+    if (recv_memory != nullptr)
+        munmap(recv_memory, cfg.recv_buffers * cfg.recv_buffer_size);
+    if (send_memory != nullptr)
+        munmap(send_memory, cfg.send_buffers * cfg.send_buffer_size);
+    sqes = nullptr;
+    sq_map = cq_map = nullptr;
+    recv_ring = nullptr;
+    recv_memory = send_memory = nullptr;
+}
+
+/**
+ * @brief Register a connected stream socket and start receiving on it.
+ *
+ * @param fd The socket. The engine never closes it; call `remove_socket()`
+ * before closing it yourself.
+ *
+ * @return The slot that identifies the socket in `send()` and events.
+ */
+int uring_engine::add_socket(int fd) {
+    int slot = -1;
+
+    for (size_t i = 0; i < conns.size(); i++) {
+        if (!conns[i].open) {
+            slot = static_cast<int>(i);
+            break;
+        }
+    }
+    if (slot < 0)
+        throw socket_exception(__FILE__, __LINE__,
+                               "uring_engine::add_socket: no free slot", false);
+
+    update_file(slot, fd);
+
+    connection& conn = conns[slot];
+    conn.fd = fd;
+    conn.generation = (conn.generation + 1) & 0xffffff;
+    conn.open = true;
+    conn.recv_armed = false;
+    // A write from the slot's previous socket frees its buffer when it
+    // completes; this socket starts with none.
+    conn.inflight_buf = -1;
+    conn.inflight_off = conn.inflight_len = 0;
+    conn.backlog.clear();
+    conn.backlog_head = 0;
+    arm_recv(slot);
+
+    return slot;
+}
+
+/**
+ * @brief Stop using a socket without reporting an event.
+ *
+ * Queued bytes that have not reached the kernel are dropped.
+ */
+void uring_engine::remove_socket(int slot) {
+    if (slot < 0 || static_cast<size_t>(slot) >= conns.size() ||
+        !conns[slot].open)
+        return;
+
+    connection& conn = conns[slot];
+
+    if (conn.recv_armed) {
+        struct io_uring_sqe* sqe = next_sqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = encode(OP_RECV, conn.generation, slot, 0);
+        sqe->user_data = encode(OP_CANCEL, conn.generation, slot, 0);
+    }
+    conn.open = false;
+    conn.recv_armed = false;
+    // Completions still in flight carry the old generation and are dropped.
+    conn.generation = (conn.generation + 1) & 0xffffff;
+    conn.inflight_buf = -1;
+    conn.backlog.clear();
+    conn.backlog_head = 0;
+    conn.fd = -1;
+    update_file(slot, -1);
+}
+
+/**
+ * @brief Queue bytes for a socket.
+ *
+ * The bytes are copied, so `buf` may be reused at once. Nothing is submitted
+ * until the next `poll()`, which writes each socket's queue in as few
+ * SQEs as the send buffers allow, in order.
+ *
+ * @return false if the slot is not open.
+ */
+bool uring_engine::send(int slot, const void* buf, size_t len) {
+    if (slot < 0 || static_cast<size_t>(slot) >= conns.size() ||
+        !conns[slot].open)
+        return false;
+    if (len == 0) return true;
+
+    connection& conn = conns[slot];
+    const bool was_idle =
+        conn.inflight_buf < 0 && conn.backlog.size() == conn.backlog_head;
+    const char* bytes = static_cast<const char*>(buf);
+
+    conn.backlog.insert(conn.backlog.end(), bytes, bytes + len);
+    if (was_idle) ready_to_write.push_back(slot);
+
+    return true;
+}
+
+/**
+ * @brief Bytes queued for a socket that the kernel has not accepted yet.
+ */
+size_t uring_engine::queued(int slot) const {
+    if (slot < 0 || static_cast<size_t>(slot) >= conns.size()) return 0;
+
+    const connection& conn = conns[slot];
+    size_t bytes = conn.backlog.size() - conn.backlog_head;
+
+    if (conn.inflight_buf >= 0) bytes += conn.inflight_len - conn.inflight_off;
+
+    return bytes;
+}
+
+/**
+ * @brief Submit queued work and report completions.
+ *
+ * Everything queued since the last call goes to the kernel in a single
+ * `io_uring_enter`, which also waits for `wait_nr` completions. With
+ * `wait_nr` 0 and nothing to submit, no syscall is made at all.
+ *
+ * @param on_event Called for every DATA or CLOSED event.
+ * @param wait_nr (default: 1) Completions to wait for.
+ *
+ * @return The number of events delivered.
+ */
+size_t uring_engine::poll(const handler& on_event, unsigned wait_nr) {
+    size_t delivered = 0;
+
+    submit_writes();
+    if (pending > 0 || wait_nr > 0) enter(pending, wait_nr);
+
+    unsigned head = *cq_head;
+    for (;;) {
+        const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) break;
+        while (head != tail) {
+            const struct io_uring_cqe cqe = cqes[head & cq_mask];
+            head++;
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+            totals.completions++;
+            handle(cqe, on_event, delivered);
+        }
+    }
+    __atomic_store_n(&recv_ring->tail, static_cast<uint16_t>(recv_tail),
+                     __ATOMIC_RELEASE);
+
+    return delivered;
+}
+
+struct io_uring_sqe* uring_engine::next_sqe(void) {
+    unsigned tail = *sq_tail;
+
+    if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) > sq_mask) {
+        // Full: hand the batch over and keep going.
+        enter(pending, 0);
+        tail = *sq_tail;
+        if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) > sq_mask)
+            throw socket_exception(__FILE__, __LINE__,
+                                   "uring_engine: submission queue is full",
+                                   false);
+    }
+
+    struct io_uring_sqe* sqe = &sqes[tail & sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    pending++;
+
+    return sqe;
+}
+
+int uring_engine::enter(unsigned to_submit, unsigned wait_nr) {
+    const unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int ret;
+
+    totals.enter_calls++;
+    ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                                   wait_nr, flags, nullptr, 0));
+    if (ret < 0) {
+        // Interrupted, or the CQ needs reaping first: the caller's poll()
+        // reaps and the SQEs stay queued for the next call.
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) return 0;
+        throw socket_exception(
+            __FILE__, __LINE__,
+            string("uring_engine: io_uring_enter failed: ") + strerror(errno));
+    }
+
+    const unsigned consumed = std::min(static_cast<unsigned>(ret), pending);
+    pending -= consumed;
+    totals.submitted += consumed;
+
+    return ret;
+}
+
+void uring_engine::update_file(int slot, int fd) {
+    struct io_uring_files_update update;
+
+    memset(&update, 0, sizeof(update));
+    update.offset = static_cast<uint32_t>(slot);
+    update.fds = reinterpret_cast<uint64_t>(&fd);
+
+    totals.register_calls++;
+    if (0 > sys_register(ring_fd, IORING_REGISTER_FILES_UPDATE, &update, 1))
+        throw socket_exception(
+            __FILE__, __LINE__,
+            string("uring_engine: updating fixed file failed: ") +
+                strerror(errno));
+}
+
+void uring_engine::arm_recv(int slot) {
+    connection& conn = conns[slot];
+    struct io_uring_sqe* sqe = next_sqe();
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = slot;
+    sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->buf_group = 0;
+    sqe->user_data = encode(OP_RECV, conn.generation, slot, 0);
+    conn.recv_armed = true;
+}
+
+void uring_engine::start_write(int slot) {
+    connection& conn = conns[slot];
+
+    if (conn.inflight_buf < 0) {
+        const size_t backlog = conn.backlog.size() - conn.backlog_head;
+        if (backlog == 0 || free_send_bufs.empty()) return;
+
+        const int buf = free_send_bufs.back();
+        free_send_bufs.pop_back();
+
+        // Coalesce as much of the queue as one registered buffer holds.
+        const size_t len = std::min(backlog, cfg.send_buffer_size);
+        memcpy(send_memory + buf * cfg.send_buffer_size,
+               conn.backlog.data() + conn.backlog_head, len);
+        conn.backlog_head += len;
+        if (conn.backlog_head == conn.backlog.size()) {
+            conn.backlog.clear();
+            conn.backlog_head = 0;
+        } else if (conn.backlog_head >= conn.backlog.size() / 2) {
+            conn.backlog.erase(conn.backlog.begin(),
+                               conn.backlog.begin() + conn.backlog_head);
+            conn.backlog_head = 0;
+        }
+
+        conn.inflight_buf = buf;
+        conn.inflight_off = 0;
+        conn.inflight_len = len;
+    }
+
+    struct io_uring_sqe* sqe = next_sqe();
+    sqe->opcode = IORING_OP_WRITE_FIXED;
+    sqe->fd = slot;
+    sqe->flags = IOSQE_FIXED_FILE;
+    sqe->addr = reinterpret_cast<uint64_t>(
+        send_memory + conn.inflight_buf * cfg.send_buffer_size +
+        conn.inflight_off);
+    sqe->len = static_cast<uint32_t>(conn.inflight_len - conn.inflight_off);
+    sqe->off = 0;
+    sqe->buf_index = static_cast<uint16_t>(conn.inflight_buf);
+    sqe->user_data =
+        encode(OP_WRITE, conn.generation, slot, conn.inflight_buf);
+}
+
+// One write in flight per socket keeps its bytes in order: io_uring may
+// otherwise run a later SQE first once an earlier one has to wait.
+void uring_engine::submit_writes(void) {
+    if (ready_to_write.empty()) return;
+
+    std::vector<int> waiting;
+    for (int slot : ready_to_write) {
+        connection& conn = conns[slot];
+        if (!conn.open || conn.inflight_buf >= 0) continue;
+        start_write(slot);
+        // Out of send buffers: try again after writes complete.
+        if (conn.inflight_buf < 0 && conn.backlog.size() > conn.backlog_head)
+            waiting.push_back(slot);
+    }
+    ready_to_write.swap(waiting);
+}
+
+void uring_engine::recycle(uint16_t bid) {
+    // Not recv_ring->bufs: in C++ the header's flex-array wrapper puts that
+    // member at offset 8 instead of 0.
+    struct io_uring_buf* buf =
+        reinterpret_cast<struct io_uring_buf*>(recv_ring) +
+        (recv_tail & recv_mask);
+
+    // bufs[0].resv doubles as the ring tail, so only these fields are set.
+    buf->addr = reinterpret_cast<uint64_t>(recv_memory +
+                                           bid * cfg.recv_buffer_size);
+    buf->len = static_cast<uint32_t>(cfg.recv_buffer_size);
+    buf->bid = bid;
+    recv_tail++;
+}
+
+void uring_engine::close_slot(int slot, int error, const handler& on_event) {
+    if (!conns[slot].open) return;
+
+    remove_socket(slot);
+
+    event ev;
+    ev.kind = event::CLOSED;
+    ev.slot = slot;
+    ev.error = error;
+    ev.data = nullptr;
+    ev.length = 0;
+    on_event(ev);
+}
+
+void uring_engine::handle(const struct io_uring_cqe& cqe,
+                          const handler& on_event, size_t& delivered) {
+    const int slot = slot_of(cqe.user_data);
+    const bool current =
+        static_cast<size_t>(slot) < conns.size() && conns[slot].open &&
+        conns[slot].generation == generation_of(cqe.user_data);
+
+    switch (kind_of(cqe.user_data)) {
+        case OP_RECV: {
+            const bool has_buf = cqe.flags & IORING_CQE_F_BUFFER;
+            const uint16_t bid =
+                static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+
+            if (!current) {
+                if (has_buf) recycle(bid);
+                return;
+            }
+            connection& conn = conns[slot];
+            if (!(cqe.flags & IORING_CQE_F_MORE)) conn.recv_armed = false;
+
+            if (cqe.res > 0) {
+                event ev;
+                ev.kind = event::DATA;
+                ev.slot = slot;
+                ev.error = 0;
+                ev.data = recv_memory + bid * cfg.recv_buffer_size;
+                ev.length = static_cast<size_t>(cqe.res);
+                totals.bytes_received += ev.length;
+                delivered++;
+                on_event(ev);
+                recycle(bid);
+            } else {
+                if (has_buf) recycle(bid);
+                if (cqe.res == 0) {
+                    delivered++;
+                    close_slot(slot, 0, on_event);
+                    return;
+                }
+                if (cqe.res != -ENOBUFS) {
+                    delivered++;
+                    close_slot(slot, -cqe.res, on_event);
+                    return;
+                }
+            }
+            // The kernel ends a multishot receive on overflow or when the
+            // buffer ring ran dry; start another with the buffers returned.
+            if (conns[slot].open && !conns[slot].recv_armed &&
+                conns[slot].generation == generation_of(cqe.user_data)) {
+                __atomic_store_n(&recv_ring->tail,
+                                 static_cast<uint16_t>(recv_tail),
+                                 __ATOMIC_RELEASE);
+                arm_recv(slot);
+            }
+            return;
+        }
+        case OP_WRITE: {
+            const int buf = buf_of(cqe.user_data);
+
+            if (!current) {
+                free_send_bufs.push_back(buf);
+                return;
+            }
+            connection& conn = conns[slot];
+            if (cqe.res < 0) {
+                if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+                    start_write(slot);
+                    return;
+                }
+                conn.inflight_buf = -1;
+                free_send_bufs.push_back(buf);
+                delivered++;
+                close_slot(slot, -cqe.res, on_event);
+                return;
+            }
+            totals.bytes_sent += static_cast<uint64_t>(cqe.res);
+            conn.inflight_off += static_cast<size_t>(cqe.res);
+            if (conn.inflight_off < conn.inflight_len) {
+                start_write(slot);
+                return;
+            }
+            conn.inflight_buf = -1;
+            free_send_bufs.push_back(buf);
+            if (conn.backlog.size() > conn.backlog_head) {
+                start_write(slot);
+                if (conn.inflight_buf < 0) ready_to_write.push_back(slot);
+            }
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+#else  // !LIBSOCKET_HAVE_URING
+
+bool uring_engine::available(void) { return false; }
+
+uring_engine::uring_engine(const params& p) : cfg(p), totals(), ring_fd(-1) {
+    throw socket_exception(__FILE__, __LINE__,
+                           "uring_engine: built without io_uring support",
+                           false);
+}
+
+uring_engine::~uring_engine(void) {}
+
+void uring_engine::release(void) {}
+
+int uring_engine::add_socket(int) { return -1; }
+void uring_engine::remove_socket(int) {}
+bool uring_engine::send(int, const void*, size_t) { return false; }
+size_t uring_engine::queued(int) const { return 0; }
+size_t uring_engine::poll(const handler&, unsigned) { return 0; }
+
+#endif  // LIBSOCKET_HAVE_URING
+
+}  // namespace libsocket
@@ -4,3 +4,4 @@ g++ -lsocket++ -o dgram_over_stream dgram_over_stream.cpp
 g++ -lsocket++ -o framing framing.cpp
 g++ -lsocket++ -o unix_dgram_syslogclient unix_dgram_syslogclient.cpp
 
+g++ -lsocket++ -o uring_bench uring_bench.cpp
@@ -0,0 +1,151 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libsocket/epoll.hpp>
+#include <libsocket/exception.hpp>
+#include <libsocket/inetclientstream.hpp>
+#include <libsocket/inetserverstream.hpp>
+#include <libsocket/uring.hpp>
+
+// Syscalls per message for small sends over loopback TCP, epoll vs io_uring.
+//
+// Usage: uring_bench [messages] [message bytes] [batch] [port]
+//
+// Each round queues `batch` messages on one socket and reads them back on
+// the other in the same thread. The epoll side issues one send() per message
+// and recv() until EAGAIN after every epoll wait; the io_uring side hands a
+// whole round to the kernel in one io_uring_enter. Every counted syscall is
+// one this process makes; `strace -c -f` gives the same totals.
+
+using libsocket::epollset;
+using libsocket::inet_stream;
+using libsocket::inet_stream_server;
+using libsocket::uring_engine;
+
+struct result {
+    uint64_t syscalls;
+    double seconds;
+};
+
+static void report(const char* mode, const result& r, size_t messages) {
+    printf("%-8s %10zu msgs %10llu syscalls %8.4f syscalls/msg %12.0f msgs/s\n",
+           mode, messages, static_cast<unsigned long long>(r.syscalls),
+           static_cast<double>(r.syscalls) / messages, messages / r.seconds);
+}
+
+static result run_epoll(inet_stream& tx, inet_stream& rx, size_t messages,
+                        size_t size, size_t batch) {
+    std::vector<char> payload(size, 'q');
+    std::vector<char> buf(64 * 1024);
+    std::vector<epollset<inet_stream>::ready_event> ready;
+    epollset<inet_stream> set;
+    uint64_t syscalls = 0;
+    size_t sent = 0, received = 0;
+    const size_t total = messages * size;
+
+    fcntl(tx.getfd(), F_SETFL, fcntl(tx.getfd(), F_GETFL) | O_NONBLOCK);
+    fcntl(rx.getfd(), F_SETFL, fcntl(rx.getfd(), F_GETFL) | O_NONBLOCK);
+    set.add_fd(rx, LIBSOCKET_READ);
+
+    auto start = std::chrono::steady_clock::now();
+    while (received < total) {
+        for (size_t i = 0; i < batch && sent < total; i++) {
+            syscalls++;
+            ssize_t n = ::send(tx.getfd(), payload.data(), size, MSG_NOSIGNAL);
+            if (n < 0) break;  // EAGAIN: drain the receiver first
+            sent += static_cast<size_t>(n);
+            if (static_cast<size_t>(n) < size) break;
+        }
+        syscalls++;
+        if (set.wait_into(ready, 1000) == 0) continue;
+        for (;;) {
+            syscalls++;
+            ssize_t n = ::recv(rx.getfd(), buf.data(), buf.size(), 0);
+            if (n <= 0) break;
+            received += static_cast<size_t>(n);
+        }
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    return result{syscalls, elapsed.count()};
+}
+
+static result run_uring(inet_stream& tx, inet_stream& rx, size_t messages,
+                        size_t size, size_t batch) {
+    std::vector<char> payload(size, 'q');
+    uring_engine engine;
+    size_t sent = 0, received = 0;
+    const size_t total = messages * size;
+
+    int tx_slot = engine.add_socket(tx.getfd());
+    int rx_slot = engine.add_socket(rx.getfd());
+    auto on_event = [&](const uring_engine::event& ev) {
+        if (ev.kind == uring_engine::event::CLOSED) {
+            std::cerr << "socket closed: " << ev.error << "\n";
+            exit(1);
+        }
+        if (ev.slot == rx_slot) received += ev.length;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    while (received < total) {
+        for (size_t i = 0; i < batch && sent < total; i++) {
+            engine.send(tx_slot, payload.data(), size);
+            sent += size;
+        }
+        engine.poll(on_event, 1);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    const uring_engine::counters& c = engine.stats();
+    engine.remove_socket(tx_slot);
+    engine.remove_socket(rx_slot);
+
+    return result{c.enter_calls + c.register_calls, elapsed.count()};
+}
+
+int main(int argc, char** argv) {
+    size_t messages = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+    size_t size = argc > 2 ? strtoul(argv[2], nullptr, 10) : 64;
+    size_t batch = argc > 3 ? strtoul(argv[3], nullptr, 10) : 32;
+    unsigned long port = argc > 4 ? strtoul(argv[4], nullptr, 10) : 39871;
+
+    try {
+        for (int pass = 0; pass < 2; pass++) {
+            const bool uring = pass == 1;
+            if (uring && !uring_engine::available()) {
+                printf("io_uring  unavailable here; epoll is the fallback\n");
+                break;
+            }
+
+            // libsocket servers cannot set SO_REUSEADDR, so each pass gets
+            // its own port rather than waiting out TIME_WAIT.
+            const std::string bind_port = std::to_string(port + pass);
+            inet_stream_server server("127.0.0.1", bind_port, LIBSOCKET_IPv4);
+            inet_stream tx("127.0.0.1", bind_port, LIBSOCKET_IPv4);
+            std::unique_ptr<inet_stream> rx = server.accept2();
+
+            if (uring)
+                report("io_uring", run_uring(tx, *rx, messages, size, batch),
+                       messages);
+            else
+                report("epoll", run_epoll(tx, *rx, messages, size, batch),
+                       messages);
+        }
+    } catch (const libsocket::socket_exception& exc) {
+        std::cerr << exc.mesg << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -6,12 +6,14 @@
 #include "socket.hpp"
 #include "streamclient.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include <netinet/ip.h>
 #include <netinet/tcp.h>
+#include <sys/uio.h>
 
 /**
  * @file dgramoverstream.hpp
@@ -64,6 +66,11 @@ namespace libsocket {
  * coming after it. The maximum supported frame size is 2GiB. Schema: [4* u8,
  * *u8]
  *
+ * By default every rcvmsg() reads exactly the bytes of one frame, which costs
+ * at least two `recv` calls per message. After enable_read_ahead(), the
+ * stream is read in large chunks and frames are parsed out of a buffer;
+ * rcvmsgs() then returns every complete frame buffered so far in one call.
+ *
  * By default, Nagle's algorithm is disabled on the inner stream. This is
  * necessary so that a message frame is sent as soon as it is written to the
  * socket. If you send a lot of small messages and can accept smaller delays,
@@ -84,7 +91,14 @@ class dgram_over_stream {
     dgram_over_stream(stream_client_socket inner);
     dgram_over_stream(std::unique_ptr<stream_client_socket> inner);
 
+    /// A frame: returned by rcvmsgs(), or one message for sndmsgs().
+    struct frame_view {
+        const char* data;
+        size_t size;
+    };
+
     void enable_nagle(bool enable) const;
+    void enable_read_ahead(size_t capacity = DEFAULT_READ_AHEAD);
 
     ssize_t sndmsg(const void* buf, size_t len);
     ssize_t rcvmsg(void* dst, size_t len);
@@ -95,16 +109,36 @@ class dgram_over_stream {
     ssize_t sndmsg(const std::vector<uint8_t>& msg);
     ssize_t rcvmsg(std::vector<uint8_t>* dst);
 
+    size_t rcvmsgs(std::vector<frame_view>* frames,
+                   size_t max_frames = SIZE_MAX);
+    size_t sndmsgs(const frame_view* frames, size_t count);
+    size_t sndmsgs(const std::vector<frame_view>& frames);
+
    private:
     static const size_t RECV_BUF_SIZE = 256;
+    static const size_t DEFAULT_READ_AHEAD = 64 * 1024;
 
     // The underlying stream.
     std::unique_ptr<stream_client_socket> inner;
     char prefix_buffer[FRAMING_PREFIX_LENGTH];
     char RECV_BUF[RECV_BUF_SIZE];
 
-    ssize_t receive_bytes(size_t);
+    // Read-ahead buffer; empty unless enable_read_ahead() was called. Bytes
+    // [read_head, read_tail) have been received but not consumed.
+    std::vector<char> read_ahead;
+    size_t read_head;
+    size_t read_tail;
+
+    size_t receive_into(char* dst, size_t n);
+    void discard(size_t n);
     uint32_t receive_header(void);
+    size_t recv_direct(char* dst, size_t n);
+    size_t read_some(void);
+    size_t send_gathered(struct iovec* iov, size_t count);
+
+    // Scratch for sndmsgs(): length prefixes and the iovec array.
+    std::vector<char> send_prefixes;
+    std::vector<struct iovec> send_iov;
 };
 }  // namespace libsocket
 
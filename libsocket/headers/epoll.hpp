@@ -35,8 +35,11 @@
  * the modern epoll API of Linux kernels newer than 2.6.
  */
 
+#include <cerrno>
+#include <cstdint>
 #include <cstring>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include <unistd.h>
@@ -47,6 +50,21 @@
 
 using std::vector;
 
+/*
+ * Interest flags for epollset, combined with LIBSOCKET_READ (1) and
+ * LIBSOCKET_WRITE (2) in the `method` argument of add_fd()/modify_fd().
+ */
+/// Edge-triggered notification (`EPOLLET`).
+#define LIBSOCKET_EDGE 4
+/// Disable the socket after one event until modify_fd() re-arms it
+/// (`EPOLLONESHOT`).
+#define LIBSOCKET_ONESHOT 8
+/// Wake only one of several epollsets waiting on the same socket
+/// (`EPOLLEXCLUSIVE`, Linux 4.5+). Only valid in add_fd().
+#define LIBSOCKET_EXCLUSIVE 16
+/// Report a peer shutdown of its writing half (`EPOLLRDHUP`).
+#define LIBSOCKET_RDHUP 32
+
 namespace libsocket {
 /**
  * @addtogroup libsocketplusplus
@@ -72,22 +90,53 @@ class epollset {
     typedef std::pair<std::vector<SocketT*>, std::vector<SocketT*> >
         ready_socks;
 
+    /// One entry of `wait_into()`: the socket, the user pointer given to
+    /// add_fd() and the raw `epoll_event.events` mask.
+    struct ready_event {
+        SocketT* sock;
+        void* data;
+        uint32_t events;
+
+        bool readable(void) const { return events & EPOLLIN; }
+        bool writable(void) const { return events & EPOLLOUT; }
+        /// Hangup, error or (with LIBSOCKET_RDHUP) peer shutdown.
+        bool closed(void) const {
+            return events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP);
+        }
+    };
+
     epollset(unsigned int maxevents = 128);
     epollset(const epollset&) = delete;
     epollset(epollset&&);
     ~epollset(void);
 
-    void add_fd(SocketT& sock, int method);
+    void add_fd(SocketT& sock, int method, void* data = nullptr);
+    void modify_fd(const SocketT& sock, int method);
     void del_fd(const SocketT& sock);
     ready_socks wait(int timeout = -1);
+    size_t wait_into(std::vector<ready_event>& ready, int timeout = -1);
 
    private:
+    /// What `epoll_event.data.ptr` points to for a registered socket.
+    struct registration {
+        SocketT* sock;
+        void* data;
+    };
+
+    static uint32_t event_mask(int method);
+    void collect_garbage(void);
+
     /// maxevents is passed to `epoll_wait`.
     unsigned int maxevents;
     /// The file descriptor used by the epoll API
     int epollfd;
     /// Array of structures, filled on the return of `epoll_wait`.
     struct epoll_event* events;
+    /// Registrations by file descriptor.
+    std::unordered_map<int, std::unique_ptr<registration> > registered;
+    /// Registrations removed by del_fd(). Events already returned for them
+    /// may still be handled, so they are freed on the next wait.
+    std::vector<std::unique_ptr<registration> > retired;
 };
 
 /**
@@ -118,6 +167,8 @@ epollset<SocketT>::epollset(epollset&& new_epollset) {
     maxevents = new_epollset.maxevents;
     epollfd = new_epollset.epollfd;
     events = new_epollset.events;
+    registered = std::move(new_epollset.registered);
+    retired = std::move(new_epollset.retired);
 
     new_epollset.epollfd = -1;
     new_epollset.events = nullptr;
@@ -129,25 +180,69 @@ epollset<SocketT>::~epollset(void) {
     delete[] events;
 }
 
+template <typename SocketT>
+uint32_t epollset<SocketT>::event_mask(int method) {
+    uint32_t mask = 0;
+
+    if (method & LIBSOCKET_READ) mask |= EPOLLIN;
+    if (method & LIBSOCKET_WRITE) mask |= EPOLLOUT;
+    if (method & LIBSOCKET_EDGE) mask |= EPOLLET;
+    if (method & LIBSOCKET_ONESHOT) mask |= EPOLLONESHOT;
+    if (method & LIBSOCKET_EXCLUSIVE) mask |= EPOLLEXCLUSIVE;
+    if (method & LIBSOCKET_RDHUP) mask |= EPOLLRDHUP;
+
+    return mask;
+}
+
 /**
  * @brief Add a socket to an `epollset`.
  *
  * @param sock The socket to be added.
- * @param method Any combination of `LIBSOCKET_READ` and `LIBSOCKET_WRITE`.
+ * @param method Any combination of `LIBSOCKET_READ` and `LIBSOCKET_WRITE`,
+ * optionally with `LIBSOCKET_EDGE`, `LIBSOCKET_ONESHOT`,
+ * `LIBSOCKET_EXCLUSIVE` and `LIBSOCKET_RDHUP`.
+ * @param data (default: nullptr) Returned with every `ready_event` of this
+ * socket from `wait_into()`, e.g. a pointer to per-connection state.
  */
 template <typename SocketT>
-void epollset<SocketT>::add_fd(SocketT& sock, int method) {
+void epollset<SocketT>::add_fd(SocketT& sock, int method, void* data) {
     struct epoll_event new_event;
+    std::unique_ptr<registration> reg(new registration{&sock, data});
+
+    new_event.data.ptr = reg.get();
+    new_event.events = event_mask(method);
+
+    if (0 > epoll_ctl(epollfd, EPOLL_CTL_ADD, sock.getfd(), &new_event))
+        throw socket_exception(__FILE__, __LINE__,
+                               string("epoll_ctl failed: ") + strerror(errno));
+
+    registered[sock.getfd()] = std::move(reg);
+}
+
+/**
+ * @brief Change the events a socket is watched for, in place.
+ *
+ * Replaces the whole interest set, so it is also how a `LIBSOCKET_ONESHOT`
+ * socket is re-armed. The user pointer given to add_fd() is kept. Linux
+ * rejects `LIBSOCKET_EXCLUSIVE` here.
+ *
+ * @param sock A socket previously passed to add_fd().
+ * @param method The new combination of flags, as for add_fd().
+ */
+template <typename SocketT>
+void epollset<SocketT>::modify_fd(const SocketT& sock, int method) {
+    auto it = registered.find(sock.getfd());
 
-    new_event.data.ptr = 0;  // ptr is the largest field (8 bytes on 64bit)
-    new_event.events = 0;
+    if (it == registered.end())
+        throw socket_exception(__FILE__, __LINE__,
+                               "modify_fd: socket is not in this epollset");
 
-    if (method & LIBSOCKET_READ) new_event.events |= EPOLLIN;
-    if (method & LIBSOCKET_WRITE) new_event.events |= EPOLLOUT;
+    struct epoll_event new_event;
 
-    new_event.data.ptr = &sock;
+    new_event.data.ptr = it->second.get();
+    new_event.events = event_mask(method);
 
-    if (0 > epoll_ctl(epollfd, EPOLL_CTL_ADD, sock.getfd(), &new_event))
+    if (0 > epoll_ctl(epollfd, EPOLL_CTL_MOD, sock.getfd(), &new_event))
         throw socket_exception(__FILE__, __LINE__,
                                string("epoll_ctl failed: ") + strerror(errno));
 }
@@ -155,6 +250,9 @@ void epollset<SocketT>::add_fd(SocketT& sock, int method) {
 /**
  * @brief Remove a file descriptor from an epoll set.
  *
+ * Events for `sock` already returned by the current `wait_into()` stay
+ * valid until the next wait.
+ *
  * @param sock The socket to remove.
  */
 template <typename SocketT>
@@ -162,6 +260,18 @@ void epollset<SocketT>::del_fd(const SocketT& sock) {
     if (0 > epoll_ctl(epollfd, EPOLL_CTL_DEL, sock.getfd(), nullptr))
         throw socket_exception(__FILE__, __LINE__,
                                string("epoll_ctl failed: ") + strerror(errno));
+
+    auto it = registered.find(sock.getfd());
+
+    if (it != registered.end()) {
+        retired.push_back(std::move(it->second));
+        registered.erase(it);
+    }
+}
+
+template <typename SocketT>
+void epollset<SocketT>::collect_garbage(void) {
+    retired.clear();
 }
 
 /**
@@ -190,19 +300,60 @@ typename epollset<SocketT>::ready_socks epollset<SocketT>::wait(int timeout) {
     int nfds;
     ready_socks ready;
 
+    collect_garbage();
+
     if (0 > (nfds = epoll_wait(epollfd, events, maxevents, timeout)))
         throw socket_exception(__FILE__, __LINE__,
                                string("epoll_wait failed: ") + strerror(errno));
 
     for (int i = 0; i < nfds; i++) {
-        if (events[i].events & EPOLLIN)
-            ready.first.push_back(static_cast<SocketT*>(events[i].data.ptr));
-        if (events[i].events & EPOLLOUT)
-            ready.second.push_back(static_cast<SocketT*>(events[i].data.ptr));
+        SocketT* sock = static_cast<registration*>(events[i].data.ptr)->sock;
+
+        if (events[i].events & EPOLLIN) ready.first.push_back(sock);
+        if (events[i].events & EPOLLOUT) ready.second.push_back(sock);
     }
 
     return ready;
 }
 
+/**
+ * @brief Wait for events, filling a caller-owned vector.
+ *
+ * Unlike `wait()`, nothing is allocated once `ready` has grown to
+ * `maxevents`: the vector is cleared and refilled, keeping its capacity, so
+ * a server loop can reuse one vector for its whole lifetime. Each entry
+ * carries the socket, its add_fd() user pointer and the full event mask,
+ * including hangups.
+ *
+ * @param ready Receives one `ready_event` per ready socket.
+ * @param timeout (default: -1) As for `wait()`.
+ *
+ * @return The number of entries in `ready`; 0 on timeout or when a signal
+ * interrupted the wait.
+ */
+template <typename SocketT>
+size_t epollset<SocketT>::wait_into(std::vector<ready_event>& ready,
+                                    int timeout) {
+    int nfds;
+
+    collect_garbage();
+    ready.clear();
+
+    if (0 > (nfds = epoll_wait(epollfd, events, maxevents, timeout))) {
+        if (errno == EINTR) return 0;
+        throw socket_exception(__FILE__, __LINE__,
+                               string("epoll_wait failed: ") + strerror(errno));
+    }
+
+    for (int i = 0; i < nfds; i++) {
+        const registration* reg =
+            static_cast<const registration*>(events[i].data.ptr);
+
+        ready.push_back(ready_event{reg->sock, reg->data, events[i].events});
+    }
+
+    return ready.size();
+}
+
 }  // namespace libsocket
 #endif
@@ -7,10 +7,14 @@
 
 #include "inetbase.hpp"
 
+#include <netinet/in.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#include <vector>
 
 /**
  * @file inetdgram.hpp
@@ -50,6 +54,33 @@ using std::string;
  * @addtogroup libsocketplusplus
  * @{
  */
+/**
+ * @brief One datagram of a batched send or receive
+ *
+ * For `sndmmsg()`, `data` and `len` are the payload and `peer`/`peerlen` the
+ * destination; a `peerlen` of 0 sends to the connected peer. For `rcvmmsg()`,
+ * `data` and `len` are a buffer and its capacity; on return `len` is the
+ * number of bytes received and `peer` holds the sender's address.
+ */
+struct dgram_message {
+    void* data;
+    size_t len;
+    struct sockaddr_storage peer;
+    socklen_t peerlen;
+    /// Set by `rcvmmsg()` when GRO merged several datagrams into `data`: each
+    /// is `segment_size` bytes, the last one possibly shorter. 0 otherwise.
+    uint16_t segment_size;
+    /// Set by `rcvmmsg()` when the datagram did not fit into `data`.
+    bool truncated;
+
+    dgram_message()
+        : data(nullptr), len(0), peer(), peerlen(0), segment_size(0),
+          truncated(false) {}
+    dgram_message(void* d, size_t l)
+        : data(d), len(l), peer(), peerlen(0), segment_size(0),
+          truncated(false) {}
+};
+
 /**
  *
  * @brief Base class for UDP/IP sockets
@@ -78,6 +109,37 @@ class inet_dgram : public inet_socket {
 
     ssize_t rcvfrom(string& buf, string& srchost, string& srcport,
                     int rcvfrom_flags = 0, bool numeric = false);
+
+    // Batched I/O
+    int sndmmsg(dgram_message* msgs, size_t count, int flags = 0);
+    int rcvmmsg(dgram_message* msgs, size_t count, int flags = 0);
+    // Non-throwing forms for hot paths: -1 with errno set on any failure.
+    int try_sndmmsg(dgram_message* msgs, size_t count, int flags = 0) noexcept;
+    int try_rcvmmsg(dgram_message* msgs, size_t count, int flags = 0) noexcept;
+    ssize_t sndsegments(const void* buf, size_t len, size_t segment_size,
+                        const struct sockaddr* peer, socklen_t peerlen,
+                        int flags = 0);
+
+    bool enable_gro(bool enable = true);
+    socklen_t resolve(const string& host, const string& port,
+                      struct sockaddr_storage* addr) const;
+
+   private:
+    ssize_t send_segmented(const void* buf, size_t len, size_t segment_size,
+                           const struct sockaddr* peer, socklen_t peerlen,
+                           int flags);
+
+    // Scratch for the batched calls, reused so a batch allocates nothing.
+    // Send and receive keep their own, so one thread may send while another
+    // receives.
+    std::vector<struct mmsghdr> tx_mmsg;
+    std::vector<struct iovec> tx_iov;
+    std::vector<dgram_message> tx_segments;
+    std::vector<struct mmsghdr> rx_mmsg;
+    std::vector<struct iovec> rx_iov;
+    std::vector<char> rx_cmsg;
+    bool gro_enabled = false;
+    bool gso_unsupported = false;
 };
 /**
  * @}
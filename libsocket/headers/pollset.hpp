@@ -0,0 +1,585 @@
+#ifndef LIBSOCKET_POLLSET_H_6D2A0F9C3B7E4A1D8C5F2E9B07A4D613
+#define LIBSOCKET_POLLSET_H_6D2A0F9C3B7E4A1D8C5F2E9B07A4D613
+
+
+/*
+   The committers of the libsocket project, all rights reserved
+   (c) 2014, dermesser <lbo@spheniscida.de>
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS” AND ANY
+   EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/**
+ * @file pollset.hpp
+ * @brief Persistent readiness multiplexer with one interface on every
+ * platform.
+ *
+ * `pollset` keeps its interest set in the kernel, or in a persistent
+ * `pollfd` array where there is no better API: sockets are added, changed
+ * and removed one at a time, and `wait_into()` refills a caller-owned
+ * vector with only the ready sockets. The backend is chosen at compile
+ * time: epoll on Linux, kqueue on macOS and the BSDs, poll(2) elsewhere.
+ * Define `LIBSOCKET_POLLSET_POLL` to force the poll(2) backend.
+ *
+ * Unlike `selectset`, nothing is rebuilt or allocated per wait once the
+ * result vector has grown, and lookups are by descriptor, not by scan.
+ */
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+#if !defined(LIBSOCKET_POLLSET_POLL) && defined(__linux__)
+#define LIBSOCKET_POLLSET_EPOLL 1
+#include <sys/epoll.h>
+#elif !defined(LIBSOCKET_POLLSET_POLL) &&                             \
+    (defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || \
+     defined(__NetBSD__) || defined(__DragonFly__))
+#define LIBSOCKET_POLLSET_KQUEUE 1
+#include <sys/event.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#else
+#ifndef LIBSOCKET_POLLSET_POLL
+#define LIBSOCKET_POLLSET_POLL 1
+#endif
+#include <poll.h>
+#endif
+
+#include "exception.hpp"
+#include "socket.hpp"
+
+namespace libsocket {
+/**
+ * @addtogroup libsocketplusplus
+ * @{
+ */
+
+/**
+ * @brief Readiness multiplexer over epoll, kqueue or a persistent poll(2)
+ * array, behind one interface.
+ *
+ * `method` is `LIBSOCKET_READ`, `LIBSOCKET_WRITE` or both. Notification is
+ * level-triggered on every backend. Each registration carries a user
+ * pointer that comes back with its events, so a server loop needs no map
+ * of its own.
+ *
+ * Not thread-safe: one thread owns a pollset.
+ */
+template <typename SocketT>
+class pollset {
+   public:
+    /// One entry of `wait_into()`. `events` is a combination of
+    /// `LIBSOCKET_READ`, `LIBSOCKET_WRITE` and `closed_event`.
+    struct ready_event {
+        SocketT* sock;
+        void* data;
+        int events;
+
+        bool readable(void) const { return events & LIBSOCKET_READ; }
+        bool writable(void) const { return events & LIBSOCKET_WRITE; }
+        /// Hangup, error or end of file.
+        bool closed(void) const { return events & closed_event; }
+    };
+
+    /// Set in `ready_event::events` on a hangup, error or end of file.
+    static const int closed_event = 4;
+
+    pollset(unsigned int maxevents = 128);
+    pollset(const pollset&) = delete;
+    pollset& operator=(const pollset&) = delete;
+    ~pollset(void);
+
+    void add_fd(SocketT& sock, int method, void* data = nullptr);
+    void modify_fd(const SocketT& sock, int method);
+    void del_fd(const SocketT& sock);
+    size_t wait_into(std::vector<ready_event>& ready, int timeout = -1);
+
+    /// Number of registered sockets.
+    size_t size(void) const { return registered.size(); }
+
+   private:
+    struct registration {
+        SocketT* sock;
+        void* data;
+        int method;
+        /// poll(2) backend: index of this socket's entry in `fds`.
+        size_t slot;
+    };
+
+    registration& find(const SocketT& sock, const char* call);
+    [[noreturn]] static void fail(const char* call);
+
+    unsigned int maxevents;
+    /// Registrations by descriptor.
+    std::unordered_map<int, std::unique_ptr<registration> > registered;
+    /// Registrations removed by del_fd(). Events already returned for them
+    /// may still be handled, so they are freed on the next wait.
+    std::vector<std::unique_ptr<registration> > retired;
+
+#if defined(LIBSOCKET_POLLSET_EPOLL)
+    int kernelfd;
+    std::vector<struct epoll_event> events;
+    static uint32_t event_mask(int method);
+#elif defined(LIBSOCKET_POLLSET_KQUEUE)
+    int kernelfd;
+    std::vector<struct kevent> events;
+    void apply(int fd, registration* reg, int before, int after);
+#else
+    /// The persistent poll array; removals swap the last entry in.
+    std::vector<struct pollfd> fds;
+    /// `slots[i]` is the registration of `fds[i]`.
+    std::vector<registration*> slots;
+    static short event_mask(int method);
+#endif
+};
+
+/**
+ * @}
+ */
+
+template <typename SocketT>
+void pollset<SocketT>::fail(const char* call) {
+    throw socket_exception(__FILE__, __LINE__,
+                           string(call) + " failed: " + strerror(errno));
+}
+
+template <typename SocketT>
+typename pollset<SocketT>::registration& pollset<SocketT>::find(
+    const SocketT& sock, const char* call) {
+    auto it = registered.find(sock.getfd());
+
+    if (it == registered.end())
+        throw socket_exception(
+            __FILE__, __LINE__,
+            string(call) + ": socket is not in this pollset", false);
+
+    return *it->second;
+}
+
+#if defined(LIBSOCKET_POLLSET_EPOLL)
+
+/**
+ * @brief Construct a pollset
+ *
+ * @param maxevs Most events one `wait_into()` returns. Default is 128.
+ */
+template <typename SocketT>
+pollset<SocketT>::pollset(unsigned int maxevs)
+    : maxevents(maxevs ? maxevs : 1), events(maxevents) {
+    if (0 > (kernelfd = epoll_create1(EPOLL_CLOEXEC))) fail("epoll_create1");
+}
+
+template <typename SocketT>
+pollset<SocketT>::~pollset(void) {
+    close(kernelfd);
+}
+
+template <typename SocketT>
+uint32_t pollset<SocketT>::event_mask(int method) {
+    uint32_t mask = 0;
+
+    if (method & LIBSOCKET_READ) mask |= EPOLLIN | EPOLLRDHUP;
+    if (method & LIBSOCKET_WRITE) mask |= EPOLLOUT;
+
+    return mask;
+}
+
+/**
+ * @brief Watch a socket.
+ *
+ * @param sock The socket; it must stay alive while registered.
+ * @param method `LIBSOCKET_READ`, `LIBSOCKET_WRITE` or both.
+ * @param data (default: nullptr) Returned with every event of `sock`.
+ */
+template <typename SocketT>
+void pollset<SocketT>::add_fd(SocketT& sock, int method, void* data) {
+    std::unique_ptr<registration> reg(
+        new registration{&sock, data, method, 0});
+    struct epoll_event ev;
+
+    ev.data.ptr = reg.get();
+    ev.events = event_mask(method);
+
+    if (0 > epoll_ctl(kernelfd, EPOLL_CTL_ADD, sock.getfd(), &ev))
+        fail("epoll_ctl");
+
+    registered[sock.getfd()] = std::move(reg);
+}
+
+/**
+ * @brief Replace the events a registered socket is watched for.
+ */
+template <typename SocketT>
+void pollset<SocketT>::modify_fd(const SocketT& sock, int method) {
+    registration& reg = find(sock, "modify_fd");
+    struct epoll_event ev;
+
+    ev.data.ptr = &reg;
+    ev.events = event_mask(method);
+
+    if (0 > epoll_ctl(kernelfd, EPOLL_CTL_MOD, sock.getfd(), &ev))
+        fail("epoll_ctl");
+
+    reg.method = method;
+}
+
+/**
+ * @brief Stop watching a socket.
+ *
+ * Events for `sock` already returned by the current `wait_into()` stay
+ * valid until the next wait.
+ */
+template <typename SocketT>
+void pollset<SocketT>::del_fd(const SocketT& sock) {
+    find(sock, "del_fd");
+
+    if (0 > epoll_ctl(kernelfd, EPOLL_CTL_DEL, sock.getfd(), nullptr))
+        fail("epoll_ctl");
+
+    auto it = registered.find(sock.getfd());
+    retired.push_back(std::move(it->second));
+    registered.erase(it);
+}
+
+/**
+ * @brief Wait for events, filling a caller-owned vector.
+ *
+ * `ready` is cleared and refilled, keeping its capacity, so one vector can
+ * serve a loop for its whole lifetime.
+ *
+ * @param ready Receives one `ready_event` per ready socket.
+ * @param timeout (default: -1) Milliseconds to wait; -1 waits
+ * indefinitely, 0 only polls.
+ *
+ * @return The number of entries in `ready`; 0 on timeout or when a signal
+ * interrupted the wait.
+ */
+template <typename SocketT>
+size_t pollset<SocketT>::wait_into(std::vector<ready_event>& ready,
+                                   int timeout) {
+    retired.clear();
+    ready.clear();
+
+    const int n = epoll_wait(kernelfd, events.data(),
+                             static_cast<int>(maxevents), timeout);
+
+    if (n < 0) {
+        if (errno == EINTR) return 0;
+        fail("epoll_wait");
+    }
+
+    for (int i = 0; i < n; i++) {
+        const registration* reg =
+            static_cast<const registration*>(events[i].data.ptr);
+        const uint32_t mask = events[i].events;
+        int flags = 0;
+
+        if (mask & EPOLLIN) flags |= LIBSOCKET_READ;
+        if (mask & EPOLLOUT) flags |= LIBSOCKET_WRITE;
+        if (mask & (EPOLLHUP | EPOLLERR | EPOLLRDHUP)) flags |= closed_event;
+
+        ready.push_back(ready_event{reg->sock, reg->data, flags});
+    }
+
+    return ready.size();
+}
+
+#elif defined(LIBSOCKET_POLLSET_KQUEUE)
+
+/**
+ * @brief Construct a pollset
+ *
+ * @param maxevs Most events one `wait_into()` returns. Default is 128. A
+ * socket watched for both directions may take two of them.
+ */
+template <typename SocketT>
+pollset<SocketT>::pollset(unsigned int maxevs)
+    : maxevents(maxevs ? maxevs : 1), events(maxevents) {
+    if (0 > (kernelfd = kqueue())) fail("kqueue");
+}
+
+template <typename SocketT>
+pollset<SocketT>::~pollset(void) {
+    close(kernelfd);
+}
+
+// kqueue keeps one filter per direction: add the new ones, delete the
+// dropped ones, in one kevent() call.
+template <typename SocketT>
+void pollset<SocketT>::apply(int fd, registration* reg, int before,
+                             int after) {
+    struct kevent changes[2];
+    int count = 0;
+    const int directions[2] = {LIBSOCKET_READ, LIBSOCKET_WRITE};
+    const short filters[2] = {EVFILT_READ, EVFILT_WRITE};
+
+    for (int i = 0; i < 2; i++) {
+        const bool was = before & directions[i];
+        const bool is = after & directions[i];
+
+        if (was == is) continue;
+        EV_SET(&changes[count], fd, filters[i], is ? EV_ADD : EV_DELETE, 0,
+               0, reg);
+        count++;
+    }
+
+    if (count > 0 && 0 > kevent(kernelfd, changes, count, nullptr, 0, nullptr))
+        fail("kevent");
+}
+
+/**
+ * @brief Watch a socket.
+ *
+ * @param sock The socket; it must stay alive while registered.
+ * @param method `LIBSOCKET_READ`, `LIBSOCKET_WRITE` or both.
+ * @param data (default: nullptr) Returned with every event of `sock`.
+ */
+template <typename SocketT>
+void pollset<SocketT>::add_fd(SocketT& sock, int method, void* data) {
+    std::unique_ptr<registration> reg(
+        new registration{&sock, data, method, 0});
+
+    apply(sock.getfd(), reg.get(), 0, method);
+    registered[sock.getfd()] = std::move(reg);
+}
+
+/**
+ * @brief Replace the events a registered socket is watched for.
+ */
+template <typename SocketT>
+void pollset<SocketT>::modify_fd(const SocketT& sock, int method) {
+    registration& reg = find(sock, "modify_fd");
+
+    apply(sock.getfd(), &reg, reg.method, method);
+    reg.method = method;
+}
+
+/**
+ * @brief Stop watching a socket.
+ *
+ * Events for `sock` already returned by the current `wait_into()` stay
+ * valid until the next wait.
+ */
+template <typename SocketT>
+void pollset<SocketT>::del_fd(const SocketT& sock) {
+    registration& reg = find(sock, "del_fd");
+
+    apply(sock.getfd(), &reg, reg.method, 0);
+
+    auto it = registered.find(sock.getfd());
+    retired.push_back(std::move(it->second));
+    registered.erase(it);
+}
+
+/**
+ * @brief Wait for events, filling a caller-owned vector.
+ *
+ * `ready` is cleared and refilled, keeping its capacity, so one vector can
+ * serve a loop for its whole lifetime. A socket ready in both directions
+ * gets one entry per direction.
+ *
+ * @param ready Receives one `ready_event` per ready filter.
+ * @param timeout (default: -1) Milliseconds to wait; -1 waits
+ * indefinitely, 0 only polls.
+ *
+ * @return The number of entries in `ready`; 0 on timeout or when a signal
+ * interrupted the wait.
+ */
+template <typename SocketT>
+size_t pollset<SocketT>::wait_into(std::vector<ready_event>& ready,
+                                   int timeout) {
+    struct timespec ts;
+    struct timespec* tsp = nullptr;
+
+    retired.clear();
+    ready.clear();
+
+    if (timeout >= 0) {
+        ts.tv_sec = timeout / 1000;
+        ts.tv_nsec = (timeout % 1000) * 1000000L;
+        tsp = &ts;
+    }
+
+    const int n = kevent(kernelfd, nullptr, 0, events.data(),
+                         static_cast<int>(maxevents), tsp);
+
+    if (n < 0) {
+        if (errno == EINTR) return 0;
+        fail("kevent");
+    }
+
+    for (int i = 0; i < n; i++) {
+        const struct kevent& ev = events[i];
+        const registration* reg = static_cast<const registration*>(ev.udata);
+        int flags = ev.filter == EVFILT_WRITE ? LIBSOCKET_WRITE : LIBSOCKET_READ;
+
+        if (ev.flags & (EV_EOF | EV_ERROR)) flags |= closed_event;
+
+        ready.push_back(ready_event{reg->sock, reg->data, flags});
+    }
+
+    return ready.size();
+}
+
+#else
+
+/**
+ * @brief Construct a pollset
+ *
+ * @param maxevs Most events one `wait_into()` returns. Default is 128.
+ */
+template <typename SocketT>
+pollset<SocketT>::pollset(unsigned int maxevs)
+    : maxevents(maxevs ? maxevs : 1) {}
+
+template <typename SocketT>
+pollset<SocketT>::~pollset(void) {}
+
+template <typename SocketT>
+short pollset<SocketT>::event_mask(int method) {
+    short mask = 0;
+
+    if (method & LIBSOCKET_READ) mask |= POLLIN;
+    if (method & LIBSOCKET_WRITE) mask |= POLLOUT;
+
+    return mask;
+}
+
+/**
+ * @brief Watch a socket.
+ *
+ * @param sock The socket; it must stay alive while registered.
+ * @param method `LIBSOCKET_READ`, `LIBSOCKET_WRITE` or both.
+ * @param data (default: nullptr) Returned with every event of `sock`.
+ */
+template <typename SocketT>
+void pollset<SocketT>::add_fd(SocketT& sock, int method, void* data) {
+    const int fd = sock.getfd();
+
+    if (registered.count(fd))
+        throw socket_exception(__FILE__, __LINE__,
+                               "add_fd: socket is already in this pollset",
+                               false);
+
+    std::unique_ptr<registration> reg(
+        new registration{&sock, data, method, fds.size()});
+    struct pollfd entry;
+
+    entry.fd = fd;
+    entry.events = event_mask(method);
+    entry.revents = 0;
+    fds.push_back(entry);
+    slots.push_back(reg.get());
+    registered[fd] = std::move(reg);
+}
+
+/**
+ * @brief Replace the events a registered socket is watched for.
+ */
+template <typename SocketT>
+void pollset<SocketT>::modify_fd(const SocketT& sock, int method) {
+    registration& reg = find(sock, "modify_fd");
+
+    fds[reg.slot].events = event_mask(method);
+    reg.method = method;
+}
+
+/**
+ * @brief Stop watching a socket.
+ *
+ * The last entry of the poll array takes its place. Events for `sock`
+ * already returned by the current `wait_into()` stay valid until the next
+ * wait.
+ */
+template <typename SocketT>
+void pollset<SocketT>::del_fd(const SocketT& sock) {
+    registration& reg = find(sock, "del_fd");
+    const size_t slot = reg.slot;
+
+    fds[slot] = fds.back();
+    slots[slot] = slots.back();
+    slots[slot]->slot = slot;
+    fds.pop_back();
+    slots.pop_back();
+
+    auto it = registered.find(sock.getfd());
+    retired.push_back(std::move(it->second));
+    registered.erase(it);
+}
+
+/**
+ * @brief Wait for events, filling a caller-owned vector.
+ *
+ * `ready` is cleared and refilled, keeping its capacity, so one vector can
+ * serve a loop for its whole lifetime. The scan stops once every ready
+ * descriptor poll(2) counted has been reported.
+ *
+ * @param ready Receives one `ready_event` per ready socket.
+ * @param timeout (default: -1) Milliseconds to wait; -1 waits
+ * indefinitely, 0 only polls.
+ *
+ * @return The number of entries in `ready`; 0 on timeout or when a signal
+ * interrupted the wait.
+ */
+template <typename SocketT>
+size_t pollset<SocketT>::wait_into(std::vector<ready_event>& ready,
+                                   int timeout) {
+    retired.clear();
+    ready.clear();
+
+    int n = ::poll(fds.data(), static_cast<nfds_t>(fds.size()), timeout);
+
+    if (n < 0) {
+        if (errno == EINTR) return 0;
+        fail("poll");
+    }
+
+    for (size_t i = 0; i < fds.size() && n > 0; i++) {
+        const short revents = fds[i].revents;
+
+        if (revents == 0) continue;
+        n--;
+        if (ready.size() == maxevents) continue;
+
+        int flags = 0;
+
+        if (revents & POLLIN) flags |= LIBSOCKET_READ;
+        if (revents & POLLOUT) flags |= LIBSOCKET_WRITE;
+        if (revents & (POLLHUP | POLLERR | POLLNVAL)) flags |= closed_event;
+
+        ready.push_back(ready_event{slots[i]->sock, slots[i]->data, flags});
+    }
+
+    return ready.size();
+}
+
+#endif
+
+}  // namespace libsocket
+#endif
@@ -65,6 +65,10 @@ class stream_client_socket : public virtual socket {
     ssize_t snd(const void* buf, size_t len, int flags = 0);  // flags: send()
     ssize_t rcv(void* buf, size_t len, int flags = 0);        // flags: recv()
 
+    // Non-throwing forms for hot paths: -1 with errno set on any failure.
+    ssize_t try_snd(const void* buf, size_t len, int flags = 0) noexcept;
+    ssize_t try_rcv(void* buf, size_t len, int flags = 0) noexcept;
+
     friend stream_client_socket& operator<<(stream_client_socket& sock,
                                             const char* str);
     friend stream_client_socket& operator<<(stream_client_socket& sock,
@@ -0,0 +1,210 @@
+#ifndef LIBSOCKET_URING_H_3B9C2E7A41D84F0C9E6A5D21F08B7C44
+#define LIBSOCKET_URING_H_3B9C2E7A41D84F0C9E6A5D21F08B7C44
+
+/*
+   The committers of the libsocket project, all rights reserved
+   (c) 2014, dermesser <lbo@spheniscida.de>
+
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions are met:
+
+   1. Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+   2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE REGENTS AND CONTRIBUTORS “AS IS” AND ANY
+   EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+   WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+   DISCLAIMED. IN NO EVENT SHALL THE REGENTS OR CONTRIBUTORS BE LIABLE FOR ANY
+   DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+   (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+   LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+   ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/**
+ * @file uring.hpp
+ * @brief [LINUX-only] io_uring I/O engine for stream sockets.
+ *
+ * `uring_engine` drives many connected stream sockets through one io_uring
+ * instance: sockets are fixed files, receives are multishot into a provided
+ * buffer ring, and sends are copied into registered buffers and submitted in
+ * one batch per `poll()`.
+ *
+ * The engine is compiled in when the kernel headers provide multishot
+ * receive (Linux 6.0+) and `LIBSOCKET_NO_URING` is not defined. At runtime,
+ * `available()` says whether the kernel lets this process create a ring;
+ * callers fall back to `epollset` when it does not.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "exception.hpp"
+
+#if !defined(LIBSOCKET_NO_URING) && defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+// Multishot receive (Linux 6.0) implies buffer rings (5.19).
+#ifdef IORING_RECV_MULTISHOT
+#define LIBSOCKET_HAVE_URING 1
+#endif
+#endif
+#endif
+
+#ifndef LIBSOCKET_HAVE_URING
+#define LIBSOCKET_HAVE_URING 0
+#endif
+
+namespace libsocket {
+/**
+ * @addtogroup libsocketplusplus
+ * @{
+ */
+
+/**
+ * @brief Completion-based engine for connected stream sockets.
+ *
+ * Sockets are registered with `add_socket()` and addressed by the slot it
+ * returns. Received bytes and closes are reported through the handler passed
+ * to `poll()`; `send()` only queues, so any number of sends cost one
+ * `io_uring_enter` at the next `poll()`.
+ *
+ * Not thread-safe: one thread owns an engine.
+ */
+class uring_engine {
+   public:
+    /// Sizes fixed when the engine is created.
+    struct params {
+        unsigned entries;          ///< Submission queue entries.
+        unsigned max_sockets;      ///< Fixed file table size.
+        unsigned recv_buffers;     ///< Provided buffers; a power of two.
+        size_t recv_buffer_size;   ///< Bytes per provided buffer.
+        unsigned send_buffers;     ///< Registered send buffers.
+        size_t send_buffer_size;   ///< Bytes per send buffer.
+
+        params()
+            : entries(256),
+              max_sockets(64),
+              recv_buffers(256),
+              recv_buffer_size(16384),
+              send_buffers(64),
+              send_buffer_size(65536) {}
+    };
+
+    /// What `poll()` reports.
+    struct event {
+        enum kind_t {
+            DATA,   ///< `data`/`length` hold received bytes.
+            CLOSED  ///< The peer closed (`error` 0) or the socket failed.
+        };
+
+        kind_t kind;
+        int slot;
+        int error;  ///< errno value for a failed socket.
+        /// Valid only during the handler call.
+        const char* data;
+        size_t length;
+    };
+
+    typedef std::function<void(const event&)> handler;
+
+    /// Running totals, e.g. for syscalls per message.
+    struct counters {
+        uint64_t enter_calls;    ///< `io_uring_enter` syscalls.
+        uint64_t register_calls; ///< `io_uring_register` syscalls.
+        uint64_t submitted;      ///< SQEs handed to the kernel.
+        uint64_t completions;    ///< CQEs reaped.
+        uint64_t bytes_sent;
+        uint64_t bytes_received;
+    };
+
+    static bool available(void);
+
+    explicit uring_engine(const params& p = params());
+    uring_engine(const uring_engine&) = delete;
+    uring_engine& operator=(const uring_engine&) = delete;
+    ~uring_engine(void);
+
+    int add_socket(int fd);
+    void remove_socket(int slot);
+    bool send(int slot, const void* buf, size_t len);
+    size_t queued(int slot) const;
+    size_t poll(const handler& on_event, unsigned wait_nr = 1);
+
+    const counters& stats(void) const { return totals; }
+
+   private:
+    struct connection {
+        int fd;
+        uint32_t generation;
+        bool open;
+        bool recv_armed;
+        /// Send buffer of the write in flight, or -1.
+        int inflight_buf;
+        size_t inflight_off;
+        size_t inflight_len;
+        /// Bytes not yet copied into a send buffer, from backlog_head on.
+        std::vector<char> backlog;
+        size_t backlog_head;
+    };
+
+    void release(void);
+    struct io_uring_sqe* next_sqe(void);
+    void arm_recv(int slot);
+    void start_write(int slot);
+    void submit_writes(void);
+    void recycle(uint16_t bid);
+    void close_slot(int slot, int error, const handler& on_event);
+    void handle(const struct io_uring_cqe& cqe, const handler& on_event,
+                size_t& delivered);
+    int enter(unsigned to_submit, unsigned wait_nr);
+    void update_file(int slot, int fd);
+
+    params cfg;
+    counters totals;
+    int ring_fd;
+
+    void* sq_map;
+    size_t sq_map_len;
+    void* cq_map;
+    size_t cq_map_len;
+    struct io_uring_sqe* sqes;
+    size_t sqes_len;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe* cqes;
+    /// SQEs filled since the last `io_uring_enter`.
+    unsigned pending;
+
+    struct io_uring_buf_ring* recv_ring;
+    size_t recv_ring_len;
+    char* recv_memory;
+    unsigned recv_mask;
+    unsigned recv_tail;
+
+    char* send_memory;
+    std::vector<int> free_send_bufs;
+
+    std::vector<connection> conns;
+    /// Slots with backlog but no write in flight.
+    std::vector<int> ready_to_write;
+};
+
+/**
+ * @}
+ */
+}  // namespace libsocket
+#endif
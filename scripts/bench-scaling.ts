@@ -0,0 +1,300 @@
+/**
+ * Connection-scaling bench: ramps each server backend through --steps
+ * connection counts (default 1k, 10k, 50k and 100k) driven by the native
+ * load generator (`make loadgen-native`). Every step runs in a fresh
+ * process so its memory and CPU are its own. At each step the generator
+ * connects everything and holds it idle while the server's RSS and idle
+ * CPU are sampled and --broadcasts stamped broadcasts measure fan-out; then
+ * the first --active connections send at --rate for --duration-ms and the
+ * echo round trip gives p99 under load.
+ *
+ * --backends=lws,libsocket,ts picks the servers; a backend that fails a
+ * step (descriptor limits, accept stalls) is not ramped further. Appends
+ * one JSONL record per step to --out (default data/bench_scaling.jsonl)
+ * and prints a table per backend. Past ~28k connections on loopback the
+ * generator spreads its sources over 127.0.0.2 upwards, which Linux routes
+ * without setup; raise `ulimit -n` past the largest step first.
+ */
+
+import { spawn } from "node:child_process";
+import fs from "node:fs";
+import path from "node:path";
+import { NativeQWormholeServer, isNativeServerAvailable } from "../src/core/native-server";
+import { QWormholeServer } from "../src/server";
+
+type Backend = "lws" | "libsocket" | "ts";
+
+const flag = (name: string, env: string): string | undefined =>
+  process.argv.find(arg => arg.startsWith(`--${name}=`))?.split("=")[1] ??
+  process.env[env];
+
+const numberFlag = (name: string, env: string, defaultValue: number): number => {
+  const raw = flag(name, env);
+  const parsed = Number(raw);
+  return raw !== undefined && Number.isFinite(parsed) ? parsed : defaultValue;
+};
+
+const root = path.join(__dirname, "..");
+const binary = flag("bin", "QWORMHOLE_LOADGEN_BIN") ??
+  path.join(root, "build/bench/qwormhole_loadgen");
+const outPath = flag("out", "QWORMHOLE_SCALING_OUT") ??
+  path.join(root, "data/bench_scaling.jsonl");
+const steps = (flag("steps", "QWORMHOLE_SCALING_STEPS") ?? "1000,10000,50000,100000")
+  .split(",")
+  .map(Number)
+  .filter(step => Number.isInteger(step) && step > 0);
+const backends = (flag("backends", "QWORMHOLE_SCALING_BACKENDS") ?? "lws,libsocket,ts")
+  .split(",")
+  .filter((name): name is Backend => name === "lws" || name === "libsocket" || name === "ts");
+const active = numberFlag("active", "QWORMHOLE_SCALING_ACTIVE", 1000);
+const rate = numberFlag("rate", "QWORMHOLE_SCALING_RATE", 20_000);
+const size = numberFlag("size", "QWORMHOLE_SCALING_SIZE", 256);
+const durationMs = numberFlag("duration-ms", "QWORMHOLE_SCALING_DURATION_MS", 5000);
+const idleMs = numberFlag("idle-ms", "QWORMHOLE_SCALING_IDLE_MS", 2000);
+const broadcasts = numberFlag("broadcasts", "QWORMHOLE_SCALING_BROADCASTS", 5);
+const threads = numberFlag("threads", "QWORMHOLE_SCALING_THREADS", 4);
+// Connections per loopback source address, inside the ephemeral port range.
+const perSource = 20_000;
+
+type ScalingServer = {
+  listen(): Promise<{ port: number }>;
+  close(): Promise<void>;
+  broadcast(payload: Buffer): void;
+  on(event: "connection", listener: () => void): unknown;
+  on(
+    event: "message",
+    listener: (event: { client: { send(data: Buffer): unknown }; data: Buffer }) => void,
+  ): unknown;
+};
+
+const createServer = (backend: Backend, connections: number): ScalingServer => {
+  const common = {
+    host: "127.0.0.1",
+    port: 0,
+    framing: "length-prefixed" as const,
+    serializer: (data: Buffer) => data,
+    deserializer: (data: Buffer) => data,
+  };
+  if (backend === "ts") {
+    return new QWormholeServer<Buffer>({ ...common, maxClients: connections + 1 }) as never;
+  }
+  if (!isNativeServerAvailable(backend)) {
+    throw new Error(`the ${backend} server backend is not built; run \`pnpm run rebuild\``);
+  }
+  return new NativeQWormholeServer<Buffer>(common, backend) as never;
+};
+
+/** A broadcast the generator times: MonotonicNs stamp, all-ones sequence. */
+const broadcastFrame = (): Buffer => {
+  const frame = Buffer.alloc(Math.max(16, size));
+  frame.writeBigUInt64LE(process.hrtime.bigint(), 0);
+  frame.writeBigUInt64LE(0xffffffffffffffffn, 8);
+  return frame;
+};
+
+type LatencySummary = { count: number; p50: number; p99: number; max: number };
+type LoadgenResult = {
+  active: number;
+  msgsPerSec: number;
+  shed: number;
+  errors: number;
+  latencyUs: LatencySummary;
+  fanoutUs: LatencySummary;
+};
+type ScalingRecord = {
+  connections: number;
+  rssPerConnectionBytes: number;
+  acceptPerSec?: number;
+  idleCpuPercent: number;
+  fanoutUs: LatencySummary;
+  latencyUs: LatencySummary;
+};
+
+const sleep = (ms: number) => new Promise(resolve => setTimeout(resolve, ms));
+
+/** CPU the whole process used over `ms`, as a percentage of one core. */
+const cpuPercentOver = async (ms: number): Promise<number> => {
+  const before = process.cpuUsage();
+  const started = performance.now();
+  await sleep(ms);
+  const used = process.cpuUsage(before);
+  return ((used.user + used.system) / 1000 / (performance.now() - started)) * 100;
+};
+
+async function runStep(backend: Backend, connections: number): Promise<ScalingRecord & Record<string, unknown>> {
+  const server = createServer(backend, connections);
+  let accepted = 0;
+  let firstAcceptAt = 0;
+  let lastAcceptAt = 0;
+  server.on("connection", () => {
+    const now = performance.now();
+    if (accepted === 0) firstAcceptAt = now;
+    lastAcceptAt = now;
+    accepted += 1;
+  });
+  server.on("message", ({ client, data }) => {
+    void client.send(data);
+  });
+  const { port } = await server.listen();
+  (globalThis as { gc?: () => void }).gc?.();
+  const rssBaseline = process.memoryUsage().rss;
+
+  const sources = connections > perSource ? Math.ceil(connections / perSource) : 0;
+  const child = spawn(
+    binary,
+    [
+      ["port", port],
+      ["connections", connections],
+      ["active", Math.min(active, connections)],
+      ["threads", Math.min(threads, connections)],
+      ["rate", rate],
+      ["size", size],
+      ["duration-ms", durationMs],
+      ["warmup-ms", 1000],
+      ["sources", sources],
+      ["start", "stdin"],
+      ["label", `scaling/${backend}/${connections}c`],
+    ].flatMap(([name, value]) => [`--${name}`, String(value)]),
+    { stdio: ["pipe", "pipe", "inherit"] },
+  );
+  const lines: string[] = [];
+  let buffered = "";
+  let notifyLine: (() => void) | undefined;
+  child.stdout.on("data", chunk => {
+    buffered += chunk;
+    const parts = buffered.split("\n");
+    buffered = parts.pop() ?? "";
+    lines.push(...parts.filter(Boolean));
+    notifyLine?.();
+  });
+  const exited = new Promise<number | null>((resolve, reject) => {
+    child.on("error", reject);
+    child.on("exit", code => {
+      notifyLine?.();
+      resolve(code);
+    });
+  });
+
+  try {
+    // Connected on the generator's side and accepted on the server's.
+    while (!lines.length && child.exitCode === null) {
+      await new Promise<void>(resolve => (notifyLine = resolve));
+    }
+    if (!lines.length) throw new Error(`load generator exited with ${child.exitCode}`);
+    const connected = JSON.parse(lines[0]) as { connectMs: number };
+    const acceptDeadline = performance.now() + 30_000;
+    while (accepted < connections && performance.now() < acceptDeadline) {
+      await sleep(10);
+    }
+    if (accepted < connections) {
+      throw new Error(`server accepted ${accepted} of ${connections} connections`);
+    }
+    const acceptMs = lastAcceptAt - firstAcceptAt;
+
+    await sleep(500);
+    (globalThis as { gc?: () => void }).gc?.();
+    const rssHeld = process.memoryUsage().rss;
+    const idleCpuPercent = await cpuPercentOver(idleMs);
+
+    const broadcastCallMs: number[] = [];
+    for (let i = 0; i < broadcasts; i += 1) {
+      const started = performance.now();
+      server.broadcast(broadcastFrame());
+      broadcastCallMs.push(performance.now() - started);
+      await sleep(200);
+    }
+
+    const loadCpu = process.cpuUsage();
+    const loadStarted = performance.now();
+    child.stdin.end("go\n");
+    const code = await exited;
+    const loadUsed = process.cpuUsage(loadCpu);
+    const result = JSON.parse(lines[lines.length - 1]) as LoadgenResult;
+    if (code !== 0) throw new Error(`load generator exited with ${code}`);
+    return {
+      timestamp: new Date().toISOString(),
+      scenario: `scaling/${backend}/${connections}c`,
+      backend,
+      connections,
+      active: result.active,
+      connectMs: connected.connectMs,
+      acceptMs,
+      acceptPerSec: acceptMs > 0 ? (connections * 1000) / acceptMs : undefined,
+      rssBaselineBytes: rssBaseline,
+      rssHeldBytes: rssHeld,
+      rssPerConnectionBytes: Math.round((rssHeld - rssBaseline) / connections),
+      idleCpuPercent,
+      broadcastCallMs: broadcastCallMs.reduce((sum, ms) => sum + ms, 0) / broadcasts,
+      fanoutExpected: connections * broadcasts,
+      fanoutReceived: result.fanoutUs.count,
+      fanoutUs: result.fanoutUs,
+      loadCpuPercent:
+        ((loadUsed.user + loadUsed.system) / 1000 / (performance.now() - loadStarted)) * 100,
+      msgsPerSec: result.msgsPerSec,
+      latencyUs: result.latencyUs,
+      shed: result.shed,
+      errors: result.errors,
+    };
+  } finally {
+    if (child.exitCode === null) child.kill();
+    await server.close();
+  }
+}
+
+const formatRow = (record: ScalingRecord): string =>
+  [
+    String(record.connections).padStart(7),
+    `${(record.rssPerConnectionBytes / 1024).toFixed(1)} KiB`.padStart(10),
+    `${Math.round(record.acceptPerSec ?? 0)}/s`.padStart(9),
+    `${record.idleCpuPercent.toFixed(1)}%`.padStart(7),
+    `${(record.fanoutUs.max / 1000).toFixed(1)} ms`.padStart(10),
+    `${(record.latencyUs.p99 / 1000).toFixed(2)} ms`.padStart(10),
+  ].join("  ");
+
+async function main() {
+  const childArg = flag("child", "QWORMHOLE_SCALING_CHILD");
+  if (childArg) {
+    const [backend, connections] = childArg.split(":");
+    const record = await runStep(backend as Backend, Number(connections));
+    process.stdout.write(`${JSON.stringify(record)}\n`);
+    return;
+  }
+  if (!fs.existsSync(binary)) {
+    throw new Error(`${binary} not found; build it with \`make loadgen-native\``);
+  }
+  fs.mkdirSync(path.dirname(outPath), { recursive: true });
+  const header = ["  conns", "   rss/conn", "   accept", "idle cpu", "    fan-out", "  p99 load"]
+    .join("  ");
+  for (const backend of backends) {
+    console.log(`[scaling] ${backend}\n${header}`);
+    for (const connections of steps) {
+      const { code, stdout } = await new Promise<{ code: number | null; stdout: string }>(
+        (resolve, reject) => {
+          const child = spawn(
+            process.execPath,
+            ["--expose-gc", ...process.execArgv, __filename, ...process.argv.slice(2),
+              `--child=${backend}:${connections}`],
+            { stdio: ["ignore", "pipe", "inherit"] },
+          );
+          let output = "";
+          child.stdout.on("data", chunk => (output += chunk));
+          child.on("error", reject);
+          child.on("exit", exitCode => resolve({ code: exitCode, stdout: output }));
+        },
+      );
+      const line = stdout.trim().split("\n").pop();
+      if (code !== 0 || !line) {
+        console.log(`${String(connections).padStart(7)}  failed; not ramping ${backend} further`);
+        break;
+      }
+      fs.appendFileSync(outPath, `${line}\n`);
+      console.log(formatRow(JSON.parse(line)));
+    }
+  }
+  console.log(`[scaling] -> ${outPath}`);
+}
+
+main().catch(err => {
+  console.error(err instanceof Error ? err.message : err);
+  process.exit(1);
+});
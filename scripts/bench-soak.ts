@@ -0,0 +1,228 @@
+/**
+ * Soak run for the native stack: an lws NativeQWormholeServer and lws
+ * NativeTcpClients exchanging mixed traffic for --duration-ms (default two
+ * hours), with connection churn, looking for memory or queues that only
+ * grow. Short benches miss this kind of creep.
+ *
+ * Each client sends a burst every 10 ms: mostly small frames, with some
+ * 4 KiB and 64 KiB ones. The server echoes everything and broadcasts once
+ * a second. Every --churn-ms a --churn-fraction of the clients close and
+ * fresh ones connect. Every --sample-ms the run records process memory,
+ * the native buffer pool, connection memory, send and receive queue depths
+ * and pending TSFN deliveries as a "soak" row in the telemetry trace
+ * (--trace, default data/soak.qwtrace).
+ *
+ * At the end growthTrend() tests each series after the warmup. A series
+ * with a significant upward trend that clears its floor fails the run.
+ * One JSONL summary goes to --out (default data/soak.jsonl).
+ */
+
+import fs from "node:fs";
+import path from "node:path";
+import { NativeQWormholeServer, isNativeServerAvailable } from "../src/core/native-server";
+import { NativeTcpClient, getNativeBufferPoolStats } from "../src/core/NativeTCPClient";
+import { TelemetryTraceRecorder, openTelemetryTrace } from "../src/telemetry/trace-recorder";
+import { TraceSchemas } from "../src/telemetry/trace-format";
+import { growthTrend, type GrowthTrend } from "../src/telemetry/growth-trend";
+
+const flag = (name: string, env: string): string | undefined =>
+  process.argv.find(arg => arg.startsWith(`--${name}=`))?.split("=")[1] ??
+  process.env[env];
+
+const numberFlag = (name: string, env: string, defaultValue: number): number => {
+  const raw = flag(name, env);
+  const parsed = Number(raw);
+  return raw !== undefined && Number.isFinite(parsed) ? parsed : defaultValue;
+};
+
+const root = path.join(__dirname, "..");
+const durationMs = numberFlag("duration-ms", "QWORMHOLE_SOAK_DURATION_MS", 2 * 3_600_000);
+const sampleMs = numberFlag("sample-ms", "QWORMHOLE_SOAK_SAMPLE_MS", 5000);
+const clientCount = numberFlag("clients", "QWORMHOLE_SOAK_CLIENTS", 32);
+const churnMs = numberFlag("churn-ms", "QWORMHOLE_SOAK_CHURN_MS", 10_000);
+const churnFraction = numberFlag("churn-fraction", "QWORMHOLE_SOAK_CHURN_FRACTION", 0.25);
+const burst = numberFlag("burst", "QWORMHOLE_SOAK_BURST", 4);
+const tracePath = flag("trace", "QWORMHOLE_SOAK_TRACE") ?? path.join(root, "data/soak.qwtrace");
+const outPath = flag("out", "QWORMHOLE_SOAK_OUT") ?? path.join(root, "data/soak.jsonl");
+
+const MB = 1024 * 1024;
+// Growth over the tested window below which a trend is not a leak.
+const growthFloors: Partial<Record<(typeof TraceSchemas.soak.columns)[number], number>> = {
+  rssBytes: 16 * MB,
+  heapUsedBytes: 8 * MB,
+  externalBytes: 8 * MB,
+  nativeConnectionBytes: 4 * MB,
+  bufferPoolCachedBytes: 4 * MB,
+  bufferPoolInUseBytes: 4 * MB,
+  serverQueuedBytes: MB,
+  clientQueuedBytes: MB,
+  clientRxBufferedBytes: MB,
+  tsfnPending: 256,
+  tsfnPendingBytes: MB,
+};
+
+// Mixed sizes: mostly control-sized frames, some pages, a few bulk ones.
+const payloads = [64, 64, 64, 256, 256, 1024, 4096, 65_536].map(size =>
+  Buffer.alloc(size, "s"),
+);
+const broadcast = Buffer.alloc(512, "b");
+
+let seed = 0x51ab;
+const random = (): number => {
+  seed = (seed * 1103515245 + 12345) % 2 ** 31;
+  return seed / 2 ** 31;
+};
+
+const sleep = (ms: number) => new Promise(resolve => setTimeout(resolve, ms));
+
+async function main() {
+  if (!isNativeServerAvailable("lws")) {
+    throw new Error("the lws server backend is not built; run `pnpm run rebuild`");
+  }
+  const server = new NativeQWormholeServer<Buffer>(
+    {
+      host: "127.0.0.1",
+      port: 0,
+      framing: "length-prefixed",
+      serializer: (data: Buffer) => data,
+      deserializer: (data: Buffer) => data,
+    },
+    "lws",
+  );
+  server.on("message", ({ client, data }) => {
+    void client.send(data);
+  });
+  const { port } = await server.listen();
+
+  let received = 0;
+  let opened = 0;
+  const open = (): NativeTcpClient => {
+    const client = new NativeTcpClient("lws");
+    client.setEventHandler(event => {
+      if (event.type === "message") received += 1;
+    });
+    client.connect({ host: "127.0.0.1", port, framing: "length-prefixed" });
+    opened += 1;
+    return client;
+  };
+  let clients = Array.from({ length: clientCount }, open);
+
+  fs.mkdirSync(path.dirname(tracePath), { recursive: true });
+  fs.rmSync(tracePath, { force: true });
+  const recorder = new TelemetryTraceRecorder(tracePath, { blockRows: 256 });
+  const sample = () => {
+    const memory = process.memoryUsage();
+    const pool = getNativeBufferPoolStats();
+    const stats = server.getStats();
+    const service = server.getServiceStats();
+    let clientQueued = 0;
+    let clientRxBuffered = 0;
+    let tsfnPending = service?.tsfnPending ?? 0;
+    let tsfnPendingBytes = service?.tsfnPendingBytes ?? 0;
+    for (const client of clients) {
+      const clientStats = client.getStats();
+      clientQueued += clientStats?.queuedBytes ?? 0;
+      clientRxBuffered += clientStats?.rxBufferedBytes ?? 0;
+      const clientService = client.getServiceStats();
+      tsfnPending += clientService?.tsfnPending ?? 0;
+      tsfnPendingBytes += clientService?.tsfnPendingBytes ?? 0;
+    }
+    recorder.record("soak", [
+      Date.now(),
+      memory.rss,
+      memory.heapUsed,
+      memory.external,
+      stats?.connectionMemory?.bytes ?? NaN,
+      pool?.cachedBytes ?? NaN,
+      pool?.inUseBytes ?? NaN,
+      stats?.queuedBytes ?? NaN,
+      clientQueued,
+      clientRxBuffered,
+      tsfnPending,
+      tsfnPendingBytes,
+      server.getConnectionCount(),
+    ]);
+  };
+
+  const traffic = setInterval(() => {
+    for (const client of clients) {
+      if (!client.isConnected()) continue;
+      // A false send is backpressure: the rest of the burst waits a tick.
+      for (let i = 0; i < burst; i += 1) {
+        if (client.send(payloads[Math.floor(random() * payloads.length)]) === false) break;
+      }
+    }
+  }, 10);
+  const broadcaster = setInterval(() => server.broadcast(broadcast), 1000);
+  const churner = setInterval(() => {
+    const replace = Math.max(1, Math.round(clients.length * churnFraction));
+    const leaving = new Set<NativeTcpClient>();
+    while (leaving.size < replace) {
+      leaving.add(clients[Math.floor(random() * clients.length)]);
+    }
+    for (const client of leaving) client.close();
+    clients = [
+      ...clients.filter(client => !leaving.has(client)),
+      ...Array.from({ length: replace }, open),
+    ];
+  }, churnMs);
+  const sampler = setInterval(sample, sampleMs);
+
+  const started = Date.now();
+  const progressEvery = Math.max(sampleMs, 60_000);
+  while (Date.now() - started < durationMs) {
+    await sleep(Math.min(progressEvery, durationMs - (Date.now() - started)));
+    const rss = process.memoryUsage().rss;
+    console.log(
+      `[soak] ${Math.round((Date.now() - started) / 60_000)} min: rss ${(rss / MB).toFixed(1)} MiB, ` +
+        `${received} messages, ${opened} connections opened`,
+    );
+  }
+  clearInterval(traffic);
+  clearInterval(broadcaster);
+  clearInterval(churner);
+  clearInterval(sampler);
+  for (const client of clients) client.close();
+  await server.close();
+  recorder.close();
+
+  const trace = openTelemetryTrace(tracePath);
+  const times = trace.column("soak", "atMs");
+  const trends: Record<string, GrowthTrend> = {};
+  const growing: string[] = [];
+  for (const [column, floor] of Object.entries(growthFloors)) {
+    const trend = growthTrend(times, trace.column("soak", column), { minAbsoluteGrowth: floor });
+    trends[column] = trend;
+    if (trend.growing) growing.push(column);
+    console.log(
+      `[soak] ${column.padEnd(22)} ${trend.growing ? "GROWING" : "ok     "} ` +
+        `slope ${trend.slopePerHour.toFixed(0)}/h, growth ${trend.growth.toFixed(0)}, ` +
+        `p ${trend.pValue.toExponential(1)}`,
+    );
+  }
+  fs.mkdirSync(path.dirname(outPath), { recursive: true });
+  fs.appendFileSync(
+    outPath,
+    `${JSON.stringify({
+      timestamp: new Date().toISOString(),
+      scenario: "soak/lws",
+      durationMs,
+      samples: times.length,
+      clients: clientCount,
+      connectionsOpened: opened,
+      messagesReceived: received,
+      trace: tracePath,
+      growing,
+      trends,
+    })}\n`,
+  );
+  if (growing.length) {
+    console.error(`[soak] monotonic growth in ${growing.join(", ")}`);
+    process.exitCode = 1;
+  }
+}
+
+main().catch(err => {
+  console.error(err instanceof Error ? err.message : err);
+  process.exit(1);
+});
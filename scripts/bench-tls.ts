@@ -0,0 +1,250 @@
+/**
+ * TLS handshake bench: drives a TLS server with the native load generator's
+ * handshake mode (build/bench/qwormhole_loadgen, `make loadgen-native`) and
+ * records connection setup rather than throughput. Each run opens
+ * --handshakes connections over --threads threads, and each connection
+ * sends one frame, reads the echo and closes.
+ *
+ * The matrix is --certs (ecdsa, rsa) x --versions (1.2, 1.3) x --sessions:
+ *   full    every handshake is full
+ *   ticket  clients resume from session tickets (tls.sessionTickets)
+ *   cache   tickets off, so the server resumes from its session cache
+ * --backends picks lws (default) and/or ts; the TS server has no cache mode.
+ * --ktls sets tls.ktls on the lws server. Certificates are self-signed and
+ * made with the openssl CLI for each run of the bench.
+ *
+ * Appends one JSONL record per run to --out (default data/bench_tls.jsonl):
+ * the generator's result (handshakes per second, full and resumed handshake
+ * times, time to first byte, its CPU per handshake) plus the server's CPU
+ * per handshake and, on lws, the full and resumed counts it saw, the
+ * service-thread time per handshake and the deepest handshake backlog.
+ */
+
+import { execFileSync, spawn } from "node:child_process";
+import fs from "node:fs";
+import os from "node:os";
+import path from "node:path";
+import { NativeQWormholeServer, isNativeServerAvailable } from "../src/core/native-server";
+import { QWormholeServer } from "../src/server";
+import type { NativeServerTransportStats } from "../src/types/types";
+
+type Backend = "lws" | "ts";
+type CertKind = "ecdsa" | "rsa";
+type SessionMode = "full" | "ticket" | "cache";
+
+const flag = (name: string, env: string): string | undefined =>
+  process.argv.find(arg => arg.startsWith(`--${name}=`))?.split("=")[1] ??
+  process.env[env];
+
+const numberFlag = (name: string, env: string, defaultValue: number): number => {
+  const raw = flag(name, env);
+  const parsed = Number(raw);
+  return raw !== undefined && Number.isFinite(parsed) ? parsed : defaultValue;
+};
+
+const listFlag = <T extends string>(
+  name: string,
+  env: string,
+  defaultValue: string,
+  allowed: readonly T[],
+): T[] =>
+  (flag(name, env) ?? defaultValue)
+    .split(",")
+    .filter((value): value is T => (allowed as readonly string[]).includes(value));
+
+const root = path.join(__dirname, "..");
+const binary = flag("bin", "QWORMHOLE_LOADGEN_BIN") ??
+  path.join(root, "build/bench/qwormhole_loadgen");
+const outPath = flag("out", "QWORMHOLE_TLS_BENCH_OUT") ??
+  path.join(root, "data/bench_tls.jsonl");
+const backends = listFlag("backends", "QWORMHOLE_TLS_BENCH_BACKENDS", "lws", ["lws", "ts"]);
+const certs = listFlag("certs", "QWORMHOLE_TLS_BENCH_CERTS", "ecdsa,rsa", ["ecdsa", "rsa"]);
+const versions = listFlag("versions", "QWORMHOLE_TLS_BENCH_VERSIONS", "1.2,1.3", ["1.2", "1.3"]);
+const sessions = listFlag("sessions", "QWORMHOLE_TLS_BENCH_SESSIONS", "full,ticket,cache", [
+  "full",
+  "ticket",
+  "cache",
+]);
+const handshakes = numberFlag("handshakes", "QWORMHOLE_TLS_BENCH_HANDSHAKES", 2000);
+const threads = numberFlag("threads", "QWORMHOLE_TLS_BENCH_THREADS", 4);
+const size = numberFlag("size", "QWORMHOLE_TLS_BENCH_SIZE", 64);
+const ktls = process.argv.includes("--ktls") || process.env.QWORMHOLE_TLS_BENCH_KTLS === "1";
+
+/** A self-signed localhost certificate and its key, from the openssl CLI. */
+const makeCertificate = (dir: string, kind: CertKind): { cert: Buffer; key: Buffer } => {
+  const keyPath = path.join(dir, `${kind}.key`);
+  const certPath = path.join(dir, `${kind}.crt`);
+  const keyArgs =
+    kind === "ecdsa"
+      ? ["-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1"]
+      : ["-newkey", "rsa:2048"];
+  execFileSync(
+    "openssl",
+    ["req", "-x509", ...keyArgs, "-nodes", "-days", "1", "-subj", "/CN=localhost",
+      "-keyout", keyPath, "-out", certPath],
+    { stdio: "ignore" },
+  );
+  return { cert: fs.readFileSync(certPath), key: fs.readFileSync(keyPath) };
+};
+
+type TlsBenchServer = {
+  listen(): Promise<{ port: number }>;
+  close(): Promise<void>;
+  getStats?(): NativeServerTransportStats | undefined;
+  on(
+    event: "message",
+    listener: (event: { client: { send(data: Buffer): unknown }; data: Buffer }) => void,
+  ): unknown;
+};
+
+const createServer = (
+  backend: Backend,
+  credentials: { cert: Buffer; key: Buffer },
+  mode: SessionMode,
+): TlsBenchServer => {
+  const common = {
+    host: "127.0.0.1",
+    port: 0,
+    framing: "length-prefixed" as const,
+    serializer: (data: Buffer) => data,
+    deserializer: (data: Buffer) => data,
+  };
+  if (backend === "ts") {
+    return new QWormholeServer<Buffer>({
+      ...common,
+      tls: { enabled: true, ...credentials },
+    }) as never;
+  }
+  if (!isNativeServerAvailable("lws")) {
+    throw new Error("the lws server backend is not built; run `pnpm run rebuild`");
+  }
+  return new NativeQWormholeServer<Buffer>(
+    {
+      ...common,
+      tls: { enabled: true, ...credentials, sessionTickets: mode !== "cache", ktls },
+    },
+    "lws",
+  ) as never;
+};
+
+type HandshakeResult = {
+  scenario: string;
+  completed: number;
+  resumed: number;
+  errors: number;
+  handshakesPerSec: number;
+  clientCpuUsPerHandshake: number;
+  fullHandshakeUs: { p50: number; p99: number };
+  resumedHandshakeUs: { p50: number; p99: number };
+  ttfbUs: { p50: number; p99: number };
+};
+
+async function runHandshakes(
+  backend: Backend,
+  kind: CertKind,
+  credentials: { cert: Buffer; key: Buffer },
+  version: "1.2" | "1.3",
+  mode: SessionMode,
+): Promise<HandshakeResult & { serverCpuUsPerHandshake?: number } & Record<string, unknown>> {
+  const server = createServer(backend, credentials, mode);
+  server.on("message", ({ client, data }) => {
+    void client.send(data);
+  });
+  const { port } = await server.listen();
+  const statsBefore = server.getStats?.();
+  const cpuBefore = process.cpuUsage();
+  const scenario = `tls/${backend}/${kind}/tls${version}/${mode}`;
+  try {
+    const { code, stdout } = await new Promise<{ code: number | null; stdout: string }>(
+      (resolve, reject) => {
+        const child = spawn(
+          binary,
+          [
+            ["port", port],
+            ["mode", "handshake"],
+            ["handshakes", handshakes],
+            ["threads", threads],
+            ["size", size],
+            ["tls-version", version],
+            ["resume", mode === "full" ? 0 : 1],
+            ["label", scenario],
+          ].flatMap(([name, value]) => [`--${name}`, String(value)]),
+          { stdio: ["ignore", "pipe", "inherit"] },
+        );
+        let output = "";
+        child.stdout.on("data", chunk => (output += chunk));
+        child.on("error", reject);
+        child.on("exit", exitCode => resolve({ code: exitCode, stdout: output }));
+      },
+    );
+    const cpu = process.cpuUsage(cpuBefore);
+    const statsAfter = server.getStats?.();
+    const line = stdout.trim().split("\n").pop();
+    if (!line) throw new Error(`load generator exited with ${code} and no result`);
+    const result = JSON.parse(line) as HandshakeResult;
+    const counted = (key: "tlsSessionsFull" | "tlsSessionsResumed") =>
+      statsAfter?.[key] !== undefined ? statsAfter[key]! - (statsBefore?.[key] ?? 0) : undefined;
+    return {
+      ...result,
+      backend,
+      certificate: kind,
+      sessions: mode,
+      ktls: backend === "lws" && ktls,
+      serverCpuUsPerHandshake:
+        result.completed > 0 ? (cpu.user + cpu.system) / result.completed : undefined,
+      serverFullHandshakes: counted("tlsSessionsFull"),
+      serverResumedHandshakes: counted("tlsSessionsResumed"),
+      // One server per run, so its histograms cover just this run.
+      serverHandshakeServiceUs: statsAfter?.tlsSetup && {
+        p50: statsAfter.tlsSetup.serviceUs.p50,
+        p99: statsAfter.tlsSetup.serviceUs.p99,
+      },
+      serverMaxPendingHandshakes: statsAfter?.tlsSetup?.maxPending,
+    };
+  } finally {
+    await server.close();
+  }
+}
+
+async function main() {
+  if (!fs.existsSync(binary)) {
+    throw new Error(`${binary} not found; build it with \`make loadgen-native\``);
+  }
+  const certDir = fs.mkdtempSync(path.join(os.tmpdir(), "qwormhole-tls-bench-"));
+  fs.mkdirSync(path.dirname(outPath), { recursive: true });
+  let failed = false;
+  try {
+    for (const kind of certs) {
+      const credentials = makeCertificate(certDir, kind);
+      for (const backend of backends) {
+        for (const version of versions) {
+          for (const mode of sessions) {
+            // Node's TLS server resumes from tickets only.
+            if (backend === "ts" && mode === "cache") continue;
+            const record = await runHandshakes(backend, kind, credentials, version, mode);
+            fs.appendFileSync(outPath, `${JSON.stringify(record)}\n`);
+            failed ||= record.errors > 0;
+            const resumedNote =
+              mode === "full" ? "" : `, ${record.resumed}/${record.completed} resumed`;
+            console.log(
+              `[tls] ${record.scenario}: ${Math.round(record.handshakesPerSec)} hs/s, ` +
+                `ttfb p50 ${(record.ttfbUs.p50 / 1000).toFixed(2)} ms ` +
+                `p99 ${(record.ttfbUs.p99 / 1000).toFixed(2)} ms, ` +
+                `server ${Math.round(record.serverCpuUsPerHandshake ?? 0)} us cpu/hs` +
+                resumedNote,
+            );
+          }
+        }
+      }
+    }
+  } finally {
+    fs.rmSync(certDir, { recursive: true, force: true });
+  }
+  console.log(`[tls] -> ${outPath}`);
+  if (failed) process.exitCode = 1;
+}
+
+main().catch(err => {
+  console.error(err instanceof Error ? err.message : err);
+  process.exit(1);
+});
@@ -11,6 +11,7 @@ import { fork } from "node:child_process";
 import { once, type EventEmitter } from "node:events";
 import fs from "node:fs/promises";
 import net from "node:net";
+import v8 from "node:v8";
 import {
   QWormholeClient,
   NativeTcpClient,
@@ -36,9 +37,17 @@ import { LengthPrefixedFramer } from "../src/core/framing";
 import { KcpServer } from "../src/transports/kcp/kcp-server";
 import { KcpSession } from "../src/transports/kcp/kcp-session";
 import { inferMessageType } from "../src/utils/negentropic-diagnostics";
+import { TelemetryTraceRecorder } from "../src/telemetry/trace-recorder";
+import { LatencyHistogram } from "../src/telemetry/latency-histogram";
+import { splitLatency } from "../src/core/native-timestamps";
+import type {
+  NativeImpairmentOptions,
+  NativeRxTimestamps,
+} from "../src/types/types";
 import type {
   FramingMode,
   NativeBackend,
+  NativeTransportStats,
   Payload,
   QWormholeServerOptions,
   Serializer,
@@ -53,6 +62,9 @@ import {
   DiagnosticsScope,
   SendBlockStats,
   ScenarioResult,
+  MessageLatencySummary,
+  LatencySplitSummary,
+  NativeCostCounters,
   DiagnosticsExtras,
   CoherenceDecisionSample,
 } from "../test/testtypes";
@@ -154,6 +166,12 @@ const BENCH_REPEAT = Math.max(
   1,
   Number(process.env.QWORMHOLE_BENCH_REPEAT ?? "1") || 1,
 );
+// Whole runs per scenario thrown away before the measured repeats (JIT,
+// page cache, socket buffers), on top of the per-run warmup messages.
+const BENCH_WARMUP_RUNS = Math.max(
+  0,
+  Number(process.env.QWORMHOLE_BENCH_WARMUP_RUNS ?? "0") || 0,
+);
 
 type BenchChildInit = {
   type: "init";
@@ -230,6 +248,8 @@ const getCsvPath = () => {
 const BENCH_CSV_PATH = getCsvPath();
 const BENCH_JSONL_PATH = process.env.QWORMHOLE_BENCH_JSONL;
 const BENCH_REPORT_PATH = process.env.QWORMHOLE_BENCH_REPORT;
+// Columnar trace (src/telemetry) of the same results, appended per run.
+const BENCH_TRACE_PATH = process.env.QWORMHOLE_BENCH_TRACE;
 
 type Mode =
   | "ts"
@@ -260,6 +280,9 @@ interface BenchResult {
   kcpRttMs?: number;
   kcpLossRate?: number;
   kcpPending?: number;
+  messageLatency?: MessageLatencySummary;
+  latencySplit?: LatencySplitSummary;
+  nativeCosts?: { server?: NativeCostCounters; client?: NativeCostCounters };
 }
 
 const SOCKET_MODES: Mode[] = ["ts", "native-lws", "native-libsocket", "quic"];
@@ -308,6 +331,33 @@ const envNumber = (key: string): number | undefined => {
   return Number.isFinite(parsed) && parsed > 0 ? parsed : undefined;
 };
 const BENCH_YIELD_EVERY = envNumber("QWORMHOLE_BENCH_YIELD_EVERY");
+// Open-loop send rate across all clients (msgs/s). Each message is stamped
+// with the time it was due, not when it went out, so a stalled sender shows
+// up as latency instead of being hidden by coordinated omission.
+const BENCH_RATE = envNumber("QWORMHOLE_BENCH_RATE");
+const BENCH_LATENCY =
+  BENCH_RATE !== undefined || process.env.QWORMHOLE_BENCH_LATENCY === "1";
+// "software" or "hardware": the libsocket server stamps receives, and
+// latency is also reported cut into wire, kernel, native and JS slices.
+const BENCH_TIMESTAMPING = ((): "software" | "hardware" | undefined => {
+  const raw = process.env.QWORMHOLE_BENCH_TIMESTAMPING;
+  return raw === "software" || raw === "hardware" ? raw : undefined;
+})();
+// JSON NativeImpairmentOptions, e.g. {"delayMs":5,"jitterMs":2,"seed":7}:
+// the lws server and native lws clients delay, cap and stall what they
+// send, so scenarios run against a bad link without `tc netem`.
+const BENCH_IMPAIRMENT = ((): NativeImpairmentOptions | undefined => {
+  const raw = process.env.QWORMHOLE_BENCH_IMPAIRMENT;
+  if (!raw) return undefined;
+  try {
+    const parsed = JSON.parse(raw) as unknown;
+    return parsed && typeof parsed === "object" && !Array.isArray(parsed)
+      ? (parsed as NativeImpairmentOptions)
+      : undefined;
+  } catch {
+    return undefined;
+  }
+})();
 const parseHandshakeTags = (
   raw?: string,
 ): Record<string, string | number> | undefined => {
@@ -477,6 +527,18 @@ for (const preferNativeServer of [false, true]) {
   }
 }
 
+// The lws server on per-thread libuv loops (IOCP on Windows) rather than
+// lws's own poll loop; skipped when libwebsockets lacks LWS_WITH_LIBUV.
+if (serverBackends.includes("lws")) {
+  scenarios.push({
+    id: "native-server(lws,uv)+native-lws",
+    preferNativeServer: true,
+    clientMode: "native-lws",
+    serverBackend: "lws",
+    serverLoop: "uv",
+  });
+}
+
 const baselineScenarios: Scenario[] = [
   {
     id: "net-server+net",
@@ -511,6 +573,8 @@ const toBytes: Serializer = (payload: Payload): Buffer => {
 const benchSerializer: Serializer = (() => {
   const cache = new Map<Payload, Buffer>();
   return (payload: Payload): Buffer => {
+    // Buffers go through untouched; caching them would pin every stamped copy.
+    if (Buffer.isBuffer(payload)) return payload;
     const cached = cache.get(payload);
     if (cached) return cached;
     const encoded = toBytes(payload);
@@ -577,6 +641,116 @@ const sendBenchPayloadAt = (
   }
 };
 
+const NATIVE_COST_KEYS = [
+  "queuedWriteAllocs",
+  "rxFrameAllocs",
+  "tsfnPayloads",
+  "lwsWrites",
+  "rxCallbacks",
+] as const;
+
+/**
+ * Sum of the lws cost counters across `sources` (a server, or every bench
+ * client); undefined when none of them is an lws wrapper.
+ */
+const readNativeCosts = (
+  sources: Array<{ getStats?: () => Partial<NativeTransportStats> | undefined }>,
+): NativeCostCounters | undefined => {
+  let out: NativeCostCounters | undefined;
+  for (const source of sources) {
+    const stats = source.getStats?.();
+    if (!stats || typeof stats.lwsWrites !== "number") continue;
+    out ??= {
+      queuedWriteAllocs: 0,
+      rxFrameAllocs: 0,
+      tsfnPayloads: 0,
+      lwsWrites: 0,
+      rxCallbacks: 0,
+    };
+    for (const key of NATIVE_COST_KEYS) out[key] += stats[key] ?? 0;
+  }
+  return out;
+};
+
+const diffNativeCosts = (
+  end: NativeCostCounters | undefined,
+  start: NativeCostCounters | undefined,
+): NativeCostCounters | undefined => {
+  if (!end) return undefined;
+  const out = { ...end };
+  for (const key of NATIVE_COST_KEYS) out[key] -= start?.[key] ?? 0;
+  return out;
+};
+
+const perMessageNativeCosts = (
+  counters: NativeCostCounters | undefined,
+  messages: number,
+): NativeCostCounters | undefined => {
+  if (!counters || messages <= 0) return undefined;
+  const out = { ...counters };
+  for (const key of NATIVE_COST_KEYS) out[key] /= messages;
+  return out;
+};
+
+const LATENCY_STAMP_BYTES = 8;
+
+/**
+ * Copy of payload `index` with `stampMs` (performance.now() time) written
+ * over its first 8 bytes, for the server to turn into one-way latency. The
+ * bench sends client and server on one process clock, so no sync is needed.
+ */
+const stampBenchPayload = (
+  index: number,
+  framing: FramingMode,
+  stampMs: number,
+  native: boolean,
+): Buffer => {
+  const offset = native && framing === "length-prefixed" ? FRAME_HEADER_BYTES : 0;
+  const source = native
+    ? getNativePayload(index, framing)
+    : benchSerializer(getBenchPayload(index));
+  if (source.length < offset + LATENCY_STAMP_BYTES) return source;
+  const stamped = Buffer.from(source);
+  stamped.writeDoubleLE(stampMs, offset);
+  return stamped;
+};
+
+const summarizeMessageLatency = (
+  histogram: LatencyHistogram,
+): MessageLatencySummary | undefined => {
+  const summary = histogram.summary();
+  if (summary.count === 0) return undefined;
+  return {
+    count: summary.count,
+    p50Ms: summary.p50,
+    p90Ms: summary.p90,
+    p99Ms: summary.p99,
+    p999Ms: summary.p999,
+    maxMs: summary.max,
+    meanMs: summary.mean,
+    openLoop: BENCH_RATE !== undefined,
+    targetRate: BENCH_RATE,
+    native: histogram.native,
+    buckets: histogram.buckets(),
+  };
+};
+
+const summarizeLatencySplit = (
+  histograms: Record<keyof LatencySplitSummary, LatencyHistogram>,
+): LatencySplitSummary | undefined => {
+  if (histograms.wire.summary().count === 0) return undefined;
+  const slice = (histogram: LatencyHistogram) => {
+    const summary = histogram.summary();
+    return { p50Ms: summary.p50, p99Ms: summary.p99, meanMs: summary.mean };
+  };
+  return {
+    wire: slice(histograms.wire),
+    kernel: slice(histograms.kernel),
+    native: slice(histograms.native),
+    js: slice(histograms.js),
+  };
+};
+
 const flushNativeBenchBatch = (
   nativeClient: NativeTcpClient | null,
   batch: Buffer[],
@@ -847,6 +1021,11 @@ const startDiagnostics = (
 
   const startGc = snapshotGcTotals();
   const startElu = performance.eventLoopUtilization();
+  // Bytes allocated = heap growth + what the collector freed in between.
+  let gcProfiler = new v8.GCProfiler();
+  gcProfiler.start();
+  let startHeapUsed = v8.getHeapStatistics().used_heap_size;
+  let startUsage = process.resourceUsage();
   const loopDelay = monitorEventLoopDelay({ resolution: 20 });
   loopDelay.enable();
 
@@ -892,6 +1071,13 @@ const startDiagnostics = (
   activeTransportCollector = transportCalls;
 
   return {
+    markMeasured: () => {
+      gcProfiler.stop();
+      gcProfiler = new v8.GCProfiler();
+      gcProfiler.start();
+      startHeapUsed = v8.getHeapStatistics().used_heap_size;
+      startUsage = process.resourceUsage();
+    },
     stop: (extras?: DiagnosticsExtras) => {
       serverInstance.off("backpressure", onBackpressure as never);
       serverInstance.off("drain", onDrain as never);
@@ -900,6 +1086,29 @@ const startDiagnostics = (
       loopDelay.disable();
 
       const gc = diffGcTotals(startGc);
+      const freedBytes = (gcProfiler.stop()?.statistics ?? []).reduce(
+        (sum, event) =>
+          sum +
+          Math.max(
+            0,
+            event.beforeGC.heapStatistics.usedHeapSize -
+              event.afterGC.heapStatistics.usedHeapSize,
+          ),
+        0,
+      );
+      const usage = process.resourceUsage();
+      const resources = {
+        allocatedBytes: Math.max(
+          0,
+          v8.getHeapStatistics().used_heap_size - startHeapUsed + freedBytes,
+        ),
+        userCpuMs: microsToMillis(usage.userCPUTime - startUsage.userCPUTime),
+        systemCpuMs: microsToMillis(usage.systemCPUTime - startUsage.systemCPUTime),
+        voluntaryContextSwitches:
+          usage.voluntaryContextSwitches - startUsage.voluntaryContextSwitches,
+        involuntaryContextSwitches:
+          usage.involuntaryContextSwitches - startUsage.involuntaryContextSwitches,
+      };
       const eluDelta: EventLoopUtilization =
         performance.eventLoopUtilization(startElu);
       const eventLoop = {
@@ -936,6 +1145,7 @@ const startDiagnostics = (
         backpressure,
         batching,
         transportCalls,
+        resources,
         flow: extras?.flowDiagnostics,
         clientFlow: extras?.clientFlowDiagnostics,
         clientBatch: extras?.clientBatchStats,
@@ -994,6 +1204,12 @@ const BENCH_ENV_KEYS = [
   "QWORMHOLE_BENCH_MESSAGES",
   "QWORMHOLE_BENCH_CLIENTS",
   "QWORMHOLE_BENCH_YIELD_EVERY",
+  "QWORMHOLE_BENCH_REPEAT",
+  "QWORMHOLE_BENCH_WARMUP_RUNS",
+  "QWORMHOLE_BENCH_RATE",
+  "QWORMHOLE_BENCH_LATENCY",
+  "QWORMHOLE_BENCH_TIMESTAMPING",
+  "QWORMHOLE_BENCH_IMPAIRMENT",
   "QWORMHOLE_BENCH_HWM",
   "QWORMHOLE_BENCH_FLOW_FAST",
   "QWORMHOLE_BENCH_COHERENCE",
@@ -1099,6 +1315,37 @@ const summarizeNumberSet = (
   };
 };
 
+/**
+ * Per-message costs from diagnostics. writeCalls counts transport write
+ * calls (writev, write, native send/sendMany), one syscall each at most, as
+ * the closest stand-in for syscalls/msg the bench can see from JS.
+ */
+const perMessageCosts = (
+  res: ScenarioResult,
+): { allocBytes?: number; writeCalls?: number; cpuUs?: number } => {
+  const diag = res.diagnostics;
+  const messages = res.messagesReceived;
+  if (!diag || messages <= 0) return {};
+  const calls = diag.transportCalls;
+  const resources = diag.resources;
+  return {
+    allocBytes: resources ? resources.allocatedBytes / messages : undefined,
+    writeCalls: calls
+      ? (calls.batchWritevCalls +
+          calls.writeBufferCalls +
+          calls.nativeSendCalls +
+          calls.nativeSendManyCalls) /
+        messages
+      : undefined,
+    cpuUs: resources
+      ? ((resources.userCpuMs + resources.systemCpuMs) * 1000) / messages
+      : undefined,
+  };
+};
+
+const finiteSamples = (values: Array<number | undefined>): number[] =>
+  values.filter((value): value is number => Number.isFinite(value));
+
 const attachRepeatStats = (
   representative: ScenarioResult,
   runs: ScenarioResult[],
@@ -1124,6 +1371,17 @@ const attachRepeatStats = (
       representative: successful.length > 0 ? "median" : "first",
       msgsPerSec,
       durationMs,
+      // Every run's value, for generate-bench-regression-report.js.
+      samples: {
+        msgsPerSec: finiteSamples(successful.map(run => run.msgsPerSec)),
+        p99Ms: finiteSamples(successful.map(run => run.messageLatency?.p99Ms)),
+        allocBytesPerMsg: finiteSamples(
+          successful.map(run => perMessageCosts(run).allocBytes),
+        ),
+        writeCallsPerMsg: finiteSamples(
+          successful.map(run => perMessageCosts(run).writeCalls),
+        ),
+      },
     },
   };
 };
@@ -1770,6 +2028,7 @@ async function childMain(): Promise<void> {
         deserializer: (data: Buffer) => data as Buffer,
         preferNative: msg.scenario.preferNativeServer,
         preferredNativeBackend: msg.scenario.serverBackend,
+        loop: msg.scenario.serverLoop,
         disableFlowController: BENCH_DISABLE_FLOW,
         flowFastPath: BENCH_FLOW_FAST,
         coherence: msg.benchCoherence
@@ -1881,6 +2140,7 @@ async function runScenarioForked({
   preferNativeServer,
   clientMode,
   serverBackend,
+  serverLoop,
 }: Scenario): Promise<ScenarioResult> {
   const scenarioFraming = framingForClientMode(clientMode);
   if (isBaselineMode(clientMode)) {
@@ -1906,7 +2166,7 @@ async function runScenarioForked({
 
     child.send?.({
       type: "init",
-      scenario: { id, preferNativeServer, clientMode, serverBackend },
+      scenario: { id, preferNativeServer, clientMode, serverBackend, serverLoop },
       framing: scenarioFraming,
       totalMessages: TOTAL_MESSAGES,
       enableDiagnostics: false,
@@ -2018,7 +2278,7 @@ async function runScenarioForked({
 
   child.send?.({
     type: "init",
-    scenario: { id, preferNativeServer, clientMode, serverBackend },
+    scenario: { id, preferNativeServer, clientMode, serverBackend, serverLoop },
     framing: scenarioFraming,
     totalMessages: TOTAL_MESSAGES,
     enableDiagnostics: ENABLE_DIAGNOSTICS,
@@ -2326,6 +2586,19 @@ async function runScenarioForked({
 }
 
 async function runScenarioRepeated(scenario: Scenario): Promise<ScenarioResult> {
+  const runOnce = () =>
+    isBaselineMode(scenario.clientMode)
+      ? runBaselineScenario(
+          scenario.clientMode,
+          framingForClientMode(scenario.clientMode),
+        )
+      : BENCH_FORK && !BENCH_CHILD
+        ? runScenarioForked(scenario)
+        : runScenario(scenario);
+  for (let i = 0; i < BENCH_WARMUP_RUNS; i++) {
+    const warmup = await runOnce();
+    if (warmup.skipped) return warmup;
+  }
   const runs: ScenarioResult[] = [];
   for (let i = 0; i < BENCH_REPEAT; i++) {
     if (BENCH_CSV_PATH !== "") {
@@ -2333,14 +2606,7 @@ async function runScenarioRepeated(scenario: Scenario): Promise<ScenarioResult>
         `[bench] starting ${scenario.id}${BENCH_REPEAT > 1 ? ` (run ${i + 1}/${BENCH_REPEAT})` : ""}`,
       );
     }
-    const result = isBaselineMode(scenario.clientMode)
-      ? await runBaselineScenario(
-          scenario.clientMode,
-          framingForClientMode(scenario.clientMode),
-        )
-      : BENCH_FORK && !BENCH_CHILD
-        ? await runScenarioForked(scenario)
-        : await runScenario(scenario);
+    const result = await runOnce();
     runs.push(result);
     if (BENCH_CSV_PATH !== "") {
       console.log(
@@ -2359,6 +2625,7 @@ async function runScenario({
   preferNativeServer,
   clientMode,
   serverBackend,
+  serverLoop,
 }: Scenario): Promise<ScenarioResult> {
   const concurrency = buildConcurrencySummary();
   const scenarioFraming = framingForClientMode(clientMode);
@@ -2373,6 +2640,7 @@ async function runScenario({
       preferNativeServer,
       clientMode,
       serverBackend,
+      serverLoop,
     });
   }
   if (BENCH_TRACE) {
@@ -2440,6 +2708,9 @@ async function runScenario({
     deserializer: (data: Buffer) => data as Buffer,
     preferNative: preferNativeServer,
     preferredNativeBackend: serverBackend,
+    timestamping: serverBackend === "libsocket" ? BENCH_TIMESTAMPING : undefined,
+    impairment: serverBackend === "lws" ? BENCH_IMPAIRMENT : undefined,
+    loop: serverLoop,
     disableFlowController: BENCH_DISABLE_FLOW,
     flowFastPath: BENCH_FLOW_FAST,
     coherence: BENCH_COHERENCE
@@ -2591,22 +2862,64 @@ async function runScenario({
         };
       }
       for (const client of nativeClients) {
-        client.connect("127.0.0.1", port);
+        if (backend === "lws" && BENCH_IMPAIRMENT) {
+          client.connect({ host: "127.0.0.1", port, impairment: BENCH_IMPAIRMENT });
+        } else {
+          client.connect("127.0.0.1", port);
+        }
       }
     }
   }
 
   let messagesReceived = 0;
   let bytesReceived = 0;
-  const onMessage = ({ data }: { data: Buffer }) => {
+  const latencyHistogram = BENCH_LATENCY ? new LatencyHistogram() : null;
+  const splitHistograms =
+    BENCH_LATENCY && BENCH_TIMESTAMPING
+      ? {
+          wire: new LatencyHistogram(),
+          kernel: new LatencyHistogram(),
+          native: new LatencyHistogram(),
+          js: new LatencyHistogram(),
+        }
+      : null;
+  let recordLatency = false;
+  const onMessage = ({
+    data,
+    timestamps,
+  }: {
+    data: Buffer;
+    timestamps?: NativeRxTimestamps;
+  }) => {
     const buffer = Buffer.isBuffer(data) ? data : toBytes(data);
     messagesReceived += 1;
     bytesReceived += buffer.length;
+    if (recordLatency && buffer.length >= LATENCY_STAMP_BYTES) {
+      const now = performance.now();
+      const stampMs = buffer.readDoubleLE(0);
+      latencyHistogram?.record(now - stampMs);
+      if (splitHistograms && timestamps) {
+        // One process, so the stamp moves onto the wall clock unchanged.
+        const split = splitLatency(
+          (performance.timeOrigin + stampMs) * 1000,
+          timestamps,
+          (performance.timeOrigin + now) * 1000,
+        );
+        splitHistograms.wire.record(split.wireMs);
+        splitHistograms.kernel.record(split.kernelMs);
+        splitHistograms.native.record(split.nativeMs);
+        splitHistograms.js.record(split.jsMs);
+      }
+    }
   };
   serverInstance.on("message", onMessage as never);
 
   let duration = 0;
   let diagnostics: ScenarioDiagnostics | undefined;
+  // lws getStats() counters over the measured messages only.
+  type SideCosts = { server?: NativeCostCounters; client?: NativeCostCounters };
+  let nativeCostsStart: SideCosts | undefined;
+  let nativeCosts: SideCosts | undefined;
   const sendBlockDurations: number[] = [];
   const blockSampleSize =
     Number(process.env.QWORMHOLE_BENCH_BLOCK_SIZE ?? "1000") || 1000;
@@ -2662,6 +2975,11 @@ async function runScenario({
       blockCount = 0;
       blockStart = ENABLE_DIAGNOSTICS ? performance.now() : 0;
     }
+    diagnosticsScope?.markMeasured?.();
+    nativeCostsStart = {
+      server: readNativeCosts([serverInstance as never]),
+      client: readNativeCosts(nativeClients as never[]),
+    };
     const start = performance.now();
     const benchStart = performance.now();
     if (ENABLE_DIAGNOSTICS) {
@@ -2669,7 +2987,20 @@ async function runScenario({
       heapPeakUsed = heapStart.heapUsed;
       heapPeakRss = heapStart.rss;
     }
+    recordLatency = latencyHistogram !== null;
+    const intervalMs = BENCH_RATE ? 1000 / BENCH_RATE : 0;
     for (let i = 0; i < TOTAL_MESSAGES; i++) {
+      let stampMs = 0;
+      if (latencyHistogram) {
+        stampMs = BENCH_RATE ? start + i * intervalMs : performance.now();
+        const aheadMs = stampMs - performance.now();
+        if (aheadMs >= 1) {
+          nativeClients.forEach((client, index) =>
+            flushNativeBenchBatch(client, nativeBatches[index]),
+          );
+          await sleep(aheadMs);
+        }
+      }
       if (BENCH_YIELD_EVERY && i > 0 && i % BENCH_YIELD_EVERY === 0) {
         nativeClients.forEach((client, index) =>
           flushNativeBenchBatch(client, nativeBatches[index]),
@@ -2678,15 +3009,25 @@ async function runScenario({
       }
       const clientIndex = i % BENCH_CLIENTS;
       if (tsClients.length > 0) {
-        sendBenchPayloadAt(
-          i + WARMUP_MESSAGES,
-          tsClients[clientIndex],
-          null,
-          scenarioFraming,
-        );
+        if (latencyHistogram) {
+          void tsClients[clientIndex].send(
+            stampBenchPayload(i + WARMUP_MESSAGES, scenarioFraming, stampMs, false),
+          );
+        } else {
+          sendBenchPayloadAt(
+            i + WARMUP_MESSAGES,
+            tsClients[clientIndex],
+            null,
+            scenarioFraming,
+          );
+        }
       } else if (nativeClients.length > 0) {
         const nativeBatch = nativeBatches[clientIndex];
-        nativeBatch.push(getNativePayload(i + WARMUP_MESSAGES, scenarioFraming));
+        nativeBatch.push(
+          latencyHistogram
+            ? stampBenchPayload(i + WARMUP_MESSAGES, scenarioFraming, stampMs, true)
+            : getNativePayload(i + WARMUP_MESSAGES, scenarioFraming),
+        );
         if (nativeBatch.length >= NATIVE_SEND_BATCH_SIZE) {
           flushNativeBenchBatch(nativeClients[clientIndex], nativeBatch);
         }
@@ -2789,6 +3130,18 @@ async function runScenario({
       heapEnd = process.memoryUsage();
     }
     serverInstance.off("message", onMessage as never);
+    if (nativeCostsStart) {
+      nativeCosts = {
+        server: diffNativeCosts(
+          readNativeCosts([serverInstance as never]),
+          nativeCostsStart.server,
+        ),
+        client: diffNativeCosts(
+          readNativeCosts(nativeClients as never[]),
+          nativeCostsStart.client,
+        ),
+      };
+    }
     if (tsClients.length > 0) {
       const clientSnapshot = await snapshotClientDiagnostics(tsClients[0]);
       clientFlowDiagnostics = clientSnapshot.flow ?? clientFlowDiagnostics;
@@ -2856,6 +3209,12 @@ async function runScenario({
     msgsPerSec,
     mbPerSec,
     benchConfig,
+    messageLatency: latencyHistogram
+      ? summarizeMessageLatency(latencyHistogram)
+      : undefined,
+    latencySplit: splitHistograms ? summarizeLatencySplit(splitHistograms) : undefined,
+    nativeCosts:
+      nativeCosts?.server || nativeCosts?.client ? nativeCosts : undefined,
     diagnostics: diagnostics ? { ...diagnostics, coherenceTrace } : undefined,
   };
 }
@@ -3389,7 +3748,19 @@ const buildJsonlEntry = (
       sendBlockAvgMs: diag?.sendBlocks?.avgMs,
       sendBlockMinMs: diag?.sendBlocks?.minMs,
       sendBlockMaxMs: diag?.sendBlocks?.maxMs,
+      messageP50Ms: res.messageLatency?.p50Ms,
+      messageP99Ms: res.messageLatency?.p99Ms,
+      messageP999Ms: res.messageLatency?.p999Ms,
+      messageMaxMs: res.messageLatency?.maxMs,
+    },
+    messageLatency: res.messageLatency,
+    perMessage: {
+      ...perMessageCosts(res),
+      nativeServer: perMessageNativeCosts(res.nativeCosts?.server, res.messagesReceived),
+      nativeClient: perMessageNativeCosts(res.nativeCosts?.client, res.messagesReceived),
     },
+    nativeCosts: res.nativeCosts,
+    resources: diag?.resources,
     heap: diag?.heap,
     clientBatch: diag?.clientBatch,
     clientQueue: diag?.clientQueue,
@@ -3475,6 +3846,35 @@ const writeBenchReport = async (results: ScenarioResult[]): Promise<void> => {
       ];
     });
 
+  const latencyRows = results
+    .filter(res => !res.skipped && res.messageLatency)
+    .map(res => {
+      const latency = res.messageLatency!;
+      return [
+        res.id,
+        latency.openLoop ? formatNumber(latency.targetRate, 0) : "closed",
+        latency.count,
+        formatNumber(latency.p50Ms, 3),
+        formatNumber(latency.p90Ms, 3),
+        formatNumber(latency.p99Ms, 3),
+        formatNumber(latency.p999Ms, 3),
+        formatNumber(latency.maxMs, 3),
+        latency.native ? "native" : "js",
+      ];
+    });
+
+  const splitRows = results
+    .filter(res => !res.skipped && res.latencySplit)
+    .map(res => {
+      const split = res.latencySplit!;
+      return [
+        res.id,
+        ...(["wire", "kernel", "native", "js"] as const).map(
+          key => `${formatNumber(split[key].p50Ms, 3)} / ${formatNumber(split[key].p99Ms, 3)}`,
+        ),
+      ];
+    });
+
   const transportRows = results
     .filter(res => !res.skipped && res.diagnostics)
     .map(res => {
@@ -3595,6 +3995,35 @@ const writeBenchReport = async (results: ScenarioResult[]): Promise<void> => {
       diagnosticsRows,
     ),
     ``,
+    ...(latencyRows.length > 0
+      ? [
+          `## Message Latency`,
+          ``,
+          renderMarkdownTable(
+            [
+              "Scenario",
+              "Rate",
+              "Samples",
+              "p50 ms",
+              "p90 ms",
+              "p99 ms",
+              "p99.9 ms",
+              "Max ms",
+              "Histogram",
+            ],
+            latencyRows,
+          ),
+          ``,
+        ]
+      : []),
+    ...(splitRows.length > 0
+      ? [
+          `## Latency Split (p50 / p99 ms)`,
+          ``,
+          renderMarkdownTable(["Scenario", "Wire", "Kernel", "Native", "JS"], splitRows),
+          ``,
+        ]
+      : []),
     `## Transport Coherence`,
     ``,
     ...transportFindings.map(line => `- ${line}`),
@@ -3649,6 +4078,51 @@ const writeJsonlResults = async (results: ScenarioResult[]): Promise<void> => {
   }
 };
 
+const writeTraceResults = (results: ScenarioResult[]): void => {
+  if (!BENCH_TRACE_PATH) return;
+  const recorder = new TelemetryTraceRecorder(BENCH_TRACE_PATH);
+  for (const res of results) {
+    if (res.skipped) continue;
+    const transport =
+      res.diagnostics?.clientFlow?.transportCoherence ??
+      res.diagnostics?.flow?.transportCoherence;
+    recorder.record(
+      "benchScenario",
+      [
+        res.concurrency?.clients ?? BENCH_CLIENTS,
+        res.messagesReceived,
+        res.bytesReceived,
+        res.durationMs,
+        res.msgsPerSec ?? NaN,
+        res.mbPerSec ?? NaN,
+        transport?.transportSNI ?? NaN,
+        transport?.transportSPI ?? NaN,
+        transport?.transportMetastability ?? NaN,
+      ],
+      res.id,
+    );
+    const latency = res.messageLatency;
+    if (latency) {
+      recorder.record(
+        "benchLatency",
+        [latency.count, latency.p50Ms, latency.p90Ms, latency.p99Ms, latency.p999Ms, latency.maxMs],
+        res.id,
+      );
+      const buckets = latency.buckets ?? [];
+      recorder.writeBlock(
+        "histogram",
+        [0, 1, 2].map(c => buckets.map(bucket => bucket[c])),
+        `${res.id}:latency`,
+      );
+    }
+  }
+  recorder.close();
+  if (BENCH_CSV_PATH !== "") {
+    // eslint-disable-next-line no-console
+    console.log(`[bench] trace appended to ${BENCH_TRACE_PATH}`);
+  }
+};
+
 function classifyTransportHealth(
   transportSPI?: number,
   transportMetastability?: number,
@@ -3692,6 +4166,7 @@ async function mainBench() {
   }
 
   await writeJsonlResults(results);
+  writeTraceResults(results);
   await writeBenchReport(results);
 
   const csvPath = BENCH_CSV_PATH;
@@ -3784,6 +4259,16 @@ async function mainBench() {
     );
   }
 
+  for (const res of results) {
+    const latency = res.messageLatency;
+    if (!latency || res.skipped) continue;
+    console.log(
+      `[latency] ${res.id}${latency.openLoop ? ` @ ${latency.targetRate} msg/s` : ""}: ` +
+        `p50 ${latency.p50Ms.toFixed(3)} ms, p99 ${latency.p99Ms.toFixed(3)} ms, ` +
+        `p99.9 ${latency.p999Ms.toFixed(3)} ms, max ${latency.maxMs.toFixed(3)} ms`,
+    );
+  }
+
   if (ENABLE_DIAGNOSTICS) {
     const diagHeader = `${pad("Scenario", 28)}${pad("GC", 12)}${pad(
       "GC ms",
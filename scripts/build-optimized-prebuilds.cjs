@@ -0,0 +1,159 @@
+#!/usr/bin/env node
+/* eslint-disable no-console */
+// Optimized Linux prebuilds: for each variant, an instrumented build
+// (QWORMHOLE_NATIVE_OPT=pgo-gen) is trained with the bench:core workload,
+// then rebuilt with LTO and the recorded profile (pgo-use) and staged with
+// scripts/stage-prebuilds.cjs.
+//
+//   node scripts/build-optimized-prebuilds.cjs [--variants baseline,x86-64-v3]
+//        [--no-pgo] [--lws] [--train "pnpm run bench:core"]
+//
+// --lws rebuilds libwebsockets/build/lib/libwebsockets.a with the same
+// flags first, so LTO and the profile reach across the lws/addon boundary
+// (needs cmake and a configured libwebsockets tree). A variant the build
+// host cannot run is built without PGO, since it cannot be trained here.
+// Profiles live in .pgo/<variant>, outside build/, which node-gyp rebuild
+// wipes between the two builds.
+const { spawnSync } = require("node:child_process");
+const fs = require("node:fs");
+const os = require("node:os");
+const path = require("node:path");
+
+const cwd = process.cwd();
+const args = process.argv.slice(2);
+const flagValue = (name, fallback) => {
+  const at = args.indexOf(name);
+  return at >= 0 && args[at + 1] ? args[at + 1] : fallback;
+};
+const variants = flagValue("--variants", "baseline")
+  .split(",")
+  .map(v => v.trim())
+  .filter(Boolean);
+const usePgo = !args.includes("--no-pgo");
+const rebuildLws = args.includes("--lws");
+const trainCommand = flagValue("--train", "pnpm run bench:core");
+
+if (os.platform() !== "linux") {
+  console.error("[qwormhole] optimized prebuilds use GCC LTO/PGO flags and are Linux-only");
+  process.exit(1);
+}
+
+// Keep in step with X86_64_V3_FLAGS in src/core/native-addons.ts.
+const X86_64_V3_FLAGS = ["avx", "avx2", "bmi1", "bmi2", "f16c", "fma", "movbe", "abm", "xsave"];
+const hostRuns = variant => {
+  if (variant === "baseline") return true;
+  if (variant !== "x86-64-v3" || os.arch() !== "x64") return false;
+  try {
+    const line = /^flags\s*:(.*)$/m.exec(fs.readFileSync("/proc/cpuinfo", "utf8"));
+    const flags = new Set((line?.[1] ?? "").trim().split(/\s+/));
+    return X86_64_V3_FLAGS.every(flag => flags.has(flag));
+  } catch {
+    return false;
+  }
+};
+
+const run = (command, commandArgs, env) => {
+  console.log(`[qwormhole] ${command} ${commandArgs.join(" ")}`);
+  const result = spawnSync(command, commandArgs, {
+    stdio: "inherit",
+    env: { ...process.env, ...env },
+    shell: commandArgs.length === 0,
+  });
+  if (result.status !== 0) {
+    console.error(`[qwormhole] "${command}" failed (status ${result.status})`);
+    process.exit(result.status ?? 1);
+  }
+};
+
+const gccFlags = (opt, march, profileDir) => {
+  const flags = ["-O3", "-flto=auto", "-ffat-lto-objects", "-fPIC"];
+  if (opt === "pgo-gen") flags.push(`-fprofile-generate=${profileDir}`, "-fprofile-update=atomic");
+  if (opt === "pgo-use") {
+    flags.push(`-fprofile-use=${profileDir}`, "-fprofile-partial-training", "-Wno-missing-profile");
+  }
+  if (march) flags.push(`-march=${march}`);
+  return flags.join(" ");
+};
+
+const buildLws = (opt, march, profileDir) => {
+  const lwsRoot = path.join(cwd, "libwebsockets");
+  const buildDir = path.join(lwsRoot, "build-optimized");
+  const flags = gccFlags(opt, march, profileDir);
+  run("cmake", [
+    "-S",
+    lwsRoot,
+    "-B",
+    buildDir,
+    "-DCMAKE_BUILD_TYPE=Release",
+    "-DCMAKE_POSITION_INDEPENDENT_CODE=ON",
+    "-DCMAKE_AR=gcc-ar",
+    "-DCMAKE_RANLIB=gcc-ranlib",
+    `-DCMAKE_C_FLAGS=${flags}`,
+    "-DLWS_WITH_STATIC=ON",
+    "-DLWS_WITH_SHARED=OFF",
+    "-DLWS_WITH_SSL=ON",
+    "-DLWS_WITH_ZLIB=ON",
+    "-DLWS_IPV6=ON",
+  ]);
+  run("cmake", ["--build", buildDir, "--config", "Release", "--parallel"]);
+  fs.mkdirSync(path.join(lwsRoot, "build", "lib"), { recursive: true });
+  fs.copyFileSync(
+    path.join(buildDir, "lib", "libwebsockets.a"),
+    path.join(lwsRoot, "build", "lib", "libwebsockets.a"),
+  );
+};
+
+const buildAddons = (opt, march, profileDir) => {
+  if (rebuildLws) buildLws(opt, march, profileDir);
+  run(process.execPath, [require.resolve("node-gyp/bin/node-gyp.js"), "rebuild"], {
+    QWORMHOLE_NATIVE_OPT: opt,
+    QWORMHOLE_NATIVE_MARCH: march,
+    QWORMHOLE_NATIVE_PROFILE_DIR: profileDir,
+  });
+};
+
+// The training run loads the instrumented addons straight from build/Release.
+const train = () => {
+  const manifestPath = path.join(cwd, ".pgo", "bindings.json");
+  const bindings = {};
+  for (const name of ["qwormhole_lws", "qwormhole"]) {
+    const file = path.join("build", "Release", `${name}.node`);
+    if (fs.existsSync(path.join(cwd, file))) bindings[name] = file;
+  }
+  fs.writeFileSync(
+    manifestPath,
+    JSON.stringify({
+      version: 1,
+      abi: process.versions.modules,
+      platform: os.platform(),
+      arch: os.arch(),
+      bindings,
+    }),
+  );
+  run(trainCommand, [], {
+    QWORMHOLE_BINDING_MANIFEST: manifestPath,
+    QWORMHOLE_NATIVE_VARIANT: "baseline",
+  });
+};
+
+for (const variant of variants) {
+  const march = variant === "baseline" ? "" : variant;
+  const profileDir = path.join(cwd, ".pgo", variant);
+  const trained = usePgo && hostRuns(variant);
+  if (usePgo && !trained) {
+    console.warn(`[qwormhole] this host cannot run ${variant}; building it with LTO only`);
+  }
+  if (trained) {
+    fs.rmSync(profileDir, { recursive: true, force: true });
+    fs.mkdirSync(profileDir, { recursive: true });
+    buildAddons("pgo-gen", march, profileDir);
+    train();
+  }
+  buildAddons(trained ? "pgo-use" : "lto", march, profileDir);
+  run(
+    process.execPath,
+    [path.join(__dirname, "stage-prebuilds.cjs"), ...(march ? ["--variant", variant] : [])],
+  );
+}
+
+console.log(`[qwormhole] optimized prebuilds staged: ${variants.join(", ")}`);
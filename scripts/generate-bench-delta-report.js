@@ -148,6 +148,10 @@ const rows = scenarios
       rawRange,
       structureRange,
       varianceReduction: varianceReductionPercent(rawRange, structureRange),
+      rawP99: raw?.messageLatency?.p99Ms,
+      structureP99: structure?.messageLatency?.p99Ms,
+      rawP999: raw?.messageLatency?.p999Ms,
+      structureP999: structure?.messageLatency?.p999Ms,
       classification: undefined,
     };
   })
@@ -191,6 +195,31 @@ const lines = [
       )} | ${row.classification} |`,
   ),
   "",
+];
+
+// Only runs with QWORMHOLE_BENCH_RATE / QWORMHOLE_BENCH_LATENCY carry these.
+const latencyRows = rows.filter(
+  row => Number.isFinite(row.rawP99) && Number.isFinite(row.structureP99),
+);
+if (latencyRows.length > 0) {
+  lines.push(
+    "## Message Latency",
+    "",
+    "| Scenario | Raw p99 ms | Structure p99 ms | p99 Delta | Raw p99.9 ms | Structure p99.9 ms | p99.9 Delta |",
+    "| --- | --- | --- | --- | --- | --- | --- |",
+    ...latencyRows.map(
+      row =>
+        `| ${row.scenario} | ${fmt(row.rawP99, 3)} | ${fmt(row.structureP99, 3)} | ${pct(
+          deltaPercent(row.rawP99, row.structureP99),
+        )} | ${fmt(row.rawP999, 3)} | ${fmt(row.structureP999, 3)} | ${pct(
+          deltaPercent(row.rawP999, row.structureP999),
+        )} |`,
+    ),
+    "",
+  );
+}
+
+lines.push(
   "## Classification",
   "",
   "- `overhead`: structure materially slower on throughput.",
@@ -203,7 +232,7 @@ const lines = [
   "",
   "## Interpretation",
   "",
-];
+);
 
 const pureTs = rows.find(row => row.scenario === "ts-server+ts");
 const nativeHybrid = rows.filter(
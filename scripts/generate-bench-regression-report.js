@@ -0,0 +1,256 @@
+const fs = require("node:fs");
+const path = require("node:path");
+
+const args = process.argv.slice(2);
+
+const readArg = name => {
+  const index = args.indexOf(name);
+  if (index === -1) return undefined;
+  return args[index + 1];
+};
+
+const baselinePath = readArg("--baseline");
+const candidatePath = readArg("--candidate");
+const outPath = readArg("--out");
+const title = readArg("--title") || "QWormhole Bench Regression Report";
+// Two-sided Mann-Whitney significance level and the smallest median shift
+// worth flagging; a significant 0.5% shift is real but not actionable.
+const alpha = Number(readArg("--alpha") ?? "0.05");
+const minEffectPercent = Number(readArg("--min-effect") ?? "2");
+const iterations = Number(readArg("--bootstrap") ?? "2000");
+const failOnRegression = args.includes("--fail-on-regression");
+
+if (!baselinePath || !candidatePath || !outPath) {
+  console.error(
+    "usage: node scripts/generate-bench-regression-report.js --baseline <a.jsonl> --candidate <b.jsonl> --out <report.md> [--title <title>] [--alpha 0.05] [--min-effect 2] [--bootstrap 2000] [--fail-on-regression]",
+  );
+  process.exit(1);
+}
+
+const METRICS = [
+  { key: "msgsPerSec", label: "Msg/s", higherIsBetter: true, digits: 0 },
+  { key: "p99Ms", label: "p99 ms", higherIsBetter: false, digits: 3 },
+  { key: "allocBytesPerMsg", label: "Alloc B/msg", higherIsBetter: false, digits: 1 },
+  { key: "writeCallsPerMsg", label: "Writes/msg", higherIsBetter: false, digits: 4 },
+];
+
+// Older records (or one record per run) have no repeatStats.samples; their
+// single values still count as one sample each.
+const singleValue = (record, key) => {
+  switch (key) {
+    case "msgsPerSec":
+      return record.msgsPerSec;
+    case "p99Ms":
+      return record.messageLatency?.p99Ms;
+    case "allocBytesPerMsg":
+      return record.perMessage?.allocBytes;
+    case "writeCallsPerMsg":
+      return record.perMessage?.writeCalls;
+    default:
+      return undefined;
+  }
+};
+
+const fmt = (value, digits = 2, fallback = "-") =>
+  Number.isFinite(value) ? Number(value).toFixed(digits) : fallback;
+
+const pct = (value, digits = 1) =>
+  Number.isFinite(value)
+    ? `${value >= 0 ? "+" : ""}${Number(value).toFixed(digits)}%`
+    : "-";
+
+const readJsonl = filePath => {
+  if (!fs.existsSync(filePath)) return [];
+  return fs
+    .readFileSync(filePath, "utf8")
+    .split(/\r?\n/)
+    .map(line => line.trim())
+    .filter(Boolean)
+    .map(line => {
+      try {
+        return JSON.parse(line);
+      } catch {
+        return null;
+      }
+    })
+    .filter(Boolean);
+};
+
+const samplesByScenario = records => {
+  const byScenario = new Map();
+  for (const record of records) {
+    if (!record?.scenario || record.skipped) continue;
+    const entry = byScenario.get(record.scenario) ?? {};
+    for (const { key } of METRICS) {
+      const values = record.repeatStats?.samples?.[key] ?? [singleValue(record, key)];
+      entry[key] = (entry[key] ?? []).concat(values.filter(Number.isFinite));
+    }
+    byScenario.set(record.scenario, entry);
+  }
+  return byScenario;
+};
+
+const median = values => {
+  const sorted = [...values].sort((a, b) => a - b);
+  const mid = Math.floor(sorted.length / 2);
+  return sorted.length % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2;
+};
+
+const normalCdf = z => {
+  // Abramowitz-Stegun 7.1.26; plenty for a p-value threshold.
+  const t = 1 / (1 + 0.3275911 * Math.abs(z) / Math.SQRT2);
+  const poly =
+    t * (0.254829592 + t * (-0.284496736 + t * (1.421413741 + t * (-1.453152027 + t * 1.061405429))));
+  const erf = 1 - poly * Math.exp(-(z * z) / 2);
+  return z >= 0 ? (1 + erf) / 2 : (1 - erf) / 2;
+};
+
+/** Two-sided Mann-Whitney U, normal approximation with tie correction. */
+const mannWhitney = (a, b) => {
+  const pooled = [
+    ...a.map(value => ({ value, group: 0 })),
+    ...b.map(value => ({ value, group: 1 })),
+  ].sort((x, y) => x.value - y.value);
+  const n = pooled.length;
+  let rankSumA = 0;
+  let tieTerm = 0;
+  for (let i = 0; i < n; ) {
+    let j = i;
+    while (j + 1 < n && pooled[j + 1].value === pooled[i].value) j += 1;
+    const rank = (i + j) / 2 + 1;
+    const ties = j - i + 1;
+    tieTerm += ties ** 3 - ties;
+    for (let k = i; k <= j; k += 1) {
+      if (pooled[k].group === 0) rankSumA += rank;
+    }
+    i = j + 1;
+  }
+  const n1 = a.length;
+  const n2 = b.length;
+  const u = rankSumA - (n1 * (n1 + 1)) / 2;
+  const mean = (n1 * n2) / 2;
+  const variance = ((n1 * n2) / 12) * (n + 1 - tieTerm / (n * (n - 1)));
+  if (variance <= 0) return { u, p: 1 };
+  const z = (Math.abs(u - mean) - 0.5) / Math.sqrt(variance);
+  return { u, p: Math.min(1, 2 * (1 - normalCdf(Math.max(0, z)))) };
+};
+
+// Seeded so the same inputs always give the same report.
+const mulberry32 = seed => () => {
+  seed = (seed + 0x6d2b79f5) | 0;
+  let t = Math.imul(seed ^ (seed >>> 15), seed | 1);
+  t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+  return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+};
+
+/** Percentile bootstrap CI of the relative median shift, in percent. */
+const bootstrapMedianShift = (a, b, confidence = 1 - alpha) => {
+  const random = mulberry32(0x5157);
+  const resample = values =>
+    values.map(() => values[Math.floor(random() * values.length)]);
+  const shifts = [];
+  for (let i = 0; i < iterations; i += 1) {
+    const base = median(resample(a));
+    if (base === 0) continue;
+    shifts.push(((median(resample(b)) - base) / base) * 100);
+  }
+  shifts.sort((x, y) => x - y);
+  if (shifts.length === 0) return [undefined, undefined];
+  const tail = (1 - confidence) / 2;
+  return [
+    shifts[Math.floor(tail * (shifts.length - 1))],
+    shifts[Math.ceil((1 - tail) * (shifts.length - 1))],
+  ];
+};
+
+const compareMetric = (metric, a, b) => {
+  if (a.length < 2 || b.length < 2) {
+    return { n: [a.length, b.length], verdict: "insufficient" };
+  }
+  const baseMedian = median(a);
+  const candMedian = median(b);
+  const shift = baseMedian !== 0 ? ((candMedian - baseMedian) / baseMedian) * 100 : undefined;
+  const { p } = mannWhitney(a, b);
+  const [low, high] = bootstrapMedianShift(a, b);
+  const excludesZero = Number.isFinite(low) && (low > 0 || high < 0);
+  const significant =
+    p < alpha && excludesZero && Number.isFinite(shift) && Math.abs(shift) >= minEffectPercent;
+  const better = metric.higherIsBetter ? shift > 0 : shift < 0;
+  return {
+    n: [a.length, b.length],
+    baseMedian,
+    candMedian,
+    shift,
+    p,
+    ci: [low, high],
+    verdict: significant ? (better ? "improvement" : "regression") : "noise",
+  };
+};
+
+const baseline = samplesByScenario(readJsonl(baselinePath));
+const candidate = samplesByScenario(readJsonl(candidatePath));
+const scenarios = [...candidate.keys()].filter(key => baseline.has(key));
+
+const rows = [];
+for (const scenario of scenarios) {
+  for (const metric of METRICS) {
+    const a = baseline.get(scenario)[metric.key] ?? [];
+    const b = candidate.get(scenario)[metric.key] ?? [];
+    if (a.length === 0 && b.length === 0) continue;
+    rows.push({ scenario, metric, ...compareMetric(metric, a, b) });
+  }
+}
+
+const regressions = rows.filter(row => row.verdict === "regression");
+const improvements = rows.filter(row => row.verdict === "improvement");
+
+const lines = [
+  `# ${title}`,
+  "",
+  `Generated: ${new Date().toISOString()}`,
+  "",
+  "## Inputs",
+  "",
+  "```json",
+  JSON.stringify(
+    { baselinePath, candidatePath, scenarios: scenarios.length, alpha, minEffectPercent, iterations },
+    null,
+    2,
+  ),
+  "```",
+  "",
+  "## Summary",
+  "",
+  `- Regressions: ${regressions.length}`,
+  `- Improvements: ${improvements.length}`,
+  `- Compared: ${rows.length} scenario/metric pairs`,
+  "",
+  "| Scenario | Metric | Runs (base/cand) | Base Median | Cand Median | Shift | CI | p | Verdict |",
+  "| --- | --- | --- | --- | --- | --- | --- | --- | --- |",
+  ...rows.map(
+    row =>
+      `| ${row.scenario} | ${row.metric.label} | ${row.n.join("/")} | ${fmt(
+        row.baseMedian,
+        row.metric.digits,
+      )} | ${fmt(row.candMedian, row.metric.digits)} | ${pct(row.shift)} | ${
+        row.ci ? `${pct(row.ci[0])} .. ${pct(row.ci[1])}` : "-"
+      } | ${fmt(row.p, 3)} | ${row.verdict} |`,
+  ),
+  "",
+  "## Method",
+  "",
+  `- A delta is flagged when the two-sided Mann-Whitney U test gives p < ${alpha}, the ${Math.round(
+    (1 - alpha) * 100,
+  )}% bootstrap CI of the median shift (${iterations} resamples) excludes zero, and the shift is at least ${minEffectPercent}%.`,
+  "- Samples are the per-run values in `repeatStats.samples`, or one value per JSONL line for records without them.",
+  "- Msg/s is better higher; p99, allocated bytes per message and transport write calls per message are better lower.",
+  "- `insufficient` means fewer than two runs on one side; run with `QWORMHOLE_BENCH_REPEAT` of 5 or more.",
+  "",
+];
+
+fs.mkdirSync(path.dirname(outPath), { recursive: true });
+fs.writeFileSync(outPath, `${lines.join("\n")}\n`, "utf8");
+console.log(
+  `[bench] regression report written to ${outPath} (${regressions.length} regressions, ${improvements.length} improvements)`,
+);
+if (failOnRegression && regressions.length > 0) process.exit(2);
@@ -0,0 +1,289 @@
+/**
+ * Compiles the SCP handshake schemas (src/schema/scp.ts) into the table the
+ * lws addon validates handshakes against: z.toJSONSchema() on each schema,
+ * lowered into flat constexpr node/property/enum arrays in
+ * c/qwormhole_handshake_schema.h. Run `pnpm run native:handshake-schema`
+ * after changing the schemas and commit the header; `--check` exits 1 when
+ * the committed header is stale.
+ *
+ * Only the JSON Schema the handshake schemas produce is lowered (types,
+ * const/enum of strings, minLength, numeric bounds, properties, items,
+ * additionalProperties, anyOf, $ref); anything else throws, so a schema
+ * change the native validator cannot follow fails here, not at runtime.
+ */
+
+import fs from "node:fs";
+import path from "node:path";
+import { z } from "zod";
+import {
+  entropyMetricsSchema,
+  handshakePayloadSchema,
+  negentropicHandshakeSchema,
+} from "../src/schema/scp";
+
+type JsonSchema = boolean | { [keyword: string]: unknown };
+
+/** Bit per JSON type; mirrors HandshakeSchemaType in the addon. */
+const TYPE_BITS: Record<string, number> = {
+  null: 1,
+  boolean: 2,
+  number: 4,
+  integer: 4,
+  string: 8,
+  array: 16,
+  object: 32,
+};
+
+const HANDLED = new Set([
+  "$schema",
+  "$id",
+  "$ref",
+  "$defs",
+  "title",
+  "description",
+  "default",
+  "type",
+  "const",
+  "enum",
+  "minLength",
+  "minimum",
+  "maximum",
+  "exclusiveMinimum",
+  "exclusiveMaximum",
+  "properties",
+  "required",
+  "additionalProperties",
+  "propertyNames",
+  "items",
+  "anyOf",
+  "oneOf",
+]);
+
+type Node = {
+  types: number;
+  integer: boolean;
+  minimum: number;
+  maximum: number;
+  exclusiveMinimum: boolean;
+  exclusiveMaximum: boolean;
+  minLength: number;
+  enumFirst: number;
+  enumCount: number;
+  propertyFirst: number;
+  propertyCount: number;
+  additional: number;
+  items: number;
+  anyOfFirst: number;
+  anyOfCount: number;
+};
+
+/** Index 0 accepts anything, 1 accepts nothing (additionalProperties: false). */
+const ANY = 0;
+const NONE = 1;
+
+const lowerHandshakeSchemas = (roots: Record<string, JsonSchema>): string => {
+  const nodes: Node[] = [];
+  const properties: { name: string; node: number; required: boolean }[] = [];
+  const enums: string[] = [];
+  const anyOf: number[] = [];
+  const seen = new Map<object, number>();
+
+  const blank = (): Node => ({
+    types: 0,
+    integer: false,
+    minimum: -Infinity,
+    maximum: Infinity,
+    exclusiveMinimum: false,
+    exclusiveMaximum: false,
+    minLength: 0,
+    enumFirst: 0,
+    enumCount: 0,
+    propertyFirst: 0,
+    propertyCount: 0,
+    additional: ANY,
+    items: ANY,
+    anyOfFirst: 0,
+    anyOfCount: 0,
+  });
+  nodes.push(blank());
+  nodes.push({ ...blank(), types: -1 });
+
+  const lower = (schema: JsonSchema, root: { [keyword: string]: unknown }, at: string): number => {
+    if (schema === true) return ANY;
+    if (schema === false) return NONE;
+    if (typeof schema.$ref === "string") {
+      const ref = schema.$ref;
+      const defs = root.$defs as Record<string, JsonSchema> | undefined;
+      const target =
+        ref === "#" ? root : ref.startsWith("#/$defs/") ? defs?.[ref.slice(8)] : undefined;
+      if (target === undefined) throw new Error(`${at}: unresolved $ref ${ref}`);
+      return lower(target, root, at);
+    }
+    const known = seen.get(schema);
+    if (known !== undefined) return known;
+    for (const keyword of Object.keys(schema)) {
+      if (!HANDLED.has(keyword)) throw new Error(`${at}: unsupported keyword ${keyword}`);
+    }
+    if (Object.keys(schema).every(k => ["$schema", "$id", "title", "description", "default"].includes(k))) {
+      return ANY;
+    }
+    const index = nodes.length;
+    const node = blank();
+    nodes.push(node);
+    // Before the children, so recursive schemas point back here.
+    seen.set(schema, index);
+
+    const types = schema.type === undefined ? [] : [schema.type].flat();
+    for (const type of types) {
+      const bit = TYPE_BITS[type as string];
+      if (bit === undefined) throw new Error(`${at}: unknown type ${String(type)}`);
+      node.types |= bit;
+      node.integer ||= type === "integer";
+    }
+    const values =
+      schema.const !== undefined ? [schema.const] : (schema.enum as unknown[] | undefined);
+    if (values) {
+      if (!values.every(value => typeof value === "string")) {
+        throw new Error(`${at}: only string const/enum values are supported`);
+      }
+      node.types ||= TYPE_BITS.string;
+      node.enumFirst = enums.length;
+      node.enumCount = values.length;
+      enums.push(...(values as string[]));
+    }
+    if (typeof schema.minLength === "number") node.minLength = schema.minLength;
+    if (typeof schema.minimum === "number") node.minimum = schema.minimum;
+    if (typeof schema.maximum === "number") node.maximum = schema.maximum;
+    if (typeof schema.exclusiveMinimum === "number") {
+      node.minimum = schema.exclusiveMinimum;
+      node.exclusiveMinimum = true;
+    }
+    if (typeof schema.exclusiveMaximum === "number") {
+      node.maximum = schema.exclusiveMaximum;
+      node.exclusiveMaximum = true;
+    }
+    if (schema.propertyNames !== undefined) {
+      const names = schema.propertyNames as { [keyword: string]: unknown };
+      if (names.type !== "string" || Object.keys(names).length !== 1) {
+        throw new Error(`${at}: propertyNames beyond {type: "string"} is unsupported`);
+      }
+    }
+    if (schema.properties !== undefined) {
+      const entries = Object.entries(schema.properties as Record<string, JsonSchema>);
+      const required = new Set((schema.required as string[] | undefined) ?? []);
+      if (entries.length > 64) throw new Error(`${at}: more than 64 properties`);
+      const lowered = entries.map(([name, child]) => ({
+        name,
+        node: lower(child, root, `${at}.${name}`),
+        required: required.has(name),
+      }));
+      node.propertyFirst = properties.length;
+      node.propertyCount = lowered.length;
+      properties.push(...lowered);
+    }
+    if (schema.additionalProperties !== undefined) {
+      node.additional = lower(
+        schema.additionalProperties as JsonSchema,
+        root,
+        `${at}.additionalProperties`,
+      );
+    }
+    if (schema.items !== undefined) {
+      node.items = lower(schema.items as JsonSchema, root, `${at}[]`);
+    }
+    const alternatives = (schema.anyOf ?? schema.oneOf) as JsonSchema[] | undefined;
+    if (alternatives) {
+      const lowered = alternatives.map((alt, i) => lower(alt, root, `${at}|${i}`));
+      node.anyOfFirst = anyOf.length;
+      node.anyOfCount = lowered.length;
+      anyOf.push(...lowered);
+    }
+    return index;
+  };
+
+  const rootIndices = Object.entries(roots).map(([name, schema]) => {
+    if (typeof schema !== "object") throw new Error(`${name}: root must be an object schema`);
+    return [name, lower(schema, schema, name)] as const;
+  });
+
+  const number = (value: number) =>
+    value === Infinity
+      ? "kSchemaInf"
+      : value === -Infinity
+        ? "-kSchemaInf"
+        : Number.isInteger(value)
+          ? `${value}.0`
+          : String(value);
+  const flags = (node: Node) =>
+    [
+      node.integer && "kSchemaInteger",
+      node.exclusiveMinimum && "kSchemaExclusiveMinimum",
+      node.exclusiveMaximum && "kSchemaExclusiveMaximum",
+    ]
+      .filter(Boolean)
+      .join(" | ") || "0";
+  const lines = [
+    "// Generated by scripts/generate-handshake-schema.ts from src/schema/scp.ts.",
+    "// Do not edit; run `pnpm run native:handshake-schema` instead.",
+    "//",
+    "// Node 0 accepts any value and node 1 none. A node with types 0 accepts",
+    "// every type; each present property, additional member, array item and",
+    "// anyOf alternative is another node.",
+    "",
+    "#pragma once",
+    "",
+    "constexpr HandshakeSchemaNode kHandshakeSchemaNodes[] = {",
+    ...nodes.map(
+      node =>
+        `    {${node.types === -1 ? "kSchemaNoType" : `0x${node.types.toString(16)}`}, ${flags(node)}, ` +
+        `${number(node.minimum)}, ${number(node.maximum)}, ${node.minLength}, ` +
+        `${node.enumFirst}, ${node.enumCount}, ${node.propertyFirst}, ${node.propertyCount}, ` +
+        `${node.additional}, ${node.items}, ${node.anyOfFirst}, ${node.anyOfCount}},`,
+    ),
+    "};",
+    "",
+    "constexpr HandshakeSchemaProperty kHandshakeSchemaProperties[] = {",
+    ...properties.map(
+      property =>
+        `    {${JSON.stringify(property.name)}, ${property.node}, ${property.required}},`,
+    ),
+    "};",
+    "",
+    "constexpr std::string_view kHandshakeSchemaEnums[] = {",
+    ...enums.map(value => `    ${JSON.stringify(value)},`),
+    "};",
+    "",
+    "constexpr uint16_t kHandshakeSchemaAnyOf[] = {",
+    `    ${anyOf.join(", ")},`,
+    "};",
+    "",
+    ...rootIndices.map(
+      ([name, index]) =>
+        `constexpr uint16_t kHandshakeSchema${name[0].toUpperCase()}${name.slice(1)} = ${index};`,
+    ),
+    "",
+  ];
+  return lines.join("\n");
+};
+
+const outPath = path.join(__dirname, "..", "c", "qwormhole_handshake_schema.h");
+
+const main = () => {
+  const header = lowerHandshakeSchemas({
+    handshake: z.toJSONSchema(handshakePayloadSchema) as JsonSchema,
+    negentropic: z.toJSONSchema(negentropicHandshakeSchema) as JsonSchema,
+    entropyMetrics: z.toJSONSchema(entropyMetricsSchema) as JsonSchema,
+  });
+  if (process.argv.includes("--check")) {
+    const committed = fs.existsSync(outPath) ? fs.readFileSync(outPath, "utf8") : "";
+    if (committed !== header) {
+      console.error(`${outPath} is stale; run \`pnpm run native:handshake-schema\``);
+      process.exit(1);
+    }
+    return;
+  }
+  fs.writeFileSync(outPath, header);
+  console.log(`[handshake-schema] -> ${outPath}`);
+};
+
+main();
@@ -46,17 +46,60 @@ const skipLibsocket =
   
 
 const artifacts = [
+  path.join(process.cwd(), "dist", "native", "qwormhole_native.node"),
   path.join(process.cwd(), "dist", "native", "qwormhole_lws.node"),
   path.join(process.cwd(), "dist", "native", "qwormhole.node"),
 ];
 
+// The resolved-binding manifest the runtime loaders read first (see
+// src/core/native-addons.ts): one path per addon that exists right now.
+const writeBindingManifest = () => {
+  const platformArch = `${platform}-${os.arch()}`;
+  const root = process.cwd();
+  const bindings = {};
+  for (const name of ["qwormhole_native", "qwormhole_lws", "qwormhole", "qwquic"]) {
+    const candidates = [
+      path.join("dist", "native", `${name}.node`),
+      path.join("build", "Release", `${name}.node`),
+      path.join("prebuilds", platformArch, `${name}.node`),
+      path.join("dist", "native", "prebuilds", platformArch, `${name}.node`),
+    ];
+    if (name === "qwquic") {
+      candidates.push(path.join("native", "qwquic", "target", "release", "qwquic.node"));
+    }
+    const found = candidates.find(candidate => fs.existsSync(path.join(root, candidate)));
+    if (found) bindings[name] = found;
+  }
+  const manifestPath =
+    process.env.QWORMHOLE_BINDING_MANIFEST ?? path.join(root, "dist", "native", "bindings.json");
+  try {
+    fs.mkdirSync(path.dirname(manifestPath), { recursive: true });
+    const manifest = {
+      version: 1,
+      abi: process.versions.modules,
+      platform,
+      arch: os.arch(),
+      bindings,
+    };
+    fs.writeFileSync(manifestPath, `${JSON.stringify(manifest, null, 2)}\n`);
+    console.log(`[qwormhole] wrote binding manifest ${manifestPath}`);
+  } catch (err) {
+    console.warn(`[qwormhole] could not write binding manifest: ${err.message}`);
+  }
+};
+
+const finish = () => {
+  writeBindingManifest();
+  process.exit(0);
+};
+
 const hydrateFromPrebuilds = () => {
   const platformArch = `${platform}-${os.arch()}`;
   const candidates = [
     path.join(process.cwd(), "prebuilds", platformArch),
     path.join(process.cwd(), "dist", "native", "prebuilds", platformArch),
   ];
-  const names = ["qwormhole_lws.node", "qwormhole.node"];
+  const names = ["qwormhole_native.node", "qwormhole_lws.node", "qwormhole.node"];
   const outDir = path.join(process.cwd(), "dist", "native");
   if (!fs.existsSync(outDir)) fs.mkdirSync(outDir, { recursive: true });
 
@@ -78,7 +121,7 @@ const hydrateFromPrebuilds = () => {
 const prebuiltHydrated = hydrateFromPrebuilds();
 if (prebuiltHydrated > 0 && !forceRebuild) {
   console.log("[qwormhole] native prebuild available; skipping rebuild.");
-  process.exit(0);
+  finish();
 }
 
 const alreadyBuilt = artifacts.some(p => fs.existsSync(p));
@@ -98,7 +141,7 @@ if (skipNative) {
 
 if (alreadyBuilt && !forceRebuild) {
   console.log("[qwormhole] Native artifact already present; skipping rebuild.");
-  process.exit(0);
+  finish();
 }
 
 if (forceRebuild) {
@@ -109,7 +152,7 @@ if (!hasNodeGyp()) {
   console.warn(
     "[qwormhole] node-gyp not found; skipping native build (TS transport remains available). Install node-gyp to enable native bindings.",
   );
-  process.exit(0);
+  finish();
 }
 
 console.log(
@@ -154,8 +197,8 @@ if (result.status !== 0) {
   console.warn(
     `[qwormhole] Native build failed (status ${result.status}${detail}). Continuing with TS transport fallback.`,
   );
-  process.exit(0);
+  finish();
 }
 
 console.log("[qwormhole] Native build succeeded.");
-process.exit(0);
+finish();
@@ -0,0 +1,97 @@
+/**
+ * Drives an lws NativeQWormholeServer with the native load generator
+ * (build/bench/qwormhole_loadgen, `make loadgen-native`), so the numbers
+ * are the server's and not a JS client's.
+ *
+ * --mode=echo (default) sends every message straight back and records
+ * open-loop round-trip latency; --mode=sink only counts. Appends one JSONL
+ * record per run to --out (default data/native_loadgen.jsonl), the
+ * generator's result plus what the server saw.
+ */
+
+import { spawn } from "node:child_process";
+import fs from "node:fs";
+import path from "node:path";
+import { NativeQWormholeServer, isNativeServerAvailable } from "../src/core/native-server";
+
+const flag = (name: string, env: string): string | undefined =>
+  process.argv.find(arg => arg.startsWith(`--${name}=`))?.split("=")[1] ??
+  process.env[env];
+
+const numberFlag = (name: string, env: string, defaultValue: number): number => {
+  const raw = flag(name, env);
+  const parsed = Number(raw);
+  return raw !== undefined && Number.isFinite(parsed) ? parsed : defaultValue;
+};
+
+const root = path.join(__dirname, "..");
+const binary = flag("bin", "QWORMHOLE_LOADGEN_BIN") ??
+  path.join(root, "build/bench/qwormhole_loadgen");
+const mode = flag("mode", "QWORMHOLE_LOADGEN_MODE") === "sink" ? "sink" : "echo";
+const outPath = flag("out", "QWORMHOLE_LOADGEN_OUT") ??
+  path.join(root, "data/native_loadgen.jsonl");
+const size = numberFlag("size", "QWORMHOLE_LOADGEN_SIZE", 256);
+
+const generatorArgs = [
+  ["connections", numberFlag("connections", "QWORMHOLE_LOADGEN_CONNECTIONS", 64)],
+  ["threads", numberFlag("threads", "QWORMHOLE_LOADGEN_THREADS", 4)],
+  ["rate", numberFlag("rate", "QWORMHOLE_LOADGEN_RATE", 100_000)],
+  ["size", size],
+  ["duration-ms", numberFlag("duration-ms", "QWORMHOLE_LOADGEN_DURATION_MS", 5000)],
+  ["warmup-ms", numberFlag("warmup-ms", "QWORMHOLE_LOADGEN_WARMUP_MS", 1000)],
+  ["mode", mode],
+].flatMap(([name, value]) => [`--${name}`, String(value)]);
+
+async function main() {
+  if (!fs.existsSync(binary)) {
+    throw new Error(`${binary} not found; build it with \`make loadgen-native\``);
+  }
+  if (!isNativeServerAvailable("lws")) {
+    throw new Error("the lws server backend is not built; run `pnpm run rebuild`");
+  }
+  const server = new NativeQWormholeServer<Buffer>(
+    {
+      host: "127.0.0.1",
+      port: 0,
+      framing: "length-prefixed",
+      serializer: (data: Buffer) => data,
+      deserializer: (data: Buffer) => data,
+    },
+    "lws",
+  );
+  let serverMessages = 0;
+  server.on("message", ({ client, data }) => {
+    serverMessages += 1;
+    if (mode === "echo") void client.send(data);
+  });
+  const { port } = await server.listen();
+
+  const { code, stdout } = await new Promise<{ code: number | null; stdout: string }>(
+    (resolve, reject) => {
+      const child = spawn(binary, ["--port", String(port), ...generatorArgs], {
+        stdio: ["ignore", "pipe", "inherit"],
+      });
+      let output = "";
+      child.stdout.on("data", chunk => (output += chunk));
+      child.on("error", reject);
+      child.on("exit", exitCode => resolve({ code: exitCode, stdout: output }));
+    },
+  );
+  await server.close();
+
+  const line = stdout.trim().split("\n").pop();
+  if (!line) throw new Error(`load generator exited with ${code} and no result`);
+  const record = { ...JSON.parse(line), serverBackend: "lws", serverMessages };
+  fs.mkdirSync(path.dirname(outPath), { recursive: true });
+  fs.appendFileSync(outPath, `${JSON.stringify(record)}\n`);
+  console.log(
+    `[loadgen] ${record.scenario}: ${Math.round(record.msgsPerSec)} msg/s, ` +
+      `p99 ${record.latencyUs.p99.toFixed(1)} us, shed ${record.shed} -> ${outPath}`,
+  );
+  if (code !== 0) process.exitCode = 1;
+}
+
+main().catch(err => {
+  console.error(err instanceof Error ? err.message : err);
+  process.exit(1);
+});
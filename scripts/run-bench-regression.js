@@ -0,0 +1,135 @@
+const { spawnSync } = require("node:child_process");
+const fs = require("node:fs");
+const path = require("node:path");
+
+// Repeats the core bench with warmup runs, pinned where the host allows it,
+// and compares every run against a stored baseline with
+// generate-bench-regression-report.js.
+//
+//   node scripts/run-bench-regression.js [--runs 10] [--warmup-runs 1]
+//     [--cpus 2,3] [--baseline data/regression.baseline.jsonl]
+//     [--update-baseline] [--fail-on-regression]
+
+const args = process.argv.slice(2);
+const readArg = (name, fallback) => {
+  const index = args.indexOf(name);
+  return index === -1 ? fallback : args[index + 1];
+};
+
+const root = path.join(__dirname, "..");
+const runs = readArg("--runs", process.env.QWORMHOLE_BENCH_REPEAT || "10");
+const warmupRuns = readArg("--warmup-runs", process.env.QWORMHOLE_BENCH_WARMUP_RUNS || "1");
+const cpus = readArg("--cpus", process.env.QWORMHOLE_BENCH_CPUS);
+const mode = readArg("--mode", "core");
+const baselinePath = path.resolve(
+  root,
+  readArg("--baseline", "data/regression.baseline.jsonl"),
+);
+const candidatePath = path.resolve(root, readArg("--candidate", "data/regression.jsonl"));
+const reportPath = path.resolve(root, readArg("--out", "data/regression.md"));
+
+const notes = [];
+
+// CPU frequency scaling is the largest noise source on shared hosts; switch
+// the pinned CPUs to "performance" when we are allowed to, and put it back.
+const governorFiles = () => {
+  const base = "/sys/devices/system/cpu";
+  if (process.platform !== "linux" || !fs.existsSync(base)) return [];
+  const ids = cpus
+    ? cpus.split(",").flatMap(part => {
+        const [lo, hi] = part.split("-").map(Number);
+        return Array.from({ length: (hi ?? lo) - lo + 1 }, (_, i) => lo + i);
+      })
+    : fs
+        .readdirSync(base)
+        .filter(name => /^cpu\d+$/.test(name))
+        .map(name => Number(name.slice(3)));
+  return ids
+    .map(id => `${base}/cpu${id}/cpufreq/scaling_governor`)
+    .filter(file => fs.existsSync(file));
+};
+
+const restoreGovernors = [];
+for (const file of governorFiles()) {
+  const current = fs.readFileSync(file, "utf8").trim();
+  if (current === "performance") continue;
+  try {
+    fs.writeFileSync(file, "performance");
+    restoreGovernors.push([file, current]);
+  } catch {
+    notes.push(`governor: ${file} is "${current}" and not writable here`);
+  }
+}
+if (restoreGovernors.length > 0) {
+  notes.push(`governor: ${restoreGovernors.length} CPUs set to performance for the run`);
+}
+
+const bench = ["tsx", "scripts/bench.ts", `--mode=${mode}`, "--diagnostics"];
+let command =
+  process.platform === "win32"
+    ? ["cmd.exe", ["/c", ...bench]]
+    : [bench[0], bench.slice(1)];
+if (cpus) {
+  const taskset = process.platform === "linux"
+    ? spawnSync("taskset", ["--version"], { stdio: "ignore" })
+    : { status: 1 };
+  if (taskset.status === 0) {
+    command = ["taskset", ["-c", cpus, ...bench]];
+    notes.push(`affinity: pinned to CPUs ${cpus}`);
+  } else {
+    notes.push("affinity: taskset unavailable, running unpinned");
+  }
+}
+
+fs.mkdirSync(path.dirname(candidatePath), { recursive: true });
+fs.writeFileSync(candidatePath, "");
+
+const env = {
+  ...process.env,
+  QWORMHOLE_BENCH_REPEAT: String(runs),
+  QWORMHOLE_BENCH_WARMUP_RUNS: String(warmupRuns),
+  QWORMHOLE_BENCH_JSONL: candidatePath,
+  QWORMHOLE_BENCH_REPORT:
+    process.env.QWORMHOLE_BENCH_REPORT || candidatePath.replace(/\.jsonl$/, ".bench.md"),
+};
+delete env.QWORMHOLE_BENCH_LANE;
+
+let status = 1;
+try {
+  const result = spawnSync(command[0], command[1], { stdio: "inherit", env, cwd: root });
+  status = result.status ?? 1;
+} finally {
+  for (const [file, previous] of restoreGovernors) {
+    try {
+      fs.writeFileSync(file, previous);
+    } catch {
+      // Best effort; the host resets it on reboot anyway.
+    }
+  }
+}
+notes.forEach(note => console.log(`[bench] ${note}`));
+
+if (status === 0) {
+  if (args.includes("--update-baseline") || !fs.existsSync(baselinePath)) {
+    fs.copyFileSync(candidatePath, baselinePath);
+    console.log(`[bench] baseline written to ${baselinePath}`);
+  } else {
+    const report = spawnSync(
+      process.execPath,
+      [
+        path.join(__dirname, "generate-bench-regression-report.js"),
+        "--baseline",
+        baselinePath,
+        "--candidate",
+        candidatePath,
+        "--out",
+        reportPath,
+        ...(args.includes("--fail-on-regression") ? ["--fail-on-regression"] : []),
+      ],
+      { stdio: "inherit", env },
+    );
+    status = report.status ?? 1;
+  }
+}
+
+process.exit(status);
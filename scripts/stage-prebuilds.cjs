@@ -6,11 +6,21 @@ const path = require("node:path");
 
 const cwd = process.cwd();
 const platformArch = `${os.platform()}-${os.arch()}`;
-const prebuildDir = path.join(cwd, "prebuilds", platformArch);
+// --variant x86-64-v3 stages a -march build into prebuilds/<platform-arch>/x86-64-v3,
+// which the loaders pick only on CPUs that run it.
+const variantArg = process.argv.indexOf("--variant");
+const variant = variantArg > 0 ? process.argv[variantArg + 1] : "";
+if (variantArg > 0 && (!variant || !/^[\w.-]+$/.test(variant))) {
+  console.error("[qwormhole] --variant needs a name such as x86-64-v3");
+  process.exit(1);
+}
+const prebuildDir = variant
+  ? path.join(cwd, "prebuilds", platformArch, variant)
+  : path.join(cwd, "prebuilds", platformArch);
 const releaseDir = path.join(cwd, "build", "Release");
 const distNativeDir = path.join(cwd, "dist", "native");
 
-const artifacts = ["qwormhole_lws.node", "qwormhole.node"];
+const artifacts = ["qwormhole_native.node", "qwormhole_lws.node", "qwormhole.node"];
 
 if (!fs.existsSync(prebuildDir)) {
   fs.mkdirSync(prebuildDir, { recursive: true });
@@ -20,9 +30,10 @@ let copied = 0;
 for (const file of artifacts) {
   const releaseSrc = path.join(releaseDir, file);
   const distSrc = path.join(distNativeDir, file);
+  // A variant is only ever the build that just ran, never an older dist copy.
   const src = fs.existsSync(releaseSrc)
     ? releaseSrc
-    : fs.existsSync(distSrc)
+    : !variant && fs.existsSync(distSrc)
       ? distSrc
       : null;
   if (!src) continue;
@@ -40,5 +51,7 @@ if (!copied) {
 }
 
 console.log(
-  `[qwormhole] prebuilt staging complete (${copied} artifact(s)) for ${platformArch}`,
+  `[qwormhole] prebuilt staging complete (${copied} artifact(s)) for ${platformArch}${
+    variant ? ` (${variant})` : ""
+  }`,
 );
@@ -1,4 +1,10 @@
 import { ChildProcess, spawn } from "child_process";
+import fs from "node:fs";
+import os from "node:os";
+import path from "node:path";
+import { bufferDeserializer } from "../core/codecs";
+import { QWormholeServer } from "../server";
+import type { QWormholeServerConnection } from "../types/types";
 import { computeNegentropicIndex } from "../utils/randomId";
 
 type JsonValue =
@@ -9,7 +15,7 @@ type JsonValue =
   | JsonValue[]
   | { [key: string]: JsonValue };
 
-interface MLAdapter {
+export interface MLAdapter {
   name: string;
   run(metrics: JsonValue): Promise<JsonValue>;
 }
@@ -19,6 +25,7 @@ export type MLAdapterName =
   | "qworm_torch"
   | "rpc"
   | "spawn"
+  | "persistent"
   | "composite"
   | "custom";
 
@@ -41,6 +48,32 @@ export interface SpawnAdapterOptions {
   env?: NodeJS.ProcessEnv;
 }
 
+export interface PersistentAdapterOptions {
+  command: string;
+  args?: string[];
+  env?: NodeJS.ProcessEnv;
+  /**
+   * Unix socket the child dials, passed to it as QWORMHOLE_ML_SOCKET; a
+   * fresh path under os.tmpdir() by default.
+   */
+  socketPath?: string;
+  /** Per-request deadline; 0 waits forever (default 5000). */
+  timeoutMs?: number;
+  /** How long a started child has to connect (default 10000). */
+  connectTimeoutMs?: number;
+  maxFrameLength?: number;
+}
+
+/**
+ * The persistent adapter: `run()` flattens the numeric leaves of `metrics`
+ * into named f64 values, and `infer()` sends a typed array as is.
+ */
+export interface PersistentMLAdapter extends MLAdapter {
+  infer(values: Float64Array | number[], names?: string[]): Promise<JsonValue>;
+  /** Stops the child and its socket; pending requests reject. */
+  close(): Promise<void>;
+}
+
 export interface CompositeAdapterOptions {
   adapters: Array<
     | MLAdapter
@@ -49,6 +82,7 @@ export interface CompositeAdapterOptions {
         options?:
           | RpcAdapterOptions
           | SpawnAdapterOptions
+          | PersistentAdapterOptions
           | QwormTorchAdapterOptions;
       }
   >;
@@ -68,11 +102,12 @@ export type AdapterSelection =
   | {
       name: Extract<
         MLAdapterName,
-        "rpc" | "spawn" | "qworm_torch" | "noop" | "composite"
+        "rpc" | "spawn" | "persistent" | "qworm_torch" | "noop" | "composite"
       >;
       options?:
         | RpcAdapterOptions
         | SpawnAdapterOptions
+        | PersistentAdapterOptions
         | QwormTorchAdapterOptions
         | CompositeAdapterOptions;
     };
@@ -89,6 +124,8 @@ const adapterFactories: Record<
     createQwormTorchAdapter(options as QwormTorchAdapterOptions | undefined),
   rpc: options => createRpcAdapter(options as RpcAdapterOptions),
   spawn: options => createSpawnAdapter(options as SpawnAdapterOptions),
+  persistent: options =>
+    createPersistentAdapter(options as PersistentAdapterOptions),
   composite: options =>
     createCompositeAdapter(options as CompositeAdapterOptions),
   custom: adapter => adapter as MLAdapter,
@@ -232,6 +269,31 @@ export function createSpawnAdapter(options: SpawnAdapterOptions): MLAdapter {
   };
 }
 
+export function createPersistentAdapter(
+  options: PersistentAdapterOptions,
+): PersistentMLAdapter {
+  if (!options?.command) {
+    throw new Error("createPersistentAdapter requires a command");
+  }
+  const link = new PersistentAdapterLink(options);
+  return {
+    name: "persistent",
+    run(metrics: JsonValue): Promise<JsonValue> {
+      const names: string[] = [];
+      const values: number[] = [];
+      flattenNumericMetrics(metrics, "", names, values);
+      return link.request(Float64Array.from(values), names);
+    },
+    infer(values: Float64Array | number[], names?: string[]) {
+      return link.request(
+        values instanceof Float64Array ? values : Float64Array.from(values),
+        names,
+      );
+    },
+    close: () => link.close(),
+  };
+}
+
 export function createNoopAdapter(): MLAdapter {
   return {
     name: "noop",
@@ -339,6 +401,15 @@ function resolveAdapterFromEnv(): MLAdapter | null {
           process.env.QWORMHOLE_ML_SPAWN_ARGS?.split(" ").filter(Boolean) ?? [];
         return createSpawnAdapter({ command: cmd, args });
       }
+      case "persistent": {
+        const cmd = process.env.QWORMHOLE_ML_SPAWN_CMD;
+        if (!cmd) {
+          throw new Error("QWORMHOLE_ML_SPAWN_CMD required for persistent");
+        }
+        const args =
+          process.env.QWORMHOLE_ML_SPAWN_ARGS?.split(" ").filter(Boolean) ?? [];
+        return createPersistentAdapter({ command: cmd, args });
+      }
       default:
         return null;
     }
@@ -441,3 +512,346 @@ function estimateEntropy(series: number[]): number {
     Math.log2(bins);
   return entropy;
 }
+
+// Persistent adapter wire format. Every message is one QWormhole
+// length-prefixed frame, little endian, behind an 8-byte header of
+// u8 type, u8 version, u16 count, u32 schemaId (schema frames) or 0:
+//   1 schema   u32 names, then per name u16 length and UTF-8 bytes.
+//   2 batch    count requests: u32 id, u32 schemaId, u32 length, u32 0,
+//              then length f64 values, 8-byte aligned in the frame.
+//   3 results  count replies: u32 id, u8 status, u8 encoding, u16 0,
+//              u32 bytes, u32 0, then the bytes padded to 8.
+// Status 0 is a result and 1 an error message; encoding 0 is f64 values
+// and 1 UTF-8 JSON. Schema 0 means unnamed values.
+const ML_WIRE_VERSION = 1;
+const ML_FRAME_SCHEMA = 1;
+const ML_FRAME_BATCH = 2;
+const ML_FRAME_RESULTS = 3;
+const ML_MAX_BATCH = 0xffff;
+const LITTLE_ENDIAN = os.endianness() === "LE";
+
+type PendingInference = {
+  resolve: (value: JsonValue) => void;
+  reject: (err: Error) => void;
+  timer?: NodeJS.Timeout;
+};
+
+type QueuedInference = { id: number; schemaId: number; values: Float64Array };
+
+let persistentSocketSeq = 0;
+
+/**
+ * One long-lived child and the QWormhole connection it dials back on. The
+ * child is started by the first request and again by the first request
+ * after it exits; requests queued in one tick leave as one batch frame.
+ */
+class PersistentAdapterLink {
+  private server?: QWormholeServer<Buffer>;
+  private proc?: ChildProcess;
+  private ready?: Promise<QWormholeServerConnection>;
+  private readonly pending = new Map<number, PendingInference>();
+  private outbox: QueuedInference[] = [];
+  private flushQueued = false;
+  private nextId = 1;
+  private readonly schemas = new Map<string, number>();
+  private readonly schemaNames: string[][] = [[]];
+  // Schemas the current child has been sent.
+  private announced = new Set<number>();
+  private closed = false;
+
+  constructor(private readonly options: PersistentAdapterOptions) {}
+
+  request(values: Float64Array, names?: string[]): Promise<JsonValue> {
+    if (this.closed) {
+      return Promise.reject(new Error("persistent adapter is closed"));
+    }
+    const id = this.nextId;
+    this.nextId = this.nextId >= 0xffffffff ? 1 : this.nextId + 1;
+    const schemaId = names?.length ? this.schemaFor(names) : 0;
+    const result = new Promise<JsonValue>((resolve, reject) => {
+      const entry: PendingInference = { resolve, reject };
+      const timeoutMs = this.options.timeoutMs ?? 5000;
+      if (timeoutMs > 0) {
+        entry.timer = setTimeout(() => {
+          if (this.pending.delete(id)) {
+            reject(new Error(`persistent adapter request ${id} timed out`));
+          }
+        }, timeoutMs);
+      }
+      this.pending.set(id, entry);
+    });
+    this.outbox.push({ id, schemaId, values });
+    if (!this.flushQueued) {
+      this.flushQueued = true;
+      queueMicrotask(() => void this.flush());
+    }
+    return result;
+  }
+
+  async close(): Promise<void> {
+    if (this.closed) return;
+    this.closed = true;
+    this.outbox = [];
+    this.failAll(new Error("persistent adapter is closed"));
+    await this.reset();
+  }
+
+  private schemaFor(names: string[]): number {
+    const key = names.join("\n");
+    let schemaId = this.schemas.get(key);
+    if (schemaId === undefined) {
+      schemaId = this.schemaNames.length;
+      this.schemas.set(key, schemaId);
+      this.schemaNames.push(names.slice());
+    }
+    return schemaId;
+  }
+
+  private async flush(): Promise<void> {
+    this.flushQueued = false;
+    let connection: QWormholeServerConnection;
+    try {
+      connection = await this.connect();
+    } catch (err) {
+      const batch = this.outbox.splice(0);
+      for (const { id } of batch) {
+        this.settle(id)?.reject(err as Error);
+      }
+      return;
+    }
+    const batch = this.outbox.splice(0);
+    if (!batch.length) return;
+    for (const { schemaId } of batch) {
+      if (schemaId === 0 || this.announced.has(schemaId)) continue;
+      this.announced.add(schemaId);
+      void connection.send(
+        encodeSchemaFrame(schemaId, this.schemaNames[schemaId]),
+      );
+    }
+    for (let start = 0; start < batch.length; start += ML_MAX_BATCH) {
+      const frame = encodeBatchFrame(batch.slice(start, start + ML_MAX_BATCH));
+      connection.send(frame).catch(err => {
+        for (const { id } of batch) this.settle(id)?.reject(err as Error);
+      });
+    }
+  }
+
+  private connect(): Promise<QWormholeServerConnection> {
+    this.ready ??= this.start().catch(err => {
+      void this.reset();
+      throw err;
+    });
+    return this.ready;
+  }
+
+  private async start(): Promise<QWormholeServerConnection> {
+    const socketPath =
+      this.options.socketPath ??
+      path.join(
+        os.tmpdir(),
+        `qwormhole-ml-${process.pid}-${++persistentSocketSeq}.sock`,
+      );
+    fs.rmSync(socketPath, { force: true });
+    const server = new QWormholeServer<Buffer>({
+      host: "127.0.0.1",
+      port: 0,
+      path: socketPath,
+      framing: "length-prefixed",
+      deserializer: bufferDeserializer,
+      maxFrameLength: this.options.maxFrameLength,
+    });
+    this.server = server;
+    await server.listen();
+
+    const connected = new Promise<QWormholeServerConnection>(
+      (resolve, reject) => {
+        const timer = setTimeout(
+          () => reject(new Error("persistent adapter child did not connect")),
+          this.options.connectTimeoutMs ?? 10_000,
+        );
+        server.once("connection", connection => {
+          clearTimeout(timer);
+          resolve(connection);
+        });
+        const proc = spawn(this.options.command, this.options.args ?? [], {
+          stdio: ["ignore", "inherit", "inherit"],
+          env: {
+            ...process.env,
+            ...this.options.env,
+            QWORMHOLE_ML_SOCKET: socketPath,
+          },
+        });
+        this.proc = proc;
+        proc.once("error", err => {
+          clearTimeout(timer);
+          reject(err);
+        });
+        proc.once("exit", code => {
+          clearTimeout(timer);
+          reject(new Error(`persistent adapter child exited (${code})`));
+          if (this.proc !== proc) return;
+          this.failAll(new Error(`persistent adapter child exited (${code})`));
+          void this.reset();
+        });
+      },
+    );
+    const connection = await connected;
+    server.on("message", ({ client, data }) => {
+      if (client === connection) this.onFrame(data);
+    });
+    server.on("clientClosed", ({ client }) => {
+      if (client !== connection || this.server !== server) return;
+      this.failAll(new Error("persistent adapter connection closed"));
+      void this.reset();
+    });
+    return connection;
+  }
+
+  private onFrame(frame: Buffer): void {
+    if (frame.length < 8 || frame[0] !== ML_FRAME_RESULTS) return;
+    const count = frame.readUInt16LE(2);
+    let offset = 8;
+    for (let i = 0; i < count && offset + 16 <= frame.length; i += 1) {
+      const id = frame.readUInt32LE(offset);
+      const status = frame[offset + 4];
+      const encoding = frame[offset + 5];
+      const bytes = frame.readUInt32LE(offset + 8);
+      const body = frame.subarray(offset + 16, offset + 16 + bytes);
+      offset += 16 + Math.ceil(bytes / 8) * 8;
+      const entry = this.settle(id);
+      if (!entry) continue;
+      if (status !== 0) {
+        entry.reject(
+          new Error(body.toString("utf8") || "persistent adapter error"),
+        );
+        continue;
+      }
+      try {
+        entry.resolve(decodeResult(body, encoding));
+      } catch (err) {
+        entry.reject(err as Error);
+      }
+    }
+  }
+
+  private settle(id: number): PendingInference | undefined {
+    const entry = this.pending.get(id);
+    if (!entry) return undefined;
+    this.pending.delete(id);
+    clearTimeout(entry.timer);
+    return entry;
+  }
+
+  private failAll(err: Error): void {
+    for (const id of [...this.pending.keys()]) {
+      this.settle(id)?.reject(err);
+    }
+  }
+
+  private async reset(): Promise<void> {
+    const { server, proc } = this;
+    this.server = undefined;
+    this.proc = undefined;
+    this.ready = undefined;
+    this.announced = new Set();
+    proc?.kill();
+    await server?.close().catch(() => undefined);
+  }
+}
+
+function encodeSchemaFrame(schemaId: number, names: string[]): Buffer {
+  const encoded = names.map(name => Buffer.from(name, "utf8"));
+  const size = encoded.reduce((sum, name) => sum + 2 + name.length, 12);
+  const frame = Buffer.alloc(size);
+  frame[0] = ML_FRAME_SCHEMA;
+  frame[1] = ML_WIRE_VERSION;
+  frame.writeUInt32LE(schemaId, 4);
+  frame.writeUInt32LE(encoded.length, 8);
+  let offset = 12;
+  for (const name of encoded) {
+    frame.writeUInt16LE(name.length, offset);
+    name.copy(frame, offset + 2);
+    offset += 2 + name.length;
+  }
+  return frame;
+}
+
+function encodeBatchFrame(batch: QueuedInference[]): Buffer {
+  const size = batch.reduce(
+    (sum, { values }) => sum + 16 + values.length * 8,
+    8,
+  );
+  // Buffer.alloc is never pooled, so the f64 runs are 8-byte aligned.
+  const frame = Buffer.alloc(size);
+  frame[0] = ML_FRAME_BATCH;
+  frame[1] = ML_WIRE_VERSION;
+  frame.writeUInt16LE(batch.length, 2);
+  let offset = 8;
+  for (const { id, schemaId, values } of batch) {
+    frame.writeUInt32LE(id, offset);
+    frame.writeUInt32LE(schemaId, offset + 4);
+    frame.writeUInt32LE(values.length, offset + 8);
+    offset += 16;
+    if (LITTLE_ENDIAN) {
+      new Float64Array(
+        frame.buffer,
+        frame.byteOffset + offset,
+        values.length,
+      ).set(values);
+    } else {
+      for (let i = 0; i < values.length; i += 1) {
+        frame.writeDoubleLE(values[i], offset + i * 8);
+      }
+    }
+    offset += values.length * 8;
+  }
+  return frame;
+}
+
+function decodeResult(body: Buffer, encoding: number): JsonValue {
+  if (encoding === 1) {
+    return body.length
+      ? (JSON.parse(body.toString("utf8")) as JsonValue)
+      : {};
+  }
+  const values: number[] = new Array(body.length >> 3);
+  for (let i = 0; i < values.length; i += 1) {
+    values[i] = body.readDoubleLE(i * 8);
+  }
+  return { adapter: "persistent", values };
+}
+
+function flattenNumericMetrics(
+  metrics: JsonValue,
+  prefix: string,
+  names: string[],
+  values: number[],
+): void {
+  if (typeof metrics === "number") {
+    if (!isFinite(metrics)) return;
+    names.push(prefix);
+    values.push(metrics);
+    return;
+  }
+  if (Array.isArray(metrics)) {
+    metrics.forEach((item, index) =>
+      flattenNumericMetrics(
+        item,
+        prefix ? `${prefix}.${index}` : `${index}`,
+        names,
+        values,
+      ),
+    );
+    return;
+  }
+  if (metrics && typeof metrics === "object") {
+    for (const [key, value] of Object.entries(metrics)) {
+      flattenNumericMetrics(
+        value,
+        prefix ? `${prefix}.${key}` : key,
+        names,
+        values,
+      );
+    }
+  }
+}
@@ -7,10 +7,20 @@
  *
  * This module is safe to import even if WireGuard binaries
  * are not present; all functions reject gracefully.
+ *
+ * Reads (getStats, getDevice, watch) and setPeer go through the libsocket
+ * addon's generic-netlink client when it loads: one dump per interface
+ * returns every peer's exact byte counts, last handshake and endpoint, with
+ * no process spawned. getStats falls back to `wg show all transfer`.
  */
 
 import { exec as _exec } from "node:child_process";
 import { promisify } from "node:util";
+import {
+  getNativeWireGuard,
+  type NativeWireGuardDevice,
+  type NativeWireGuardHandle,
+} from "../core/NativeTCPClient";
 const exec = promisify(_exec);
 
 export interface PeerConfig {
@@ -23,6 +33,56 @@ export interface WireGuardStats {
   peer: string;
   received: number;
   sent: number;
+  /** The peer's interface, when the source names it. */
+  interface?: string;
+  /** Wall-clock ms of the last handshake, 0 for none (netlink reads only). */
+  lastHandshakeMs?: number;
+  /** "address:port" of the current endpoint (netlink reads only). */
+  endpoint?: string;
+}
+
+export interface WireGuardPeer {
+  /** Base64, as `wg` prints it. */
+  publicKey: string;
+  endpoint?: { address: string; port: number; family: "IPv4" | "IPv6" };
+  lastHandshakeMs: number;
+  received: number;
+  sent: number;
+  persistentKeepaliveSecs: number;
+  allowedIps: string[];
+}
+
+export interface WireGuardDevice {
+  name: string;
+  publicKey?: string;
+  listenPort: number;
+  fwmark: number;
+  peers: WireGuardPeer[];
+}
+
+export interface WireGuardPeerUpdate {
+  /** Base64 public key of the peer to add, change or remove. */
+  publicKey: string;
+  /** Numeric address; no name resolution. */
+  endpoint?: { address: string; port: number };
+  persistentKeepaliveSecs?: number;
+  /** "address/cidr" entries, added unless `replaceAllowedIps`. */
+  allowedIps?: string[];
+  replaceAllowedIps?: boolean;
+  remove?: boolean;
+}
+
+export interface WireGuardPeerEvent {
+  type: "added" | "removed" | "handshake" | "endpoint";
+  interface: string;
+  peer: WireGuardPeer;
+}
+
+export interface WireGuardWatchOptions {
+  /** Interfaces to poll; every WireGuard interface by default. */
+  interfaces?: string[];
+  /** Poll period (default 1000, at least 100). */
+  intervalMs?: number;
 }
 
 export interface WireGuardAdapter {
@@ -30,18 +90,89 @@ export interface WireGuardAdapter {
   routeTraffic(cidr: string): Promise<void>;
   getStats(): Promise<WireGuardStats[]>;
   teardown(name?: string): Promise<void>;
+  /** Netlink only: the interface and its peers, or null without the addon. */
+  getDevice?(name: string): Promise<WireGuardDevice | null>;
+  /** Netlink only: adds, changes or removes one peer (needs CAP_NET_ADMIN). */
+  setPeer?(name: string, peer: WireGuardPeerUpdate): Promise<void>;
+  /**
+   * Netlink only: polls and reports peers added, removed, re-handshaken or
+   * roamed since the previous poll; the first poll is the baseline. The
+   * kernel has no WireGuard notifications to subscribe to. Returns a stop
+   * function; a no-op without the addon.
+   */
+  watch?(
+    listener: (event: WireGuardPeerEvent) => void,
+    options?: WireGuardWatchOptions,
+  ): () => void;
 }
 
+const UNIT_BYTES: Record<string, number> = {
+  B: 1,
+  KiB: 1024,
+  MiB: 1024 ** 2,
+  GiB: 1024 ** 3,
+  TiB: 1024 ** 4,
+};
+
+const parseBytes = (value: string | undefined): number => {
+  const match = /^([\d.]+)([A-Za-z]*)$/.exec(value ?? "");
+  if (!match) return 0;
+  return Math.round(Number(match[1]) * (UNIT_BYTES[match[2] || "B"] ?? 1));
+};
+
 function parseStats(output: string): WireGuardStats[] {
-  // Example wg show wg0 transfer: "peerA 1.23KiB 4.56KiB\npeerB ..."
-  const lines = output.trim().split("\n");
-  return lines.map(line => {
-    const [peer, recv, sent] = line.split(/\s+/);
-    const parse = (v: string) => parseFloat(v.replace(/[A-Za-z]/g, "")) * 1024;
-    return { peer, received: parse(recv), sent: parse(sent) };
-  });
+  // Piped, `wg show all transfer` prints "wg0 <key> <rx> <tx>" in bytes;
+  // per-interface output drops the first column ("peerA 1.23KiB 4.56KiB").
+  return output
+    .trim()
+    .split("\n")
+    .filter(line => line.trim())
+    .map(line => {
+      const fields = line.trim().split(/\s+/);
+      const [iface, peer, recv, sent] =
+        fields.length >= 4 ? fields : [undefined, ...fields];
+      const stats: WireGuardStats = {
+        peer,
+        received: parseBytes(recv),
+        sent: parseBytes(sent),
+      };
+      if (iface) stats.interface = iface;
+      return stats;
+    });
 }
 
+let nativeHandle: NativeWireGuardHandle | null | undefined;
+const nativeWireGuard = (): NativeWireGuardHandle | null => {
+  if (nativeHandle === undefined) {
+    const WireGuard = getNativeWireGuard();
+    nativeHandle = WireGuard ? new WireGuard() : null;
+  }
+  return nativeHandle;
+};
+
+const toDevice = (device: NativeWireGuardDevice): WireGuardDevice => ({
+  name: device.name,
+  publicKey: device.publicKey?.toString("base64"),
+  listenPort: device.listenPort,
+  fwmark: device.fwmark,
+  peers: device.peers.map(peer => ({
+    publicKey: peer.publicKey.toString("base64"),
+    endpoint: peer.endpoint,
+    lastHandshakeMs: peer.lastHandshakeMs,
+    received: peer.rxBytes,
+    sent: peer.txBytes,
+    persistentKeepaliveSecs: peer.persistentKeepaliveSecs,
+    allowedIps: peer.allowedIps,
+  })),
+});
+
+const endpointText = (peer: WireGuardPeer): string | undefined =>
+  peer.endpoint
+    ? peer.endpoint.family === "IPv6"
+      ? `[${peer.endpoint.address}]:${peer.endpoint.port}`
+      : `${peer.endpoint.address}:${peer.endpoint.port}`
+    : undefined;
+
 /**
  * Validate and sanitize input to prevent shell injection
  */
@@ -94,6 +225,23 @@ export const wireGuardAdapter: WireGuardAdapter = {
   },
 
   async getStats() {
+    const wg = nativeWireGuard();
+    if (wg) {
+      try {
+        return wg.listDevices().flatMap(name =>
+          toDevice(wg.getDevice(name)).peers.map(peer => ({
+            peer: peer.publicKey,
+            received: peer.received,
+            sent: peer.sent,
+            interface: name,
+            lastHandshakeMs: peer.lastHandshakeMs,
+            endpoint: endpointText(peer),
+          })),
+        );
+      } catch {
+        // No wireguard netlink family here; the wg tool may still work.
+      }
+    }
     try {
       const { stdout } = await exec(`sudo wg show all transfer`);
       return parseStats(stdout);
@@ -107,4 +255,64 @@ export const wireGuardAdapter: WireGuardAdapter = {
     await exec(`sudo wg-quick down ${name}`).catch(() => {});
     console.log(`[wireguard] tunnel down for ${name}`);
   },
+
+  async getDevice(name) {
+    validateInterfaceName(name);
+    const wg = nativeWireGuard();
+    return wg ? toDevice(wg.getDevice(name)) : null;
+  },
+
+  async setPeer(name, peer) {
+    validateInterfaceName(name);
+    const wg = nativeWireGuard();
+    if (!wg) {
+      throw new Error("setPeer needs the native libsocket addon (Linux)");
+    }
+    const publicKey = Buffer.from(peer.publicKey, "base64");
+    if (publicKey.length !== 32) {
+      throw new Error("Invalid public key: must be 32 bytes of base64");
+    }
+    wg.setPeer(name, { ...peer, publicKey });
+  },
+
+  watch(listener, options = {}) {
+    const wg = nativeWireGuard();
+    if (!wg) return () => {};
+    let previous: Map<string, { name: string; peer: WireGuardPeer }> | null = null;
+    const poll = () => {
+      const current = new Map<string, { name: string; peer: WireGuardPeer }>();
+      try {
+        for (const name of options.interfaces ?? wg.listDevices()) {
+          for (const peer of toDevice(wg.getDevice(name)).peers) {
+            current.set(`${name}/${peer.publicKey}`, { name, peer });
+          }
+        }
+      } catch {
+        return;
+      }
+      if (previous) {
+        for (const [key, { name, peer }] of current) {
+          const before = previous.get(key)?.peer;
+          if (!before) {
+            listener({ type: "added", interface: name, peer });
+            continue;
+          }
+          if (peer.lastHandshakeMs !== before.lastHandshakeMs) {
+            listener({ type: "handshake", interface: name, peer });
+          }
+          if (endpointText(peer) !== endpointText(before)) {
+            listener({ type: "endpoint", interface: name, peer });
+          }
+        }
+        for (const [key, { name, peer }] of previous) {
+          if (!current.has(key)) listener({ type: "removed", interface: name, peer });
+        }
+      }
+      previous = current;
+    };
+    poll();
+    const timer = setInterval(poll, Math.max(100, options.intervalMs ?? 1000));
+    timer.unref?.();
+    return () => clearInterval(timer);
+  },
 };
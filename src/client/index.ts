@@ -1,12 +1,20 @@
 import net from "node:net";
 import tls from "node:tls";
+import zlib from "node:zlib";
 import { LengthPrefixedFramer } from "../core/framing";
 import { BatchFramer } from "../core/batch-framer";
+import { encodeClockReply, readClockProbe, wallClockUs } from "../core/native-timestamps";
 import { defaultSerializer, bufferDeserializer } from "../core/codecs";
 import { TypedEventEmitter } from "../utils/typedEmitter";
-import { resolveInterfaceAddress } from "../utils/netUtils";
+import { resolveInterfaceAddress, toUnixSocketPath } from "../utils/netUtils";
 import { QWormholeError } from "../utils/errors";
-import { TokenBucket, PriorityQueue, delay } from "../core/qos";
+import {
+  TokenBucket,
+  PriorityQueue,
+  createNativePriorityQueue,
+  delay,
+  type MessageQueue,
+} from "../core/qos";
 import { handshakePayloadSchema, type HandshakePayload } from "../schema/scp";
 import {
   createFlowController,
@@ -77,11 +85,13 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
   private readonly framer?: LengthPrefixedFramer;
   private readonly outboundFramer?: BatchFramer;
   private flowController?: FlowController;
+  private lastNativeWriteBudget?: number;
+  private nativeFlowSocket?: QWormholeSocketLike;
   private coherenceAdapter?: CoherenceAdapterHandle;
   private readonly entropyMetrics: EntropyMetrics;
   private readonly peerIsNative: boolean;
   private connectTimer?: NodeJS.Timeout;
-  private readonly queue = new PriorityQueue<Buffer>();
+  private readonly queue: MessageQueue<Buffer>;
   private readonly limiter?: TokenBucket;
   private draining = false;
   private heartbeatTimer?: NodeJS.Timeout;
@@ -94,13 +104,24 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
   constructor(options: QWormholeClientOptions<TMessage>) {
     super();
     this.options = this.buildOptions(options);
+    const nativeQueue = this.options.nativeScheduler
+      ? createNativePriorityQueue({
+          rateBytesPerSec: this.options.rateLimitBytesPerSec,
+          burstBytes: this.options.rateLimitBurstBytes,
+          overheadBytes: this.options.framing === "length-prefixed" ? 4 : 0,
+        })
+      : null;
+    this.queue = nativeQueue ?? new PriorityQueue<Buffer>();
     if (this.options.framing === "length-prefixed") {
       this.framer = new LengthPrefixedFramer({
         maxFrameLength: this.options.maxFrameLength,
+        inflate: this.buildFrameInflater(),
+        checksums: this.options.integrity === true && !!this.options.protocolVersion,
+      });
+      this.framer.on("message", data => {
+        if (this.answerClockProbe(data)) return;
+        this.emit("message", this.options.deserializer(data));
       });
-      this.framer.on("message", data =>
-        this.emit("message", this.options.deserializer(data)),
-      );
       this.framer.on("error", err => this.emit("error", err));
     }
     this.peerIsNative = this.options.peerIsNative ?? false;
@@ -120,6 +141,7 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
           const caps = this.flowController.resolveFramerCaps(this.peerIsNative);
           this.outboundFramer.setBatchTiming(batchSize, caps.flushMs);
           this.outboundFramer.setFlushCaps(caps.maxBuffers, caps.maxBytes);
+          this.applyNativeTuning();
         };
         this.outboundFramer.on("backpressure", ({ queuedBytes }) => {
           this.flowController?.onBackpressure(queuedBytes);
@@ -137,7 +159,8 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
         tuneFramer();
       }
     }
-    if (this.options.rateLimitBytesPerSec) {
+    // A native queue with a rate gates dequeues itself.
+    if (this.options.rateLimitBytesPerSec && !nativeQueue) {
       this.limiter = new TokenBucket(
         this.options.rateLimitBytesPerSec,
         this.options.rateLimitBurstBytes ?? this.options.rateLimitBytesPerSec,
@@ -199,6 +222,7 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
         ? this.options.socketFactory({
             host: this.options.host,
             port: this.options.port,
+            path: this.options.path,
             interfaceName: this.options.interfaceName,
             localAddress,
             localPort: this.options.localPort,
@@ -209,8 +233,9 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
         : this.options.tls?.enabled
           ? tls.connect(
               {
-                host: this.options.host,
-                port: this.options.port,
+                ...(this.options.path
+                  ? { path: toUnixSocketPath(this.options.path) }
+                  : { host: this.options.host, port: this.options.port }),
                 servername: this.options.tls.servername ?? this.options.host,
                 key: this.options.tls.key,
                 cert: this.options.tls.cert,
@@ -224,15 +249,20 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
               },
               onConnect,
             )
-          : net.createConnection(
-              {
-                host: this.options.host,
-                port: this.options.port,
-                localAddress,
-                localPort: this.options.localPort,
-              },
-              onConnect,
-            );
+          : this.options.path
+            ? net.createConnection(
+                { path: toUnixSocketPath(this.options.path) },
+                onConnect,
+              )
+            : net.createConnection(
+                {
+                  host: this.options.host,
+                  port: this.options.port,
+                  localAddress,
+                  localPort: this.options.localPort,
+                },
+                onConnect,
+              );
 
       this.socket = socket;
       const closeToken = ++this.socketTokenCounter;
@@ -432,6 +462,7 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
     return {
       host: secured.host,
       port: secured.port,
+      path: secured.path ?? undefined,
       framing: secured.framing ?? "length-prefixed",
       maxFrameLength: secured.maxFrameLength ?? undefined,
       keepAlive: secured.keepAlive ?? true,
@@ -461,9 +492,24 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
       coherence: secured.coherence ?? undefined,
       disableFlowController: secured.disableFlowController ?? false,
       flowFastPath: secured.flowFastPath ?? false,
+      nativeScheduler: secured.nativeScheduler ?? false,
+      nativeFlowControl: secured.nativeFlowControl ?? true,
+      compression: secured.compression ?? undefined,
+      integrity: secured.integrity ?? false,
     };
   }
 
+  /** caps.compression: frames the server flags are raw-deflate blocks. */
+  private buildFrameInflater(): ((payload: Buffer) => Buffer) | undefined {
+    const compression = this.options.compression;
+    if (!compression || !this.options.protocolVersion) return undefined;
+    const dictionary =
+      typeof compression === "object" ? compression.dictionary : undefined;
+    const maxOutputLength = this.options.maxFrameLength ?? 4 * 1024 * 1024;
+    return payload =>
+      zlib.inflateRawSync(payload, { dictionary, maxOutputLength });
+  }
+
   private clearReconnectTimer(): void {
     if (this.reconnectTimer) {
       clearTimeout(this.reconnectTimer);
@@ -480,6 +526,8 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
 
   private attachOutboundFramer(socket: net.Socket | QWormholeSocketLike): void {
     this.outboundFramer?.attachSocket(socket as net.Socket);
+    this.lastNativeWriteBudget = undefined;
+    this.applyNativeTuning();
     this.coherenceAdapter?.stop();
     this.coherenceAdapter = undefined;
     if (!this.outboundFramer || !this.flowController) return;
@@ -491,10 +539,49 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
     );
   }
 
+  /** Push the FlowController write budget down to native lws sockets. */
+  private applyNativeTuning(): void {
+    const socket = this.socket as QWormholeSocketLike | undefined;
+    if (!this.flowController || this.applyNativeFlowPolicy(socket)) return;
+    if (typeof socket?.setNativeTuning !== "function") {
+      return;
+    }
+    const tuning = this.flowController.resolveNativeTuning(this.peerIsNative);
+    if (tuning.maxWritesPerWritable === this.lastNativeWriteBudget) return;
+    this.lastNativeWriteBudget = tuning.maxWritesPerWritable;
+    socket.setNativeTuning(tuning);
+  }
+
+  /**
+   * Hand slice/rate control to the lws service thread, once per socket. True
+   * while it runs there; the JS write budget is then left alone.
+   */
+  private applyNativeFlowPolicy(socket?: QWormholeSocketLike): boolean {
+    if (
+      !this.flowController ||
+      this.options.nativeFlowControl === false ||
+      typeof socket?.setNativeFlowPolicy !== "function"
+    ) {
+      return false;
+    }
+    if (this.nativeFlowSocket === socket) return true;
+    const policy = this.flowController.resolveNativeFlowPolicy(this.peerIsNative);
+    if (socket.setNativeFlowPolicy(policy) === undefined) return false;
+    this.nativeFlowSocket = socket;
+    // The native slice is the budget now; lift the per-pass write cap to it.
+    socket.setNativeTuning?.({ maxWritesPerWritable: policy.maxSlice });
+    this.flowController.setNativeDiagnosticsSource(
+      () => socket.getNativeFlowDiagnostics?.(),
+    );
+    return true;
+  }
+
   private detachOutboundFramer(): void {
     this.coherenceAdapter?.stop();
     this.coherenceAdapter = undefined;
     this.outboundFramer?.detachSocket();
+    this.nativeFlowSocket = undefined;
+    this.flowController?.setNativeDiagnosticsSource(undefined);
   }
 
   private publishTrustSnapshot(reason: TrustSnapshotReason): void {
@@ -551,7 +638,12 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
     while (this.queue.length > 0) {
       if (!this.socket || this.socket.destroyed) break;
       const batch = this.queue.dequeueMany(DRAIN_BATCH_SIZE);
-      if (batch.length === 0) break;
+      if (batch.length === 0) {
+        const wait = this.queue.waitMs?.() ?? 0;
+        if (wait <= 0) break;
+        await delay(wait);
+        continue;
+      }
       for (const next of batch) {
         if (!this.socket || this.socket.destroyed) break;
         if (this.limiter) {
@@ -632,11 +724,24 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
     };
     const finalTags =
       Object.keys(mergedTags).length > 0 ? mergedTags : undefined;
+    // A signed payload carries its own caps; adding any would void it.
+    const offered =
+      this.framer && !signerPayload.signature
+        ? {
+            ...(this.options.compression ? { compression: "deflate" } : {}),
+            ...(this.options.integrity ? { integrity: "crc32c" } : {}),
+          }
+        : {};
+    const caps =
+      Object.keys(offered).length > 0
+        ? { ...(signerPayload.caps ?? {}), ...offered }
+        : signerPayload.caps;
     const payload = handshakePayloadSchema.parse({
       type: "handshake",
       ...signerPayload,
       version: signerPayload.version ?? this.options.protocolVersion,
       tags: finalTags,
+      caps,
     });
     await this.enqueueSendAsync(payload, { priority: -100 });
   }
@@ -660,6 +765,20 @@ export class QWormholeClient<TMessage = Buffer> extends TypedEventEmitter<
     await this.drainQueue();
   }
 
+  /**
+   * A libsocket server's syncClock() probe goes straight back with when it
+   * arrived and when the reply left, ahead of anything queued.
+   */
+  private answerClockProbe(data: Buffer): boolean {
+    const probe = readClockProbe(data);
+    if (!probe || probe.t2 !== undefined) return false;
+    const t2 = wallClockUs();
+    if (!this.socket || this.socket.destroyed) return true;
+    this.queue.enqueue(encodeClockReply(probe.probe, t2, wallClockUs()), 100);
+    void this.drainQueue();
+    return true;
+  }
+
   private startHeartbeat(): void {
     if (!this.options.heartbeatIntervalMs) return;
     this.stopHeartbeat();
@@ -22,6 +22,20 @@ CoherenceEnvelope = {
 
 import { resolveLatencyVar } from "./latency";
 
+/** Sum of |next - prev| over the numeric keys two configs share. */
+export function sumConfigDelta(prev: Record<string, any>, next: Record<string, any>): number {
+  let sum = 0;
+  const keys = new Set([...Object.keys(prev), ...Object.keys(next)]);
+  for (const key of keys) {
+    const prevValue = prev[key];
+    const nextValue = next[key];
+    if (typeof prevValue === "number" && typeof nextValue === "number") {
+      sum += Math.abs(nextValue - prevValue);
+    }
+  }
+  return sum;
+}
+
 export interface CommitmentEvent {
   timestamp: number;
   config: Record<string, any>; // e.g., { batch_size: 32, pacing: 0.5 }
@@ -120,7 +134,7 @@ export class CommitmentDetector {
         const prevConfig = this.history[i]?.config;
         const currConfig = this.history[i + 1]?.config;
         if (prevConfig && currConfig) {
-          deltas.push(this.sumConfigDelta(prevConfig, currConfig));
+          deltas.push(sumConfigDelta(prevConfig, currConfig));
         }
       }
       if (deltas.length > 0) {
@@ -182,19 +196,6 @@ export class CommitmentDetector {
     return latencySpike || errorSpike;
   }
 
-  private sumConfigDelta(prev: Record<string, any>, next: Record<string, any>): number {
-    let sum = 0;
-    const keys = new Set([...Object.keys(prev), ...Object.keys(next)]);
-    for (const key of keys) {
-      const prevValue = prev[key];
-      const nextValue = next[key];
-      if (typeof prevValue === "number" && typeof nextValue === "number") {
-        sum += Math.abs(nextValue - prevValue);
-      }
-    }
-    return sum;
-  }
-
   private isCommitted(m: number, v: number): boolean {
     return Math.abs(v) < this.v_epsilon &&
           m > this.m_stable &&
@@ -0,0 +1,395 @@
+import {
+  createNativeDetectorBank,
+  type DetectorBankHandle,
+  type DetectorBankOptions,
+} from "../core/NativeTCPClient";
+import { resolveLatencyVar } from "./latency";
+
+/**
+ * CommitmentDetector and ResonanceDetector for many peers as streaming
+ * detectors: each peer's window sits in a Float64 ring with running
+ * moments, so a sample costs O(1), and one tick() updates every peer from
+ * a row-major Float64Array. The lws addon's DetectorBank runs it when
+ * loaded, JsDetectorBank otherwise. Unlike the classes it follows, the bank
+ * keeps no configs or event lists and logs nothing; it reports flags and
+ * scores per peer.
+ */
+
+/** One input row per peer slot; NaN m or v skips the peer this tick. */
+export const DETECTOR_INPUT_FIELDS = [
+  "m",
+  "v",
+  "latencyVar",
+  "latencyP95",
+  "errRate",
+  /** sumConfigDelta() against the peer's previous config; NaN for none. */
+  "configDelta",
+] as const;
+
+export const DETECTOR_OUTPUT_FIELDS = [
+  "flags",
+  "commitmentResonance",
+  "lyapunov",
+  "perturbationResonance",
+  "resonance",
+  "residual",
+  "latencyStd",
+] as const;
+
+/** Bits in the flags column. */
+export const DETECTOR_COMMITMENT = 1;
+export const DETECTOR_RESONANCE = 2;
+
+const IN = DETECTOR_INPUT_FIELDS.length;
+const OUT = DETECTOR_OUTPUT_FIELDS.length;
+const MAX_WINDOW = 256;
+const STABLE_STD = 0.05;
+
+/** Fills one peer's input row; latency variance comes from resolveLatencyVar(). */
+export function writeDetectorRow(
+  input: Float64Array,
+  peer: number,
+  m: number,
+  v: number,
+  sample: Record<string, number> = {},
+  configDelta = NaN,
+): void {
+  const row = peer * IN;
+  input[row] = m;
+  input[row + 1] = v;
+  input[row + 2] = resolveLatencyVar(sample);
+  input[row + 3] = sample.latencyP95 ?? 0;
+  input[row + 4] = sample.errRate ?? 0;
+  input[row + 5] = configDelta;
+}
+
+/** The addon's DetectorBank when loaded, else JsDetectorBank. */
+export function createDetectorBank(options: DetectorBankOptions = {}): DetectorBankHandle {
+  return createNativeDetectorBank(options) ?? new JsDetectorBank(options);
+}
+
+// Welford's running mean and sum of squares, with removal.
+class SlidingMoments {
+  n = 0;
+  mean = 0;
+  m2 = 0;
+
+  add(x: number): void {
+    this.n += 1;
+    const d = x - this.mean;
+    this.mean += d / this.n;
+    this.m2 += d * (x - this.mean);
+  }
+
+  remove(x: number): void {
+    if (this.n <= 1) {
+      this.clear();
+      return;
+    }
+    this.n -= 1;
+    const d = x - this.mean;
+    this.mean -= d / this.n;
+    this.m2 = Math.max(0, this.m2 - d * (x - this.mean));
+  }
+
+  clear(): void {
+    this.n = 0;
+    this.mean = 0;
+    this.m2 = 0;
+  }
+
+  get avg(): number {
+    return this.n > 0 ? this.mean : 0;
+  }
+
+  get std(): number {
+    return this.n > 0 ? Math.sqrt(this.m2 / this.n) : 0;
+  }
+}
+
+// Sample columns in a peer's ring.
+const T = 0;
+const M = 1;
+const V = 2;
+const LAT = 3;
+const P95 = 4;
+const ERR = 5;
+const CFG = 6;
+const SAMPLE = 7;
+
+// One peer's window. With tau > 0 it also weighs m by
+// exp(-(now - t) / tau), the sums kept as of weightedAt.
+class PeerWindow {
+  readonly ring: Float64Array;
+  head = 0;
+  len = 0;
+  evictions = 0;
+  readonly m = new SlidingMoments();
+  readonly v = new SlidingMoments();
+  readonly latency = new SlidingMoments();
+  w0 = 0;
+  w1 = 0;
+  w2 = 0;
+  weightedAt = 0;
+  perturbation = 0;
+
+  constructor(
+    private readonly window: number,
+    private readonly tau: number,
+  ) {
+    this.ring = new Float64Array(window * SAMPLE);
+  }
+
+  /** Column `field` of the i-th oldest sample. */
+  at(i: number, field: number): number {
+    return this.ring[((this.head + i) % this.window) * SAMPLE + field];
+  }
+
+  decayTo(now: number): void {
+    const decay = Math.exp(-(now - this.weightedAt) / this.tau);
+    this.w0 *= decay;
+    this.w1 *= decay;
+    this.w2 *= decay;
+    this.weightedAt = now;
+  }
+
+  push(sample: ArrayLike<number>): void {
+    if (this.len === this.window) this.evictFront();
+    this.ring.set(sample, ((this.head + this.len) % this.window) * SAMPLE);
+    this.len += 1;
+    this.addMoments(sample[T], sample[M], sample[V], sample[LAT]);
+  }
+
+  evictFront(): void {
+    const base = this.head * SAMPLE;
+    const m = this.ring[base + M];
+    this.m.remove(m);
+    this.v.remove(this.ring[base + V]);
+    this.latency.remove(this.ring[base + LAT]);
+    if (this.tau > 0) {
+      const weight = Math.exp(-(this.weightedAt - this.ring[base + T]) / this.tau);
+      this.w0 -= weight;
+      this.w1 -= weight * m;
+      this.w2 -= weight * m * m;
+    }
+    this.head = (this.head + 1) % this.window;
+    this.len -= 1;
+    this.evictions += 1;
+    if (this.evictions >= this.window) this.rebuild();
+  }
+
+  /** Weighted deviation of m, as weightedStdDev() computes it. */
+  weightedStd(): number {
+    if (this.len === 0 || this.w0 <= 0) return 0;
+    const mean = this.w1 / this.w0;
+    return Math.sqrt(Math.max(0, this.w2 / this.w0 - mean * mean));
+  }
+
+  reset(): void {
+    this.head = 0;
+    this.len = 0;
+    this.evictions = 0;
+    this.m.clear();
+    this.v.clear();
+    this.latency.clear();
+    this.w0 = this.w1 = this.w2 = 0;
+    this.weightedAt = 0;
+    this.perturbation = 0;
+  }
+
+  private addMoments(t: number, m: number, v: number, latency: number): void {
+    this.m.add(m);
+    this.v.add(v);
+    this.latency.add(latency);
+    if (this.tau > 0) {
+      const weight = Math.exp(-(this.weightedAt - t) / this.tau);
+      this.w0 += weight;
+      this.w1 += weight * m;
+      this.w2 += weight * m * m;
+    }
+  }
+
+  // Sheds the rounding the removals leave behind, once per window of them.
+  private rebuild(): void {
+    this.evictions = 0;
+    this.m.clear();
+    this.v.clear();
+    this.latency.clear();
+    this.w0 = this.w1 = this.w2 = 0;
+    for (let i = 0; i < this.len; i += 1) {
+      this.addMoments(this.at(i, T), this.at(i, M), this.at(i, V), this.at(i, LAT));
+    }
+  }
+}
+
+const windowOf = (value: number | undefined, fallback: number): number => {
+  const window = value ?? fallback;
+  if (!(window >= 2 && window <= MAX_WINDOW)) {
+    throw new RangeError("DetectorBank windows must be 2..256 samples");
+  }
+  return Math.floor(window);
+};
+
+/** The addon's DetectorBank in JS, for when it is not loaded. */
+export class JsDetectorBank implements DetectorBankHandle {
+  private readonly commitment: Required<NonNullable<DetectorBankOptions["commitment"]>>;
+  private readonly resonance: Required<NonNullable<DetectorBankOptions["resonance"]>>;
+  private readonly commitmentWindows: PeerWindow[] = [];
+  private readonly resonanceWindows: PeerWindow[] = [];
+  private readonly sample = new Float64Array(SAMPLE);
+
+  constructor(options: DetectorBankOptions = {}) {
+    const c = options.commitment ?? {};
+    const r = options.resonance ?? {};
+    this.commitment = {
+      vEpsilon: c.vEpsilon ?? 0.01,
+      mStable: c.mStable ?? 0.8,
+      resonanceThreshold: c.resonanceThreshold ?? 0.1,
+      window: windowOf(c.window, 5),
+      horizonMs: c.horizonMs ?? 5000,
+      tauMs: c.tauMs ?? 3000,
+    };
+    this.resonance = {
+      vEpsilon: r.vEpsilon ?? 0.01,
+      mStable: r.mStable ?? 0.8,
+      resonanceThreshold: r.resonanceThreshold ?? 0.1,
+      window: windowOf(r.window, 10),
+    };
+    if (!(this.commitment.tauMs > 0) || !(this.commitment.horizonMs > 0)) {
+      throw new RangeError("DetectorBank horizonMs and tauMs must be positive");
+    }
+    this.grow(options.peers ?? 0);
+  }
+
+  peers(): number {
+    return this.commitmentWindows.length;
+  }
+
+  reset(peer?: number): void {
+    if (peer === undefined) {
+      for (let i = 0; i < this.peers(); i += 1) this.reset(i);
+      return;
+    }
+    this.commitmentWindows[peer]?.reset();
+    this.resonanceWindows[peer]?.reset();
+  }
+
+  tick(nowMs: number, input: Float64Array, out: Float64Array): number {
+    const rows = input.length / IN;
+    if (!Number.isInteger(rows) || out.length < rows * OUT) {
+      throw new RangeError("tick() needs 6 input and 7 output values per peer");
+    }
+    this.grow(rows);
+    const sample = this.sample;
+    const zeroNaN = (x: number) => (Number.isNaN(x) ? 0 : x);
+    let events = 0;
+    for (let peer = 0; peer < rows; peer += 1) {
+      const row = peer * IN;
+      const result = peer * OUT;
+      if (Number.isNaN(input[row]) || Number.isNaN(input[row + 1])) {
+        out.fill(NaN, result, result + OUT);
+        out[result] = 0;
+        continue;
+      }
+      sample[T] = nowMs;
+      sample[M] = input[row];
+      sample[V] = input[row + 1];
+      sample[LAT] = zeroNaN(input[row + 2]);
+      sample[P95] = zeroNaN(input[row + 3]);
+      sample[ERR] = zeroNaN(input[row + 4]);
+      sample[CFG] = input[row + 5];
+      const flags =
+        (this.stepCommitment(peer, nowMs, out, result) ? DETECTOR_COMMITMENT : 0) |
+        (this.stepResonance(peer, out, result) ? DETECTOR_RESONANCE : 0);
+      out[result] = flags;
+      if (flags !== 0) events += 1;
+    }
+    return events;
+  }
+
+  private grow(peers: number): void {
+    while (this.commitmentWindows.length < peers) {
+      this.commitmentWindows.push(new PeerWindow(this.commitment.window, this.commitment.tauMs));
+      this.resonanceWindows.push(new PeerWindow(this.resonance.window, 0));
+    }
+  }
+
+  private stepCommitment(peer: number, now: number, out: Float64Array, at: number): boolean {
+    const { vEpsilon, mStable, resonanceThreshold, window, horizonMs } = this.commitment;
+    const w = this.commitmentWindows[peer];
+    w.decayTo(now);
+    w.push(this.sample);
+    while (w.len > 1 && now - w.at(0, T) >= horizonMs) w.evictFront();
+
+    const len = w.len;
+    const last = len - 1;
+    if (len >= 2) {
+      // detectPerturbation(): a latency or error-rate spike since the last sample.
+      if (w.at(last, P95) - w.at(last - 1, P95) > 50 || w.at(last, ERR) - w.at(last - 1, ERR) > 0.05) {
+        const k = Math.min(5, len);
+        let any = false;
+        let peak = 0;
+        let latest = 0;
+        for (let i = len - k + 1; i < len; i += 1) {
+          const delta = w.at(i, CFG);
+          if (Number.isNaN(delta)) continue;
+          peak = any ? Math.max(peak, delta) : delta;
+          latest = delta;
+          any = true;
+        }
+        if (any) {
+          // Spike then decay; the ±1 after the clamp is CommitmentDetector's too.
+          const decayed = latest < peak * 0.5;
+          w.perturbation =
+            Math.max(0, Math.min(1, w.perturbation + (decayed ? 0.05 : -0.05))) + (decayed ? 1 : -1);
+        }
+      }
+    }
+
+    let responsiveness = 0;
+    if (len >= 3) {
+      const diff = Math.abs(w.at(last, P95) - w.at(last - 1, P95));
+      const rebound = Math.abs(w.at(last, P95) - w.at(0, P95));
+      responsiveness = diff > 0 ? 1 - rebound / diff : 0;
+    }
+    const resonance = 1 / (1 + w.latency.std);
+    const lyapunov = w.v.std + w.m.std;
+    out[at + 1] = resonance;
+    out[at + 2] = lyapunov;
+    out[at + 3] = w.perturbation;
+    const m = this.sample[M];
+    const v = this.sample[V];
+    const stable =
+      len >= window && w.weightedStd() < STABLE_STD && Math.abs(w.v.avg) < vEpsilon;
+    return (
+      Math.abs(v) < vEpsilon &&
+      m > mStable &&
+      stable &&
+      responsiveness > 0.5 &&
+      resonance > resonanceThreshold &&
+      lyapunov < STABLE_STD
+    );
+  }
+
+  private stepResonance(peer: number, out: Float64Array, at: number): boolean {
+    const { vEpsilon, mStable, resonanceThreshold, window } = this.resonance;
+    const w = this.resonanceWindows[peer];
+    w.push(this.sample);
+    const len = w.len;
+    const m = this.sample[M];
+    const v = this.sample[V];
+    const latencyStd = w.latency.std;
+    const resonance = 1 / (1 + latencyStd);
+    const residual = len >= 2 ? v + (m - w.at(len - 2, M)) : 0;
+    out[at + 4] = resonance;
+    out[at + 5] = residual;
+    out[at + 6] = latencyStd;
+    const resolved =
+      Math.abs(v) < vEpsilon &&
+      m > mStable &&
+      len >= window &&
+      w.m.std < STABLE_STD &&
+      Math.abs(w.v.avg) < vEpsilon;
+    return resolved && resonance > resonanceThreshold && Math.abs(residual) < STABLE_STD;
+  }
+}
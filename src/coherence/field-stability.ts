@@ -11,6 +11,10 @@
 // Depends on linear algebra utilities (e.g., matrix solve, dot product)
 // Ties to coherence loop: Uses M(t), V(t); adds resonance check for binding event
 
+import {
+  createNativeGeometryAccumulator,
+  type GeometryAccumulator,
+} from "../core/NativeTCPClient";
 import { computeHealth, certifyGeometryContract } from "./geometry";
 import { eigenSymmetric3x3 } from "./spectral";
 import {
@@ -66,18 +70,25 @@ export function buildGeometryState(
   return { ...state, validity };
 }
 
+// The transition from prev to current, or null when their gap is not finite
+export const buildSample = (
+  prev: CoherenceSample,
+  current: CoherenceSample,
+): FitSample | null => {
+  const dt = Math.max(0.001, (current.t - prev.t) / 1000);
+  if (!Number.isFinite(dt)) return null;
+  const s = toVector(current.state);
+  const prevS = toVector(prev.state);
+  const delta: Vector3 = [s[0] - prevS[0], s[1] - prevS[1], s[2] - prevS[2]];
+  const dotS: Vector3 = [delta[0] / dt, delta[1] / dt, delta[2] / dt];
+  return { t: current.t, s, delta, dotS };
+};
+
 export const buildSamples = (buffer: CoherenceSample[]): FitSample[] => {
   const samples: FitSample[] = [];
   for (let i = 1; i < buffer.length; i += 1) {
-    const prev = buffer[i - 1];
-    const current = buffer[i];
-    const dt = Math.max(0.001, (current.t - prev.t) / 1000);
-    if (!Number.isFinite(dt)) continue;
-    const s = toVector(current.state);
-    const prevS = toVector(prev.state);
-    const delta: Vector3 = [s[0] - prevS[0], s[1] - prevS[1], s[2] - prevS[2]];
-    const dotS: Vector3 = [delta[0] / dt, delta[1] / dt, delta[2] / dt];
-    samples.push({ t: current.t, s, delta, dotS });
+    const sample = buildSample(buffer[i - 1], buffer[i]);
+    if (sample) samples.push(sample);
   }
   return samples;
 };
@@ -154,11 +165,7 @@ export const projectPSD = (Q: number[][], eps = 1e-10): PSDProjectionResult => {
   throw new Error("projectPSD: unable to enforce PSD via Cholesky inflation.");
 };
 
-// Returns a partial geometry (Q, b, T, c, grad, stats)
-export const fitGeometry = (
-  samples: FitSample[],
-  options: FitJOptions = {},
-): Omit<
+export type PartialGeometry = Omit<
   CoherenceGeometry,
   | "curvature"
   | "stability"
@@ -170,25 +177,47 @@ export const fitGeometry = (
 > & {
   grad: (s: Vector3) => Vector3;
   stats: FitStats;
-} => {
+};
+
+// Returns a partial geometry (Q, b, T, c, grad, stats)
+export const fitGeometry = (
+  samples: FitSample[],
+  options: FitJOptions = {},
+): PartialGeometry => {
   const model = options.model ?? "quadratic";
   const regularization = options.regularization ?? 1e-6;
-  const controlLaw = options.controlLaw;
   const features = samples.map(sample => buildFeatures(sample.s, model));
   const featureCount = features[0]?.length ?? 0;
   if (featureCount === 0) {
     throw new Error("fitJ requires at least one sample.");
   }
 
-  const targets = samples.map(sample => {
-    const u = controlLaw ? controlLaw(sample.s) : ([0, 0, 0] as Vector3);
-    return [
-      -sample.dotS[0] + u[0],
-      -sample.dotS[1] + u[1],
-      -sample.dotS[2] + u[2],
-    ] as Vector3;
-  });
+  const targets = samples.map(sample => buildTargets(sample, options.controlLaw));
+
+  const coeffs: number[][] = [];
+  const mse: number[] = [];
+  const r2: number[] = [];
 
+  for (let i = 0; i < 3; i += 1) {
+    const y = targets.map(target => target[i]);
+    const solved = solveRidge(features, y, regularization);
+    const { mse: mseValue, r2: r2Value } = scoreFit(features, y, solved);
+    coeffs.push(solved);
+    mse.push(mseValue);
+    r2.push(r2Value);
+  }
+
+  return assembleGeometry(model, coeffs, mse, r2, samples.length);
+};
+
+// Q, b and T from per-target regression coefficients, Q projected to PSD
+const assembleGeometry = (
+  model: FitModel,
+  coeffsPerTarget: ArrayLike<number>[],
+  mse: number[],
+  r2: number[],
+  sampleCount: number,
+): PartialGeometry => {
   const Q: number[][] = [
     [0, 0, 0],
     [0, 0, 0],
@@ -216,12 +245,8 @@ export const fitGeometry = (
         ]
       : undefined;
 
-  const mse: number[] = [];
-  const r2: number[] = [];
-
   for (let i = 0; i < 3; i += 1) {
-    const y = targets.map(target => target[i]);
-    const coeffs = solveRidge(features, y, regularization);
+    const coeffs = coeffsPerTarget[i];
 
     if (model === "cubic") {
       // cubic: coeffs = [Q(i,0..2), T(i,00,01,02,11,12,22), b(i)]
@@ -229,11 +254,15 @@ export const fitGeometry = (
       Q[i][1] = coeffs[1];
       Q[i][2] = coeffs[2];
 
-      const tCoeffs = coeffs.slice(3, 9); // 6 terms
       if (T) {
         // map unique terms into symmetric T[i][j][k]
         // order: 00,01,02,11,12,22
-        const [t00, t01, t02, t11, t12, t22] = tCoeffs;
+        const t00 = coeffs[3];
+        const t01 = coeffs[4];
+        const t02 = coeffs[5];
+        const t11 = coeffs[6];
+        const t12 = coeffs[7];
+        const t22 = coeffs[8];
 
         T[i][0][0] = t00;
         T[i][0][1] = t01;
@@ -255,10 +284,6 @@ export const fitGeometry = (
       Q[i][2] = coeffs[2];
       b[i] = coeffs[3];
     }
-
-    const { mse: mseValue, r2: r2Value } = scoreFit(features, y, coeffs);
-    mse.push(mseValue);
-    r2.push(r2Value);
   }
 
   const symQ = symmetrizeQ(Q);
@@ -279,7 +304,7 @@ export const fitGeometry = (
     c: 0,
     grad: (s: Vector3) => gradient(s, Qpsd, bVec, symT),
     stats: {
-      samples: samples.length,
+      samples: sampleCount,
       mse,
       r2,
       psd_inflation: inflationUsed,
@@ -289,9 +314,194 @@ export const fitGeometry = (
   };
 };
 
+/**
+ * fitGeometry() over a sliding window of the last `window` samples, kept
+ * as running normal equations: each push() adds the new sample's rank-1
+ * term and removes the evicted one's, and fit() solves the features-sized
+ * system, so refitting no longer walks the window. Uses the lws addon's
+ * GeometryAccumulator when loaded. The sums are rebuilt from the window
+ * every `window` evictions so add/remove rounding does not accumulate.
+ */
+export class IncrementalGeometryFit {
+  private readonly model: FitModel;
+  private readonly regularization: number;
+  private readonly controlLaw?: (s: Vector3) => Vector3;
+  private readonly accumulator: GeometryAccumulator;
+  private readonly entries: Array<{
+    sample: FitSample;
+    features: Float64Array;
+    targets: Float64Array;
+  }> = [];
+  private evictions = 0;
+
+  constructor(
+    private readonly window: number,
+    options: FitJOptions = {},
+  ) {
+    this.model = options.model ?? "quadratic";
+    this.regularization = options.regularization ?? 1e-6;
+    this.controlLaw = options.controlLaw;
+    const featureCount = this.model === "cubic" ? 10 : 4;
+    this.accumulator =
+      createNativeGeometryAccumulator(featureCount) ??
+      new JsGeometryAccumulator(featureCount, 3);
+  }
+
+  get size(): number {
+    return this.entries.length;
+  }
+
+  push(sample: FitSample): void {
+    const entry = {
+      sample,
+      features: Float64Array.from(buildFeatures(sample.s, this.model)),
+      targets: Float64Array.from(buildTargets(sample, this.controlLaw)),
+    };
+    this.entries.push(entry);
+    this.accumulator.add(entry.features, entry.targets);
+    while (this.entries.length > Math.max(1, this.window)) {
+      const evicted = this.entries.shift()!;
+      this.accumulator.remove(evicted.features, evicted.targets);
+      this.evictions += 1;
+    }
+    if (this.evictions >= Math.max(1, this.window)) {
+      this.evictions = 0;
+      this.accumulator.reset();
+      for (const { features, targets } of this.entries) {
+        this.accumulator.add(features, targets);
+      }
+    }
+  }
+
+  /** The samples in the window, oldest first. */
+  samples(): FitSample[] {
+    return this.entries.map(entry => entry.sample);
+  }
+
+  fit(): PartialGeometry {
+    const n = this.entries.length;
+    if (n === 0) {
+      throw new Error("fitJ requires at least one sample.");
+    }
+    const featureCount = this.model === "cubic" ? 10 : 4;
+    const { coeffs, ssRes, ssTot } = this.accumulator.solve(this.regularization);
+    const perTarget: Float64Array[] = [];
+    const mse: number[] = [];
+    const r2: number[] = [];
+    for (let i = 0; i < 3; i += 1) {
+      perTarget.push(coeffs.subarray(i * featureCount, (i + 1) * featureCount));
+      mse.push(ssRes[i] / n);
+      r2.push(ssTot[i] > 0 ? 1 - ssRes[i] / ssTot[i] : 1);
+    }
+    return assembleGeometry(this.model, perTarget, mse, r2, n);
+  }
+
+  reset(): void {
+    this.entries.length = 0;
+    this.evictions = 0;
+    this.accumulator.reset();
+  }
+}
+
+// The addon's GeometryAccumulator in JS, for when it is not loaded.
+class JsGeometryAccumulator implements GeometryAccumulator {
+  private readonly xtx: Float64Array;
+  private readonly xty: Float64Array;
+  private readonly sumY: Float64Array;
+  private readonly sumYY: Float64Array;
+  private n = 0;
+
+  constructor(
+    private readonly features: number,
+    private readonly targets: number,
+  ) {
+    this.xtx = new Float64Array(features * features);
+    this.xty = new Float64Array(features * targets);
+    this.sumY = new Float64Array(targets);
+    this.sumYY = new Float64Array(targets);
+  }
+
+  add(x: Float64Array, y: Float64Array): boolean {
+    this.update(x, y, 1);
+    return true;
+  }
+
+  remove(x: Float64Array, y: Float64Array): boolean {
+    if (this.n === 0) return false;
+    this.update(x, y, -1);
+    return true;
+  }
+
+  solve(lambda: number) {
+    const f = this.features;
+    const coeffs = new Float64Array(f * this.targets);
+    const ssRes = new Float64Array(this.targets);
+    const ssTot = new Float64Array(this.targets);
+    for (let t = 0; t < this.targets; t += 1) {
+      const a: number[][] = [];
+      const rhs: number[] = [];
+      for (let i = 0; i < f; i += 1) {
+        const row = Array.from(this.xtx.subarray(i * f, (i + 1) * f));
+        row[i] += lambda;
+        a.push(row);
+        rhs.push(this.xty[i * this.targets + t]);
+      }
+      const beta = solveLinearSystem(a, rhs);
+      // ||y - X b||^2 = y.y - 2 b.X^T y + b.X^T X b
+      let fit = 0;
+      let quad = 0;
+      for (let i = 0; i < f; i += 1) {
+        coeffs[t * f + i] = beta[i];
+        fit += beta[i] * this.xty[i * this.targets + t];
+        let row = 0;
+        for (let k = 0; k < f; k += 1) row += this.xtx[i * f + k] * beta[k];
+        quad += beta[i] * row;
+      }
+      // Cancellation leaves residue near zero; below the moments' rounding
+      // the batch fit would have seen an exact zero.
+      const floor = 1e-12 * this.sumYY[t];
+      const res = this.sumYY[t] - 2 * fit + quad;
+      const tot =
+        this.n > 0 ? this.sumYY[t] - (this.sumY[t] * this.sumY[t]) / this.n : 0;
+      ssRes[t] = res > floor ? res : 0;
+      ssTot[t] = tot > floor ? tot : 0;
+    }
+    return { coeffs, ssRes, ssTot };
+  }
+
+  count(): number {
+    return this.n;
+  }
+
+  reset(): void {
+    this.xtx.fill(0);
+    this.xty.fill(0);
+    this.sumY.fill(0);
+    this.sumYY.fill(0);
+    this.n = 0;
+  }
+
+  private update(x: Float64Array, y: Float64Array, sign: number) {
+    const f = this.features;
+    for (let c = 0; c < f; c += 1) {
+      const v = sign * x[c];
+      for (let k = 0; k < f; k += 1) this.xtx[c * f + k] += v * x[k];
+      for (let t = 0; t < this.targets; t += 1) {
+        this.xty[c * this.targets + t] += v * y[t];
+      }
+    }
+    for (let t = 0; t < this.targets; t += 1) {
+      this.sumY[t] += sign * y[t];
+      this.sumYY[t] += sign * y[t] * y[t];
+    }
+    this.n += sign;
+    if (this.n === 0) this.reset();
+  }
+}
+
 // Certifies a full CoherenceGeometry contract from a partial geometry and samples
 export function certifyGeometry(
-  partial: ReturnType<typeof fitGeometry>,
+  partial: PartialGeometry,
   samples: FitSample[],
   ridgeLambda: number,
 ): CoherenceGeometry {
@@ -479,6 +689,18 @@ const buildFeatures = (s: Vector3, model: FitModel): number[] => {
   return [s[0], s[1], s[2], 1];
 };
 
+const buildTargets = (
+  sample: FitSample,
+  controlLaw?: (s: Vector3) => Vector3,
+): Vector3 => {
+  const u = controlLaw ? controlLaw(sample.s) : ([0, 0, 0] as Vector3);
+  return [
+    -sample.dotS[0] + u[0],
+    -sample.dotS[1] + u[1],
+    -sample.dotS[2] + u[2],
+  ];
+};
+
 const solveRidge = (x: number[][], y: number[], lambda: number): number[] => {
   const rows = x.length;
   const cols = x[0]?.length ?? 0;
@@ -1,5 +1,6 @@
 import type { SignalTrialTelemetry } from "../schema/signal-trial";
 import type { TransportGovernanceSignals } from "../core/transport-governance-policy";
+import type { NativeAnomalyEvent } from "../types/types";
 
 export type SignalTrialGovernanceTelemetry = {
   driftRate: number;
@@ -56,6 +57,22 @@ export function governanceSignalsFromTelemetry(
   };
 }
 
+/**
+ * The regime raised native anomalies impose: retransmit or RTT shifts make
+ * the path "unstable" (guarded), jitter alone "turbulent" (no throughput
+ * mode). Undefined when none is raised.
+ */
+export function anomalyRegime(
+  raised: Iterable<NativeAnomalyEvent["metric"]>,
+): TransportGovernanceSignals["regime"] {
+  let regime: TransportGovernanceSignals["regime"];
+  for (const metric of raised) {
+    if (metric !== "jitter") return "unstable";
+    regime = "turbulent";
+  }
+  return regime;
+}
+
 export function createGovernanceSignalStore(
   initial?: TransportGovernanceSignals,
 ): {
@@ -64,21 +81,44 @@ export function createGovernanceSignalStore(
   updateFromTelemetry: (
     telemetry?: Pick<SignalTrialTelemetry, "governance" | "regime" | "derived"> | null,
   ) => TransportGovernanceSignals | undefined;
+  /**
+   * Feed a native server's "anomaly" events. While any connection has a
+   * metric raised, its regime overrides the telemetry's.
+   */
+  applyAnomaly: (
+    event: NativeAnomalyEvent & { client: { id: string } },
+  ) => TransportGovernanceSignals | undefined;
   clear: () => void;
 } {
   let current = initial;
+  const raised = new Map<string, NativeAnomalyEvent["metric"]>();
+  let override: TransportGovernanceSignals["regime"];
+  const effective = () =>
+    override ? { ...current, regime: override } : current;
 
   return {
-    get: () => current,
+    get: effective,
     set: (value) => {
       current = value;
     },
     updateFromTelemetry: (telemetry) => {
       current = governanceSignalsFromTelemetry(telemetry);
-      return current;
+      return effective();
+    },
+    applyAnomaly: (event) => {
+      const key = `${event.client.id}\u0000${event.metric}`;
+      if (event.raised) {
+        raised.set(key, event.metric);
+      } else {
+        raised.delete(key);
+      }
+      override = anomalyRegime(raised.values());
+      return effective();
     },
     clear: () => {
       current = undefined;
+      raised.clear();
+      override = undefined;
     },
   };
 }
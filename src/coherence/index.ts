@@ -3,6 +3,7 @@ export * from "./adapter";
 export * from "./coherence";
 export * from "./coherenceStep";
 export * from "./commitment-detector";
+export * from "./detector-bank";
 export * from "./field-stability";
 export * from "./fitj";
 export * from "./geometric-regime";
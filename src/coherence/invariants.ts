@@ -1,4 +1,5 @@
 import * as tf from "@tensorflow/tfjs";
+import { vectorStatsNative } from "./native-math";
 import type { CoherenceState } from "./types";
 
 export const DEFAULT_MIN_RESERVE = 0.2;
@@ -14,6 +15,8 @@ export function clamp(x: number, min: number, max: number): number {
 export function cosineSimilarity(signal: number[], intent: number[]): number {
   if (!signal.length || !intent.length) return 0;
   if (signal.length !== intent.length) return 0;
+  const native = vectorStatsNative(signal, intent);
+  if (native) return native.dot / Math.sqrt(native.sumSqA * native.sumSqB);
 
   return tf.tidy(() => {
     const a = tf.tensor1d(signal);
@@ -30,6 +33,8 @@ export function sineSimilarity(signal: number[], intent: number[]): number {
 }
 
 export function euclideanDistance(signal: number[], intent: number[]): number {
+  const native = vectorStatsNative(signal, intent);
+  if (native) return Math.sqrt(native.distSq);
   return tf.tidy(() => {
     const a = tf.tensor1d(signal);
     const b = tf.tensor1d(intent);
@@ -38,6 +43,8 @@ export function euclideanDistance(signal: number[], intent: number[]): number {
 }
 
 export function computeSignalPower(signal: number[]): number {
+  const native = vectorStatsNative(signal);
+  if (native) return native.sumSqA / signal.length;
   return tf.tidy(() => tf.tensor1d(signal).square().mean().dataSync()[0]);
 }
 
@@ -0,0 +1,188 @@
+import {
+  getNativeCoherenceKernels,
+  type NativeCoherenceKernels,
+  type NativeNboSweepOptions,
+} from "../core/NativeTCPClient";
+
+// Below these sizes the JS loops beat copying into Float64Arrays and
+// crossing into the addon.
+export const NATIVE_MATRIX_MIN_ROWS = 16;
+export const NATIVE_VECTOR_MIN_LENGTH = 64;
+
+let kernels: NativeCoherenceKernels | null | undefined;
+
+const loadKernels = (): NativeCoherenceKernels | null => {
+  if (kernels === undefined) kernels = getNativeCoherenceKernels();
+  return kernels;
+};
+
+/** Copies equal-length rows into one row-major Float64Array. */
+export function toRowMajor(matrix: number[][], cols = matrix[0]?.length ?? 0): Float64Array {
+  const out = new Float64Array(matrix.length * cols);
+  for (let i = 0; i < matrix.length; i += 1) {
+    out.set(matrix[i], i * cols);
+  }
+  return out;
+}
+
+export function fromRowMajor(data: Float64Array, rows: number, cols: number): number[][] {
+  const out: number[][] = new Array(rows);
+  for (let i = 0; i < rows; i += 1) {
+    out[i] = Array.from(data.subarray(i * cols, (i + 1) * cols));
+  }
+  return out;
+}
+
+const rectangularCols = (matrix: number[][]): number | null => {
+  const cols = matrix[0]?.length ?? 0;
+  for (const row of matrix) {
+    if (row.length !== cols) return null;
+  }
+  return cols;
+};
+
+/**
+ * normalizeTopologyRows() in the addon. Null when the kernels are not
+ * loaded, the matrix is below NATIVE_MATRIX_MIN_ROWS or its rows are ragged;
+ * the caller then runs the JS loop.
+ */
+export function normalizeRowsNative(matrix: number[][]): number[][] | null {
+  if (matrix.length < NATIVE_MATRIX_MIN_ROWS) return null;
+  const native = loadKernels();
+  const cols = native ? rectangularCols(matrix) : null;
+  if (!native || cols === null) return null;
+  const data = native.normalizeRows(toRowMajor(matrix, cols), matrix.length, cols);
+  return fromRowMajor(data, matrix.length, cols);
+}
+
+/**
+ * matrix * vector in the addon, row-normalizing on the fly when asked.
+ * Takes number[][] or an already row-major Float64Array of `vector.length`
+ * columns; null under the same conditions as normalizeRowsNative().
+ */
+export function matVecNative(
+  matrix: number[][] | Float64Array,
+  vector: number[],
+  normalize = false,
+): number[] | null {
+  const cols = vector.length;
+  const rows = matrix instanceof Float64Array ? matrix.length / (cols || 1) : matrix.length;
+  if (rows < NATIVE_MATRIX_MIN_ROWS) return null;
+  const native = loadKernels();
+  if (!native) return null;
+  let data: Float64Array;
+  if (matrix instanceof Float64Array) {
+    if (!Number.isInteger(rows)) return null;
+    data = matrix;
+  } else {
+    if (rectangularCols(matrix) !== cols) return null;
+    data = toRowMajor(matrix, cols);
+  }
+  return Array.from(native.matVec(data, Float64Array.from(vector), rows, cols, normalize));
+}
+
+/**
+ * The coordinate sweeps of nboVectorized() plus its per-node epiplexity,
+ * each golden-section probe O(1) instead of a full pass over the field.
+ */
+export function nboSweepsNative(
+  baseField: number[],
+  options: NativeNboSweepOptions,
+): { offsets: number[]; epiplexityPerNode: number[] } | null {
+  if (baseField.length < NATIVE_MATRIX_MIN_ROWS) return null;
+  const native = loadKernels();
+  if (!native) return null;
+  const result = native.nboSweeps(Float64Array.from(baseField), options);
+  return {
+    offsets: Array.from(result.offsets),
+    epiplexityPerNode: Array.from(result.epiplexityPerNode),
+  };
+}
+
+/**
+ * Dot product, squared norms and squared distance of two equal-length
+ * vectors in one Float64 pass; only sumSqA without `b`. Null below
+ * NATIVE_VECTOR_MIN_LENGTH, on a length mismatch, or without the addon.
+ */
+export function vectorStatsNative(
+  a: number[],
+  b?: number[],
+): { dot: number; sumSqA: number; sumSqB: number; distSq: number } | null {
+  if (a.length < NATIVE_VECTOR_MIN_LENGTH) return null;
+  if (b && b.length !== a.length) return null;
+  const native = loadKernels();
+  if (!native) return null;
+  return native.vectorStats(
+    Float64Array.from(a),
+    b ? Float64Array.from(b) : undefined,
+  );
+}
+
+const SUPERFORMULA_KEYS = ["m", "n1", "n2", "n3", "a", "b"] as const;
+type SuperformulaSet = Record<(typeof SUPERFORMULA_KEYS)[number], number>;
+
+/** Parameter sets packed six values each, in SUPERFORMULA_KEYS order. */
+export function packSuperformulaParams(sets: SuperformulaSet[]): Float64Array {
+  const out = new Float64Array(sets.length * SUPERFORMULA_KEYS.length);
+  sets.forEach((set, i) => {
+    SUPERFORMULA_KEYS.forEach((key, k) => {
+      out[i * SUPERFORMULA_KEYS.length + k] = set[key];
+    });
+  });
+  return out;
+}
+
+/** superformulaRadius() at each angle for each set, one row per set. */
+export function superformulaRadiiNative(
+  angles: Float64Array,
+  sets: SuperformulaSet[],
+): Float64Array | null {
+  const native = loadKernels();
+  if (!native) return null;
+  return native.superformulaRadii(angles, packSuperformulaParams(sets));
+}
+
+/** computeLoss() for each set; Huber when huberDelta is given. */
+export function superformulaLossNative(
+  angles: Float64Array,
+  radii: Float64Array,
+  sets: SuperformulaSet[],
+  huberDelta?: number,
+): Float64Array | null {
+  if (angles.length === 0) return null;
+  const native = loadKernels();
+  if (!native) return null;
+  return native.superformulaLoss(angles, radii, packSuperformulaParams(sets), huberDelta);
+}
+
+/**
+ * localSearch() from every seed in the addon, seeds spread over threads
+ * when the batch is large. Same steps and libm math as the JS search.
+ */
+export function superformulaSearchNative(
+  angles: Float64Array,
+  radii: Float64Array,
+  seeds: SuperformulaSet[],
+  iterations: number,
+  huberDelta?: number,
+): Array<{ params: SuperformulaSet; fitError: number }> | null {
+  if (angles.length === 0) return null;
+  const native = loadKernels();
+  if (!native) return null;
+  const stride = SUPERFORMULA_KEYS.length + 1;
+  const packed = native.superformulaSearch(
+    angles,
+    radii,
+    packSuperformulaParams(seeds),
+    iterations,
+    huberDelta,
+  );
+  return seeds.map((_, i) => {
+    const row = packed.subarray(i * stride, (i + 1) * stride);
+    const params = {} as SuperformulaSet;
+    SUPERFORMULA_KEYS.forEach((key, k) => {
+      params[key] = row[k];
+    });
+    return { params, fitError: row[SUPERFORMULA_KEYS.length] };
+  });
+}
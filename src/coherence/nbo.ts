@@ -1,4 +1,5 @@
 import type { Alignment, FieldSample, /* NboAttribution, */ NboOptions, NboResult, NboSummary } from "./types";
+import { matVecNative, nboSweepsNative, normalizeRowsNative } from "./native-math";
 
 const EPS = 1e-12;
 
@@ -13,6 +14,8 @@ export function buildIdentityMatrix(size: number): number[][] {
 }
 
 export function normalizeTopologyRows(matrix: number[][]): number[][] {
+  const native = normalizeRowsNative(matrix);
+  if (native) return native;
   const size = matrix.length;
   return matrix.map((row, rowIndex) => {
     const clipped = row.map((value) => Math.max(0, safeValue(value)));
@@ -201,9 +204,12 @@ export function nboVectorized(
   const tol = options.tol ?? 1e-4;
   const maxIter = options.maxIter ?? 200;
   const curvatureDelta = options.curvatureDelta ?? 0.01;
+  const useNative = options.native ?? true;
 
   const baseField = new Array<number>(n);
-  const wx = multiplyMatrixVector(topology, xVec);
+  const wx =
+    (useNative ? matVecNative(topology, xVec) : null) ??
+    multiplyMatrixVector(topology, xVec);
   for (let i = 0; i < n; i += 1) {
     baseField[i] = Math.max(EPS, safeValue(signal[i]) + couplingStrength * wx[i]);
   }
@@ -298,15 +304,31 @@ export function nboVectorized(
   );
   const basinWidthPenalty = 1 / Math.sqrt(curvaturePenalty);
 
-  const offsets = new Array<number>(n).fill(0);
-  for (let sweep = 0; sweep < coordSweeps; sweep += 1) {
-    for (let i = 0; i < n; i += 1) {
-      const f = (xi: number) => {
-        const trial = offsets.slice();
-        trial[i] = xi;
-        return entropyWithPenalty(trial);
-      };
-      offsets[i] = boundedMinimize(f, lo, hi, tol, maxIter);
+  const sweepNative = useNative
+    ? nboSweepsNative(baseField, {
+        couplingStrength,
+        lo,
+        hi,
+        minProb,
+        boundaryMargin,
+        boundPenalty,
+        ridge,
+        coordSweeps,
+        tol,
+        maxIter,
+      })
+    : null;
+  const offsets = sweepNative?.offsets ?? new Array<number>(n).fill(0);
+  if (!sweepNative) {
+    for (let sweep = 0; sweep < coordSweeps; sweep += 1) {
+      for (let i = 0; i < n; i += 1) {
+        const f = (xi: number) => {
+          const trial = offsets.slice();
+          trial[i] = xi;
+          return entropyWithPenalty(trial);
+        };
+        offsets[i] = boundedMinimize(f, lo, hi, tol, maxIter);
+      }
     }
   }
 
@@ -327,7 +349,9 @@ export function nboVectorized(
     return h;
   };
 
-  const epiplexityPerNode = offsets.map((offset, idx) => origEnt - entropySingleOffset(idx, offset));
+  const epiplexityPerNode =
+    sweepNative?.epiplexityPerNode ??
+    offsets.map((offset, idx) => origEnt - entropySingleOffset(idx, offset));
   const weightDenom = epiplexityPerNode.reduce(
     (sum, value) => sum + Math.abs(value),
     0,
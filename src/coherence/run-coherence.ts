@@ -18,9 +18,9 @@ import type { MuxStream } from "../transports/mux/mux-stream";
 import { WSTransport, WSTransportServer } from "../transports/ws/ws-transport";
 import { CommitmentDetector } from "./commitment-detector";
 import {
-  buildSamples,
+  buildSample,
   certifyGeometry,
-  fitGeometry,
+  IncrementalGeometryFit,
   minimumSamplesForModel,
 } from "./field-stability";
 import { isJSpaceResolved } from "./jSpaceResolution";
@@ -1596,6 +1596,17 @@ export function startSignalTrialBroadcast(
   let detector = new CommitmentDetector();
   let resolutionObserver = new ResolutionDetector(observerConfig);
   let stabilityBuffer: Array<{ t: number; state: CoherenceState }> = [];
+  // The analysis window, which buildSamples() over the buffer could never
+  // make longer than bufferSize - 1.
+  const createStabilityFit = () =>
+    new IncrementalGeometryFit(
+      Math.min(stabilityConfig.analysisWindow, stabilityConfig.bufferSize - 1),
+      {
+        model: stabilityConfig.model,
+        regularization: stabilityConfig.regularization,
+      },
+    );
+  let stabilityFit = createStabilityFit();
   let geometrySummary: GeometrySummary | null = null;
   let attractorComparisonSummary: AttractorComparisonTelemetry | null = null;
   let attractorTick = 0;
@@ -1686,28 +1697,25 @@ export function startSignalTrialBroadcast(
     if (stabilityBuffer.length > stabilityConfig.bufferSize) {
       stabilityBuffer.shift();
     }
+    if (stabilityBuffer.length >= 2) {
+      const sample = buildSample(stabilityBuffer.at(-2)!, stabilityBuffer.at(-1)!);
+      if (sample) {
+        stabilityFit.push(
+          applyStabilityConvention([sample], stabilityConfig.convention)[0],
+        );
+      }
+    }
     stabilityTick += 1;
     if (stabilityTick % stabilityConfig.analysisEvery !== 0) {
       return;
     }
 
-    const samples = buildSamples(stabilityBuffer);
-    const window =
-      samples.length > stabilityConfig.analysisWindow
-        ? samples.slice(-stabilityConfig.analysisWindow)
-        : samples;
     const minimumSamples = minimumSamplesForModel(stabilityConfig.model);
-    if (window.length < minimumSamples) {
+    if (stabilityFit.size < minimumSamples) {
       return;
     }
-    const effectiveWindow = applyStabilityConvention(
-      window,
-      stabilityConfig.convention,
-    );
-    const fit = fitGeometry(effectiveWindow, {
-      model: stabilityConfig.model,
-      regularization: stabilityConfig.regularization,
-    });
+    const effectiveWindow = stabilityFit.samples();
+    const fit = stabilityFit.fit();
     const geometry = certifyGeometry(
       fit,
       effectiveWindow,
@@ -1868,6 +1876,7 @@ export function startSignalTrialBroadcast(
     detector = new CommitmentDetector();
     resolutionObserver = new ResolutionDetector(observerConfig);
     stabilityBuffer = [];
+    stabilityFit = createStabilityFit();
     geometrySummary = null;
     attractorComparisonSummary = null;
     attractorTick = 0;
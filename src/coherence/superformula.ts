@@ -1,4 +1,9 @@
 import { clamp } from "./invariants";
+import {
+  superformulaLossNative,
+  superformulaRadiiNative,
+  superformulaSearchNative,
+} from "./native-math";
 
 export interface PolarPoint {
   angle: number;
@@ -107,6 +112,30 @@ export function generateSuperformulaPoints(params: SuperformulaParams, samples:
   return points;
 }
 
+/**
+ * Radii at `samples` evenly spaced angles for each parameter set, one row
+ * of `samples` per set in one Float64Array, without a PolarPoint per
+ * sample. Evaluated in the lws addon when it is loaded.
+ */
+export function generateSuperformulaRadii(
+  sets: SuperformulaParams[],
+  samples: number,
+): Float64Array {
+  const angles = new Float64Array(Math.max(0, samples));
+  for (let i = 0; i < angles.length; i++) {
+    angles[i] = (i / samples) * 2 * Math.PI;
+  }
+  const native = superformulaRadiiNative(angles, sets);
+  if (native) return native;
+  const out = new Float64Array(sets.length * angles.length);
+  sets.forEach((params, row) => {
+    for (let i = 0; i < angles.length; i++) {
+      out[row * angles.length + i] = superformulaRadius(angles[i], params);
+    }
+  });
+  return out;
+}
+
 export function generateCircle(radius: number, samples: number): PolarPoint[] {
   const points: PolarPoint[] = [];
   for (let i = 0; i < samples; i++) {
@@ -161,13 +190,16 @@ export function fitSuperformula(
   const rng = createRng(options.randomSeed);
   const seedParams = buildSeedParams(seeds, rng);
   const seedResults: Array<{ params: SuperformulaParams; fitError: number }> =
-    [];
-
-  for (const seed of seedParams) {
-    seedResults.push(
+    superformulaSearchNative(
+      Float64Array.from(points, (p) => p.angle),
+      Float64Array.from(points, (p) => p.radius),
+      seedParams,
+      iterations,
+      lossMode === "huber" ? huberDelta : undefined,
+    ) ??
+    seedParams.map((seed) =>
       localSearch(points, seed, iterations, lossMode, huberDelta),
     );
-  }
 
   seedResults.sort((a, b) => a.fitError - b.fitError);
   const top = seedResults.slice(0, Math.min(5, seedResults.length));
@@ -391,6 +423,27 @@ export function computeLoss(
   return total / points.length;
 }
 
+/** computeLoss() for each candidate, in the addon when it is loaded. */
+export function computeLossBatch(
+  points: PolarPoint[],
+  candidates: SuperformulaParams[],
+  mode: LossMode,
+  huberDelta: number,
+): Float64Array {
+  const native = superformulaLossNative(
+    Float64Array.from(points, (p) => p.angle),
+    Float64Array.from(points, (p) => p.radius),
+    candidates,
+    mode === "huber" ? huberDelta : undefined,
+  );
+  return (
+    native ??
+    Float64Array.from(candidates, (params) =>
+      computeLoss(points, params, mode, huberDelta),
+    )
+  );
+}
+
 export function localSearch(
   points: PolarPoint[],
   seed: SuperformulaParams,
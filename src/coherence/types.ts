@@ -288,6 +288,11 @@ export interface NboOptions {
   tol?: number;
   maxIter?: number;
   curvatureDelta?: number;
+  /**
+   * Use the addon's kernels for the matrix product and coordinate sweeps
+   * when it is loaded and the field has at least 16 nodes. Default true.
+   */
+  native?: boolean;
 }
 
 export interface CoherenceTelemetryEntry {
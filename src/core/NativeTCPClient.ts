@@ -1,9 +1,42 @@
-import bindings from "bindings";
-import path from "node:path";
-import { createRequire } from "node:module";
+import { loadBackendAddon } from "./native-addons";
+import {
+  DEFAULT_STREAM_CHUNK_BYTES,
+  decodeStreamChunk,
+  pumpStreamChunks,
+  type NativeStreamSource,
+} from "./native-stream";
 import type {
   NativeBackend,
+  NativeClientPoolOptions,
+  NativeClientPoolStats,
+  NativeClientTransportStats,
+  NativeFlowDiagnostics,
+  NativeConnectTimings,
+  NativeFlowPolicy,
+  NativeHistogramSnapshot,
+  NativeHandshakeSignerInfo,
+  NativeHandshakeSignerOptions,
+  NativeKcpEngineStats,
+  NativeKcpSessionStats,
+  NativeLwsTuning,
+  NativeMuxEvent,
+  NativeRpcEvent,
+  NativeRpcResponse,
+  NativeSecureStreamEvent,
+  NativeSecureStreamsStats,
+  NativeServiceStats,
+  NativeSendFileOptions,
+  NativeEncodable,
+  NativeSendOptions,
   NativeSocketOptions,
+  NativeSocketTuning,
+  NativeSocketTuningPreset,
+  NativeSocketTuningReport,
+  NativeStreamChunk,
+  NativeStreamSendOptions,
+  NativeTcpPathStats,
+  NativeTlsContextOptions,
+  NativeUdpSocketStats,
   QWTlsOptions,
   INativeTcpClient,
 } from "src/types/types";
@@ -15,19 +48,6 @@ const logNative = (msg: string) => {
   }
 };
 
-const requireFn =
-  typeof require === "function" ? require : createRequire(__filename);
-const bindingModuleRoot = path.resolve(__dirname, "..", "..");
-const envBindingPath = process.env.QWORMHOLE_NATIVE_PATH;
-const platformArch = `${process.platform}-${process.arch}`;
-const isTestRuntime =
-  process.env.NODE_ENV === "test" ||
-  process.env.VITEST === "true" ||
-  process.env.VITEST === "1" ||
-  !!process.env.VITEST_WORKER_ID;
-const allowPrebuiltProbeInTests =
-  process.env.QWORMHOLE_ENABLE_TEST_PREBUILDS === "1";
-
 type TlsBufferInput = string | Buffer | Array<string | Buffer> | undefined;
 
 const normalizeTlsBuffer = (value?: TlsBufferInput): Buffer | undefined => {
@@ -43,27 +63,53 @@ const serializeAlpn = (protocols?: string[]): string | undefined => {
   return protocols.join(",");
 };
 
+const observeConnect = (result: unknown): Promise<void> | void => {
+  if (result instanceof Promise) {
+    result.catch(() => undefined);
+    return result as Promise<void>;
+  }
+  return undefined;
+};
+
 type NativeBindingClient = INativeTcpClient & {
   connect(host: string, port: number): void;
   connect(opts: NativeSocketOptions): void;
-  send(data: string | Buffer): void;
-  sendMany?(data: Array<string | Buffer>): number | void;
+  send(data: NativeEncodable, options?: NativeSendOptions): boolean | void;
+  sendMany?(data: NativeEncodable[], options?: NativeSendOptions): number | void;
+  sendv?(data: Array<string | Buffer>): boolean;
+  attachSendRing?(ring: Uint8Array): boolean;
+  kickSendRing?(): void;
+  sendFile?(
+    file: string | number,
+    offset?: number,
+    length?: number,
+    options?: NativeSendFileOptions,
+  ): boolean;
+  sendStreamChunk?(streamId: number, data: Buffer, bits?: number): boolean;
   recv(length?: number): Buffer;
   isConnected?(): boolean;
   setEventHandler?(
     handler: (evt: {
       type: string;
       data?: Buffer;
+      /** nativeDecode: the "message" frame, decoded. */
+      value?: unknown;
       error?: string;
       hadError?: boolean;
-    }) => void,
+      queuedBytes?: number;
+      threshold?: number;
+    } & NativeMuxEvent & NativeRpcEvent) => void,
   ): void;
+  setEventCodeHandler?(handler: NativeEventCodeHandler): void;
   getTlsInfo?():
     | {
         alpnProtocol?: string;
         protocol?: string;
         cipher?: string;
         authorized?: boolean;
+        sessionReused?: boolean;
+        ktlsSend?: boolean;
+        ktlsRecv?: boolean;
         peerFingerprint?: string;
         peerFingerprint256?: string;
       }
@@ -73,99 +119,477 @@ type NativeBindingClient = INativeTcpClient & {
     label: string,
     context?: Buffer,
   ): Buffer | undefined;
+  setTuning?(tuning: NativeLwsTuning): NativeLwsTuning | undefined;
+  setFlowPolicy?(policy: NativeFlowPolicy | null): NativeFlowDiagnostics | null;
+  getFlowDiagnostics?(): NativeFlowDiagnostics | null;
+  getServiceStats?(): NativeServiceStats | undefined;
+  getStats?(): NativeClientTransportStats | undefined;
+  muxOpen?(): number | undefined;
+  muxWrite?(streamId: number, data: Buffer): boolean;
+  muxClose?(streamId: number, reset?: boolean): boolean;
+  rpcRequest?(payload: Buffer | string, timeoutMs?: number): number;
+  setSessionKey?(key: Buffer): void;
+  rekey?(): void;
+  setIdleTimeout?(ms: number): void;
+  getSocketOptions?(): NativeSocketTuningReport | undefined;
+  getConnectTimings?(): NativeConnectTimings | undefined;
+  getPathSample?(): NativeTcpPathStats | undefined;
+  close(): void;
+};
+
+type NativePoolHandle = {
+  close(): void;
+  getServiceStats(): NativeClientPoolStats | undefined;
+};
+
+/** Native KCP engine: one UDP socket, every session's ARQ state in C++. */
+export type NativeUdpSocketHandle = {
+  bind(): Promise<{ address: string; port: number; family: string }>;
+  send(data: Buffer, port: number, address?: string): boolean;
+  sendBatch(
+    datagrams: Array<Buffer | { data: Buffer; port?: number; address?: string }>,
+    port?: number,
+    address?: string,
+  ): number;
+  sendSegments(
+    data: Buffer,
+    segmentSize: number,
+    port: number,
+    address?: string,
+  ): number;
+  address(): { address: string; port: number; family: string };
+  getStats(): NativeUdpSocketStats;
+  close(): void;
+  emit?: (event: string, payload?: unknown) => boolean;
+};
+
+export type NativeKcpEngineHandle = {
+  bind(): Promise<{ address: string; port: number; family: string }>;
+  connect(address: string, port: number): string;
+  send(key: string, data: Buffer): boolean;
+  closeSession(key: string): void;
+  close(): void;
+  getSession(key: string): NativeKcpSessionStats | undefined;
+  getStats(): NativeKcpEngineStats;
+  emit?: (event: string, payload?: unknown) => boolean;
+};
+
+export type NativeDiscoveryOptions = {
+  group?: string;
+  port?: number;
+  /** Interface to join the group on; the kernel's choice otherwise. */
+  interface?: string;
+  /** Bytes every announcement starts with; anything else is dropped natively. */
+  prefix?: string;
+  /** Hear announcements from this host too (default true). */
+  loopback?: boolean;
+  intervalMs?: number;
+  /** Longest a new announcement waits for others to share its "peers" event. */
+  batchMs?: number;
+  maxBatch?: number;
+  /** An unchanged announcement is reported once per window. */
+  dedupeWindowMs?: number;
+  bloomBits?: number;
+};
+
+export type NativeDiscoveryStats = {
+  datagramsIn: number;
+  /** Dropped for not starting with the prefix, or truncated. */
+  filtered: number;
+  /** Already reported this dedupe window. */
+  duplicates: number;
+  selfEchoes: number;
+  emitted: number;
+  batches: number;
+  announcements: number;
+};
+
+export type NativeDiscoveryHandle = {
+  start(): Promise<{ group: string; port: number; family: string }>;
+  announce(data: Buffer): void;
+  close(): void;
+  getStats(): NativeDiscoveryStats;
+  emit?: (event: string, payload?: unknown) => boolean;
+};
+
+export type NativeMulticastOptions = {
+  group?: string;
+  port?: number;
+  /** Interface to join and send on; the kernel's choice otherwise. */
+  interface?: string;
+  /** Hear channels on this host too (default true); own frames never are. */
+  loopback?: boolean;
+  /** Multicast TTL / hop limit (default 1: the local segment). */
+  ttl?: number;
+  /** Largest frame (default 1400, one Ethernet datagram); receivers need as much. */
+  maxPayloadBytes?: number;
+  /** Frames kept for repair (default 4096 and 8 MiB); the oldest go first. */
+  windowFrames?: number;
+  windowBytes?: number;
+  /** How long a gap waits for reordering before its first NACK (default 5). */
+  nackDelayMs?: number;
+  /** Between NACKs for the same gap (default 40)... */
+  nackIntervalMs?: number;
+  /** ...and how many before its frames are given up as lost (default 5). */
+  maxNacks?: number;
+  /** NACKs for one frame before it is repaired to the group, not unicast (default 3). */
+  repairGroupAfter?: number;
+  /** First heartbeat after a send (default 100); they double for about a second. */
+  heartbeatMs?: number;
+  /** Out-of-order frames held per source before the oldest gap is lost (default 1024). */
+  maxHeldFrames?: number;
+  /** A silent source is forgotten after this long (default 30000). */
+  sourceTimeoutMs?: number;
+};
+
+export type NativeMulticastStats = {
+  framesSent: number;
+  bytesSent: number;
+  sendFailures: number;
+  framesReceived: number;
+  framesDelivered: number;
+  duplicates: number;
+  /** Not a channel datagram, or truncated. */
+  filtered: number;
+  nacksSent: number;
+  nacksReceived: number;
+  /** Unicast, to the receiver that asked. */
+  repairsSent: number;
+  groupRepairsSent: number;
+  repairsReceived: number;
+  /** NACKs answered with "no longer in the window". */
+  gapsSent: number;
+  framesLost: number;
+  heartbeatsSent: number;
+  sources: number;
+  windowFrames: number;
+  windowBytes: number;
+};
+
+export type NativeMulticastHandle = {
+  start(): Promise<{ group: string; port: number; family: string; sourceId: number }>;
+  send(data: Buffer): number | false;
+  close(): void;
+  getStats(): NativeMulticastStats;
+  emit?: (event: string, payload?: unknown) => boolean;
+};
+
+export type NativeUnixDgramOptions = {
+  /** Bind here and receive; without it the socket only sends. */
+  path?: string;
+  /** connect(2) to this receiver, so send() needs no path. */
+  connect?: string;
+  /** Datagrams per recvmmsg call and per "messages" event (default 32). */
+  batchSize?: number;
+  /** Receive slot size; larger datagrams are dropped (default 65536). */
+  maxDatagramBytes?: number;
+  /** SO_RCVBUF / SO_SNDBUF, forced past net.core.*mem_max with CAP_NET_ADMIN. */
+  receiveBufferBytes?: number;
+  sendBufferBytes?: number;
+};
+
+export type NativeUnixDgramStats = {
+  datagramsIn: number;
+  /** recvmmsg batches delivered; datagramsIn / batchesIn is the batch size. */
+  batchesIn: number;
+  /** Dropped for not fitting maxDatagramBytes. */
+  truncated: number;
+  datagramsOut: number;
+  /** Refused by a full receiver (EAGAIN), and for want of one at the path. */
+  wouldBlock: number;
+  noReceiver: number;
+  blocksAllocated: number;
+  blocksReused: number;
+  /** Effective sizes, as the kernel reports them (doubled). */
+  receiveBufferBytes: number;
+  sendBufferBytes: number;
+  /** net.unix.max_dgram_qlen, the receive queue cap in datagrams; -1 if unreadable. */
+  maxDgramQlen: number;
+};
+
+export type NativeUnixDgramAddress = {
+  path: string;
+  connect?: string;
+  receiveBufferBytes: number;
+  sendBufferBytes: number;
+};
+
+export type NativeUnixDgramHandle = {
+  bind(): Promise<NativeUnixDgramAddress>;
+  send(data: Buffer, path?: string): boolean;
+  sendBatch(datagrams: Array<Buffer | { data: Buffer; path?: string }>, path?: string): number;
+  address(): NativeUnixDgramAddress;
+  getStats(): NativeUnixDgramStats;
   close(): void;
+  emit?: (event: string, payload?: unknown) => boolean;
+};
+
+export type NativeWireGuardPeer = {
+  publicKey: Buffer;
+  endpoint?: { address: string; port: number; family: "IPv4" | "IPv6" };
+  /** Wall-clock ms of the last handshake; 0 when there has been none. */
+  lastHandshakeMs: number;
+  rxBytes: number;
+  txBytes: number;
+  persistentKeepaliveSecs: number;
+  protocolVersion: number;
+  /** "address/cidr" strings. */
+  allowedIps: string[];
+};
+
+export type NativeWireGuardDevice = {
+  name: string;
+  ifindex: number;
+  publicKey?: Buffer;
+  listenPort: number;
+  fwmark: number;
+  peers: NativeWireGuardPeer[];
+};
+
+export type NativeWireGuardPeerConfig = {
+  publicKey: Buffer;
+  /** Numeric address; no name resolution. */
+  endpoint?: { address: string; port: number };
+  persistentKeepaliveSecs?: number;
+  allowedIps?: string[];
+  /** Replace the peer's allowed IPs instead of adding to them. */
+  replaceAllowedIps?: boolean;
+  remove?: boolean;
+  /** Fail rather than create the peer when it does not exist. */
+  updateOnly?: boolean;
+};
+
+export type NativeWireGuardHandle = {
+  listDevices(): string[];
+  getDevice(name: string): NativeWireGuardDevice;
+  setPeer(name: string, peer: NativeWireGuardPeerConfig): void;
+  close(): void;
+};
+
+/** lws addon only, when built with LWS_WITH_SECURE_STREAMS. */
+export type NativeSecureStreamsHandle = {
+  setEventHandler(fn: (events: NativeSecureStreamEvent[]) => void): void;
+  create(streamtype: string, metadata?: Record<string, string>): number | undefined;
+  setMetadata(id: number, name: string, value: string): boolean;
+  write(id: number, data: Buffer | string): boolean;
+  requestTx(id: number): void;
+  destroy(id: number): void;
+  getStats(): NativeSecureStreamsStats | undefined;
+  close(): void;
+};
+
+type NativeHandshakeSignerHandle = {
+  sign(ts?: number): Buffer;
+  describe(): NativeHandshakeSignerInfo;
 };
 
 type NativeModule = {
   TcpClientWrapper: new () => NativeBindingClient;
+  TcpClientPool?: new (opts?: Record<string, unknown>) => NativePoolHandle;
+  TlsContext?: new (opts?: Record<string, unknown>) => object;
+  HandshakeSigner?: new (opts: Record<string, unknown>) => NativeHandshakeSignerHandle;
+  SecureStreams?: new (opts: { policy: string }) => NativeSecureStreamsHandle;
+  /** libsocket addon only. */
+  QWormholeKcpEngine?: new (
+    opts?: Record<string, unknown>,
+  ) => NativeKcpEngineHandle;
+  /** libsocket addon only. */
+  QWormholeUdpSocket?: new (
+    opts?: Record<string, unknown>,
+  ) => NativeUdpSocketHandle;
+  /** libsocket addon only: batched Unix datagram socket. */
+  QWormholeUnixDgram?: new (
+    opts?: NativeUnixDgramOptions,
+  ) => NativeUnixDgramHandle;
+  /** libsocket addon only: multicast discovery responder. */
+  QWormholeDiscovery?: new (
+    opts?: NativeDiscoveryOptions,
+  ) => NativeDiscoveryHandle;
+  /** libsocket addon only: NACK-repaired multicast channel. */
+  QWormholeMulticast?: new (
+    opts?: NativeMulticastOptions,
+  ) => NativeMulticastHandle;
+  /** libsocket addon only: WireGuard devices over generic netlink. */
+  QWormholeWireGuard?: new () => NativeWireGuardHandle;
+  /** lws addon only: banked byte histogram + log table, bits per byte. */
+  computeEntropy?: (data: Uint8Array | string) => number;
+  /** lws addon only: the compiled SCP schema check; null or why the frame fails. */
+  validateHandshake?: NativeHandshakeValidator;
+  /** lws addon only: row-major coherence kernels, see src/coherence/native-math.ts. */
+  normalizeRows?: NativeCoherenceKernels["normalizeRows"];
+  matVec?: NativeCoherenceKernels["matVec"];
+  nboSweeps?: NativeCoherenceKernels["nboSweeps"];
+  vectorStats?: NativeCoherenceKernels["vectorStats"];
+  superformulaRadii?: NativeCoherenceKernels["superformulaRadii"];
+  superformulaLoss?: NativeCoherenceKernels["superformulaLoss"];
+  superformulaSearch?: NativeCoherenceKernels["superformulaSearch"];
+  /** lws addon only: length-prefix parsing over a chunk list. */
+  FrameSplitter?: new (opts: NativeFrameSplitterOptions) => NativeFrameSplitter;
+  /** lws addon only: a BatchFramer send queue framed in one native slab. */
+  FrameRing?: new (opts: { capacityBytes?: number }) => NativeFrameRing;
+  PriorityScheduler?: new (
+    opts: NativePrioritySchedulerOptions,
+  ) => NativePriorityScheduler;
+  GeometryAccumulator?: new (opts: {
+    features: number;
+    targets?: number;
+  }) => GeometryAccumulator;
+  /** lws addon only: incremental coherence inputs, see src/core/transport-coherence-pipeline.ts. */
+  CoherenceAccumulator?: new (opts?: { historySize?: number }) => NativeCoherenceAccumulatorHandle;
+  /** lws addon only: per-peer streaming detectors, see src/coherence/detector-bank.ts. */
+  DetectorBank?: new (opts?: DetectorBankOptions) => DetectorBankHandle;
+  /** lws addon only: append-only columnar trace files, see src/telemetry. */
+  TraceRecorder?: new (opts: {
+    path: string;
+    initialBytes?: number;
+  }) => NativeTraceRecorder;
+  mapTraceFile?: (path: string) => ArrayBuffer | null;
+  LatencyHistogram?: new () => NativeLatencyHistogram;
+  BundleReorder?: new (opts?: NativeBundleReorderOptions) => NativeBundleReorder;
+  PeerStore?: new (opts: NativePeerStoreOptions & { path: string }) => NativePeerStore;
+  bufferPoolStats?: () => NativeBufferPoolStats;
+  setBufferPoolLimit?: (bytes: number) => void;
+  /** lws addon only: the service-thread profiler. */
+  setServiceProfiling?: (enabled: boolean) => void;
+  serviceProfile?: () => NativeServiceProfile;
+  serviceProfileFolded?: () => string;
+  /** lws addon only: cooperative ids, see src/utils/ids.ts. */
+  nextId?: NativeIdService["nextId"];
+  fillIds?: NativeIdService["fillIds"];
+  setIdNode?: NativeIdService["setIdNode"];
 };
 
-type LoadedBinding = {
-  kind: NativeBackend;
-  module: NativeModule;
+export type NativeIdService = {
+  nextId(): bigint;
+  fillIds(buffer: Buffer, offset?: number, count?: number): number;
+  setIdNode(node: number): void;
 };
 
-const resolveBindings = () =>
-  (globalThis as unknown as { bindings?: typeof bindings }).bindings ??
-  bindings;
+/**
+ * Schemas compiled from src/schema/scp.ts into the lws addon. Left out, the
+ * validator picks as `strictHandshake` does: negentropic for a frame with a
+ * publicKey and no resumeProof, handshake otherwise.
+ */
+export type NativeHandshakeSchema = "handshake" | "negentropic" | "entropyMetrics";
 
-type BindingLoader = (
-  target: string | { module_root: string; bindings: string },
-) => unknown;
+export type NativeHandshakeValidator = (
+  frame: Uint8Array | string,
+  schema?: NativeHandshakeSchema,
+) => string | null;
 
-const tryLoadBindingPath = (targetPath: string): NativeModule | null => {
-  try {
-    logNative(`attempting to load binding path "${targetPath}"`);
-    const mod = requireFn(targetPath) as NativeModule;
-    if (!mod?.TcpClientWrapper) {
-      logNative(`binding path "${targetPath}" missing TcpClientWrapper export`);
-      return null;
-    }
-    logNative(`successfully loaded binding path "${targetPath}"`);
-    return mod;
-  } catch (err) {
-    logNative(
-      `binding path "${targetPath}" not found: ${(err as Error).message}`,
-    );
-    return null;
-  }
+export type NativeFrameSplitterOptions = {
+  maxFrameLength: number;
+  /** Treat the prefix's top bit as the compressed-payload flag. */
+  compressedFlag?: boolean;
+  /** Check and strip CRC32C trailers flagged in the prefix (caps.integrity). */
+  checksumFlag?: boolean;
 };
 
-const tryLoadBinding = (name: string): NativeModule | null => {
-  try {
-    logNative(`attempting to load binding "${name}"`);
-    const loader = resolveBindings() as BindingLoader;
-    const mod = loader({
-      module_root: bindingModuleRoot,
-      bindings: name,
-    }) as NativeModule;
-    logNative(`successfully loaded binding "${name}"`);
-    return mod;
-  } catch (err) {
-    logNative(`binding "${name}" not found: ${(err as Error).message}`);
-    return null;
-  }
+/**
+ * Splits length-prefixed frames out of pushed chunks. Frames inside one
+ * chunk are subarrays of it; one straddling chunks is copied once.
+ * `compressed` holds the indices of frames flagged compressed; `oversized`
+ * the length that broke maxFrameLength and `corrupt` the index of a frame
+ * whose checksum failed, either of which resets the splitter.
+ */
+export type NativeFrameSplitter = {
+  push(chunk: Buffer): {
+    frames: Buffer[];
+    compressed?: number[];
+    oversized?: number;
+    corrupt?: number;
+  };
+  reset(): void;
+  buffered(): number;
 };
 
-const bindingPathCandidates = (bindingName: string): string[] => {
-  const candidates: string[] = [];
-  if (envBindingPath) candidates.push(envBindingPath);
-  if (isTestRuntime && !allowPrebuiltProbeInTests) {
-    return candidates;
-  }
-  candidates.push(
-    path.join(bindingModuleRoot, "dist", "native", `${bindingName}.node`),
-    path.join(bindingModuleRoot, "prebuilds", platformArch, `${bindingName}.node`),
-    path.join(
-      bindingModuleRoot,
-      "dist",
-      "native",
-      "prebuilds",
-      platformArch,
-      `${bindingName}.node`,
-    ),
-  );
-  return candidates;
+export type NativeNboSweepOptions = {
+  couplingStrength: number;
+  lo: number;
+  hi: number;
+  minProb: number;
+  boundaryMargin: number;
+  boundPenalty: number;
+  ridge: number;
+  coordSweeps: number;
+  tol: number;
+  maxIter: number;
 };
 
+/**
+ * Float64 kernels for the coherence math. Matrices are row-major;
+ * normalizeRows works in place and returns its argument. Superformula
+ * parameter sets are six values (m, n1, n2, n3, a, b) laid end to end;
+ * the Huber loss applies when huberDelta is given.
+ */
+export type NativeCoherenceKernels = {
+  normalizeRows(matrix: Float64Array, rows: number, cols: number): Float64Array;
+  matVec(
+    matrix: Float64Array,
+    vector: Float64Array,
+    rows: number,
+    cols: number,
+    normalize?: boolean,
+  ): Float64Array;
+  nboSweeps(
+    baseField: Float64Array,
+    options: NativeNboSweepOptions,
+  ): { offsets: Float64Array; epiplexityPerNode: Float64Array };
+  vectorStats(
+    a: Float64Array,
+    b?: Float64Array,
+  ): { dot: number; sumSqA: number; sumSqB: number; distSq: number };
+  /** One row of radii per parameter set. */
+  superformulaRadii(angles: Float64Array, params: Float64Array): Float64Array;
+  /** computeLoss() per parameter set. */
+  superformulaLoss(
+    angles: Float64Array,
+    radii: Float64Array,
+    params: Float64Array,
+    huberDelta?: number,
+  ): Float64Array;
+  /** localSearch() per seed: seven values each, the fitted set then its loss. */
+  superformulaSearch(
+    angles: Float64Array,
+    radii: Float64Array,
+    seeds: Float64Array,
+    iterations: number,
+    huberDelta?: number,
+  ): Float64Array;
+};
+
+type LoadedBinding = {
+  kind: NativeBackend;
+  module: NativeModule;
+};
+
+/** seal keys: raw bytes, or the Base64 form session/ helpers pass around. */
+export const toSessionKey = (key: Uint8Array | string): Buffer =>
+  typeof key === "string"
+    ? Buffer.from(key, "base64")
+    : Buffer.from(key.buffer, key.byteOffset, key.byteLength);
+
+const SOCKET_TUNING_PRESETS: Record<NativeSocketTuningPreset, NativeSocketTuning> = {
+  latency: { noDelay: true, quickAck: true, notSentLowatBytes: 16 * 1024, busyPollUs: 50 },
+  bulk: { noDelay: false, sendBufferBytes: 4 * 1024 * 1024, receiveBufferBytes: 4 * 1024 * 1024 },
+};
+
+/** socketOptions as the addons read it: presets expand to their fields. */
+export const resolveSocketTuning = (
+  options: NativeSocketTuning | NativeSocketTuningPreset,
+): NativeSocketTuning =>
+  typeof options === "string" ? { ...SOCKET_TUNING_PRESETS[options] } : options;
+
 const loadNative = (preferred?: NativeBackend): LoadedBinding | null => {
   const order: NativeBackend[] = preferred
     ? [preferred, preferred === "lws" ? "libsocket" : "lws"]
     : ["lws", "libsocket"];
 
   for (const kind of order) {
-    const bindingName = kind === "lws" ? "qwormhole_lws" : "qwormhole";
-    logNative(`trying backend: ${kind} (${bindingName})`);
-    for (const candidatePath of bindingPathCandidates(bindingName)) {
-      const mod = tryLoadBindingPath(candidatePath);
-      if (mod?.TcpClientWrapper) {
-        logNative(`loaded native backend "${kind}" from ${candidatePath}`);
-        return { kind, module: mod };
-      }
-    }
-    const module = tryLoadBinding(bindingName);
+    logNative(`trying backend: ${kind}`);
+    const module = loadBackendAddon<NativeModule>(kind);
     if (module?.TcpClientWrapper) {
-      logNative(`loaded native backend "${kind}" from ${bindingName}`);
+      logNative(`loaded native backend "${kind}"`);
       return { kind, module };
     } else {
       logNative(`backend "${kind}" not available (missing TcpClientWrapper)`);
@@ -202,14 +626,789 @@ export const getNativeBackend = (): NativeBackend | null =>
 
 export const isNativeAvailable = (): boolean => Boolean(ensureNativeBinding());
 
+/** Whether the libsocket client loads, whichever backend is the default. */
+export const isNativeLibsocketAvailable = (): boolean =>
+  Boolean(ensureLibsocketBinding()?.TcpClientWrapper);
+
+/** The addon's byte-entropy kernel, or null when the lws binding is not loaded. */
+export const getNativeEntropyKernel = ():
+  | ((data: Uint8Array | string) => number)
+  | null => ensureNativeBinding()?.module.computeEntropy ?? null;
+
+/**
+ * The addon's compiled handshake schema check (strictHandshake's), or null
+ * when the lws binding is not loaded. Returns null for a valid frame.
+ */
+export const getNativeHandshakeValidator = (): NativeHandshakeValidator | null =>
+  ensureNativeBinding()?.module.validateHandshake ?? null;
+
+/** The addon's id service, or null when the lws binding is not loaded. */
+export const getNativeIdService = (): NativeIdService | null => {
+  const module = ensureNativeBinding()?.module;
+  if (!module?.nextId || !module.fillIds || !module.setIdNode) return null;
+  return { nextId: module.nextId, fillIds: module.fillIds, setIdNode: module.setIdNode };
+};
+
+/** The addon's coherence kernels, or null when the lws binding is not loaded. */
+export const getNativeCoherenceKernels = (): NativeCoherenceKernels | null => {
+  const module = ensureNativeBinding()?.module;
+  if (
+    !module?.normalizeRows ||
+    !module.matVec ||
+    !module.nboSweeps ||
+    !module.vectorStats ||
+    !module.superformulaRadii ||
+    !module.superformulaLoss ||
+    !module.superformulaSearch
+  ) {
+    return null;
+  }
+  const {
+    normalizeRows,
+    matVec,
+    nboSweeps,
+    vectorStats,
+    superformulaRadii,
+    superformulaLoss,
+    superformulaSearch,
+  } = module;
+  return {
+    normalizeRows,
+    matVec,
+    nboSweeps,
+    vectorStats,
+    superformulaRadii,
+    superformulaLoss,
+    superformulaSearch,
+  };
+};
+
+/** A native FrameSplitter, or null when the lws binding is not loaded. */
+export const createNativeFrameSplitter = (
+  options: NativeFrameSplitterOptions,
+): NativeFrameSplitter | null => {
+  const Splitter = ensureNativeBinding()?.module.FrameSplitter;
+  return Splitter ? new Splitter(options) : null;
+};
+
+/**
+ * Length-prefixed frames queued in one native slab. flush() sends what it
+ * can with one sendmsg() on `fd` and returns the bytes sent (-1 when the
+ * descriptor failed); take() copies out and drops whatever is left.
+ */
+export type NativeFrameRing = {
+  append(payload: Uint8Array): boolean;
+  flush(fd: number, maxBytes?: number): number;
+  take(): Buffer;
+  pending(): { frames: number; bytes: number };
+  stats(): {
+    capacityBytes: number;
+    framed: number;
+    rejected: number;
+    syscalls: number;
+    partialWrites: number;
+    bytesWritten: number;
+    copies: number;
+    copiedBytes: number;
+    maxPendingBytes: number;
+    maxPendingFrames: number;
+  };
+  clear(): void;
+};
+
+/** A native FrameRing, or null when the lws binding is not loaded. */
+export const createNativeFrameRing = (options?: {
+  capacityBytes?: number;
+}): NativeFrameRing | null => {
+  const Ring = ensureNativeBinding()?.module.FrameRing;
+  return Ring ? new Ring(options ?? {}) : null;
+};
+
+export type NativePrioritySchedulerOptions = {
+  /** Gate dequeues at this rate; ungated when unset. */
+  rateBytesPerSec?: number;
+  /** Token bucket depth; one second of the rate by default. */
+  burstBytes?: number;
+  /** Charged per message on top of its length (4 for a length prefix). */
+  overheadBytes?: number;
+};
+
+/**
+ * Buffers in priority lanes (lowest first, FIFO within one), optionally
+ * gated by a token bucket: dequeueMany() stops at the first message the
+ * bucket cannot cover yet, and waitMs() says how long that takes.
+ */
+export type NativePriorityScheduler = {
+  enqueue(data: Buffer, priority?: number): void;
+  dequeue(): Buffer | undefined;
+  dequeueMany(maxItems: number): Buffer[];
+  waitMs(): number;
+  length(): number;
+  getStats(): {
+    length: number;
+    maxLength: number;
+    totalEnqueued: number;
+    totalDequeued: number;
+    bytes: number;
+    maxBytes: number;
+    bytesEnqueued: number;
+    bytesDequeued: number;
+    rateWaits: number;
+  };
+  resetStats(): void;
+  clear(): void;
+};
+
+/** A native PriorityScheduler, or null when the lws binding is not loaded. */
+export const createNativePriorityScheduler = (
+  options?: NativePrioritySchedulerOptions,
+): NativePriorityScheduler | null => {
+  const Scheduler = ensureNativeBinding()?.module.PriorityScheduler;
+  return Scheduler ? new Scheduler(options ?? {}) : null;
+};
+
+/**
+ * Sliding-window normal equations: add() and remove() apply one sample's
+ * rank-1 term; solve(lambda) returns the ridge coefficients per target,
+ * end to end, with residual and total sums of squares per target.
+ */
+export type GeometryAccumulator = {
+  add(features: Float64Array, targets: Float64Array): boolean;
+  remove(features: Float64Array, targets: Float64Array): boolean;
+  solve(lambda: number): {
+    coeffs: Float64Array;
+    ssRes: Float64Array;
+    ssTot: Float64Array;
+  };
+  count(): number;
+  reset(): void;
+};
+
+/** Thresholds and windows; the defaults are CommitmentDetector's and ResonanceDetector's. */
+export type DetectorBankOptions = {
+  /** Peer slots to allocate up front; tick() grows the bank as needed. */
+  peers?: number;
+  commitment?: {
+    vEpsilon?: number;
+    mStable?: number;
+    resonanceThreshold?: number;
+    /** Samples (default 5, 2..256). */
+    window?: number;
+    horizonMs?: number;
+    tauMs?: number;
+  };
+  resonance?: {
+    vEpsilon?: number;
+    mStable?: number;
+    resonanceThreshold?: number;
+    /** Samples (default 10, 2..256). */
+    window?: number;
+  };
+};
+
+export type DetectorBankHandle = {
+  /** Updates one peer per input row; returns how many raised an event. */
+  tick(nowMs: number, input: Float64Array, out: Float64Array): number;
+  reset(peer?: number): void;
+  peers(): number;
+};
+
+/** A native DetectorBank, or null when the lws binding is not loaded. */
+export const createNativeDetectorBank = (
+  opts?: DetectorBankOptions,
+): DetectorBankHandle | null => {
+  const Bank = ensureNativeBinding()?.module.DetectorBank;
+  return Bank ? new Bank(opts) : null;
+};
+
+/**
+ * The lws addon's SecureStreams constructor, or undefined when the addon is
+ * not loaded or libwebsockets was built without Secure Streams.
+ */
+export const loadNativeSecureStreams = ():
+  | (new (opts: { policy: string }) => NativeSecureStreamsHandle)
+  | undefined => {
+  const binding = ensureNativeBinding("lws");
+  return binding?.kind === "lws" ? binding.module.SecureStreams : undefined;
+};
+
+/**
+ * TransportCoherenceComponents kept over rolling windows of telemetry
+ * records; components() writes them in TRANSPORT_COHERENCE_COMPONENT_FIELDS
+ * order. drain() takes a server's telemetry rings directly and returns -1
+ * for an unknown token.
+ */
+export type NativeCoherenceAccumulatorHandle = {
+  ingest(records: Float64Array, count: number): void;
+  drain(token: string, maxRecords?: number): number;
+  components(out?: Float64Array): Float64Array;
+  reset(): void;
+};
+
+/** A native CoherenceAccumulator, or null when the lws binding is not loaded. */
+export const createNativeCoherenceAccumulator = (
+  historySize?: number,
+): NativeCoherenceAccumulatorHandle | null => {
+  const Accumulator = ensureNativeBinding()?.module.CoherenceAccumulator;
+  return Accumulator ? new Accumulator({ historySize }) : null;
+};
+
+/** A native GeometryAccumulator, or null when the lws binding is not loaded. */
+export const createNativeGeometryAccumulator = (
+  features: number,
+  targets = 3,
+): GeometryAccumulator | null => {
+  const Accumulator = ensureNativeBinding()?.module.GeometryAccumulator;
+  return Accumulator ? new Accumulator({ features, targets }) : null;
+};
+
+/**
+ * Writes trace blocks into a memory-mapped file: `columns` holds
+ * columns.length / rows columns back to back. append() returns the block's
+ * file offset; close() writes the index and trims the file.
+ */
+export type NativeTraceRecorder = {
+  append(
+    schema: number,
+    label: string,
+    columns: Float64Array,
+    rows: number,
+    t0?: number,
+    t1?: number,
+  ): number;
+  stats(): { blocks: number; bytes: number };
+  close(): void;
+};
+
+/** A native TraceRecorder, or null when the lws binding is not loaded. */
+export const createNativeTraceRecorder = (
+  path: string,
+  initialBytes?: number,
+): NativeTraceRecorder | null => {
+  const Recorder = ensureNativeBinding()?.module.TraceRecorder;
+  return Recorder ? new Recorder({ path, initialBytes }) : null;
+};
+
+/**
+ * A trace file mapped read-only, so column views page in on demand. Null
+ * without the lws binding or when the file cannot be mapped.
+ */
+export const mapNativeTraceFile = (path: string): ArrayBuffer | null =>
+  ensureNativeBinding()?.module.mapTraceFile?.(path) ?? null;
+
+/** Summary fields of a latency histogram, in ms. */
+export type LatencyHistogramSummary = {
+  count: number;
+  min: number;
+  max: number;
+  mean: number;
+  p50: number;
+  p90: number;
+  p99: number;
+  p999: number;
+};
+
+/**
+ * Log-linear latency histogram, 128 sub-buckets per power of two of ns.
+ * buckets() is [lowerMs, upperMs, count] per non-empty bucket, flattened.
+ */
+export type NativeLatencyHistogram = {
+  recordBatch(valuesMs: Float64Array, count?: number): void;
+  summary(): LatencyHistogramSummary;
+  buckets(): Float64Array;
+  reset(): void;
+};
+
+/** A native LatencyHistogram, or null when the lws binding is not loaded. */
+export const createNativeLatencyHistogram = (): NativeLatencyHistogram | null => {
+  const Histogram = ensureNativeBinding()?.module.LatencyHistogram;
+  return Histogram ? new Histogram() : null;
+};
+
+export type NativeBundleReorderOptions = {
+  /** Early frames held before the missing one is given up on (default 4096). */
+  maxHeldFrames?: number;
+  /** Bytes of early frames held before giving up (default 64 MiB). */
+  maxHeldBytes?: number;
+};
+
+export type NativeBundleReorderStats = {
+  nextSeq: number;
+  held: number;
+  heldBytes: number;
+  delivered: number;
+  /** Frames that arrived ahead of a missing one and were held. */
+  reordered: number;
+  duplicates: number;
+  /** Sequence numbers skipped by flush() or a full hold. */
+  gaps: number;
+};
+
+/**
+ * Puts frames numbered from 0 back in order. push() returns what became
+ * deliverable; flush() releases everything held, skipping gaps.
+ */
+export type NativeBundleReorder = {
+  push(seq: number, data: Buffer): Buffer[];
+  flush(): Buffer[];
+  stats(): NativeBundleReorderStats;
+};
+
+/** A native BundleReorder, or null when the lws binding is not loaded. */
+export const createNativeBundleReorder = (
+  opts?: NativeBundleReorderOptions,
+): NativeBundleReorder | null => {
+  const Reorder = ensureNativeBinding()?.module.BundleReorder;
+  return Reorder ? new Reorder(opts) : null;
+};
+
+export type NativePeerStoreOptions = {
+  /** Share of the log that may be dead records before it is compacted (default 0.5). */
+  compactRatio?: number;
+  /** Dead bytes below which the log is never compacted (default 64 KiB). */
+  compactMinBytes?: number;
+};
+
+export type NativePeerStoreStats = {
+  count: number;
+  logBytes: number;
+  /** Bytes of the latest record of every live key. */
+  liveBytes: number;
+  /** Index slots; the index grows at 70% occupancy. */
+  capacity: number;
+  /** Bumped by every compaction, which rewrites the log. */
+  generation: number;
+  compactions: number;
+};
+
+/**
+ * A key/value store over an append-only record log, with a hash index of
+ * the latest record per key. put() and delete() append one record.
+ */
+export type NativePeerStore = {
+  get(key: string): Buffer | null;
+  put(key: string, value: Buffer | string): void;
+  delete(key: string): boolean;
+  keys(): string[];
+  entries(): Array<[string, Buffer]>;
+  compact(): void;
+  sync(): void;
+  stats(): NativePeerStoreStats;
+  close(): void;
+};
+
+/**
+ * A native PeerStore over `path`, its index memory-mapped at `path`.idx.
+ * Null when the lws binding is not loaded (or on Windows).
+ */
+export const createNativePeerStore = (
+  path: string,
+  opts: NativePeerStoreOptions = {},
+): NativePeerStore | null => {
+  const Store = ensureNativeBinding()?.module.PeerStore;
+  return Store ? new Store({ ...opts, path }) : null;
+};
+
+/**
+ * The lws addon's send-buffer and RX-slab pools, summed over threads.
+ * cachedBytes is what sits in free lists; inUseBytes is pooled storage
+ * still referenced by queued writes or JS Buffers.
+ */
+export type NativeBufferPoolStats = {
+  hits: number;
+  misses: number;
+  hitRate: number;
+  /** Requests above the largest size class (1 MiB), never cached. */
+  oversized: number;
+  /** Buffers freed on return because the pool was at its limit. */
+  dropped: number;
+  trimmedBytes: number;
+  cachedBytes: number;
+  cachedBuffers: number;
+  inUseBytes: number;
+  pools: number;
+  limitBytes: number;
+};
+
+/** Buffer pool counters, or null when the lws binding is not loaded. */
+export const getNativeBufferPoolStats = (): NativeBufferPoolStats | null =>
+  ensureNativeBinding()?.module.bufferPoolStats?.() ?? null;
+
+/**
+ * Caps the bytes each native thread keeps cached (default 8 MiB, or
+ * QWORMHOLE_BUFFER_POOL_BYTES); 0 turns pooling off. False without the lws
+ * binding.
+ */
+export const setNativeBufferPoolLimit = (bytes: number): boolean => {
+  const setLimit = ensureNativeBinding()?.module.setBufferPoolLimit;
+  if (!setLimit) return false;
+  setLimit(bytes);
+  return true;
+};
+
+/**
+ * Where lws service threads spend their time, process-wide. `sites` is
+ * keyed by callback reason (RAW_RX, RAW_WRITEABLE, RAW_ADOPT, ...) and by
+ * phase (frame_decode, handshake_verify, tsfn_dispatch, service_drain,
+ * lock_wait:*), each an inclusive-time histogram in us. A lock_wait site
+ * only times acquires that found the lock held.
+ */
+export type NativeServiceProfile = {
+  enabled: boolean;
+  /** The counter timings are read from: "rdtsc", "cntvct" or "steady". */
+  clock: string;
+  ticksPerNs: number;
+  elapsedMs: number;
+  sites: Record<string, NativeHistogramSnapshot>;
+  /** Acquires while profiling, and how many had to wait, by lock. */
+  locks: Record<string, { acquires: number; contended: number }>;
+  /** Records whose stack found no free slot; their site histograms still count. */
+  droppedStacks: number;
+};
+
+/**
+ * Turns the lws service-thread profiler on, starting a fresh profile, or
+ * off. Off, each profiled scope costs one relaxed load; on, two cycle
+ * counter reads and a few relaxed atomics. False without the lws binding.
+ */
+export const setNativeServiceProfiling = (enabled: boolean): boolean => {
+  const setProfiling = ensureNativeBinding()?.module.setServiceProfiling;
+  if (!setProfiling) return false;
+  setProfiling(enabled);
+  return true;
+};
+
+/** The current service-thread profile, or null without the lws binding. */
+export const getNativeServiceProfile = (): NativeServiceProfile | null =>
+  ensureNativeBinding()?.module.serviceProfile?.() ?? null;
+
+/**
+ * The profile as flamegraph folded stacks ("server;RAW_RX;frame_decode
+ * 1234", self time in ns per line), or null without the lws binding.
+ */
+export const getNativeServiceProfileFolded = (): string | null =>
+  ensureNativeBinding()?.module.serviceProfileFolded?.() ?? null;
+
+let libsocketBinding: LoadedBinding | null | undefined;
+
+/**
+ * qwormhole.node for its datagram exports. Cached separately so the client
+ * backend choice is untouched.
+ */
+const ensureLibsocketBinding = (): NativeModule | null => {
+  if (nativeDisabled()) return null;
+  if (libsocketBinding === undefined) {
+    libsocketBinding =
+      nativeBinding?.kind === "libsocket"
+        ? nativeBinding
+        : loadNative("libsocket");
+  }
+  return libsocketBinding?.kind === "libsocket"
+    ? libsocketBinding.module
+    : null;
+};
+
+/** The libsocket addon's KCP engine constructor, or null when unavailable. */
+export const getNativeKcpEngine = ():
+  | NonNullable<NativeModule["QWormholeKcpEngine"]>
+  | null => ensureLibsocketBinding()?.QWormholeKcpEngine ?? null;
+
+/** The libsocket addon's batched UDP socket constructor, or null. */
+export const getNativeUdpSocket = ():
+  | NonNullable<NativeModule["QWormholeUdpSocket"]>
+  | null => ensureLibsocketBinding()?.QWormholeUdpSocket ?? null;
+
+/** The libsocket addon's batched Unix datagram socket, or null. */
+export const getNativeUnixDgram = ():
+  | NonNullable<NativeModule["QWormholeUnixDgram"]>
+  | null => ensureLibsocketBinding()?.QWormholeUnixDgram ?? null;
+
+/** The libsocket addon's multicast discovery responder, or null. */
+export const getNativeDiscovery = ():
+  | NonNullable<NativeModule["QWormholeDiscovery"]>
+  | null => ensureLibsocketBinding()?.QWormholeDiscovery ?? null;
+
+/** The libsocket addon's reliable multicast channel, or null. */
+export const getNativeMulticast = ():
+  | NonNullable<NativeModule["QWormholeMulticast"]>
+  | null => ensureLibsocketBinding()?.QWormholeMulticast ?? null;
+
+/** The libsocket addon's WireGuard netlink client constructor, or null. */
+export const getNativeWireGuard = ():
+  | NonNullable<NativeModule["QWormholeWireGuard"]>
+  | null => ensureLibsocketBinding()?.QWormholeWireGuard ?? null;
+
+/**
+ * Client TLS credentials parsed once into an SSL_CTX that every native
+ * connection given this handle reuses. Identical credentials share one
+ * SSL_CTX process-wide.
+ */
+export class NativeTlsContext {
+  /** @internal Native TlsContext handed to connect() as tlsContext. */
+  readonly handle: object;
+
+  constructor(options: NativeTlsContextOptions = {}) {
+    const binding = ensureNativeBinding("lws");
+    const ContextCtor =
+      binding?.kind === "lws" ? binding.module.TlsContext : undefined;
+    if (!ContextCtor) {
+      throw new Error(
+        "Native TLS contexts require the libwebsockets backend. Run `pnpm run rebuild` or disable preferNative.",
+      );
+    }
+    const payload: Record<string, unknown> = {};
+    // The shared context trusts every CA given, not only the first.
+    const cas = Array.isArray(options.ca)
+      ? options.ca
+      : options.ca
+        ? [options.ca]
+        : [];
+    if (cas.length > 0) {
+      payload.tlsCa = Buffer.concat(
+        cas.map(ca => Buffer.concat([Buffer.from(ca), Buffer.from("\n")])),
+      );
+    }
+    const cert = normalizeTlsBuffer(options.cert);
+    const key = normalizeTlsBuffer(options.key);
+    if (cert) payload.tlsCert = cert;
+    if (key) payload.tlsKey = key;
+    if (options.passphrase) payload.tlsPassphrase = options.passphrase;
+    if (options.ktls) payload.tlsKtls = true;
+    this.handle = new ContextCtor(payload);
+  }
+}
+
+/** Parse client credentials once for reuse via `tls.context`. */
+export const createTlsContext = (
+  options: NativeTlsContextOptions = {},
+): NativeTlsContext => new NativeTlsContext(options);
+
+/**
+ * An Ed25519 handshake key loaded once into the lws addon, with its SPKI
+ * publicKey, nIndex, negHash and nonce derived up front. Each handshake then
+ * costs one canonical serialization and one signature, and the frame is the
+ * one createNegentropicHandshake() would build for the same key.
+ */
+export class NativeHandshakeSigner {
+  /** @internal Native HandshakeSigner handed to connect() as handshake. */
+  readonly handle: NativeHandshakeSignerHandle;
+  readonly info: NativeHandshakeSignerInfo;
+
+  constructor(options: NativeHandshakeSignerOptions) {
+    const binding = ensureNativeBinding("lws");
+    const SignerCtor =
+      binding?.kind === "lws" ? binding.module.HandshakeSigner : undefined;
+    if (!SignerCtor) {
+      throw new Error(
+        "Native handshake signers require the libwebsockets backend. Run `pnpm run rebuild` or disable preferNative.",
+      );
+    }
+    const payload: Record<string, unknown> = { signingKey: options.signingKey };
+    if (options.version !== undefined) payload.version = options.version;
+    if (options.tags) payload.tags = options.tags;
+    this.handle = new SignerCtor(payload);
+    this.info = this.handle.describe();
+  }
+
+  /** The signed handshake JSON, stamped with `ts` (default now). */
+  sign(ts?: number): Buffer {
+    return this.handle.sign(ts);
+  }
+}
+
+/** Load a handshake key once for reuse via `handshake`. */
+export const createHandshakeSigner = (
+  options: NativeHandshakeSignerOptions,
+): NativeHandshakeSigner => new NativeHandshakeSigner(options);
+
+/**
+ * Shared lws event loops for many native clients. Each thread owns one lws
+ * context (and SSL_CTX); clients created with this pool multiplex onto them
+ * instead of spinning up a context and service thread per connection.
+ */
+export class NativeClientPool {
+  private readonly handles: NativePoolHandle[];
+  private next = 0;
+  private closed = false;
+
+  constructor(options: NativeClientPoolOptions = {}) {
+    const binding = ensureNativeBinding("lws");
+    const PoolCtor =
+      binding?.kind === "lws" ? binding.module.TcpClientPool : undefined;
+    if (!PoolCtor) {
+      throw new Error(
+        "Native client pools require the libwebsockets backend. Run `pnpm run rebuild` or disable preferNative.",
+      );
+    }
+    const payload: Record<string, unknown> = {};
+    const tls = options.tls;
+    if (tls?.context) {
+      payload.tlsContext = tls.context.handle;
+    } else if (tls) {
+      const ca = normalizeTlsBuffer(tls.ca);
+      const cert = normalizeTlsBuffer(tls.cert);
+      const key = normalizeTlsBuffer(tls.key);
+      if (ca) payload.tlsCa = ca;
+      if (cert) payload.tlsCert = cert;
+      if (key) payload.tlsKey = key;
+      if (tls.passphrase) payload.tlsPassphrase = tls.passphrase;
+      if (tls.ktls) payload.tlsKtls = true;
+    }
+    const threads = Math.max(1, Math.floor(options.threads ?? 1));
+    this.handles = Array.from({ length: threads }, () => new PoolCtor(payload));
+  }
+
+  get threads(): number {
+    return this.handles.length;
+  }
+
+  /** Next pool thread for a new connection (round-robin). */
+  acquire(): NativePoolHandle {
+    if (this.closed) {
+      throw new Error("Native client pool is closed");
+    }
+    const handle = this.handles[this.next % this.handles.length];
+    this.next = (this.next + 1) % this.handles.length;
+    return handle;
+  }
+
+  getServiceStats(): NativeClientPoolStats[] {
+    return this.handles
+      .map(handle => handle.getServiceStats())
+      .filter((stats): stats is NativeClientPoolStats => Boolean(stats));
+  }
+
+  /** Stops the shared loops; pooled clients still open are torn down. */
+  close(): void {
+    if (this.closed) return;
+    this.closed = true;
+    for (const handle of this.handles) {
+      handle.close();
+    }
+  }
+}
+
+/**
+ * Event codes for NativeTcpClient.setEventCodeHandler(). The handler gets
+ * (code, data, arg, arg2): data is the payload for Data and Message; arg
+ * is the error text (Error), hadError (Close), queuedBytes (Backpressure,
+ * with the threshold in arg2), the event object (Mux, Rpc, Stream,
+ * Reconnecting, Failover) or,
+ * under nativeDecode, the decoded Message with data undefined. Stream
+ * passes the chunk's data, without its header, as data.
+ */
+export const NativeEventCode = {
+  Connect: 1,
+  Data: 2,
+  Message: 3,
+  Backpressure: 4,
+  Drain: 5,
+  Timeout: 6,
+  Close: 7,
+  Error: 8,
+  Mux: 9,
+  Rpc: 10,
+  Stream: 11,
+  Reconnecting: 12,
+  Failover: 13,
+} as const;
+export type NativeEventCode = (typeof NativeEventCode)[keyof typeof NativeEventCode];
+
+export type NativeEventCodeHandler = (
+  code: NativeEventCode,
+  data: Buffer | undefined,
+  arg?: unknown,
+  arg2?: unknown,
+) => void;
+
+// Send ring header words (Int32Array over the first 64 bytes).
+const RING_HEADER_BYTES = 64;
+const RING_HEAD = 0;
+const RING_TAIL = 1;
+const RING_CLOSED = 3;
+const RING_FRAME_HEADER_BYTES = 4;
+
+/**
+ * A single-producer ring in a SharedArrayBuffer that the lws service thread
+ * empties in its writable pass (NativeTcpClient.createSendRing()). write()
+ * is a copy into shared memory; only a write into an empty ring crosses
+ * into the addon, to schedule the pass.
+ */
+export class NativeSendRing {
+  readonly capacity: number;
+  private readonly header: Int32Array;
+  private readonly data: Uint8Array;
+  private readonly mask: number;
+
+  constructor(
+    readonly buffer: SharedArrayBuffer,
+    private readonly lengthPrefixed: boolean,
+    private readonly kick: () => void,
+  ) {
+    this.header = new Int32Array(buffer, 0, RING_HEADER_BYTES / 4);
+    this.data = new Uint8Array(buffer, RING_HEADER_BYTES);
+    this.capacity = this.data.length;
+    this.mask = this.capacity - 1;
+  }
+
+  /** False when the ring is closed or `payload` does not fit; send() it instead. */
+  write(payload: string | Uint8Array): boolean {
+    if (Atomics.load(this.header, RING_CLOSED) !== 0) return false;
+    const body = typeof payload === "string" ? Buffer.from(payload) : payload;
+    const size = body.length + (this.lengthPrefixed ? RING_FRAME_HEADER_BYTES : 0);
+    const head = Atomics.load(this.header, RING_HEAD) >>> 0;
+    const used = (head - (Atomics.load(this.header, RING_TAIL) >>> 0)) >>> 0;
+    if (size > this.capacity - used || (!this.lengthPrefixed && size === 0)) return false;
+    let at = head;
+    if (this.lengthPrefixed) {
+      const length = body.length;
+      for (const byte of [length >>> 24, length >>> 16, length >>> 8, length]) {
+        this.data[at & this.mask] = byte & 0xff;
+        at += 1;
+      }
+    }
+    const start = at & this.mask;
+    const first = Math.min(body.length, this.capacity - start);
+    this.data.set(first === body.length ? body : body.subarray(0, first), start);
+    if (first < body.length) this.data.set(body.subarray(first), 0);
+    Atomics.store(this.header, RING_HEAD, (head + size) | 0);
+    // Empty before this publish: the service thread may have nothing scheduled.
+    if (Atomics.load(this.header, RING_TAIL) >>> 0 === head) this.kick();
+    return true;
+  }
+
+  /** Bytes published and not yet taken by the service thread. */
+  pending(): number {
+    return (
+      ((Atomics.load(this.header, RING_HEAD) >>> 0) -
+        (Atomics.load(this.header, RING_TAIL) >>> 0)) >>>
+      0
+    );
+  }
+
+  get closed(): boolean {
+    return Atomics.load(this.header, RING_CLOSED) !== 0;
+  }
+}
+
 /**
  * Explicit native client. Prefers libwebsockets backend when available, falls back to libsocket.
  */
 export class NativeTcpClient implements NativeBindingClient {
   private readonly impl: NativeBindingClient;
   public readonly backend: NativeBackend;
+  private readonly pool?: NativeClientPool;
+  // rpcRequest() calls awaiting their "rpc" completion, by native id.
+  private readonly rpcCalls = new Map<
+    number,
+    { resolve: (res: NativeRpcResponse) => void; reject: (err: Error) => void }
+  >();
+  private rpcDispatching = false;
+  // sendStream(): writers waiting for "drain" (or "close") to go on.
+  private streamWaiters: Array<() => void> = [];
+  private nextStreamId = 1;
 
-  constructor(preferred?: NativeBackend) {
+  constructor(preferred?: NativeBackend, pool?: NativeClientPool) {
     logNative(`NativeTcpClient constructor called with preferred=${preferred}`);
     nativeBinding = ensureNativeBinding(preferred);
 
@@ -223,17 +1422,27 @@ export class NativeTcpClient implements NativeBindingClient {
     this.backend = nativeBinding.kind;
     logNative(`NativeTcpClient using backend: ${this.backend}`);
     this.impl = new nativeBinding.module.TcpClientWrapper();
+    if (pool && this.backend === "lws") {
+      this.pool = pool;
+    }
   }
 
-  connect(hostOrOptions: string | NativeSocketOptions, port?: number): void {
+  /**
+   * lws reports the outcome through "connect"/"error" events. libsocket also
+   * returns a promise for it; failures still arrive as events, so the promise
+   * never surfaces as an unhandled rejection.
+   */
+  connect(
+    hostOrOptions: string | NativeSocketOptions,
+    port?: number,
+  ): Promise<void> | void {
     if (typeof hostOrOptions === "string") {
       const resolvedPort = port ?? 0;
-      this.impl.connect(hostOrOptions, resolvedPort);
-      return;
+      return observeConnect(this.impl.connect(hostOrOptions, resolvedPort));
     }
 
-    const { host, port: resolvedPort } = hostOrOptions;
-    if (!host || !resolvedPort) {
+    const { host, port: resolvedPort, path: unixPath } = hostOrOptions;
+    if (!unixPath && (!host || !resolvedPort)) {
       throw new Error("connect requires host and port");
     }
 
@@ -246,14 +1455,93 @@ export class NativeTcpClient implements NativeBindingClient {
           ? (tlsOptions.enabled ?? true)
           : false;
 
+    if (unixPath) {
+      return this.connectUnix(unixPath, hostOrOptions, inferredTls);
+    }
+
     if (this.backend === "libsocket") {
       if (inferredTls) {
         throw new Error(
           "Native libsocket backend does not support TLS. Switch to the libwebsockets backend or disable preferNative.",
         );
       }
-      this.impl.connect(host, resolvedPort);
-      return;
+      if (
+        hostOrOptions.framing === "length-prefixed" ||
+        hostOrOptions.mux ||
+        hostOrOptions.websocket ||
+        hostOrOptions.seal ||
+        hostOrOptions.sequence ||
+        hostOrOptions.resumable ||
+        hostOrOptions.streaming ||
+        hostOrOptions.delta ||
+        hostOrOptions.integrity ||
+        hostOrOptions.rpc ||
+        hostOrOptions.nativeCodec
+      ) {
+        throw new Error(
+          "Native libsocket backend does not support native framing. Switch to the libwebsockets backend.",
+        );
+      }
+      if (hostOrOptions.impairment) {
+        throw new Error(
+          "Native libsocket backend does not support impairment. Switch to the libwebsockets backend.",
+        );
+      }
+      if (hostOrOptions.handshake) {
+        throw new Error(
+          "Native libsocket backend does not support native handshakes. Switch to the libwebsockets backend.",
+        );
+      }
+      if (hostOrOptions.reconnect) {
+        throw new Error(
+          "Native libsocket backend does not support native reconnect. Switch to the libwebsockets backend.",
+        );
+      }
+      const {
+        maxBackpressureBytes,
+        rxHighWaterMark,
+        connectTimeoutMs,
+        dnsCacheTtlMs,
+        happyEyeballsDelayMs,
+        interfaceName,
+        localAddress,
+        localPort,
+      } = hostOrOptions;
+      const socketOptions = hostOrOptions.socketOptions
+        ? resolveSocketTuning(hostOrOptions.socketOptions)
+        : undefined;
+      if (
+        !maxBackpressureBytes &&
+        !rxHighWaterMark &&
+        !socketOptions &&
+        connectTimeoutMs === undefined &&
+        dnsCacheTtlMs === undefined &&
+        happyEyeballsDelayMs === undefined &&
+        !interfaceName &&
+        !localAddress &&
+        !localPort
+      ) {
+        return observeConnect(this.impl.connect(host, resolvedPort));
+      }
+      return observeConnect(
+        (
+          this.impl as unknown as {
+            connect(opts: Record<string, unknown>): Promise<void> | void;
+          }
+        ).connect({
+          host,
+          port: resolvedPort,
+          maxBackpressureBytes,
+          rxHighWaterMark,
+          socketOptions,
+          connectTimeoutMs,
+          dnsCacheTtlMs,
+          happyEyeballsDelayMs,
+          interfaceName,
+          localAddress,
+          localPort,
+        }),
+      );
     }
 
     const payload: Record<string, unknown> = {
@@ -261,23 +1549,211 @@ export class NativeTcpClient implements NativeBindingClient {
       port: resolvedPort,
       useTls: inferredTls,
     };
+    if (hostOrOptions.framing) {
+      payload.framing = hostOrOptions.framing;
+    }
+    if (hostOrOptions.maxFrameLength) {
+      payload.maxFrameLength = hostOrOptions.maxFrameLength;
+    }
+    if (hostOrOptions.delivery) {
+      payload.delivery = hostOrOptions.delivery;
+    }
+    if (hostOrOptions.rxHighWaterMark) {
+      payload.rxHighWaterMark = hostOrOptions.rxHighWaterMark;
+    }
+    if (hostOrOptions.maxPendingEvents) {
+      payload.maxPendingEvents = hostOrOptions.maxPendingEvents;
+    }
+    if (hostOrOptions.maxBackpressureBytes) {
+      payload.maxBackpressureBytes = hostOrOptions.maxBackpressureBytes;
+    }
+    if (hostOrOptions.idleTimeoutMs) {
+      payload.idleTimeoutMs = hostOrOptions.idleTimeoutMs;
+    }
+    if (hostOrOptions.heartbeatIntervalMs && hostOrOptions.heartbeatPayload) {
+      payload.heartbeatIntervalMs = hostOrOptions.heartbeatIntervalMs;
+      payload.heartbeatPayload = hostOrOptions.heartbeatPayload;
+    }
+    if (hostOrOptions.socketOptions) {
+      payload.socketOptions = resolveSocketTuning(hostOrOptions.socketOptions);
+    }
+    if (hostOrOptions.zeroCopySend) {
+      payload.zeroCopySend = true;
+    }
+    if (hostOrOptions.deferWakeups) {
+      payload.deferWakeups = true;
+    }
+    if (hostOrOptions.loop) {
+      payload.loop = hostOrOptions.loop;
+    }
+    if (hostOrOptions.dnsCacheTtlMs !== undefined) {
+      payload.dnsCacheTtlMs = hostOrOptions.dnsCacheTtlMs;
+    }
+    if (hostOrOptions.interfaceName) {
+      payload.interfaceName = hostOrOptions.interfaceName;
+    }
+    if (hostOrOptions.localAddress) {
+      payload.localAddress = hostOrOptions.localAddress;
+    }
+    if (hostOrOptions.localPort) {
+      payload.localPort = hostOrOptions.localPort;
+    }
+    if (hostOrOptions.mux) {
+      payload.mux = hostOrOptions.mux;
+    }
+    if (hostOrOptions.websocket) {
+      payload.websocket = hostOrOptions.websocket;
+    }
+    if (hostOrOptions.seal) {
+      payload.seal = hostOrOptions.seal;
+    }
+    if (hostOrOptions.sequence) {
+      payload.sequence = hostOrOptions.sequence;
+    }
+    if (hostOrOptions.resumable) {
+      payload.resumable = hostOrOptions.resumable;
+    }
+    if (hostOrOptions.reconnect) {
+      payload.reconnect = hostOrOptions.reconnect;
+    }
+    if (hostOrOptions.streaming) {
+      payload.streaming = true;
+    }
+    if (hostOrOptions.delta) {
+      payload.delta = hostOrOptions.delta;
+    }
+    if (hostOrOptions.integrity) {
+      payload.integrity = true;
+    }
+    if (hostOrOptions.impairment) {
+      payload.impairment = hostOrOptions.impairment;
+    }
+    if (hostOrOptions.coalesce) {
+      payload.coalesce = hostOrOptions.coalesce;
+    }
+    if (hostOrOptions.rpc) {
+      payload.rpc = true;
+    }
+    if (hostOrOptions.nativeCodec) {
+      payload.nativeCodec = hostOrOptions.nativeCodec;
+      if (hostOrOptions.nativeDecode) payload.nativeDecode = true;
+    }
+    if (hostOrOptions.messageTypes) {
+      payload.messageTypes = hostOrOptions.messageTypes;
+    }
+    if (hostOrOptions.handshake) {
+      payload.handshake = hostOrOptions.handshake.handle;
+    }
+    if (hostOrOptions.cpuAffinity !== undefined) {
+      payload.cpuAffinity = hostOrOptions.cpuAffinity;
+    }
+    if (hostOrOptions.numaNode !== undefined) {
+      payload.numaNode = hostOrOptions.numaNode;
+    }
 
     if (inferredTls && tlsOptions) {
       Object.assign(payload, this.serializeTlsOptions(tlsOptions));
     }
 
+    if (this.pool) {
+      // Certificates live on the pool's shared context.
+      delete payload.tlsCa;
+      delete payload.tlsCert;
+      delete payload.tlsKey;
+      delete payload.tlsPassphrase;
+      delete payload.tlsKtls;
+      delete payload.tlsContext;
+      payload.pool = this.pool.acquire();
+    }
+
     (
       this.impl as unknown as { connect(opts: Record<string, unknown>): void }
     ).connect(payload);
   }
 
-  send(data: string | Buffer): void {
-    this.impl.send(data);
+  /** Unix stream sockets go through libsocket; TLS and native framing stay TCP/lws-only. */
+  private connectUnix(
+    unixPath: string,
+    options: NativeSocketOptions,
+    useTls: boolean,
+  ): Promise<void> | void {
+    if (this.backend !== "libsocket") {
+      throw new Error(
+        "Native Unix sockets require the libsocket backend. Run `pnpm run rebuild` or disable preferNative.",
+      );
+    }
+    if (useTls) {
+      throw new Error("Native Unix sockets do not support TLS.");
+    }
+    if (options.framing === "length-prefixed") {
+      throw new Error(
+        "Native libsocket backend does not support native framing. Switch to the libwebsockets backend.",
+      );
+    }
+    const { maxBackpressureBytes, rxHighWaterMark, maxPendingEvents, sharedMemory } = options;
+    return observeConnect(
+      (
+        this.impl as unknown as {
+          connect(opts: Record<string, unknown>): Promise<void> | void;
+        }
+      ).connect({
+        path: unixPath,
+        maxBackpressureBytes,
+        rxHighWaterMark,
+        maxPendingEvents,
+        sharedMemory,
+      }),
+    );
+  }
+
+  /**
+   * False once queued bytes exceed maxBackpressureBytes (lws); wait for
+   * "drain". `{ flush: true }` skips the `coalesce` hold. Other than
+   * strings and Buffers, values need `nativeCodec`.
+   */
+  send(data: NativeEncodable, options?: NativeSendOptions): boolean | void {
+    return options ? this.impl.send(data, options) : this.impl.send(data);
   }
 
-  sendMany(data: Array<string | Buffer>): number | void {
+  /**
+   * Stream a file range (path or fd) as frames whose bodies the kernel
+   * copies straight from the file (lws backend). False once above
+   * maxBackpressureBytes, like send().
+   */
+  sendFile(
+    file: string | number,
+    offset = 0,
+    length?: number,
+    options?: NativeSendFileOptions,
+  ): boolean {
+    if (typeof this.impl.sendFile !== "function") {
+      throw new Error("sendFile requires the libwebsockets backend");
+    }
+    return this.impl.sendFile(file, offset, length, options);
+  }
+
+  /**
+   * Attach a SharedArrayBuffer send ring (lws backend, before or after
+   * connect(); once per client). capacityBytes is rounded up to a power of
+   * two, 1 MiB by default. Ring frames interleave with send()'s at frame
+   * boundaries; use one or the other where order matters. Not available
+   * with websocket, mux, seal, sequence or integrity.
+   */
+  createSendRing(options: { capacityBytes?: number } = {}): NativeSendRing {
+    const { attachSendRing, kickSendRing } = this.impl;
+    if (typeof attachSendRing !== "function" || typeof kickSendRing !== "function") {
+      throw new Error("createSendRing requires the libwebsockets backend");
+    }
+    const requested = Math.max(RING_FRAME_HEADER_BYTES + 1, options.capacityBytes ?? 1 << 20);
+    const capacity = 2 ** Math.ceil(Math.log2(Math.min(requested, 2 ** 30)));
+    const buffer = new SharedArrayBuffer(RING_HEADER_BYTES + capacity);
+    const lengthPrefixed = attachSendRing.call(this.impl, new Uint8Array(buffer));
+    return new NativeSendRing(buffer, lengthPrefixed, () => kickSendRing.call(this.impl));
+  }
+
+  sendMany(data: NativeEncodable[], options?: NativeSendOptions): number | void {
     if (typeof this.impl.sendMany === "function") {
-      return this.impl.sendMany(data);
+      return options ? this.impl.sendMany(data, options) : this.impl.sendMany(data);
     }
     for (const chunk of data) {
       this.impl.send(chunk);
@@ -285,10 +1761,36 @@ export class NativeTcpClient implements NativeBindingClient {
     return data.length;
   }
 
+  /**
+   * One gathered write of every chunk (libsocket: a single sendmsg over the
+   * chunks' own memory). False once queued bytes exceed maxBackpressureBytes.
+   */
+  sendv(data: Array<string | Buffer>): boolean {
+    if (typeof this.impl.sendv === "function") {
+      return this.impl.sendv(data);
+    }
+    const accepted = this.sendMany(data);
+    return typeof accepted !== "number" || accepted === data.length;
+  }
+
   recv(length?: number): Buffer {
     return this.impl.recv(length);
   }
 
+  /**
+   * Copies buffered bytes into `buffer` from `offset` and returns the count,
+   * so a reused buffer makes pull-mode reads allocation-free. Older bindings
+   * fall back to recv() plus a copy.
+   */
+  recvInto(buffer: Buffer, offset = 0): number {
+    if (typeof this.impl.recvInto === "function") {
+      return this.impl.recvInto(buffer, offset);
+    }
+    if (offset >= buffer.length) return 0;
+    const data = this.impl.recv(buffer.length - offset);
+    return data.copy(buffer, offset);
+  }
+
   isConnected(): boolean {
     if (typeof this.impl.isConnected === "function") {
       return this.impl.isConnected();
@@ -300,25 +1802,175 @@ export class NativeTcpClient implements NativeBindingClient {
     handler: (evt: {
       type: string;
       data?: Buffer;
+      /** nativeDecode: the "message" frame, decoded. */
+      value?: unknown;
       error?: string;
       hadError?: boolean;
-    }) => void,
+      queuedBytes?: number;
+      threshold?: number;
+      /** "reconnecting" and "failover": the endpoint connecting next. */
+      attempt?: number;
+      delayMs?: number;
+      endpoint?: number;
+      host?: string;
+      port?: number;
+    } & NativeMuxEvent & NativeRpcEvent & Partial<NativeStreamChunk>) => void,
   ): void {
-    if (typeof this.impl.setEventHandler === "function") {
+    if (typeof this.impl.setEventHandler !== "function") return;
+    if (typeof this.impl.rpcRequest !== "function") {
       this.impl.setEventHandler(handler);
+      return;
     }
+    this.rpcDispatching = true;
+    this.impl.setEventHandler(evt => {
+      if (evt.type === "rpc") {
+        this.settleRpc(evt.responses);
+        return;
+      }
+      if (evt.type === "close") this.failRpc("Connection closed");
+      // Responses cannot come back over a connection that was replaced.
+      if (evt.type === "reconnecting" || evt.type === "failover") {
+        this.failRpc("Connection dropped");
+      }
+      if (evt.type === "drain" || evt.type === "close") this.releaseStreamWaiters();
+      if (evt.type === "stream" && evt.data) {
+        // streaming: "stream" events carry the chunk header in data.
+        handler({ type: "stream", ...decodeStreamChunk(evt.data) });
+        return;
+      }
+      handler(evt);
+    });
   }
 
   supportsEventStream(): boolean {
     return typeof this.impl.setEventHandler === "function";
   }
 
+  /**
+   * Events as (code, data, arg) calls, with no event object or type string
+   * per delivery (lws backend). False when the backend only has the object
+   * form; use setEventHandler() then.
+   */
+  setEventCodeHandler(handler: NativeEventCodeHandler): boolean {
+    if (typeof this.impl.setEventCodeHandler !== "function") return false;
+    if (typeof this.impl.rpcRequest !== "function") {
+      this.impl.setEventCodeHandler(handler);
+      return true;
+    }
+    this.rpcDispatching = true;
+    this.impl.setEventCodeHandler((code, data, arg, arg2) => {
+      if (code === NativeEventCode.Rpc) {
+        this.settleRpc((arg as NativeRpcEvent | undefined)?.responses);
+        return;
+      }
+      if (code === NativeEventCode.Close) this.failRpc("Connection closed");
+      if (code === NativeEventCode.Reconnecting || code === NativeEventCode.Failover) {
+        this.failRpc("Connection dropped");
+      }
+      if (code === NativeEventCode.Drain || code === NativeEventCode.Close) {
+        this.releaseStreamWaiters();
+      }
+      if (code === NativeEventCode.Stream && data) {
+        const chunk = decodeStreamChunk(data);
+        handler(code, chunk.data, chunk);
+        return;
+      }
+      handler(code, data, arg, arg2);
+    });
+    return true;
+  }
+
+  /**
+   * Send a message of any size as ordered chunks of at most `chunkBytes`
+   * on a connection opened with `streaming` (lws backend). The peer gets a
+   * "stream" event per chunk rather than one frame, so neither side holds
+   * the whole message; a false send() result waits for "drain" before the
+   * next chunk. Resolves with the stream id once the last chunk is queued.
+   */
+  async sendStream(
+    source: NativeStreamSource,
+    options: NativeStreamSendOptions = {},
+  ): Promise<number> {
+    const sendChunk = this.impl.sendStreamChunk?.bind(this.impl);
+    if (!sendChunk) {
+      throw new Error("Native streaming requires the libwebsockets backend");
+    }
+    if (!this.rpcDispatching) {
+      // "drain" needs the event stream even when nothing else listens.
+      this.setEventHandler(() => undefined);
+    }
+    const streamId = this.nextStreamId;
+    this.nextStreamId = this.nextStreamId >= 0xffffffff ? 1 : this.nextStreamId + 1;
+    await pumpStreamChunks(
+      source,
+      options.chunkBytes ?? DEFAULT_STREAM_CHUNK_BYTES,
+      (data, bits) => sendChunk(streamId, data, bits),
+      () => new Promise(resolve => this.streamWaiters.push(resolve)),
+    );
+    return streamId;
+  }
+
+  private releaseStreamWaiters() {
+    if (this.streamWaiters.length === 0) return;
+    const waiters = this.streamWaiters;
+    this.streamWaiters = [];
+    for (const resolve of waiters) resolve();
+  }
+
+  /**
+   * One request over a connection opened with `rpc` (lws backend): the id,
+   * deadline and response matching live on the service thread, so there
+   * is no per-call timer or id string here. Resolves with the peer's
+   * status and body; rejects on timeout (0 waits indefinitely) or close.
+   */
+  rpcRequest(payload: Buffer | string, timeoutMs = 5000): Promise<NativeRpcResponse> {
+    if (typeof this.impl.rpcRequest !== "function") {
+      return Promise.reject(new Error("Native rpc requires the libwebsockets backend"));
+    }
+    if (!this.rpcDispatching) {
+      // Completions need the event stream even when nothing else listens.
+      this.setEventHandler(() => undefined);
+    }
+    let id: number;
+    try {
+      id = this.impl.rpcRequest(payload, timeoutMs);
+    } catch (err) {
+      return Promise.reject(err as Error);
+    }
+    return new Promise((resolve, reject) => {
+      this.rpcCalls.set(id, { resolve, reject });
+    });
+  }
+
+  private settleRpc(responses: NativeRpcResponse[] | undefined) {
+    for (const response of responses ?? []) {
+      const call = this.rpcCalls.get(response.id);
+      if (!call) continue;
+      this.rpcCalls.delete(response.id);
+      if (response.status === 0) {
+        call.reject(new Error("RPC request timed out"));
+      } else {
+        call.resolve(response);
+      }
+    }
+  }
+
+  private failRpc(reason: string) {
+    if (this.rpcCalls.size === 0) return;
+    const calls = [...this.rpcCalls.values()];
+    this.rpcCalls.clear();
+    for (const call of calls) call.reject(new Error(reason));
+  }
+
   getTlsInfo():
     | {
         alpnProtocol?: string;
         protocol?: string;
         cipher?: string;
         authorized?: boolean;
+        sessionReused?: boolean;
+        ktlsSend?: boolean;
+        ktlsRecv?: boolean;
         peerFingerprint?: string;
         peerFingerprint256?: string;
       }
@@ -340,19 +1992,163 @@ export class NativeTcpClient implements NativeBindingClient {
     return undefined;
   }
 
+  /** Adjust lws write budget / service timeout live; undefined on libsocket. */
+  setTuning(tuning: NativeLwsTuning): NativeLwsTuning | undefined {
+    if (typeof this.impl.setTuning === "function") {
+      return this.impl.setTuning(tuning);
+    }
+    return undefined;
+  }
+
+  /**
+   * Bounds for service-thread slice/rate control (null turns it off);
+   * undefined on libsocket.
+   */
+  setFlowPolicy(
+    policy: NativeFlowPolicy | null,
+  ): NativeFlowDiagnostics | null | undefined {
+    if (typeof this.impl.setFlowPolicy === "function") {
+      return this.impl.setFlowPolicy(policy);
+    }
+    return undefined;
+  }
+
+  /** Native flow control state; null while off, undefined on libsocket. */
+  getFlowDiagnostics(): NativeFlowDiagnostics | null | undefined {
+    if (typeof this.impl.getFlowDiagnostics === "function") {
+      return this.impl.getFlowDiagnostics();
+    }
+    return undefined;
+  }
+
+  /** Service-loop wakeup rates since the previous call; undefined on libsocket. */
+  getServiceStats(): NativeServiceStats | undefined {
+    if (typeof this.impl.getServiceStats === "function") {
+      return this.impl.getServiceStats();
+    }
+    return undefined;
+  }
+
+  /** Latency/size histograms of the lws transport; undefined on libsocket. */
+  getStats(): NativeClientTransportStats | undefined {
+    if (typeof this.impl.getStats === "function") {
+      return this.impl.getStats();
+    }
+    return undefined;
+  }
+
+  /** Open a stream when connected with `mux`; undefined at `maxStreams`. */
+  muxOpen(): number | undefined {
+    if (typeof this.impl.muxOpen !== "function") {
+      throw new Error("Native mux requires the libwebsockets backend");
+    }
+    return this.impl.muxOpen();
+  }
+
+  /**
+   * Frame `data` onto a mux stream natively. False when the stream is not
+   * open, is out of the peer's credit (see `resumed` in the mux event) or
+   * the send queue is past maxBackpressureBytes.
+   */
+  muxWrite(streamId: number, data: Buffer): boolean {
+    if (typeof this.impl.muxWrite !== "function") {
+      throw new Error("Native mux requires the libwebsockets backend");
+    }
+    return this.impl.muxWrite(streamId, data);
+  }
+
+  muxClose(streamId: number, reset = false): boolean {
+    return this.impl.muxClose?.(streamId, reset) ?? false;
+  }
+
+  /**
+   * Install the `seal` key: 32 bytes, or the Base64 string deriveSharedSecret()
+   * returns. Frames sent after this call are sealed; one key per connection.
+   */
+  setSessionKey(key: Uint8Array | string): void {
+    if (typeof this.impl.setSessionKey !== "function") {
+      throw new Error("Native seal requires the libwebsockets backend");
+    }
+    this.impl.setSessionKey(toSessionKey(key));
+  }
+
+  /**
+   * Move the `seal` stage to the next key, derived natively from the current
+   * one. Takes effect from the next frame sent; nothing queued is drained.
+   */
+  rekey(): void {
+    if (typeof this.impl.rekey !== "function") {
+      throw new Error("Native seal requires the libwebsockets backend");
+    }
+    this.impl.rekey();
+  }
+
+  /**
+   * Enforce the idle timeout on the service thread: a "timeout" event, then
+   * close. False when the backend has no native timer (libsocket).
+   */
+  setIdleTimeout(ms: number): boolean {
+    if (typeof this.impl.setIdleTimeout !== "function") return false;
+    this.impl.setIdleTimeout(ms);
+    return true;
+  }
+
+  /** Whether idleTimeoutMs/setIdleTimeout() run natively. */
+  supportsNativeIdleTimeout(): boolean {
+    return typeof this.impl.setIdleTimeout === "function";
+  }
+
+  /** Effective `socketOptions` once the socket is open; undefined without them. */
+  getSocketOptions(): NativeSocketTuningReport | undefined {
+    if (typeof this.impl.getSocketOptions === "function") {
+      return this.impl.getSocketOptions();
+    }
+    return undefined;
+  }
+
+  /** DNS, TCP and TLS timings of the latest connect; undefined until resolved. */
+  getConnectTimings(): NativeConnectTimings | undefined {
+    if (typeof this.impl.getConnectTimings === "function") {
+      return this.impl.getConnectTimings();
+    }
+    return undefined;
+  }
+
+  /**
+   * The latest TCP_INFO reading of the connection (lws, Linux), refreshed
+   * by the service thread every 50 ms while it writes or reads.
+   */
+  getPathSample(): NativeTcpPathStats | undefined {
+    if (typeof this.impl.getPathSample === "function") {
+      return this.impl.getPathSample();
+    }
+    return undefined;
+  }
+
   close(): void {
     this.impl.close();
+    this.failRpc("Client closed");
   }
 
   private serializeTlsOptions(tls: QWTlsOptions): Record<string, unknown> {
     const result: Record<string, unknown> = {};
-    const ca = normalizeTlsBuffer(tls.ca);
-    const cert = normalizeTlsBuffer(tls.cert);
-    const key = normalizeTlsBuffer(tls.key);
     const alpn = serializeAlpn(tls.alpnProtocols);
-    if (ca) result.tlsCa = ca;
-    if (cert) result.tlsCert = cert;
-    if (key) result.tlsKey = key;
+    if (tls.context) {
+      result.tlsContext = tls.context.handle;
+    } else {
+      const ca = normalizeTlsBuffer(tls.ca);
+      const cert = normalizeTlsBuffer(tls.cert);
+      const key = normalizeTlsBuffer(tls.key);
+      if (ca) result.tlsCa = ca;
+      if (cert) result.tlsCert = cert;
+      if (key) result.tlsKey = key;
+      if (tls.passphrase) {
+        result.tlsPassphrase = tls.passphrase;
+      }
+      if (tls.ktls) {
+        result.tlsKtls = true;
+      }
+    }
     if (alpn) result.tlsAlpn = alpn;
     if (tls.servername) result.tlsServername = tls.servername;
     if (typeof tls.rejectUnauthorized === "boolean") {
@@ -361,8 +2157,8 @@ export class NativeTcpClient implements NativeBindingClient {
     if (typeof tls.requestCert === "boolean") {
       result.tlsRequestCert = tls.requestCert;
     }
-    if (tls.passphrase) {
-      result.tlsPassphrase = tls.passphrase;
+    if (typeof tls.sessionCache === "boolean") {
+      result.tlsSessionCache = tls.sessionCache;
     }
     return result;
   }
@@ -12,8 +12,26 @@
 import net from "node:net";
 import { TypedEventEmitter } from "../utils/typedEmitter";
 import type { QWormholeSocketLike } from "../types/types";
+import {
+  createNativeFrameRing,
+  createNativeFrameSplitter,
+  type NativeFrameRing,
+  type NativeFrameSplitter,
+} from "./NativeTCPClient";
 
 const HEADER_LENGTH = 4;
+
+/**
+ * The descriptor a plain TCP socket writes through, when nothing is queued
+ * in front of it. TLS sockets and wrapped transports have none usable.
+ */
+const directDescriptor = (socket: net.Socket): number | undefined => {
+  if (process.platform === "win32") return undefined;
+  if ((socket as net.Socket & { encrypted?: boolean }).encrypted) return undefined;
+  if ((socket.writableLength ?? 0) > 0) return undefined;
+  const fd = (socket as unknown as { _handle?: { fd?: number } })._handle?.fd;
+  return typeof fd === "number" && fd >= 0 ? fd : undefined;
+};
 const DEFAULT_MAX_FRAME_LENGTH = 4 * 1024 * 1024; // 4 MiB
 const ENV_BATCH_SIZE = process.env.QW_WRITEV_BATCH_SIZE
   ? Number(process.env.QW_WRITEV_BATCH_SIZE)
@@ -82,6 +100,14 @@ export interface BatchFramerOptions {
   maxBytesPerFlush?: number;
   /** Optional flush handler for non-socket transports */
   flushHandler?: (buffers: Buffer[]) => number;
+  /** Parse incoming frames with the native FrameSplitter when loaded (default: true) */
+  preferNative?: boolean;
+  /**
+   * Queue outgoing frames in a native slab and flush them with one
+   * sendmsg() on the socket's descriptor (default: false). Needs the lws
+   * addon and a plain TCP socket; otherwise the JS ring is used.
+   */
+  nativeRing?: boolean | { capacityBytes?: number };
 }
 
 /**
@@ -108,8 +134,15 @@ export class BatchFramer extends TypedEventEmitter<BatchFramerEvents> {
   private readonly ring: RingSlot[];
   private ringHead = 0;
 
-  // Incoming data buffer
+  // Incoming data buffer, or the native splitter holding it instead
   private inBuffer: Buffer = Buffer.alloc(0);
+  private readonly splitter: NativeFrameSplitter | null;
+
+  // Native send queue (nativeRing). Only used while outBatch is empty, so
+  // its frames are always older than any queued in JS.
+  private readonly nativeRing: NativeFrameRing | null;
+  private nativePendingFrames = 0;
+  private nativePendingBytes = 0;
 
   // Outgoing batch queue
   private outBatch: Buffer[] = [];
@@ -190,6 +223,15 @@ export class BatchFramer extends TypedEventEmitter<BatchFramerEvents> {
     this.maxBytesPerFlush =
       options?.maxBytesPerFlush ?? DEFAULT_MAX_BYTES_PER_FLUSH;
     this.flushHandler = options?.flushHandler;
+    this.splitter =
+      options?.preferNative === false
+        ? null
+        : createNativeFrameSplitter({ maxFrameLength: this.maxFrameLength });
+    this.nativeRing = options?.nativeRing
+      ? createNativeFrameRing(
+          typeof options.nativeRing === "object" ? options.nativeRing : undefined,
+        )
+      : null;
 
     // Initialize ring buffer
     const ringSize = options?.ringSize ?? DEFAULT_RING_SIZE;
@@ -293,14 +335,22 @@ export class BatchFramer extends TypedEventEmitter<BatchFramerEvents> {
    * Encode payload and add to batch queue
    */
   encodeToBatch(payload: Buffer): void {
+    if (this.nativeRing && this.appendNative(this.nativeRing, payload)) {
+      this.totalFrames += 1;
+      this.schedulePendingFlush(this.nativePendingFrames);
+      return;
+    }
     const framed = this.encode(payload);
     this.outBatch.push(framed);
     this.outBatchBytes += framed.length;
     this.totalFrames += 1;
     this.maxPendingFrames = Math.max(this.maxPendingFrames, this.outBatch.length);
     this.maxPendingBytes = Math.max(this.maxPendingBytes, this.outBatchBytes);
+    this.schedulePendingFlush(this.outBatch.length);
+  }
 
-    if (this.outBatch.length >= this.batchSize) {
+  private schedulePendingFlush(pendingFrames: number): void {
+    if (pendingFrames >= this.batchSize) {
       void this.flushBatch();
     } else if (!this.flushTimer && this.flushIntervalMs > 0) {
       this.flushTimer = setTimeout(() => {
@@ -310,13 +360,92 @@ export class BatchFramer extends TypedEventEmitter<BatchFramerEvents> {
     }
   }
 
+  /**
+   * Frame `payload` into the native ring, flushing it once to make room.
+   * False sends the frame down the JS path, after anything the ring still
+   * holds has been moved there ahead of it.
+   */
+  private appendNative(ring: NativeFrameRing, payload: Buffer): boolean {
+    if (this.flushHandler || this.outBatch.length > 0) {
+      this.spillNative(ring);
+      return false;
+    }
+    if (!ring.append(payload)) {
+      this.overflowAllocations += 1;
+      this.overflowAllocatedBytes += HEADER_LENGTH + payload.length;
+      if (this.nativePendingBytes > 0 && !this.draining) {
+        this.flushNative(ring)?.catch(err =>
+          this.emit("error", err instanceof Error ? err : new Error(String(err))),
+        );
+      }
+      if (this.nativePendingBytes > 0 || !ring.append(payload)) {
+        this.spillNative(ring);
+        return false;
+      }
+    }
+    this.nativePendingFrames += 1;
+    this.nativePendingBytes += HEADER_LENGTH + payload.length;
+    this.maxPendingFrames = Math.max(this.maxPendingFrames, this.nativePendingFrames);
+    this.maxPendingBytes = Math.max(this.maxPendingBytes, this.nativePendingBytes);
+    return true;
+  }
+
+  /** Move the ring's frames to the front of the JS batch, as one copy. */
+  private spillNative(ring: NativeFrameRing): void {
+    if (this.nativePendingBytes === 0) return;
+    const queued = ring.take();
+    this.copyAllocations += 1;
+    this.copyAllocatedBytes += queued.length;
+    this.outBatch.unshift(queued);
+    this.outBatchBytes += queued.length;
+    this.nativePendingFrames = 0;
+    this.nativePendingBytes = 0;
+  }
+
+  /**
+   * Send the ring with one sendmsg() when the socket's own queue is empty.
+   * Whatever the kernel does not take, or everything when the socket cannot
+   * be written directly, is handed to socket.write() so ordering holds.
+   */
+  private flushNative(ring: NativeFrameRing): Promise<void> | undefined {
+    const socket = this.socket;
+    const frames = this.nativePendingFrames;
+    const bytes = this.nativePendingBytes;
+    if (!socket || socket.destroyed) {
+      ring.clear();
+      this.nativePendingFrames = 0;
+      this.nativePendingBytes = 0;
+      return undefined;
+    }
+
+    this.emit("flush", { bufferCount: frames, totalBytes: bytes });
+    this.totalFlushes += 1;
+    this.totalBytes += bytes;
+    this.lastFlushTimestamp = Date.now();
+
+    const fd = this.draining ? undefined : directDescriptor(socket);
+    const written = fd === undefined ? 0 : ring.flush(fd);
+    if (written === bytes) {
+      this.nativePendingFrames = 0;
+      this.nativePendingBytes = 0;
+      return undefined;
+    }
+    // A failed descriptor is left for socket.write() to report.
+    const rest = ring.take();
+    this.copyAllocations += 1;
+    this.copyAllocatedBytes += rest.length;
+    this.nativePendingFrames = 0;
+    this.nativePendingBytes = 0;
+    return this.writeBuffer(rest);
+  }
+
   /**
    * Flush the current batch to the socket
    */
   async flushBatch(): Promise<void> {
     this.clearFlushTimer();
 
-    if (this.outBatch.length === 0) {
+    if (this.outBatch.length === 0 && this.nativePendingBytes === 0) {
       return;
     }
     if (this.draining) {
@@ -328,6 +457,12 @@ export class BatchFramer extends TypedEventEmitter<BatchFramerEvents> {
       return;
     }
 
+    // The ring only fills while outBatch is empty, so this is the whole batch.
+    if (this.nativeRing && this.nativePendingBytes > 0) {
+      await this.flushNative(this.nativeRing);
+      return;
+    }
+
     const buffers = this.outBatch;
     const totalBytes = this.outBatchBytes;
     const slotIndices = this.outBatchSlotIndices;
@@ -600,6 +735,10 @@ export class BatchFramer extends TypedEventEmitter<BatchFramerEvents> {
    * Push incoming data for parsing
    */
   push(chunk: Buffer): void {
+    if (this.splitter) {
+      this.pushNative(this.splitter, chunk);
+      return;
+    }
     if (this.inBuffer.length === 0) {
       this.inBuffer = chunk;
     } else {
@@ -634,14 +773,37 @@ export class BatchFramer extends TypedEventEmitter<BatchFramerEvents> {
     }
   }
 
+  private pushNative(splitter: NativeFrameSplitter, chunk: Buffer): void {
+    this.maxInBufferBytes = Math.max(
+      this.maxInBufferBytes,
+      splitter.buffered() + chunk.length,
+    );
+    const { frames, oversized } = splitter.push(chunk);
+    for (const frame of frames) {
+      this.emit("message", frame);
+    }
+    if (oversized !== undefined) {
+      this.emit(
+        "error",
+        new Error(
+          `Frame length ${oversized} exceeds limit ${this.maxFrameLength}`,
+        ),
+      );
+    }
+  }
+
   /**
    * Reset the framer state
    */
   reset(): void {
     this.inBuffer = Buffer.alloc(0);
+    this.splitter?.reset();
     this.outBatch = [];
     this.outBatchBytes = 0;
     this.outBatchSlotIndices = [];
+    this.nativeRing?.clear();
+    this.nativePendingFrames = 0;
+    this.nativePendingBytes = 0;
     this.clearFlushTimer();
     for (const slot of this.ring) {
       slot.inUse = false;
@@ -665,8 +827,8 @@ export class BatchFramer extends TypedEventEmitter<BatchFramerEvents> {
       totalFrames: this.totalFrames,
       totalFlushes: this.totalFlushes,
       totalBytes: this.totalBytes,
-      pendingFrames: this.outBatch.length,
-      pendingBytes: this.outBatchBytes,
+      pendingFrames: this.outBatch.length + this.nativePendingFrames,
+      pendingBytes: this.outBatchBytes + this.nativePendingBytes,
       maxPendingFrames: this.maxPendingFrames,
       maxPendingBytes: this.maxPendingBytes,
       maxInBufferBytes: this.maxInBufferBytes,
@@ -694,8 +856,8 @@ export class BatchFramer extends TypedEventEmitter<BatchFramerEvents> {
     this.backpressureEvents = 0;
     this.lastBackpressureBytes = undefined;
     this.lastBackpressureTimestamp = undefined;
-    this.maxPendingFrames = this.outBatch.length;
-    this.maxPendingBytes = this.outBatchBytes;
+    this.maxPendingFrames = this.outBatch.length + this.nativePendingFrames;
+    this.maxPendingBytes = this.outBatchBytes + this.nativePendingBytes;
     this.maxInBufferBytes = this.inBuffer.length;
     this.ringMaxInUse = this.ringInUse;
     this.ringResizeCount = 0;
@@ -719,7 +881,7 @@ export class BatchFramer extends TypedEventEmitter<BatchFramerEvents> {
    * Get current batch size
    */
   get pendingBatchSize(): number {
-    return this.outBatch.length;
+    return this.outBatch.length + this.nativePendingFrames;
   }
 
   /**
@@ -0,0 +1,483 @@
+import { randomBytes } from "node:crypto";
+import { TypedEventEmitter } from "../utils/typedEmitter";
+import type {
+  NativeTcpPathStats,
+  QWormholeServerConnection,
+} from "../types/types";
+import {
+  NativeTcpClient,
+  createNativeBundleReorder,
+  type NativeBundleReorder,
+  type NativeBundleReorderOptions,
+  type NativeBundleReorderStats,
+} from "./NativeTCPClient";
+
+// The first frame on every member connection introduces it:
+// "QWB1", 16-byte bundle id, u16 member index, u16 member count.
+// Every later frame is a u64 bundle sequence number and the payload.
+const HELLO_MAGIC = 0x51574231;
+const HELLO_BYTES = 24;
+const SEQ_BYTES = 8;
+const TWO_32 = 2 ** 32;
+// A path never drops below this share of the fastest one, so a path that
+// was starved keeps sending enough to be measured again.
+const MIN_RELATIVE_WEIGHT = 0.05;
+
+export type ConnectionBundlePath = {
+  /** Defaults to the bundle's host and port. */
+  host?: string;
+  port?: number;
+  interfaceName?: string;
+  localAddress?: string;
+  localPort?: number;
+};
+
+export type ConnectionBundleOptions = {
+  host: string;
+  port: number;
+  /** One member connection per entry; two on the default route if omitted. */
+  paths?: ConnectionBundlePath[];
+  /** How often TCP_INFO re-weights the paths (default 250 ms). */
+  weightIntervalMs?: number;
+  maxBackpressureBytes?: number;
+  connectTimeoutMs?: number;
+};
+
+export type ConnectionBundlePathStats = ConnectionBundlePath & {
+  index: number;
+  open: boolean;
+  backpressured: boolean;
+  /** Share of new frames this path currently gets, 0 to 1. */
+  share: number;
+  framesSent: number;
+  bytesSent: number;
+  tcp?: NativeTcpPathStats;
+};
+
+type ConnectionBundleEvents = {
+  connect: void;
+  /** Unordered: whatever the receiver sends back on any member. */
+  message: Buffer;
+  /** Every open path is below maxBackpressureBytes again. */
+  drain: void;
+  /** A member connection went away; frames it had in flight are lost. */
+  pathClose: { index: number; hadError: boolean };
+  close: void;
+  error: Error;
+};
+
+type BundlePath = {
+  index: number;
+  config: ConnectionBundlePath;
+  client: NativeTcpClient;
+  open: boolean;
+  backpressured: boolean;
+  weight: number;
+  /** Virtual finish time: bytes assigned divided by weight. */
+  vtime: number;
+  framesSent: number;
+  bytesSent: number;
+};
+
+/**
+ * Sender side of a multipath bundle: K native lws connections, each
+ * optionally bound to its own interface, carrying one ordered stream.
+ * Frames are striped by weighted fair queueing on path capacity from
+ * TCP_INFO (cwnd * mss / srtt, or the delivery rate when higher), so bulk
+ * throughput can grow past one flow's window. The receiver puts them back
+ * in order with a ConnectionBundleAcceptor.
+ */
+export class ConnectionBundle extends TypedEventEmitter<ConnectionBundleEvents> {
+  readonly id = randomBytes(16);
+  private readonly paths: BundlePath[];
+  private readonly options: ConnectionBundleOptions;
+  private nextSeq = 0;
+  private weightTimer?: NodeJS.Timeout;
+  private closed = false;
+
+  constructor(options: ConnectionBundleOptions) {
+    super();
+    this.options = options;
+    const configs = options.paths?.length ? options.paths : [{}, {}];
+    this.paths = configs.map((config, index) => {
+      const client = new NativeTcpClient("lws");
+      if (client.backend !== "lws") {
+        throw new Error("ConnectionBundle requires the libwebsockets backend");
+      }
+      return {
+        index,
+        config,
+        client,
+        open: false,
+        backpressured: false,
+        weight: 1,
+        vtime: 0,
+        framesSent: 0,
+        bytesSent: 0,
+      };
+    });
+  }
+
+  /** Resolves once every member is connected and introduced. */
+  connect(): Promise<void> {
+    return new Promise((resolve, reject) => {
+      let pending = this.paths.length;
+      let settled = false;
+      const fail = (err: Error) => {
+        if (settled) return;
+        settled = true;
+        this.close();
+        reject(err);
+      };
+      for (const path of this.paths) {
+        path.client.setEventHandler(evt => {
+          switch (evt.type) {
+            case "connect":
+              path.open = true;
+              path.client.send(this.hello(path.index));
+              pending -= 1;
+              if (pending === 0 && !settled) {
+                settled = true;
+                this.weightTimer = setInterval(
+                  () => this.reweight(),
+                  this.options.weightIntervalMs ?? 250,
+                );
+                this.weightTimer.unref?.();
+                this.emit("connect");
+                resolve();
+              }
+              break;
+            case "message":
+            case "data":
+              if (evt.data) this.emit("message", evt.data);
+              break;
+            case "backpressure":
+              path.backpressured = true;
+              break;
+            case "drain":
+              path.backpressured = false;
+              if (this.paths.every(p => !p.open || !p.backpressured)) this.emit("drain");
+              break;
+            case "error":
+              if (!settled) fail(new Error(evt.error ?? "Bundle path failed to connect"));
+              else this.emit("error", new Error(evt.error ?? "Bundle path error"));
+              break;
+            case "close":
+              if (!settled) fail(new Error("Bundle path closed before connecting"));
+              this.onPathClose(path, Boolean(evt.hadError));
+              break;
+            default:
+              break;
+          }
+        });
+        try {
+          path.client.connect({
+            host: path.config.host ?? this.options.host,
+            port: path.config.port ?? this.options.port,
+            interfaceName: path.config.interfaceName,
+            localAddress: path.config.localAddress,
+            localPort: path.config.localPort,
+            framing: "length-prefixed",
+            delivery: "events",
+            connectTimeoutMs: this.options.connectTimeoutMs,
+            maxBackpressureBytes: this.options.maxBackpressureBytes,
+          });
+        } catch (err) {
+          fail(err instanceof Error ? err : new Error(String(err)));
+          return;
+        }
+      }
+    });
+  }
+
+  /**
+   * Queues one frame on the path that would finish it first. False when
+   * every open path is over maxBackpressureBytes; wait for "drain".
+   */
+  send(data: Buffer | string): boolean {
+    const payload = typeof data === "string" ? Buffer.from(data) : data;
+    let best: BundlePath | undefined;
+    let bestReady: BundlePath | undefined;
+    for (const path of this.paths) {
+      if (!path.open) continue;
+      if (!best || path.vtime < best.vtime) best = path;
+      if (!path.backpressured && (!bestReady || path.vtime < bestReady.vtime)) {
+        bestReady = path;
+      }
+    }
+    const path = bestReady ?? best;
+    if (!path) throw new Error("Connection bundle has no open paths");
+    const seq = this.nextSeq++;
+    const frame = Buffer.allocUnsafe(SEQ_BYTES + payload.length);
+    frame.writeUInt32BE(Math.floor(seq / TWO_32), 0);
+    frame.writeUInt32BE(seq >>> 0, 4);
+    payload.copy(frame, SEQ_BYTES);
+    path.vtime += frame.length / path.weight;
+    path.framesSent += 1;
+    path.bytesSent += frame.length;
+    if (path.client.send(frame) === false) path.backpressured = true;
+    return bestReady !== undefined && !path.backpressured;
+  }
+
+  stats(): ConnectionBundlePathStats[] {
+    const total = this.paths.reduce((sum, p) => sum + (p.open ? p.weight : 0), 0);
+    return this.paths.map(path => ({
+      ...path.config,
+      index: path.index,
+      open: path.open,
+      backpressured: path.backpressured,
+      share: path.open && total > 0 ? path.weight / total : 0,
+      framesSent: path.framesSent,
+      bytesSent: path.bytesSent,
+      tcp: path.client.getPathSample(),
+    }));
+  }
+
+  close(): void {
+    if (this.closed) return;
+    this.closed = true;
+    clearInterval(this.weightTimer);
+    for (const path of this.paths) {
+      path.open = false;
+      path.client.close();
+    }
+    this.emit("close");
+  }
+
+  private hello(index: number): Buffer {
+    const hello = Buffer.alloc(HELLO_BYTES);
+    hello.writeUInt32BE(HELLO_MAGIC, 0);
+    this.id.copy(hello, 4);
+    hello.writeUInt16BE(index, 20);
+    hello.writeUInt16BE(this.paths.length, 22);
+    return hello;
+  }
+
+  private reweight() {
+    const capacities = this.paths.map(path => {
+      const tcp = path.open ? path.client.getPathSample() : undefined;
+      if (!tcp || tcp.rttUs <= 0) return 0;
+      return Math.max((tcp.cwnd * tcp.mss * 1e6) / tcp.rttUs, tcp.deliveryRate);
+    });
+    const fastest = Math.max(...capacities);
+    if (fastest <= 0) return;
+    const floorVtime = Math.min(...this.paths.filter(p => p.open).map(p => p.vtime));
+    this.paths.forEach((path, i) => {
+      path.weight = Math.max(capacities[i] / fastest, MIN_RELATIVE_WEIGHT);
+      // Keep virtual times small and comparable across the new weights.
+      if (Number.isFinite(floorVtime)) path.vtime = Math.max(0, path.vtime - floorVtime);
+    });
+  }
+
+  private onPathClose(path: BundlePath, hadError: boolean) {
+    if (!path.open) return;
+    path.open = false;
+    if (this.closed) return;
+    this.emit("pathClose", { index: path.index, hadError });
+    if (this.paths.every(p => !p.open)) this.close();
+  }
+}
+
+/** The JS side of BundleReorder when the addon is not loaded. */
+class JsBundleReorder implements NativeBundleReorder {
+  private readonly held = new Map<number, Buffer>();
+  private readonly maxHeldFrames: number;
+  private readonly maxHeldBytes: number;
+  private next = 0;
+  private heldBytes = 0;
+  private delivered = 0;
+  private reordered = 0;
+  private duplicates = 0;
+  private gaps = 0;
+
+  constructor(opts: NativeBundleReorderOptions = {}) {
+    this.maxHeldFrames = Math.max(1, opts.maxHeldFrames ?? 4096);
+    this.maxHeldBytes = Math.max(1, opts.maxHeldBytes ?? 64 * 1024 * 1024);
+  }
+
+  push(seq: number, data: Buffer): Buffer[] {
+    if (seq < this.next || this.held.has(seq)) {
+      this.duplicates += 1;
+      return [];
+    }
+    if (seq === this.next) {
+      const out = [data];
+      this.next += 1;
+      this.delivered += 1;
+      this.release(out, false);
+      return out;
+    }
+    this.reordered += 1;
+    this.held.set(seq, data);
+    this.heldBytes += data.length;
+    const out: Buffer[] = [];
+    if (this.held.size > this.maxHeldFrames || this.heldBytes > this.maxHeldBytes) {
+      this.release(out, true);
+    }
+    return out;
+  }
+
+  flush(): Buffer[] {
+    const out: Buffer[] = [];
+    this.release(out, true);
+    return out;
+  }
+
+  stats(): NativeBundleReorderStats {
+    return {
+      nextSeq: this.next,
+      held: this.held.size,
+      heldBytes: this.heldBytes,
+      delivered: this.delivered,
+      reordered: this.reordered,
+      duplicates: this.duplicates,
+      gaps: this.gaps,
+    };
+  }
+
+  private release(out: Buffer[], skipGaps: boolean) {
+    if (!skipGaps) {
+      for (let data = this.held.get(this.next); data; data = this.held.get(this.next)) {
+        this.take(out, this.next, data);
+      }
+      return;
+    }
+    for (const seq of [...this.held.keys()].sort((a, b) => a - b)) {
+      if (seq !== this.next) this.gaps += 1;
+      this.take(out, seq, this.held.get(seq) as Buffer);
+    }
+  }
+
+  private take(out: Buffer[], seq: number, data: Buffer) {
+    out.push(data);
+    this.held.delete(seq);
+    this.heldBytes -= data.length;
+    this.next = seq + 1;
+    this.delivered += 1;
+  }
+}
+
+type BundleEvents = {
+  /** In the order the sender's send() calls were made. */
+  message: Buffer;
+  close: void;
+};
+
+/** Receiver side of one bundle: its members, reassembled into one stream. */
+export class BundleConnection extends TypedEventEmitter<BundleEvents> {
+  readonly members = new Map<string, QWormholeServerConnection>();
+
+  constructor(
+    readonly id: string,
+    /** Members the sender opened; some may not have joined yet. */
+    readonly paths: number,
+    private readonly reorder: NativeBundleReorder,
+  ) {
+    super();
+  }
+
+  /** Sends on one member; replies are not striped or ordered across paths. */
+  send(data: Buffer | string): Promise<void> {
+    const member = this.members.values().next().value as QWormholeServerConnection | undefined;
+    if (!member) return Promise.reject(new Error("Bundle has no members"));
+    return member.send(data);
+  }
+
+  stats(): NativeBundleReorderStats & { members: number } {
+    return { ...this.reorder.stats(), members: this.members.size };
+  }
+
+  /** @internal */
+  deliver(frames: Buffer[]) {
+    for (const frame of frames) this.emit("message", frame);
+  }
+
+  /** @internal */
+  leave(memberId: string) {
+    this.members.delete(memberId);
+    // Frames the lost member had in flight will not come; stop waiting.
+    this.deliver(this.reorder.flush());
+    if (this.members.size === 0) this.emit("close");
+  }
+
+  /** @internal */
+  push(seq: number, payload: Buffer) {
+    this.deliver(this.reorder.push(seq, payload));
+  }
+}
+
+type BundleServer = {
+  on(
+    event: "message",
+    listener: (evt: { client: QWormholeServerConnection; data: unknown }) => void,
+  ): unknown;
+  on(
+    event: "clientClosed",
+    listener: (evt: { client: QWormholeServerConnection }) => void,
+  ): unknown;
+};
+
+export type ConnectionBundleAcceptorOptions = NativeBundleReorderOptions & {
+  /** false keeps the JS reorder buffer even with the lws addon loaded. */
+  native?: boolean;
+};
+
+type AcceptorEvents = {
+  /** A bundle's first member joined. */
+  bundle: BundleConnection;
+};
+
+/**
+ * Groups a server's connections into bundles by their hello frame and
+ * reorders each bundle's frames, natively when the lws addon is loaded.
+ * Give it a server whose deserializer yields Buffers (the native servers'
+ * default) and that is used for bundles only.
+ */
+export class ConnectionBundleAcceptor extends TypedEventEmitter<AcceptorEvents> {
+  private readonly bundles = new Map<string, BundleConnection>();
+  private readonly memberOf = new Map<string, BundleConnection>();
+
+  constructor(
+    server: BundleServer,
+    private readonly options: ConnectionBundleAcceptorOptions = {},
+  ) {
+    super();
+    server.on("message", ({ client, data }) => {
+      if (!Buffer.isBuffer(data)) return;
+      const bundle = this.memberOf.get(client.id);
+      if (bundle) {
+        if (data.length < SEQ_BYTES) return;
+        const seq = data.readUInt32BE(0) * TWO_32 + data.readUInt32BE(4);
+        bundle.push(seq, data.subarray(SEQ_BYTES));
+        return;
+      }
+      this.join(client, data);
+    });
+    server.on("clientClosed", ({ client }) => {
+      const bundle = this.memberOf.get(client.id);
+      if (!bundle) return;
+      this.memberOf.delete(client.id);
+      bundle.leave(client.id);
+      if (bundle.members.size === 0) this.bundles.delete(bundle.id);
+    });
+  }
+
+  private join(client: QWormholeServerConnection, hello: Buffer) {
+    if (hello.length < HELLO_BYTES || hello.readUInt32BE(0) !== HELLO_MAGIC) return;
+    const id = hello.toString("hex", 4, 20);
+    let bundle = this.bundles.get(id);
+    const created = !bundle;
+    if (!bundle) {
+      const native = this.options.native === false ? null : createNativeBundleReorder(this.options);
+      bundle = new BundleConnection(
+        id,
+        hello.readUInt16BE(22),
+        native ?? new JsBundleReorder(this.options),
+      );
+      this.bundles.set(id, bundle);
+    }
+    bundle.members.set(client.id, client);
+    this.memberOf.set(client.id, bundle);
+    if (created) this.emit("bundle", bundle);
+  }
+}
@@ -3,7 +3,9 @@ import { QWormholeServer } from "../server";
 import {
   getNativeBackend,
   isNativeAvailable,
+  isNativeLibsocketAvailable,
   NativeTcpClient,
+  type NativeClientPool,
 } from "./NativeTCPClient";
 import { NativeSocketAdapter } from "./native-socket";
 import {
@@ -17,20 +19,33 @@ import type {
   QWormholeClientOptions,
   QWormholeServerOptions,
   NativeBackend,
+  NativeSharedMemoryOptions,
   TransportMode,
   FramingMode,
 } from "../types/types";
 import { BatchFramer } from "./batch-framer";
 import { QWormholeContext } from "src/types/context";
 
-export interface CreateClientOptions<
-  TMessage,
-> extends QWormholeClientOptions<TMessage> {
+export interface CreateClientOptions<TMessage> extends Omit<
+  QWormholeClientOptions<TMessage>,
+  "host" | "port"
+> {
+  /** Optional when `path` selects a Unix domain socket. */
+  host?: string;
+  port?: number;
   preferNative?: boolean;
   forceTs?: boolean;
   detectNative?: boolean;
   nativeRaw?: boolean;
   nativePollIntervalMs?: number;
+  /** Multiplex onto a shared native client pool instead of a per-client lws context. */
+  nativePool?: NativeClientPool;
+  /**
+   * With `path`: talk to a `sharedMemory` server through shared-memory
+   * rings. Picks the native libsocket client whenever it loads, even
+   * without preferNative; without it the client falls back to the socket.
+   */
+  sharedMemory?: boolean | NativeSharedMemoryOptions;
 }
 
 export interface CreateClientResult<TMessage> {
@@ -52,17 +67,38 @@ export function createQWormholeClient<TMessage = Buffer>(
     detectNative,
     nativeRaw,
     nativePollIntervalMs,
-    ...clientOptions
+    nativePool,
+    sharedMemory,
+    host,
+    port,
+    ...rest
   } = options;
+  if (!rest.path && (!host || port === undefined)) {
+    throw new Error("createQWormholeClient requires host and port, or path");
+  }
+  const clientOptions: QWormholeClientOptions<TMessage> = {
+    ...rest,
+    host: host ?? "localhost",
+    port: port ?? 0,
+  };
   const useDetectNative = detectNative !== false;
   const backend = useDetectNative ? getNativeBackend() : null;
   const nativeReady = useDetectNative ? isNativeAvailable() : false;
+  const sharedMemoryReady =
+    !forceTs &&
+    !!sharedMemory &&
+    !!clientOptions.path &&
+    useDetectNative &&
+    isNativeLibsocketAvailable();
 
-  if (!forceTs && preferNative && nativeReady && backend) {
-    const resolvedBackend = backend ?? "lws";
+  if (!forceTs && ((preferNative && nativeReady && backend) || sharedMemoryReady)) {
+    // Only libsocket speaks Unix domain sockets.
+    const resolvedBackend: NativeBackend = clientOptions.path
+      ? "libsocket"
+      : (backend as NativeBackend);
     if (nativeRaw) {
       return {
-        client: new NativeTcpClient(resolvedBackend),
+        client: new NativeTcpClient(resolvedBackend, nativePool),
         mode: resolvedBackend === "lws" ? "native-lws" : "native-libsocket",
         nativeAvailable: true,
         nativeBackend: resolvedBackend,
@@ -77,6 +113,8 @@ export function createQWormholeClient<TMessage = Buffer>(
             ...socketOpts,
             preferredBackend: resolvedBackend,
             pollIntervalMs: nativePollIntervalMs,
+            pool: nativePool,
+            sharedMemory: clientOptions.path ? sharedMemory : undefined,
           }),
       }),
       mode: resolvedBackend === "lws" ? "native-lws" : "native-libsocket",
@@ -121,19 +159,25 @@ export function createQWormholeServer<TMessage = Buffer>(
 ): CreateServerResult<TMessage> {
   const forceTsForSecurity = shouldForceTsSecureServer(options);
   const detectNative = options.detectNative !== false;
-  const backend = detectNative
-    ? getNativeServerBackend(options.preferredNativeBackend)
-    : null;
+  // Only the libsocket server listens on Unix domain sockets.
+  const preferredBackend: NativeBackend | undefined = options.path
+    ? "libsocket"
+    : options.preferredNativeBackend;
+  const backend = detectNative ? getNativeServerBackend(preferredBackend) : null;
   const nativeReady = detectNative
-    ? isNativeServerAvailable(options.preferredNativeBackend)
+    ? isNativeServerAvailable(preferredBackend)
     : false;
+  // The TS server cannot take the rings, so sharedMemory insists on native.
+  const sharedMemory = !!options.sharedMemory && !!options.path && !options.forceTs;
 
   if (
     !forceTsForSecurity &&
     !options.forceTs &&
-    options.preferNative &&
+    (options.preferNative || sharedMemory) &&
     nativeReady &&
-    backend
+    backend &&
+    (!options.path || backend === "libsocket") &&
+    (backend === "lws" || (!options.nativeHandshake && !options.tls?.enabled))
   ) {
     const resolvedBackend = backend;
     return {
@@ -144,6 +188,11 @@ export function createQWormholeServer<TMessage = Buffer>(
     };
   }
 
+  if (sharedMemory) {
+    throw new Error(
+      "sharedMemory needs the native libsocket server. Run `pnpm run rebuild` or drop sharedMemory.",
+    );
+  }
   return {
     server: new QWormholeServer<TMessage>(options),
     mode: "ts",
@@ -34,6 +34,12 @@ import { CoherenceController } from "./CoherenceController";
 import { TokenBucket } from "./qos";
 import { CoherenceLevel, EntropyVelocity } from "src/schema/scp";
 import type { TransportGovernancePolicy } from "./transport-governance-policy";
+import type {
+  NativeFlowDiagnostics,
+  NativeFlowPolicy,
+  NativeLwsTuning,
+  NativeTcpPathStats,
+} from "../types/types";
 import {
   computeTransportCoherence,
   type TransportCoherenceSnapshot,
@@ -427,6 +433,8 @@ export class FlowController extends TypedEventEmitter<FlowControllerEvents> {
   private readonly negDiagnostics = new NegentropicDiagnostics();
   private lastEluBaseline?: ReturnType<typeof performance.eventLoopUtilization>;
   private governancePolicy?: TransportGovernancePolicy;
+  private nativeDiagnostics?: () => NativeFlowDiagnostics | null | undefined;
+  private path?: NativeTcpPathStats;
 
   // Diagnostics
   private totalFlushes = 0;
@@ -694,7 +702,7 @@ export class FlowController extends TypedEventEmitter<FlowControllerEvents> {
       gcPauseMs: diag.adaptive?.gcPauseMaxMs ?? 0,
       marginEstimate: diag.policy.coherence, // Use coherence as margin proxy
       reserveEstimate,
-      rttMs: undefined,
+      rttMs: this.resolveRttMs(),
       timestamp: now,
     };
     // Get decision from CoherenceController
@@ -968,6 +976,56 @@ export class FlowController extends TypedEventEmitter<FlowControllerEvents> {
     );
   }
 
+  /**
+   * Map the current framer caps onto the native lws write budget so writable
+   * callbacks contract and expand on the same pressure signals as BatchFramer.
+   */
+  resolveNativeTuning(peerIsNative: boolean): NativeLwsTuning {
+    const caps = this.resolveFramerCaps(peerIsNative);
+    return { maxWritesPerWritable: Math.max(1, caps.maxBuffers) };
+  }
+
+  /**
+   * Bounds for native flow control: the service thread adapts the slice
+   * within the session policy from TCP_INFO and the send queue, so the JS
+   * backpressure contractions above no longer reach lws.
+   */
+  resolveNativeFlowPolicy(peerIsNative: boolean): NativeFlowPolicy {
+    const minSlice = Math.max(1, this.policy.minSlice);
+    const caps = this.resolveFramerCaps(peerIsNative);
+    const maxSlice = Math.max(
+      minSlice,
+      Math.min(this.getEffectiveMaxSlice(), caps.maxBuffers),
+    );
+    return {
+      minSlice,
+      maxSlice,
+      preferredSlice: this.clamp(this.sliceSize, minSlice, maxSlice),
+      rateBytesPerSec: this.effectiveRateBytesPerSec,
+      burstBytes: this.policy.burstBudgetBytes,
+    };
+  }
+
+  /**
+   * Feed a measured TCP path (a native connection's TCP_INFO sample) in
+   * place of the RTT the peer profile would otherwise leave unknown.
+   */
+  observePath(path?: NativeTcpPathStats): void {
+    this.path = path;
+  }
+
+  private resolveRttMs(): number | undefined {
+    const rttUs = this.path?.rttUs || this.nativeDiagnostics?.()?.rttUs;
+    return rttUs ? rttUs / 1000 : undefined;
+  }
+
+  /** Where getDiagnostics() reads native flow control state; unset to detach. */
+  setNativeDiagnosticsSource(
+    read?: () => NativeFlowDiagnostics | null | undefined,
+  ): void {
+    this.nativeDiagnostics = read;
+  }
+
   setGovernancePolicy(policy?: TransportGovernancePolicy): void {
     this.governancePolicy = policy;
   }
@@ -992,6 +1050,7 @@ export class FlowController extends TypedEventEmitter<FlowControllerEvents> {
           gcPauseMaxMs: this.adaptive?.state.gcPauseMaxMs,
           payloadEntropy: negentropic.entropy,
           payloadNegentropy: negentropic.negentropy,
+          path: this.path,
         })
       : undefined;
     return {
@@ -1031,6 +1090,8 @@ export class FlowController extends TypedEventEmitter<FlowControllerEvents> {
             reason: this.governancePolicy.reason,
           }
         : undefined,
+      native: this.nativeDiagnostics?.() ?? undefined,
+      path: this.path,
       negentropic,
     };
   }
@@ -1343,6 +1404,10 @@ export interface FlowControllerDiagnostics {
     reason: string[];
   };
   transportCoherence?: TransportCoherenceSnapshot;
+  /** Service-thread flow control, when a native lws socket runs it. */
+  native?: NativeFlowDiagnostics;
+  /** The TCP path last passed to observePath(). */
+  path?: NativeTcpPathStats;
   negentropic: NegentropicSnapshot;
 }
 
@@ -1,4 +1,8 @@
 import { TypedEventEmitter } from "../utils/typedEmitter";
+import {
+  createNativeFrameSplitter,
+  type NativeFrameSplitter,
+} from "./NativeTCPClient";
 
 interface FramerEvents {
   message: Buffer;
@@ -7,18 +11,76 @@ interface FramerEvents {
 
 export interface LengthPrefixedFramerOptions {
   maxFrameLength?: number;
+  /**
+   * Set once caps.compression is on: the top bit of the length prefix then
+   * flags a compressed payload, which is passed through this before emit.
+   */
+  inflate?: (payload: Buffer) => Buffer;
+  /**
+   * caps.integrity: frames flagged with a CRC32C trailer are checked and
+   * emitted without it; a mismatch is an "error" and resets the framer.
+   */
+  checksums?: boolean;
+  /**
+   * Split frames with the lws addon's FrameSplitter when it is loaded
+   * (default true). Chunks are then kept as a list rather than concatenated,
+   * so a frame spanning many chunks is copied once instead of per chunk.
+   */
+  preferNative?: boolean;
 }
 
 const HEADER_LENGTH = 4;
+/** Length-prefix bit marking a raw-deflate payload (caps.compression). */
+export const COMPRESSED_FRAME_FLAG = 0x80000000;
+/** Length-prefix bit marking a CRC32C trailer (caps.integrity). */
+export const CHECKSUM_FRAME_FLAG = 0x04000000;
+const CHECKSUM_LENGTH = 4;
 const DEFAULT_MAX_FRAME_LENGTH = 4 * 1024 * 1024; // 4 MiB
 
+let crc32cTable: Uint32Array | undefined;
+
+/**
+ * CRC32C (Castagnoli) a byte at a time, for when the lws addon's
+ * FrameSplitter, which checks trailers natively, is not loaded.
+ */
+export const crc32c = (bytes: Uint8Array, crc = 0): number => {
+  if (!crc32cTable) {
+    crc32cTable = new Uint32Array(256);
+    for (let i = 0; i < 256; i += 1) {
+      let value = i;
+      for (let bit = 0; bit < 8; bit += 1) {
+        value = value & 1 ? (value >>> 1) ^ 0x82f63b78 : value >>> 1;
+      }
+      crc32cTable[i] = value;
+    }
+  }
+  let value = ~crc;
+  for (let i = 0; i < bytes.length; i += 1) {
+    value = (value >>> 8) ^ crc32cTable[(value ^ bytes[i]!) & 0xff]!;
+  }
+  return ~value >>> 0;
+};
+
 export class LengthPrefixedFramer extends TypedEventEmitter<FramerEvents> {
   private readonly maxFrameLength: number;
+  private readonly inflate?: (payload: Buffer) => Buffer;
+  private readonly checksums: boolean;
+  private readonly splitter: NativeFrameSplitter | null;
   private buffer: Buffer = Buffer.alloc(0);
 
   constructor(options?: LengthPrefixedFramerOptions) {
     super();
     this.maxFrameLength = options?.maxFrameLength ?? DEFAULT_MAX_FRAME_LENGTH;
+    this.inflate = options?.inflate;
+    this.checksums = options?.checksums ?? false;
+    this.splitter =
+      options?.preferNative === false
+        ? null
+        : createNativeFrameSplitter({
+            maxFrameLength: this.maxFrameLength,
+            compressedFlag: this.inflate !== undefined,
+            checksumFlag: this.checksums || undefined,
+          });
   }
 
   encode(payload: Buffer): Buffer {
@@ -28,10 +90,20 @@ export class LengthPrefixedFramer extends TypedEventEmitter<FramerEvents> {
   }
 
   push(chunk: Buffer): void {
+    if (this.splitter) {
+      this.pushNative(this.splitter, chunk);
+      return;
+    }
     this.buffer = Buffer.concat([this.buffer, chunk]);
 
     while (this.buffer.length >= HEADER_LENGTH) {
-      const frameLength = this.buffer.readUInt32BE(0);
+      const word = this.buffer.readUInt32BE(0);
+      const compressed =
+        this.inflate !== undefined && word >= COMPRESSED_FRAME_FLAG;
+      let frameLength = compressed ? word - COMPRESSED_FRAME_FLAG : word;
+      const checksummed =
+        this.checksums && (frameLength & CHECKSUM_FRAME_FLAG) !== 0;
+      if (checksummed) frameLength -= CHECKSUM_FRAME_FLAG;
       if (frameLength > this.maxFrameLength) {
         this.buffer = Buffer.alloc(0);
         this.emit(
@@ -47,13 +119,64 @@ export class LengthPrefixedFramer extends TypedEventEmitter<FramerEvents> {
 
       const start = HEADER_LENGTH;
       const end = HEADER_LENGTH + frameLength;
-      const frame = this.buffer.subarray(start, end);
+      let frame = this.buffer.subarray(start, end);
+      if (checksummed) {
+        // The trailer covers the length word as sent, then the payload.
+        const body = end - CHECKSUM_LENGTH;
+        if (
+          frameLength < CHECKSUM_LENGTH ||
+          crc32c(this.buffer.subarray(0, body)) !== this.buffer.readUInt32BE(body)
+        ) {
+          this.buffer = Buffer.alloc(0);
+          this.emit("error", new Error("Frame checksum mismatch"));
+          return;
+        }
+        frame = this.buffer.subarray(start, body);
+      }
       this.buffer = this.buffer.subarray(end);
+      if (compressed) {
+        try {
+          frame = this.inflate!(frame);
+        } catch (err) {
+          this.buffer = Buffer.alloc(0);
+          this.emit("error", err as Error);
+          return;
+        }
+      }
       this.emit("message", frame);
     }
   }
 
   reset(): void {
     this.buffer = Buffer.alloc(0);
+    this.splitter?.reset();
+  }
+
+  private pushNative(splitter: NativeFrameSplitter, chunk: Buffer): void {
+    const { frames, compressed, oversized, corrupt } = splitter.push(chunk);
+    let nextCompressed = 0;
+    for (let index = 0; index < frames.length; index += 1) {
+      let frame = frames[index];
+      if (compressed?.[nextCompressed] === index) {
+        nextCompressed += 1;
+        try {
+          frame = this.inflate!(frame);
+        } catch (err) {
+          splitter.reset();
+          this.emit("error", err as Error);
+          return;
+        }
+      }
+      this.emit("message", frame);
+    }
+    if (oversized !== undefined) {
+      this.emit(
+        "error",
+        new Error(`Frame length ${oversized} exceeds limit ${this.maxFrameLength}`),
+      );
+    }
+    if (corrupt !== undefined) {
+      this.emit("error", new Error("Frame checksum mismatch"));
+    }
   }
 }
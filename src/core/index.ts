@@ -2,14 +2,20 @@
 export * from './base-runtime';
 export * from './batch-framer';
 export * from './codecs';
+export * from './connection-bundle';
 export * from './CoherenceController';
 export * from './factory';
 export * from './flow-controller';
 export * from './framing';
+export * from './native-mux-link';
 export * from './native-server';
+export * from './native-stats-stream';
+export * from './native-timestamps';
 export * from './NativeTCPClient';
 export * from './qos';
 export * from './runtime';
+export * from './secure-streams';
 export * from './TcpClient';
 export * from './transport-coherence';
+export * from './transport-coherence-pipeline';
 export * from './transport-governance-policy';
@@ -0,0 +1,256 @@
+import bindings from "bindings";
+import fs from "node:fs";
+import path from "node:path";
+import { createRequire } from "node:module";
+import type { NativeBackend } from "../types/types";
+
+/**
+ * Addon resolution shared by the client, server and QUIC loaders. Each
+ * addon is resolved once per process: through the binding manifest that
+ * scripts/install-native.js writes to dist/native/bindings.json, and only
+ * when that is missing or stale by probing the usual build, dist and
+ * prebuild locations. A successful probe refreshes the manifest, so the
+ * next process (every shard worker, say) goes straight to the file.
+ */
+
+export type NativeAddonName =
+  | "qwormhole_native"
+  | "qwormhole_lws"
+  | "qwormhole"
+  | "qwquic";
+
+export type BindingManifest = {
+  version: number;
+  /** process.versions.modules the addons were resolved for. */
+  abi: string;
+  platform: string;
+  arch: string;
+  /** CPU variant the paths were picked for; absent for baseline builds. */
+  variant?: string;
+  /** Addon paths relative to the package root. */
+  bindings: Partial<Record<NativeAddonName, string>>;
+};
+
+export const BINDING_MANIFEST_VERSION = 1;
+
+const DEBUG_NATIVE = process.env.QWORMHOLE_DEBUG_NATIVE === "1";
+const logNative = (msg: string) => {
+  if (DEBUG_NATIVE) {
+    console.log(`[qwormhole][native] ${msg}`);
+  }
+};
+
+const requireFn =
+  typeof require === "function" ? require : createRequire(__filename);
+/** From src/ (ts-node) or dist/ (compiled), two levels up is the package root. */
+export const packageRoot = path.resolve(__dirname, "..", "..");
+const envBindingPath = process.env.QWORMHOLE_NATIVE_PATH;
+const platformArch = `${process.platform}-${process.arch}`;
+const isTestRuntime =
+  process.env.NODE_ENV === "test" ||
+  process.env.VITEST === "true" ||
+  process.env.VITEST === "1" ||
+  !!process.env.VITEST_WORKER_ID;
+const allowPrebuiltProbeInTests =
+  process.env.QWORMHOLE_ENABLE_TEST_PREBUILDS === "1";
+// Tests load mocked bindings; a developer's real manifest must not win.
+const useManifest = !isTestRuntime || allowPrebuiltProbeInTests;
+
+// x86-64-v3 (AVX2, BMI1/2, FMA, MOVBE, F16C, LZCNT) builds are staged in
+// prebuilds/<platform-arch>/x86-64-v3 by scripts/build-optimized-prebuilds.cjs.
+const X86_64_V3_FLAGS = ["avx", "avx2", "bmi1", "bmi2", "f16c", "fma", "movbe", "abm", "xsave"];
+let detectedVariant: string | null | undefined;
+
+/**
+ * The -march prebuild variant this CPU runs, or null for baseline builds.
+ * QWORMHOLE_NATIVE_VARIANT overrides detection ("baseline" turns it off).
+ */
+export const cpuVariant = (): string | null => {
+  if (detectedVariant !== undefined) return detectedVariant;
+  detectedVariant = null;
+  const forced = process.env.QWORMHOLE_NATIVE_VARIANT;
+  if (forced) {
+    detectedVariant = forced === "baseline" ? null : forced;
+  } else if (process.platform === "linux" && process.arch === "x64") {
+    try {
+      const line = /^flags\s*:(.*)$/m.exec(fs.readFileSync("/proc/cpuinfo", "utf8"));
+      const flags = new Set((line?.[1] ?? "").trim().split(/\s+/));
+      if (X86_64_V3_FLAGS.every(flag => flags.has(flag))) detectedVariant = "x86-64-v3";
+    } catch {
+      // No cpuinfo: stay on the baseline build.
+    }
+  }
+  return detectedVariant;
+};
+
+export const bindingManifestPath = (): string =>
+  process.env.QWORMHOLE_BINDING_MANIFEST ??
+  path.join(packageRoot, "dist", "native", "bindings.json");
+
+const resolveBindings = () =>
+  (globalThis as unknown as { bindings?: typeof bindings }).bindings ??
+  bindings;
+
+type BindingLoader = (
+  target: string | { module_root: string; bindings: string },
+) => unknown;
+
+let manifest: BindingManifest | null | undefined;
+const loaded = new Map<NativeAddonName, unknown>();
+
+/** The manifest if written for this Node ABI, platform and CPU variant, else null. */
+export const readBindingManifest = (): BindingManifest | null => {
+  if (manifest !== undefined) return manifest;
+  manifest = null;
+  if (!useManifest) return manifest;
+  try {
+    const parsed = JSON.parse(
+      fs.readFileSync(bindingManifestPath(), "utf8"),
+    ) as BindingManifest;
+    if (
+      parsed.version === BINDING_MANIFEST_VERSION &&
+      parsed.abi === process.versions.modules &&
+      parsed.platform === process.platform &&
+      parsed.arch === process.arch &&
+      (parsed.variant ?? null) === cpuVariant() &&
+      parsed.bindings
+    ) {
+      manifest = parsed;
+    } else {
+      logNative(`binding manifest ${bindingManifestPath()} is for another runtime`);
+    }
+  } catch {
+    logNative(`no binding manifest at ${bindingManifestPath()}`);
+  }
+  return manifest;
+};
+
+// QUIC brings its own candidate list (cargo targets and the like).
+const probeCandidates = (name: NativeAddonName): string[] => {
+  const candidates: string[] = [];
+  if (name === "qwquic") return candidates;
+  if (isTestRuntime && !allowPrebuiltProbeInTests) {
+    return candidates;
+  }
+  const variant = cpuVariant();
+  if (variant) {
+    candidates.push(
+      path.join(packageRoot, "prebuilds", platformArch, variant, `${name}.node`),
+      path.join(packageRoot, "dist", "native", "prebuilds", platformArch, variant, `${name}.node`),
+    );
+  }
+  candidates.push(
+    path.join(packageRoot, "dist", "native", `${name}.node`),
+    path.join(packageRoot, "prebuilds", platformArch, `${name}.node`),
+    path.join(packageRoot, "dist", "native", "prebuilds", platformArch, `${name}.node`),
+  );
+  return candidates;
+};
+
+const tryRequire = (targetPath: string): unknown => {
+  try {
+    logNative(`attempting to load binding path "${targetPath}"`);
+    return requireFn(targetPath);
+  } catch (err) {
+    logNative(`binding path "${targetPath}" not found: ${(err as Error).message}`);
+    return null;
+  }
+};
+
+// Best effort: a read-only install just keeps probing.
+const recordResolvedPath = (name: NativeAddonName, resolved: string) => {
+  if (!useManifest) return;
+  const relative = path.relative(packageRoot, resolved);
+  const current = readBindingManifest();
+  if (current?.bindings[name] === relative) return;
+  const next: BindingManifest = {
+    version: BINDING_MANIFEST_VERSION,
+    abi: process.versions.modules,
+    platform: process.platform,
+    arch: process.arch,
+    variant: cpuVariant() ?? undefined,
+    bindings: { ...current?.bindings, [name]: relative },
+  };
+  try {
+    fs.mkdirSync(path.dirname(bindingManifestPath()), { recursive: true });
+    fs.writeFileSync(bindingManifestPath(), `${JSON.stringify(next, null, 2)}\n`);
+    manifest = next;
+    logNative(`binding manifest refreshed with ${name} -> ${relative}`);
+  } catch (err) {
+    logNative(`could not refresh binding manifest: ${(err as Error).message}`);
+  }
+};
+
+/**
+ * The addon `name`, loaded at most once per process. An `overridePath`
+ * (QWORMHOLE_NATIVE_PATH by default for the socket addons) is tried first
+ * and bypasses the manifest; `extraCandidates` are
+ * probed after the standard locations; a function candidate may return a
+ * path or the module itself. Unless `useBindings` is false, the bindings
+ * package's build/Release search comes last.
+ */
+export const loadNativeAddon = <T = unknown>(
+  name: NativeAddonName,
+  options: {
+    overridePath?: string;
+    extraCandidates?: Array<string | (() => unknown)>;
+    useBindings?: boolean;
+  } = {},
+): T | null => {
+  if (loaded.has(name)) return loaded.get(name) as T | null;
+  const overridePath =
+    options.overridePath ?? (name === "qwquic" ? undefined : envBindingPath);
+  let module: unknown = overridePath ? tryRequire(overridePath) : null;
+
+  const current = overridePath ? null : readBindingManifest();
+  const listed = current?.bindings[name];
+  if (listed) {
+    module = tryRequire(path.resolve(packageRoot, listed));
+    // Dropped so a probe that succeeds rewrites only this entry.
+    if (!module) delete current.bindings[name];
+  }
+  for (const candidate of module ? [] : [
+    ...probeCandidates(name),
+    ...(options.extraCandidates ?? []),
+  ]) {
+    const resolved = typeof candidate === "function" ? candidate() : candidate;
+    if (!resolved) continue;
+    if (typeof resolved !== "string") {
+      module = resolved;
+      break;
+    }
+    module = tryRequire(resolved);
+    if (module) {
+      recordResolvedPath(name, requireFn.resolve(resolved));
+      break;
+    }
+  }
+  if (!module && options.useBindings !== false) {
+    try {
+      logNative(`attempting to load binding "${name}"`);
+      const loader = resolveBindings() as BindingLoader;
+      module = loader({ module_root: packageRoot, bindings: name });
+      logNative(`successfully loaded binding "${name}"`);
+    } catch (err) {
+      logNative(`binding "${name}" not found: ${(err as Error).message}`);
+    }
+  }
+  loaded.set(name, module ?? null);
+  return (module ?? null) as T | null;
+};
+
+const backendAddons: Record<NativeBackend, NativeAddonName> = {
+  lws: "qwormhole_lws",
+  libsocket: "qwormhole",
+};
+
+/**
+ * The exports of socket backend `kind`: its namespace in the combined
+ * qwormhole_native addon (built with QWORMHOLE_BUILD_COMBINED=1) when that
+ * is present, so both backends come from one load, else its own addon.
+ */
+export const loadBackendAddon = <T>(kind: NativeBackend): T | null => {
+  const combined =
+    loadNativeAddon<Partial<Record<NativeBackend, T>>>("qwormhole_native");
+  return combined?.[kind] ?? loadNativeAddon<T>(backendAddons[kind]);
+};
@@ -0,0 +1,389 @@
+import { EventEmitter } from "node:events";
+import type {
+  NativeMuxEvent,
+  NativeMuxOptions,
+  NativeSocketOptions,
+  QWormholeServerConnection,
+  QWormholeSocketFactory,
+} from "../types/types";
+import { LengthPrefixedFramer } from "./framing";
+import { NativeTcpClient, type NativeClientPool } from "./NativeTCPClient";
+import type { NativeQWormholeServer } from "./native-server";
+
+export interface NativeMuxLinkOptions {
+  host: string;
+  port: number;
+  tls?: NativeSocketOptions["tls"];
+  /** Per-stream window and stream cap; the server's `mux` must match. */
+  mux?: NativeMuxOptions;
+  connectTimeoutMs?: number;
+  /** Shared lws context/thread for the physical connection. */
+  pool?: NativeClientPool;
+}
+
+type PendingLink = {
+  promise: Promise<NativeTcpClient>;
+  resolve: (client: NativeTcpClient) => void;
+  reject: (err: Error) => void;
+  timer?: NodeJS.Timeout;
+};
+
+/**
+ * Many logical links over one lws connection opened with `mux`. Each
+ * socket() is a mux stream, framed and demultiplexed on the service
+ * thread, so QWormholeClients built with `socketFactory:
+ * link.socketFactory` share one TCP (and TLS) connection upstream instead
+ * of opening one each. The connection opens with the first socket and is
+ * reopened by the first socket after it drops; every socket on it closes
+ * with it. The host and port a client passes to the factory are ignored:
+ * the link's own are used.
+ *
+ * The far end is a native lws server with `mux`; attachMuxLinkServer()
+ * turns its streams back into framed messages.
+ */
+export class NativeMuxLink extends EventEmitter {
+  private client?: NativeTcpClient;
+  private pending?: PendingLink;
+  private readonly sockets = new Map<number, MuxLinkSocket>();
+  private closed = false;
+
+  readonly socketFactory: QWormholeSocketFactory = () => this.socket();
+
+  constructor(private readonly options: NativeMuxLinkOptions) {
+    super();
+  }
+
+  /** A logical link; connect() opens its stream, and the connection if needed. */
+  socket(): MuxLinkSocket {
+    return new MuxLinkSocket(this);
+  }
+
+  /** Open streams on the current connection. */
+  get streamCount(): number {
+    return this.sockets.size;
+  }
+
+  /** Transport counters of the physical connection, mux included. */
+  getStats() {
+    return this.client?.getStats();
+  }
+
+  /** Closes the connection and every socket on it; socket() then fails. */
+  close(): void {
+    this.closed = true;
+    this.drop(false, new Error("Mux link closed"));
+  }
+
+  /** @internal MuxLinkSocket.connect(). */
+  async open(socket: MuxLinkSocket): Promise<number> {
+    if (this.closed) throw new Error("Mux link closed");
+    const client = await this.connectLink();
+    const streamId = client.muxOpen();
+    if (streamId === undefined) {
+      throw new Error("Mux link is at maxStreams");
+    }
+    this.sockets.set(streamId, socket);
+    return streamId;
+  }
+
+  /** @internal */
+  write(streamId: number, data: Buffer): boolean {
+    return this.client?.muxWrite(streamId, data) ?? false;
+  }
+
+  /** @internal */
+  release(streamId: number, reset: boolean): void {
+    if (!this.sockets.delete(streamId)) return;
+    this.client?.muxClose(streamId, reset);
+  }
+
+  private connectLink(): Promise<NativeTcpClient> {
+    if (this.client) return Promise.resolve(this.client);
+    if (this.pending) return this.pending.promise;
+    let resolve!: (client: NativeTcpClient) => void;
+    let reject!: (err: Error) => void;
+    const promise = new Promise<NativeTcpClient>((res, rej) => {
+      resolve = res;
+      reject = rej;
+    });
+    const pending: PendingLink = { promise, resolve, reject };
+    this.pending = pending;
+
+    const client = new NativeTcpClient("lws", this.options.pool);
+    client.setEventHandler(evt => {
+      switch (evt.type) {
+        case "connect":
+          if (this.pending !== pending) return;
+          clearTimeout(pending.timer);
+          this.pending = undefined;
+          this.client = client;
+          pending.resolve(client);
+          return;
+        case "mux":
+          this.onMux(client, evt);
+          return;
+        case "error": {
+          const err = new Error(evt.error ?? "Native mux link error");
+          if (this.listenerCount("error") > 0) this.emit("error", err);
+          if (this.pending === pending) this.fail(pending, err);
+          return;
+        }
+        case "close":
+          if (this.pending === pending) {
+            this.fail(pending, new Error("Native mux link closed during connect"));
+          } else if (this.client === client) {
+            this.drop(Boolean(evt.hadError));
+          }
+          return;
+        default:
+          return;
+      }
+    });
+    const timeoutMs = this.options.connectTimeoutMs ?? 5_000;
+    if (timeoutMs > 0) {
+      pending.timer = setTimeout(() => {
+        if (this.pending !== pending) return;
+        this.fail(pending, new Error("Native mux link connect timeout"));
+        client.close();
+      }, timeoutMs);
+    }
+    try {
+      client.connect({
+        host: this.options.host,
+        port: this.options.port,
+        useTls: this.options.tls?.enabled,
+        tls: this.options.tls,
+        alpn: this.options.tls?.alpnProtocols,
+        connectTimeoutMs: this.options.connectTimeoutMs,
+        delivery: "events",
+        mux: this.options.mux ?? true,
+      });
+    } catch (err) {
+      this.fail(pending, err instanceof Error ? err : new Error(String(err)));
+    }
+    return promise;
+  }
+
+  private fail(pending: PendingLink, err: Error): void {
+    clearTimeout(pending.timer);
+    if (this.pending === pending) this.pending = undefined;
+    pending.reject(err);
+  }
+
+  private onMux(client: NativeTcpClient, evt: NativeMuxEvent): void {
+    if (this.client !== client) return;
+    // Links are client-opened only; refuse whatever the server opens.
+    for (const streamId of evt.opened ?? []) {
+      if (!this.sockets.has(streamId)) client.muxClose(streamId, true);
+    }
+    for (const { streamId, data } of evt.streams ?? []) {
+      this.sockets.get(streamId)?.receive(data);
+    }
+    for (const streamId of evt.resumed ?? []) {
+      this.sockets.get(streamId)?.resume();
+    }
+    for (const { streamId, reset } of evt.closed ?? []) {
+      const socket = this.sockets.get(streamId);
+      if (!socket) continue;
+      this.sockets.delete(streamId);
+      socket.remoteClosed(reset);
+    }
+  }
+
+  private drop(hadError: boolean, err?: Error): void {
+    if (this.pending) this.fail(this.pending, err ?? new Error("Native mux link closed"));
+    const client = this.client;
+    this.client = undefined;
+    const sockets = [...this.sockets.values()];
+    this.sockets.clear();
+    for (const socket of sockets) socket.remoteClosed(hadError);
+    client?.close();
+  }
+}
+
+/** One mux stream of a NativeMuxLink, as the QWormholeSocketLike a client drives. */
+export class MuxLinkSocket extends EventEmitter {
+  public destroyed = false;
+  public writableLength = 0;
+  private streamId?: number;
+  private backpressured = false;
+  private idleTimeoutMs = 0;
+  private idleTimer?: NodeJS.Timeout;
+  private lastActivity = Date.now();
+
+  constructor(private readonly link: NativeMuxLink) {
+    super();
+  }
+
+  /** The stream id once connected. */
+  get stream(): number | undefined {
+    return this.streamId;
+  }
+
+  async connect(): Promise<void> {
+    if (this.destroyed) throw new Error("Mux link socket destroyed");
+    const streamId = await this.link.open(this);
+    if (this.destroyed) {
+      this.link.release(streamId, true);
+      throw new Error("Mux link socket destroyed");
+    }
+    this.streamId = streamId;
+    this.touch();
+    this.emit("connect");
+  }
+
+  /** False when the stream is out of the peer's window; "drain" follows. */
+  write(data: Buffer | string): boolean {
+    if (this.destroyed || this.streamId === undefined) return false;
+    const accepted = this.link.write(
+      this.streamId,
+      typeof data === "string" ? Buffer.from(data) : data,
+    );
+    this.touch();
+    if (!accepted) this.backpressured = true;
+    return !this.backpressured;
+  }
+
+  writev(buffers: Array<{ chunk: Buffer }>): boolean {
+    return this.write(Buffer.concat(buffers.map(entry => entry.chunk)));
+  }
+
+  end(): void {
+    this.close(false, false);
+  }
+
+  destroy(err?: Error): void {
+    this.close(true, Boolean(err));
+  }
+
+  setTimeout(timeoutMs: number): void {
+    this.idleTimeoutMs = timeoutMs;
+    this.armIdleTimeout();
+  }
+
+  /** @internal */
+  receive(data: Buffer): void {
+    if (this.destroyed) return;
+    this.touch();
+    this.emit("data", data);
+  }
+
+  /** @internal */
+  resume(): void {
+    if (!this.backpressured) return;
+    this.backpressured = false;
+    this.emit("drain");
+  }
+
+  /** @internal The peer or the connection closed the stream. */
+  remoteClosed(hadError: boolean): void {
+    if (this.destroyed) return;
+    this.destroyed = true;
+    this.clearIdleTimer();
+    this.emit("close", hadError);
+  }
+
+  private close(reset: boolean, hadError: boolean): void {
+    if (this.destroyed) return;
+    this.destroyed = true;
+    this.clearIdleTimer();
+    if (this.streamId !== undefined) this.link.release(this.streamId, reset);
+    this.emit("close", hadError);
+  }
+
+  private touch(): void {
+    this.lastActivity = Date.now();
+    if (this.idleTimeoutMs > 0 && !this.idleTimer) this.armIdleTimeout();
+  }
+
+  private armIdleTimeout(): void {
+    this.clearIdleTimer();
+    if (this.idleTimeoutMs <= 0 || this.destroyed) return;
+    const idle = Date.now() - this.lastActivity;
+    this.idleTimer = setTimeout(
+      () => {
+        this.idleTimer = undefined;
+        if (this.destroyed) return;
+        if (Date.now() - this.lastActivity >= this.idleTimeoutMs) {
+          this.emit("timeout");
+          return;
+        }
+        this.armIdleTimeout();
+      },
+      Math.max(this.idleTimeoutMs - idle, 1),
+    );
+  }
+
+  private clearIdleTimer(): void {
+    if (!this.idleTimer) return;
+    clearTimeout(this.idleTimer);
+    this.idleTimer = undefined;
+  }
+}
+
+export interface MuxLinkMessage {
+  client: QWormholeServerConnection;
+  streamId: number;
+  data: Buffer;
+  /** Frames `payload` back onto the same stream. */
+  reply(payload: Buffer): boolean;
+}
+
+/**
+ * The server end of NativeMuxLink: splits each stream of a native lws
+ * server's `mux` connections into the length-prefixed frames its
+ * QWormholeClient sent, and calls `onMessage` per frame. A client with
+ * `protocolVersion` sends its handshake as the first frame. A stream that
+ * sends a frame over `maxFrameLength` is reset. Returns an unsubscribe
+ * function.
+ */
+export const attachMuxLinkServer = (
+  server: NativeQWormholeServer<unknown>,
+  onMessage: (message: MuxLinkMessage) => void,
+  options: { maxFrameLength?: number } = {},
+): (() => void) => {
+  const framers = new Map<string, Map<number, LengthPrefixedFramer>>();
+
+  const framerFor = (client: QWormholeServerConnection, streamId: number) => {
+    let streams = framers.get(client.id);
+    if (!streams) {
+      streams = new Map();
+      framers.set(client.id, streams);
+    }
+    let framer = streams.get(streamId);
+    if (!framer) {
+      const created = new LengthPrefixedFramer({ maxFrameLength: options.maxFrameLength });
+      const reply = (payload: Buffer) =>
+        server.muxWrite(client.id, streamId, created.encode(payload));
+      created.on("message", data => onMessage({ client, streamId, data, reply }));
+      created.on("error", () => {
+        streams!.delete(streamId);
+        server.muxClose(client.id, streamId, true);
+      });
+      streams.set(streamId, created);
+      framer = created;
+    }
+    return framer;
+  };
+
+  const onMux = (event: NativeMuxEvent & { client: QWormholeServerConnection }) => {
+    for (const { streamId, data } of event.streams ?? []) {
+      framerFor(event.client, streamId).push(data);
+    }
+    for (const { streamId } of event.closed ?? []) {
+      framers.get(event.client.id)?.delete(streamId);
+    }
+  };
+  const onClientClosed = ({ client }: { client: QWormholeServerConnection }) => {
+    framers.delete(client.id);
+  };
+
+  server.on("mux", onMux);
+  server.on("clientClosed", onClientClosed);
+
+  return () => {
+    server.off("mux", onMux);
+    server.off("clientClosed", onClientClosed);
+    framers.clear();
+  };
+};
@@ -1,19 +1,51 @@
-import bindings from "bindings";
 import type net from "node:net";
-import path from "node:path";
-import { createRequire } from "node:module";
 import { defaultSerializer, bufferDeserializer } from "./codecs";
 import { QWormholeError } from "../utils/errors";
 import { TypedEventEmitter } from "../utils/typedEmitter";
 import {
+  buildEntropyPolicyTable,
   computeEntropyMetrics,
   deriveEntropyPolicy,
   type EntropyMetrics,
 } from "../handshake/entropy-policy";
 import { applyQWormholeServerSecurityDefaults } from "../security/env";
+import { resolveSocketTuning, toSessionKey } from "./NativeTCPClient";
+import { loadBackendAddon } from "./native-addons";
+import {
+  DEFAULT_STREAM_CHUNK_BYTES,
+  pumpStreamChunks,
+  type NativeStreamSource,
+} from "./native-stream";
+import { encodeClockProbe, readClockProbe, wallClockUs } from "./native-timestamps";
 import type {
   Deserializer,
+  NativeAnomalyEvent,
+  NativeAnomalyMetric,
   NativeBackend,
+  NativeClockOffset,
+  NativeConnectionCost,
+  NativeConnectionsSnapshot,
+  NativeConnectionStats,
+  NativeGatewayRequest,
+  NativeGatewayStats,
+  NativeHandshakePolicyRow,
+  NativeListenEndpointInfo,
+  NativeLwsTuning,
+  NativeMetricDefinition,
+  NativeMuxEvent,
+  NativeRxTimestamps,
+  NativeSendFileOptions,
+  NativeServerSendOptions,
+  NativeServerAcceptStats,
+  NativeServerTransportStats,
+  NativeServerWriteStats,
+  NativeServiceStats,
+  NativeShutdownOptions,
+  NativeShutdownReport,
+  NativeStreamChunk,
+  NativeStreamSendOptions,
+  NativeTcpPathStats,
+  NativeTimestampStats,
   Payload,
   QWormholeServerConnection,
   QWormholeServerEvents,
@@ -35,21 +67,9 @@ const parsePreferredBackend = (raw?: string): NativeBackend | undefined => {
   return undefined;
 };
 
-const requireFn = typeof require === "function" ? require : createRequire(__filename);
-const envBindingPath = process.env.QWORMHOLE_NATIVE_PATH;
-const platformArch = `${process.platform}-${process.arch}`;
-const isTestRuntime =
-  process.env.NODE_ENV === "test" ||
-  process.env.VITEST === "true" ||
-  process.env.VITEST === "1" ||
-  !!process.env.VITEST_WORKER_ID;
-const allowPrebuiltProbeInTests =
-  process.env.QWORMHOLE_ENABLE_TEST_PREBUILDS === "1";
-
 const DEFAULT_NATIVE_SERVER_BACKEND =
   parsePreferredBackend(process.env.QWORMHOLE_NATIVE_SERVER_PREFERRED) ??
-  parsePreferredBackend(process.env.QWORMHOLE_NATIVE_PREFERRED) ??
-  (process.platform === "linux" ? "libsocket" : undefined);
+  parsePreferredBackend(process.env.QWORMHOLE_NATIVE_PREFERRED);
 
 const nativeDisabled = () => {
   const legacy = process.env.QWORMHOLE_NATIVE;
@@ -61,30 +81,136 @@ const nativeDisabled = () => {
 type NativeServerHandle = NodeJS.EventEmitter & {
   listen(): Promise<net.AddressInfo>;
   close(): Promise<void>;
-  broadcast(payload: Payload): void;
-  sendTo?(id: string, payload: Payload): void;
-  shutdown?(gracefulMs?: number): Promise<void>;
-  getConnection?(id: string): QWormholeServerConnection | undefined;
+  broadcast(payload: Payload, options?: { ttlMs?: number }): void;
+  broadcastTo?(
+    ids: Array<string | number>,
+    payload: Payload,
+    options?: { ttlMs?: number },
+  ): number;
+  broadcastDelta?(key: string, data: Buffer): void;
+  subscribe?(id: string | number, topic: string): boolean;
+  unsubscribe?(id: string | number, topic?: string): boolean | number;
+  publish?(topic: string, payload: Payload, options?: NativeServerSendOptions): number;
+  sendTo?(
+    id: string | number,
+    payload: Payload,
+    options?: NativeServerSendOptions,
+  ): boolean | void;
+  sendBatch?(
+    ids: Array<string | number> | Uint32Array | Float64Array,
+    payloads: Payload[] | NativePackedPayloads,
+    options?: { priority?: number; ttlMs?: number },
+  ): Uint8Array;
+  receiveRings?(): Uint8Array[];
+  sendFile?(
+    id: string | number,
+    file: string | number,
+    offset?: number,
+    length?: number,
+    options?: NativeSendFileOptions,
+  ): boolean;
+  sendStreamChunk?(
+    id: string | number,
+    streamId: number,
+    data: Buffer,
+    bits?: number,
+  ): boolean | undefined;
+  shutdown?(
+    gracefulMs?: number,
+    options?: { closeHint?: Payload },
+  ): Promise<void>;
+  getConnection?(id: string | number): QWormholeServerConnection | undefined;
   getConnectionCount?(): number;
-  closeConnection?(id: string): void;
+  closeConnection?(id: string | number): void;
+  pause?(id: string | number): boolean;
+  resume?(id: string | number): boolean;
+  ack?(id: string | number, bytes: number): boolean;
+  getWriteStats?(): NativeServerWriteStats;
+  getAcceptStats?(): NativeServerAcceptStats;
+  registerMetrics?(metrics: NativeMetricDefinition[]): Float64Array;
+  getMetricsPort?(): number | undefined;
+  getGatewayPort?(): number | undefined;
+  getEndpoints?(): NativeListenEndpointInfo[];
+  respondGateway?(id: number, status: number, body?: Buffer | string, contentType?: string): boolean;
+  getGatewayStats?(): NativeGatewayStats | undefined;
+  getTimestampStats?(): NativeTimestampStats | undefined;
+  sendClockProbe?(id: string | number, probe: number, data: Buffer): boolean | undefined;
+  addClockSample?(
+    id: string | number,
+    probe: number,
+    t2Us: number,
+    t3Us: number,
+    t4Us: number,
+  ): NativeClockOffset | undefined;
+  setTuning?(tuning: NativeLwsTuning): NativeLwsTuning;
+  getServiceStats?(): NativeServiceStats;
+  getStats?(): NativeServerTransportStats;
+  getConnectionStats?(id: string | number): NativeConnectionStats | undefined;
+  getPathSnapshot?(): Float64Array;
+  getConnectionsSnapshot?(): NativeConnectionsSnapshot;
+  getCostlyConnections?(limit?: number): NativeConnectionCost[] | undefined;
+  setHandshakePolicy?(rows: NativeHandshakePolicyRow[]): number;
+  muxOpen?(id: string | number): number | undefined;
+  muxWrite?(id: string | number, streamId: number, data: Buffer): boolean;
+  muxClose?(id: string | number, streamId: number, reset?: boolean): boolean;
+  setSessionKey?(id: string | number, key: Buffer): boolean;
+  rekey?(id: string | number): boolean;
+  adoptSocket?(fd: number, state?: Buffer): boolean;
+  detachConnection?(id: string | number): Promise<NativeDetachedConnection | null>;
+  attachBroadcastRing?(name: string): boolean;
+  attachConnectionDirectory?(
+    link: NativeConnectionDirectoryNames & { shard: number },
+  ): boolean;
+  enableWorkerDelivery?(workers: number): string;
+  disableWorkerDelivery?(): void;
+  enableTransportTelemetry?(options?: { capacity?: number }): string;
+  disableTransportTelemetry?(): void;
 };
 
 type NativeConnectionSnapshot = Pick<
   QWormholeServerConnection,
-  "id" | "remoteAddress" | "remotePort" | "handshake"
->;
+  "id" | "remoteAddress" | "remotePort" | "remoteFamily" | "endpoint" | "handshake"
+> & {
+  /** Numeric slot handle; resolves without parsing or hashing the id. */
+  handle?: number;
+};
 
 type NativeMessagePayload = {
   client: NativeConnectionSnapshot;
   data: Buffer;
+  /** nativeDecode: the frame as the deserializer would have returned it. */
+  value?: unknown;
+  /** timestamping (libsocket). */
+  timestamps?: NativeRxTimestamps;
 };
 
+/** A nativeDecode frame held until verifyHandshake accepts the connection. */
+type DecodedMessage = { value: unknown };
+
 type NativeFlowPayload = {
   client: NativeConnectionSnapshot;
   queuedBytes?: number;
   threshold?: number;
 };
 
+type NativeResumablePayload = {
+  client?: { id: string };
+  /** Session token, hex. */
+  session: string;
+  resumed: boolean;
+  replayedFrames: number;
+};
+
+type NativeAnomalyPayload = NativeAnomalyEvent & { client?: { id: string } };
+
+type NativeStreamPayload = NativeStreamChunk & {
+  client: NativeConnectionSnapshot;
+};
+
+type NativeMuxPayload = NativeMuxEvent & {
+  client: NativeConnectionSnapshot;
+};
+
 type NativeClientClosedPayload = {
   client: NativeConnectionSnapshot;
   hadError: boolean;
@@ -95,130 +221,281 @@ type InternalServerOptions<TMessage> = {
   deserializer: Deserializer<TMessage>;
   verifyHandshake?: QWormholeServerOptions<TMessage>["verifyHandshake"];
   maxBackpressureBytes?: number;
+  nativeCodec?: QWormholeServerOptions<TMessage>["nativeCodec"];
+};
+
+// receiveRing layout, shared with the addon: a 64-byte header of i32 words
+// (head, tail, capacity), then 8-byte aligned records of u32 length, u32
+// reserved, u32 handle low, u32 handle high and the payload.
+const RING_HEADER_BYTES = 64;
+const RING_HEAD = 0;
+const RING_TAIL = 1;
+const RECEIVE_RECORD_HEADER_BYTES = 16;
+const RECEIVE_RING_PAD = 0xffffffff;
+
+type ReceiveRingView = {
+  header: Int32Array;
+  words: Uint32Array;
+  bytes: Uint8Array;
+  capacity: number;
+  mask: number;
+  /** Stopped at a frame whose "connection" event has not run yet. */
+  stalled: boolean;
 };
 
 type NativeConnectionState = {
   managed: QWormholeServerConnection;
+  handle?: number;
   accepted: boolean;
-  pending: Buffer[];
+  pending: Array<Buffer | DecodedMessage>;
+  /** mux events that arrived while verifyHandshake was still deciding. */
+  pendingMux: NativeMuxEvent[];
+  /** Likewise for stream chunks. */
+  pendingStream: NativeStreamChunk[];
+  /** Topics held in JS for a backend without native topics (libsocket). */
+  topics?: Set<string>;
+  /** anomalyDetection metrics raised and not yet cleared. */
+  anomalies?: Map<NativeAnomalyMetric, NativeAnomalyEvent>;
+  /** The syncClock() probe awaiting its reply. */
+  clockProbe?: {
+    probe: number;
+    resolve: (offset: NativeClockOffset) => void;
+    reject: (err: Error) => void;
+    timer: NodeJS.Timeout;
+  };
 };
 
-type NativeServerModule<TMessage> = {
-  QWormholeServerWrapper: new (
-    options: QWormholeServerOptions<TMessage>,
-  ) => NativeServerHandle;
+/** Producer end of a shared-memory broadcast ring (lws addon, POSIX). */
+export type NativeBroadcastRing = {
+  /** shm name shards pass to attachBroadcastRing(). */
+  name(): string;
+  /** False when the payload is over half the ring; send it another way. */
+  publish(data: Buffer): boolean;
+  close(): void;
+  getStats(): {
+    capacityBytes: number;
+    published: number;
+    bytes: number;
+    rejected: number;
+  };
 };
 
-type LoadedServerBinding<TMessage> = {
-  kind: NativeBackend;
-  module: NativeServerModule<TMessage>;
+/** shm names of a ConnectionDirectory and its per-shard inboxes. */
+export type NativeConnectionDirectoryNames = {
+  directory: string;
+  inboxes: string[];
 };
 
-const resolveBindings = () =>
-  (globalThis as unknown as { bindings?: typeof bindings }).bindings ??
-  bindings;
+/**
+ * Primary end of the cross-shard connection directory (lws addon, POSIX):
+ * maps connection ids to the shard holding them, plus one inbox per shard.
+ */
+export type NativeConnectionDirectory = {
+  names(): NativeConnectionDirectoryNames;
+  /** Owning shard index, or -1. */
+  lookup(id: string): number;
+  /** False when the id is unknown or the owner's inbox refused the frame. */
+  sendTo(id: string, data: Buffer, priority?: number): boolean;
+  close(): void;
+  getStats(): {
+    slots: number;
+    live: number;
+    /** Inserts that found no free slot within the probe limit. */
+    full: number;
+    forwarded: number;
+    misses: number;
+    rejected: number;
+  };
+};
 
 /**
- * bindings() resolves native .node relative to module_root/build/Release.
- * From src/ (ts-node) or dist/ (compiled), we need to climb two levels to the
- * package root so build/Release can be found.
+ * A connection detachConnection() let go of: `fd` is a duplicate of its
+ * socket, owned by the caller, and `state` what adoptSocket() on another
+ * shard needs to resume it.
  */
-const bindingModuleRoot = path.resolve(__dirname, "..", "..");
-
-type BindingLoader = (
-  target: string | { module_root: string; bindings: string },
-) => unknown;
-
-const tryLoadBindingPath = <TMessage>(
-  targetPath: string,
-): NativeServerModule<TMessage> | null => {
-  try {
-    logNativeServer(`attempting to load server binding path "${targetPath}"`);
-    const mod = requireFn(targetPath) as NativeServerModule<TMessage>;
-    if (!mod?.QWormholeServerWrapper) {
-      logNativeServer(
-        `server binding path "${targetPath}" missing QWormholeServerWrapper export`,
-      );
-      return null;
+export type NativeDetachedConnection = {
+  id: string;
+  fd: number;
+  state: Buffer;
+};
+
+/**
+ * A received frame as a worker sink gets it: `data` is the raw frame,
+ * before any deserializer, backed by the native receive buffer itself.
+ */
+export type NativeWorkerMessage = {
+  id: string;
+  handle: number;
+  data: Buffer;
+};
+
+/**
+ * Column order of getPathSnapshot(): NativePathField.Stride values per
+ * sampled connection, starting with its handle.
+ */
+export const NativePathField = {
+  Handle: 0,
+  SampledAt: 1,
+  RttUs: 2,
+  RttVarUs: 3,
+  MinRttUs: 4,
+  Cwnd: 5,
+  Mss: 6,
+  Unacked: 7,
+  Lost: 8,
+  Retransmits: 9,
+  PacingRate: 10,
+  DeliveryRate: 11,
+  Stride: 12,
+} as const;
+
+/** Bits of NativeConnectionsSnapshot.flags. */
+export const NativeConnectionFlag = {
+  Backpressured: 1,
+  /** pause() is in effect. */
+  Paused: 2,
+  Closing: 4,
+  HandshakeComplete: 8,
+  Ipv6: 16,
+} as const;
+
+/** Per-item results of sendBatch(). */
+export const NativeSendStatus = {
+  Queued: 0,
+  /** Queued, and the connection is over maxBackpressureBytes. */
+  Backpressured: 1,
+  /** No connection with that id or handle, here or on another shard. */
+  Unknown: 2,
+  /** Handed to the shard that holds the id. */
+  Forwarded: 3,
+} as const;
+
+/** sendBatch() payloads packed end to end: item i is buffer[offsets[i], offsets[i + 1]). */
+export type NativePackedPayloads = {
+  buffer: Uint8Array;
+  offsets: Uint32Array;
+};
+
+/** Connection `index`'s remote address in a snapshot, as Node prints it. */
+export const snapshotRemoteAddress = (
+  snapshot: NativeConnectionsSnapshot,
+  index: number,
+): string => {
+  const bytes = snapshot.addresses.subarray(index * 16, index * 16 + 16);
+  if (!(snapshot.flags[index] & NativeConnectionFlag.Ipv6)) {
+    return `${bytes[12]}.${bytes[13]}.${bytes[14]}.${bytes[15]}`;
+  }
+  const groups: string[] = [];
+  for (let i = 0; i < 16; i += 2) groups.push(((bytes[i] << 8) | bytes[i + 1]).toString(16));
+  // Shorten the longest run of two or more zero groups to "::".
+  let best = -1;
+  let bestLength = 1;
+  for (let i = 0; i < 8; ) {
+    let end = i;
+    while (end < 8 && groups[end] === "0") end += 1;
+    if (end - i > bestLength) {
+      best = i;
+      bestLength = end - i;
     }
-    logNativeServer(
-      `successfully loaded server binding path "${targetPath}"`,
-    );
-    return mod;
-  } catch (err) {
-    logNativeServer(
-      `server binding path "${targetPath}" not found: ${(err as Error).message}`,
-    );
-    return null;
+    i = end > i ? end : i + 1;
   }
+  if (best < 0) return groups.join(":");
+  return `${groups.slice(0, best).join(":")}::${groups.slice(best + bestLength).join(":")}`;
 };
 
-const tryLoadBinding = <TMessage>(
-  name: string,
-): NativeServerModule<TMessage> | null => {
-  try {
-    logNativeServer(`attempting to load server binding "${name}"`);
-    const loader = resolveBindings() as BindingLoader;
-    const mod = loader({
-      module_root: bindingModuleRoot,
-      bindings: name,
-    }) as NativeServerModule<TMessage>;
-    if (!mod?.QWormholeServerWrapper) {
-      logNativeServer(
-        `server binding "${name}" missing QWormholeServerWrapper export`,
-      );
-      return null;
-    }
-    logNativeServer(`successfully loaded server binding "${name}"`);
-    return mod;
-  } catch (err) {
-    logNativeServer(
-      `server binding "${name}" not found: ${(err as Error).message}`,
-    );
-    return null;
+/** Unpacks a getPathSnapshot() array, keyed by connection handle. */
+export const readPathSnapshot = (
+  snapshot: Float64Array,
+): Map<number, NativeTcpPathStats> => {
+  const paths = new Map<number, NativeTcpPathStats>();
+  const F = NativePathField;
+  for (let i = 0; i + F.Stride <= snapshot.length; i += F.Stride) {
+    paths.set(snapshot[i + F.Handle], {
+      sampledAt: snapshot[i + F.SampledAt],
+      rttUs: snapshot[i + F.RttUs],
+      rttVarUs: snapshot[i + F.RttVarUs],
+      minRttUs: snapshot[i + F.MinRttUs],
+      cwnd: snapshot[i + F.Cwnd],
+      mss: snapshot[i + F.Mss],
+      unacked: snapshot[i + F.Unacked],
+      lost: snapshot[i + F.Lost],
+      retransmits: snapshot[i + F.Retransmits],
+      pacingRate: snapshot[i + F.PacingRate],
+      deliveryRate: snapshot[i + F.DeliveryRate],
+    });
   }
+  return paths;
 };
 
-const bindingPathCandidates = (bindingName: string): string[] => {
-  const candidates: string[] = [];
-  if (envBindingPath) candidates.push(envBindingPath);
-  if (isTestRuntime && !allowPrebuiltProbeInTests) {
-    return candidates;
-  }
-  candidates.push(
-    path.join(bindingModuleRoot, "dist", "native", `${bindingName}.node`),
-    path.join(bindingModuleRoot, "prebuilds", platformArch, `${bindingName}.node`),
-    path.join(
-      bindingModuleRoot,
-      "dist",
-      "native",
-      "prebuilds",
-      platformArch,
-      `${bindingName}.node`,
-    ),
-  );
-  return candidates;
+/** A raw libuv handle, as child_process IPC delivers an unwrapped socket. */
+type NativeSocketHandle = { fd?: number; close(): void };
+
+/** One shard's page of a ShardStatsBoard, as read by the primary. */
+export type NativeShardStatsPage = {
+  shardIndex: number;
+  processId: number;
+  /** Bumps on every write; unchanged means the shard has not reported. */
+  seq: number;
+  /** Wall-clock ms of the last write. */
+  updatedAt: number;
+  messagesIn: number;
+  bytesIn: number;
+  connections: number;
+  errors: number;
+  queuedBytes: number;
+  loopLagMs: number;
+  serviceLagUs: number;
+};
+
+/** Seqlock-protected per-shard stats pages in shared memory (lws addon). */
+export type NativeShardStatsBoard = {
+  name(): string;
+  /** Shard side: overwrite this shard's page. */
+  write(
+    stats: Partial<
+      Omit<NativeShardStatsPage, "shardIndex" | "processId" | "seq" | "updatedAt">
+    >,
+  ): boolean;
+  /** Primary side: every page, null where a shard has not written yet. */
+  read(): Array<NativeShardStatsPage | null>;
+  close(): void;
+};
+
+type NativeServerModule<TMessage> = {
+  QWormholeServerWrapper: new (
+    options: QWormholeServerOptions<TMessage>,
+  ) => NativeServerHandle;
+  BroadcastRing?: new (options: { capacityBytes?: number }) => NativeBroadcastRing;
+  ConnectionDirectory?: new (options: {
+    shards: number;
+    slots?: number;
+    inboxBytes?: number;
+  }) => NativeConnectionDirectory;
+  ShardStatsBoard?: new (
+    options: { shards: number } | { name: string; shard: number },
+  ) => NativeShardStatsBoard;
+  attachMessageSink?(
+    token: string,
+    index: number,
+    onMessages: (messages: NativeWorkerMessage[]) => void,
+  ): boolean;
+  detachMessageSink?(token: string, index: number): boolean;
+  drainTransportTelemetry?(token: string, out: Float64Array): number;
+};
+
+type LoadedServerBinding<TMessage> = {
+  kind: NativeBackend;
+  module: NativeServerModule<TMessage>;
 };
 
 const loadServerBackend = <TMessage>(
   kind: NativeBackend,
 ): LoadedServerBinding<TMessage> | null => {
-  const bindingName = kind === "lws" ? "qwormhole_lws" : "qwormhole";
-  logNativeServer(`trying server backend: ${kind} (${bindingName})`);
-  for (const candidatePath of bindingPathCandidates(bindingName)) {
-    const mod = tryLoadBindingPath<TMessage>(candidatePath);
-    if (mod?.QWormholeServerWrapper) {
-      logNativeServer(
-        `loaded native server backend "${kind}" from ${candidatePath}`,
-      );
-      return { kind, module: mod };
-    }
-  }
-  const module = tryLoadBinding<TMessage>(bindingName);
+  logNativeServer(`trying server backend: ${kind}`);
+  // Shared with the client loader, so each addon is required once.
+  const module = loadBackendAddon<NativeServerModule<TMessage>>(kind);
   if (module?.QWormholeServerWrapper) {
-    logNativeServer(
-      `loaded native server backend "${kind}" from ${bindingName}`,
-    );
+    logNativeServer(`loaded native server backend "${kind}"`);
     return { kind, module };
   }
   logNativeServer(`server backend "${kind}" unavailable`);
@@ -299,12 +576,127 @@ export const isNativeServerAvailable = (preferred?: NativeBackend): boolean => {
   return Boolean(ensureNativeServerBinding(preferred));
 };
 
+/**
+ * A shared-memory broadcast ring for a sharded server's primary, or null
+ * when the lws addon is missing or predates it. Throws if shm fails.
+ */
+export const createNativeBroadcastRing = (
+  capacityBytes?: number,
+): NativeBroadcastRing | null => {
+  if (nativeDisabled()) return null;
+  const binding = bindingCache.lws ?? loadServerBackend<unknown>("lws");
+  if (!binding) return null;
+  bindingCache.lws = binding;
+  const Ring = binding.module.BroadcastRing;
+  return Ring ? new Ring({ capacityBytes }) : null;
+};
+
+/**
+ * A connection directory for `shards` shards, or null without the lws addon.
+ * Throws when shared memory cannot be set up.
+ */
+export const createNativeConnectionDirectory = (options: {
+  shards: number;
+  slots?: number;
+  inboxBytes?: number;
+}): NativeConnectionDirectory | null => {
+  if (nativeDisabled()) return null;
+  const binding = bindingCache.lws ?? loadServerBackend<unknown>("lws");
+  if (!binding) return null;
+  bindingCache.lws = binding;
+  const Directory = binding.module.ConnectionDirectory;
+  return Directory ? new Directory(options) : null;
+};
+
+/**
+ * `{ shards }` creates a stats board in the primary; `{ name, shard }` opens
+ * one shard's page of it. Null without the lws addon; throws when shared
+ * memory cannot be set up.
+ */
+export const createNativeShardStatsBoard = (
+  options: { shards: number } | { name: string; shard: number },
+): NativeShardStatsBoard | null => {
+  if (nativeDisabled()) return null;
+  const binding = bindingCache.lws ?? loadServerBackend<unknown>("lws");
+  if (!binding) return null;
+  bindingCache.lws = binding;
+  const Board = binding.module.ShardStatsBoard;
+  return Board ? new Board(options) : null;
+};
+
+/**
+ * In a worker thread: take sink `index` of the frames a server's
+ * enableWorkerDelivery() `token` routes, in the batches the service threads
+ * post. False when the token is unknown here (another process, or delivery
+ * since disabled) or the slot is taken; throws without the lws addon.
+ */
+export const attachNativeMessageSink = (
+  token: string,
+  index: number,
+  onMessages: (messages: NativeWorkerMessage[]) => void,
+): boolean => {
+  const binding = nativeDisabled()
+    ? undefined
+    : (bindingCache.lws ?? loadServerBackend<unknown>("lws"));
+  if (!binding?.module.attachMessageSink) {
+    throw new Error("Worker message sinks require the lws server backend");
+  }
+  bindingCache.lws = binding;
+  return binding.module.attachMessageSink(token, index, onMessages);
+};
+
+/** Undo attachNativeMessageSink() from the same worker. */
+export const detachNativeMessageSink = (
+  token: string,
+  index: number,
+): boolean =>
+  bindingCache.lws?.module.detachMessageSink?.(token, index) ?? false;
+
+/** drainNativeTransportTelemetry() record kinds. */
+export const NativeTelemetryKind = {
+  Flush: 1,
+  Backpressure: 2,
+} as const;
+
+/** Doubles per drainNativeTransportTelemetry() record. */
+export const NATIVE_TELEMETRY_RECORD_FIELDS = 4;
+
+/**
+ * From any thread of the process: move the records the service threads
+ * queued under an enableTransportTelemetry() `token` into `out`, four
+ * doubles each (kind, wall-clock ms, bytes, frames), and return how many.
+ * -1 when the token is unknown (telemetry disabled or the server closed);
+ * throws without the lws addon.
+ */
+export const drainNativeTransportTelemetry = (
+  token: string,
+  out: Float64Array,
+): number => {
+  const binding = nativeDisabled()
+    ? undefined
+    : (bindingCache.lws ?? loadServerBackend<unknown>("lws"));
+  if (!binding?.module.drainTransportTelemetry) {
+    throw new Error("Transport telemetry requires the lws server backend");
+  }
+  bindingCache.lws = binding;
+  return binding.module.drainTransportTelemetry(token, out);
+};
+
 export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
   QWormholeServerEvents<TMessage>
 > {
   private readonly impl: NativeServerHandle;
   private readonly options: InternalServerOptions<TMessage>;
   private readonly connections = new Map<string, NativeConnectionState>();
+  // receiveRing: records carry handles, not ids.
+  private readonly connectionsByHandle = new Map<number, NativeConnectionState>();
+  /** topic -> subscriber ids, only where the addon has no subscribe(). */
+  private readonly fallbackTopics = new Map<string, Set<string>>();
+  private receiveRings: ReceiveRingView[] = [];
+  /** sendStream() writers waiting on a connection's "drain", by id. */
+  private readonly streamWaiters = new Map<string, Array<() => void>>();
+  private nextStreamId = 1;
+  private nextClockProbe = 0;
   public readonly backend: NativeBackend;
 
   constructor(
@@ -327,7 +719,9 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
     }
 
     this.backend = nativeServerBinding.kind;
-    this.impl = new nativeServerBinding.module.QWormholeServerWrapper(options);
+    this.impl = new nativeServerBinding.module.QWormholeServerWrapper(
+      this.buildNativeOptions(options),
+    );
     this.interceptNativeEmits();
   }
 
@@ -342,6 +736,140 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
       deserializer,
       verifyHandshake: secured.verifyHandshake,
       maxBackpressureBytes: secured.maxBackpressureBytes,
+      nativeCodec: secured.nativeCodec,
+    };
+  }
+
+  private buildNativeOptions(
+    options: QWormholeServerOptions<TMessage>,
+  ): QWormholeServerOptions<TMessage> {
+    const nativeHandshake = options.nativeHandshake;
+    if (this.backend === "libsocket" && (nativeHandshake || options.tls?.enabled)) {
+      throw new QWormholeError(
+        "E_INVALID_HANDSHAKE",
+        "The libsocket server backend does not support nativeHandshake or TLS; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.mux) {
+      throw new Error(
+        "The libsocket server backend does not support native mux; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.compression) {
+      throw new Error(
+        "The libsocket server backend does not support frame compression; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.seal) {
+      throw new Error(
+        "The libsocket server backend does not support native seal; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.sequence) {
+      throw new Error(
+        "The libsocket server backend does not support native sequence numbers; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.resumable) {
+      throw new Error(
+        "The libsocket server backend does not support resumable sessions; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.streaming) {
+      throw new Error(
+        "The libsocket server backend does not support native streaming; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.delta) {
+      throw new Error(
+        "The libsocket server backend does not support delta broadcasts; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.integrity) {
+      throw new Error(
+        "The libsocket server backend does not support frame integrity; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.anomalyDetection) {
+      throw new Error(
+        "The libsocket server backend does not support anomalyDetection; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.impairment) {
+      throw new Error(
+        "The libsocket server backend does not support impairment; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.metrics) {
+      throw new Error(
+        "The libsocket server backend does not support a metrics endpoint; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.gateway) {
+      throw new Error(
+        "The libsocket server backend does not support an HTTP/2 gateway; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.endpoints?.length) {
+      throw new Error(
+        "The libsocket server backend does not support multiple endpoints; use the lws backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.strictHandshake) {
+      throw new Error(
+        "The libsocket server backend does not support strictHandshake; use the lws backend",
+      );
+    }
+    if (this.backend === "lws" && options.timestamping) {
+      // lws does its own reads, which leave the receive stamps behind.
+      throw new Error(
+        "The lws server backend does not support timestamping; use the libsocket backend",
+      );
+    }
+    if (this.backend === "libsocket" && options.loop === "uv") {
+      throw new Error(
+        "The libsocket server backend has no libuv loop option; use the lws backend",
+      );
+    }
+    if (options.nativeDecode && !options.nativeCodec) {
+      throw new Error("nativeDecode requires nativeCodec");
+    }
+    if (this.backend === "libsocket" && options.websocket) {
+      throw new Error(
+        "The libsocket server backend does not support native WebSocket; use the lws backend",
+      );
+    }
+    if (options.socketOptions) {
+      options = { ...options, socketOptions: resolveSocketTuning(options.socketOptions) };
+    }
+    if (options.heartbeatIntervalMs) {
+      // Serialized once here; the service threads resend the same bytes.
+      options = {
+        ...options,
+        heartbeatPayload: this.options.serializer(
+          options.heartbeatPayload ?? { type: "ping" },
+        ),
+      };
+    }
+    if (!nativeHandshake) return options;
+    if (!options.protocolVersion) {
+      throw new QWormholeError(
+        "E_INVALID_HANDSHAKE",
+        "nativeHandshake requires protocolVersion",
+      );
+    }
+    if (this.options.verifyHandshake) {
+      throw new QWormholeError(
+        "E_INVALID_HANDSHAKE",
+        "nativeHandshake cannot be combined with verifyHandshake",
+      );
+    }
+    return {
+      ...options,
+      nativeHandshake: {
+        ...nativeHandshake,
+        policy: nativeHandshake.policy ?? buildEntropyPolicyTable(),
+      },
     };
   }
 
@@ -369,7 +897,7 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
         this.emit("error", args[0] as Error);
         return;
       case "close":
-        this.emit("close", undefined as never);
+        this.emit("close", args[0] as NativeShutdownReport | undefined);
         return;
       case "connection":
         this.handleNativeConnection(args[0] as NativeConnectionSnapshot);
@@ -377,6 +905,23 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
       case "message":
         this.handleNativeMessage(args[0] as NativeMessagePayload);
         return;
+      case "messages":
+        for (const payload of args[0] as NativeMessagePayload[]) {
+          this.handleNativeMessage(payload);
+        }
+        return;
+      case "receiveRing":
+        this.drainReceiveRing(args[0] as number);
+        return;
+      case "mux":
+        this.handleNativeMux(args[0] as NativeMuxPayload);
+        return;
+      case "stream":
+        this.handleNativeStream(args[0] as NativeStreamPayload);
+        return;
+      case "gatewayRequests":
+        this.emit("gatewayRequests", args[0] as NativeGatewayRequest[]);
+        return;
       case "clientClosed":
         this.handleNativeClientClosed(args[0] as NativeClientClosedPayload);
         return;
@@ -386,6 +931,28 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
       case "drain":
         this.forwardFlowEvent("drain", args[0] as NativeFlowPayload);
         return;
+      case "timeout": {
+        const id = (args[0] as NativeFlowPayload).client?.id;
+        const state = id ? this.connections.get(id) : undefined;
+        if (state) this.emit("timeout", { client: state.managed } as never);
+        return;
+      }
+      case "resumable": {
+        const payload = args[0] as NativeResumablePayload;
+        const state = payload.client?.id ? this.connections.get(payload.client.id) : undefined;
+        if (state) {
+          this.emit("resumable", {
+            client: state.managed,
+            session: payload.session,
+            resumed: payload.resumed,
+            replayedFrames: payload.replayedFrames,
+          } as never);
+        }
+        return;
+      }
+      case "anomaly":
+        this.forwardAnomaly(args[0] as NativeAnomalyPayload);
+        return;
       default:
         break;
     }
@@ -396,28 +963,40 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
     const managed = this.createManagedConnection(snapshot);
     const state: NativeConnectionState = {
       managed,
+      handle: snapshot.handle,
       accepted: !this.options.verifyHandshake,
       pending: [],
+      pendingMux: [],
+      pendingStream: [],
     };
 
     this.connections.set(managed.id, state);
+    if (snapshot.handle !== undefined) this.connectionsByHandle.set(snapshot.handle, state);
     if (!state.accepted) {
       void this.verifyNativeHandshake(state, snapshot.handshake);
-      return;
+    } else {
+      this.emit("connection", managed);
     }
-    this.emit("connection", managed);
+    this.receiveRings.forEach((ring, index) => {
+      if (ring.stalled) this.drainReceiveRing(index);
+    });
   }
 
   private createManagedConnection(
     snapshot: NativeConnectionSnapshot,
   ): QWormholeServerConnection {
-    const close = () => this.closeConnection(snapshot.id);
+    // Native lookups by handle skip the id string round-trip.
+    const target = snapshot.handle ?? snapshot.id;
+    const close = () => this.closeConnection(target);
     const sendNotSupported = async () => {
       throw new Error(
         "Native backend does not support per-connection send yet",
       );
     };
-    const send: QWormholeServerConnection["send"] = async payload => {
+    const send: QWormholeServerConnection["send"] = async (
+      payload,
+      options,
+    ) => {
       const state = this.connections.get(snapshot.id);
       if (
         state?.managed.backpressured &&
@@ -428,9 +1007,15 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
           "Backpressure limit exceeded",
         );
       }
-      if (typeof this.impl.sendTo === "function") {
-        const serialized = this.options.serializer(payload);
-        this.impl.sendTo(snapshot.id, serialized);
+      const sendTo = this.impl.sendTo?.bind(this.impl);
+      if (sendTo) {
+        // Lower priorities drain first; the native side keeps one lane each
+        // for 0-3 and interleaves them at frame boundaries.
+        const lane =
+          options?.priority === undefined && options?.ttlMs === undefined
+            ? undefined
+            : { priority: options?.priority, ttlMs: options?.ttlMs };
+        this.encodeAndSend(payload, data => sendTo(target, data, lane));
         return;
       }
       return sendNotSupported();
@@ -442,6 +1027,8 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
       id: snapshot.id,
       remoteAddress: snapshot.remoteAddress,
       remotePort: snapshot.remotePort,
+      remoteFamily: snapshot.remoteFamily,
+      endpoint: snapshot.endpoint,
       handshake,
       backpressured: false,
       socket: {} as net.Socket,
@@ -454,22 +1041,137 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
   private handleNativeMessage(payload: NativeMessagePayload): void {
     const state = this.connections.get(payload.client.id);
     if (!state) return;
+    if ("value" in payload) {
+      if (!state.accepted) {
+        state.pending.push({ value: payload.value });
+        return;
+      }
+      this.emit("message", { client: state.managed, data: payload.value } as never);
+      return;
+    }
     const data = Buffer.isBuffer(payload.data)
       ? payload.data
       : Buffer.from(payload.data ?? []);
     logNativeServer(
       `received chunk from ${payload.client.id} (${data.length} bytes)`,
     );
+    if (state.clockProbe && this.completeClockProbe(state, data, payload.timestamps)) return;
     if (!state.accepted) {
       state.pending.push(data);
       return;
     }
-    this.emitMessage(state, data);
+    this.emitMessage(state, data, payload.timestamps);
+  }
+
+  /** True when `data` was the reply syncClock() is waiting for. */
+  private completeClockProbe(
+    state: NativeConnectionState,
+    data: Buffer,
+    timestamps?: NativeRxTimestamps,
+  ): boolean {
+    const waiter = state.clockProbe!;
+    const reply = readClockProbe(data);
+    if (!reply || reply.probe !== waiter.probe || reply.t2 === undefined || reply.t3 === undefined) {
+      return false;
+    }
+    state.clockProbe = undefined;
+    clearTimeout(waiter.timer);
+    const t4 = timestamps?.kernelUs ?? timestamps?.nativeUs ?? wallClockUs();
+    const offset = this.impl.addClockSample?.(state.managed.id, reply.probe, reply.t2, reply.t3, t4);
+    if (offset) {
+      waiter.resolve(offset);
+    } else {
+      waiter.reject(new Error("Clock probe was never sent"));
+    }
+    return true;
   }
 
-  private emitMessage(state: NativeConnectionState, payload: Buffer): void {
+  /**
+   * One "receiveRing" event per ring that went non-empty: every record up
+   * to head is emitted, and the space is handed back only after the
+   * handlers ran. Each Buffer is a view into the ring, valid until then.
+   */
+  private drainReceiveRing(index: number): void {
+    const ring = this.receiveRings[index];
+    if (!ring) return;
+    ring.stalled = false;
+    const { header, words, bytes, mask, capacity } = ring;
+    let tail = Atomics.load(header, RING_TAIL) >>> 0;
+    try {
+      for (;;) {
+        const head = Atomics.load(header, RING_HEAD) >>> 0;
+        if (head === tail) return;
+        while (tail !== head) {
+          const at = tail & mask;
+          const length = words[at >>> 2];
+          if (length === RECEIVE_RING_PAD) {
+            tail = (tail + capacity - at) >>> 0;
+            continue;
+          }
+          const handle = words[(at >>> 2) + 2] + words[(at >>> 2) + 3] * 2 ** 32;
+          const state = this.connectionsByHandle.get(handle);
+          if (!state && this.impl.getConnection?.(handle)) {
+            // Its "connection" event is still queued behind this one;
+            // handleNativeConnection() drains the rest.
+            ring.stalled = true;
+            return;
+          }
+          tail = (tail + RECEIVE_RECORD_HEADER_BYTES + ((length + 7) & ~7)) >>> 0;
+          if (!state) continue;
+          const data = Buffer.from(
+            bytes.buffer,
+            bytes.byteOffset + at + RECEIVE_RECORD_HEADER_BYTES,
+            length,
+          );
+          if (!state.accepted) {
+            state.pending.push(Buffer.from(data));
+            continue;
+          }
+          this.emitMessage(state, data);
+        }
+        // Re-read head after publishing tail: the service thread only
+        // notifies when it saw the ring empty.
+        Atomics.store(header, RING_TAIL, tail | 0);
+      }
+    } finally {
+      Atomics.store(header, RING_TAIL, tail | 0);
+    }
+  }
+
+  private handleNativeMux(payload: NativeMuxPayload): void {
+    const state = this.connections.get(payload.client.id);
+    if (!state) return;
+    const { client: _client, ...event } = payload;
+    if (!state.accepted) {
+      state.pendingMux.push(event);
+      return;
+    }
+    this.emit("mux", { ...event, client: state.managed } as never);
+  }
+
+  private handleNativeStream(payload: NativeStreamPayload): void {
+    const state = this.connections.get(payload.client.id);
+    if (!state) return;
+    const { client: _client, ...chunk } = payload;
+    if (!state.accepted) {
+      state.pendingStream.push(chunk);
+      return;
+    }
+    this.emit("stream", { ...chunk, client: state.managed } as never);
+  }
+
+  private emitMessage(
+    state: NativeConnectionState,
+    payload: Buffer,
+    timestamps?: NativeRxTimestamps,
+  ): void {
     const data = this.options.deserializer(payload);
-    this.emit("message", { client: state.managed, data } as never);
+    this.emit(
+      "message",
+      (timestamps
+        ? { client: state.managed, data, timestamps }
+        : { client: state.managed, data }) as never,
+    );
   }
 
   private async verifyNativeHandshake(
@@ -507,10 +1209,22 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
     if (state.accepted) return;
     state.accepted = true;
     this.emit("connection", state.managed);
+    const queuedMux = state.pendingMux.splice(0);
+    queuedMux.forEach(event =>
+      this.emit("mux", { ...event, client: state.managed } as never),
+    );
+    const queuedStream = state.pendingStream.splice(0);
+    queuedStream.forEach(chunk =>
+      this.emit("stream", { ...chunk, client: state.managed } as never),
+    );
     if (!state.pending.length) return;
     const queued = [...state.pending];
     state.pending.length = 0;
-    queued.forEach(buffer => this.emitMessage(state, buffer));
+    queued.forEach(message =>
+      Buffer.isBuffer(message)
+        ? this.emitMessage(state, message)
+        : this.emit("message", { client: state.managed, data: message.value } as never),
+    );
   }
 
   private rejectConnection(state: NativeConnectionState, error: Error): void {
@@ -518,16 +1232,48 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
     this.closeConnection(state.managed.id);
   }
 
-  private closeConnection(id: string): void {
+  private closeConnection(id: string | number): void {
     this.impl.closeConnection?.(id);
   }
 
+  private forwardAnomaly(payload: NativeAnomalyPayload): void {
+    const state = payload.client?.id ? this.connections.get(payload.client.id) : undefined;
+    if (!state) return;
+    const event: NativeAnomalyEvent = {
+      metric: payload.metric,
+      raised: payload.raised,
+      value: payload.value,
+      baseline: payload.baseline,
+    };
+    if (event.raised) {
+      (state.anomalies ??= new Map()).set(event.metric, event);
+    } else {
+      state.anomalies?.delete(event.metric);
+    }
+    this.emit("anomaly", { ...event, client: state.managed } as never);
+  }
+
   private handleNativeClientClosed(payload: NativeClientClosedPayload): void {
     const id = payload.client?.id;
     const state = id ? this.connections.get(id) : undefined;
+    if (state?.anomalies?.size) {
+      // Listeners tracking raised metrics (a governance signal store) see
+      // them end with the connection.
+      for (const raised of [...state.anomalies.values()]) {
+        this.forwardAnomaly({ ...raised, raised: false, client: { id: id! } });
+      }
+    }
     if (state) {
       this.connections.delete(id!);
+      if (state.handle !== undefined) this.connectionsByHandle.delete(state.handle);
+      this.dropFallbackTopics(id!, state);
+      if (state.clockProbe) {
+        clearTimeout(state.clockProbe.timer);
+        state.clockProbe.reject(new Error(`Connection ${id} closed`));
+        state.clockProbe = undefined;
+      }
     }
+    if (id) this.releaseStreamWaiters(id);
     const client =
       state?.managed ?? this.createManagedConnection(payload.client);
     this.emit("clientClosed", { client, hadError: payload.hadError } as never);
@@ -551,9 +1297,17 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
       return;
     }
     state.managed.backpressured = false;
+    this.releaseStreamWaiters(state.managed.id);
     this.emit(event, { client: state.managed } as never);
   }
 
+  private releaseStreamWaiters(id: string): void {
+    const waiters = this.streamWaiters.get(id);
+    if (!waiters) return;
+    this.streamWaiters.delete(id);
+    for (const resolve of waiters) resolve();
+  }
+
   private normalizeHandshake(
     handshake?: QWormholeServerConnection["handshake"],
   ): QWormholeServerConnection["handshake"] | undefined {
@@ -561,7 +1315,8 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
     const nIndex = handshake.nIndex ?? handshake.entropyMetrics?.negIndex ?? 0.5;
     const entropyMetrics: EntropyMetrics =
       handshake.entropyMetrics ?? computeEntropyMetrics(nIndex);
-    const policy = deriveEntropyPolicy(entropyMetrics);
+    // The native responder already chose a policy when it acked the handshake.
+    const policy = handshake.policy ?? deriveEntropyPolicy(entropyMetrics);
     return {
       ...handshake,
       entropyMetrics,
@@ -570,21 +1325,180 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
   }
 
   listen(): Promise<net.AddressInfo> {
-    return this.impl.listen();
+    const listening = this.impl.listen();
+    // Created synchronously by listen(), before any frame can be published.
+    this.receiveRings = (this.impl.receiveRings?.() ?? []).map(view => {
+      const buffer = view.buffer as SharedArrayBuffer;
+      const bytes = new Uint8Array(buffer, RING_HEADER_BYTES);
+      return {
+        header: new Int32Array(buffer, 0, RING_HEADER_BYTES / 4),
+        words: new Uint32Array(buffer, RING_HEADER_BYTES),
+        bytes,
+        capacity: bytes.length,
+        mask: bytes.length - 1,
+        stalled: false,
+      };
+    });
+    return listening;
   }
 
   close(): Promise<void> {
     return this.impl.close();
   }
 
-  broadcast(payload: Payload): void {
+  /**
+   * Send one payload to every connection. `ttlMs` (lws) drops it unsent
+   * from any queue still holding it that long from now.
+   */
+  broadcast(payload: Payload, options?: { ttlMs?: number }): void {
+    this.encodeAndSend(payload, data =>
+      options ? this.impl.broadcast(data, options) : this.impl.broadcast(data),
+    );
+  }
+
+  /**
+   * Send `payload` to every connection as the next version of snapshot
+   * `key`, with `delta` on both ends (lws backend). A connection sent the
+   * previous version gets a patch against it, everyone else the whole
+   * snapshot, and clients deliver the rebuilt snapshot as a "message".
+   * Non-Buffer payloads go through the serializer.
+   */
+  broadcastDelta(key: string, payload: Payload): void {
+    const broadcastDelta = this.impl.broadcastDelta?.bind(this.impl);
+    if (!broadcastDelta) {
+      throw new Error("Delta broadcasts require the lws server backend");
+    }
+    broadcastDelta(key, Buffer.isBuffer(payload) ? payload : this.options.serializer(payload));
+  }
+
+  /**
+   * Send one payload to a subset of connections. The native backend frames it
+   * once and queues a shared reference per recipient.
+   */
+  broadcastTo(
+    ids: Iterable<string>,
+    payload: Payload,
+    options?: { ttlMs?: number },
+  ): number {
+    const targets = Array.from(ids);
+    const broadcastTo = this.impl.broadcastTo?.bind(this.impl);
+    if (broadcastTo) {
+      return this.encodeAndSend(payload, data => broadcastTo(targets, data, options));
+    }
+    const serialized = this.options.serializer(payload);
+    let sent = 0;
+    for (const id of targets) {
+      if (!this.connections.has(id) || typeof this.impl.sendTo !== "function") {
+        continue;
+      }
+      this.impl.sendTo(id, serialized);
+      sent += 1;
+    }
+    return sent;
+  }
+
+  /**
+   * Add a connection to `topic`; false for an unknown connection or one
+   * already subscribed. The lws backend keeps subscriptions natively, as a
+   * bitset over connection slots per topic, and drops them when the
+   * connection closes.
+   */
+  subscribe(id: string, topic: string): boolean {
+    if (typeof this.impl.subscribe === "function") {
+      return this.impl.subscribe(id, topic);
+    }
+    const state = this.connections.get(id);
+    if (!state || state.topics?.has(topic)) return false;
+    (state.topics ??= new Set()).add(topic);
+    let subscribers = this.fallbackTopics.get(topic);
+    if (!subscribers) this.fallbackTopics.set(topic, (subscribers = new Set()));
+    subscribers.add(id);
+    return true;
+  }
+
+  /**
+   * Remove a connection from `topic` (whether it was subscribed), or from
+   * every topic when none is given (how many it had).
+   */
+  unsubscribe(id: string, topic: string): boolean;
+  unsubscribe(id: string): number;
+  unsubscribe(id: string, topic?: string): boolean | number {
+    if (typeof this.impl.unsubscribe === "function") {
+      return topic === undefined ? this.impl.unsubscribe(id) : this.impl.unsubscribe(id, topic);
+    }
+    const state = this.connections.get(id);
+    if (topic === undefined) {
+      const count = state?.topics?.size ?? 0;
+      if (state) this.dropFallbackTopics(id, state);
+      return count;
+    }
+    if (!state?.topics?.delete(topic)) return false;
+    const subscribers = this.fallbackTopics.get(topic);
+    subscribers?.delete(id);
+    if (subscribers?.size === 0) this.fallbackTopics.delete(topic);
+    return true;
+  }
+
+  /**
+   * Send one payload to every subscriber of `topic` and return how many
+   * there were. Natively that is one call however many subscribe: the
+   * payload is framed once and each subscriber queues a shared reference.
+   * With `conflate`, a subscriber's unsent frame under the same key is
+   * replaced rather than followed.
+   */
+  publish(topic: string, payload: Payload, options?: NativeServerSendOptions): number {
+    const publish = this.impl.publish?.bind(this.impl);
+    if (publish) {
+      return this.encodeAndSend(payload, data => publish(topic, data, options));
+    }
+    const subscribers = this.fallbackTopics.get(topic);
+    if (!subscribers?.size || typeof this.impl.sendTo !== "function") return 0;
     const serialized = this.options.serializer(payload);
-    this.impl.broadcast(serialized);
+    for (const id of subscribers) this.impl.sendTo(id, serialized, options);
+    return subscribers.size;
+  }
+
+  private dropFallbackTopics(id: string, state: NativeConnectionState): void {
+    if (!state.topics) return;
+    for (const topic of state.topics) {
+      const subscribers = this.fallbackTopics.get(topic);
+      subscribers?.delete(id);
+      if (subscribers?.size === 0) this.fallbackTopics.delete(topic);
+    }
+    state.topics = undefined;
   }
 
-  shutdown(gracefulMs?: number): Promise<void> {
+  /**
+   * With `nativeCodec` set, non-Buffer payloads are handed to the addon to
+   * encode straight into the framed buffer; the native encoder throws a
+   * TypeError for values it does not cover, which then take the JS serializer.
+   */
+  private encodeAndSend<T>(payload: Payload, send: (data: Payload) => T): T {
+    if (this.options.nativeCodec && !Buffer.isBuffer(payload)) {
+      try {
+        return send(payload);
+      } catch (err) {
+        if (!(err instanceof TypeError)) throw err;
+      }
+    }
+    return send(this.options.serializer(payload));
+  }
+
+  /**
+   * Stops accepting, flushes every connection's queue (then an optional close
+   * hint) and closes each as it drains, up to gracefulMs. "close" then carries
+   * a NativeShutdownReport.
+   */
+  shutdown(
+    gracefulMs?: number,
+    options: NativeShutdownOptions = {},
+  ): Promise<void> {
     if (typeof this.impl.shutdown === "function") {
-      return this.impl.shutdown(gracefulMs);
+      const closeHint =
+        options.closeHint === undefined
+          ? undefined
+          : this.options.serializer(options.closeHint);
+      return this.impl.shutdown(gracefulMs, { closeHint });
     }
     return this.close();
   }
@@ -601,4 +1515,472 @@ export class NativeQWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
   getConnectionCount(): number {
     return this.connections.size;
   }
+
+  /** Adjust lws write budget / service timeout live, when supported. */
+  setTuning(tuning: NativeLwsTuning): NativeLwsTuning | undefined {
+    return this.impl.setTuning?.(tuning);
+  }
+
+  /** Service-loop wakeup rates since the previous call, when supported. */
+  getServiceStats(): NativeServiceStats | undefined {
+    return this.impl.getServiceStats?.();
+  }
+
+  /** Write coalescing counters, when the loaded backend reports them. */
+  getWriteStats(): NativeServerWriteStats | undefined {
+    return this.impl.getWriteStats?.();
+  }
+
+  /** Listener accept counters and rate, when the loaded backend reports them. */
+  getAcceptStats(): NativeServerAcceptStats | undefined {
+    return this.impl.getAcceptStats?.();
+  }
+
+  /**
+   * Series for the `metrics` endpoint, one slot each in the returned array:
+   * write a slot and the next scrape reads it, without a call into native.
+   * Undefined on a backend without the endpoint.
+   */
+  registerMetrics(metrics: NativeMetricDefinition[]): Float64Array | undefined {
+    return this.impl.registerMetrics?.(metrics);
+  }
+
+  /** The port `metrics` is served on once listening; undefined when off. */
+  getMetricsPort(): number | undefined {
+    return this.impl.getMetricsPort?.();
+  }
+
+  /** The port `gateway` is served on once listening; undefined when off. */
+  getGatewayPort(): number | undefined {
+    return this.impl.getGatewayPort?.();
+  }
+
+  /**
+   * Every listener once listening: the server's own ("default") then each
+   * of `endpoints`, with the port it bound and its open connections.
+   * Empty before listen() and on the libsocket backend.
+   */
+  getEndpoints(): NativeListenEndpointInfo[] {
+    return this.impl.getEndpoints?.() ?? [];
+  }
+
+  /**
+   * Answers a "gatewayRequests" entry; the stream's service thread writes
+   * it. False when the server is not listening or has no gateway.
+   */
+  respondGateway(
+    id: number,
+    status: number,
+    body?: Uint8Array | string,
+    contentType?: string,
+  ): boolean {
+    const payload =
+      body === undefined || typeof body === "string" || Buffer.isBuffer(body)
+        ? body
+        : Buffer.from(body.buffer, body.byteOffset, body.byteLength);
+    return this.impl.respondGateway?.(id, status, payload, contentType) ?? false;
+  }
+
+  /** Gateway counters; undefined without `gateway`. */
+  getGatewayStats(): NativeGatewayStats | undefined {
+    return this.impl.getGatewayStats?.();
+  }
+
+  /** `timestamping` (libsocket): stamped reads and sends; undefined when off. */
+  getTimestampStats(): NativeTimestampStats | undefined {
+    return this.impl.getTimestampStats?.();
+  }
+
+  /** Server-wide latency/size histograms; snapshots never pause the service threads. */
+  getStats(): NativeServerTransportStats | undefined {
+    return this.impl.getStats?.();
+  }
+
+  /**
+   * Stop reading one connection (lws); the peer's TCP window then fills.
+   * False for an unknown id or a backend without RX flow control.
+   */
+  pause(id: string | number): boolean {
+    return this.impl.pause?.(id) ?? false;
+  }
+
+  /** Undo pause(); an rxBudgetBytes or maxPendingEvents pause still holds. */
+  resume(id: string | number): boolean {
+    return this.impl.resume?.(id) ?? false;
+  }
+
+  /** Return `bytes` of a connection's rxBudgetBytes with `rxBudgetRelease: "ack"`. */
+  ack(id: string | number, bytes: number): boolean {
+    return this.impl.ack?.(id, bytes) ?? false;
+  }
+
+  /** Counters for one connection, plus histograms with `connectionStats: true`. */
+  getConnectionStats(id: string | number): NativeConnectionStats | undefined {
+    return this.impl.getConnectionStats?.(id);
+  }
+
+  /**
+   * The latest TCP_INFO sample of every connection, packed per
+   * NativePathField (see readPathSnapshot()). Empty unless the server runs
+   * with `tcpInfoIntervalMs`; undefined on libsocket.
+   */
+  getPathSnapshot(): Float64Array | undefined {
+    return this.impl.getPathSnapshot?.();
+  }
+
+  /**
+   * Every connection as struct-of-arrays typed views, built natively in one
+   * pass: one call however many connections there are. Undefined on a
+   * backend without it (lws only).
+   */
+  getConnectionsSnapshot(): NativeConnectionsSnapshot | undefined {
+    return this.impl.getConnectionsSnapshot?.();
+  }
+
+  /**
+   * The `limit` (default 10) connections that have cost the service threads
+   * the most callback time, costliest first. Undefined without
+   * `costAccounting: true` or on libsocket.
+   */
+  getCostlyConnections(limit?: number): NativeConnectionCost[] | undefined {
+    return this.impl.getCostlyConnections?.(limit);
+  }
+
+  /** Open a stream on a `mux` connection; undefined at `maxStreams` or without mux. */
+  muxOpen(id: string | number): number | undefined {
+    return this.impl.muxOpen?.(id);
+  }
+
+  /**
+   * Frame `data` onto a mux stream natively. Bytes beyond the peer's window
+   * wait in the addon. False when the stream is not open or is now out of
+   * credit; its id comes back in a later `mux` event's `resumed` list.
+   */
+  muxWrite(id: string | number, streamId: number, data: Buffer): boolean {
+    return this.impl.muxWrite?.(id, streamId, data) ?? false;
+  }
+
+  muxClose(id: string | number, streamId: number, reset = false): boolean {
+    return this.impl.muxClose?.(id, streamId, reset) ?? false;
+  }
+
+  /**
+   * Install a connection's `seal` key (32 bytes, or deriveSharedSecret()'s
+   * Base64). Frames sent to it afterwards are sealed; once it has sent a
+   * sealed frame, unsealed ones from it are refused.
+   */
+  setSessionKey(id: string | number, key: Uint8Array | string): boolean {
+    if (typeof this.impl.setSessionKey !== "function") {
+      throw new Error("Native seal requires the lws server backend");
+    }
+    return this.impl.setSessionKey(id, toSessionKey(key));
+  }
+
+  /**
+   * Take over a connected TCP socket accepted elsewhere (lws backend, not
+   * Windows). The descriptor is duplicated natively and a net.Socket is
+   * destroyed straight after, so it must not have been read from: accept
+   * it with `pauseOnConnect` or receive it over IPC and adopt synchronously.
+   * A raw handle is closed instead. With `state` from another shard's
+   * detachConnection(), the connection resumes rather than starting over.
+   */
+  adoptSocket(
+    socket: net.Socket | NativeSocketHandle | number,
+    state?: Buffer,
+  ): boolean {
+    if (typeof this.impl.adoptSocket !== "function") {
+      throw new Error("Socket adoption requires the lws server backend");
+    }
+    const raw = typeof socket === "object" && !("destroy" in socket);
+    const fd =
+      typeof socket === "number"
+        ? socket
+        : raw
+          ? (socket as NativeSocketHandle).fd
+          : (socket as unknown as { _handle?: { fd?: number } })._handle?.fd;
+    if (typeof fd !== "number" || fd < 0) {
+      throw new Error("adoptSocket needs a socket with an OS file descriptor");
+    }
+    const adopted = state
+      ? this.impl.adoptSocket(fd, state)
+      : this.impl.adoptSocket(fd);
+    if (raw) {
+      (socket as NativeSocketHandle).close();
+    } else if (typeof socket !== "number") {
+      (socket as net.Socket).destroy();
+    }
+    return adopted;
+  }
+
+  /**
+   * Hot migration (lws backend, plain TCP, not Windows): let go of a
+   * connection without closing it, for adoptSocket(fd, state) on another
+   * shard. Queued frames and a half-read frame travel in `state`; the
+   * connection leaves here with a clientClosed event flagged `migrated`.
+   * Undefined when it cannot move: TLS, websocket, mux or sealed
+   * connections, and ones still in their handshake.
+   */
+  async detachConnection(
+    id: string,
+  ): Promise<NativeDetachedConnection | undefined> {
+    if (typeof this.impl.detachConnection !== "function") {
+      throw new Error("Connection migration requires the lws server backend");
+    }
+    const detached = await this.impl.detachConnection(id);
+    if (!detached) return undefined;
+    const state = this.connections.get(id);
+    if (state) {
+      this.connections.delete(id);
+      this.dropFallbackTopics(id, state);
+      this.emit("clientClosed", {
+        client: state.managed,
+        hadError: false,
+        migrated: true,
+      });
+    }
+    return detached;
+  }
+
+  /**
+   * Fan out a primary's createNativeBroadcastRing() frames to this server's
+   * connections natively, as broadcast() would (lws backend, not Windows).
+   * The ring is read from the moment of attaching.
+   */
+  attachBroadcastRing(name: string): boolean {
+    if (typeof this.impl.attachBroadcastRing !== "function") {
+      throw new Error("Broadcast rings require the lws server backend");
+    }
+    return this.impl.attachBroadcastRing(name);
+  }
+
+  /**
+   * Join a primary's createNativeConnectionDirectory() as shard `shard`, so
+   * sendTo() reaches connections held by the other shards (lws backend).
+   */
+  attachConnectionDirectory(
+    link: NativeConnectionDirectoryNames & { shard: number },
+  ): boolean {
+    if (typeof this.impl.attachConnectionDirectory !== "function") {
+      throw new Error("Connection directories require the lws server backend");
+    }
+    return this.impl.attachConnectionDirectory(link);
+  }
+
+  /**
+   * Route received frames to `workers` worker threads instead of this one
+   * (lws backend). Each worker passes the returned token and its index to
+   * attachNativeMessageSink(); a connection's frames always go to the same
+   * worker, and to this thread's message events while that worker has no
+   * sink or falls behind. Connection events stay here.
+   */
+  enableWorkerDelivery(workers: number): string {
+    if (typeof this.impl.enableWorkerDelivery !== "function") {
+      throw new Error("Worker delivery requires the lws server backend");
+    }
+    return this.impl.enableWorkerDelivery(workers);
+  }
+
+  disableWorkerDelivery(): void {
+    this.impl.disableWorkerDelivery?.();
+  }
+
+  /**
+   * Have the service threads record every writable pass (lws backend): a
+   * flush per pass that sent bytes, plus a backpressure mark when the
+   * socket took less than offered. Each thread writes its own lock-free
+   * ring of `capacity` records; drainNativeTransportTelemetry() with the
+   * returned token empties them from any thread, e.g. a coherence worker
+   * started by startTransportCoherencePipeline().
+   */
+  enableTransportTelemetry(options: { capacity?: number } = {}): string {
+    if (typeof this.impl.enableTransportTelemetry !== "function") {
+      throw new Error("Transport telemetry requires the lws server backend");
+    }
+    return this.impl.enableTransportTelemetry(options);
+  }
+
+  disableTransportTelemetry(): void {
+    this.impl.disableTransportTelemetry?.();
+  }
+
+  /**
+   * Send to one connection by id. With a connection directory attached, ids
+   * held by another shard are forwarded through its inbox. False when no
+   * shard holds the id. `conflate` (lws) replaces a still-queued frame sent
+   * with the same key, so only the latest state of that key goes out.
+   */
+  sendTo(
+    id: string,
+    payload: Payload,
+    options?: NativeServerSendOptions,
+  ): boolean {
+    const sendTo = this.impl.sendTo?.bind(this.impl);
+    if (!sendTo) return false;
+    const lane =
+      options?.priority === undefined &&
+      options?.conflate === undefined &&
+      options?.ttlMs === undefined
+        ? undefined
+        : {
+            priority: options?.priority,
+            conflate: options?.conflate,
+            ttlMs: options?.ttlMs,
+          };
+    const sent = this.encodeAndSend(payload, data => sendTo(id, data, lane));
+    // libsocket's sendTo() reports nothing; it only reaches local ids.
+    return sent === undefined ? this.connections.has(id) : sent;
+  }
+
+  /**
+   * sendTo() for many connections in one native call (lws backend): frames
+   * are built first, ids resolve under one table lock, each connection's
+   * items queue under one hold of its send lock, and the service threads
+   * are woken once. `ids` may be ids, handles, or a Uint32Array /
+   * Float64Array of handles; `payloads` one per id, or packed. Returns a
+   * NativeSendStatus per item.
+   */
+  sendBatch(
+    ids: Array<string | number> | Uint32Array | Float64Array,
+    payloads: Payload[] | NativePackedPayloads,
+    options?: { priority?: number; ttlMs?: number },
+  ): Uint8Array {
+    if (typeof this.impl.sendBatch !== "function") {
+      throw new Error("sendBatch requires the lws server backend");
+    }
+    const lane =
+      options?.priority === undefined && options?.ttlMs === undefined
+        ? undefined
+        : { priority: options?.priority, ttlMs: options?.ttlMs };
+    if (!Array.isArray(payloads)) {
+      return this.impl.sendBatch(ids, payloads, lane);
+    }
+    // Nothing is queued before every frame is built, so a nativeCodec
+    // refusal can be retried with the serializer, as encodeAndSend() does.
+    if (this.options.nativeCodec) {
+      try {
+        return this.impl.sendBatch(ids, payloads, lane);
+      } catch (err) {
+        if (!(err instanceof TypeError)) throw err;
+      }
+    }
+    const encoded = payloads.map(payload =>
+      Buffer.isBuffer(payload) ? payload : this.options.serializer(payload),
+    );
+    return this.impl.sendBatch(ids, encoded, lane);
+  }
+
+  /**
+   * Stream `length` bytes of a file (path or fd; default: to the end) from
+   * `offset` to one connection (lws backend). The length prefix is written
+   * natively and the body goes by sendfile(), or SSL_sendfile() with kTLS,
+   * so it never passes through JS. Only user-space TLS reads it into memory
+   * first. Not with websocket, mux, seal, sequence or integrity. False for
+   * an unknown id.
+   */
+  sendFile(
+    id: string | number,
+    file: string | number,
+    offset = 0,
+    length?: number,
+    options?: NativeSendFileOptions,
+  ): boolean {
+    if (typeof this.impl.sendFile !== "function") {
+      throw new Error("sendFile requires the lws server backend");
+    }
+    return this.impl.sendFile(id, file, offset, length, options);
+  }
+
+  /**
+   * Send a message of any size to one connection as ordered chunks of at
+   * most `chunkBytes`, with `streaming` on both ends (lws backend). The
+   * client gets a "stream" event per chunk; while the connection is
+   * backpressured the next chunk waits for its "drain". Resolves with the
+   * stream id once the last chunk is queued; rejects if the connection
+   * goes away first.
+   */
+  async sendStream(
+    id: string | number,
+    source: NativeStreamSource,
+    options: NativeStreamSendOptions = {},
+  ): Promise<number> {
+    const sendChunk = this.impl.sendStreamChunk?.bind(this.impl);
+    if (!sendChunk) {
+      throw new Error("Native streaming requires the lws server backend");
+    }
+    const key =
+      typeof id === "number" ? (this.connectionsByHandle.get(id)?.managed.id ?? String(id)) : id;
+    const streamId = this.nextStreamId;
+    this.nextStreamId = this.nextStreamId >= 0xffffffff ? 1 : this.nextStreamId + 1;
+    await pumpStreamChunks(
+      source,
+      options.chunkBytes ?? DEFAULT_STREAM_CHUNK_BYTES,
+      (data, bits) => {
+        const queued = sendChunk(id, streamId, data, bits);
+        if (queued === undefined) throw new Error(`Unknown connection ${key}`);
+        return queued;
+      },
+      () =>
+        new Promise(resolve => {
+          const waiters = this.streamWaiters.get(key) ?? [];
+          waiters.push(resolve);
+          this.streamWaiters.set(key, waiters);
+        }),
+    );
+    return streamId;
+  }
+
+  /**
+   * `timestamping` (libsocket): one NTP-style probe exchange with a
+   * QWormhole client, which answers probes by itself. t1 is when the probe
+   * reached the kernel here and t4 the kernel's stamp on the reply, so JS
+   * scheduling on this side stays out of the estimate. Resolves with the
+   * client's clock minus this one, filtered over the last eight probes;
+   * a newer call supersedes one still waiting.
+   */
+  syncClock(id: string, options: { timeoutMs?: number } = {}): Promise<NativeClockOffset> {
+    const state = this.connections.get(id);
+    const sendProbe = this.impl.sendClockProbe?.bind(this.impl);
+    if (!sendProbe) {
+      return Promise.reject(new Error("syncClock requires the libsocket server backend"));
+    }
+    if (!state) return Promise.reject(new Error(`Unknown connection ${id}`));
+    this.nextClockProbe = (this.nextClockProbe + 1) >>> 0;
+    const probe = this.nextClockProbe;
+    return new Promise((resolve, reject) => {
+      if (state.clockProbe) {
+        clearTimeout(state.clockProbe.timer);
+        state.clockProbe.reject(new Error("Superseded by a newer clock probe"));
+      }
+      const timer = setTimeout(() => {
+        if (state.clockProbe?.probe !== probe) return;
+        state.clockProbe = undefined;
+        reject(new Error("Clock probe timed out"));
+      }, options.timeoutMs ?? 1000);
+      state.clockProbe = { probe, resolve, reject, timer };
+      if (!sendProbe(id, probe, encodeClockProbe(probe))) {
+        clearTimeout(timer);
+        state.clockProbe = undefined;
+        reject(new Error(`Unknown connection ${id}`));
+      }
+    });
+  }
+
+  /**
+   * Move a connection's `seal` stage to its next key from the next frame
+   * sent. The client follows the key-phase bit; no round trip is needed.
+   */
+  rekey(id: string | number): boolean {
+    if (typeof this.impl.rekey !== "function") {
+      throw new Error("Native seal requires the lws server backend");
+    }
+    return this.impl.rekey(id);
+  }
+
+  /**
+   * Replace the `nativeHandshake` admission table; later handshakes use it,
+   * connections already admitted keep their policy. Returns the row count.
+   */
+  setHandshakePolicy(rows: NativeHandshakePolicyRow[]): number | undefined {
+    return this.impl.setHandshakePolicy?.(rows);
+  }
 }
@@ -1,10 +1,22 @@
 import { EventEmitter } from "node:events";
-import type { NativeBackend, NativeSocketOptions } from "../types/types";
-import { NativeTcpClient } from "./NativeTCPClient";
+import type {
+  NativeBackend,
+  NativeFlowDiagnostics,
+  NativeFlowPolicy,
+  NativeLwsTuning,
+  NativeSocketOptions,
+} from "../types/types";
+import {
+  NativeEventCode,
+  NativeTcpClient,
+  type NativeClientPool,
+} from "./NativeTCPClient";
 
 type NativeSocketAdapterOptions = NativeSocketOptions & {
   pollIntervalMs?: number;
   preferredBackend?: NativeBackend;
+  /** Shared lws context/thread to multiplex onto (lws backend only). */
+  pool?: NativeClientPool;
 };
 
 export class NativeSocketAdapter extends EventEmitter {
@@ -23,6 +35,10 @@ export class NativeSocketAdapter extends EventEmitter {
   private lastActivity = Date.now();
   private idleTimeoutMs?: number;
   private usingEvents = false;
+  // idleTimeoutMs runs on the native service thread instead of a JS timer.
+  private nativeIdle = false;
+  private backpressured = false;
+  private corked: Buffer[] | undefined;
   private pendingConnect?:
     | {
         resolve: () => void;
@@ -35,6 +51,9 @@ export class NativeSocketAdapter extends EventEmitter {
     protocol?: string;
     cipher?: string;
     authorized?: boolean;
+    sessionReused?: boolean;
+    ktlsSend?: boolean;
+    ktlsRecv?: boolean;
     peerFingerprint?: string;
     peerFingerprint256?: string;
   };
@@ -42,9 +61,10 @@ export class NativeSocketAdapter extends EventEmitter {
   constructor(opts: NativeSocketAdapterOptions) {
     super();
     this.opts = opts;
-    this.client = new NativeTcpClient(opts.preferredBackend);
+    this.client = new NativeTcpClient(opts.preferredBackend, opts.pool);
     if (this.client.supportsEventStream()) {
       this.enableEventStream();
+      this.nativeIdle = this.client.supportsNativeIdleTimeout();
     }
   }
 
@@ -58,11 +78,22 @@ export class NativeSocketAdapter extends EventEmitter {
         this.client.connect({
           host: this.opts.host,
           port: this.opts.port,
+          path: this.opts.path,
           useTls: this.opts.tls?.enabled,
           tls: this.opts.tls,
           alpn: this.opts.tls?.alpnProtocols,
           connectTimeoutMs: this.opts.connectTimeoutMs,
-          idleTimeoutMs: this.opts.idleTimeoutMs,
+          interfaceName: this.opts.interfaceName,
+          localAddress: this.opts.localAddress,
+          localPort: this.opts.localPort,
+          idleTimeoutMs: this.nativeIdle ? this.opts.idleTimeoutMs : undefined,
+          heartbeatIntervalMs: this.opts.heartbeatIntervalMs,
+          heartbeatPayload: this.opts.heartbeatPayload,
+          delivery: this.usingEvents ? "events" : "pull",
+          rxHighWaterMark: this.opts.rxHighWaterMark,
+          maxPendingEvents: this.opts.maxPendingEvents,
+          sharedMemory: this.opts.sharedMemory,
+          maxBackpressureBytes: this.opts.maxBackpressureBytes,
         });
       } catch (err) {
         reject(err instanceof Error ? err : new Error(String(err)));
@@ -119,12 +150,20 @@ export class NativeSocketAdapter extends EventEmitter {
     });
   }
 
+  /** Mirrors net.Socket: false once the native send queue is over its limit. */
   write(data: Buffer | string): boolean {
     if (this.destroyed) return false;
+    if (this.corked) {
+      this.corked.push(typeof data === "string" ? Buffer.from(data) : data);
+      return !this.backpressured;
+    }
     try {
-      this.client.send(data);
+      const accepted = this.client.send(data);
       this.touch();
-      return true;
+      if (accepted === false) {
+        this.backpressured = true;
+      }
+      return !this.backpressured;
     } catch (err) {
       this.emit("error", err instanceof Error ? err : new Error(String(err)));
       return false;
@@ -133,28 +172,41 @@ export class NativeSocketAdapter extends EventEmitter {
 
   writev(buffers: Array<{ chunk: Buffer }>): boolean {
     if (this.destroyed) return false;
+    const payloads = buffers.map(entry => entry.chunk);
+    if (this.corked) {
+      this.corked.push(...payloads);
+      return !this.backpressured;
+    }
+    return this.sendBatch(payloads);
+  }
+
+  /** Buffers writes until uncork() so they reach the native queue in one sendMany. */
+  cork(): void {
+    this.corked ??= [];
+  }
+
+  uncork(): void {
+    const pending = this.corked;
+    this.corked = undefined;
+    if (pending && pending.length > 0 && !this.destroyed) {
+      this.sendBatch(pending);
+    }
+  }
+
+  private sendBatch(payloads: Buffer[]): boolean {
     try {
-      const payloads = buffers.map(entry => entry.chunk);
       const result = this.client.sendMany?.(payloads);
       this.touch();
-      if (typeof result === "number") {
-        return result >= payloads.length;
+      if (typeof result === "number" && result < payloads.length) {
+        return false;
       }
-      return true;
+      return !this.backpressured;
     } catch (err) {
       this.emit("error", err instanceof Error ? err : new Error(String(err)));
       return false;
     }
   }
 
-  cork(): void {
-    // no-op: native binding batches internally
-  }
-
-  uncork(): void {
-    // no-op
-  }
-
   end(): void {
     this.destroy();
   }
@@ -171,12 +223,33 @@ export class NativeSocketAdapter extends EventEmitter {
     this.emit("close", false);
   }
 
+  setNativeTuning(tuning: NativeLwsTuning): NativeLwsTuning | undefined {
+    if (this.destroyed) return undefined;
+    return this.client.setTuning(tuning);
+  }
+
+  setNativeFlowPolicy(
+    policy: NativeFlowPolicy | null,
+  ): NativeFlowDiagnostics | null | undefined {
+    if (this.destroyed) return undefined;
+    return this.client.setFlowPolicy(policy);
+  }
+
+  getNativeFlowDiagnostics(): NativeFlowDiagnostics | null | undefined {
+    if (this.destroyed) return undefined;
+    return this.client.getFlowDiagnostics();
+  }
+
   setKeepAlive(_enable?: boolean, _delay?: number): void {
     // not supported by native binding yet
   }
 
   setTimeout(timeoutMs: number): void {
     this.idleTimeoutMs = timeoutMs;
+    if (this.nativeIdle) {
+      this.client.setIdleTimeout(timeoutMs);
+      return;
+    }
     this.armIdleTimeout();
   }
 
@@ -240,48 +313,117 @@ export class NativeSocketAdapter extends EventEmitter {
   enableEventStream(): void {
     if (this.usingEvents) return;
     this.usingEvents = true;
-    this.client.setEventHandler?.(evt => {
-      switch (evt.type) {
-        case "connect":
-          this.connected = true;
-          this.touch();
-          this.refreshTlsInfo();
-          this.resolvePendingConnect();
-          this.emit("connect");
+    // The lws client can hand events over as (code, data, arg) calls, which
+    // avoids an event object and type string per chunk.
+    const coded = this.client.setEventCodeHandler((code, data, arg) => {
+      switch (code) {
+        case NativeEventCode.Connect:
+          this.onNativeConnect();
           break;
-        case "data":
-          if (evt.data) {
-            this.touch();
-            this.emit("data", evt.data);
-          }
+        case NativeEventCode.Data:
+          if (data) this.onNativeData(data);
           break;
-        case "close":
-          this.connected = false;
-          if (!this.destroyed) {
-            this.failPendingConnect(
-              new Error(
-                evt.hadError
-                  ? "Native client closed during connect with error"
-                  : "Native client closed during connect",
-              ),
-            );
-          }
-          this.stopPolling();
-          this.emit("close", Boolean(evt.hadError));
+        case NativeEventCode.Backpressure:
+          this.onNativeBackpressure(typeof arg === "number" ? arg : undefined);
+          break;
+        case NativeEventCode.Drain:
+          this.onNativeDrain();
+          break;
+        case NativeEventCode.Timeout:
+          this.onNativeTimeout();
+          break;
+        case NativeEventCode.Close:
+          this.onNativeClose(Boolean(arg));
           break;
-        case "error":
-          this.failPendingConnect(
-            new Error(evt.error ?? "Native client error"),
-          );
-          this.emit("error", new Error(evt.error ?? "Native client error"));
+        case NativeEventCode.Error:
+          this.onNativeError(typeof arg === "string" ? arg : undefined);
           break;
         default:
           break;
       }
     });
+    if (!coded) {
+      this.client.setEventHandler?.(evt => {
+        switch (evt.type) {
+          case "connect":
+            this.onNativeConnect();
+            break;
+          case "data":
+            if (evt.data) this.onNativeData(evt.data);
+            break;
+          case "backpressure":
+            this.onNativeBackpressure(evt.queuedBytes);
+            break;
+          case "drain":
+            this.onNativeDrain();
+            break;
+          case "timeout":
+            this.onNativeTimeout();
+            break;
+          case "close":
+            this.onNativeClose(Boolean(evt.hadError));
+            break;
+          case "error":
+            this.onNativeError(evt.error);
+            break;
+          default:
+            break;
+        }
+      });
+    }
     this.armIdleTimeout();
   }
 
+  private onNativeConnect() {
+    this.connected = true;
+    this.touch();
+    this.refreshTlsInfo();
+    this.resolvePendingConnect();
+    this.emit("connect");
+  }
+
+  private onNativeData(data: Buffer) {
+    this.touch();
+    this.emit("data", data);
+  }
+
+  private onNativeBackpressure(queuedBytes: number | undefined) {
+    this.backpressured = true;
+    this.writableLength = queuedBytes ?? this.writableLength;
+  }
+
+  private onNativeDrain() {
+    this.backpressured = false;
+    this.writableLength = 0;
+    this.emit("drain");
+  }
+
+  private onNativeTimeout() {
+    if (this.destroyed) return;
+    this.emit("timeout");
+    this.destroy();
+  }
+
+  private onNativeClose(hadError: boolean) {
+    this.connected = false;
+    if (!this.destroyed) {
+      this.failPendingConnect(
+        new Error(
+          hadError
+            ? "Native client closed during connect with error"
+            : "Native client closed during connect",
+        ),
+      );
+    }
+    this.stopPolling();
+    this.emit("close", hadError);
+  }
+
+  private onNativeError(message: string | undefined) {
+    this.failPendingConnect(new Error(message ?? "Native client error"));
+    this.emit("error", new Error(message ?? "Native client error"));
+  }
+
   getPeerCertificate(_detailed?: boolean): {
     fingerprint?: string;
     fingerprint256?: string;
@@ -300,6 +442,9 @@ export class NativeSocketAdapter extends EventEmitter {
         protocol?: string;
         cipher?: string;
         authorized?: boolean;
+        sessionReused?: boolean;
+        ktlsSend?: boolean;
+        ktlsRecv?: boolean;
         peerFingerprint?: string;
         peerFingerprint256?: string;
       }
@@ -330,7 +475,12 @@ export class NativeSocketAdapter extends EventEmitter {
       clearTimeout(this.idleTimer);
       this.idleTimer = undefined;
     }
-    if (!this.idleTimeoutMs || this.idleTimeoutMs <= 0 || this.destroyed) {
+    if (
+      this.nativeIdle ||
+      !this.idleTimeoutMs ||
+      this.idleTimeoutMs <= 0 ||
+      this.destroyed
+    ) {
       return;
     }
     this.idleTimer = setTimeout(() => {
@@ -0,0 +1,122 @@
+/**
+ * Reader for the lws server's `metrics.stream` WebSocket (subprotocol
+ * "qwormhole-stats" on the metrics port). The server opens with a JSON
+ * schema naming its fields, then sends a binary frame every `intervalMs`:
+ * a version byte, a flags byte (1 on the first frame), two zero bytes and
+ * a little-endian f64 wall-clock stamp, followed by zigzag varint deltas.
+ * There is one delta per global field, then a count of changed connections
+ * with a varint handle and one delta per connection field each, then a
+ * count of closed handles and the handles. Browser-safe: no Buffer.
+ */
+export const STATS_STREAM_PROTOCOL = "qwormhole-stats";
+const STATS_STREAM_VERSION = 1;
+
+export type NativeStatsStreamSchema = {
+  type: "qw:stats-schema";
+  version: number;
+  intervalMs: number;
+  global: string[];
+  connection: string[];
+};
+
+export type NativeStatsFrame = {
+  atMs: number;
+  first: boolean;
+  /** Running values, keyed by schema field. */
+  global: Record<string, number>;
+  /** Every open connection's running values, keyed by handle. */
+  connections: Map<number, Record<string, number>>;
+  /** Handles this frame changed, and those that closed since the last. */
+  changed: number[];
+  closed: number[];
+};
+
+/** Sums one subscription's deltas back into values. */
+export class NativeStatsStreamDecoder {
+  private readonly global: number[];
+  private readonly connections = new Map<number, number[]>();
+
+  constructor(readonly schema: NativeStatsStreamSchema) {
+    if (schema.version !== STATS_STREAM_VERSION) {
+      throw new Error(`Unsupported stats stream version ${schema.version}`);
+    }
+    this.global = schema.global.map(() => 0);
+  }
+
+  decode(message: ArrayBuffer | Uint8Array): NativeStatsFrame {
+    const bytes = message instanceof Uint8Array ? message : new Uint8Array(message);
+    const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+    if (bytes.length < 12 || bytes[0] !== STATS_STREAM_VERSION) {
+      throw new Error("Malformed stats stream frame");
+    }
+    let offset = 12;
+    // Varints carry up to 53 bits here, so no bitwise ops past 32.
+    const varint = (): number => {
+      let value = 0;
+      let scale = 1;
+      for (;;) {
+        if (offset >= bytes.length) throw new Error("Truncated stats stream frame");
+        const byte = bytes[offset++];
+        value += (byte & 0x7f) * scale;
+        if (byte < 0x80) return value;
+        scale *= 128;
+      }
+    };
+    const delta = (): number => {
+      const zigzag = varint();
+      return zigzag % 2 === 0 ? zigzag / 2 : -(zigzag + 1) / 2;
+    };
+
+    const { schema } = this;
+    for (let i = 0; i < schema.global.length; i += 1) this.global[i] += delta();
+    const changed: number[] = [];
+    for (let remaining = varint(); remaining > 0; remaining -= 1) {
+      const handle = varint();
+      const row = this.connections.get(handle) ?? schema.connection.map(() => 0);
+      for (let i = 0; i < schema.connection.length; i += 1) row[i] += delta();
+      this.connections.set(handle, row);
+      changed.push(handle);
+    }
+    const closed: number[] = [];
+    for (let remaining = varint(); remaining > 0; remaining -= 1) {
+      const handle = varint();
+      this.connections.delete(handle);
+      closed.push(handle);
+    }
+
+    const named = (fields: string[], values: number[]) =>
+      Object.fromEntries(fields.map((field, i) => [field, values[i]]));
+    return {
+      atMs: view.getFloat64(4, true),
+      first: (bytes[1] & 1) !== 0,
+      global: named(schema.global, this.global),
+      connections: new Map(
+        [...this.connections].map(([handle, row]) => [handle, named(schema.connection, row)]),
+      ),
+      changed,
+      closed,
+    };
+  }
+}
+
+/**
+ * Subscribe to `url` (ws://host:metricsPort/) and call `onFrame` with each
+ * decoded frame. Returns the socket; close() it to stop.
+ */
+export const openNativeStatsStream = (
+  url: string,
+  onFrame: (frame: NativeStatsFrame, schema: NativeStatsStreamSchema) => void,
+  WebSocketImpl: typeof WebSocket = globalThis.WebSocket,
+): WebSocket => {
+  const socket = new WebSocketImpl(url, STATS_STREAM_PROTOCOL);
+  socket.binaryType = "arraybuffer";
+  let decoder: NativeStatsStreamDecoder | undefined;
+  socket.addEventListener("message", event => {
+    if (typeof event.data === "string") {
+      decoder = new NativeStatsStreamDecoder(JSON.parse(event.data) as NativeStatsStreamSchema);
+    } else if (decoder) {
+      onFrame(decoder.decode(event.data as ArrayBuffer), decoder.schema);
+    }
+  });
+  return socket;
+};
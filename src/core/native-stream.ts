@@ -0,0 +1,79 @@
+import type { NativeStreamChunk } from "../types/types";
+
+/**
+ * Native `streaming` chunk layout, shared by the client and server
+ * wrappers. Each chunk is one length-prefixed frame flagged in its length
+ * word; its payload opens with the stream id (u32 big endian), a bits byte
+ * and three reserved bytes. Keep in step with kStreamChunk* in
+ * c/qwormhole_lws.cpp.
+ */
+export const STREAM_CHUNK_HEADER_BYTES = 8;
+export const STREAM_CHUNK_FIRST = 0x1;
+export const STREAM_CHUNK_LAST = 0x2;
+export const STREAM_CHUNK_ABORT = 0x4;
+export const DEFAULT_STREAM_CHUNK_BYTES = 256 * 1024;
+
+export type NativeStreamSource =
+  | AsyncIterable<Uint8Array | string>
+  | Iterable<Uint8Array | string>;
+
+/** A received chunk frame, header and all, as the event wrappers see it. */
+export const decodeStreamChunk = (frame: Buffer): NativeStreamChunk => {
+  const bits = frame[4] ?? 0;
+  return {
+    streamId: frame.length >= 4 ? frame.readUInt32BE(0) : 0,
+    first: (bits & STREAM_CHUNK_FIRST) !== 0,
+    last: (bits & STREAM_CHUNK_LAST) !== 0,
+    aborted: (bits & STREAM_CHUNK_ABORT) !== 0,
+    data: frame.subarray(STREAM_CHUNK_HEADER_BYTES),
+  };
+};
+
+/**
+ * Cut `source` into chunks of at most `chunkBytes` and hand each to
+ * `write` with its bits. One chunk is held back so that the last carries
+ * the end bit, which keeps memory at a chunk plus whatever the source
+ * yields at once. A false from `write` waits for `drained()` before the
+ * next chunk; an error from the source sends an abort chunk before it is
+ * rethrown.
+ */
+export const pumpStreamChunks = async (
+  source: NativeStreamSource,
+  chunkBytes: number,
+  write: (data: Buffer, bits: number) => boolean,
+  drained: () => Promise<void>,
+): Promise<void> => {
+  if (!Number.isInteger(chunkBytes) || chunkBytes <= 0) {
+    throw new RangeError("chunkBytes must be a positive integer");
+  }
+  let held: Buffer | undefined;
+  let bits = STREAM_CHUNK_FIRST;
+  const send = async (data: Buffer, extra: number): Promise<void> => {
+    const ok = write(data, bits | extra);
+    bits = 0;
+    // The last chunk only needs queueing; the caller sees drain as usual.
+    if (!ok && extra !== STREAM_CHUNK_LAST) await drained();
+  };
+  try {
+    for await (const piece of source) {
+      const bytes =
+        typeof piece === "string"
+          ? Buffer.from(piece)
+          : Buffer.from(piece.buffer, piece.byteOffset, piece.byteLength);
+      for (let at = 0; at < bytes.length; at += chunkBytes) {
+        if (held) await send(held, 0);
+        held = bytes.subarray(at, Math.min(at + chunkBytes, bytes.length));
+      }
+    }
+  } catch (err) {
+    if (bits === 0) {
+      try {
+        write(Buffer.alloc(0), STREAM_CHUNK_ABORT);
+      } catch {
+        // Closed as well: the peer sees the stream end with the connection.
+      }
+    }
+    throw err;
+  }
+  await send(held ?? Buffer.alloc(0), STREAM_CHUNK_LAST);
+};
@@ -0,0 +1,75 @@
+import type { NativeRxTimestamps } from "../types/types";
+
+/**
+ * syncClock() probes, shared by the libsocket server that sends them and
+ * the client that answers. Both ends spell them as JSON whatever their
+ * serializers: `{"type":"qw:clock","probe":n}` out, and the same with the
+ * client's receive and reply times (`t2`, `t3`, microseconds since the
+ * epoch) back, so either side spots one by its first bytes.
+ */
+export const CLOCK_PROBE_TYPE = "qw:clock";
+const CLOCK_PROBE_PREFIX = Buffer.from(`{"type":"${CLOCK_PROBE_TYPE}"`);
+
+export type ClockProbeMessage = { probe: number; t2?: number; t3?: number };
+
+/** This process's wall clock in microseconds since the epoch. */
+export const wallClockUs = (): number =>
+  (performance.timeOrigin + performance.now()) * 1000;
+
+export const encodeClockProbe = (probe: number): Buffer =>
+  Buffer.from(JSON.stringify({ type: CLOCK_PROBE_TYPE, probe }));
+
+export const encodeClockReply = (probe: number, t2: number, t3: number): Buffer =>
+  Buffer.from(JSON.stringify({ type: CLOCK_PROBE_TYPE, probe, t2, t3 }));
+
+/** The probe or reply in `data`, or undefined for any other frame. */
+export const readClockProbe = (data: Buffer): ClockProbeMessage | undefined => {
+  if (
+    data.length < CLOCK_PROBE_PREFIX.length ||
+    data.compare(CLOCK_PROBE_PREFIX, 0, CLOCK_PROBE_PREFIX.length, 0, CLOCK_PROBE_PREFIX.length) !== 0
+  ) {
+    return undefined;
+  }
+  try {
+    const parsed = JSON.parse(data.toString("utf8")) as Record<string, unknown>;
+    if (typeof parsed.probe !== "number") return undefined;
+    return {
+      probe: parsed.probe,
+      t2: typeof parsed.t2 === "number" ? parsed.t2 : undefined,
+      t3: typeof parsed.t3 === "number" ? parsed.t3 : undefined,
+    };
+  } catch {
+    return undefined;
+  }
+};
+
+export type NativeLatencySplit = {
+  /** The peer's send to the kernel's receive stamp: its stack and the path. */
+  wireMs: number;
+  /** The receive stamp to the addon's read: socket buffer and wakeup. */
+  kernelMs: number;
+  /** The read to the batch leaving the addon's loop: framing and batching. */
+  nativeMs: number;
+  /** Hand-off to JS to `receivedUs`: TSFN queueing and the event loop. */
+  jsMs: number;
+};
+
+/**
+ * One message's one-way latency cut at each of its `timestamps`. `sentUs`
+ * is on the sender's clock and `offsetUs` (syncClock(), sender minus here)
+ * moves it onto this one; a sender in this process needs none.
+ */
+export const splitLatency = (
+  sentUs: number,
+  timestamps: NativeRxTimestamps,
+  receivedUs: number = wallClockUs(),
+  offsetUs = 0,
+): NativeLatencySplit => {
+  const kernelUs = timestamps.kernelUs ?? timestamps.nativeUs;
+  return {
+    wireMs: (kernelUs - (sentUs - offsetUs)) / 1000,
+    kernelMs: (timestamps.nativeUs - kernelUs) / 1000,
+    nativeMs: (timestamps.emittedUs - timestamps.nativeUs) / 1000,
+    jsMs: (receivedUs - timestamps.emittedUs) / 1000,
+  };
+};
@@ -1,4 +1,9 @@
 import { Buffer } from "node:buffer";
+import {
+  createNativePriorityScheduler,
+  type NativePriorityScheduler,
+  type NativePrioritySchedulerOptions,
+} from "./NativeTCPClient";
 
 export class TokenBucket {
   private tokens: number;
@@ -174,6 +179,83 @@ export class PriorityQueue<T> {
   }
 }
 
+/** What QWormholeClient needs of its send queue. */
+export interface MessageQueue<T> {
+  enqueue(data: T, priority?: number): void;
+  dequeue(): T | undefined;
+  dequeueMany(maxItems: number): T[];
+  readonly length: number;
+  clear(): void;
+  getStats(): PriorityQueueStats;
+  snapshot(options?: { reset?: boolean }): PriorityQueueStats;
+  /**
+   * Set when the queue gates itself on a rate: ms until the next message may
+   * leave. dequeueMany() returns fewer (or none) until then.
+   */
+  waitMs?(): number;
+}
+
+/**
+ * PriorityQueue over the lws addon's PriorityScheduler: the same ordering
+ * and stats, with messages held natively in per-priority lanes and, given a
+ * rate, the token bucket applied as they leave.
+ */
+export class NativePriorityQueue implements MessageQueue<Buffer> {
+  private readonly native: NativePriorityScheduler;
+
+  constructor(native: NativePriorityScheduler) {
+    this.native = native;
+  }
+
+  enqueue(data: Buffer | string, priority = 0): void {
+    this.native.enqueue(
+      typeof data === "string" ? Buffer.from(data) : data,
+      priority,
+    );
+  }
+
+  dequeue(): Buffer | undefined {
+    return this.native.dequeue();
+  }
+
+  dequeueMany(maxItems: number): Buffer[] {
+    return this.native.dequeueMany(maxItems);
+  }
+
+  get length(): number {
+    return this.native.length();
+  }
+
+  clear(): void {
+    this.native.clear();
+  }
+
+  getStats(): PriorityQueueStats {
+    const { rateWaits: _rateWaits, ...stats } = this.native.getStats();
+    return stats;
+  }
+
+  snapshot(options?: { reset?: boolean }): PriorityQueueStats {
+    const stats = this.getStats();
+    if (options?.reset) {
+      this.native.resetStats();
+    }
+    return stats;
+  }
+
+  waitMs(): number {
+    return this.native.waitMs();
+  }
+}
+
+/** A NativePriorityQueue, or null when the lws binding is not loaded. */
+export const createNativePriorityQueue = (
+  options?: NativePrioritySchedulerOptions,
+): NativePriorityQueue | null => {
+  const native = createNativePriorityScheduler(options);
+  return native ? new NativePriorityQueue(native) : null;
+};
+
 export const delay = (ms: number) =>
   new Promise<void>(resolve => setTimeout(resolve, ms));
 
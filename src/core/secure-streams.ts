@@ -0,0 +1,159 @@
+import { EventEmitter } from "node:events";
+import type {
+  NativeSecureStreamEvent,
+  NativeSecureStreamsOptions,
+  NativeSecureStreamsStats,
+  NativeSecureStreamState,
+} from "../types/types";
+import { loadNativeSecureStreams, type NativeSecureStreamsHandle } from "./NativeTCPClient";
+
+/** Whether the lws addon loads and was built with Secure Streams. */
+export const isNativeSecureStreamsAvailable = (): boolean =>
+  Boolean(loadNativeSecureStreams());
+
+/**
+ * lws Secure Streams as a client mode: one lws context and service thread
+ * built from a JSON policy. Each open() is a stream of a policy streamtype,
+ * and the policy, not JS, decides its endpoint, TLS trust store, retry and
+ * backoff, and connection reuse. Trust stores are compiled once per
+ * context, and h2 streamtypes share one connection per endpoint. States and
+ * received data come back in one batch per service pass.
+ */
+export class NativeSecureStreams {
+  private readonly handle: NativeSecureStreamsHandle;
+  private readonly streams = new Map<number, SecureStream>();
+  private closed = false;
+
+  constructor(options: NativeSecureStreamsOptions) {
+    const SecureStreamsCtor = loadNativeSecureStreams();
+    if (!SecureStreamsCtor) {
+      throw new Error(
+        "Secure Streams require the libwebsockets backend built with -DLWS_WITH_SECURE_STREAMS=ON. Run `pnpm run rebuild`.",
+      );
+    }
+    const policy =
+      typeof options.policy === "string" ? options.policy : JSON.stringify(options.policy);
+    this.handle = new SecureStreamsCtor({ policy });
+    this.handle.setEventHandler(events => this.dispatch(events));
+  }
+
+  /**
+   * A stream of `streamtype`; `metadata` fills the policy's `${name}`
+   * substitutions before it first connects.
+   */
+  open(streamtype: string, options: { metadata?: Record<string, string> } = {}): SecureStream {
+    if (this.closed) throw new Error("Secure Streams context is closed");
+    const id = this.handle.create(streamtype, options.metadata);
+    if (id === undefined) throw new Error("Secure Streams context is closed");
+    const stream = new SecureStream(this.handle, id, streamtype, () => this.streams.delete(id));
+    this.streams.set(id, stream);
+    return stream;
+  }
+
+  /** Open streams. */
+  get streamCount(): number {
+    return this.streams.size;
+  }
+
+  getStats(): NativeSecureStreamsStats | undefined {
+    return this.handle.getStats();
+  }
+
+  /** Destroys every stream and the context. */
+  close(): void {
+    if (this.closed) return;
+    this.closed = true;
+    this.handle.close();
+    const streams = [...this.streams.values()];
+    this.streams.clear();
+    for (const stream of streams) stream.closed();
+  }
+
+  private dispatch(events: NativeSecureStreamEvent[]): void {
+    for (const event of events) {
+      this.streams.get(event.id)?.deliver(event);
+    }
+  }
+}
+
+/**
+ * One Secure Stream. Emits "state" (state, ack) on every lws state change,
+ * "data" (chunk, { som, eom }) per received chunk, "message" once a chunk
+ * with eom completes a message, "error" for a create or metadata failure,
+ * and "close" when the stream is destroyed.
+ */
+export class SecureStream extends EventEmitter {
+  state: NativeSecureStreamState = "creating";
+  private chunks: Buffer[] = [];
+  private done = false;
+
+  constructor(
+    private readonly handle: NativeSecureStreamsHandle,
+    readonly id: number,
+    readonly streamtype: string,
+    private readonly onClose: () => void,
+  ) {
+    super();
+  }
+
+  /** Queues one message (SOM..EOM); false once the stream is closed. */
+  write(data: Buffer | string): boolean {
+    if (this.done) return false;
+    return this.handle.write(this.id, data);
+  }
+
+  setMetadata(name: string, value: string): boolean {
+    if (this.done) return false;
+    return this.handle.setMetadata(this.id, name, value);
+  }
+
+  /** Asks for a tx slot, which connects per the policy when idle. */
+  requestTx(): void {
+    if (!this.done) this.handle.requestTx(this.id);
+  }
+
+  close(): void {
+    if (this.done) return;
+    this.handle.destroy(this.id);
+    this.closed();
+  }
+
+  /** @internal */
+  deliver(event: NativeSecureStreamEvent): void {
+    if (this.done) return;
+    switch (event.type) {
+      case "data":
+        this.emit("data", event.data, { som: event.som, eom: event.eom });
+        if (event.som) this.chunks = [];
+        this.chunks.push(event.data);
+        if (event.eom) {
+          const message =
+            this.chunks.length === 1 ? this.chunks[0] : Buffer.concat(this.chunks);
+          this.chunks = [];
+          this.emit("message", message);
+        }
+        return;
+      case "state":
+        this.state = event.state;
+        this.emit("state", event.state, event.ack);
+        if (event.state === "destroying") this.closed();
+        return;
+      case "error":
+        if (this.listenerCount("error") > 0) this.emit("error", new Error(event.error));
+        return;
+    }
+  }
+
+  /** @internal */
+  closed(): void {
+    if (this.done) return;
+    this.done = true;
+    this.chunks = [];
+    this.onClose();
+    this.emit("close");
+  }
+}
+
+/** A Secure Streams client context from `policy`. */
+export const createSecureStreams = (options: NativeSecureStreamsOptions): NativeSecureStreams =>
+  new NativeSecureStreams(options);
@@ -0,0 +1,331 @@
+import path from "node:path";
+import { Worker } from "node:worker_threads";
+import {
+  NATIVE_TELEMETRY_RECORD_FIELDS,
+  NativeTelemetryKind,
+  type NativeQWormholeServer,
+} from "./native-server";
+import {
+  createNativeCoherenceAccumulator,
+  type NativeCoherenceAccumulatorHandle,
+} from "./NativeTCPClient";
+import {
+  composeTransportCoherence,
+  type TransportCoherenceComponents,
+  type TransportCoherenceInput,
+  type TransportCoherenceRuntime,
+  type TransportCoherenceSnapshot,
+  type TransportFlushEvent,
+  type TransportSliceEvent,
+} from "./transport-coherence";
+
+/**
+ * The flush and backpressure histories computeTransportCoherence() reads,
+ * fed from drainNativeTransportTelemetry() records and capped at the last
+ * `historySize` of each. A pass's slice is its mean frame size.
+ */
+export class TransportTelemetryHistory {
+  private flushes: TransportFlushEvent[] = [];
+  private slices: TransportSliceEvent[] = [];
+  private backpressure: number[] = [];
+
+  constructor(private readonly historySize = 256) {}
+
+  ingest(records: Float64Array, count: number): void {
+    for (let i = 0; i < count; i += 1) {
+      const base = i * NATIVE_TELEMETRY_RECORD_FIELDS;
+      const kind = records[base];
+      const timestamp = records[base + 1];
+      if (kind === NativeTelemetryKind.Backpressure) {
+        this.backpressure.push(timestamp);
+        continue;
+      }
+      if (kind !== NativeTelemetryKind.Flush) continue;
+      const bytes = records[base + 2];
+      const frames = records[base + 3];
+      this.flushes.push({ timestamp, bytes, frames });
+      if (frames > 0) this.slices.push({ timestamp, size: Math.round(bytes / frames) });
+    }
+    this.flushes = this.cap(this.flushes);
+    this.slices = this.cap(this.slices);
+    this.backpressure = this.cap(this.backpressure);
+  }
+
+  input(): TransportCoherenceInput {
+    return {
+      sliceHistory: this.slices.slice(-this.historySize),
+      flushHistory: this.flushes.slice(-this.historySize),
+      backpressureHistory: this.backpressure.slice(-this.historySize),
+    };
+  }
+
+  // Trim in chunks so steady ingestion doesn't copy on every call.
+  private cap<T>(history: T[]): T[] {
+    return history.length > 2 * this.historySize
+      ? history.slice(-this.historySize)
+      : history;
+  }
+}
+
+/** The order CoherenceAccumulator.components() writes its fields in. */
+export const TRANSPORT_COHERENCE_COMPONENT_FIELDS = [
+  "sliceEntropy",
+  "flushIntervalEntropy",
+  "flushIntervalCv",
+  "frameCv",
+  "byteCv",
+  "bytesPerFrameCv",
+  "backpressureDensity",
+  "backpressureClustered",
+  "slices",
+  "flushes",
+  "flushIntervals",
+  "backpressure",
+] as const satisfies readonly (keyof TransportCoherenceComponents)[];
+
+/**
+ * TransportTelemetryHistory and measureTransportCoherence() kept
+ * incrementally in the lws addon: each record updates running sums,
+ * slice-size counts and interval histograms, and snapshot() costs the same
+ * however long the history, so coherence can be scored on every drain
+ * rather than once a second. Gaps are taken in arrival order (each batch
+ * merged by time), and interval entropy and the backpressure median are
+ * exact for whole-millisecond gaps under 64 ms and to 1/16 octave above.
+ * create() returns null without the lws addon.
+ */
+export class TransportCoherenceAccumulator {
+  private readonly out = new Float64Array(TRANSPORT_COHERENCE_COMPONENT_FIELDS.length);
+
+  private constructor(private readonly handle: NativeCoherenceAccumulatorHandle) {}
+
+  static create(historySize = 256): TransportCoherenceAccumulator | null {
+    const handle = createNativeCoherenceAccumulator(historySize);
+    return handle ? new TransportCoherenceAccumulator(handle) : null;
+  }
+
+  /** drainNativeTransportTelemetry() records already in JS. */
+  ingest(records: Float64Array, count: number): void {
+    this.handle.ingest(records, count);
+  }
+
+  /** The server's telemetry rings straight in; -1 once the token is stale. */
+  drain(token: string, maxRecords?: number): number {
+    return this.handle.drain(token, maxRecords);
+  }
+
+  components(): TransportCoherenceComponents {
+    this.handle.components(this.out);
+    const components = {} as TransportCoherenceComponents;
+    TRANSPORT_COHERENCE_COMPONENT_FIELDS.forEach((field, i) => {
+      components[field] = this.out[i];
+    });
+    return components;
+  }
+
+  snapshot(runtime?: TransportCoherenceRuntime): TransportCoherenceSnapshot {
+    return composeTransportCoherence(this.components(), runtime);
+  }
+
+  reset(): void {
+    this.handle.reset();
+  }
+}
+
+// One seqlock-guarded page: an Int32 sequence word, then Float64 fields.
+const FIELDS_OFFSET = 8;
+const FIELD_COUNT = 15;
+const BOARD_BYTES = FIELDS_OFFSET + FIELD_COUNT * 8;
+const READ_ATTEMPTS = 16;
+
+const Field = {
+  UpdatedAt: 0,
+  TransportSNI: 1,
+  TransportSPI: 2,
+  TransportMetastability: 3,
+  SliceEntropyInverse: 4,
+  FlushIntervalStability: 5,
+  BatchingRegularity: 6,
+  BackpressureBoundedness: 7,
+  RuntimeRegularity: 8,
+  PayloadRegularity: 9,
+  SliceEntropy: 10,
+  FlushIntervalEntropy: 11,
+  Flushes: 12,
+  Backpressure: 13,
+  Slices: 14,
+} as const;
+
+/**
+ * A published snapshot. Diagnostics stay in the worker: only the numbers
+ * cross the shared buffer.
+ */
+export type TransportCoherenceReading = Omit<
+  TransportCoherenceSnapshot,
+  "diagnostics" | "pathRegularity"
+> & {
+  seq: number;
+  updatedAt: number;
+};
+
+export const allocateTransportCoherenceBuffer = (): SharedArrayBuffer =>
+  new SharedArrayBuffer(BOARD_BYTES);
+
+const boardViews = (buffer: SharedArrayBuffer) => ({
+  seq: new Int32Array(buffer, 0, 1),
+  fields: new Float64Array(buffer, FIELDS_OFFSET, FIELD_COUNT),
+});
+
+/** Publish `snapshot`; the single writer is the coherence worker. */
+export const writeTransportCoherence = (
+  buffer: SharedArrayBuffer,
+  snapshot: TransportCoherenceSnapshot,
+): void => {
+  const { seq, fields } = boardViews(buffer);
+  Atomics.add(seq, 0, 1);
+  fields[Field.UpdatedAt] = Date.now();
+  fields[Field.TransportSNI] = snapshot.transportSNI;
+  fields[Field.TransportSPI] = snapshot.transportSPI;
+  fields[Field.TransportMetastability] = snapshot.transportMetastability;
+  fields[Field.SliceEntropyInverse] = snapshot.sliceEntropyInverse;
+  fields[Field.FlushIntervalStability] = snapshot.flushIntervalStability;
+  fields[Field.BatchingRegularity] = snapshot.batchingRegularity;
+  fields[Field.BackpressureBoundedness] = snapshot.backpressureBoundedness;
+  fields[Field.RuntimeRegularity] = snapshot.runtimeRegularity;
+  fields[Field.PayloadRegularity] = snapshot.payloadRegularity;
+  fields[Field.SliceEntropy] = snapshot.sliceEntropy;
+  fields[Field.FlushIntervalEntropy] = snapshot.flushIntervalEntropy;
+  fields[Field.Flushes] = snapshot.sampleCount.flushes;
+  fields[Field.Backpressure] = snapshot.sampleCount.backpressure;
+  fields[Field.Slices] = snapshot.sampleCount.slices;
+  Atomics.add(seq, 0, 1);
+  Atomics.notify(seq, 0);
+};
+
+/**
+ * The latest published snapshot, or null before the first one (or when
+ * the writer keeps the page busy for every attempt).
+ */
+export const readTransportCoherence = (
+  buffer: SharedArrayBuffer,
+): TransportCoherenceReading | null => {
+  const { seq, fields } = boardViews(buffer);
+  for (let attempt = 0; attempt < READ_ATTEMPTS; attempt += 1) {
+    const before = Atomics.load(seq, 0);
+    if (before === 0) return null;
+    if (before & 1) continue;
+    const copy = Float64Array.from(fields);
+    if (Atomics.load(seq, 0) !== before) continue;
+    return {
+      seq: before >>> 1,
+      updatedAt: copy[Field.UpdatedAt],
+      transportSNI: copy[Field.TransportSNI],
+      transportSPI: copy[Field.TransportSPI],
+      transportMetastability: copy[Field.TransportMetastability],
+      sliceEntropyInverse: copy[Field.SliceEntropyInverse],
+      flushIntervalStability: copy[Field.FlushIntervalStability],
+      batchingRegularity: copy[Field.BatchingRegularity],
+      backpressureBoundedness: copy[Field.BackpressureBoundedness],
+      runtimeRegularity: copy[Field.RuntimeRegularity],
+      payloadRegularity: copy[Field.PayloadRegularity],
+      sliceEntropy: copy[Field.SliceEntropy],
+      flushIntervalEntropy: copy[Field.FlushIntervalEntropy],
+      sampleCount: {
+        slices: copy[Field.Slices],
+        flushes: copy[Field.Flushes],
+        backpressure: copy[Field.Backpressure],
+      },
+    };
+  }
+  return null;
+};
+
+export type TransportCoherenceWorkerData = {
+  token: string;
+  buffer: SharedArrayBuffer;
+  intervalMs: number;
+  historySize: number;
+  drainRecords: number;
+  tracePath?: string;
+};
+
+export type TransportCoherencePipelineOptions = {
+  /** Records per service-thread ring (default 4096). */
+  capacity?: number;
+  /** How often the worker drains and recomputes (default 250 ms). */
+  intervalMs?: number;
+  /** Flushes and backpressure marks kept for scoring (default 256). */
+  historySize?: number;
+  /**
+   * Also append every drained record to this telemetry trace file
+   * (flush, backpressure and slice blocks; see TelemetryTraceRecorder).
+   */
+  tracePath?: string;
+  workerExecArgv?: string[];
+  /** The worker failed (e.g. no lws addon in its thread); it has exited. */
+  onError?: (error: Error) => void;
+};
+
+export type TransportCoherencePipeline = {
+  readonly buffer: SharedArrayBuffer;
+  /** The worker's latest snapshot; a few loads, no message round trip. */
+  read(): TransportCoherenceReading | null;
+  close(): Promise<void>;
+};
+
+const resolveWorkerEntry = (): string => {
+  const ext = path.extname(__filename) || ".js";
+  return path.join(__dirname, `transport-coherence-worker${ext}`);
+};
+
+/**
+ * Score a native server's transport coherence off the event loop. The
+ * service threads record their writable passes into per-thread rings
+ * (enableTransportTelemetry()); a worker drains them every `intervalMs`
+ * into a TransportCoherenceAccumulator (TransportTelemetryHistory and
+ * computeTransportCoherence() when the worker cannot load one) and
+ * publishes the snapshot into a shared buffer that read() polls. close()
+ * stops the worker and the recording.
+ */
+export const startTransportCoherencePipeline = (
+  server: Pick<
+    NativeQWormholeServer<unknown>,
+    "enableTransportTelemetry" | "disableTransportTelemetry"
+  >,
+  options: TransportCoherencePipelineOptions = {},
+): TransportCoherencePipeline => {
+  const capacity = options.capacity ?? 4096;
+  const token = server.enableTransportTelemetry({ capacity });
+  const buffer = allocateTransportCoherenceBuffer();
+  const entry = resolveWorkerEntry();
+  const workerData: TransportCoherenceWorkerData = {
+    token,
+    buffer,
+    intervalMs: Math.max(10, options.intervalMs ?? 250),
+    historySize: Math.max(8, options.historySize ?? 256),
+    drainRecords: capacity,
+    tracePath: options.tracePath,
+  };
+  const worker = new Worker(entry, {
+    workerData,
+    execArgv:
+      options.workerExecArgv ?? (entry.endsWith(".ts") ? ["--import", "tsx"] : []),
+  });
+  worker.unref();
+  worker.on("error", error => options.onError?.(error));
+  const exited = new Promise<void>(resolve => worker.once("exit", () => resolve()));
+
+  let closed = false;
+  return {
+    buffer,
+    read: () => readTransportCoherence(buffer),
+    async close() {
+      if (closed) return exited;
+      closed = true;
+      server.disableTransportTelemetry();
+      // Unref'd so it never holds the process open, but close() waits.
+      worker.ref();
+      worker.postMessage({ type: "stop" });
+      await exited;
+    },
+  };
+};
@@ -0,0 +1,84 @@
+import { parentPort, workerData } from "node:worker_threads";
+import {
+  drainNativeTransportTelemetry,
+  NATIVE_TELEMETRY_RECORD_FIELDS,
+  NativeTelemetryKind,
+} from "./native-server";
+import { computeTransportCoherence } from "./transport-coherence";
+import { TelemetryTraceRecorder } from "../telemetry/trace-recorder";
+import {
+  TransportCoherenceAccumulator,
+  TransportTelemetryHistory,
+  writeTransportCoherence,
+  type TransportCoherenceWorkerData,
+} from "./transport-coherence-pipeline";
+
+// Worker side of startTransportCoherencePipeline(): drain the server's
+// telemetry rings, rescore, publish. With the lws addon loaded here the
+// rings drain straight into a native accumulator (through JS only when
+// tracing) and rescoring is O(1). Exits when told to stop or once the
+// token goes stale (server closed).
+const { token, buffer, intervalMs, historySize, drainRecords, tracePath } =
+  workerData as TransportCoherenceWorkerData;
+
+const accumulator = TransportCoherenceAccumulator.create(historySize);
+const history = accumulator ? null : new TransportTelemetryHistory(historySize);
+const trace = tracePath ? new TelemetryTraceRecorder(tracePath) : null;
+const records = new Float64Array(drainRecords * NATIVE_TELEMETRY_RECORD_FIELDS);
+let published = false;
+
+const tick = () => {
+  let drained = 0;
+  // A full buffer means more may be queued; a few passes, not a spin.
+  for (let pass = 0; pass < 8; pass += 1) {
+    const count =
+      accumulator && !trace
+        ? accumulator.drain(token, drainRecords)
+        : drainNativeTransportTelemetry(token, records);
+    if (count < 0) {
+      stop();
+      return;
+    }
+    if (trace) {
+      accumulator?.ingest(records, count);
+      recordTrace(trace, count);
+    }
+    history?.ingest(records, count);
+    drained += count;
+    if (count < drainRecords) break;
+  }
+  // Nothing new since the last snapshot: leave it published as is.
+  if (drained === 0 && published) return;
+  published = true;
+  writeTransportCoherence(
+    buffer,
+    accumulator ? accumulator.snapshot() : computeTransportCoherence(history!.input()),
+  );
+};
+
+const timer = setInterval(tick, intervalMs);
+
+function recordTrace(recorder: TelemetryTraceRecorder, count: number) {
+  for (let i = 0; i < count; i += 1) {
+    const base = i * NATIVE_TELEMETRY_RECORD_FIELDS;
+    const atMs = records[base + 1];
+    if (records[base] === NativeTelemetryKind.Backpressure) {
+      recorder.record("backpressure", [atMs]);
+      continue;
+    }
+    const bytes = records[base + 2];
+    const frames = records[base + 3];
+    recorder.record("flush", [atMs, bytes, frames]);
+    if (frames > 0) recorder.record("slice", [atMs, Math.round(bytes / frames)]);
+  }
+}
+
+function stop() {
+  clearInterval(timer);
+  trace?.close();
+  parentPort?.close();
+}
+
+parentPort?.on("message", (message: { type?: string }) => {
+  if (message?.type === "stop") stop();
+});
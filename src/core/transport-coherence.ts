@@ -17,6 +17,14 @@ export interface TransportCoherenceInput {
   gcPauseMaxMs?: number;
   payloadEntropy?: number;
   payloadNegentropy?: number;
+  /** Measured TCP path (TCP_INFO), when a native connection reports one. */
+  path?: {
+    rttUs: number;
+    rttVarUs: number;
+    minRttUs: number;
+    cwnd: number;
+    lost: number;
+  };
 }
 
 export interface TransportCoherenceSnapshot {
@@ -29,6 +37,11 @@ export interface TransportCoherenceSnapshot {
   backpressureBoundedness: number;
   runtimeRegularity: number;
   payloadRegularity: number;
+  /**
+   * 1 for a quiet path: RTT near its floor, little jitter, nothing lost in
+   * the window. Only with a measured `path`.
+   */
+  pathRegularity?: number;
   sliceEntropy: number;
   flushIntervalEntropy: number;
   sampleCount: {
@@ -41,60 +54,113 @@ export interface TransportCoherenceSnapshot {
 
 const EPS = 1e-9;
 
+/**
+ * The windowed measures computeTransportCoherence() scores, before any
+ * weighting: what measureTransportCoherence() takes from the histories and
+ * what a native CoherenceAccumulator keeps incrementally.
+ */
+export interface TransportCoherenceComponents {
+  sliceEntropy: number;
+  flushIntervalEntropy: number;
+  flushIntervalCv: number;
+  frameCv: number;
+  byteCv: number;
+  bytesPerFrameCv: number;
+  /** Backpressure marks per flush, capped at 1. */
+  backpressureDensity: number;
+  /** Share of backpressure gaps within max(5, median / 2) ms. */
+  backpressureClustered: number;
+  slices: number;
+  flushes: number;
+  flushIntervals: number;
+  backpressure: number;
+}
+
+/** What composeTransportCoherence() reads besides the components. */
+export type TransportCoherenceRuntime = Pick<
+  TransportCoherenceInput,
+  "eluIdleRatioAvg" | "gcPauseMaxMs" | "payloadEntropy" | "payloadNegentropy" | "path"
+>;
+
 export function computeTransportCoherence(
   input: TransportCoherenceInput,
 ): TransportCoherenceSnapshot {
-  const diagnostics: string[] = [];
+  return composeTransportCoherence(measureTransportCoherence(input), input);
+}
+
+/** The components of `input`'s histories; O(n log n) per call. */
+export function measureTransportCoherence(
+  input: TransportCoherenceInput,
+): TransportCoherenceComponents {
   const sliceSizes = finite(input.sliceHistory.map((entry) => entry.size));
   const flushes = input.flushHistory
     .filter((entry) => Number.isFinite(entry.timestamp) && entry.timestamp > 0)
     .sort((a, b) => a.timestamp - b.timestamp);
   const backpressureHistory = finite(input.backpressureHistory).sort((a, b) => a - b);
 
-  const sliceEntropy = normalizedDiscreteEntropy(sliceSizes);
-  const sliceEntropyInverse = clamp01(1 - sliceEntropy);
-  if (sliceSizes.length < 2) diagnostics.push("slice_history_under_sampled");
-
   const flushIntervals = diff(flushes.map((entry) => entry.timestamp));
-  const flushIntervalEntropy = normalizedQuantizedEntropy(flushIntervals);
-  const flushIntervalCv = coefficientOfVariation(flushIntervals);
-  const flushIntervalStability = clamp01(
-    1 - 0.55 * flushIntervalEntropy - 0.45 * clamp01(flushIntervalCv / 1.25),
-  );
-  if (flushIntervals.length < 2) diagnostics.push("flush_history_under_sampled");
-
   const frameCounts = finite(flushes.map((entry) => entry.frames));
   const byteCounts = finite(flushes.map((entry) => entry.bytes));
   const bytesPerFrame = flushes
     .filter((entry) => entry.frames > 0)
     .map((entry) => entry.bytes / entry.frames)
     .filter((value) => Number.isFinite(value) && value > 0);
+
+  return {
+    sliceEntropy: normalizedDiscreteEntropy(sliceSizes),
+    flushIntervalEntropy: normalizedQuantizedEntropy(flushIntervals),
+    flushIntervalCv: coefficientOfVariation(flushIntervals),
+    frameCv: coefficientOfVariation(frameCounts),
+    byteCv: coefficientOfVariation(byteCounts),
+    bytesPerFrameCv: coefficientOfVariation(bytesPerFrame),
+    backpressureDensity:
+      flushes.length > 0 ? clamp01(backpressureHistory.length / flushes.length) : 0,
+    backpressureClustered: backpressureClusterRatio(diff(backpressureHistory)),
+    slices: sliceSizes.length,
+    flushes: flushes.length,
+    flushIntervals: flushIntervals.length,
+    backpressure: backpressureHistory.length,
+  };
+}
+
+/** Scores `components`; O(1), so it can run per flush. */
+export function composeTransportCoherence(
+  components: TransportCoherenceComponents,
+  runtime: TransportCoherenceRuntime = {},
+): TransportCoherenceSnapshot {
+  const diagnostics: string[] = [];
+  const { sliceEntropy, flushIntervalEntropy, flushIntervalCv } = components;
+
+  const sliceEntropyInverse = clamp01(1 - sliceEntropy);
+  if (components.slices < 2) diagnostics.push("slice_history_under_sampled");
+
+  const flushIntervalStability = clamp01(
+    1 - 0.55 * flushIntervalEntropy - 0.45 * clamp01(flushIntervalCv / 1.25),
+  );
+  if (components.flushIntervals < 2) diagnostics.push("flush_history_under_sampled");
+
   const batchingRegularity = clamp01(
     1 -
       mean([
-        clamp01(coefficientOfVariation(frameCounts) / 1.4),
-        clamp01(coefficientOfVariation(byteCounts) / 1.4),
-        clamp01(coefficientOfVariation(bytesPerFrame) / 1.1),
+        clamp01(components.frameCv / 1.4),
+        clamp01(components.byteCv / 1.4),
+        clamp01(components.bytesPerFrameCv / 1.1),
       ]),
   );
-  if (flushes.length < 3) diagnostics.push("batching_under_sampled");
+  if (components.flushes < 3) diagnostics.push("batching_under_sampled");
 
-  const backpressureDensity =
-    flushes.length > 0 ? clamp01(backpressureHistory.length / flushes.length) : 0;
-  const backpressureIntervals = diff(backpressureHistory);
-  const clusteredBackpressure = backpressureClusterRatio(backpressureIntervals);
   const backpressureBoundedness = clamp01(
-    1 - 0.6 * backpressureDensity - 0.4 * clusteredBackpressure,
+    1 - 0.6 * components.backpressureDensity - 0.4 * components.backpressureClustered,
   );
-  if (!backpressureHistory.length) diagnostics.push("backpressure_idle");
+  if (!components.backpressure) diagnostics.push("backpressure_idle");
 
   const runtimeRegularity = clamp01(
-    0.65 * clamp01(input.eluIdleRatioAvg ?? 0.5) +
-      0.35 * (1 - clamp01((input.gcPauseMaxMs ?? 0) / 40)),
+    0.65 * clamp01(runtime.eluIdleRatioAvg ?? 0.5) +
+      0.35 * (1 - clamp01((runtime.gcPauseMaxMs ?? 0) / 40)),
   );
   const payloadRegularity = resolvePayloadRegularity(
-    input.payloadEntropy,
-    input.payloadNegentropy,
+    runtime.payloadEntropy,
+    runtime.payloadNegentropy,
   );
 
   const transportSNI = clamp01(
@@ -120,6 +186,11 @@ export function computeTransportCoherence(
       0.2 * clamp01(flushIntervalCv / 1.5),
   );
 
+  const pathRegularity = runtime.path ? resolvePathRegularity(runtime.path) : undefined;
+  if (pathRegularity !== undefined) {
+    diagnostics.push(`path_regularity:${pathRegularity.toFixed(3)}`);
+  }
+
   diagnostics.push(`transport_sni:${transportSNI.toFixed(3)}`);
   diagnostics.push(`transport_spi:${transportSPI.toFixed(3)}`);
   diagnostics.push(`transport_meta:${transportMetastability.toFixed(3)}`);
@@ -134,12 +205,13 @@ export function computeTransportCoherence(
     backpressureBoundedness,
     runtimeRegularity,
     payloadRegularity,
+    pathRegularity,
     sliceEntropy,
     flushIntervalEntropy,
     sampleCount: {
-      slices: sliceSizes.length,
-      flushes: flushes.length,
-      backpressure: backpressureHistory.length,
+      slices: components.slices,
+      flushes: components.flushes,
+      backpressure: components.backpressure,
     },
     diagnostics,
   };
@@ -158,6 +230,17 @@ function resolvePayloadRegularity(
   return 0.5;
 }
 
+function resolvePathRegularity(
+  path: NonNullable<TransportCoherenceInput["path"]>,
+): number {
+  if (!(path.rttUs > 0)) return 0.5;
+  const jitter = clamp01(path.rttVarUs / path.rttUs);
+  const inflation =
+    path.minRttUs > 0 ? clamp01((path.rttUs - path.minRttUs) / path.rttUs) : 0;
+  const loss = path.cwnd > 0 ? clamp01(path.lost / path.cwnd) : 0;
+  return clamp01(1 - 0.4 * jitter - 0.4 * inflation - 0.2 * loss);
+}
+
 function backpressureClusterRatio(intervals: number[]): number {
   if (intervals.length <= 1) return intervals.length ? 0.25 : 0;
   const medianInterval = percentile(intervals, 0.5);
@@ -202,6 +202,25 @@ export function deriveEntropyPolicy(metrics: EntropyMetrics): EntropyPolicy {
   }
 }
 
+/**
+ * Policy rows for each mode threshold, highest first. This is the table the
+ * native server's handshake responder evaluates in place of deriveEntropyPolicy.
+ */
+export function buildEntropyPolicyTable(): Array<
+  EntropyPolicy & { minNIndex: number; admit: boolean }
+> {
+  return [
+    ENTROPY_THRESHOLDS.TRUST_ZERO,
+    ENTROPY_THRESHOLDS.TRUST_LIGHT,
+    ENTROPY_THRESHOLDS.IMMUNE,
+    0,
+  ].map(minNIndex => ({
+    minNIndex,
+    admit: true,
+    ...deriveEntropyPolicy({ negIndex: minNIndex }),
+  }));
+}
+
 /**
  * Compute entropy metrics from handshake nIndex
  */
@@ -1,5 +1,6 @@
 import {
   createHash,
+  createHmac,
   createPrivateKey,
   createPublicKey,
   generateKeyPairSync,
@@ -173,6 +174,93 @@ export function verifyNegentropicHandshake(hs: unknown): boolean {
   );
 }
 
+export interface NegentropicHandshakeAck {
+  type: "handshake-ack";
+  ts: number;
+  publicKey: string;
+  signature: string;
+  policy: Record<string, unknown>;
+  version?: string;
+  nonce?: string;
+  nIndex?: number;
+  negHash?: string;
+  /** With `nativeHandshake.resumption` and TLS exporter material. */
+  resume?: { token: string; expires: number };
+}
+
+export interface ResumedHandshakeParams {
+  /** The `resume` field of a verified ack. */
+  resume: { token: string; expires: number };
+  /** The handshake the token was issued for. */
+  handshake: Pick<NegentropicHandshake, "publicKey" | "negHash" | "nIndex">;
+  /** TLS exporter material of the new connection, as the server exports it. */
+  keyMaterial: Buffer;
+  version?: string;
+}
+
+/**
+ * Build a handshake that resumes a native-server session: no signature, just
+ * an HMAC keyed by the ack's token over this connection's exporter material.
+ */
+export function createResumedHandshake(
+  params: ResumedHandshakeParams,
+): Record<string, unknown> {
+  const resumeProof = createHmac(
+    "sha256",
+    Buffer.from(params.resume.token, "base64"),
+  )
+    .update(params.keyMaterial)
+    .digest("base64");
+  return {
+    type: "handshake",
+    version: params.version,
+    ts: Date.now(),
+    publicKey: params.handshake.publicKey,
+    negHash: params.handshake.negHash,
+    nIndex: params.handshake.nIndex,
+    resumeExpires: params.resume.expires,
+    resumeProof,
+  };
+}
+
+/**
+ * Verify a `handshake-ack` from the native server's handshake responder.
+ * Pass `expectedPublicKey` (base64 SPKI DER) to pin the server key, and
+ * `expectedNonce` to bind the ack to the handshake that was sent.
+ */
+export function verifyHandshakeAck(
+  ack: unknown,
+  expected: { publicKey?: string; nonce?: string } = {},
+): ack is NegentropicHandshakeAck {
+  if (!ack || typeof ack !== "object") return false;
+  const { signature, ...unsigned } = ack as Record<string, unknown>;
+  if (
+    unsigned.type !== "handshake-ack" ||
+    typeof unsigned.publicKey !== "string" ||
+    typeof signature !== "string"
+  ) {
+    return false;
+  }
+  if (expected.publicKey && unsigned.publicKey !== expected.publicKey) {
+    return false;
+  }
+  if (expected.nonce && unsigned.nonce !== expected.nonce) return false;
+  try {
+    return verify(
+      null,
+      Buffer.from(canonicalizeRecord(unsigned)),
+      createPublicKey({
+        key: Buffer.from(unsigned.publicKey, "base64"),
+        format: "der",
+        type: "spki",
+      }),
+      Buffer.from(signature, "base64"),
+    );
+  } catch {
+    return false;
+  }
+}
+
 export function isNegentropicHandshake(
   payload: unknown,
 ): payload is NegentropicHandshake {
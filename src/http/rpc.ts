@@ -1,7 +1,15 @@
-import { randomUUID } from "node:crypto";
 import type { QWormholeClient } from "../client";
 import type { QWormholeServer } from "../server";
-import type { QWEnvelope, QWormholeServerConnection, QWormholeRequest, QWormholeResponse } from "../types/types";
+import type { NativeTcpClient } from "../core/NativeTCPClient";
+import type { NativeQWormholeServer } from "../core/native-server";
+import { nextIdString } from "../utils/ids";
+import type {
+  NativeGatewayRequest,
+  QWEnvelope,
+  QWormholeServerConnection,
+  QWormholeRequest,
+  QWormholeResponse,
+} from "../types/types";
 
 export interface RpcResponse {
   status: QWormholeResponse;
@@ -88,10 +96,9 @@ const cleanup = (id: string) => {
 
   return {
     request: (req: QWormholeRequest, body?: Uint8Array, timeoutMs = 5000) => {
-      const id =
-        typeof randomUUID === "function"
-          ? randomUUID()
-          : Math.random().toString(36).slice(2);
+      // Only matched against this client's pending map, so it needs to be
+      // unique in the process, not unguessable.
+      const id = nextIdString();
       const envelope: QWEnvelope = { v: 1, kind: "request", id, req, body };
       return new Promise<RpcResponse>((resolve, reject) => {
         const timer =
@@ -181,3 +188,167 @@ export const attachRpcServer = (
   };
 };
 
+
+/**
+ * Binary RPC frames, as the lws client's native `rpc` mode reads and writes
+ * them: a 16-byte big-endian header (version 1, kind, u16 status, four
+ * reserved bytes, u64 request id) and the body. Status 0 is reserved for
+ * native timeouts.
+ */
+export const RPC_HEADER_BYTES = 16;
+const RPC_VERSION = 1;
+const RPC_KINDS = { request: 1, response: 2 } as const;
+
+export type RpcFrameKind = keyof typeof RPC_KINDS;
+
+export interface RpcFrame {
+  kind: RpcFrameKind;
+  status: number;
+  id: bigint;
+  body: Buffer;
+}
+
+export const encodeRpcFrame = (
+  kind: RpcFrameKind,
+  id: bigint,
+  status = 0,
+  body?: Uint8Array,
+): Buffer => {
+  const frame = Buffer.alloc(RPC_HEADER_BYTES + (body?.length ?? 0));
+  frame[0] = RPC_VERSION;
+  frame[1] = RPC_KINDS[kind];
+  frame.writeUInt16BE(status, 2);
+  frame.writeBigUInt64BE(id, 8);
+  if (body) frame.set(body, RPC_HEADER_BYTES);
+  return frame;
+};
+
+/** Null for anything that is not an RPC frame. */
+export const decodeRpcFrame = (frame: Buffer): RpcFrame | null => {
+  if (frame.length < RPC_HEADER_BYTES || frame[0] !== RPC_VERSION) return null;
+  const kind =
+    frame[1] === RPC_KINDS.request ? "request" : frame[1] === RPC_KINDS.response ? "response" : null;
+  if (!kind) return null;
+  return {
+    kind,
+    status: frame.readUInt16BE(2),
+    id: frame.readBigUInt64BE(8),
+    body: frame.subarray(RPC_HEADER_BYTES),
+  };
+};
+
+export interface BinaryRpcResponse {
+  status: number;
+  body?: Uint8Array;
+}
+
+export type BinaryRpcHandler = (
+  body: Buffer,
+  ctx: RpcHandlerContext,
+) => Promise<BinaryRpcResponse> | BinaryRpcResponse;
+
+export interface BinaryRpcClient {
+  request(body: Uint8Array, timeoutMs?: number): Promise<BinaryRpcResponse>;
+}
+
+/**
+ * RPC over a native client connected with `rpc: true` and length-prefixed
+ * framing. Ids, deadlines and matching are native; responses with status
+ * 400 and up reject, as attachRpcClient's do.
+ */
+export const attachNativeRpcClient = (client: NativeTcpClient): BinaryRpcClient => ({
+  request: async (body: Uint8Array, timeoutMs = 5000) => {
+    const payload = Buffer.isBuffer(body)
+      ? body
+      : Buffer.from(body.buffer, body.byteOffset, body.byteLength);
+    const res = await client.rpcRequest(payload, timeoutMs);
+    if (res.status >= 400) {
+      throw new Error(res.body.length > 0 ? res.body.toString() : `RPC error ${res.status}`);
+    }
+    return { status: res.status, body: res.body };
+  },
+});
+
+/**
+ * Answer binary RPC requests arriving on a length-prefixed server whose
+ * messages are raw Buffers. Non-RPC messages are left to other listeners.
+ * Returns an unsubscribe function.
+ */
+export const attachBinaryRpcServer = (
+  server: QWormholeServer<Buffer>,
+  handler: BinaryRpcHandler,
+): (() => void) => {
+  const onMessage = async ({
+    client,
+    data,
+  }: {
+    client: QWormholeServerConnection;
+    data: Buffer;
+  }) => {
+    const frame = Buffer.isBuffer(data) ? decodeRpcFrame(data) : null;
+    if (!frame || frame.kind !== "request") return;
+    if (client.backpressured) {
+      await client.send(encodeRpcFrame("response", frame.id, 503, Buffer.from("Server under load")));
+      return;
+    }
+    try {
+      const res = await handler(frame.body, { client });
+      await client.send(encodeRpcFrame("response", frame.id, res.status, res.body));
+    } catch (err) {
+      const message = err instanceof Error ? err.message : String(err);
+      await client.send(encodeRpcFrame("response", frame.id, 500, Buffer.from(message)));
+    }
+  };
+
+  server.on("message", onMessage as never);
+
+  return () => {
+    server.off("message", onMessage as never);
+  };
+};
+
+export interface GatewayRpcContext {
+  /** The request path, gateway.path included. */
+  path: string;
+  contentType?: string;
+}
+
+export type GatewayRpcHandler = (
+  body: Buffer,
+  ctx: GatewayRpcContext,
+) => Promise<BinaryRpcResponse> | BinaryRpcResponse;
+
+/**
+ * Answer the HTTP/2 streams of a native lws server's `gateway` with
+ * `handler`, one call per stream. Each batch's calls all start before any
+ * of them is awaited; a throw becomes a 500 with the message as its body.
+ * Responses carry `contentType` (default application/octet-stream).
+ * Returns an unsubscribe function.
+ */
+export const attachGatewayRpcServer = (
+  server: NativeQWormholeServer<unknown>,
+  handler: GatewayRpcHandler,
+  options: { contentType?: string } = {},
+): (() => void) => {
+  const answer = async (request: NativeGatewayRequest) => {
+    try {
+      const res = await handler(request.body, {
+        path: request.path,
+        contentType: request.contentType,
+      });
+      server.respondGateway(request.id, res.status, res.body, options.contentType);
+    } catch (err) {
+      const message = err instanceof Error ? err.message : String(err);
+      server.respondGateway(request.id, 500, message, "text/plain; charset=utf-8");
+    }
+  };
+  const onRequests = (requests: NativeGatewayRequest[]) => {
+    for (const request of requests) void answer(request);
+  };
+
+  server.on("gatewayRequests", onRequests);
+
+  return () => {
+    server.off("gatewayRequests", onRequests);
+  };
+};
@@ -15,3 +15,4 @@ export * from './client';
 export * from './transports';
 export * from './utils';
 export * from './security';
+export * from './telemetry';
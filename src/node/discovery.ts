@@ -5,15 +5,31 @@ import { EventEmitter } from "events";
 import { Peer} from "../types";
 import type { QWormholeNode } from "./node-runtime";
 import mdns from 'multicast-dns';
+import {
+  getNativeDiscovery,
+  type NativeDiscoveryHandle,
+  type NativeDiscoveryStats,
+} from "../core/NativeTCPClient";
 
 export interface DiscoveryConfig {
   port: number;           // UDP port
   intervalMs?: number;    // broadcast interval
   magic?: string;         // to avoid cross-talk with other systems
+  // Native responder (libsocket addon): multicast announcements, filtered,
+  // deduplicated and batched off the event loop. Replaces the broadcast
+  // socket and mDNS; falls back to them without the addon.
+  native?: boolean;
+  group?: string;          // multicast group (default 239.255.67.71)
+  interface?: string;      // interface to join the group on
+  batchMs?: number;        // longest a new peer waits to share a batch
+  dedupeWindowMs?: number; // an unchanged peer is reported once per window
 }
 
+type NativeAnnouncement = { data: Buffer; address: string; port: number };
+
 export class DiscoveryModule extends EventEmitter {
   private socket: dgram.Socket | null = null;
+  private native: NativeDiscoveryHandle | null = null;
   private timer?: NodeJS.Timeout;
 
   constructor(
@@ -26,7 +42,8 @@ export class DiscoveryModule extends EventEmitter {
   }
 
   start() {
-    if (this.socket) return;
+    if (this.socket || this.native) return;
+    if (this.cfg.native && this.startNative()) return;
 
     this.socket = dgram.createSocket("udp4");
     const mdnsInstance = mdns();
@@ -81,37 +98,7 @@ export class DiscoveryModule extends EventEmitter {
       });
     });
 
-    this.socket.on("message", (msg, rinfo) => {
-      try {
-        const parsed = JSON.parse(msg.toString());
-        if (parsed.magic !== this.cfg.magic) return;
-        if (!parsed.id || !parsed.host || !parsed.port) return;
-
-        const peer: Peer = {
-          id: parsed.id,
-          host: parsed.host,
-          port: parsed.port,
-          address: `${parsed.host}:${parsed.port}`,
-          negentropicIndex: parsed.negentropicIndex,
-          lastSeen: Date.now(),
-          meta: parsed.meta,
-          origin: parsed.origin ?? "",
-          sigil: parsed.sigil ?? "",
-          ed25519PublicKey: parsed.ed25519PublicKey ?? "",
-          x25519PublicKey: parsed.x25519PublicKey ?? "",
-          trustLevel: parsed.trustLevel ?? 0,
-          latency: parsed.latency ?? 0,
-        };
-
-
-        // notify node
-        this.emit("peer:discovered", peer);
-        this.node.emit("discovery:message", { peer, rinfo });
-
-      } catch (err) {
-        this.node.emit("discovery:error", { err });
-      }
-    });
+    this.socket.on("message", (msg, rinfo) => this.handleAnnouncement(msg, rinfo));
 
     this.socket.bind(this.cfg.port, () => {
       this.socket!.setBroadcast(true);
@@ -126,10 +113,42 @@ export class DiscoveryModule extends EventEmitter {
     this.timer = setInterval(() => this.broadcastSelf(), this.cfg.intervalMs);
   }
 
-  private broadcastSelf() {
-    if (!this.socket) return;
+  private handleAnnouncement(msg: Buffer, rinfo: { address: string; port: number }) {
+    try {
+      const parsed = JSON.parse(msg.toString());
+      if (parsed.magic !== this.cfg.magic) return;
+      if (!parsed.id || !parsed.host || !parsed.port) return;
+
+      const peer: Peer = {
+        id: parsed.id,
+        host: parsed.host,
+        port: parsed.port,
+        address: `${parsed.host}:${parsed.port}`,
+        negentropicIndex: parsed.negentropicIndex,
+        lastSeen: Date.now(),
+        meta: parsed.meta,
+        origin: parsed.origin ?? "",
+        sigil: parsed.sigil ?? "",
+        ed25519PublicKey: parsed.ed25519PublicKey ?? "",
+        x25519PublicKey: parsed.x25519PublicKey ?? "",
+        trustLevel: parsed.trustLevel ?? 0,
+        latency: parsed.latency ?? 0,
+      };
+
+
+      // notify node
+      this.emit("peer:discovered", peer);
+      this.node.emit("discovery:message", { peer, rinfo });
+
+    } catch (err) {
+      this.node.emit("discovery:error", { err });
+    }
+  }
+
+  // The magic goes first, so the native responder can match it as a prefix.
+  private announcement(): Buffer {
     const self = this.node.getSelfPeer();
-    const packet = Buffer.from(JSON.stringify({
+    return Buffer.from(JSON.stringify({
       magic: this.cfg.magic,
       id: self.id,
       host: self.host,
@@ -138,6 +157,55 @@ export class DiscoveryModule extends EventEmitter {
       meta: self.meta,
       ts: Date.now(),
     }));
+  }
+
+  private startNative(): boolean {
+    const Discovery = getNativeDiscovery();
+    if (!Discovery) return false;
+    const native = new Discovery({
+      group: this.cfg.group,
+      port: this.cfg.port,
+      interface: this.cfg.interface,
+      prefix: `{"magic":${JSON.stringify(this.cfg.magic)},`,
+      intervalMs: this.cfg.intervalMs,
+      batchMs: this.cfg.batchMs,
+      dedupeWindowMs: this.cfg.dedupeWindowMs,
+    });
+    native.emit = (event: string, payload?: unknown) => {
+      if (event === "peers") {
+        for (const { data, address, port } of payload as NativeAnnouncement[]) {
+          this.handleAnnouncement(data, { address, port });
+        }
+      }
+      return true;
+    };
+    this.native = native;
+    native.start().then(
+      address => {
+        this.node.emit("discovery:ready", { port: address.port, group: address.group });
+        this.refreshAnnouncement();
+      },
+      err => this.node.emit("discovery:error", { err }),
+    );
+    return true;
+  }
+
+  /**
+   * Re-reads the self peer for the native responder's announcement, which
+   * it otherwise repeats unchanged every interval.
+   */
+  refreshAnnouncement() {
+    this.native?.announce(this.announcement());
+  }
+
+  /** Native responder counters; undefined on the dgram path. */
+  getStats(): NativeDiscoveryStats | undefined {
+    return this.native?.getStats();
+  }
+
+  private broadcastSelf() {
+    if (!this.socket) return;
+    const packet = this.announcement();
 
     // LAN broadcast – can later add multicast or directed sends
     this.socket.send(packet, 0, packet.length, this.cfg.port, "255.255.255.255");
@@ -146,6 +214,10 @@ export class DiscoveryModule extends EventEmitter {
 
   stop() {
     if (this.timer) clearInterval(this.timer);
+    if (this.native) {
+      this.native.close();
+      this.native = null;
+    }
     if (this.socket) {
       this.socket.close();
       this.socket = null;
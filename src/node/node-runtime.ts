@@ -37,6 +37,7 @@ export interface NodeConfig {
   host: string; // local listening host
   port: number; // local listening port for QWormhole server
   discoveryPort?: number; // UDP port for discovery
+  nativeDiscovery?: boolean; // multicast responder in the libsocket addon
   transport?: "tcp" | "ws" | "kcp";
   url?: string; // for ws
   seeds?: string[]; // ["host:port", ...]
@@ -77,6 +78,7 @@ export class QWormholeNode extends EventEmitter {
     this.gossip = new GossipModule(this.peers);
     this.discovery = new DiscoveryModule(this, {
       port: cfg.discoveryPort ?? 43_221,
+      native: cfg.nativeDiscovery,
     });
 
     this.discovery.on("peer:discovered", (peer: Peer) => {
@@ -7,6 +7,7 @@
  */
 
 import * as fs from "node:fs/promises";
+import { mkdirSync } from "node:fs";
 import * as path from "node:path";
 import os from "node:os";
 const homedir =
@@ -14,6 +15,9 @@ const homedir =
     ? os.homedir()
     : "";
 import { CoherenceThresholds, Peer } from "../types/sigilnet.types";
+import { openPeerStore, type PeerStore, type PeerStoreOptions } from "./peer-store";
+
+export { openPeerStore, type PeerStore, type PeerStoreOptions, type PeerStoreStats } from "./peer-store";
 
 /**
  * Default coherence thresholds for field validation
@@ -34,6 +38,14 @@ export const DEFAULT_COHERENCE_THRESHOLDS: CoherenceThresholds = {
 export interface PeerRegistryOptions {
   registryPath?: string;
   coherenceThresholds?: CoherenceThresholds;
+  /**
+   * "json" (the default) rewrites one JSON file on every change. "log"
+   * keeps peers in a PeerStore, keyed by origin: each change appends one
+   * record and startup opens the index instead of parsing every peer.
+   */
+  storage?: "json" | "log";
+  /** Compaction settings and native opt-out for the "log" store. */
+  store?: PeerStoreOptions;
 }
 
 export interface PeerRegistryInterface {
@@ -61,21 +73,43 @@ export class PeerRegistry implements PeerRegistryInterface {
   public peers: Map<string, Peer> = new Map();
   private registryPath: string;
   private coherenceThresholds: CoherenceThresholds;
+  private readonly storage: "json" | "log";
+  private readonly storeOptions?: PeerStoreOptions;
+  private logStore?: PeerStore;
+  // With the log store, `peers` caches what has been read so far.
+  private loadedAll = false;
 
   constructor(
-    registryPath?: string,
+    registryPathOrOptions?: string | PeerRegistryOptions,
     coherenceThresholds?: CoherenceThresholds,
   ) {
+    const options =
+      typeof registryPathOrOptions === "object"
+        ? registryPathOrOptions
+        : { registryPath: registryPathOrOptions };
+    this.storage = options.storage ?? "json";
+    this.storeOptions = options.store;
     this.registryPath =
-      registryPath || path.join(homedir, ".sigilnet", "peers.json");
+      options.registryPath ||
+      path.join(
+        homedir,
+        ".sigilnet",
+        this.storage === "log" ? "peers.qwpeers" : "peers.json",
+      );
     this.coherenceThresholds =
-      coherenceThresholds || DEFAULT_COHERENCE_THRESHOLDS;
+      coherenceThresholds ||
+      options.coherenceThresholds ||
+      DEFAULT_COHERENCE_THRESHOLDS;
   }
 
   /**
    * Initialize the registry (load from disk)
    */
   async initialize(): Promise<void> {
+    if (this.storage === "log") {
+      console.log(`Opened peer store with ${this.store().stats().count} peers`);
+      return;
+    }
     try {
       const data = await fs.readFile(this.registryPath, "utf-8");
       const peersArray: Peer[] = JSON.parse(data);
@@ -95,6 +129,14 @@ export class PeerRegistry implements PeerRegistryInterface {
    * Save the registry to disk
    */
   async save(): Promise<void> {
+    if (this.storage === "log") {
+      const store = this.store();
+      for (const [origin, peer] of this.peers) {
+        store.put(origin, JSON.stringify(peer));
+      }
+      store.sync();
+      return;
+    }
     const dir = path.dirname(this.registryPath);
     await fs.mkdir(dir, { recursive: true, mode: 0o700 });
 
@@ -112,20 +154,27 @@ export class PeerRegistry implements PeerRegistryInterface {
       ...peer,
       lastSeen: Date.now(),
     });
-    await this.save();
+    await this.persist(peer.origin);
   }
 
   /**
    * Get a peer by origin
    */
   getPeer(origin: string): Peer | undefined {
-    return this.peers.get(origin);
+    const cached = this.peers.get(origin);
+    if (cached || this.storage !== "log" || this.loadedAll) return cached;
+    const stored = this.store().get(origin);
+    if (!stored) return undefined;
+    const peer: Peer = JSON.parse(stored.toString("utf-8"));
+    this.peers.set(origin, peer);
+    return peer;
   }
 
   /**
    * Get all peers
    */
   getAllPeers(): Peer[] {
+    this.loadAll();
     return Array.from(this.peers.values());
   }
 
@@ -133,6 +182,7 @@ export class PeerRegistry implements PeerRegistryInterface {
    * Get trusted peers (trust level >= threshold)
    */
   getTrustedPeers(minTrustLevel = 0.5): Peer[] {
+    this.loadAll();
     return Array.from(this.peers.values()).filter(
       p => p.trustLevel >= minTrustLevel,
     );
@@ -142,10 +192,10 @@ export class PeerRegistry implements PeerRegistryInterface {
    * Update peer's last seen timestamp
    */
   async updateLastSeen(origin: string): Promise<void> {
-    const peer = this.peers.get(origin);
+    const peer = this.getPeer(origin);
     if (peer) {
       peer.lastSeen = Date.now();
-      await this.save();
+      await this.persist(origin);
     }
   }
 
@@ -153,10 +203,10 @@ export class PeerRegistry implements PeerRegistryInterface {
    * Update peer's trust level
    */
   async updateTrustLevel(origin: string, trustLevel: number): Promise<void> {
-    const peer = this.peers.get(origin);
+    const peer = this.getPeer(origin);
     if (peer) {
       peer.trustLevel = Math.max(0, Math.min(1, trustLevel));
-      await this.save();
+      await this.persist(origin);
     }
   }
 
@@ -165,6 +215,9 @@ export class PeerRegistry implements PeerRegistryInterface {
    */
   async removePeer(origin: string): Promise<boolean> {
     const deleted = this.peers.delete(origin);
+    if (this.storage === "log") {
+      return this.store().delete(origin) || deleted;
+    }
     if (deleted) {
       await this.save();
     }
@@ -226,29 +279,68 @@ export class PeerRegistry implements PeerRegistryInterface {
     const now = Date.now();
     let removed = 0;
 
+    this.loadAll();
     for (const [origin, peer] of this.peers.entries()) {
       if (now - peer.lastSeen > staleAfterMs) {
         this.peers.delete(origin);
+        this.logStore?.delete(origin);
         removed++;
       }
     }
 
-    if (removed > 0) {
+    if (removed > 0 && this.storage === "json") {
       await this.save();
     }
 
     return removed;
   }
+
+  /**
+   * Close the log store; the JSON registry has nothing open
+   */
+  close(): void {
+    this.logStore?.close();
+    this.logStore = undefined;
+    this.loadedAll = false;
+  }
+
+  private store(): PeerStore {
+    if (!this.logStore) {
+      mkdirSync(path.dirname(this.registryPath), { recursive: true, mode: 0o700 });
+      this.logStore = openPeerStore(this.registryPath, this.storeOptions);
+    }
+    return this.logStore;
+  }
+
+  // One peer's change: a rewrite of the JSON file, or one appended record.
+  private async persist(origin: string): Promise<void> {
+    const peer = this.peers.get(origin);
+    if (this.storage === "json") {
+      await this.save();
+    } else if (peer) {
+      this.store().put(origin, JSON.stringify(peer));
+    }
+  }
+
+  private loadAll(): void {
+    if (this.storage !== "log" || this.loadedAll) return;
+    for (const [origin, value] of this.store().entries()) {
+      if (!this.peers.has(origin)) {
+        this.peers.set(origin, JSON.parse(value.toString("utf-8")));
+      }
+    }
+    this.loadedAll = true;
+  }
 }
 
 /**
  * Convenience function to create and initialize a peer registry
  */
 export async function createPeerRegistry(
-  registryPath?: string,
+  registryPathOrOptions?: string | PeerRegistryOptions,
   coherenceThresholds?: CoherenceThresholds,
 ): Promise<PeerRegistry> {
-  const registry = new PeerRegistry(registryPath, coherenceThresholds);
+  const registry = new PeerRegistry(registryPathOrOptions, coherenceThresholds);
   await registry.initialize();
   return registry;
 }
@@ -0,0 +1,245 @@
+import fs from "node:fs";
+import {
+  createNativePeerStore,
+  type NativePeerStore,
+  type NativePeerStoreOptions,
+  type NativePeerStoreStats,
+} from "../core/NativeTCPClient";
+
+// The record log the lws addon's PeerStore writes: a 32-byte header
+// ("QWPEERS1", version, generation), then records of a 16-byte header
+// (magic, key bytes, value bytes or 0xffffffff for a delete, FNV-1a of key
+// and value), the key and the value. The native store keeps its index in a
+// mapped `<path>.idx`; this one rebuilds it in memory on open.
+const LOG_MAGIC = Buffer.from("QWPEERS1", "latin1");
+const LOG_HEADER_BYTES = 32;
+const RECORD_HEADER_BYTES = 16;
+const RECORD_MAGIC = 0x52505751;
+const TOMBSTONE = 0xffffffff;
+const VERSION = 1;
+
+export type PeerStoreOptions = NativePeerStoreOptions & {
+  /** false keeps the JS store even with the lws addon loaded. */
+  native?: boolean;
+};
+
+export type PeerStore = NativePeerStore;
+export type PeerStoreStats = NativePeerStoreStats;
+
+const checksum = (key: Buffer, value: Buffer | null): number => {
+  let hash = 0x811c9dc5;
+  for (const bytes of value ? [key, value] : [key]) {
+    for (let i = 0; i < bytes.length; i += 1) {
+      hash = Math.imul(hash ^ bytes[i], 0x01000193) >>> 0;
+    }
+  }
+  return hash;
+};
+
+type Slot = { offset: number; length: number };
+
+/** The native PeerStore's log format, indexed by a Map. */
+class FilePeerStore implements PeerStore {
+  private fd: number;
+  private generation: number;
+  private logBytes: number;
+  private liveBytes = 0;
+  private compactions = 0;
+  private readonly index = new Map<string, Slot>();
+  private readonly compactRatio: number;
+  private readonly compactMinBytes: number;
+
+  constructor(
+    private readonly path: string,
+    options: NativePeerStoreOptions = {},
+  ) {
+    this.compactRatio = Math.min(1, Math.max(0, options.compactRatio ?? 0.5));
+    this.compactMinBytes = Math.max(0, options.compactMinBytes ?? 64 * 1024);
+    this.fd = fs.openSync(path, fs.existsSync(path) ? "r+" : "w+", 0o600);
+    const log = fs.readFileSync(path);
+    if (log.length === 0) {
+      this.generation = Date.now();
+      fs.writeSync(this.fd, this.encodeHeader(this.generation), 0, LOG_HEADER_BYTES, 0);
+      this.logBytes = LOG_HEADER_BYTES;
+      return;
+    }
+    if (
+      log.length < LOG_HEADER_BYTES ||
+      !log.subarray(0, 8).equals(LOG_MAGIC) ||
+      log.readUInt32LE(8) !== VERSION
+    ) {
+      fs.closeSync(this.fd);
+      throw new Error("PeerStore: not a peer store");
+    }
+    this.generation = Number(log.readBigUInt64LE(16));
+    this.logBytes = this.scan(log);
+    // A torn or corrupt record ends the log.
+    if (this.logBytes < log.length) fs.ftruncateSync(this.fd, this.logBytes);
+  }
+
+  get(key: string): Buffer | null {
+    this.checkOpen();
+    const slot = this.index.get(key);
+    if (!slot) return null;
+    const keyBytes = Buffer.byteLength(key);
+    const value = Buffer.alloc(slot.length - RECORD_HEADER_BYTES - keyBytes);
+    fs.readSync(this.fd, value, 0, value.length, slot.offset + RECORD_HEADER_BYTES + keyBytes);
+    return value;
+  }
+
+  put(key: string, value: Buffer | string): void {
+    this.append(key, Buffer.isBuffer(value) ? value : Buffer.from(value));
+    this.maybeCompact();
+  }
+
+  delete(key: string): boolean {
+    if (!this.index.has(key)) return false;
+    this.append(key, null);
+    this.maybeCompact();
+    return true;
+  }
+
+  keys(): string[] {
+    return this.ordered().map(([key]) => key);
+  }
+
+  entries(): Array<[string, Buffer]> {
+    return this.ordered().map(([key]) => [key, this.get(key) as Buffer]);
+  }
+
+  /** Rewrites the log with only live records, swapped in with a rename. */
+  compact(): void {
+    this.checkOpen();
+    const nextPath = `${this.path}.compact`;
+    const next = fs.openSync(nextPath, "w+", 0o600);
+    const moved = new Map<string, Slot>();
+    let offset = LOG_HEADER_BYTES;
+    try {
+      fs.writeSync(next, this.encodeHeader(this.generation + 1), 0, LOG_HEADER_BYTES, 0);
+      for (const [key, slot] of this.ordered()) {
+        const record = Buffer.alloc(slot.length);
+        fs.readSync(this.fd, record, 0, slot.length, slot.offset);
+        fs.writeSync(next, record, 0, record.length, offset);
+        moved.set(key, { offset, length: slot.length });
+        offset += slot.length;
+      }
+      fs.fdatasyncSync(next);
+      fs.renameSync(nextPath, this.path);
+    } catch (error) {
+      fs.closeSync(next);
+      fs.rmSync(nextPath, { force: true });
+      throw error;
+    }
+    fs.closeSync(this.fd);
+    this.fd = next;
+    this.index.clear();
+    moved.forEach((slot, key) => this.index.set(key, slot));
+    this.generation += 1;
+    this.logBytes = offset;
+    this.compactions += 1;
+  }
+
+  sync(): void {
+    this.checkOpen();
+    fs.fdatasyncSync(this.fd);
+  }
+
+  stats(): PeerStoreStats {
+    return {
+      count: this.index.size,
+      logBytes: this.logBytes,
+      liveBytes: this.liveBytes,
+      capacity: this.index.size,
+      generation: this.generation,
+      compactions: this.compactions,
+    };
+  }
+
+  close(): void {
+    if (this.fd < 0) return;
+    fs.fdatasyncSync(this.fd);
+    fs.closeSync(this.fd);
+    this.fd = -1;
+  }
+
+  private checkOpen() {
+    if (this.fd < 0) throw new Error("PeerStore: peer store is closed");
+  }
+
+  private encodeHeader(generation: number): Buffer {
+    const header = Buffer.alloc(LOG_HEADER_BYTES);
+    LOG_MAGIC.copy(header, 0);
+    header.writeUInt32LE(VERSION, 8);
+    header.writeBigUInt64LE(BigInt(generation), 16);
+    return header;
+  }
+
+  // Indexes every whole record; returns where the valid log ends.
+  private scan(log: Buffer): number {
+    let offset = LOG_HEADER_BYTES;
+    while (offset + RECORD_HEADER_BYTES <= log.length) {
+      if (log.readUInt32LE(offset) !== RECORD_MAGIC) break;
+      const keyBytes = log.readUInt32LE(offset + 4);
+      const valueBytes = log.readUInt32LE(offset + 8);
+      const tombstone = valueBytes === TOMBSTONE;
+      const length = RECORD_HEADER_BYTES + keyBytes + (tombstone ? 0 : valueBytes);
+      if (offset + length > log.length) break;
+      const keyStart = offset + RECORD_HEADER_BYTES;
+      const key = log.subarray(keyStart, keyStart + keyBytes);
+      const value = tombstone ? null : log.subarray(keyStart + keyBytes, offset + length);
+      if (checksum(key, value) !== log.readUInt32LE(offset + 12)) break;
+      this.applyRecord(key.toString(), offset, length, tombstone);
+      offset += length;
+    }
+    return offset;
+  }
+
+  private append(key: string, value: Buffer | null) {
+    this.checkOpen();
+    const keyBytes = Buffer.from(key);
+    const record = Buffer.alloc(RECORD_HEADER_BYTES + keyBytes.length + (value?.length ?? 0));
+    record.writeUInt32LE(RECORD_MAGIC, 0);
+    record.writeUInt32LE(keyBytes.length, 4);
+    record.writeUInt32LE(value ? value.length : TOMBSTONE, 8);
+    record.writeUInt32LE(checksum(keyBytes, value), 12);
+    keyBytes.copy(record, RECORD_HEADER_BYTES);
+    value?.copy(record, RECORD_HEADER_BYTES + keyBytes.length);
+    fs.writeSync(this.fd, record, 0, record.length, this.logBytes);
+    this.applyRecord(key, this.logBytes, record.length, value === null);
+    this.logBytes += record.length;
+  }
+
+  private applyRecord(key: string, offset: number, length: number, tombstone: boolean) {
+    const previous = this.index.get(key);
+    if (previous) this.liveBytes -= previous.length;
+    if (tombstone) {
+      this.index.delete(key);
+      return;
+    }
+    this.index.set(key, { offset, length });
+    this.liveBytes += length;
+  }
+
+  private ordered(): Array<[string, Slot]> {
+    return [...this.index].sort(([, a], [, b]) => a.offset - b.offset);
+  }
+
+  private maybeCompact() {
+    const body = this.logBytes - LOG_HEADER_BYTES;
+    const dead = body - this.liveBytes;
+    if (dead >= this.compactMinBytes && dead > this.compactRatio * body) this.compact();
+  }
+}
+
+/**
+ * A PeerStore over `path`: the lws addon's, with its index memory-mapped
+ * beside the log, when it is loaded, and a JS store over the same log
+ * otherwise.
+ */
+export const openPeerStore = (path: string, options: PeerStoreOptions = {}): PeerStore => {
+  const { native, ...storeOptions } = options;
+  return (
+    (native === false ? null : createNativePeerStore(path, storeOptions)) ??
+    new FilePeerStore(path, storeOptions)
+  );
+};
@@ -204,7 +204,11 @@ export const shouldForceTsSecureServer = <TMessage>(
   options: QWormholeServerOptions<TMessage>,
 ): boolean => {
   const resolved = applyQWormholeServerSecurityDefaults(options);
+  // The native lws responder verifies and acks handshakes itself.
+  const nativeHandshake = Boolean(resolved.nativeHandshake);
   return Boolean(
-    resolved.tls?.enabled || resolved.verifyHandshake || resolved.protocolVersion,
+    resolved.tls?.enabled ||
+      resolved.verifyHandshake ||
+      (resolved.protocolVersion && !nativeHandshake),
   );
 };
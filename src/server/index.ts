@@ -25,6 +25,7 @@ import {
   type FlowController,
 } from "../core/flow-controller";
 import { LengthPrefixedFramer } from "../core/framing";
+import { getNativeHandshakeValidator } from "../core/NativeTCPClient";
 import { PriorityQueue, TokenBucket, delay } from "../core/qos";
 import type { EntropyMetrics } from "../handshake/entropy-policy";
 import {
@@ -36,11 +37,12 @@ import {
   isNegentropicHandshake,
   verifyNegentropicHandshake,
 } from "../handshake/negentropic-handshake";
-import { handshakePayloadSchema } from "../schema/scp";
+import { handshakePayloadSchema, negentropicHandshakeSchema } from "../schema/scp";
 import { applyQWormholeServerSecurityDefaults } from "../security/env";
 import { QWormholeError } from "../utils/errors";
 import { inferMessageType } from "../utils/negentropic-diagnostics";
 import { TypedEventEmitter } from "../utils/typedEmitter";
+import { toUnixSocketPath } from "../utils/netUtils";
 
 const randomId = () =>
   typeof randomUUID === "function"
@@ -150,16 +152,26 @@ export class QWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
     });
   }
 
+  /** Unix-socket listeners report family "unix" with the path as address. */
   async listen(): Promise<net.AddressInfo> {
+    const unixPath = this.options.path;
     return new Promise((resolve, reject) => {
       this.server.listen(
-        {
-          host: this.options.host,
-          port: this.options.port,
-          reusePort: this.options.reusePort,
-        },
+        unixPath
+          ? { path: toUnixSocketPath(unixPath) }
+          : {
+              host: this.options.host,
+              port: this.options.port,
+              reusePort: this.options.reusePort,
+              ipv6Only: this.options.ipv6Only,
+              backlog: this.options.listenBacklog,
+            },
         () => {
-          const address = this.server.address();
+          const bound = this.server.address();
+          const address =
+            unixPath && typeof bound === "string"
+              ? { address: unixPath, family: "unix", port: 0 }
+              : bound;
           if (!address || typeof address === "string") {
             reject(
               new Error(
@@ -224,6 +236,18 @@ export class QWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
     }
   }
 
+  /** Send one payload to a subset of connections; returns how many were found. */
+  broadcastTo(ids: Iterable<string>, payload: Payload): number {
+    let sent = 0;
+    for (const id of ids) {
+      const client = this.clients.get(id);
+      if (!client) continue;
+      void client.send(payload);
+      sent += 1;
+    }
+    return sent;
+  }
+
   async shutdown(gracefulMs = 1000): Promise<void> {
     await this.close(gracefulMs);
   }
@@ -236,6 +260,15 @@ export class QWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
     return this.clients.size;
   }
 
+  /**
+   * Serve a socket accepted elsewhere, e.g. one a routing primary handed
+   * over through child_process IPC, as if this server's listener took it.
+   */
+  adoptSocket(socket: net.Socket): boolean {
+    this.server.emit("connection", socket);
+    return true;
+  }
+
   /**
    * Record a failed handshake attempt with TTL-based cleanup
    */
@@ -469,6 +502,7 @@ export class QWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
       socket,
       remoteAddress: socket.remoteAddress ?? undefined,
       remotePort: socket.remotePort ?? undefined,
+      remoteFamily: socket.remoteFamily ?? undefined,
       send: (payload: Payload, options?: SendOptions) =>
         this.write(connection, payload, options).catch(err => {
           this.emit("error", err);
@@ -722,6 +756,7 @@ export class QWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
       rateLimitBurstBytes:
         secured.rateLimitBurstBytes ?? secured.rateLimitBytesPerSec,
       maxClients: secured.maxClients ?? undefined,
+      listenBacklog: secured.listenBacklog,
       onTelemetry: secured.onTelemetry,
       allowConnection: secured.allowConnection,
       serializer: secured.serializer ?? defaultSerializer,
@@ -736,6 +771,7 @@ export class QWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
       },
       onAuthorizeConnection: secured.onAuthorizeConnection,
       verifyHandshake: secured.verifyHandshake,
+      strictHandshake: secured.strictHandshake ?? false,
       tls: secured.tls,
       coherence: secured.coherence ?? undefined,
       disableFlowController: secured.disableFlowController ?? false,
@@ -749,14 +785,27 @@ export class QWormholeServer<TMessage = Buffer> extends TypedEventEmitter<
   ): boolean {
     let verified = false;
     try {
-      const parsedPayload = JSON.parse(data.toString("utf8"));
-      const parsedResult = handshakePayloadSchema.safeParse(parsedPayload);
+      // strictHandshake: the addon's compiled schemas turn malformed frames
+      // away before JSON.parse; Zod below still applies the same ones.
+      const nativeProblem = this.options.strictHandshake
+        ? getNativeHandshakeValidator()?.(data)
+        : null;
+      const parsedPayload = nativeProblem ? undefined : JSON.parse(data.toString("utf8"));
+      const schema =
+        this.options.strictHandshake &&
+        parsedPayload?.publicKey !== undefined &&
+        parsedPayload?.resumeProof === undefined
+          ? negentropicHandshakeSchema
+          : handshakePayloadSchema;
+      const parsedResult = nativeProblem
+        ? { success: false as const }
+        : schema.safeParse(parsedPayload);
       if (!parsedResult.success) {
         this.emit(
           "error",
           new QWormholeError(
             "E_INVALID_HANDSHAKE_PAYLOAD",
-            "Invalid handshake payload",
+            nativeProblem ?? "Invalid handshake payload",
           ),
         );
         this.clients.delete(connection.id);
@@ -104,6 +104,24 @@ export function deriveSharedSecret(
   return encodeBase64(sharedSecret);
 }
 
+const SEAL_KEY_LABEL = decodeUTF8("qwormhole/native-seal/v1");
+
+/**
+ * Derive the 32-byte key for the native `seal` stage from the same X25519
+ * pair. Hashed under its own label so the transport cipher never shares a
+ * key with encryptPayload's box.
+ */
+export function deriveSealKey(
+  mySecretKey: string,
+  theirPublicKey: string,
+): string {
+  const shared = decodeBase64(deriveSharedSecret(mySecretKey, theirPublicKey));
+  const input = new Uint8Array(SEAL_KEY_LABEL.length + shared.length);
+  input.set(SEAL_KEY_LABEL);
+  input.set(shared, SEAL_KEY_LABEL.length);
+  return encodeBase64(nacl.hash(input).subarray(0, 32));
+}
+
 /**
  * Encrypt a payload using a shared secret
  *
@@ -160,6 +178,126 @@ export function decryptPayload(
   }
 }
 
+/**
+ * Per-peer box keys: nacl.box.before() for each (my secret, their public)
+ * pair, computed once and kept in a bounded LRU, so encrypting for a known
+ * peer costs XSalsa20-Poly1305 only rather than a scalar multiplication
+ * per message. Output is the same as nacl.box().
+ */
+export class PeerCryptoCache {
+  private readonly keys = new Map<string, Uint8Array>();
+  private hits = 0;
+  private misses = 0;
+
+  constructor(readonly capacity = 1024) {}
+
+  /** The shared box key for the pair, derived on first use. */
+  sharedKey(myX25519SecretKey: string, theirX25519PublicKey: string): Uint8Array {
+    const id = `${theirX25519PublicKey}\0${myX25519SecretKey}`;
+    const known = this.keys.get(id);
+    if (known) {
+      this.hits += 1;
+      // Re-inserted to mark it most recently used.
+      this.keys.delete(id);
+      this.keys.set(id, known);
+      return known;
+    }
+    this.misses += 1;
+    const shared = nacl.box.before(
+      decodeBase64(theirX25519PublicKey),
+      decodeBase64(myX25519SecretKey),
+    );
+    this.keys.set(id, shared);
+    if (this.keys.size > this.capacity) {
+      this.keys.delete(this.keys.keys().next().value!);
+    }
+    return shared;
+  }
+
+  encrypt(
+    data: string | object,
+    myX25519SecretKey: string,
+    theirX25519PublicKey: string,
+  ): EncryptedPayload {
+    return this.encryptMany([data], myX25519SecretKey, theirX25519PublicKey)[0];
+  }
+
+  /** One key lookup for the whole batch; a fresh nonce per payload. */
+  encryptMany(
+    items: ReadonlyArray<string | object>,
+    myX25519SecretKey: string,
+    theirX25519PublicKey: string,
+  ): EncryptedPayload[] {
+    const shared = this.sharedKey(myX25519SecretKey, theirX25519PublicKey);
+    return items.map(data => {
+      const message = typeof data === "string" ? data : JSON.stringify(data);
+      const nonce = nacl.randomBytes(nacl.box.nonceLength);
+      return {
+        ciphertext: encodeBase64(nacl.box.after(decodeUTF8(message), nonce, shared)),
+        nonce: encodeBase64(nonce),
+      };
+    });
+  }
+
+  decrypt(
+    encrypted: EncryptedPayload,
+    myX25519SecretKey: string,
+    theirX25519PublicKey: string,
+  ): string | null {
+    return this.decryptMany([encrypted], myX25519SecretKey, theirX25519PublicKey)[0];
+  }
+
+  /** Null for each payload that fails to open, as decryptFromPeer(). */
+  decryptMany(
+    items: ReadonlyArray<EncryptedPayload>,
+    myX25519SecretKey: string,
+    theirX25519PublicKey: string,
+  ): Array<string | null> {
+    let shared: Uint8Array;
+    try {
+      shared = this.sharedKey(myX25519SecretKey, theirX25519PublicKey);
+    } catch {
+      return items.map(() => null);
+    }
+    return items.map(encrypted => {
+      try {
+        const decrypted = nacl.box.open.after(
+          decodeBase64(encrypted.ciphertext),
+          decodeBase64(encrypted.nonce),
+          shared,
+        );
+        return decrypted ? encodeUTF8(decrypted) : null;
+      } catch {
+        return null;
+      }
+    });
+  }
+
+  /** Drop one peer's keys, e.g. when its session ends. */
+  forgetPeer(theirX25519PublicKey: string): void {
+    const prefix = `${theirX25519PublicKey}\0`;
+    for (const id of [...this.keys.keys()]) {
+      if (id.startsWith(prefix)) this.keys.delete(id);
+    }
+  }
+
+  clear(): void {
+    this.keys.clear();
+  }
+
+  getStats(): { size: number; capacity: number; hits: number; misses: number } {
+    return {
+      size: this.keys.size,
+      capacity: this.capacity,
+      hits: this.hits,
+      misses: this.misses,
+    };
+  }
+}
+
+/** The cache encryptForPeer() and decryptFromPeer() share. */
+export const peerCryptoCache = new PeerCryptoCache();
+
 /**
  * Encrypt data for a specific peer (convenience function)
  *
@@ -173,24 +311,7 @@ export function encryptForPeer(
   myX25519SecretKey: string,
   theirX25519PublicKey: string,
 ): EncryptedPayload {
-  const mySecretBytes = decodeBase64(myX25519SecretKey);
-  const theirPublicBytes = decodeBase64(theirX25519PublicKey);
-  const message = typeof data === "string" ? data : JSON.stringify(data);
-  const messageBytes = decodeUTF8(message);
-  const nonce = nacl.randomBytes(nacl.box.nonceLength);
-
-  // Direct encryption without pre-computing shared secret
-  const ciphertext = nacl.box(
-    messageBytes,
-    nonce,
-    theirPublicBytes,
-    mySecretBytes,
-  );
-
-  return {
-    ciphertext: encodeBase64(ciphertext),
-    nonce: encodeBase64(nonce),
-  };
+  return peerCryptoCache.encrypt(data, myX25519SecretKey, theirX25519PublicKey);
 }
 
 /**
@@ -206,26 +327,5 @@ export function decryptFromPeer(
   myX25519SecretKey: string,
   theirX25519PublicKey: string,
 ): string | null {
-  try {
-    const mySecretBytes = decodeBase64(myX25519SecretKey);
-    const theirPublicBytes = decodeBase64(theirX25519PublicKey);
-    const ciphertext = decodeBase64(encrypted.ciphertext);
-    const nonce = decodeBase64(encrypted.nonce);
-
-    const decrypted = nacl.box.open(
-      ciphertext,
-      nonce,
-      theirPublicBytes,
-      mySecretBytes,
-    );
-
-    if (!decrypted) {
-      return null;
-    }
-
-    // Convert Uint8Array to string - encodeUTF8 converts bytes to string
-    return encodeUTF8(decrypted);
-  } catch {
-    return null;
-  }
+  return peerCryptoCache.decrypt(encrypted, myX25519SecretKey, theirX25519PublicKey);
 }
@@ -1,2 +1,4 @@
 export * from "./worker-sharded-server";
 export * from "./routed-sharded-server";
+export * from "./shard-balance";
+export * from "./thread-sharded-server";
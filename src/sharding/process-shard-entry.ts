@@ -1,8 +1,17 @@
 import { createRequire } from "node:module";
+import net from "node:net";
 import path from "node:path";
-import type { AddressInfo } from "node:net";
-import type { Payload } from "../types/types";
+import { monitorEventLoopDelay } from "node:perf_hooks";
+import { parentPort } from "node:worker_threads";
+import type { AddressInfo, Socket } from "node:net";
+import type {
+  NativeServerTransportStats,
+  Payload,
+  QWormholeServerEvents,
+} from "../types/types";
 import type { QWormholeServer as QWormholeServerType } from "../server";
+import type { TypedEventEmitter } from "../utils/typedEmitter";
+import type { NativeDetachedConnection } from "../core/native-server";
 import type {
   WorkerShardSerializableServerOptions,
 } from "./worker-sharded-server";
@@ -11,14 +20,51 @@ const require_ = createRequire(
   path.join(process.cwd(), "src", "sharding", "process-shard-entry.ts"),
 );
 const { QWormholeServer } = require_("../server") as typeof import("../server");
+const { createQWormholeServer } =
+  require_("../core/factory") as typeof import("../core/factory");
+const { createNativeShardStatsBoard } =
+  require_("../core/native-server") as typeof import("../core/native-server");
+const { createThreadStatsBoard } =
+  require_("./thread-stats-board") as typeof import("./thread-stats-board");
 
 type WorkerShardBootstrap = {
   options: WorkerShardSerializableServerOptions;
   shardIndex: number;
   shardCount: number;
   telemetryIntervalMs: number;
+  preferNative?: boolean;
+  broadcastRing?: string;
+  connectionDirectory?: { directory: string; inboxes: string[] };
+  /** shm name of the primary's stats board. */
+  statsBoard?: string;
+  /** Thread shards: the owner's stats pages, shared in-process. */
+  statsBuffer?: SharedArrayBuffer;
 };
 
+// The slice of the TS and native servers a shard drives.
+type ShardServer = TypedEventEmitter<QWormholeServerEvents<Buffer>> &
+  Pick<
+    QWormholeServerType<Buffer>,
+    | "listen"
+    | "broadcast"
+    | "shutdown"
+    | "getConnection"
+    | "getConnectionCount"
+  > & {
+    adoptSocket(socket: Socket | RawHandle, state?: Buffer): boolean;
+    getStats?(): NativeServerTransportStats | undefined;
+    detachConnection?(id: string): Promise<NativeDetachedConnection | undefined>;
+    attachBroadcastRing?(name: string): boolean;
+    attachConnectionDirectory?(link: {
+      directory: string;
+      inboxes: string[];
+      shard: number;
+    }): boolean;
+  };
+
+// What child_process IPC hands over for a socket sent unwrapped.
+type RawHandle = { fd?: number; close(): void };
+
 type WorkerShardStats = {
   processId: number;
   listening: boolean;
@@ -27,11 +73,18 @@ type WorkerShardStats = {
   messagesIn: number;
   bytesIn: number;
   errors: number;
+  loopLagMs?: number;
+  queuedBytes?: number;
+  serviceLagUs?: number;
 };
 
 type WorkerShardCommand =
   | { type: "bootstrap"; payload: WorkerShardBootstrap }
   | { type: "broadcast"; payload: Payload }
+  | { type: "sendTo"; id: string; payload: Payload; priority?: number }
+  | { type: "adopt" }
+  | { type: "migrate"; id: string; requestId: number }
+  | { type: "adoptMigrated"; requestId: number; state: string }
   | { type: "shutdown"; gracefulMs: number };
 
 const estimatePayloadBytes = (payload: unknown): number => {
@@ -44,13 +97,20 @@ const estimatePayloadBytes = (payload: unknown): number => {
   return Buffer.byteLength(String(payload ?? ""));
 };
 
-if (typeof process.send !== "function") {
-  throw new Error("process shard entry requires IPC");
+// Thread shards (ThreadShardedServer) hear from their owner on parentPort;
+// process shards over IPC.
+const channel = parentPort;
+
+if (!channel && typeof process.send !== "function") {
+  throw new Error("process shard entry requires IPC or a worker thread");
 }
 
-let server: QWormholeServerType<Buffer> | null = null;
+let server: ShardServer | null = null;
 let telemetryTimer: NodeJS.Timeout | null = null;
 let shardIndex = -1;
+// This shard's page of the primary's stats board; replaces IPC telemetry.
+let statsPage: { write(stats: WorkerShardStats): boolean } | null = null;
+let statsDirty = false;
 
 const stats: WorkerShardStats = {
   processId: process.pid,
@@ -62,31 +122,80 @@ const stats: WorkerShardStats = {
 };
 
 const postMessage = (message: unknown): void => {
+  if (channel) {
+    channel.postMessage(message);
+    return;
+  }
   process.send?.(message);
 };
 
+const disconnect = (): void => {
+  if (channel) {
+    channel.close();
+    return;
+  }
+  process.disconnect?.();
+};
+
+const reportStats = (): void => {
+  if (statsPage) {
+    statsPage.write(stats);
+    return;
+  }
+  postMessage({
+    type: "telemetry",
+    shardIndex,
+    stats,
+  });
+};
+
+// With a stats page, counter changes are published once per loop turn
+// instead of waiting for the telemetry tick.
+const markStatsDirty = (): void => {
+  if (!statsPage || statsDirty) return;
+  statsDirty = true;
+  setImmediate(() => {
+    statsDirty = false;
+    statsPage?.write(stats);
+  });
+};
+
 const attachServer = (bootstrap: WorkerShardBootstrap) => {
   shardIndex = bootstrap.shardIndex;
-  server = new QWormholeServer<Buffer>({
+  const options = {
     ...bootstrap.options,
     reusePort: bootstrap.options.reusePort ?? true,
-  });
+  };
+  const shardServer: ShardServer = bootstrap.preferNative
+    ? createQWormholeServer<Buffer>({
+        ...options,
+        preferNative: true,
+        // Only the libsocket listener can carry the steering program.
+        preferredNativeBackend:
+          options.reusePortSteering === "cpu" ? "libsocket" : undefined,
+      }).server
+    : new QWormholeServer<Buffer>(options);
+  server = shardServer;
 
   server.on("connection", () => {
     stats.connections = server?.getConnectionCount() ?? 0;
+    markStatsDirty();
   });
 
   server.on("clientClosed", () => {
     stats.connections = server?.getConnectionCount() ?? 0;
+    markStatsDirty();
   });
 
   server.on("message", ({ data }) => {
     stats.messagesIn += 1;
     stats.bytesIn += estimatePayloadBytes(data);
+    markStatsDirty();
   });
 
   server.on("error", error => {
     stats.errors += 1;
+    markStatsDirty();
     postMessage({
       type: "error",
       shardIndex,
@@ -94,12 +203,19 @@ const attachServer = (bootstrap: WorkerShardBootstrap) => {
     });
   });
 
+  // Load signal for the primary's shard selection.
+  const loopDelay = monitorEventLoopDelay({ resolution: 10 });
+  loopDelay.enable();
+
   telemetryTimer = setInterval(() => {
-    postMessage({
-      type: "telemetry",
-      shardIndex,
-      stats,
-    });
+    stats.loopLagMs = Number.isFinite(loopDelay.mean) ? loopDelay.mean / 1e6 : 0;
+    loopDelay.reset();
+    const native = server?.getStats?.();
+    if (native) {
+      stats.queuedBytes = native.queuedBytes;
+      stats.serviceLagUs = native.serviceLagUs;
+    }
+    reportStats();
   }, bootstrap.telemetryIntervalMs);
 
   telemetryTimer.unref?.();
@@ -110,6 +226,7 @@ const shutdown = async (gracefulMs: number) => {
     clearInterval(telemetryTimer);
     telemetryTimer = null;
   }
+  statsPage = null;
   if (server) {
     await server.shutdown(gracefulMs);
     server = null;
@@ -118,10 +235,143 @@ const shutdown = async (gracefulMs: number) => {
     type: "shutdown-complete",
     shardIndex,
   });
-  process.disconnect?.();
+  disconnect();
+};
+
+// Adoption must happen in the same tick the handle arrives: the native
+// server dups the descriptor and destroys the Node socket before libuv
+// gets a chance to read from it.
+const adopt = (handle: Socket | undefined) => {
+  if (!server || !handle) {
+    handle?.destroy();
+    return;
+  }
+  try {
+    server.adoptSocket(handle);
+  } catch (error) {
+    stats.errors += 1;
+    handle.destroy();
+    postMessage({
+      type: "error",
+      shardIndex,
+      error: error instanceof Error ? error.message : String(error),
+    });
+  }
 };
 
-process.on("message", async (message: WorkerShardCommand) => {
+// Hot migration, source side. The socket goes back to the primary as a raw
+// handle, which libuv does not read from on the way through; our duplicate
+// is closed once it is sent.
+const migrateOut = async (id: string, requestId: number) => {
+  let detached: NativeDetachedConnection | undefined;
+  try {
+    detached = await server?.detachConnection?.(id);
+  } catch {
+    detached = undefined;
+  }
+  if (!detached) {
+    postMessage({ type: "detached", shardIndex, requestId });
+    return;
+  }
+  const socket = new net.Socket({
+    fd: detached.fd,
+    readable: false,
+    writable: false,
+  });
+  const handle = (socket as unknown as { _handle: unknown })._handle;
+  process.send?.(
+    {
+      type: "detached",
+      shardIndex,
+      requestId,
+      state: detached.state.toString("base64"),
+    },
+    handle as Socket,
+    undefined,
+    () => socket.destroy(),
+  );
+};
+
+// Target side: resume the connection from the source shard's state.
+const migrateIn = (
+  requestId: number,
+  state: string,
+  handle: RawHandle | undefined,
+) => {
+  let ok = false;
+  // A server that can detach is one that can resume.
+  if (server?.detachConnection && handle) {
+    try {
+      ok = server.adoptSocket(handle, Buffer.from(state, "base64"));
+    } catch (error) {
+      stats.errors += 1;
+      handle.close();
+      postMessage({
+        type: "error",
+        shardIndex,
+        error: error instanceof Error ? error.message : String(error),
+      });
+    }
+  } else {
+    handle?.close();
+  }
+  postMessage({ type: "adopted", shardIndex, requestId, ok });
+};
+
+// Only the lws server can consume the ring; the primary keeps IPC-sending
+// broadcasts to shards that report false here.
+const attachBroadcastRing = (name?: string): boolean => {
+  if (!name || !server?.attachBroadcastRing) return false;
+  try {
+    return server.attachBroadcastRing(name);
+  } catch {
+    return false;
+  }
+};
+
+const attachStatsPage = (
+  name?: string,
+  buffer?: SharedArrayBuffer,
+): boolean => {
+  if (!name && !buffer) return false;
+  try {
+    statsPage = buffer
+      ? createThreadStatsBoard(buffer, shardIndex)
+      : createNativeShardStatsBoard({ name: name!, shard: shardIndex });
+  } catch {
+    statsPage = null;
+  }
+  if (statsPage) reportStats();
+  return statsPage !== null;
+};
+
+const attachConnectionDirectory = (
+  link?: WorkerShardBootstrap["connectionDirectory"],
+): boolean => {
+  if (!link || !server?.attachConnectionDirectory) return false;
+  try {
+    return server.attachConnectionDirectory({ ...link, shard: shardIndex });
+  } catch {
+    return false;
+  }
+};
+
+const onCommand = async (message: WorkerShardCommand, handle?: Socket) => {
+  if (message.type === "adopt") {
+    adopt(handle);
+    return;
+  }
+
+  if (message.type === "migrate") {
+    void migrateOut(message.id, message.requestId);
+    return;
+  }
+
+  if (message.type === "adoptMigrated") {
+    migrateIn(message.requestId, message.state, handle as unknown as RawHandle);
+    return;
+  }
+
   if (message.type === "bootstrap") {
     try {
       attachServer(message.payload);
@@ -133,6 +383,14 @@ process.on("message", async (message: WorkerShardCommand) => {
         shardIndex,
         processId: process.pid,
         address,
+        broadcastRing: attachBroadcastRing(message.payload.broadcastRing),
+        connectionDirectory: attachConnectionDirectory(
+          message.payload.connectionDirectory,
+        ),
+        statsBoard: attachStatsPage(
+          message.payload.statsBoard,
+          message.payload.statsBuffer,
+        ),
       });
     } catch (error) {
       postMessage({
@@ -140,7 +398,7 @@ process.on("message", async (message: WorkerShardCommand) => {
         shardIndex: message.payload.shardIndex,
         error: error instanceof Error ? error.message : String(error),
       });
-      process.disconnect?.();
+      disconnect();
       process.exitCode = 1;
     }
     return;
@@ -151,7 +409,24 @@ process.on("message", async (message: WorkerShardCommand) => {
     return;
   }
 
+  if (message.type === "sendTo") {
+    // The primary may ask every shard when it does not know the owner.
+    server
+      ?.getConnection(message.id)
+      ?.send(message.payload, { priority: message.priority })
+      .catch(() => {
+        stats.errors += 1;
+      });
+    return;
+  }
+
   if (message.type === "shutdown") {
     await shutdown(message.gracefulMs);
   }
-});
+};
+
+if (channel) {
+  channel.on("message", (message: WorkerShardCommand) => void onCommand(message));
+} else {
+  process.on("message", onCommand);
+}
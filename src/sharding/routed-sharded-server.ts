@@ -4,7 +4,10 @@ import net from "node:net";
 import { availableParallelism } from "node:os";
 import path from "node:path";
 import type { AddressInfo } from "node:net";
+import type { NativeShardStatsBoard } from "../core/native-server";
 import type { Payload, QWormholeServerOptions } from "../types/types";
+import { pickShard, type ShardBalance } from "./shard-balance";
+import { openShardStatsBoard, readShardStatsBoard } from "./shard-stats-board";
 import type {
   WorkerShardSerializableServerOptions,
   WorkerShardStats,
@@ -28,6 +31,25 @@ export interface RoutedShardedServerOptions
   workerExecArgv?: string[];
   workerEnv?: NodeJS.ProcessEnv;
   shardHost?: string;
+  /**
+   * How accepted connections reach a shard. "fd" (default off Windows)
+   * sends the socket itself over the shard's IPC channel, so the primary
+   * drops out of the data path; "proxy" pipes bytes through the primary.
+   */
+  handoff?: "fd" | "proxy";
+  /** Run shards on the native server when the lws addon is present. */
+  shardPreferNative?: boolean;
+  /**
+   * New-connection routing: "p2c" (default) takes the lighter of two random
+   * shards by shardLoadScore(), "least-loaded" the lightest of all, and
+   * "round-robin" ignores load.
+   */
+  balance?: ShardBalance;
+  /**
+   * Shards publish their stats to a seqlocked shared-memory page that
+   * getStats() and shard selection read live, instead of IPC telemetry.
+   */
+  statsBoard?: boolean;
 }
 
 export type RoutedShardedServerStats = {
@@ -36,6 +58,9 @@ export type RoutedShardedServerStats = {
   connections: number;
   acceptedConnections: number;
   proxiedConnections: number;
+  handedOffConnections: number;
+  /** Connections moved between shards by migrateConnection(). */
+  migratedConnections: number;
   messagesIn: number;
   bytesIn: number;
   errors: number;
@@ -48,6 +73,9 @@ type WorkerShardBootstrap = {
   shardIndex: number;
   shardCount: number;
   telemetryIntervalMs: number;
+  preferNative?: boolean;
+  /** shm name of the primary's stats board. */
+  statsBoard?: string;
 };
 
 type WorkerShardReady = {
@@ -55,6 +83,7 @@ type WorkerShardReady = {
   shardIndex: number;
   processId: number;
   address: AddressInfo;
+  statsBoard?: boolean;
 };
 
 type WorkerShardTelemetry = {
@@ -74,17 +103,47 @@ type WorkerShardShutdownComplete = {
   shardIndex: number;
 };
 
+/** A shard's answer to "migrate": `state` (and a handle) when it held the id. */
+type WorkerShardDetached = {
+  type: "detached";
+  shardIndex: number;
+  requestId: number;
+  state?: string;
+};
+
+type WorkerShardAdopted = {
+  type: "adopted";
+  shardIndex: number;
+  requestId: number;
+  ok: boolean;
+};
+
 type WorkerShardMessage =
   | WorkerShardReady
   | WorkerShardTelemetry
   | WorkerShardError
-  | WorkerShardShutdownComplete;
+  | WorkerShardShutdownComplete
+  | WorkerShardDetached
+  | WorkerShardAdopted;
 
 type WorkerShardCommand =
   | { type: "bootstrap"; payload: WorkerShardBootstrap }
   | { type: "broadcast"; payload: Payload }
+  | { type: "adopt" }
+  | { type: "migrate"; id: string; requestId: number }
+  | { type: "adoptMigrated"; requestId: number; state: string }
   | { type: "shutdown"; gracefulMs: number };
 
+// A migrated socket crosses the primary as a raw libuv handle, never read.
+type RawHandle = { close(): void };
+
+type PendingMigration = {
+  toShard: number;
+  /** Source shards yet to answer. */
+  awaiting: number;
+  resolve(migrated: boolean): void;
+};
+
 type ShardProcess = ReturnType<typeof spawn>;
 
 type RoutedProxy = {
@@ -209,20 +268,38 @@ export class RoutedShardedServer {
   private readonly tsxCli = resolveTsxCli();
   private readonly shardStats = new Map<number, WorkerShardStats>();
   private readonly workers: ShardProcess[] = [];
+  private readonly workersByShard = new Map<number, ShardProcess>();
   private readonly proxies = new Map<string, RoutedProxy>();
   private readonly acceptor: net.Server;
+  private readonly handoff: "fd" | "proxy";
   private listening = false;
-  private nextShardIndex = 0;
+  private readonly balance = {
+    cursor: 0,
+    // Connections routed to a shard since its last telemetry report.
+    pending: new Map<number, number>(),
+  };
+  private statsBoard: NativeShardStatsBoard | null = null;
+  private readonly statsBoardSeen = new Map<number, number>();
   private proxyCounter = 0;
   private acceptedConnections = 0;
+  private handedOffConnections = 0;
+  private readonly migrations = new Map<number, PendingMigration>();
+  private migrationCounter = 0;
+  private migratedConnections = 0;
   private errors = 0;
   private listeningAddress?: AddressInfo;
 
   constructor(options: RoutedShardedServerOptions) {
     this.options = options;
-    this.acceptor = net.createServer(socket => {
-      void this.handleInbound(socket);
-    });
+    this.handoff =
+      options.handoff ?? (process.platform === "win32" ? "proxy" : "fd");
+    // Handed-off sockets must reach the shard unread.
+    this.acceptor = net.createServer(
+      { pauseOnConnect: this.handoff === "fd" },
+      socket => {
+        void this.handleInbound(socket);
+      },
+    );
     onServer(
       this.acceptor,
       "error",
@@ -242,6 +319,9 @@ export class RoutedShardedServer {
     const startupTimeoutMs =
       this.options.startupTimeoutMs ?? DEFAULT_STARTUP_TIMEOUT_MS;
     const workerOptions = assertSerializableOptions(this.options);
+    this.statsBoard = this.options.statsBoard
+      ? openShardStatsBoard(workerCount, "RoutedShardedServer")
+      : null;
 
     const startupPromises = Array.from({ length: workerCount }, (_unused, index) =>
       this.spawnWorker(
@@ -250,6 +330,8 @@ export class RoutedShardedServer {
           shardIndex: index,
           shardCount: workerCount,
           telemetryIntervalMs,
+          preferNative: this.options.shardPreferNative,
+          statsBoard: this.statsBoard?.name(),
         },
         startupTimeoutMs,
       ),
@@ -293,6 +375,7 @@ export class RoutedShardedServer {
   }
 
   getStats(): RoutedShardedServerStats {
+    this.refreshFromStatsBoard();
     const byWorker = [...this.shardStats.values()].sort(
       (a, b) => a.shardIndex - b.shardIndex,
     );
@@ -302,6 +385,8 @@ export class RoutedShardedServer {
       connections: byWorker.reduce((sum, stat) => sum + stat.connections, 0),
       acceptedConnections: this.acceptedConnections,
       proxiedConnections: this.proxies.size,
+      handedOffConnections: this.handedOffConnections,
+      migratedConnections: this.migratedConnections,
       messagesIn: byWorker.reduce((sum, stat) => sum + stat.messagesIn, 0),
       bytesIn: byWorker.reduce((sum, stat) => sum + stat.bytesIn, 0),
       errors:
@@ -311,8 +396,46 @@ export class RoutedShardedServer {
     };
   }
 
+  /**
+   * Move a live connection to shard `toShard` without the client
+   * reconnecting: native lws shards, plain TCP only. The other shards are
+   * asked for `id`; the one holding it detaches it, and its socket and
+   * state pass through here to the target, where it resumes under a new id
+   * with its queued frames still ahead of anything sent there. Resolves
+   * false when no shard could hand it over or the target refused it.
+   */
+  migrateConnection(id: string, toShard: number): Promise<boolean> {
+    const target = this.workersByShard.get(toShard);
+    const sources = [...this.workersByShard].filter(
+      ([shardIndex, worker]) => shardIndex !== toShard && worker.connected,
+    );
+    if (!target?.connected || sources.length === 0) {
+      return Promise.resolve(false);
+    }
+    this.migrationCounter += 1;
+    const requestId = this.migrationCounter;
+    return new Promise<boolean>(resolve => {
+      this.migrations.set(requestId, {
+        toShard,
+        awaiting: sources.length,
+        resolve,
+      });
+      for (const [, worker] of sources) {
+        worker.send?.({
+          type: "migrate",
+          id,
+          requestId,
+        } satisfies WorkerShardCommand);
+      }
+    });
+  }
+
   async shutdown(gracefulMs = 1_000): Promise<void> {
     this.listening = false;
+    for (const migration of this.migrations.values()) {
+      migration.resolve(false);
+    }
+    this.migrations.clear();
     await new Promise<void>(resolve => {
       this.acceptor.close(() => resolve());
     });
@@ -324,7 +447,10 @@ export class RoutedShardedServer {
     this.proxies.clear();
 
     const workers = [...this.workers];
-    if (workers.length === 0) return;
+    if (workers.length === 0) {
+      this.closeStatsBoard();
+      return;
+    }
 
     await Promise.all(
       workers.map(
@@ -368,7 +494,9 @@ export class RoutedShardedServer {
     );
 
     this.workers.length = 0;
+    this.workersByShard.clear();
     this.shardStats.clear();
+    this.closeStatsBoard();
     this.listeningAddress = undefined;
   }
 
@@ -389,7 +517,9 @@ export class RoutedShardedServer {
       ),
     );
     this.workers.length = 0;
+    this.workersByShard.clear();
     this.shardStats.clear();
+    this.closeStatsBoard();
   }
 
   private async handleInbound(client: net.Socket): Promise<void> {
@@ -400,6 +530,11 @@ export class RoutedShardedServer {
     }
 
     this.acceptedConnections += 1;
+    if (this.handoff === "fd") {
+      this.handOff(client, targetShard.shardIndex);
+      return;
+    }
+
     const proxyId = makeProxyId(++this.proxyCounter);
     const upstream = net.createConnection({
       host: targetShard.address.address,
@@ -443,13 +578,53 @@ export class RoutedShardedServer {
     upstream.on("close", cleanup);
   }
 
+  private handOff(client: net.Socket, shardIndex: number): void {
+    const worker = this.workersByShard.get(shardIndex);
+    if (!worker?.connected) {
+      this.errors += 1;
+      client.destroy();
+      return;
+    }
+    // Node passes the handle with SCM_RIGHTS and closes our copy once sent.
+    worker.send({ type: "adopt" } satisfies WorkerShardCommand, client, error => {
+      if (error) {
+        this.errors += 1;
+        client.destroy();
+        return;
+      }
+      this.handedOffConnections += 1;
+    });
+  }
+
+  // A page written since the last read resets that shard's pending count,
+  // as a telemetry message does.
+  private refreshFromStatsBoard(): void {
+    if (!this.statsBoard) return;
+    for (const shardIndex of readShardStatsBoard(
+      this.statsBoard,
+      this.shardStats,
+      this.statsBoardSeen,
+    )) {
+      this.balance.pending.delete(shardIndex);
+    }
+  }
+
+  private closeStatsBoard(): void {
+    this.statsBoard?.close();
+    this.statsBoard = null;
+    this.statsBoardSeen.clear();
+  }
+
   private selectShard(): WorkerShardStats | undefined {
+    this.refreshFromStatsBoard();
     const shards = [...this.shardStats.values()]
       .filter(stat => stat.listening && stat.address)
       .sort((a, b) => a.shardIndex - b.shardIndex);
-    if (shards.length === 0) return undefined;
-    const shard = shards[this.nextShardIndex % shards.length];
-    this.nextShardIndex = (this.nextShardIndex + 1) % shards.length;
+    const shard = pickShard(shards, this.options.balance ?? "p2c", this.balance);
+    if (shard) {
+      const pending = this.balance.pending;
+      pending.set(shard.shardIndex, (pending.get(shard.shardIndex) ?? 0) + 1);
+    }
     return shard;
   }
 
@@ -476,6 +651,7 @@ export class RoutedShardedServer {
         },
       );
       this.workers.push(worker);
+      this.workersByShard.set(bootstrap.shardIndex, worker);
 
       const rejectWith = (error: Error) => {
         cleanup();
@@ -528,8 +704,8 @@ export class RoutedShardedServer {
           onProcess(
             worker,
             "message",
-            ((followup: WorkerShardMessage) =>
-              this.onWorkerMessage(followup)) as unknown as (
+            ((followup: WorkerShardMessage, handle?: RawHandle) =>
+              this.onWorkerMessage(followup, handle)) as unknown as (
               ...args: unknown[]
             ) => void,
           );
@@ -547,6 +723,7 @@ export class RoutedShardedServer {
       const onExit = (code: number | null, signal: NodeJS.Signals | null) => {
         cleanup();
         this.workers.splice(this.workers.indexOf(worker), 1);
+        this.workersByShard.delete(bootstrap.shardIndex);
         reject(
           new Error(
             `Routed shard ${bootstrap.shardIndex} exited before ready with code ${code ?? "null"} signal ${signal ?? "null"}`,
@@ -577,12 +754,74 @@ export class RoutedShardedServer {
     });
   }
 
-  private onWorkerMessage(message: WorkerShardMessage): void {
+  private onDetached(message: WorkerShardDetached, handle?: RawHandle): void {
+    const migration = this.migrations.get(message.requestId);
+    if (!message.state || !handle) {
+      handle?.close();
+      if (migration) {
+        migration.awaiting -= 1;
+        if (migration.awaiting === 0) {
+          this.migrations.delete(message.requestId);
+          migration.resolve(false);
+        }
+      }
+      return;
+    }
+    const target = migration
+      ? this.workersByShard.get(migration.toShard)
+      : undefined;
+    if (!migration || !target?.connected) {
+      // Detached with nowhere to go: the client sees a reset.
+      this.errors += 1;
+      handle.close();
+      this.migrations.delete(message.requestId);
+      migration?.resolve(false);
+      return;
+    }
+    // Answers from the other shards no longer matter.
+    migration.awaiting = Number.POSITIVE_INFINITY;
+    target.send(
+      {
+        type: "adoptMigrated",
+        requestId: message.requestId,
+        state: message.state,
+      } satisfies WorkerShardCommand,
+      handle as unknown as net.Socket,
+      error => {
+        handle.close();
+        if (error) {
+          this.errors += 1;
+          this.migrations.delete(message.requestId);
+          migration.resolve(false);
+        }
+      },
+    );
+  }
+
+  private onWorkerMessage(
+    message: WorkerShardMessage,
+    handle?: RawHandle,
+  ): void {
+    if (message.type === "detached") {
+      this.onDetached(message, handle);
+      return;
+    }
+
+    if (message.type === "adopted") {
+      const migration = this.migrations.get(message.requestId);
+      if (!migration) return;
+      this.migrations.delete(message.requestId);
+      if (message.ok) this.migratedConnections += 1;
+      migration.resolve(message.ok);
+      return;
+    }
+
     if (message.type === "telemetry") {
       this.shardStats.set(message.shardIndex, {
         shardIndex: message.shardIndex,
         ...message.stats,
       });
+      this.balance.pending.delete(message.shardIndex);
       return;
     }
 
@@ -0,0 +1,64 @@
+import type { WorkerShardStats } from "./worker-sharded-server";
+
+export type ShardBalance = "round-robin" | "least-loaded" | "p2c";
+
+const QUEUED_BYTES_PER_UNIT = 64 * 1024;
+
+/**
+ * One number per shard, lower is better. Each connection counts one, as
+ * does each connection routed since the shard last reported, every 64 KiB
+ * queued for send, and every millisecond of event-loop or native
+ * service-loop lag. A shard stuck in GC or flushing a few hot connections
+ * thus looks busy before its connection count catches up.
+ */
+export const shardLoadScore = (
+  stat: WorkerShardStats,
+  pending = 0,
+): number =>
+  stat.connections +
+  pending +
+  (stat.queuedBytes ?? 0) / QUEUED_BYTES_PER_UNIT +
+  (stat.loopLagMs ?? 0) +
+  (stat.serviceLagUs ?? 0) / 1000;
+
+/**
+ * Picks a shard from `shards` (ready ones, in shard order). "p2c" compares
+ * two at random and takes the lighter, which avoids the herd a stale
+ * least-loaded view sends to one shard between telemetry ticks.
+ */
+export const pickShard = (
+  shards: WorkerShardStats[],
+  balance: ShardBalance,
+  state: { cursor: number; pending: Map<number, number> },
+  random: () => number = Math.random,
+): WorkerShardStats | undefined => {
+  if (shards.length === 0) return undefined;
+  const score = (stat: WorkerShardStats) =>
+    shardLoadScore(stat, state.pending.get(stat.shardIndex) ?? 0);
+
+  if (balance === "round-robin" || shards.length === 1) {
+    const shard = shards[state.cursor % shards.length];
+    state.cursor = (state.cursor + 1) % shards.length;
+    return shard;
+  }
+
+  if (balance === "least-loaded") {
+    let best = shards[0];
+    let bestScore = score(best);
+    for (let i = 1; i < shards.length; i += 1) {
+      const candidate = score(shards[i]);
+      if (candidate < bestScore) {
+        best = shards[i];
+        bestScore = candidate;
+      }
+    }
+    return best;
+  }
+
+  const first = Math.floor(random() * shards.length) % shards.length;
+  let second = Math.floor(random() * (shards.length - 1)) % (shards.length - 1);
+  if (second >= first) second += 1;
+  const a = shards[first];
+  const b = shards[second];
+  return score(b) < score(a) ? b : a;
+};
@@ -0,0 +1,53 @@
+import {
+  createNativeShardStatsBoard,
+  type NativeShardStatsBoard,
+} from "../core/native-server";
+import type { WorkerShardStats } from "./worker-sharded-server";
+
+/**
+ * A stats board with a page per shard, or null when the lws addon (or POSIX
+ * shared memory) is missing; shards then keep reporting over IPC.
+ */
+export const openShardStatsBoard = (
+  shards: number,
+  owner: string,
+): NativeShardStatsBoard | null => {
+  try {
+    return createNativeShardStatsBoard({ shards });
+  } catch (error) {
+    console.error(`[${owner}] shard stats board unavailable:`, error);
+    return null;
+  }
+};
+
+/**
+ * Folds every page written since the last call into `stats`, keeping the
+ * entries' listening state and address. `seen` holds each shard's last seq.
+ * Returns the shards that reported, in page order.
+ */
+export const readShardStatsBoard = (
+  board: NativeShardStatsBoard,
+  stats: Map<number, WorkerShardStats>,
+  seen: Map<number, number>,
+): number[] => {
+  const updated: number[] = [];
+  for (const page of board.read()) {
+    if (!page || seen.get(page.shardIndex) === page.seq) continue;
+    const current = stats.get(page.shardIndex);
+    // Pages outlive a shard that exited; only ready shards are in `stats`.
+    if (!current || current.processId !== page.processId) continue;
+    seen.set(page.shardIndex, page.seq);
+    updated.push(page.shardIndex);
+    stats.set(page.shardIndex, {
+      ...current,
+      connections: page.connections,
+      messagesIn: page.messagesIn,
+      bytesIn: page.bytesIn,
+      errors: page.errors,
+      loopLagMs: page.loopLagMs,
+      queuedBytes: page.queuedBytes,
+      serviceLagUs: page.serviceLagUs,
+    });
+  }
+  return updated;
+};
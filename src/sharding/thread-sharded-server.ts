@@ -0,0 +1,469 @@
+import { availableParallelism } from "node:os";
+import path from "node:path";
+import { Worker } from "node:worker_threads";
+import type { AddressInfo } from "node:net";
+import { defaultSerializer } from "../core/codecs";
+import {
+  createNativeBroadcastRing,
+  createNativeConnectionDirectory,
+  type NativeBroadcastRing,
+  type NativeConnectionDirectory,
+  type NativeConnectionDirectoryNames,
+  type NativeShardStatsBoard,
+} from "../core/native-server";
+import type { Payload, QWormholeServerOptions } from "../types/types";
+import { readShardStatsBoard } from "./shard-stats-board";
+import {
+  allocateThreadStatsBuffer,
+  createThreadStatsBoard,
+} from "./thread-stats-board";
+import type {
+  WorkerShardedServerStats,
+  WorkerShardSerializableServerOptions,
+  WorkerShardStats,
+} from "./worker-sharded-server";
+
+type UnsupportedThreadServerOptionKeys =
+  | "allowConnection"
+  | "onAuthorizeConnection"
+  | "verifyHandshake"
+  | "onTelemetry"
+  | "onTrustSnapshot"
+  | "coherence"
+  | "serializer"
+  | "deserializer";
+
+export interface ThreadShardedServerOptions
+  extends QWormholeServerOptions<Buffer> {
+  workers?: number;
+  telemetryIntervalMs?: number;
+  startupTimeoutMs?: number;
+  /**
+   * Node options for each worker thread. Defaults to `--import tsx` when
+   * running from TypeScript sources, nothing otherwise.
+   */
+  workerExecArgv?: string[];
+  /** Run shards on the native server when an addon is present. */
+  shardPreferNative?: boolean;
+  /** As on WorkerShardedServer; the ring lives in this process. */
+  broadcastRing?: boolean | { capacityBytes?: number };
+  /** As on WorkerShardedServer; the directory lives in this process. */
+  connectionDirectory?: boolean | { slots?: number; inboxBytes?: number };
+}
+
+export type ThreadShardedServerStats = WorkerShardedServerStats;
+
+type ThreadShardBootstrap = {
+  options: WorkerShardSerializableServerOptions;
+  shardIndex: number;
+  shardCount: number;
+  telemetryIntervalMs: number;
+  preferNative?: boolean;
+  broadcastRing?: string;
+  connectionDirectory?: NativeConnectionDirectoryNames;
+  statsBuffer: SharedArrayBuffer;
+};
+
+type ThreadShardMessage =
+  | {
+      type: "ready";
+      shardIndex: number;
+      processId: number;
+      address: AddressInfo;
+      broadcastRing?: boolean;
+      connectionDirectory?: boolean;
+      statsBoard?: boolean;
+    }
+  | {
+      type: "telemetry";
+      shardIndex: number;
+      stats: Omit<WorkerShardStats, "shardIndex">;
+    }
+  | { type: "error"; shardIndex: number; error: string }
+  | { type: "shutdown-complete"; shardIndex: number };
+
+type ThreadShardCommand =
+  | { type: "bootstrap"; payload: ThreadShardBootstrap }
+  | { type: "broadcast"; payload: Payload }
+  | { type: "sendTo"; id: string; payload: Payload; priority?: number }
+  | { type: "shutdown"; gracefulMs: number };
+
+const DEFAULT_TELEMETRY_INTERVAL_MS = 250;
+const DEFAULT_STARTUP_TIMEOUT_MS = 10_000;
+
+// Thread shards run the same entry as process shards, on a worker thread.
+const resolveShardEntry = (): string => {
+  const ext = path.extname(__filename) || ".js";
+  return path.join(__dirname, `process-shard-entry${ext}`);
+};
+
+const defaultWorkerCount = () =>
+  Math.max(1, (typeof availableParallelism === "function"
+    ? availableParallelism()
+    : 1) - 1);
+
+const assertThreadShardOptions = (
+  options: ThreadShardedServerOptions,
+  workerCount: number,
+): WorkerShardSerializableServerOptions => {
+  const blocked: Array<UnsupportedThreadServerOptionKeys> = [];
+  if (options.allowConnection) blocked.push("allowConnection");
+  if (options.onAuthorizeConnection) blocked.push("onAuthorizeConnection");
+  if (options.verifyHandshake) blocked.push("verifyHandshake");
+  if (options.onTelemetry) blocked.push("onTelemetry");
+  if (options.onTrustSnapshot) blocked.push("onTrustSnapshot");
+  if (options.coherence) blocked.push("coherence");
+  if (options.serializer) blocked.push("serializer");
+  if (options.deserializer) blocked.push("deserializer");
+
+  if (blocked.length > 0) {
+    throw new Error(
+      `ThreadShardedServer cannot pass functions to worker threads: ${blocked.join(", ")}`,
+    );
+  }
+  if (workerCount > 1 && process.platform === "win32") {
+    throw new Error(
+      "ThreadShardedServer needs SO_REUSEPORT for more than one worker, which Windows lacks",
+    );
+  }
+
+  return {
+    ...options,
+    reusePort: true,
+    // Each shard's native server gets its slice of the service threads.
+    serviceThreads: options.serviceThreads
+      ? Math.max(1, Math.floor(options.serviceThreads / workerCount))
+      : undefined,
+  };
+};
+
+/**
+ * Shards on worker threads of this process instead of child processes:
+ * one isolate per shard rather than one Node process, so startup is the
+ * cost of loading the module graph and shards share the process heap.
+ * Every shard binds the same port with SO_REUSEPORT, so the kernel spreads
+ * accepts across their listeners. Broadcasts and sendTo() take the shared
+ * ring and directory when enabled, postMessage otherwise. Shard stats live
+ * in one SharedArrayBuffer that getStats() reads on demand.
+ */
+export class ThreadShardedServer {
+  private readonly options: ThreadShardedServerOptions;
+  private readonly shardEntry = resolveShardEntry();
+  private readonly shardStats = new Map<number, WorkerShardStats>();
+  private readonly workers: Worker[] = [];
+  private readonly workersByShard = new Map<number, Worker>();
+  private readonly ringWorkers = new Set<Worker>();
+  private readonly directoryWorkers = new Set<Worker>();
+  private ring: NativeBroadcastRing | null = null;
+  private directory: NativeConnectionDirectory | null = null;
+  private statsBoard: NativeShardStatsBoard | null = null;
+  private readonly statsBoardSeen = new Map<number, number>();
+  private listening = false;
+
+  constructor(options: ThreadShardedServerOptions) {
+    this.options = options;
+  }
+
+  async listen(): Promise<AddressInfo> {
+    const first = this.shardStats.get(0)?.address;
+    if (this.listening && first) return first;
+
+    const workerCount = this.options.workers ?? defaultWorkerCount();
+    const workerOptions = assertThreadShardOptions(this.options, workerCount);
+    const statsBuffer = allocateThreadStatsBuffer(workerCount);
+    this.statsBoard = createThreadStatsBoard(statsBuffer);
+    this.ring = this.openBroadcastRing();
+    this.directory = this.openConnectionDirectory(workerCount);
+    const bootstrap = (shardIndex: number, port?: number): ThreadShardBootstrap => ({
+      options: port === undefined ? workerOptions : { ...workerOptions, port },
+      shardIndex,
+      shardCount: workerCount,
+      telemetryIntervalMs:
+        this.options.telemetryIntervalMs ?? DEFAULT_TELEMETRY_INTERVAL_MS,
+      preferNative: this.options.shardPreferNative,
+      broadcastRing: this.ring?.name(),
+      connectionDirectory: this.directory?.names(),
+      statsBuffer,
+    });
+    const startupTimeoutMs =
+      this.options.startupTimeoutMs ?? DEFAULT_STARTUP_TIMEOUT_MS;
+
+    try {
+      // The first shard picks the port when asked for port 0; the others
+      // join it.
+      const address = await this.spawnWorker(bootstrap(0), startupTimeoutMs);
+      await Promise.all(
+        Array.from({ length: workerCount - 1 }, (_unused, index) =>
+          this.spawnWorker(bootstrap(index + 1, address.port), startupTimeoutMs),
+        ),
+      );
+      this.listening = true;
+      return address;
+    } catch (error) {
+      await this.terminateWorkers();
+      throw error;
+    }
+  }
+
+  broadcast(payload: Payload): void {
+    const ringable =
+      this.ring && this.ringWorkers.size > 0 && this.sharedMemorySafe(payload);
+    const published = ringable
+      ? this.ring!.publish(defaultSerializer(payload))
+      : false;
+    for (const worker of this.workers) {
+      if (published && this.ringWorkers.has(worker)) continue;
+      worker.postMessage({ type: "broadcast", payload } satisfies ThreadShardCommand);
+    }
+  }
+
+  /**
+   * Send to the connection `id` on whichever shard holds it: through the
+   * connection directory when enabled, else by asking the owner (or every
+   * shard, when the owner is unknown).
+   */
+  sendTo(id: string, payload: Payload, options?: { priority?: number }): void {
+    const owner = this.directory?.lookup(id) ?? -1;
+    const worker = owner >= 0 ? this.workersByShard.get(owner) : undefined;
+    if (
+      worker &&
+      this.directoryWorkers.has(worker) &&
+      this.sharedMemorySafe(payload) &&
+      this.directory!.sendTo(id, defaultSerializer(payload), options?.priority)
+    ) {
+      return;
+    }
+    const command: ThreadShardCommand = {
+      type: "sendTo",
+      id,
+      payload,
+      priority: options?.priority,
+    };
+    for (const target of worker ? [worker] : this.workers) {
+      target.postMessage(command);
+    }
+  }
+
+  getStats(): ThreadShardedServerStats {
+    if (this.statsBoard) {
+      readShardStatsBoard(this.statsBoard, this.shardStats, this.statsBoardSeen);
+    }
+    const byWorker = [...this.shardStats.values()].sort(
+      (a, b) => a.shardIndex - b.shardIndex,
+    );
+    return {
+      workers: this.workers.length,
+      listening: this.listening,
+      connections: byWorker.reduce((sum, stat) => sum + stat.connections, 0),
+      messagesIn: byWorker.reduce((sum, stat) => sum + stat.messagesIn, 0),
+      bytesIn: byWorker.reduce((sum, stat) => sum + stat.bytesIn, 0),
+      errors: byWorker.reduce((sum, stat) => sum + stat.errors, 0),
+      byWorker,
+      broadcastRing: this.ring
+        ? { ...this.ring.getStats(), attachedWorkers: this.ringWorkers.size }
+        : undefined,
+      connectionDirectory: this.directory
+        ? {
+            ...this.directory.getStats(),
+            attachedWorkers: this.directoryWorkers.size,
+          }
+        : undefined,
+    };
+  }
+
+  async shutdown(gracefulMs = 1_000): Promise<void> {
+    this.listening = false;
+    await Promise.all(
+      this.workers.map(
+        worker =>
+          new Promise<void>(resolve => {
+            const done = () => {
+              worker.off("message", onMessage);
+              worker.off("exit", done);
+              resolve();
+            };
+            const onMessage = (message: ThreadShardMessage) => {
+              if (
+                message.type === "shutdown-complete" ||
+                message.type === "error"
+              ) {
+                done();
+              }
+            };
+            worker.on("message", onMessage);
+            worker.once("exit", done);
+            worker.postMessage({
+              type: "shutdown",
+              gracefulMs,
+            } satisfies ThreadShardCommand);
+          }),
+      ),
+    );
+    await this.terminateWorkers();
+  }
+
+  private async terminateWorkers(): Promise<void> {
+    const workers = [...this.workers];
+    await Promise.allSettled(workers.map(worker => worker.terminate()));
+    this.workers.length = 0;
+    this.workersByShard.clear();
+    this.ringWorkers.clear();
+    this.directoryWorkers.clear();
+    this.ring?.close();
+    this.ring = null;
+    this.directory?.close();
+    this.directory = null;
+    this.statsBoard = null;
+    this.statsBoardSeen.clear();
+    this.shardStats.clear();
+    this.listening = false;
+  }
+
+  private openBroadcastRing(): NativeBroadcastRing | null {
+    const option = this.options.broadcastRing;
+    if (!option) return null;
+    try {
+      return createNativeBroadcastRing(
+        typeof option === "object" ? option.capacityBytes : undefined,
+      );
+    } catch (error) {
+      console.error("[ThreadShardedServer] broadcast ring unavailable:", error);
+      return null;
+    }
+  }
+
+  private openConnectionDirectory(
+    shards: number,
+  ): NativeConnectionDirectory | null {
+    const option = this.options.connectionDirectory;
+    if (!option) return null;
+    try {
+      return createNativeConnectionDirectory({
+        shards,
+        ...(typeof option === "object" ? option : {}),
+      });
+    } catch (error) {
+      console.error(
+        "[ThreadShardedServer] connection directory unavailable:",
+        error,
+      );
+      return null;
+    }
+  }
+
+  // Shards serialize non-Buffer payloads with their own nativeCodec, which
+  // shared memory cannot reproduce; those go by postMessage.
+  private sharedMemorySafe(payload: Payload): boolean {
+    return Buffer.isBuffer(payload) || !this.options.nativeCodec;
+  }
+
+  private spawnWorker(
+    bootstrap: ThreadShardBootstrap,
+    startupTimeoutMs: number,
+  ): Promise<AddressInfo> {
+    return new Promise((resolve, reject) => {
+      const worker = new Worker(this.shardEntry, {
+        execArgv:
+          this.options.workerExecArgv ??
+          (this.shardEntry.endsWith(".ts") ? ["--import", "tsx"] : []),
+      });
+      this.workers.push(worker);
+
+      const cleanup = () => {
+        clearTimeout(startupTimer);
+        worker.off("message", onMessage);
+        worker.off("error", rejectWith);
+        worker.off("exit", onExit);
+      };
+
+      const rejectWith = (error: Error) => {
+        cleanup();
+        void worker.terminate();
+        reject(error);
+      };
+
+      const startupTimer = setTimeout(() => {
+        rejectWith(
+          new Error(
+            `Thread shard ${bootstrap.shardIndex} did not become ready within ${startupTimeoutMs}ms`,
+          ),
+        );
+      }, startupTimeoutMs);
+
+      const onMessage = (message: ThreadShardMessage) => {
+        if (message.type === "ready") {
+          this.shardStats.set(message.shardIndex, {
+            shardIndex: message.shardIndex,
+            processId: message.processId,
+            listening: true,
+            address: message.address,
+            connections: 0,
+            messagesIn: 0,
+            bytesIn: 0,
+            errors: 0,
+          });
+          this.workersByShard.set(message.shardIndex, worker);
+          if (message.broadcastRing) this.ringWorkers.add(worker);
+          if (message.connectionDirectory) this.directoryWorkers.add(worker);
+          worker.once("exit", () => {
+            const index = this.workers.indexOf(worker);
+            if (index >= 0) this.workers.splice(index, 1);
+            if (this.workersByShard.get(message.shardIndex) === worker) {
+              this.workersByShard.delete(message.shardIndex);
+            }
+            this.ringWorkers.delete(worker);
+            this.directoryWorkers.delete(worker);
+          });
+          cleanup();
+          worker.on("message", (followup: ThreadShardMessage) =>
+            this.onWorkerMessage(followup),
+          );
+          resolve(message.address);
+          return;
+        }
+
+        if (message.type === "error") {
+          rejectWith(new Error(message.error));
+        }
+      };
+
+      const onExit = (code: number) => {
+        cleanup();
+        this.workers.splice(this.workers.indexOf(worker), 1);
+        reject(
+          new Error(
+            `Thread shard ${bootstrap.shardIndex} exited before ready with code ${code}`,
+          ),
+        );
+      };
+
+      worker.on("message", onMessage);
+      worker.on("error", rejectWith);
+      worker.on("exit", onExit);
+      worker.postMessage({
+        type: "bootstrap",
+        payload: bootstrap,
+      } satisfies ThreadShardCommand);
+    });
+  }
+
+  private onWorkerMessage(message: ThreadShardMessage): void {
+    if (message.type === "telemetry") {
+      this.shardStats.set(message.shardIndex, {
+        shardIndex: message.shardIndex,
+        ...message.stats,
+      });
+      return;
+    }
+
+    if (message.type === "error") {
+      const current = this.shardStats.get(message.shardIndex);
+      if (current) {
+        this.shardStats.set(message.shardIndex, {
+          ...current,
+          errors: current.errors + 1,
+        });
+      }
+    }
+  }
+}
@@ -0,0 +1,101 @@
+import type {
+  NativeShardStatsBoard,
+  NativeShardStatsPage,
+} from "../core/native-server";
+
+// The native board's page, over a SharedArrayBuffer: an Int32 seqlock word
+// then Float64 fields, 128 bytes per shard so neighbours never share a line.
+const PAGE_BYTES = 128;
+const FIELDS_OFFSET = 8;
+const FIELD_COUNT = 9;
+const READ_ATTEMPTS = 16;
+
+const Field = {
+  ProcessId: 0,
+  UpdatedAt: 1,
+  MessagesIn: 2,
+  BytesIn: 3,
+  Connections: 4,
+  Errors: 5,
+  QueuedBytes: 6,
+  LoopLagMs: 7,
+  ServiceLagUs: 8,
+} as const;
+
+type PageStats = Parameters<NativeShardStatsBoard["write"]>[0];
+
+const pageViews = (buffer: SharedArrayBuffer, shard: number) => ({
+  seq: new Int32Array(buffer, shard * PAGE_BYTES, 1),
+  fields: new Float64Array(buffer, shard * PAGE_BYTES + FIELDS_OFFSET, FIELD_COUNT),
+});
+
+const pageCount = (buffer: SharedArrayBuffer) =>
+  Math.floor(buffer.byteLength / PAGE_BYTES);
+
+/**
+ * Stats pages for thread shards, shaped like the native ShardStatsBoard so
+ * readShardStatsBoard() folds them the same way. With `shard`, the result
+ * is that shard's writer; otherwise the owner's reader. name() is empty:
+ * the buffer itself is what threads share.
+ */
+export const createThreadStatsBoard = (
+  buffer: SharedArrayBuffer,
+  shard?: number,
+): NativeShardStatsBoard => {
+  const shards = pageCount(buffer);
+  return {
+    name: () => "",
+    write(stats: PageStats): boolean {
+      if (shard === undefined || shard < 0 || shard >= shards) return false;
+      const { seq, fields } = pageViews(buffer, shard);
+      // Odd while the fields are in flux; readers retry until it is even
+      // and unchanged across their copy.
+      Atomics.add(seq, 0, 1);
+      fields[Field.ProcessId] = process.pid;
+      fields[Field.UpdatedAt] = Date.now();
+      fields[Field.MessagesIn] = stats.messagesIn ?? 0;
+      fields[Field.BytesIn] = stats.bytesIn ?? 0;
+      fields[Field.Connections] = stats.connections ?? 0;
+      fields[Field.Errors] = stats.errors ?? 0;
+      fields[Field.QueuedBytes] = stats.queuedBytes ?? 0;
+      fields[Field.LoopLagMs] = stats.loopLagMs ?? 0;
+      fields[Field.ServiceLagUs] = stats.serviceLagUs ?? 0;
+      Atomics.add(seq, 0, 1);
+      return true;
+    },
+    read(): Array<NativeShardStatsPage | null> {
+      const pages: Array<NativeShardStatsPage | null> = [];
+      for (let index = 0; index < shards; index += 1) {
+        const { seq, fields } = pageViews(buffer, index);
+        let page: NativeShardStatsPage | null = null;
+        for (let attempt = 0; attempt < READ_ATTEMPTS; attempt += 1) {
+          const before = Atomics.load(seq, 0);
+          if (before === 0) break;
+          if (before & 1) continue;
+          const copy = Float64Array.from(fields);
+          if (Atomics.load(seq, 0) !== before) continue;
+          page = {
+            shardIndex: index,
+            processId: copy[Field.ProcessId],
+            seq: before >>> 1,
+            updatedAt: copy[Field.UpdatedAt],
+            messagesIn: copy[Field.MessagesIn],
+            bytesIn: copy[Field.BytesIn],
+            connections: copy[Field.Connections],
+            errors: copy[Field.Errors],
+            queuedBytes: copy[Field.QueuedBytes],
+            loopLagMs: copy[Field.LoopLagMs],
+            serviceLagUs: copy[Field.ServiceLagUs],
+          };
+          break;
+        }
+        pages.push(page);
+      }
+      return pages;
+    },
+    close: () => {},
+  };
+};
+
+export const allocateThreadStatsBuffer = (shards: number): SharedArrayBuffer =>
+  new SharedArrayBuffer(Math.max(1, shards) * PAGE_BYTES);
@@ -5,7 +5,17 @@ import type { Worker as ClusterWorker } from "node:cluster";
 import { createRequire } from "node:module";
 import path from "node:path";
 import type { AddressInfo } from "node:net";
+import { defaultSerializer } from "../core/codecs";
+import {
+  createNativeBroadcastRing,
+  createNativeConnectionDirectory,
+  type NativeBroadcastRing,
+  type NativeConnectionDirectory,
+  type NativeConnectionDirectoryNames,
+  type NativeShardStatsBoard,
+} from "../core/native-server";
 import type { Payload, QWormholeServerOptions } from "../types/types";
+import { openShardStatsBoard, readShardStatsBoard } from "./shard-stats-board";
 
 type UnsupportedWorkerServerOptionKeys =
   | "allowConnection"
@@ -31,6 +41,11 @@ export type WorkerShardStats = {
   messagesIn: number;
   bytesIn: number;
   errors: number;
+  /** Mean event-loop delay over the last telemetry interval. */
+  loopLagMs?: number;
+  /** From the native server's getStats(), when the shard runs one. */
+  queuedBytes?: number;
+  serviceLagUs?: number;
 };
 
 export type WorkerShardedServerStats = {
@@ -41,6 +56,14 @@ export type WorkerShardedServerStats = {
   bytesIn: number;
   errors: number;
   byWorker: WorkerShardStats[];
+  /** Present while broadcasts go through the shared-memory ring. */
+  broadcastRing?: ReturnType<NativeBroadcastRing["getStats"]> & {
+    attachedWorkers: number;
+  };
+  /** Present while connection ids are tracked in the shared directory. */
+  connectionDirectory?: ReturnType<NativeConnectionDirectory["getStats"]> & {
+    attachedWorkers: number;
+  };
 };
 
 export interface WorkerShardedServerOptions
@@ -50,6 +73,27 @@ export interface WorkerShardedServerOptions
   startupTimeoutMs?: number;
   workerExecArgv?: string[];
   workerEnv?: NodeJS.ProcessEnv;
+  /** Run shards on the native server when an addon is present. */
+  shardPreferNative?: boolean;
+  /**
+   * Publish broadcasts once into a shared-memory ring that native lws
+   * shards fan out from, instead of one IPC message per worker. Shards that
+   * could not attach, and payloads over half the ring, still go over IPC.
+   */
+  broadcastRing?: boolean | { capacityBytes?: number };
+  /**
+   * Track which shard holds each connection id in shared memory, so
+   * sendTo() here or on any native lws shard goes straight to the owner's
+   * inbox. Without it, or for shards that could not attach, sendTo() falls
+   * back to IPC.
+   */
+  connectionDirectory?: boolean | { slots?: number; inboxBytes?: number };
+  /**
+   * Shards publish their stats to a seqlocked shared-memory page instead of
+   * IPC telemetry, and getStats() reads every page when called. Shards
+   * that cannot open the board keep sending telemetry.
+   */
+  statsBoard?: boolean;
 }
 
 type WorkerShardBootstrap = {
@@ -57,6 +101,11 @@ type WorkerShardBootstrap = {
   shardIndex: number;
   shardCount: number;
   telemetryIntervalMs: number;
+  preferNative?: boolean;
+  /** shm name of the primary's broadcast ring. */
+  broadcastRing?: string;
+  connectionDirectory?: NativeConnectionDirectoryNames;
+  statsBoard?: string;
 };
 
 type WorkerShardReady = {
@@ -64,6 +113,12 @@ type WorkerShardReady = {
   shardIndex: number;
   processId: number;
   address: AddressInfo;
+  /** The shard's native server is consuming the broadcast ring. */
+  broadcastRing?: boolean;
+  /** The shard's native server joined the connection directory. */
+  connectionDirectory?: boolean;
+  /** The shard writes its stats page instead of sending telemetry. */
+  statsBoard?: boolean;
 };
 
 type WorkerShardTelemetry = {
@@ -92,6 +147,7 @@ type WorkerShardMessage =
 type WorkerShardCommand =
   | { type: "bootstrap"; payload: WorkerShardBootstrap }
   | { type: "broadcast"; payload: Payload }
+  | { type: "sendTo"; id: string; payload: Payload; priority?: number }
   | { type: "shutdown"; gracefulMs: number };
 
 const DEFAULT_TELEMETRY_INTERVAL_MS = 250;
@@ -198,6 +254,13 @@ export class WorkerShardedServer {
   private readonly tsxCli = resolveTsxCli();
   private readonly shardStats = new Map<number, WorkerShardStats>();
   private readonly workers: ClusterWorker[] = [];
+  private readonly ringWorkers = new Set<ClusterWorker>();
+  private ring: NativeBroadcastRing | null = null;
+  private readonly workersByShard = new Map<number, ClusterWorker>();
+  private readonly directoryWorkers = new Set<ClusterWorker>();
+  private directory: NativeConnectionDirectory | null = null;
+  private statsBoard: NativeShardStatsBoard | null = null;
+  private readonly statsBoardSeen = new Map<number, number>();
   private listening = false;
 
   constructor(options: WorkerShardedServerOptions) {
@@ -215,8 +278,20 @@ export class WorkerShardedServer {
       this.options.telemetryIntervalMs ?? DEFAULT_TELEMETRY_INTERVAL_MS;
     const startupTimeoutMs =
       this.options.startupTimeoutMs ?? DEFAULT_STARTUP_TIMEOUT_MS;
-    const workerOptions = assertSerializableOptions(this.options);
+    const serializable = assertSerializableOptions(this.options);
+    const workerOptions =
+      serializable.reusePortSteering === "cpu"
+        ? {
+            ...serializable,
+            reusePortGroupSize: serializable.reusePortGroupSize ?? workerCount,
+          }
+        : serializable;
     assertShardPlatformSupport(workerCount, workerOptions.reusePort);
+    this.ring = this.openBroadcastRing();
+    this.directory = this.openConnectionDirectory(workerCount);
+    this.statsBoard = this.options.statsBoard
+      ? openShardStatsBoard(workerCount, "WorkerShardedServer")
+      : null;
     cluster.setupPrimary({
       exec: this.workerEntry,
       execArgv:
@@ -233,6 +308,10 @@ export class WorkerShardedServer {
           shardIndex: index,
           shardCount: workerCount,
           telemetryIntervalMs,
+          preferNative: this.options.shardPreferNative,
+          broadcastRing: this.ring?.name(),
+          connectionDirectory: this.directory?.names(),
+          statsBoard: this.statsBoard?.name(),
         },
         startupTimeoutMs,
       ),
@@ -257,12 +336,49 @@ export class WorkerShardedServer {
   }
 
   broadcast(payload: Payload): void {
+    const ringable =
+      this.ring && this.ringWorkers.size > 0 && this.sharedMemorySafe(payload);
+    const published = ringable
+      ? this.ring!.publish(defaultSerializer(payload))
+      : false;
     for (const worker of this.workers) {
+      if (published && this.ringWorkers.has(worker)) continue;
       worker.send?.({ type: "broadcast", payload } satisfies WorkerShardCommand);
     }
   }
 
+  /**
+   * Send to the connection `id` on whichever shard holds it. With
+   * `connectionDirectory`, the owner is looked up in shared memory and the
+   * payload lands in its inbox; otherwise the shard is asked over IPC (every
+   * shard, when the owner is unknown).
+   */
+  sendTo(id: string, payload: Payload, options?: { priority?: number }): void {
+    const owner = this.directory?.lookup(id) ?? -1;
+    const worker = owner >= 0 ? this.workersByShard.get(owner) : undefined;
+    if (
+      worker &&
+      this.directoryWorkers.has(worker) &&
+      this.sharedMemorySafe(payload) &&
+      this.directory!.sendTo(id, defaultSerializer(payload), options?.priority)
+    ) {
+      return;
+    }
+    const command: WorkerShardCommand = {
+      type: "sendTo",
+      id,
+      payload,
+      priority: options?.priority,
+    };
+    for (const target of worker ? [worker] : this.workers) {
+      target.send?.(command);
+    }
+  }
+
   getStats(): WorkerShardedServerStats {
+    if (this.statsBoard) {
+      readShardStatsBoard(this.statsBoard, this.shardStats, this.statsBoardSeen);
+    }
     const byWorker = [...this.shardStats.values()].sort(
       (a, b) => a.shardIndex - b.shardIndex,
     );
@@ -274,6 +390,15 @@ export class WorkerShardedServer {
       bytesIn: byWorker.reduce((sum, stat) => sum + stat.bytesIn, 0),
       errors: byWorker.reduce((sum, stat) => sum + stat.errors, 0),
       byWorker,
+      broadcastRing: this.ring
+        ? { ...this.ring.getStats(), attachedWorkers: this.ringWorkers.size }
+        : undefined,
+      connectionDirectory: this.directory
+        ? {
+            ...this.directory.getStats(),
+            attachedWorkers: this.directoryWorkers.size,
+          }
+        : undefined,
     };
   }
 
@@ -328,6 +453,9 @@ export class WorkerShardedServer {
       ),
     );
     this.workers.length = 0;
+    this.closeBroadcastRing();
+    this.closeConnectionDirectory();
+    this.closeStatsBoard();
     this.shardStats.clear();
     this.listening = false;
   }
@@ -335,6 +463,9 @@ export class WorkerShardedServer {
   private async forceTerminateWorkers(): Promise<void> {
     const workers = [...this.workers];
     if (workers.length === 0) {
+      this.closeBroadcastRing();
+      this.closeConnectionDirectory();
+      this.closeStatsBoard();
       this.shardStats.clear();
       this.listening = false;
       return;
@@ -353,10 +484,73 @@ export class WorkerShardedServer {
       ),
     );
     this.workers.length = 0;
+    this.closeBroadcastRing();
+    this.closeConnectionDirectory();
+    this.closeStatsBoard();
     this.shardStats.clear();
     this.listening = false;
   }
 
+  private openBroadcastRing(): NativeBroadcastRing | null {
+    const option = this.options.broadcastRing;
+    if (!option) return null;
+    try {
+      return createNativeBroadcastRing(
+        typeof option === "object" ? option.capacityBytes : undefined,
+      );
+    } catch (error) {
+      console.error("[WorkerShardedServer] broadcast ring unavailable:", error);
+      return null;
+    }
+  }
+
+  // Shards serialize non-Buffer payloads with their own serializer or
+  // nativeCodec, which shared memory cannot reproduce; those stay on IPC.
+  private sharedMemorySafe(payload: Payload): boolean {
+    return (
+      Buffer.isBuffer(payload) ||
+      (!this.options.serializer && !this.options.nativeCodec)
+    );
+  }
+
+  private openConnectionDirectory(
+    shards: number,
+  ): NativeConnectionDirectory | null {
+    const option = this.options.connectionDirectory;
+    if (!option) return null;
+    try {
+      return createNativeConnectionDirectory({
+        shards,
+        ...(typeof option === "object" ? option : {}),
+      });
+    } catch (error) {
+      console.error(
+        "[WorkerShardedServer] connection directory unavailable:",
+        error,
+      );
+      return null;
+    }
+  }
+
+  private closeStatsBoard(): void {
+    this.statsBoard?.close();
+    this.statsBoard = null;
+    this.statsBoardSeen.clear();
+  }
+
+  private closeConnectionDirectory(): void {
+    this.workersByShard.clear();
+    this.directoryWorkers.clear();
+    this.directory?.close();
+    this.directory = null;
+  }
+
+  private closeBroadcastRing(): void {
+    this.ringWorkers.clear();
+    this.ring?.close();
+    this.ring = null;
+  }
+
   private spawnWorker(
       bootstrap: WorkerShardBootstrap,
       startupTimeoutMs: number,
@@ -415,6 +609,16 @@ export class WorkerShardedServer {
             bytesIn: 0,
             errors: 0,
           });
+          this.workersByShard.set(message.shardIndex, worker);
+          onceProcess(worker, "exit", () => {
+            if (this.workersByShard.get(message.shardIndex) === worker) {
+              this.workersByShard.delete(message.shardIndex);
+            }
+            this.ringWorkers.delete(worker);
+            this.directoryWorkers.delete(worker);
+          });
+          if (message.broadcastRing) this.ringWorkers.add(worker);
+          if (message.connectionDirectory) this.directoryWorkers.add(worker);
           cleanup();
           onProcess(
             worker,
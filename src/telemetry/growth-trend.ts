@@ -0,0 +1,145 @@
+/**
+ * Monotonic growth in a sampled series (RSS, queue depths, TSFN backlog)
+ * for soak runs: a Mann-Kendall test for an upward trend, with Sen's slope
+ * for its size. Samples are averaged down to `maxPoints` buckets first,
+ * which bounds the O(n^2) pair scan and damps the short-range correlation
+ * a raw memory series has. A trend only counts as growth when it is both
+ * significant and large: allocators and pools settle upwards for a while,
+ * so the leading `warmupFraction` is skipped and the growth over the rest
+ * must clear `minAbsoluteGrowth` and `minRelativeGrowth` of the level.
+ */
+
+export type GrowthTrendOptions = {
+  /** Leading fraction of the samples ignored (default 0.2). */
+  warmupFraction?: number;
+  /** Buckets the rest is averaged into before the test (default 200). */
+  maxPoints?: number;
+  /** One-sided significance level (default 0.01). */
+  alpha?: number;
+  /** Growth over the window, in the series' units, that counts (default 0). */
+  minAbsoluteGrowth?: number;
+  /** Growth as a fraction of the median level that counts (default 0.05). */
+  minRelativeGrowth?: number;
+};
+
+export type GrowthTrend = {
+  /** Points the test ran on, after warmup and bucketing. */
+  points: number;
+  /** Kendall's tau between time and value, -1..1. */
+  tau: number;
+  z: number;
+  /** One-sided p-value for an upward trend. */
+  pValue: number;
+  /** Sen's slope, in units per hour. */
+  slopePerHour: number;
+  /** Sen's slope carried across the tested window. */
+  growth: number;
+  /** `growth` over the median of the tested window. */
+  relativeGrowth: number;
+  growing: boolean;
+};
+
+// Abramowitz and Stegun 7.1.26; |error| < 1.5e-7.
+const erfc = (x: number): number => {
+  const t = 1 / (1 + 0.3275911 * Math.abs(x));
+  const poly =
+    t * (0.254829592 + t * (-0.284496736 + t * (1.421413741 + t * (-1.453152027 + t * 1.061405429))));
+  const value = poly * Math.exp(-x * x);
+  return x >= 0 ? value : 2 - value;
+};
+
+const upperTail = (z: number): number => 0.5 * erfc(z / Math.SQRT2);
+
+const median = (values: number[]): number => {
+  if (values.length === 0) return 0;
+  const sorted = [...values].sort((a, b) => a - b);
+  const mid = sorted.length >> 1;
+  return sorted.length % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2;
+};
+
+/** `times` in milliseconds, one per value. */
+export const growthTrend = (
+  times: ArrayLike<number>,
+  values: ArrayLike<number>,
+  options: GrowthTrendOptions = {},
+): GrowthTrend => {
+  const warmup = Math.min(Math.max(options.warmupFraction ?? 0.2, 0), 0.9);
+  const maxPoints = Math.max(3, options.maxPoints ?? 200);
+  const alpha = options.alpha ?? 0.01;
+  const from = Math.floor(values.length * warmup);
+  const span = values.length - from;
+
+  const t: number[] = [];
+  const x: number[] = [];
+  const buckets = Math.min(maxPoints, span);
+  for (let b = 0; b < buckets; b += 1) {
+    const start = from + Math.floor((b * span) / buckets);
+    const end = from + Math.floor(((b + 1) * span) / buckets);
+    let sumT = 0;
+    let sumX = 0;
+    let count = 0;
+    for (let i = start; i < end; i += 1) {
+      if (!Number.isFinite(values[i])) continue;
+      sumT += times[i];
+      sumX += values[i];
+      count += 1;
+    }
+    if (count === 0) continue;
+    t.push(sumT / count);
+    x.push(sumX / count);
+  }
+
+  const n = x.length;
+  const none: GrowthTrend = {
+    points: n,
+    tau: 0,
+    z: 0,
+    pValue: 1,
+    slopePerHour: 0,
+    growth: 0,
+    relativeGrowth: 0,
+    growing: false,
+  };
+  if (n < 3) return none;
+
+  let s = 0;
+  const slopes: number[] = [];
+  for (let i = 0; i < n - 1; i += 1) {
+    for (let j = i + 1; j < n; j += 1) {
+      const delta = x[j] - x[i];
+      s += delta > 0 ? 1 : delta < 0 ? -1 : 0;
+      if (t[j] > t[i]) slopes.push(delta / (t[j] - t[i]));
+    }
+  }
+  // Tied values shrink the variance of S.
+  let tieTerm = 0;
+  const sorted = [...x].sort((a, b) => a - b);
+  for (let i = 0; i < n; ) {
+    let j = i + 1;
+    while (j < n && sorted[j] === sorted[i]) j += 1;
+    const ties = j - i;
+    if (ties > 1) tieTerm += ties * (ties - 1) * (2 * ties + 5);
+    i = j;
+  }
+  const variance = (n * (n - 1) * (2 * n + 5) - tieTerm) / 18;
+  const z = variance > 0 ? (s > 0 ? (s - 1) : s < 0 ? (s + 1) : 0) / Math.sqrt(variance) : 0;
+  const pValue = variance > 0 ? upperTail(z) : 1;
+
+  const slope = median(slopes);
+  const growth = slope * (t[n - 1] - t[0]);
+  const level = Math.abs(median(x));
+  const relativeGrowth = level > 0 ? growth / level : growth > 0 ? Infinity : 0;
+  return {
+    points: n,
+    tau: s / ((n * (n - 1)) / 2),
+    z,
+    pValue,
+    slopePerHour: slope * 3_600_000,
+    growth,
+    relativeGrowth,
+    growing:
+      pValue < alpha &&
+      growth > (options.minAbsoluteGrowth ?? 0) &&
+      relativeGrowth > (options.minRelativeGrowth ?? 0.05),
+  };
+};
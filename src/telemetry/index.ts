@@ -0,0 +1,5 @@
+// Auto-generated index for telemetry
+export * from './trace-format';
+export * from './trace-recorder';
+export * from './latency-histogram';
+export * from './growth-trend';
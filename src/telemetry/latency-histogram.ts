@@ -0,0 +1,162 @@
+import {
+  createNativeLatencyHistogram,
+  type LatencyHistogramSummary,
+  type NativeLatencyHistogram,
+} from "../core/NativeTCPClient";
+
+export type { LatencyHistogramSummary };
+
+export type LatencyHistogramOptions = {
+  /** false keeps the JS histogram even with the lws addon loaded. */
+  native?: boolean;
+};
+
+// Same layout as the addon's BasicAtomicHistogram<7>: values in ns, each
+// power of two split into 128 linear sub-buckets, clamped below 2^50.
+const SUB_BUCKET_BITS = 7;
+const SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+const BUCKETS = SUB_BUCKETS * (51 - SUB_BUCKET_BITS);
+const BATCH = 1024;
+const NS_PER_MS = 1e6;
+
+const bucketFor = (value: number): number => {
+  if (value < SUB_BUCKETS) return value;
+  const high = Math.floor(value / 2 ** 32);
+  const msb = high > 0 ? 63 - Math.clz32(high) : 31 - Math.clz32(value >>> 0);
+  const shift = msb - SUB_BUCKET_BITS;
+  const index = (shift + 1) * SUB_BUCKETS + (Math.floor(value / 2 ** shift) & (SUB_BUCKETS - 1));
+  return Math.min(index, BUCKETS - 1);
+};
+
+const bucketLower = (index: number): number =>
+  index < SUB_BUCKETS
+    ? index
+    : (SUB_BUCKETS + (index % SUB_BUCKETS)) * 2 ** (Math.floor(index / SUB_BUCKETS) - 1);
+
+const bucketWidth = (index: number): number =>
+  index < SUB_BUCKETS ? 1 : 2 ** (Math.floor(index / SUB_BUCKETS) - 1);
+
+/** The JS side of LatencyHistogram when the addon is not loaded. */
+class JsLatencyHistogram implements NativeLatencyHistogram {
+  private counts = new Float64Array(BUCKETS);
+  private total = 0;
+  private sum = 0;
+  private min = Infinity;
+  private max = 0;
+
+  recordBatch(valuesMs: Float64Array, count = valuesMs.length): void {
+    for (let i = 0; i < count; i += 1) {
+      const ms = valuesMs[i];
+      if (Number.isNaN(ms)) continue;
+      const ns = Math.floor(Math.min(Math.max(ms * NS_PER_MS, 0), 1e15));
+      this.counts[bucketFor(ns)] += 1;
+      this.total += 1;
+      this.sum += ns;
+      if (ns < this.min) this.min = ns;
+      if (ns > this.max) this.max = ns;
+    }
+  }
+
+  summary(): LatencyHistogramSummary {
+    const out: LatencyHistogramSummary = {
+      count: this.total,
+      min: 0,
+      max: 0,
+      mean: 0,
+      p50: 0,
+      p90: 0,
+      p99: 0,
+      p999: 0,
+    };
+    if (this.total === 0) return out;
+    out.min = this.min / NS_PER_MS;
+    out.max = this.max / NS_PER_MS;
+    out.mean = this.sum / this.total / NS_PER_MS;
+    let bucket = 0;
+    let seen = 0;
+    for (const [key, quantile] of [
+      ["p50", 0.5],
+      ["p90", 0.9],
+      ["p99", 0.99],
+      ["p999", 0.999],
+    ] as const) {
+      const rank = Math.ceil(quantile * this.total);
+      while (bucket + 1 < BUCKETS && seen + this.counts[bucket] < rank) {
+        seen += this.counts[bucket];
+        bucket += 1;
+      }
+      out[key] = (bucketLower(bucket) + (bucketWidth(bucket) - 1) / 2) / NS_PER_MS;
+    }
+    return out;
+  }
+
+  buckets(): Float64Array {
+    const flat: number[] = [];
+    this.counts.forEach((count, index) => {
+      if (count === 0) return;
+      const lower = bucketLower(index);
+      flat.push(lower / NS_PER_MS, (lower + bucketWidth(index)) / NS_PER_MS, count);
+    });
+    return Float64Array.from(flat);
+  }
+
+  reset(): void {
+    this.counts.fill(0);
+    this.total = 0;
+    this.sum = 0;
+    this.min = Infinity;
+    this.max = 0;
+  }
+}
+
+/**
+ * HDR-style latency histogram (under 0.8% relative error) backed by the lws
+ * addon's LatencyHistogram when it is loaded. record() buffers values and
+ * hands them over 1024 at a time, so a per-message call stays cheap.
+ */
+export class LatencyHistogram {
+  private readonly impl: NativeLatencyHistogram;
+  private readonly pending = new Float64Array(BATCH);
+  private pendingCount = 0;
+  readonly native: boolean;
+
+  constructor(options: LatencyHistogramOptions = {}) {
+    const native = options.native === false ? null : createNativeLatencyHistogram();
+    this.native = native !== null;
+    this.impl = native ?? new JsLatencyHistogram();
+  }
+
+  record(ms: number): void {
+    this.pending[this.pendingCount] = ms;
+    this.pendingCount += 1;
+    if (this.pendingCount === BATCH) this.flush();
+  }
+
+  /** count, min, max, mean and p50 to p99.9, in ms. */
+  summary(): LatencyHistogramSummary {
+    this.flush();
+    return this.impl.summary();
+  }
+
+  /** [lowerMs, upperMs, count] per non-empty bucket, upper exclusive. */
+  buckets(): Array<[number, number, number]> {
+    this.flush();
+    const flat = this.impl.buckets();
+    const out: Array<[number, number, number]> = [];
+    for (let i = 0; i + 2 < flat.length; i += 3) {
+      out.push([flat[i], flat[i + 1], flat[i + 2]]);
+    }
+    return out;
+  }
+
+  reset(): void {
+    this.pendingCount = 0;
+    this.impl.reset();
+  }
+
+  private flush() {
+    if (this.pendingCount === 0) return;
+    this.impl.recordBatch(this.pending, this.pendingCount);
+    this.pendingCount = 0;
+  }
+}
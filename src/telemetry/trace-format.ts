@@ -0,0 +1,275 @@
+// Columnar telemetry trace files (.qwtrace), as TraceRecorder writes them.
+// Little-endian throughout:
+//
+//   file header, 64 bytes: magic "QWTRACE1", u32 version, u32 block header
+//     bytes, u64 committed (end of the last complete block), u64 index
+//     offset (0 while recording), u64 block count, f64 created ms
+//   block header, 80 bytes: u32 "QWBK", u32 schema, u32 rows, u32 cols,
+//     f64 t0, f64 t1, 48-byte NUL-padded label
+//   payload: cols columns of rows f64 each, column after column
+//
+// close() appends an index block (schema 0: offset, schema, rows, t0, t1
+// per block) past `committed`. Every offset is a multiple of 8, so columns
+// are Float64Array views straight over the file bytes.
+//
+// No Node imports: bench-visualization reads traces with this in a browser.
+
+export const TRACE_MAGIC = "QWTRACE1";
+export const TRACE_VERSION = 1;
+export const TRACE_FILE_HEADER_BYTES = 64;
+export const TRACE_BLOCK_HEADER_BYTES = 80;
+export const TRACE_LABEL_BYTES = 48;
+const BLOCK_MAGIC = 0x4b425751;
+const INDEX_SCHEMA = 0;
+
+/** The fixed schemas; a block's columns are always these, in this order. */
+export const TraceSchemas = {
+  flush: { id: 1, columns: ["atMs", "bytes", "frames"] },
+  backpressure: { id: 2, columns: ["atMs"] },
+  slice: { id: 3, columns: ["atMs", "size"] },
+  histogram: { id: 4, columns: ["lower", "upper", "count"] },
+  benchScenario: {
+    id: 5,
+    columns: [
+      "concurrency",
+      "messagesReceived",
+      "bytesReceived",
+      "durationMs",
+      "msgsPerSec",
+      "mbPerSec",
+      "transportSNI",
+      "transportSPI",
+      "transportMetastability",
+    ],
+  },
+  benchLatency: {
+    id: 6,
+    columns: ["count", "p50Ms", "p90Ms", "p99Ms", "p999Ms", "maxMs"],
+  },
+  soak: {
+    id: 7,
+    columns: [
+      "atMs",
+      "rssBytes",
+      "heapUsedBytes",
+      "externalBytes",
+      "nativeConnectionBytes",
+      "bufferPoolCachedBytes",
+      "bufferPoolInUseBytes",
+      "serverQueuedBytes",
+      "clientQueuedBytes",
+      "clientRxBufferedBytes",
+      "tsfnPending",
+      "tsfnPendingBytes",
+      "connections",
+    ],
+  },
+} as const;
+
+export type TraceSchemaName = keyof typeof TraceSchemas;
+
+const schemaNamesById = new Map<number, TraceSchemaName>(
+  (Object.keys(TraceSchemas) as TraceSchemaName[]).map(name => [
+    TraceSchemas[name].id,
+    name,
+  ]),
+);
+
+export type TraceBlock = {
+  offset: number;
+  /** Schema name, or the raw id for a schema this build does not know. */
+  schema: TraceSchemaName | number;
+  label: string;
+  rows: number;
+  t0: number;
+  t1: number;
+  /** Views over the trace bytes, keyed by column name. */
+  columns: Record<string, Float64Array>;
+};
+
+export type TelemetryTrace = {
+  createdAt: number;
+  /** False for a capture still recording (or cut short): no index yet. */
+  indexed: boolean;
+  blocks: TraceBlock[];
+  /**
+   * One column across every block of `schema` (optionally only those
+   * labelled `label`), in file order. A view when a single block matches.
+   */
+  column(schema: TraceSchemaName, name: string, label?: string): Float64Array;
+};
+
+const textEncoder = new TextEncoder();
+const textDecoder = new TextDecoder();
+
+export const encodeTraceFileHeader = (header: {
+  committed: number;
+  indexOffset: number;
+  blocks: number;
+  createdMs: number;
+}): Uint8Array => {
+  const out = new Uint8Array(TRACE_FILE_HEADER_BYTES);
+  const view = new DataView(out.buffer);
+  out.set(textEncoder.encode(TRACE_MAGIC), 0);
+  view.setUint32(8, TRACE_VERSION, true);
+  view.setUint32(12, TRACE_BLOCK_HEADER_BYTES, true);
+  view.setBigUint64(16, BigInt(header.committed), true);
+  view.setBigUint64(24, BigInt(header.indexOffset), true);
+  view.setBigUint64(32, BigInt(header.blocks), true);
+  view.setFloat64(40, header.createdMs, true);
+  return out;
+};
+
+export const encodeTraceBlockHeader = (block: {
+  schema: number;
+  label: string;
+  rows: number;
+  cols: number;
+  t0: number;
+  t1: number;
+}): Uint8Array => {
+  const out = new Uint8Array(TRACE_BLOCK_HEADER_BYTES);
+  const view = new DataView(out.buffer);
+  view.setUint32(0, BLOCK_MAGIC, true);
+  view.setUint32(4, block.schema, true);
+  view.setUint32(8, block.rows, true);
+  view.setUint32(12, block.cols, true);
+  view.setFloat64(16, block.t0, true);
+  view.setFloat64(24, block.t1, true);
+  out.set(textEncoder.encode(block.label).subarray(0, TRACE_LABEL_BYTES - 1), 32);
+  return out;
+};
+
+type RawBlock = {
+  offset: number;
+  schema: number;
+  label: string;
+  rows: number;
+  cols: number;
+  t0: number;
+  t1: number;
+};
+
+const readBlockHeader = (view: DataView, offset: number): RawBlock | null => {
+  if (offset + TRACE_BLOCK_HEADER_BYTES > view.byteLength) return null;
+  if (view.getUint32(offset, true) !== BLOCK_MAGIC) return null;
+  const labelBytes = new Uint8Array(
+    view.buffer,
+    view.byteOffset + offset + 32,
+    TRACE_LABEL_BYTES,
+  );
+  const end = labelBytes.indexOf(0);
+  return {
+    offset,
+    schema: view.getUint32(offset + 4, true),
+    rows: view.getUint32(offset + 8, true),
+    cols: view.getUint32(offset + 12, true),
+    t0: view.getFloat64(offset + 16, true),
+    t1: view.getFloat64(offset + 24, true),
+    label: textDecoder.decode(labelBytes.subarray(0, end < 0 ? TRACE_LABEL_BYTES : end)),
+  };
+};
+
+const blockEnd = (block: RawBlock) =>
+  block.offset + TRACE_BLOCK_HEADER_BYTES + block.rows * block.cols * 8;
+
+/** Walks block headers from the file header up to `committed`. */
+const scanBlocks = (view: DataView, committed: number): RawBlock[] => {
+  const blocks: RawBlock[] = [];
+  let offset = TRACE_FILE_HEADER_BYTES;
+  while (offset < committed) {
+    const block = readBlockHeader(view, offset);
+    if (!block || blockEnd(block) > committed) break;
+    blocks.push(block);
+    offset = blockEnd(block);
+  }
+  return blocks;
+};
+
+/**
+ * Parses a trace (a file read whole, or mapped with mapNativeTraceFile()).
+ * Only headers are read up front; column data stays where it is.
+ */
+export function readTelemetryTrace(data: ArrayBuffer | ArrayBufferView): TelemetryTrace {
+  let bytes =
+    data instanceof ArrayBuffer
+      ? new Uint8Array(data)
+      : new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+  // Float64Array views need 8-byte alignment; pooled Buffers may lack it.
+  if (bytes.byteOffset % 8 !== 0) bytes = bytes.slice();
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+  if (
+    bytes.byteLength < TRACE_FILE_HEADER_BYTES ||
+    textDecoder.decode(bytes.subarray(0, 8)) !== TRACE_MAGIC ||
+    view.getUint32(8, true) !== TRACE_VERSION
+  ) {
+    throw new Error("Not a QWormhole telemetry trace");
+  }
+  const committed = Math.min(Number(view.getBigUint64(16, true)), bytes.byteLength);
+  const indexOffset = Number(view.getBigUint64(24, true));
+  const createdAt = view.getFloat64(40, true);
+
+  let raw: RawBlock[] | null = null;
+  const index = indexOffset > 0 ? readBlockHeader(view, indexOffset) : null;
+  if (index && index.schema === INDEX_SCHEMA && blockEnd(index) <= bytes.byteLength) {
+    const offsets = new Float64Array(
+      bytes.buffer,
+      bytes.byteOffset + index.offset + TRACE_BLOCK_HEADER_BYTES,
+      index.rows,
+    );
+    raw = [];
+    for (let i = 0; i < index.rows; i += 1) {
+      const block = readBlockHeader(view, offsets[i]);
+      if (!block || blockEnd(block) > bytes.byteLength) {
+        raw = null;
+        break;
+      }
+      raw.push(block);
+    }
+  }
+  const indexed = raw !== null;
+  raw ??= scanBlocks(view, committed);
+
+  const blocks: TraceBlock[] = raw.map(block => {
+    const schema = schemaNamesById.get(block.schema) ?? block.schema;
+    const names: readonly string[] =
+      typeof schema === "number" ? [] : TraceSchemas[schema].columns;
+    const columns: Record<string, Float64Array> = {};
+    for (let c = 0; c < block.cols; c += 1) {
+      columns[names[c] ?? `c${c}`] = new Float64Array(
+        bytes.buffer,
+        bytes.byteOffset + block.offset + TRACE_BLOCK_HEADER_BYTES + c * block.rows * 8,
+        block.rows,
+      );
+    }
+    return {
+      offset: block.offset,
+      schema,
+      label: block.label,
+      rows: block.rows,
+      t0: block.t0,
+      t1: block.t1,
+      columns,
+    };
+  });
+
+  return {
+    createdAt,
+    indexed,
+    blocks,
+    column(schema, name, label) {
+      const parts = blocks
+        .filter(block => block.schema === schema && (label === undefined || block.label === label))
+        .map(block => block.columns[name])
+        .filter((part): part is Float64Array => part !== undefined);
+      if (parts.length === 1) return parts[0];
+      const out = new Float64Array(parts.reduce((acc, part) => acc + part.length, 0));
+      let at = 0;
+      for (const part of parts) {
+        out.set(part, at);
+        at += part.length;
+      }
+      return out;
+    },
+  };
+}
@@ -0,0 +1,255 @@
+import fs from "node:fs";
+import {
+  createNativeTraceRecorder,
+  mapNativeTraceFile,
+  type NativeTraceRecorder,
+} from "../core/NativeTCPClient";
+import {
+  TRACE_BLOCK_HEADER_BYTES,
+  TRACE_FILE_HEADER_BYTES,
+  TraceSchemas,
+  encodeTraceBlockHeader,
+  encodeTraceFileHeader,
+  readTelemetryTrace,
+  type TelemetryTrace,
+  type TraceSchemaName,
+} from "./trace-format";
+
+export type TelemetryTraceRecorderOptions = {
+  /** Rows buffered per schema and label before they go out as one block (default 4096). */
+  blockRows?: number;
+  /** Initial size of the native file mapping (default 1 MiB); it doubles as needed. */
+  initialBytes?: number;
+  /** false keeps the JS file writer even with the lws addon loaded. */
+  native?: boolean;
+};
+
+type IndexEntry = { offset: number; schema: number; rows: number; t0: number; t1: number };
+
+const INDEX_COLUMNS = 5;
+
+/**
+ * The same file layout as the native TraceRecorder, written with
+ * positional fs writes: the block, then the header's `committed`.
+ */
+class FileTraceSink implements NativeTraceRecorder {
+  private fd: number;
+  private committed = TRACE_FILE_HEADER_BYTES;
+  private createdMs = Date.now();
+  private readonly index: IndexEntry[] = [];
+
+  constructor(path: string) {
+    const existing = fs.existsSync(path) ? fs.statSync(path).size : 0;
+    if (existing > 0) {
+      const trace = readTelemetryTrace(fs.readFileSync(path));
+      this.createdMs = trace.createdAt;
+      for (const block of trace.blocks) {
+        this.index.push({
+          offset: block.offset,
+          schema: typeof block.schema === "number" ? block.schema : TraceSchemas[block.schema].id,
+          rows: block.rows,
+          t0: block.t0,
+          t1: block.t1,
+        });
+        this.committed = block.offset + TRACE_BLOCK_HEADER_BYTES +
+          block.rows * Object.keys(block.columns).length * 8;
+      }
+    }
+    this.fd = fs.openSync(path, existing > 0 ? "r+" : "w+");
+    fs.ftruncateSync(this.fd, this.committed);
+    this.writeHeader(0);
+  }
+
+  append(
+    schema: number,
+    label: string,
+    columns: Float64Array,
+    rows: number,
+    t0 = 0,
+    t1 = t0,
+  ): number {
+    if (this.fd < 0) throw new Error("TraceRecorder: trace recorder is closed");
+    const offset = this.committed;
+    const header = encodeTraceBlockHeader({
+      schema,
+      label,
+      rows,
+      cols: columns.length / rows,
+      t0,
+      t1,
+    });
+    fs.writeSync(this.fd, header, 0, header.length, offset);
+    const payload = new Uint8Array(columns.buffer, columns.byteOffset, columns.byteLength);
+    fs.writeSync(this.fd, payload, 0, payload.length, offset + header.length);
+    this.committed = offset + header.length + payload.length;
+    this.index.push({ offset, schema, rows, t0, t1 });
+    this.writeHeader(0);
+    return offset;
+  }
+
+  stats() {
+    return { blocks: this.index.length, bytes: this.committed };
+  }
+
+  close(): void {
+    if (this.fd < 0) return;
+    const n = this.index.length;
+    const columns = new Float64Array(n * INDEX_COLUMNS);
+    this.index.forEach((entry, i) => {
+      columns[i] = entry.offset;
+      columns[n + i] = entry.schema;
+      columns[2 * n + i] = entry.rows;
+      columns[3 * n + i] = entry.t0;
+      columns[4 * n + i] = entry.t1;
+    });
+    const dataEnd = this.committed;
+    const header = encodeTraceBlockHeader({
+      schema: 0,
+      label: "index",
+      rows: n,
+      cols: INDEX_COLUMNS,
+      t0: 0,
+      t1: 0,
+    });
+    fs.writeSync(this.fd, header, 0, header.length, dataEnd);
+    fs.writeSync(
+      this.fd,
+      new Uint8Array(columns.buffer),
+      0,
+      columns.byteLength,
+      dataEnd + header.length,
+    );
+    this.writeHeader(dataEnd);
+    fs.closeSync(this.fd);
+    this.fd = -1;
+  }
+
+  private writeHeader(indexOffset: number) {
+    const header = encodeTraceFileHeader({
+      committed: this.committed,
+      indexOffset,
+      blocks: this.index.length,
+      createdMs: this.createdMs,
+    });
+    fs.writeSync(this.fd, header, 0, header.length, 0);
+  }
+}
+
+type PendingBlock = {
+  schema: TraceSchemaName;
+  label: string;
+  columns: Float64Array[];
+  rows: number;
+  firstAt: number;
+  lastAt: number;
+};
+
+/**
+ * Appends fixed-schema telemetry rows to a trace file as columnar blocks,
+ * through the lws addon's memory-mapped TraceRecorder when it is loaded.
+ * Rows are buffered per schema and label; flush() or `blockRows` rows write
+ * a block. An existing trace at `path` is appended to. Read it back with
+ * openTelemetryTrace().
+ */
+export class TelemetryTraceRecorder {
+  private readonly sink: NativeTraceRecorder;
+  private readonly blockRows: number;
+  private readonly pending = new Map<string, PendingBlock>();
+  readonly native: boolean;
+
+  constructor(
+    readonly path: string,
+    options: TelemetryTraceRecorderOptions = {},
+  ) {
+    this.blockRows = Math.max(1, options.blockRows ?? 4096);
+    const native =
+      options.native === false ? null : createNativeTraceRecorder(path, options.initialBytes);
+    this.native = native !== null;
+    this.sink = native ?? new FileTraceSink(path);
+  }
+
+  /** One row, in the schema's column order. */
+  record(schema: TraceSchemaName, row: ArrayLike<number>, label = ""): void {
+    const key = `${schema}\u0000${label}`;
+    let block = this.pending.get(key);
+    if (!block) {
+      const now = Date.now();
+      block = {
+        schema,
+        label,
+        columns: TraceSchemas[schema].columns.map(() => new Float64Array(this.blockRows)),
+        rows: 0,
+        firstAt: now,
+        lastAt: now,
+      };
+      this.pending.set(key, block);
+    }
+    for (let c = 0; c < block.columns.length; c += 1) {
+      block.columns[c][block.rows] = Number(row[c] ?? NaN);
+    }
+    block.rows += 1;
+    block.lastAt = Date.now();
+    if (block.rows === this.blockRows) this.flushBlock(key, block);
+  }
+
+  /** Columns already gathered, one array per schema column, as one block. */
+  writeBlock(schema: TraceSchemaName, columns: ArrayLike<number>[], label = ""): void {
+    const names = TraceSchemas[schema].columns;
+    const rows = columns[0]?.length ?? 0;
+    if (columns.length !== names.length || columns.some(column => column.length !== rows)) {
+      throw new Error(`${schema} blocks take ${names.length} equal-length columns`);
+    }
+    if (rows === 0) return;
+    const packed = new Float64Array(rows * names.length);
+    columns.forEach((column, c) => packed.set(column, c * rows));
+    const [t0, t1] = this.timeRange(schema, packed, rows, Date.now(), Date.now());
+    this.sink.append(TraceSchemas[schema].id, label, packed, rows, t0, t1);
+  }
+
+  flush(): void {
+    for (const [key, block] of this.pending) this.flushBlock(key, block);
+  }
+
+  stats(): { blocks: number; bytes: number; native: boolean } {
+    return { ...this.sink.stats(), native: this.native };
+  }
+
+  close(): void {
+    this.flush();
+    this.sink.close();
+  }
+
+  private flushBlock(key: string, block: PendingBlock) {
+    this.pending.delete(key);
+    const { rows } = block;
+    const packed = new Float64Array(rows * block.columns.length);
+    block.columns.forEach((column, c) => packed.set(column.subarray(0, rows), c * rows));
+    const [t0, t1] = this.timeRange(block.schema, packed, rows, block.firstAt, block.lastAt);
+    this.sink.append(TraceSchemas[block.schema].id, block.label, packed, rows, t0, t1);
+  }
+
+  // Event schemas span their atMs column; the rest the time they were recorded.
+  private timeRange(
+    schema: TraceSchemaName,
+    packed: Float64Array,
+    rows: number,
+    firstAt: number,
+    lastAt: number,
+  ): [number, number] {
+    if (TraceSchemas[schema].columns[0] !== "atMs") return [firstAt, lastAt];
+    let t0 = Infinity;
+    let t1 = -Infinity;
+    for (let i = 0; i < rows; i += 1) {
+      t0 = Math.min(t0, packed[i]);
+      t1 = Math.max(t1, packed[i]);
+    }
+    return [t0, t1];
+  }
+}
+
+/**
+ * A trace file, memory-mapped through the lws addon when it is loaded
+ * (columns page in as they are read) and read whole otherwise.
+ */
+export const openTelemetryTrace = (path: string): TelemetryTrace =>
+  readTelemetryTrace(mapNativeTraceFile(path) ?? fs.readFileSync(path));
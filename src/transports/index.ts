@@ -4,4 +4,5 @@ export * from './factory';
 export * from './transport';
 export * from './kcp';
 export * from './quic';
+export * from './udp';
 export * from './ws';
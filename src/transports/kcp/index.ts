@@ -4,6 +4,7 @@ export * from './kcp-client';
 export * from './kcp-config';
 export * from './kcp-encode';
 export * from './kcp-header';
+export * from './kcp-native';
 export * from './kcp-server';
 export * from './kcp-session';
 export * from './start-client';
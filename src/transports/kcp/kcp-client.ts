@@ -11,13 +11,15 @@
 // export function verifyHandshake(handshake: SCPHandshake): boolean {
 
 //implement a KCP client that uses MuxSession for multiplexing streams over a KCP transport
-import dgram from "dgram";
 import { EventEmitter } from "node:events";
 import { KcpConfig, DEFAULT_KCP_CONFIG } from "./kcp-config";
 import { MuxSession } from "../mux/mux-session";
 import type { QWormholeTransport } from "../transport";
+import { createDatagramSocket, type DatagramSocket } from "../udp/native-udp";
 export interface KcpClientOptions extends KcpConfig {
   localPort?: number;
+  /** Use the libsocket addon's batched UDP socket when it is available. */
+  nativeUdp?: boolean;
 }
 /**
  * KCP client that connects to a remote KCP server over UDP.
@@ -26,7 +28,7 @@ export interface KcpClientOptions extends KcpConfig {
  */
 export class KcpClient extends EventEmitter implements QWormholeTransport {
   readonly type: "kcp" = "kcp";
-  private socket: dgram.Socket;
+  private socket: DatagramSocket;
   private keepalive?: NodeJS.Timeout
   private lastActivity = Date.now();
   public readonly mux: MuxSession;
@@ -41,7 +43,7 @@ export class KcpClient extends EventEmitter implements QWormholeTransport {
       ...cfg,
       nodelay: { ...DEFAULT_KCP_CONFIG.nodelay, ...(cfg.nodelay ?? {}) },
     };
-    this.socket = dgram.createSocket("udp4");
+    this.socket = createDatagramSocket({ native: cfg.nativeUdp });
     if (cfg.localPort) {
       this.socket.bind(cfg.localPort);
     }
@@ -0,0 +1,171 @@
+import { EventEmitter } from "node:events";
+import {
+  getNativeKcpEngine,
+  type NativeKcpEngineHandle,
+} from "../../core/NativeTCPClient";
+import type {
+  NativeImpairmentOptions,
+  NativeKcpEngineStats,
+  NativeKcpFecOptions,
+  NativeKcpSessionStats,
+} from "../../types/types";
+import { MuxSession } from "../mux/mux-session";
+import { DEFAULT_KCP_CONFIG, KcpConfig } from "./kcp-config";
+
+export interface NativeKcpServerOptions extends KcpConfig {
+  listenPort: number;
+  host?: string;
+  ipv6?: boolean;
+  /** Sessions silent for this long are ended (default 30000). */
+  idleTimeoutMs?: number;
+  /** Ping interval for sessions opened with connect() (default 5000). */
+  keepaliveMs?: number;
+  /** Retransmissions of one segment before the session is dropped (default 20). */
+  deadLink?: number;
+  /** Seeded datagram loss on the way out, for benchmarks; getStats() counts it. */
+  impairment?: Pick<NativeImpairmentOptions, "loss" | "seed">;
+  /**
+   * Reed-Solomon parity so most losses are repaired without a retransmit
+   * round trip; `true` is 8 data to 2 parity. The peer needs it too.
+   */
+  fec?: boolean | NativeKcpFecOptions;
+}
+
+type EngineMessage = {
+  session: string;
+  address: string;
+  port: number;
+  data: Buffer;
+};
+
+/** True when qwormhole.node exposes the native KCP engine. */
+export const isNativeKcpAvailable = (): boolean =>
+  Boolean(getNativeKcpEngine());
+
+/**
+ * KcpServer counterpart whose ARQ loop (acks, RTO, fast resend, windows)
+ * runs on the libsocket addon's own thread. Speaks the same wire format as
+ * KcpSession; in-order payloads are handed to each session's mux.
+ */
+export class NativeKcpServer extends EventEmitter {
+  private readonly engine: NativeKcpEngineHandle;
+  private readonly sessions = new Map<string, MuxSession>();
+  private boundPort: number | undefined;
+  private started = false;
+
+  constructor(private opts: NativeKcpServerOptions) {
+    super();
+    const EngineCtor = getNativeKcpEngine();
+    if (!EngineCtor) {
+      throw new Error(
+        "Native KCP requires the libsocket backend (qwormhole.node). Run `pnpm run rebuild` or use KcpServer.",
+      );
+    }
+    const nodelay = { ...DEFAULT_KCP_CONFIG.nodelay, ...(opts.nodelay ?? {}) };
+    this.engine = new EngineCtor({
+      host: opts.host ?? (opts.ipv6 ? "::" : "0.0.0.0"),
+      port: opts.listenPort,
+      type: opts.ipv6 ? "udp6" : "udp4",
+      conv: opts.conv ?? 1,
+      mtu: opts.mtu ?? DEFAULT_KCP_CONFIG.mtu,
+      sndWnd: opts.sndWnd ?? DEFAULT_KCP_CONFIG.sndWnd,
+      rcvWnd: opts.rcvWnd ?? DEFAULT_KCP_CONFIG.rcvWnd,
+      nodelay,
+      deadLink: opts.deadLink,
+      idleTimeoutMs: opts.idleTimeoutMs,
+      keepaliveMs: opts.keepaliveMs,
+      impairment: opts.impairment,
+      fec: opts.fec,
+    });
+    this.engine.emit = (event: string, payload?: unknown) => {
+      this.routeEngineEvent(event, payload);
+      return true;
+    };
+  }
+
+  async start(): Promise<number> {
+    if (this.started) return this.boundPort ?? this.opts.listenPort;
+    const address = await this.engine.bind();
+    this.boundPort = address.port;
+    this.started = true;
+    return address.port;
+  }
+
+  /**
+   * Open an outbound session. The mux is usable right away; writes queue in
+   * the engine behind the open. "session" still fires for it.
+   */
+  connect(address: string, port: number): { key: string; mux: MuxSession } {
+    const key = this.engine.connect(address, port);
+    return { key, mux: this.muxFor(key) };
+  }
+
+  stop(): void {
+    if (!this.started) return;
+    this.started = false;
+    this.engine.close();
+  }
+
+  getPort(): number | undefined {
+    return this.boundPort;
+  }
+
+  getStats(): NativeKcpEngineStats {
+    return this.engine.getStats();
+  }
+
+  getSession(key: string): NativeKcpSessionStats | undefined {
+    return this.engine.getSession(key);
+  }
+
+  private routeEngineEvent(event: string, payload: unknown): void {
+    switch (event) {
+      case "listening":
+        this.emit("listening", { port: (payload as { port: number }).port });
+        return;
+      case "session": {
+        const { key } = payload as { key: string };
+        this.emit("session", { key, mux: this.muxFor(key) });
+        return;
+      }
+      case "message":
+        this.deliver(payload as EngineMessage);
+        return;
+      case "messages":
+        for (const message of payload as EngineMessage[]) {
+          this.deliver(message);
+        }
+        return;
+      case "session:end": {
+        const { key, reason } = payload as { key: string; reason: string };
+        this.sessions.delete(key);
+        this.emit("session:end", key, reason);
+        return;
+      }
+      case "error":
+        this.emit("error", payload as Error);
+        return;
+      case "close":
+        this.sessions.clear();
+        this.emit("close");
+        return;
+      default:
+        return;
+    }
+  }
+
+  private muxFor(key: string): MuxSession {
+    let mux = this.sessions.get(key);
+    if (!mux) {
+      mux = new MuxSession(buf => {
+        this.engine.send(key, Buffer.from(buf.buffer, buf.byteOffset, buf.byteLength));
+      });
+      this.sessions.set(key, mux);
+    }
+    return mux;
+  }
+
+  private deliver(message: EngineMessage): void {
+    this.sessions.get(message.session)?.receiveRaw(message.data);
+  }
+}
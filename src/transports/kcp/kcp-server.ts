@@ -1,10 +1,12 @@
-import dgram from "dgram";
 import { EventEmitter } from "node:events";
 import { MuxSession } from "../mux/mux-session";
+import { createDatagramSocket, type DatagramSocket } from "../udp/native-udp";
 import { DEFAULT_KCP_CONFIG, KcpConfig } from "./kcp-config";
 
 export interface KcpServerOptions extends KcpConfig {
   listenPort: number;
+  /** Use the libsocket addon's batched UDP socket when it is available. */
+  nativeUdp?: boolean;
 }
 
 type WireType = 0 | 1 | 2; // data, ack, ping
@@ -52,7 +54,7 @@ interface SessionState {
  * Mirrors the client wire format for true KCP↔KCP reliability.
  */
 export class KcpServer extends EventEmitter {
-  private socket: dgram.Socket;
+  private socket: DatagramSocket;
   private sessions = new Map<string, SessionState>();
   private timer?: NodeJS.Timeout;
   private boundPort: number | undefined;
@@ -65,7 +67,7 @@ export class KcpServer extends EventEmitter {
 
   constructor(private opts: KcpServerOptions) {
     super();
-    this.socket = dgram.createSocket("udp4");
+    this.socket = createDatagramSocket({ native: opts.nativeUdp });
     this.conv = opts.conv ?? 1;
     this.sndWnd = opts.sndWnd ?? DEFAULT_KCP_CONFIG.sndWnd;
     this.rcvWnd = opts.rcvWnd ?? DEFAULT_KCP_CONFIG.rcvWnd;
@@ -1,8 +1,8 @@
-import dgram from "dgram";
 import { EventEmitter } from "node:events";
 import { KcpConfig, DEFAULT_KCP_CONFIG } from "./kcp-config";
 import { MuxSession } from "../mux/mux-session";
 import type { QWormholeTransport } from "../transport";
+import { createDatagramSocket, type DatagramSocket } from "../udp/native-udp";
 
 export interface KcpEndpoint {
   address: string;
@@ -11,6 +11,8 @@ export interface KcpEndpoint {
 
 export interface KcpSessionOptions extends KcpConfig {
   localPort?: number;
+  /** Use the libsocket addon's batched UDP socket when it is available. */
+  nativeUdp?: boolean;
 }
 
 type WireType = 0 | 1 | 2; // data, ack, ping
@@ -33,7 +35,7 @@ const DEFAULT_INTERVAL_MS = 10;
  */
 export class KcpSession extends EventEmitter implements QWormholeTransport {
   readonly type = "kcp" as const;
-  private socket: dgram.Socket;
+  private socket: DatagramSocket;
   private keepalive?: NodeJS.Timeout;
   private retransmit?: NodeJS.Timeout;
   private lastActivity = Date.now();
@@ -85,7 +87,7 @@ export class KcpSession extends EventEmitter implements QWormholeTransport {
     this.sndWnd = this.cfg.sndWnd;
     this.rcvWnd = this.cfg.rcvWnd;
     this.mtu = this.cfg.mtu;
-    this.socket = dgram.createSocket("udp4");
+    this.socket = createDatagramSocket({ native: cfg.nativeUdp });
     if (cfg.localPort) {
       this.socket.bind(cfg.localPort);
     }
@@ -4,16 +4,24 @@ import { MuxError } from "./mux-error";
 const MUX_DEBUG = process.env.QW_KCP_DEBUG === "1";
 
 // Simple varint helpers (unsigned)
-function encodeVarint(value: number): Uint8Array {
-  const bytes: number[] = [];
+function varintLength(value: number): number {
   let v = value >>> 0;
+  let len = 1;
   while (v >= 0x80) {
-    bytes.push((v & 0x7f) | 0x80);
     v >>>= 7;
+    len += 1;
   }
-  bytes.push(v);
-  
-  return Uint8Array.from(bytes);
+  return len;
+}
+
+function writeVarint(out: Uint8Array, offset: number, value: number): number {
+  let v = value >>> 0;
+  while (v >= 0x80) {
+    out[offset++] = (v & 0x7f) | 0x80;
+    v >>>= 7;
+  }
+  out[offset++] = v;
+  return offset;
 }
 
 function decodeVarint(buf: Uint8Array, offset: number): { value: number; read: number } {
@@ -51,33 +59,22 @@ const FRAME_TYPE_CODE: Record<MuxFrameType, number> = {
 
 export class MuxFramer {
   encode(frame: MuxFrame): Uint8Array {
+    // One allocation per frame: size the header, then write it in place.
     const typeCode = FRAME_TYPE_CODE[frame.type];
-    const headerParts: Uint8Array[] = [];
-    headerParts.push(Uint8Array.of(typeCode));
-    headerParts.push(encodeVarint(frame.streamId));
-
-    if (frame.type === "window") {
-      const win = frame.window ?? 0;
-      headerParts.push(encodeVarint(win));
-      const out = concatBuffers(headerParts);
-      if (MUX_DEBUG) {
-        console.log("[mux:encode]", {
-          type: frame.type,
-          streamId: frame.streamId,
-          len: 0,
-        });
-      }
-      return out;
-    }
-
-    const payload = frame.payload ?? new Uint8Array();
-    headerParts.push(encodeVarint(payload.length));
-    const out = concatBuffers([...headerParts, payload]);
+    const isWindow = frame.type === "window";
+    const payload = isWindow ? undefined : (frame.payload ?? new Uint8Array());
+    const tail = isWindow ? (frame.window ?? 0) : payload!.length;
+    const headerLength = 1 + varintLength(frame.streamId) + varintLength(tail);
+    const out = new Uint8Array(headerLength + (payload?.length ?? 0));
+    out[0] = typeCode;
+    let offset = writeVarint(out, 1, frame.streamId);
+    offset = writeVarint(out, offset, tail);
+    if (payload) out.set(payload, offset);
     if (MUX_DEBUG) {
       console.log("[mux:encode]", {
         type: frame.type,
         streamId: frame.streamId,
-        len: payload.length,
+        len: payload?.length ?? 0,
       });
     }
     return out;
@@ -126,14 +123,3 @@ export class MuxFramer {
     return frames;
   }
 }
-
-function concatBuffers(chunks: Uint8Array[]): Uint8Array {
-  const total = chunks.reduce((acc, cur) => acc + cur.length, 0);
-  const out = new Uint8Array(total);
-  let offset = 0;
-  for (const chunk of chunks) {
-    out.set(chunk, offset);
-    offset += chunk.length;
-  }
-  return out;
-}
@@ -1,19 +1,39 @@
 import path from "node:path";
 import { createRequire } from "node:module";
+import { loadNativeAddon } from "../../core/native-addons";
 import type { QuicBinding } from "./types";
 
 let cachedBinding: QuicBinding | null | undefined;
 const requireFn = typeof require === "function" ? require : createRequire(__filename);
 
 const envPath = process.env.QW_QUIC_PATH ?? process.env.QWORMHOLE_QUIC_PATH;
+const platformArch = `${process.platform}-${process.arch}`;
 
+/** `QW_QUIC=0` turns QUIC off even when a binding is present. */
+export const quicDisabled = (): boolean => {
+  const flag = process.env.QW_QUIC ?? process.env.QWORMHOLE_QUIC;
+  return flag === "0" || flag === "false" || flag === "off";
+};
+
+// Probed after the binding manifest, which records whichever one loads.
 const bindingCandidates = [
-  // Explicit override
-  envPath,
   // Development build/Release layout (package root)
   path.join(__dirname, "..", "..", "..", "build", "Release", "qwquic.node"),
   // Dist native layout (package root)
   path.join(__dirname, "..", "..", "..", "dist", "native", "qwquic.node"),
+  // Prebuilt layout shared with qwormhole.node / qwormhole_lws.node
+  path.join(__dirname, "..", "..", "..", "prebuilds", platformArch, "qwquic.node"),
+  path.join(
+    __dirname,
+    "..",
+    "..",
+    "..",
+    "dist",
+    "native",
+    "prebuilds",
+    platformArch,
+    "qwquic.node",
+  ),
   // Workspace-level native target (useful in tests/tsx)
   path.resolve(process.cwd(), "native", "qwquic", "target", "release", "qwquic.dll"),
   path.resolve(process.cwd(), "native", "qwquic", "target", "release", "qwquic.node"),
@@ -41,7 +61,7 @@ const bindingCandidates = [
   },
   // Direct module name (napi-rs default)
   "qwquic",
-].filter(Boolean) as (string | (() => string | null))[];
+] as (string | (() => unknown))[];
 
 const isQuicBinding = (mod: unknown): mod is QuicBinding =>
   Boolean(mod && typeof (mod as QuicBinding).createEndpoint === "function");
@@ -50,33 +70,24 @@ export function loadQuicBinding(): QuicBinding | null {
   if (cachedBinding !== undefined) {
     return cachedBinding;
   }
-  for (const candidate of bindingCandidates) {
-    const resolved = typeof candidate === "function" ? candidate() : candidate;
-    if (!resolved) continue;
-    if (typeof resolved === "object") {
-      if (isQuicBinding(resolved)) {
-        cachedBinding = resolved;
-        if (process.env.QW_QUIC_DEBUG === "1") {
-          console.warn("[qwquic] loaded binding from node-gyp-build");
-        }
-        return cachedBinding;
-      }
-      continue;
-    }
-    try {
-      const mod = requireFn(resolved) as QuicBinding;
-      if (isQuicBinding(mod)) {
-        cachedBinding = mod;
-        if (process.env.QW_QUIC_DEBUG === "1") {
-          console.warn("[qwquic] loaded binding from", resolved);
-        }
-        return cachedBinding;
-      }
-    } catch {
-      if (process.env.QW_QUIC_DEBUG === "1") {
-        console.warn("[qwquic] failed to load", resolved);
-      }
+  if (quicDisabled()) {
+    cachedBinding = null;
+    return cachedBinding;
+  }
+  const mod = loadNativeAddon("qwquic", {
+    overridePath: envPath,
+    extraCandidates: bindingCandidates,
+    useBindings: false,
+  });
+  if (isQuicBinding(mod)) {
+    cachedBinding = mod;
+    if (process.env.QW_QUIC_DEBUG === "1") {
+      console.warn("[qwquic] loaded binding");
     }
+    return cachedBinding;
+  }
+  if (process.env.QW_QUIC_DEBUG === "1") {
+    console.warn("[qwquic] no usable binding found");
   }
   cachedBinding = null;
   return cachedBinding;
@@ -85,3 +96,11 @@ export function loadQuicBinding(): QuicBinding | null {
 export function quicAvailable(): boolean {
   return Boolean(loadQuicBinding());
 }
+
+/** Error text for a QUIC call made without a usable binding. */
+export function quicUnavailableMessage(): string {
+  if (quicDisabled()) {
+    return "QUIC transport disabled (QW_QUIC=0)";
+  }
+  return `QUIC native binding unavailable: no qwquic.node found (set QW_QUIC_PATH, or place it in prebuilds/${platformArch}/ or dist/native/)`;
+}
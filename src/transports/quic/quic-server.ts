@@ -1,6 +1,10 @@
 import { EventEmitter } from "node:events";
 import { Buffer } from "node:buffer";
-import { loadQuicBinding, quicAvailable } from "./quic-binding";
+import {
+  loadQuicBinding,
+  quicAvailable,
+  quicUnavailableMessage,
+} from "./quic-binding";
 import { MuxSession } from "../mux/mux-session";
 import { MuxStream } from "../mux/mux-stream";
 import { BatchFramer } from "../../core/batch-framer";
@@ -848,7 +852,7 @@ export class QuicServer extends EventEmitter {
 
   async listen(): Promise<void> {
     if (!this.binding) {
-      throw new Error("QUIC native binding unavailable");
+      throw new Error(quicUnavailableMessage());
     }
     this.endpoint = this.binding.createEndpoint({
       host: this.opts.host,
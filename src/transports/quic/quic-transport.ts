@@ -1,7 +1,11 @@
 import { EventEmitter } from "node:events";
 import { Buffer } from "node:buffer";
 import type { QWormholeTransport } from "../transport";
-import { loadQuicBinding, quicAvailable } from "./quic-binding";
+import {
+  loadQuicBinding,
+  quicAvailable,
+  quicUnavailableMessage,
+} from "./quic-binding";
 import { MuxSession } from "../mux/mux-session";
 import { MuxStream } from "../mux/mux-stream";
 import { handshakePayloadSchema, type HandshakePayload } from "../../schema/scp";
@@ -107,9 +111,7 @@ export class QuicTransport extends EventEmitter implements QWormholeTransport {
 
   async connect(): Promise<void> {
     if (!this.binding) {
-      throw new Error(
-        "QUIC native binding unavailable. Build or install qwquic.node",
-      );
+      throw new Error(quicUnavailableMessage());
     }
 
     // Create endpoint
@@ -0,0 +1,4 @@
+// Auto-generated index for udp
+export * from './multicast-channel';
+export * from './native-udp';
+export * from './unix-dgram';
@@ -0,0 +1,112 @@
+import { EventEmitter } from "node:events";
+import {
+  getNativeMulticast,
+  type NativeMulticastHandle,
+  type NativeMulticastOptions,
+  type NativeMulticastStats,
+} from "../../core/NativeTCPClient";
+
+export type MulticastChannelOptions = NativeMulticastOptions;
+
+export interface MulticastMessageInfo {
+  /** The sending node's random id for this channel's lifetime. */
+  source: number;
+  address: string;
+  port: number;
+  seq: number;
+}
+
+export interface MulticastLoss {
+  source: number;
+  address: string;
+  port: number;
+  /** First sequence number lost, and how many. */
+  from: number;
+  count: number;
+}
+
+type NativeMulticastMessage = MulticastMessageInfo & { data: Buffer };
+
+/** True when qwormhole.node exposes the multicast channel. */
+export const isNativeMulticastAvailable = (): boolean => Boolean(getNativeMulticast());
+
+/**
+ * Reliable fan-out to every subscriber on the local segment: each send()
+ * is one datagram to the group, however many nodes listen. Every node is
+ * both a source and a receiver. Sources keep a window of what they sent,
+ * and a receiver missing frames NACKs the source, which repairs them
+ * unicast to that receiver alone. A frame many receivers miss goes back to
+ * the group once instead. Frames arrive in order per source, as "message"
+ * (data, info) and once per native batch as "messages". What a source can
+ * no longer repair is reported as "loss"; resync that peer out of band,
+ * for example over its unicast connection.
+ */
+export class NativeMulticastChannel extends EventEmitter {
+  private readonly handle: NativeMulticastHandle;
+  private closed = false;
+
+  constructor(options: MulticastChannelOptions = {}) {
+    super();
+    const MulticastCtor = getNativeMulticast();
+    if (!MulticastCtor) {
+      throw new Error(
+        "Native multicast requires the libsocket backend (qwormhole.node). Run `pnpm run rebuild`.",
+      );
+    }
+    this.handle = new MulticastCtor(options);
+    this.handle.emit = (event: string, payload?: unknown) => {
+      this.routeNativeEvent(event, payload);
+      return true;
+    };
+  }
+
+  /** Joins the group; resolves with it and this node's source id. */
+  start(): Promise<{ group: string; port: number; family: string; sourceId: number }> {
+    return this.handle.start();
+  }
+
+  /**
+   * Sends one frame to the group; its sequence number, or false before
+   * start() or after close(). Throws past `maxPayloadBytes`.
+   */
+  send(payload: Buffer | string): number | false {
+    if (this.closed) return false;
+    return this.handle.send(typeof payload === "string" ? Buffer.from(payload) : payload);
+  }
+
+  getStats(): NativeMulticastStats {
+    return this.handle.getStats();
+  }
+
+  close(): void {
+    if (this.closed) return;
+    this.closed = true;
+    this.handle.close();
+  }
+
+  private routeNativeEvent(event: string, payload: unknown): void {
+    switch (event) {
+      case "messages": {
+        const messages = payload as NativeMulticastMessage[];
+        this.emit("messages", messages);
+        for (const { data, ...info } of messages) {
+          this.emit("message", data, info satisfies MulticastMessageInfo);
+        }
+        return;
+      }
+      case "loss":
+        this.emit("loss", payload as MulticastLoss);
+        return;
+      case "close":
+        this.emit("close");
+        return;
+      default:
+        return;
+    }
+  }
+}
+
+/** A NativeMulticastChannel; throws without the libsocket addon. */
+export const createMulticastChannel = (
+  options: MulticastChannelOptions = {},
+): NativeMulticastChannel => new NativeMulticastChannel(options);
@@ -0,0 +1,201 @@
+import dgram from "dgram";
+import { EventEmitter } from "node:events";
+import type { AddressInfo } from "node:net";
+import {
+  getNativeUdpSocket,
+  type NativeUdpSocketHandle,
+} from "../../core/NativeTCPClient";
+import type { NativeUdpSocketStats } from "../../types/types";
+
+export interface NativeDatagramSocketOptions {
+  type?: "udp4" | "udp6";
+  /** Datagrams per recvmmsg call and per "messages" event (default 32). */
+  batchSize?: number;
+  /** Receive slot size; larger datagrams are dropped (default 65536). */
+  maxDatagramBytes?: number;
+  /** Ask the kernel to coalesce runs of equal datagrams (UDP GRO). */
+  gro?: boolean;
+}
+
+export interface DatagramRemoteInfo {
+  address: string;
+  family: "IPv4" | "IPv6";
+  port: number;
+  size: number;
+}
+
+/**
+ * The slice of dgram.Socket the KCP transports use; NativeDatagramSocket
+ * and dgram.Socket both satisfy it.
+ */
+export interface DatagramSocket {
+  bind(port?: number, address?: string): unknown;
+  send(
+    msg: Uint8Array,
+    offset: number,
+    length: number,
+    port: number,
+    address?: string,
+  ): void;
+  address(): AddressInfo | string;
+  close(): void;
+  on(
+    event: "message",
+    listener: (msg: Buffer, rinfo: DatagramRemoteInfo) => void,
+  ): this;
+  once(event: "listening", listener: () => void): this;
+  once(event: "error", listener: (err: Error) => void): this;
+  off(event: string, listener: (...args: never[]) => void): this;
+}
+
+type NativeDatagram = { data: Buffer; address: string; port: number };
+
+/** True when qwormhole.node exposes the batched UDP socket. */
+export const isNativeUdpAvailable = (): boolean => Boolean(getNativeUdpSocket());
+
+/**
+ * dgram.Socket stand-in on the libsocket addon's UDP socket. A native thread
+ * receives with recvmmsg into pooled blocks and hands a whole batch over in
+ * one call; sends made in the same tick leave as one sendmmsg. Emits
+ * dgram-style "message" per datagram and "messages" once per batch.
+ */
+export class NativeDatagramSocket extends EventEmitter implements DatagramSocket {
+  private handle: NativeUdpSocketHandle | undefined;
+  private readonly outbox: NativeDatagram[] = [];
+  private flushQueued = false;
+  private closed = false;
+
+  constructor(private readonly opts: NativeDatagramSocketOptions = {}) {
+    super();
+    if (!getNativeUdpSocket()) {
+      throw new Error(
+        "Native UDP requires the libsocket backend (qwormhole.node). Run `pnpm run rebuild` or use node:dgram.",
+      );
+    }
+  }
+
+  /** Binds right away; "listening" follows. Port 0 picks a free port. */
+  bind(port = 0, address?: string): this {
+    if (this.handle || this.closed) return this;
+    const SocketCtor = getNativeUdpSocket()!;
+    const ipv6 = this.opts.type === "udp6";
+    this.handle = new SocketCtor({
+      host: address ?? (ipv6 ? "::" : "0.0.0.0"),
+      port,
+      type: ipv6 ? "udp6" : "udp4",
+      batchSize: this.opts.batchSize,
+      maxDatagramBytes: this.opts.maxDatagramBytes,
+      gro: this.opts.gro,
+    });
+    this.handle.emit = (event: string, payload?: unknown) => {
+      this.routeNativeEvent(event, payload);
+      return true;
+    };
+    this.handle.bind().catch((err: Error) => this.emit("error", err));
+    return this;
+  }
+
+  /** Queues one datagram; everything queued this tick goes out together. */
+  send(
+    msg: Uint8Array,
+    offset: number,
+    length: number,
+    port: number,
+    address?: string,
+  ): void {
+    if (this.closed) return;
+    if (!this.handle) this.bind();
+    this.outbox.push({
+      data: Buffer.from(msg.buffer, msg.byteOffset + offset, length),
+      port,
+      address: address ?? (this.opts.type === "udp6" ? "::1" : "127.0.0.1"),
+    });
+    if (!this.flushQueued) {
+      this.flushQueued = true;
+      queueMicrotask(() => this.flush());
+    }
+  }
+
+  address(): AddressInfo {
+    if (!this.handle) throw new Error("Socket is not bound");
+    return this.handle.address();
+  }
+
+  getStats(): NativeUdpSocketStats | undefined {
+    return this.handle?.getStats();
+  }
+
+  close(): void {
+    if (this.closed) return;
+    this.closed = true;
+    this.outbox.length = 0;
+    if (this.handle) {
+      this.handle.close();
+    } else {
+      this.emit("close");
+    }
+  }
+
+  private flush(): void {
+    this.flushQueued = false;
+    if (!this.handle || this.outbox.length === 0) return;
+    const batch = this.outbox.splice(0);
+    try {
+      // Datagrams the kernel did not take are dropped, as dgram would on
+      // a full socket buffer; the ARQ above retransmits them.
+      this.handle.sendBatch(batch);
+    } catch (err) {
+      this.emit("error", err as Error);
+    }
+  }
+
+  private routeNativeEvent(event: string, payload: unknown): void {
+    switch (event) {
+      case "listening":
+        this.emit("listening");
+        return;
+      case "message":
+        this.deliver(payload as NativeDatagram);
+        return;
+      case "messages": {
+        const datagrams = payload as NativeDatagram[];
+        this.emit("messages", datagrams);
+        for (const datagram of datagrams) {
+          this.deliver(datagram);
+        }
+        return;
+      }
+      case "error":
+        this.emit("error", payload as Error);
+        return;
+      case "close":
+        this.emit("close");
+        return;
+      default:
+        return;
+    }
+  }
+
+  private deliver(datagram: NativeDatagram): void {
+    this.emit("message", datagram.data, {
+      address: datagram.address,
+      family: this.opts.type === "udp6" ? "IPv6" : "IPv4",
+      port: datagram.port,
+      size: datagram.data.byteLength,
+    } satisfies DatagramRemoteInfo);
+  }
+}
+
+/**
+ * A NativeDatagramSocket when `native` is set and the addon is present,
+ * otherwise a node:dgram socket.
+ */
+export const createDatagramSocket = (
+  opts: NativeDatagramSocketOptions & { native?: boolean } = {},
+): DatagramSocket => {
+  const { native, ...socketOpts } = opts;
+  if (native && isNativeUdpAvailable()) {
+    return new NativeDatagramSocket(socketOpts);
+  }
+  return dgram.createSocket(socketOpts.type ?? "udp4");
+};
@@ -0,0 +1,156 @@
+import { EventEmitter } from "node:events";
+import {
+  getNativeUnixDgram,
+  type NativeUnixDgramAddress,
+  type NativeUnixDgramHandle,
+  type NativeUnixDgramOptions,
+  type NativeUnixDgramStats,
+} from "../../core/NativeTCPClient";
+
+export type NativeUnixDatagramSocketOptions = Omit<NativeUnixDgramOptions, "path">;
+
+export interface UnixDatagramInfo {
+  /** The sender's bound path; "" for an unbound sender, a leading NUL for abstract names. */
+  path: string;
+  size: number;
+}
+
+type NativeUnixDatagram = { data: Buffer; path: string };
+type QueuedUnixDatagram = { data: Buffer; path?: string };
+
+/** True when qwormhole.node exposes the batched Unix datagram socket. */
+export const isNativeUnixDgramAvailable = (): boolean => Boolean(getNativeUnixDgram());
+
+/**
+ * An AF_UNIX SOCK_DGRAM socket on the libsocket addon, for local telemetry
+ * and control fan-in. A native thread drains the socket with recvmmsg into
+ * pooled blocks and hands each batch over in one call; sends made in the
+ * same tick leave as one sendmmsg. Unlike UDP a full receiver pushes back
+ * instead of dropping: datagrams it refuses are counted as `wouldBlock`,
+ * and its queue is capped at net.unix.max_dgram_qlen datagrams whatever
+ * its buffer size. Emits "message" per datagram and "messages" per batch.
+ */
+export class NativeUnixDatagramSocket extends EventEmitter {
+  private handle: NativeUnixDgramHandle | undefined;
+  private readonly outbox: QueuedUnixDatagram[] = [];
+  private flushQueued = false;
+  private closed = false;
+
+  constructor(private readonly opts: NativeUnixDatagramSocketOptions = {}) {
+    super();
+    if (!getNativeUnixDgram()) {
+      throw new Error(
+        "Native Unix datagrams require the libsocket backend (qwormhole.node). Run `pnpm run rebuild`.",
+      );
+    }
+  }
+
+  /**
+   * Binds to `path` (an abstract name when it starts with "\0") and starts
+   * receiving; "listening" follows. Without a path the socket only sends.
+   */
+  bind(path?: string): this {
+    if (this.handle || this.closed) return this;
+    const SocketCtor = getNativeUnixDgram()!;
+    this.handle = new SocketCtor({ ...this.opts, path });
+    this.handle.emit = (event: string, payload?: unknown) => {
+      this.routeNativeEvent(event, payload);
+      return true;
+    };
+    this.handle.bind().catch((err: Error) => this.emit("error", err));
+    return this;
+  }
+
+  /**
+   * Queues one datagram to `path`, or to the `connect` peer without one;
+   * everything queued this tick goes out together.
+   */
+  send(msg: Buffer | Uint8Array | string, path?: string): void {
+    if (this.closed) return;
+    if (!this.handle) this.bind();
+    const data =
+      typeof msg === "string"
+        ? Buffer.from(msg)
+        : Buffer.isBuffer(msg)
+          ? msg
+          : Buffer.from(msg.buffer, msg.byteOffset, msg.byteLength);
+    this.outbox.push({ data, path });
+    if (!this.flushQueued) {
+      this.flushQueued = true;
+      queueMicrotask(() => this.flush());
+    }
+  }
+
+  address(): NativeUnixDgramAddress {
+    if (!this.handle) throw new Error("Socket is not bound");
+    return this.handle.address();
+  }
+
+  getStats(): NativeUnixDgramStats | undefined {
+    return this.handle?.getStats();
+  }
+
+  /** Closes the socket and unlinks a bound filesystem path. */
+  close(): void {
+    if (this.closed) return;
+    this.closed = true;
+    this.outbox.length = 0;
+    if (this.handle) {
+      this.handle.close();
+    } else {
+      this.emit("close");
+    }
+  }
+
+  private flush(): void {
+    this.flushQueued = false;
+    if (!this.handle || this.outbox.length === 0) return;
+    const batch = this.outbox.splice(0);
+    try {
+      // Datagrams a full or missing receiver refused are dropped and
+      // counted; telemetry is lossy by design.
+      this.handle.sendBatch(batch);
+    } catch (err) {
+      this.emit("error", err as Error);
+    }
+  }
+
+  private routeNativeEvent(event: string, payload: unknown): void {
+    switch (event) {
+      case "listening":
+        this.emit("listening");
+        return;
+      case "message":
+        this.deliver(payload as NativeUnixDatagram);
+        return;
+      case "messages": {
+        const datagrams = payload as NativeUnixDatagram[];
+        this.emit("messages", datagrams);
+        for (const datagram of datagrams) {
+          this.deliver(datagram);
+        }
+        return;
+      }
+      case "error":
+        this.emit("error", payload as Error);
+        return;
+      case "close":
+        this.emit("close");
+        return;
+      default:
+        return;
+    }
+  }
+
+  private deliver(datagram: NativeUnixDatagram): void {
+    this.emit("message", datagram.data, {
+      path: datagram.path,
+      size: datagram.data.byteLength,
+    } satisfies UnixDatagramInfo);
+  }
+}
+
+/** A NativeUnixDatagramSocket; throws without the libsocket addon. */
+export const createUnixDatagramSocket = (
+  opts: NativeUnixDatagramSocketOptions = {},
+): NativeUnixDatagramSocket => new NativeUnixDatagramSocket(opts);
@@ -24,6 +24,8 @@ import {
   generateSessionKeyPair,
   encryptForPeer,
   decryptFromPeer,
+  deriveSealKey,
+  peerCryptoCache,
 } from "../session";
 
 import { PeerRegistry } from "../registry";
@@ -243,6 +245,21 @@ export class SovereignTunnel implements Tunnel {
     );
   }
 
+  /**
+   * Native seal key for an established session (Base64), for the lws
+   * transport's setSessionKey(). Both peers derive the same value.
+   */
+  sealKeyFor(peerOrigin: string): string | null {
+    const session = this.sessions.get(peerOrigin);
+    if (!session || !session.established) {
+      return null;
+    }
+    return deriveSealKey(
+      session.myX25519SecretKey,
+      session.peerX25519PublicKey,
+    );
+  }
+
   /**
    * Get active session with a peer
    */
@@ -254,6 +271,8 @@ export class SovereignTunnel implements Tunnel {
    * Close a session
    */
   closeSession(peerOrigin: string): boolean {
+    const peerKey = this.sessions.get(peerOrigin)?.peerX25519PublicKey;
+    if (peerKey) peerCryptoCache.forgetPeer(peerKey);
     return this.sessions.delete(peerOrigin);
   }
 
@@ -10,6 +10,7 @@ import type { TransportGovernanceSignals } from "../core/transport-governance-po
 import type { FlowControllerDiagnostics } from "../core/flow-controller";
 import type { BatchFramerStats } from "../core/batch-framer";
 import type { PriorityQueueStats } from "../core/qos";
+import type { NativeHandshakeSigner, NativeTlsContext } from "../core/NativeTCPClient";
 
 export type Payload = string | Buffer | Uint8Array | Record<string, unknown>;
 
@@ -24,6 +25,1435 @@ export type FramingMode =
 export type TransportMode = "ts" | "native-lws" | "native-libsocket";
 export type NativeBackend = "lws" | "libsocket";
 
+/**
+ * Live libwebsockets knobs accepted by `setTuning()` on the native lws client
+ * and server. Omitted fields keep their current value; defaults come from the
+ * QWORMHOLE_LWS_* environment variables.
+ */
+export interface NativeLwsTuning {
+  /** lws_write calls allowed per writable callback. */
+  maxWritesPerWritable?: number;
+  /**
+   * Upper bound on each lws_service wait. 0 (the default) blocks until socket
+   * activity or an explicit wakeup, so idle connections cost no CPU.
+   */
+  serviceTimeoutMs?: number;
+  /** Coalescing chunk size; also sizes the lws context on the next connect/listen. */
+  ptServBufSize?: number;
+}
+
+/**
+ * Bounds for the lws client's native flow control. The service thread moves
+ * the slice (lws writes per writable callback) between minSlice and maxSlice
+ * from TCP_INFO RTT and send-buffer occupancy, and meters bytes when a rate
+ * is set.
+ */
+export interface NativeFlowPolicy {
+  minSlice: number;
+  maxSlice: number;
+  /** Starting slice; defaults to half of maxSlice. */
+  preferredSlice?: number;
+  /** 0 or unset: unmetered. */
+  rateBytesPerSec?: number;
+  /** Token bucket depth; defaults to a tenth of a second at the rate. */
+  burstBytes?: number;
+  /**
+   * Linux: enforce rateBytesPerSec as the socket's SO_MAX_PACING_RATE, not
+   * a token bucket, so the kernel spaces packets out instead of the service
+   * thread releasing bursts. The loop cuts the rate by a quarter (at most
+   * once per RTT, down to a sixteenth) while the RTT sits well above its
+   * floor, and raises it back an eighth per sample once it does not.
+   */
+  kernelPacing?: boolean;
+}
+
+/** What the native flow control last measured and decided. */
+export interface NativeFlowDiagnostics {
+  sliceSize: number;
+  minSlice: number;
+  maxSlice: number;
+  preferredSlice: number;
+  rateBytesPerSec: number;
+  /** Smoothed RTT and its variance from TCP_INFO; 0 where unavailable. */
+  rttUs: number;
+  /** Lowest RTT seen over the last ten seconds. */
+  minRttUs: number;
+  rttVarUs: number;
+  /** SO_SNDBUF, and the bytes sitting in it (SIOCOUTQ). */
+  sendBufferBytes: number;
+  sendQueuedBytes: number;
+  /** Bytes handed to send() and not yet written. */
+  queueDepthBytes: number;
+  samples: number;
+  sliceIncreases: number;
+  sliceDecreases: number;
+  /** Passes that stopped short waiting for rate tokens. */
+  rateWaits: number;
+  /** The SO_MAX_PACING_RATE kernelPacing holds now; 0 without it. */
+  pacingRateBytesPerSec: number;
+  /** RTT-driven cuts of that rate. */
+  pacingCuts: number;
+}
+
+/** Service-loop wakeup counters; rates cover the time since the previous call. */
+export interface NativeServiceStats {
+  /** lws_service returns since start. */
+  servicePasses: number;
+  /** lws_cancel_service wakeups issued by send/broadcast/tuning calls. */
+  wakeRequests: number;
+  wakeupsPerSec: number;
+  wakeRequestsPerSec: number;
+  /**
+   * Wake requests that issued no lws_cancel_service because one was already
+   * in flight, or (deferWakeups) were folded into the pending setImmediate (lws).
+   */
+  wakesCoalesced?: number;
+  sampleMs: number;
+  /** Callback time per service pass, poll wait excluded (lws). */
+  serviceBusyUs?: NativeHistogramSnapshot;
+  /** Deliveries queued for the JS thread and not yet run (lws client/server). */
+  tsfnPending?: number;
+  tsfnPendingBytes?: number;
+  tsfnPendingPeak?: number;
+  /** Times RX was paused because tsfnPending reached maxPendingEvents. */
+  jsLagPauses?: number;
+}
+
+/** Snapshot of a native log-linear histogram (values within ~12.5%). */
+export interface NativeHistogramSnapshot {
+  count: number;
+  min: number;
+  max: number;
+  mean: number;
+  p50: number;
+  p90: number;
+  p99: number;
+  p999: number;
+}
+
+/** lws transport internals; latencies are in microseconds. */
+export interface NativeTransportStats {
+  /** Frame decoded on the service thread until its JS handler ran. */
+  rxToEmitUs: NativeHistogramSnapshot;
+  /** send()/sendTo() until the frame's last byte went to lws_write. */
+  enqueueToWireUs: NativeHistogramSnapshot;
+  /** Time spent in one writable callback. */
+  writableUs: NativeHistogramSnapshot;
+  bytesPerWritable: NativeHistogramSnapshot;
+  framesPerWritable: NativeHistogramSnapshot;
+  /** Queued bytes when a writable pass started. */
+  queueDepthBytes: NativeHistogramSnapshot;
+  /** Writable passes that ended on a short lws_write. */
+  partialWrites: number;
+  writablePasses: number;
+  /** Heap buffers built for outbound frames; a broadcast counts once. */
+  queuedWriteAllocs: number;
+  /** Vectors allocated for received frames/messages (slab frames are not). */
+  rxFrameAllocs: number;
+  /** Deliveries handed to a threadsafe function (one per batch when batched). */
+  tsfnPayloads: number;
+  lwsWrites: number;
+  /** RX callbacks, roughly one read() each. */
+  rxCallbacks: number;
+}
+
+export interface NativeClientTransportStats extends NativeTransportStats {
+  queuedBytes: number;
+  /** send() frames dropped unsent past their ttlMs. */
+  framesExpired?: number;
+  rxBufferedBytes: number;
+  /** Present when connected with `mux`. */
+  mux?: NativeMuxStats;
+  /** Present when connected with `seal`. */
+  seal?: NativeSealStats;
+  /** Present when connected with `sequence`. */
+  sequence?: NativeSequenceStats;
+  /** Present when connected with `resumable`. */
+  resumable?: NativeResumableStats;
+  /** Present when connected with `reconnect`. */
+  reconnect?: NativeReconnectStats;
+  /** Present when connected with `streaming`. */
+  streaming?: NativeStreamingStats;
+  /** Present when connected with `delta`. */
+  delta?: NativeDeltaClientStats;
+  /** Present when connected with `integrity`. */
+  integrity?: NativeIntegrityStats;
+  /** Present when connected with `impairment`. */
+  impairment?: NativeImpairmentStats;
+  /** Present when connected with `coalesce`. */
+  coalesce?: NativeCoalesceStats;
+  /** Present when connected with `rpc`. */
+  rpc?: NativeRpcStats;
+  /** Present when connected with `messageTypes`. */
+  messageTypes?: NativeMessageTypeStats;
+  /** lws: the dedicated service thread; absent for pooled clients. */
+  serviceThread?: NativeServiceThreadStats;
+}
+
+/**
+ * Native AEAD stage (lws backend only) for length-prefixed frames. Once
+ * `setSessionKey()` installs a 32-byte key on a connection, frames queued
+ * after that call are encrypted in their send buffers and flagged in the
+ * length prefix, and received flagged frames are opened in place.
+ */
+export interface NativeSealOptions {
+  /** Default "chacha20-poly1305". Both ends must use the same cipher. */
+  cipher?: "chacha20-poly1305" | "aes-256-gcm";
+  /**
+   * Move to the next key after this many frames sent (default: only when
+   * `rekey()` is called). Each end sets its own; the peer follows.
+   */
+  rekeyAfterFrames?: number;
+}
+
+/**
+ * Native replay guard (lws backend only) for length-prefixed frames. Each
+ * frame carries a 64-bit sequence number behind its payload; the receiver
+ * drops numbers it has already seen or that fall behind a sliding window.
+ */
+export interface NativeSequenceOptions {
+  /** Window in frames (default 2048, at most 65536). */
+  window?: number;
+}
+
+/**
+ * Native resumable sessions (lws backend only), on top of `sequence`. Each
+ * end keeps the frames it sent until the peer's cumulative ack passes them;
+ * connecting the same client again resumes the session and each side
+ * resends only what the other had not received. Both ends must enable it.
+ */
+export interface NativeResumableOptions {
+  /** Unacked bytes kept for a resend (default 4 MiB); the oldest go first. */
+  bufferBytes?: number;
+  /** Ack once this many frames are unacked (default 64). */
+  ackEvery?: number;
+  /** Or with the next frame this long after the last ack (default 50). */
+  ackIntervalMs?: number;
+  /** Server: how long a session waits for its client (default 30000). */
+  ttlMs?: number;
+}
+
+/**
+ * Native reconnect (lws backend only): a dropped connection, or a connect
+ * that runs out of addresses, is redialled on the service thread after a
+ * jittered exponential backoff, in the same lws context, without a
+ * "close". Each redial emits "reconnecting" and the next "connect" means
+ * it is up again. Writes already handed to the dropped socket are lost
+ * unless `resumable` replays them; what JS queued since goes out on the
+ * next connection. Ignored with mux or seal.
+ */
+export interface NativeReconnectOptions {
+  /** First backoff (default 100). */
+  initialDelayMs?: number;
+  /** Backoff cap (default 5000). */
+  maxDelayMs?: number;
+  /** Backoff growth per attempt (default 2). */
+  multiplier?: number;
+  /** +/- fraction of each backoff, 0-1 (default 0.2). */
+  jitter?: number;
+  /** Redials in a row before "close"; 0 = unlimited (default). */
+  maxAttempts?: number;
+  /** More endpoints after the client's own host/port, tried in turn. */
+  endpoints?: { host: string; port: number }[];
+  /**
+   * With endpoints: dial the next endpoint too when an attempt has not
+   * connected after this long, and keep the first to connect (0 = off).
+   */
+  hedgeDelayMs?: number;
+  /**
+   * With endpoints: keep a second, already handshaken connection to the
+   * next endpoint, so a drop fails over to it at once ("failover") rather
+   * than redialling. Raw or length-prefixed framing without `sequence`.
+   */
+  standby?: boolean;
+}
+
+export interface NativeReconnectStats {
+  /** Connections made after the first. */
+  reconnects: number;
+  /** Redials scheduled, failed ones included. */
+  attempts: number;
+  /** Drops taken over by the standby. */
+  failovers: number;
+  /** Hedged dials, and those that won the race. */
+  hedges: number;
+  hedgeWins: number;
+  standbyOpened: number;
+  /** Writes on a dropped connection that never made it out. */
+  writesLost: number;
+  /** Index of the current endpoint; 0 is the client's own host/port. */
+  endpoint: number;
+}
+
+/**
+ * Native write coalescing (lws backend only): small frames wait on the
+ * service thread for up to `maxDelayUs`, or until `maxBytes` are pending,
+ * and then leave in one write. Send with `{ flush: true }` to skip the
+ * wait for a latency-critical frame.
+ */
+export interface NativeCoalesceOptions {
+  /** Longest hold in microseconds (default 200, at most 100000). */
+  maxDelayUs?: number;
+  /** Pending bytes that end the hold early (default: the lws write chunk). */
+  maxBytes?: number;
+  /**
+   * Shorten the hold to about two observed inter-arrival gaps, and skip it
+   * while frames arrive further apart than `maxDelayUs` (default true).
+   */
+  adaptive?: boolean;
+}
+
+export interface NativeCoalesceStats {
+  /** Writable passes that started holding frames. */
+  held: number;
+  /** Holds ended by the deadline. */
+  deadlineFlushes: number;
+  /** Passes written at once because `maxBytes` were pending. */
+  byteFlushes: number;
+  /** Passes written at once for `{ flush: true }`. */
+  explicitFlushes: number;
+  /** Hold in use at the last pass; 0 while holding is skipped. */
+  holdUs: number;
+  /** Smoothed gap between frame enqueue times. */
+  arrivalGapUs: number;
+}
+
+/**
+ * Native message-type sampling (lws backend only): every received frame is
+ * classified on the service thread as inferMessageType() would classify its
+ * decoded payload (a string `type`, `event:<event>`, `action:<action>`,
+ * "object", "string", "buffer" and so on), into a rolling histogram that
+ * stats reads return. Frames are read as JSON unless `nativeCodec` is
+ * "cbor"; turn it into a NegentropicSnapshot with nativeNegentropicSnapshot().
+ */
+export interface NativeMessageTypeOptions {
+  /** Frames the type histogram covers (default 512, at most 65536). */
+  window?: number;
+  /** Bin the byte entropy of every nth frame (default 16; 0 never). */
+  entropyEvery?: number;
+}
+
+export interface NativeMessageTypeStats {
+  /** Frames classified since connect. */
+  frames: number;
+  /** Frames in the window, each counted once in `histogram`. */
+  sampleCount: number;
+  /** Count per type; past 32 distinct types the rest share "other". */
+  histogram: Record<string, number>;
+  /** Shannon entropy of `histogram`, in bits. */
+  entropy: number;
+  negentropy: number;
+  /** `entropy` less its value at the previous stats read. */
+  entropyVelocity: number;
+  /** Frames whose byte entropy was sampled. */
+  entropySamples: number;
+  /** Sampled frames by whole bits per byte: [0,1), [1,2) ... [7,8]. */
+  entropyHistogram: number[];
+  /** Bits per byte of the latest sampled frame. */
+  payloadEntropy?: number;
+}
+
+/**
+ * A call completed by the native rpc layer (lws backend): the peer's
+ * response, or status 0 when the request timed out natively.
+ */
+export interface NativeRpcResponse {
+  id: number;
+  status: number;
+  body: Buffer;
+}
+
+export interface NativeRpcEvent {
+  /** Every call completed since the previous "rpc" event. */
+  responses?: NativeRpcResponse[];
+}
+
+export interface NativeRpcStats {
+  requests: number;
+  responses: number;
+  /** Requests that hit their deadline before a response came. */
+  timeouts: number;
+  /** Responses to no outstanding request, e.g. after a timeout; dropped. */
+  unmatched: number;
+}
+
+/**
+ * What the native client's send() takes under `nativeCodec`: a Buffer goes
+ * out as is, anything else through the codec (JSON-shaped values, with
+ * Buffers as CBOR byte strings). Values the codec cannot encode throw.
+ */
+export type NativeEncodable = string | Buffer | number | boolean | null | object;
+
+/** Per-call options for the native client's send() and sendMany(). */
+export interface NativeSendOptions {
+  /** Write what is queued without waiting out the `coalesce` hold. */
+  flush?: boolean;
+  /**
+   * Drop the frames unsent if still queued this many ms from now (lws):
+   * heartbeats and telemetry that backpressure held past their use stop
+   * delaying fresher data. getStats() counts them as `framesExpired`.
+   */
+  ttlMs?: number;
+}
+
+/**
+ * Placement of one lws service thread. `rxLocal` / `rxRemote` count the
+ * connections it took whose SO_INCOMING_CPU matched the CPU it was running
+ * on, which is the locality `cpuAffinity` is meant to buy.
+ */
+export interface NativeServiceThreadStats {
+  /** The pinned CPU, "node" for a NUMA-node mask, or false. */
+  pinned: number | "node" | false;
+  /** CPU the thread last ran on, sampled at its latest connection. */
+  cpu: number;
+  repins: number;
+  rxLocal: number;
+  rxRemote: number;
+}
+
+/**
+ * lws service-thread placement (Linux). A list pins thread i to
+ * `cpus[i % length]`; "auto" moves each thread to the CPU most of its
+ * accepted connections take their RX interrupts on (SO_INCOMING_CPU).
+ */
+export type NativeCpuAffinity = number[] | "auto";
+
+export interface NativeSequenceStats {
+  /** Outbound frames numbered. */
+  framesSequenced: number;
+  /** Inbound frames that passed the window. */
+  framesAccepted: number;
+  /** Inbound frames dropped as already seen. */
+  duplicates: number;
+  /** Inbound frames dropped as older than the window. */
+  stale: number;
+}
+
+export interface NativeResumableStats {
+  /** Reconnects the peer resumed, and sessions that started over. */
+  resumed: number;
+  fresh: number;
+  /** Frames sent again after a reconnect. */
+  replayedFrames: number;
+  /** Inbound frames dropped as delivered before the reconnect. */
+  duplicates: number;
+  /** Frames the peer lacked that the buffer had already evicted. */
+  lostFrames: number;
+  acksSent: number;
+  /** Client only: sent and not yet acked. */
+  retainedBytes?: number;
+  /** Server only: sessions waiting for their client. */
+  detachedSessions?: number;
+}
+
+/**
+ * One chunk of a message sent with `streaming` (lws backend only). A
+ * stream's chunks arrive in order as separate events, so a message larger
+ * than `maxFrameLength` is never gathered in the addon; the first chunk
+ * starts it and the last ends it (one chunk may be both).
+ */
+export interface NativeStreamChunk {
+  /** Chosen by the sender; unique among its streams in flight. */
+  streamId: number;
+  first: boolean;
+  last: boolean;
+  /** The sender gave up on the message; no more chunks follow. */
+  aborted: boolean;
+  data: Buffer;
+}
+
+export interface NativeStreamSendOptions {
+  /** Largest chunk in bytes (default 256 KiB, below `maxFrameLength`). */
+  chunkBytes?: number;
+}
+
+export interface NativeStreamingStats {
+  chunksSent: number;
+  chunksReceived: number;
+}
+
+/**
+ * Keyed snapshot deltas (`delta`, lws backend only). The server's
+ * broadcastDelta() sends each connection a patch against the version of
+ * the key it was last sent, or the whole snapshot; the client rebuilds it
+ * natively and delivers only whole snapshots. Both ends must enable it.
+ */
+export interface NativeDeltaOptions {
+  /** Keys a server broadcasts under, or a client keeps (default 64). */
+  maxKeys?: number;
+  /**
+   * Server: every this many versions a key goes out whole to everyone, so
+   * a client that dropped a patch catches up (default 64; 0 never).
+   */
+  keyframeInterval?: number;
+}
+
+export interface NativeDeltaClientStats {
+  fullFrames: number;
+  patchFrames: number;
+  /** Patches against a version this client did not hold; dropped. */
+  mismatches: number;
+}
+
+export interface NativeDeltaServerStats {
+  keys: number;
+  /** Whole snapshots queued, counted per connection. */
+  fullFrames: number;
+  patchFrames: number;
+  /** Payload bytes the patches saved against whole snapshots. */
+  bytesSaved: number;
+}
+
+/**
+ * CRC32C frame trailers (`integrity`, lws backend only). Checks count the
+ * flagged frames received; a mismatch fails the connection.
+ */
+export interface NativeIntegrityStats {
+  /** "sse4.2", "armv8-crc" or "slicing-by-8". */
+  implementation: string;
+  framesChecksummed: number;
+  framesChecked: number;
+  mismatches: number;
+}
+
+/**
+ * Seeded egress impairment in the native addons, an in-process stand-in
+ * for `tc netem` when benchmarking on loopback. The lws server and client
+ * hold each connection's frames in a delay line after they are framed, so
+ * bytes are unchanged and arrive in order; the KCP engine drops datagrams.
+ * The same seed replays the same draws.
+ */
+export interface NativeImpairmentOptions {
+  /** Added to every frame (lws). */
+  delayMs?: number;
+  /** Spread of the delay drawn from `distribution` (lws). */
+  jitterMs?: number;
+  /**
+   * "uniform" (default): delayMs plus or minus jitterMs. "normal": jitterMs
+   * is the standard deviation. "pareto": a heavy tail above delayMs with
+   * jitterMs as its scale.
+   */
+  distribution?: "uniform" | "normal" | "pareto";
+  /** The link serializes frames at this rate; 0 is unlimited (lws). */
+  bandwidthBytesPerSec?: number;
+  /** Every stallEveryMs nothing is written for stallMs (lws). */
+  stallEveryMs?: number;
+  stallMs?: number;
+  /** Fraction in [0, 1] of datagrams dropped before they are sent (KCP). */
+  loss?: number;
+  /** Generator seed; default 1. Connections each draw their own sequence from it. */
+  seed?: number;
+}
+
+/**
+ * CUSUM settings for the lws server's `anomalyDetection`. Each metric is
+ * standardized against its own EWMA mean and deviation.
+ */
+export interface NativeAnomalyOptions {
+  /** Decision interval h in standard deviations (default 8). */
+  threshold?: number;
+  /** Per-sample slack k in standard deviations (default 1). */
+  slack?: number;
+  /** Samples a metric learns from before it is tested (default 32). */
+  warmup?: number;
+}
+
+export type NativeAnomalyMetric = "jitter" | "rtt" | "retransmits";
+
+/**
+ * The lws server's `metrics` endpoint: OpenMetrics text over plain HTTP on
+ * its own port, rendered by a service thread so scrapes never wait for the
+ * event loop.
+ */
+export interface NativeMetricsOptions {
+  /** 0 picks a free port; getMetricsPort() reports it. */
+  port: number;
+  /** Default "127.0.0.1"; "0.0.0.0" or "::" listens everywhere. */
+  host?: string;
+  /** Default "/metrics"; any other path is a 404. */
+  path?: string;
+  /**
+   * Also accept WebSocket subscribers (subprotocol "qwormhole-stats") and
+   * push them compact deltas of global and per-connection counters every
+   * `intervalMs` (50 when `true`, clamped to 20-100); read them with
+   * openNativeStatsStream().
+   */
+  stream?: boolean | { intervalMs?: number };
+}
+
+/**
+ * `gateway` on the native lws server: HTTP/2 on a port of its own, every
+ * POST under `path` one RPC request. lws does HPACK, per-stream flow
+ * control and multiplexing on the service threads; the requests whose
+ * bodies completed in one service pass reach JS as one "gatewayRequests"
+ * event, and respondGateway() answers each. TLS servers negotiate h2 (or
+ * HTTP/1.1) by ALPN with their certificate; plaintext ones take h2 with
+ * prior knowledge only.
+ */
+/**
+ * Another (host, port, TLS) a native lws server listens on, as a vhost of
+ * the same context: its connections share the server's service threads,
+ * pools, framing, handlers and stats.
+ */
+export interface NativeListenEndpointOptions {
+  /** Tags its connections' `endpoint`; default "endpoint-<n>". "default" is the server's own. */
+  name?: string;
+  /** Default the server's host. */
+  host?: string;
+  /** 0 picks a free port; getEndpoints() reports it. */
+  port: number;
+  ipv6Only?: boolean;
+  /** TLS with its own certificate, and client certificates with `requestCert`; plaintext when unset. */
+  tls?: Pick<QWTlsOptions, "enabled" | "cert" | "key" | "ca" | "passphrase" | "requestCert">;
+}
+
+export interface NativeListenEndpointInfo {
+  name: string;
+  address: string;
+  family: string;
+  port: number;
+  tls: boolean;
+  /** Open now. */
+  connections: number;
+  /** Since listen(). */
+  accepted: number;
+}
+
+export interface NativeGatewayOptions {
+  /** 0 picks a free port; getGatewayPort() reports it. */
+  port: number;
+  /** Default "127.0.0.1"; "0.0.0.0" or "::" listens everywhere. */
+  host?: string;
+  /** Default "/rpc": it and the paths below it are served, the rest 404. */
+  path?: string;
+  /** SETTINGS_MAX_CONCURRENT_STREAMS per connection; default 100. */
+  maxStreams?: number;
+  /** Bodies over this are answered 413 natively; default 1 MiB. */
+  maxBodyBytes?: number;
+  /** Streams left unanswered this long are reset; default 30000, 0 never. */
+  timeoutMs?: number;
+}
+
+/** One gateway request; answer it with respondGateway(id, ...). */
+export interface NativeGatewayRequest {
+  id: number;
+  /** The request path, without its query. */
+  path: string;
+  contentType?: string;
+  body: Buffer;
+}
+
+export interface NativeGatewayStats {
+  requests: number;
+  /** "gatewayRequests" events; requests / batches is the mean batch. */
+  batches: number;
+  responses: number;
+  /** Answered natively: 404, 405 or 413. */
+  rejected: number;
+  /** Answers whose stream had closed, timed out or was already answered. */
+  orphaned: number;
+}
+
+/**
+ * One JS series for registerMetrics(). Entries sharing a name are one
+ * family and must share its type; counters are exposed with `_total`.
+ */
+export interface NativeMetricDefinition {
+  name: string;
+  type: "counter" | "gauge";
+  help?: string;
+  labels?: Record<string, string>;
+}
+
+/**
+ * A regime change on one connection. `raised` is the move away from
+ * `baseline`, and a later event with `raised: false` is the move back.
+ * Values are EWMA means: jitter and rtt in microseconds, and retransmits
+ * per TCP_INFO sample.
+ */
+export interface NativeAnomalyEvent {
+  metric: NativeAnomalyMetric;
+  raised: boolean;
+  value: number;
+  baseline: number;
+}
+
+/** Present with `impairment`; counts cover every connection of the wrapper. */
+export interface NativeImpairmentStats {
+  framesDelayed: number;
+  /** Time from entering the delay line to being handed to the write. */
+  meanDelayUs: number;
+  maxDelayUs: number;
+  /** Writable passes that found a due frame inside a stall window. */
+  stalledPasses: number;
+}
+
+export interface NativeSealStats {
+  framesSealed: number;
+  framesOpened: number;
+  /** Frames that failed to seal, failed authentication, or came in unsealed late. */
+  failures: number;
+  /** Times this end moved its sending key on. */
+  rekeys: number;
+  /** Times the peer's key phase moved on. */
+  peerRekeys: number;
+}
+
+/**
+ * Native mux (lws backend only): the `src/transports/mux` frame format is
+ * decoded on the service thread and delivered as per-stream batches.
+ */
+export interface NativeMuxOptions {
+  /**
+   * Per-stream flow-control window in bytes, granted in both directions.
+   * Both peers must use the same value. 0 (default) disables it; keep it
+   * off against a TS MuxSession, which never sends window frames.
+   */
+  window?: number;
+  /** Open streams per connection; further opens are reset (default 1024). */
+  maxStreams?: number;
+  /**
+   * When received bytes count as consumed and their credit goes back to the
+   * peer. "release" (default) waits for the delivered Buffers to be garbage
+   * collected, so data JS still holds keeps the sender paused; "delivery"
+   * grants as soon as the event is emitted.
+   */
+  grant?: "release" | "delivery";
+}
+
+/**
+ * Native WebSocket mode (lws backend only): connections speak RFC 6455
+ * through libwebsockets' ws role instead of a raw socket, and each
+ * WebSocket message is delivered as one frame. Both ends must enable it.
+ */
+export interface NativeWebSocketOptions {
+  /** Sec-WebSocket-Protocol offered and served (default "qwormhole"). */
+  protocol?: string;
+  /** Client request path (default "/"). */
+  path?: string;
+  /**
+   * Negotiate permessage-deflate. Needs libwebsockets built with
+   * extensions; otherwise messages go out uncompressed. Pooled clients
+   * connect without it.
+   */
+  deflate?: boolean;
+  /** Messages larger than this are sent as continuation frames (default 65536). */
+  fragmentBytes?: number;
+}
+
+/**
+ * Frame compression for the length-prefixed protocol, negotiated through the
+ * handshake's `caps.compression` ("deflate"). Frames of at least `threshold`
+ * payload bytes are raw-deflated and flagged in the top bit of the length
+ * prefix; each frame is compressed on its own, primed with `dictionary`.
+ */
+export interface FrameCompressionOptions {
+  /** Native server: payloads shorter than this go out as they are (default 1024). */
+  threshold?: number;
+  /** Native server: zlib level 1-9 (default 1). */
+  level?: number;
+  /** Preset dictionary, e.g. common JSON keys; both peers must use the same bytes. */
+  dictionary?: Buffer;
+}
+
+/** One read's worth of demultiplexed mux frames. */
+export interface NativeMuxEvent {
+  opened?: number[];
+  /** All stream bytes the read carried, one Buffer per stream. */
+  streams?: Array<{ streamId: number; data: Buffer }>;
+  closed?: Array<{ streamId: number; reset: boolean }>;
+  /** Streams whose held writes went out on new credit; writable again. */
+  resumed?: number[];
+}
+
+export interface NativeMuxStats {
+  streams: number;
+  framesIn: number;
+  framesOut: number;
+  /** Streams reset for sending past their window. */
+  windowViolations: number;
+  /** Written bytes waiting natively for the peer's window. */
+  heldBytes: number;
+  /** Streams with held bytes, i.e. out of the peer's credit. */
+  stalledStreams: number;
+  /** Delivered bytes whose Buffers JS has not released yet (grant "release"). */
+  unreleasedBytes: number;
+}
+
+export interface NativeServerTransportStats extends NativeTransportStats {
+  connections: number;
+  /** lws: topics with at least one subscriber, and subscriptions in all. */
+  topics?: number;
+  subscriptions?: number;
+  /** lws: bytes queued for send across all connections. */
+  queuedBytes?: number;
+  /**
+   * lws: estimated native memory held by connections, refreshed once a
+   * second. `idleCompactions` counts idle connections that released their
+   * send lanes, staging buffer or RX slab.
+   */
+  connectionMemory?: {
+    bytes: number;
+    bytesPerConnection: number;
+    idleCompactions: number;
+  };
+  /** lws with receiveRing: frames through the rings, and full-ring fallbacks. */
+  receiveRing?: {
+    records: number;
+    overflows: number;
+    notifications: number;
+  };
+  /** lws: smoothed delay between a cross-thread wake and a service pass. */
+  serviceLagUs?: number;
+  /** lws: one entry per service thread, in tsi order. */
+  serviceThreads?: NativeServiceThreadStats[];
+  /**
+   * Present after attachBroadcastRing(). `laps` counts times this server
+   * fell a whole ring behind and skipped `bytesLost` to catch up.
+   */
+  broadcastRing?: { frames: number; laps: number; bytesLost: number };
+  /**
+   * lws, with attachConnectionDirectory(): sendTo() frames `forwarded` to
+   * other shards (`misses`: no owner known, `rejected`: inbox busy), and
+   * inbox frames `delivered` here or `undeliverable` (connection gone).
+   * `bytesLost` is inbox traffic this shard fell too far behind to read.
+   */
+  connectionDirectory?: {
+    shard: number;
+    forwarded: number;
+    misses: number;
+    rejected: number;
+    delivered: number;
+    undeliverable: number;
+    bytesLost: number;
+  };
+  /** lws: sockets taken over through adoptSocket(), and ones lws refused. */
+  adoptedSockets?: number;
+  adoptFailures?: number;
+  /** lws: connections handed off by detachConnection(), and ones resumed here. */
+  connectionsDetached?: number;
+  connectionsMigratedIn?: number;
+  /**
+   * lws, with enableWorkerDelivery(): frame batches and frames posted to
+   * worker sinks, and frames that went to the main thread instead.
+   */
+  workerDelivery?: {
+    workers: number;
+    attached: number;
+    batches: number;
+    delivered: number;
+    fallbacks: number;
+  };
+  /** lws, with maxConnectionsPerIp / acceptRatePerIp: sources tracked and connections refused. */
+  peerLimits?: {
+    tracked: number;
+    connectionCapRejects: number;
+    acceptRateRejects: number;
+  };
+  /**
+   * lws, with lowLatencyWriteBytes: writable passes it shortened, and passes
+   * it skipped because the kernel already held that much unsent.
+   */
+  lowLatencyWrites?: {
+    unsentCapBytes: number;
+    cappedPasses: number;
+    deferredPasses: number;
+  };
+  /** lws: connections closed by idleTimeoutMs, and heartbeats sent. */
+  idleTimeouts?: number;
+  heartbeatsSent?: number;
+  /** Handshakes admitted and acked natively (with `nativeHandshake`). */
+  handshakeAcks?: number;
+  /** Handshakes refused by the native policy table. */
+  handshakeRejects?: number;
+  /** TLS handshakes that resumed a session vs. ran in full (TLS servers only). */
+  tlsSessionsResumed?: number;
+  tlsSessionsFull?: number;
+  /** Connections whose send path runs on kernel TLS (with `tls.ktls`). */
+  tlsKtlsConnections?: number;
+  /**
+   * lws TLS servers: handshakes started and not finished (and the most at
+   * once), finished or abandoned, start-to-done time, and the service-thread
+   * time each spent inside the TLS library, certificate signature included.
+   */
+  tlsSetup?: {
+    pending: number;
+    maxPending: number;
+    completed: number;
+    failed: number;
+    handshakeMs: NativeHistogramSnapshot;
+    serviceUs: NativeHistogramSnapshot;
+  };
+  /** Handshakes admitted on a resumption proof (with `nativeHandshake.resumption`). */
+  handshakeResumes?: number;
+  /** Present with `handshakeVerifyThreads`. */
+  handshakeVerify?: NativeHandshakeVerifyStats;
+  /** Verified-key cache; absent with `handshakeCacheSize: 0`. */
+  handshakeCache?: { size: number; hits: number; misses: number };
+  /** Present with `compression`; bytes are payload bytes before/after deflate. */
+  compression?: {
+    framesDeflated: number;
+    bytesIn: number;
+    bytesOut: number;
+    framesInflated: number;
+  };
+  /** Present with `seal`. */
+  seal?: NativeSealStats;
+  /** Present with `sequence`. */
+  sequence?: NativeSequenceStats;
+  /** Present with `resumable`. */
+  resumable?: NativeResumableStats;
+  /** Present with `streaming`. */
+  streaming?: NativeStreamingStats;
+  /** Present with `delta`. */
+  delta?: NativeDeltaServerStats;
+  /** Present with `integrity`; received counts cover every connection. */
+  integrity?: NativeIntegrityStats;
+  /** Present with `impairment`. */
+  impairment?: NativeImpairmentStats;
+  /** Present with `anomalyDetection`: anomaly events raised and cleared. */
+  anomalies?: { raised: number; cleared: number };
+}
+
+/** Native handshake verify pool: queueing and per-handshake verify cost. */
+export interface NativeHandshakeVerifyStats {
+  queueDepth: number;
+  /** Handshakes refused because the queue was at `handshakeVerifyQueueMax`. */
+  overflows: number;
+  /** Queue depth sampled at each submission. */
+  queueDepthSamples: NativeHistogramSnapshot;
+  /** Handshakes a worker took per wakeup. */
+  batchSize: NativeHistogramSnapshot;
+  waitUs: NativeHistogramSnapshot;
+  verifyUs: NativeHistogramSnapshot;
+}
+
+/**
+ * getConnectionsSnapshot(): every connection at one instant as parallel
+ * typed arrays over one buffer; entry i of each belongs to the same
+ * connection. `rttUs` is 0 until TCP_INFO sampling (tcpInfoIntervalMs)
+ * has read it; bits of `flags` are NativeConnectionFlag. `addresses`
+ * holds 16 bytes per connection, IPv4 mapped into IPv6.
+ */
+export interface NativeConnectionsSnapshot {
+  count: number;
+  handles: Float64Array;
+  queuedBytes: Float64Array;
+  bytesReceived: Float64Array;
+  bytesSent: Float64Array;
+  rttUs: Uint32Array;
+  remotePorts: Uint16Array;
+  flags: Uint8Array;
+  addresses: Uint8Array;
+}
+
+/**
+ * One connection's service-thread cost with `costAccounting: true`: time
+ * spent in its RX and writable callbacks (TLS decryption that lws does
+ * before the callback is not included), against the traffic it moved.
+ */
+export interface NativeConnectionCost {
+  id: string;
+  handle: number;
+  /** rxCpuUs + txCpuUs. */
+  cpuUs: number;
+  rxCpuUs: number;
+  txCpuUs: number;
+  rxCalls: number;
+  txCalls: number;
+  bytesReceived: number;
+  bytesSent: number;
+  framesReceived: number;
+  framesSent: number;
+  /** cpuUs per byte moved either way, in ns; 0 before any traffic. */
+  cpuNsPerByte: number;
+  ageMs: number;
+}
+
+/**
+ * One TCP_INFO reading for a native server connection (Linux). Rates are
+ * bytes per second; fields the kernel does not report read 0.
+ */
+export interface NativeTcpPathStats {
+  /** Wall-clock ms of the sample. */
+  sampledAt: number;
+  rttUs: number;
+  rttVarUs: number;
+  minRttUs: number;
+  /** Congestion window, in segments of `mss` bytes. */
+  cwnd: number;
+  mss: number;
+  /** Segments sent and not yet acknowledged, and those deemed lost. */
+  unacked: number;
+  lost: number;
+  /** Retransmitted segments over the connection's lifetime. */
+  retransmits: number;
+  pacingRate: number;
+  deliveryRate: number;
+}
+
+/**
+ * Socket options for native connections, applied as the socket is opened
+ * (client) or adopted (lws server). Unset fields keep the kernel default.
+ * busyPollUs, quickAck, notSentLowatBytes and priority are Linux-only.
+ */
+export interface NativeSocketTuning {
+  noDelay?: boolean;
+  sendBufferBytes?: number;
+  receiveBufferBytes?: number;
+  /** SO_BUSY_POLL; usually needs CAP_NET_ADMIN past net.core.busy_read. */
+  busyPollUs?: number;
+  /** TCP_QUICKACK, re-armed after every read. */
+  quickAck?: boolean;
+  /** TCP_NOTSENT_LOWAT: unsent bytes at which the socket stops being writable. */
+  notSentLowatBytes?: number;
+  /** SO_PRIORITY, 0-6. */
+  priority?: number;
+  /** DSCP code point (0-63), written to IP_TOS / IPV6_TCLASS. */
+  dscp?: number;
+  /**
+   * Clients, Linux: TCP_FASTOPEN_CONNECT, so the first write (a TLS
+   * ClientHello, say) rides the SYN once the server's cookie is cached. The
+   * connect then completes at once, so libsocket races no addresses.
+   */
+  fastOpen?: boolean;
+  /**
+   * Linux: SO_MAX_PACING_RATE in bytes per second, so TCP spreads this
+   * connection's packets over time rather than bursting a window at line
+   * rate. The fq qdisc enforces it per flow; elsewhere TCP paces itself
+   * (Linux 4.13+). The report reads back the cap (0: unlimited).
+   */
+  pacingRateBytesPerSec?: number;
+}
+
+/**
+ * "latency": no Nagle, quick ACKs, a 16 KiB not-sent low-water mark and
+ * 50 us of busy polling. "bulk": Nagle on and 4 MiB socket buffers.
+ */
+export type NativeSocketTuningPreset = "latency" | "bulk";
+
+/** What the kernel reports after `socketOptions` (Linux doubles buffer sizes). */
+export interface NativeSocketTuningReport extends Required<NativeSocketTuning> {
+  /**
+   * Root qdisc of the egress interface, read when a pacing rate is set:
+   * "fq", "fq_codel", "noqueue", or "mq:fq" for a multiqueue root with fq
+   * children. Empty when unknown or no rate was set.
+   */
+  pacingQdisc: string;
+  /** Options setsockopt() refused or the platform lacks. */
+  rejected: string[];
+}
+
+/** getConnectTimings(): phases of the latest native connect, in ms. */
+export interface NativeConnectTimings {
+  dnsMs: number;
+  /** Answered from the shared resolver cache or a lookup already in flight. */
+  dnsCached: boolean;
+  /** Addresses tried so far (RFC 8305 racing on libsocket, fallback on lws). */
+  attempts: number;
+  /** The address that connected. */
+  address?: string;
+  /** Socket connect to connected: TCP, plus TLS and any WebSocket upgrade. */
+  connectMs?: number;
+  /** TCP handshake alone, where the backend can tell it apart. */
+  tcpMs?: number;
+  /** TLS handshake alone (lws built with conmon). */
+  tlsMs?: number;
+  /** connect() call to connected. */
+  totalMs?: number;
+  /** The TLS session was resumed from the session cache (lws, TLS only). */
+  tlsResumed?: boolean;
+  /** The SYN carried data the server accepted: TCP fast open (lws, Linux). */
+  fastOpen?: boolean;
+}
+
+/** sendTo() and publish() options on the native servers. */
+export interface NativeServerSendOptions {
+  /** Send lane, 0-3; lower drains first. */
+  priority?: number;
+  /**
+   * Drop the frame unsent if still queued this many ms from now (lws), as
+   * on the client; counted as `framesExpired` per connection and in
+   * getWriteStats().
+   */
+  ttlMs?: number;
+  /**
+   * Conflation key (lws backend): a frame still queued for the connection
+   * under the same key is replaced in place by this one, so a slow reader
+   * gets the latest state instead of every superseded update.
+   */
+  conflate?: string | number;
+}
+
+/** sendFile() options (lws backend). */
+export interface NativeSendFileOptions {
+  /** Server only: send lane, as for sendTo(). */
+  priority?: number;
+  /**
+   * Split the range into frames of at most this many body bytes, so other
+   * frames can go out between them and receivers stay under maxFrameLength.
+   * Default: the whole range as one frame.
+   */
+  frameBytes?: number;
+}
+
+/** Per-connection counters; histograms only with `connectionStats: true`. */
+export interface NativeConnectionStats extends Partial<NativeTransportStats> {
+  id: string;
+  handle: number;
+  queuedBytes: number;
+  backpressured: boolean;
+  /** pause() or the rxBudgetBytes budget has reading stopped (lws). */
+  rxPaused?: boolean;
+  /** Received bytes JS still holds, with `rxBudgetBytes`. */
+  rxHeldBytes?: number;
+  bytesReceived: number;
+  bytesSent: number;
+  framesSent: number;
+  /** Frames dropped unsent past their ttlMs (lws). */
+  framesExpired?: number;
+  /** Frames delivered as messages (lws). */
+  framesReceived?: number;
+  /** Callback time and counts, with `costAccounting: true` (lws). */
+  cost?: { rxCpuUs: number; txCpuUs: number; rxCalls: number; txCalls: number };
+  /** Present when the server runs with `mux`. */
+  mux?: NativeMuxStats;
+  /** The latest sample, with `tcpInfoIntervalMs` set. */
+  tcpPath?: NativeTcpPathStats;
+  /** Effective values, with `socketOptions` set (lws). */
+  socketOptions?: NativeSocketTuningReport;
+  /** Present when the server runs with `messageTypes` (lws). */
+  messageTypes?: NativeMessageTypeStats;
+  /** Present when the server runs with `integrity` (lws). */
+  integrity?: {
+    /** Whether frames to this connection carry trailers. */
+    trailers: boolean;
+    framesChecked: number;
+    mismatches: number;
+  };
+}
+
+/** Options for a shared-context native client pool (lws backend only). */
+export interface NativeClientPoolOptions {
+  /** Service threads (one lws context each); clients are spread round-robin. */
+  threads?: number;
+  /**
+   * Client TLS material for every pooled connection. lws keeps certificates
+   * per context, so pooled clients cannot carry their own ca/cert/key.
+   */
+  tls?: Pick<
+    QWTlsOptions,
+    "ca" | "cert" | "key" | "passphrase" | "ktls" | "context"
+  >;
+}
+
+/** Client credentials parsed once by `createTlsContext()`. */
+export type NativeTlsContextOptions = Pick<
+  QWTlsOptions,
+  "ca" | "cert" | "key" | "passphrase" | "ktls"
+>;
+
+/** Native service stats for a client pool thread, plus attached clients. */
+export interface NativeClientPoolStats extends NativeServiceStats {
+  clients: number;
+}
+
+/** Options for a Secure Streams client context (lws backend only). */
+export interface NativeSecureStreamsOptions {
+  /**
+   * The lws Secure Streams policy: `retry` backoff tables, `certs` and
+   * `trust_stores`, and the `s` streamtypes (endpoint, port, protocol, tls,
+   * retry, metadata). A string is passed through as JSON.
+   */
+  policy: string | Record<string, unknown>;
+}
+
+/** A stream's lws connection state, per LWSSSCS_*. */
+export type NativeSecureStreamState =
+  | "creating"
+  | "disconnected"
+  | "unreachable"
+  | "authFailed"
+  | "connected"
+  | "connecting"
+  | "destroying"
+  | "poll"
+  | "allRetriesFailed"
+  | "ackRemote"
+  | "nackRemote"
+  | "ackLocal"
+  | "nackLocal"
+  | "timeout"
+  | "serverTxn"
+  | "serverUpgrade"
+  | "upstreamLinkRetry"
+  | "unknown";
+
+export type NativeSecureStreamEvent =
+  | { id: number; type: "data"; data: Buffer; som: boolean; eom: boolean }
+  | { id: number; type: "state"; state: NativeSecureStreamState; ack: number }
+  | { id: number; type: "error"; error: string };
+
+/** Counters across every stream of a Secure Streams context. */
+export interface NativeSecureStreamsStats {
+  /** Streams currently open. */
+  streams: number;
+  created: number;
+  /** create() calls lws refused, e.g. for a streamtype not in the policy. */
+  createFailed: number;
+  /** Connection attempts, retries included. */
+  connecting: number;
+  connected: number;
+  disconnected: number;
+  unreachable: number;
+  /** Streams whose policy retry table ran out. */
+  retriesExhausted: number;
+  rxBytes: number;
+  txBytes: number;
+  /** Written but not yet handed to lws. */
+  txQueuedBytes: number;
+}
+
+/** Options for the native lws server's graceful shutdown. */
+export interface NativeShutdownOptions {
+  /** Sent to every connection after its queued data, before it is closed. */
+  closeHint?: Payload;
+}
+
+/** Outcome of a native graceful shutdown, delivered with "close". */
+export interface NativeShutdownReport {
+  graceful: true;
+  /** Bytes written after shutdown began (queued data plus close hints). */
+  drainedBytes: number;
+  /** Bytes still queued on connections when gracefulMs expired. */
+  undeliveredBytes: number;
+  timedOut: boolean;
+}
+
+/** Transport policy advertised for an admitted handshake. */
+export type NativeHandshakePolicy = NonNullable<
+  NonNullable<QWormholeServerConnection["handshake"]>["policy"]
+>;
+
+/**
+ * One row of the native admission table. The first row (by descending
+ * `minNIndex`) the peer's nIndex reaches decides; `admit: false` refuses.
+ */
+export interface NativeHandshakePolicyRow extends NativeHandshakePolicy {
+  minNIndex: number;
+  admit?: boolean;
+}
+
+/** Native lws server: answer handshakes in the addon with a signed ack. */
+export interface NativeHandshakeOptions {
+  /** Ed25519 private key: PKCS#8 DER (Buffer or base64) or a 32-byte seed. */
+  signingKey: string | Buffer;
+  /** Admission table; defaults to `buildEntropyPolicyTable()`. */
+  policy?: NativeHandshakePolicyRow[];
+  /**
+   * Issue a resumption token in each ack. A reconnecting client answers with
+   * `createResumedHandshake()`, an HMAC over the new session's TLS exporter
+   * material, instead of a signature. Needs `tls.exportKeyingMaterial`.
+   */
+  resumption?: NativeHandshakeResumptionOptions;
+}
+
+/** Key and fields for `createHandshakeSigner()`. */
+export interface NativeHandshakeSignerOptions {
+  /** Ed25519 private key: PKCS#8 DER (Buffer or base64) or a 32-byte seed. */
+  signingKey: string | Buffer;
+  version?: string;
+  tags?: Record<string, string | number>;
+}
+
+/** What a handshake signer derived once from its key. */
+export interface NativeHandshakeSignerInfo {
+  /** Base64 SPKI DER. */
+  publicKey: string;
+  negHash: string;
+  nIndex: number;
+  /** Every handshake from this key carries it; pass it to `verifyHandshakeAck()`. */
+  nonce: string;
+}
+
+export interface NativeHandshakeResumptionOptions {
+  /** Token MAC key; share it across servers that should honour each other's tokens. Random per server by default. */
+  secret?: string | Buffer;
+  /** Token lifetime (default 600000). */
+  ttlMs?: number;
+}
+
+/** Write coalescing counters reported by the native servers. */
+export interface NativeServerWriteStats {
+  /** Write syscalls issued: lws_write calls, or sendmsg calls on libsocket. */
+  writeCalls: number;
+  framesWritten: number;
+  bytesWritten: number;
+  /** framesWritten / writeCalls; above 1 when small frames are coalesced. */
+  framesPerWrite: number;
+  /** Writable passes deferred to a refill timer by the rate limits. */
+  rateLimitedWaits?: number;
+  /** Queued frames replaced by a newer one with the same conflate key (lws). */
+  framesConflated?: number;
+  /** Frames dropped unsent past their ttlMs (lws). */
+  framesExpired?: number;
+  /** zeroCopyMinBytes (libsocket): sendmsg calls made with MSG_ZEROCOPY. */
+  zeroCopySends?: number;
+  /** Send ids the kernel reported complete, and how many of those it copied anyway. */
+  zeroCopyCompletions?: number;
+  zeroCopyCopied?: number;
+  /** Sockets that refused SO_ZEROCOPY plus sends retried as copies on ENOBUFS. */
+  zeroCopyFallbacks?: number;
+}
+
+/** getAcceptStats(): what the native server's listener has taken. */
+export interface NativeServerAcceptStats {
+  accepted: number;
+  /**
+   * Drains of the listen queue that accepted something: one edge-triggered
+   * wakeup on libsocket, one service pass on lws.
+   */
+  batches: number;
+  maxBatch: number;
+  /** accept() failures such as EMFILE (libsocket; lws does not report them). */
+  errors: number;
+  /** Over the last window of at least a second. */
+  acceptsPerSec: number;
+}
+
+/**
+ * `timestamping` (libsocket): when a message got here, in microseconds
+ * since the epoch. `kernelUs` is the kernel's receive stamp on the segment
+ * that completed it, `hardwareUs` the NIC's (on the NIC's own clock, only
+ * comparable once it is synced to this one), `nativeUs` when the addon's
+ * read returned and `emittedUs` when its batch was handed to JS.
+ */
+export interface NativeRxTimestamps {
+  kernelUs?: number;
+  hardwareUs?: number;
+  nativeUs: number;
+  emittedUs: number;
+}
+
+/**
+ * getTimestampStats(): stamped reads and the sampled stamped sends, one in
+ * flight per connection. Delays are means in microseconds: kernel receive
+ * stamp to the read, and a send's sendmsg to its queueing-discipline entry
+ * (`txSchedUs`), driver hand-off (`txSoftwareUs`) and the peer's ACK.
+ */
+export interface NativeTimestampStats {
+  mode: "software" | "hardware";
+  rxStamped: number;
+  rxHardware: number;
+  kernelToNativeUs: number;
+  txStamped: number;
+  txHardware: number;
+  /** Stamped sends given up on after a second without their ACK report. */
+  txExpired: number;
+  txSchedUs: number;
+  txSoftwareUs: number;
+  txAckUs: number;
+}
+
+/**
+ * syncClock(): the peer's clock minus this one's and the round trip, taken
+ * from the probe with the shortest round trip of the last eight.
+ */
+export interface NativeClockOffset {
+  offsetUs: number;
+  rttUs: number;
+  samples: number;
+}
+
+/** Per-session ARQ state reported by the native KCP engine. */
+export interface NativeKcpSessionStats {
+  srttMs: number;
+  rtoMs: number;
+  cwnd: number;
+  /** Segments sent and not yet acknowledged. */
+  inFlight: number;
+  /** Segments waiting for window space. */
+  queued: number;
+  sndUna: number;
+  sndNxt: number;
+  rcvNxt: number;
+  retransmits: number;
+  fastResends: number;
+  bytesWritten: number;
+  bytesRead: number;
+  /** Present when the engine runs with `fec`. */
+  fec?: NativeKcpFecSessionStats;
+}
+
+/**
+ * Forward error correction for the native KCP engine: Reed-Solomon parity
+ * over GF(256) for every `dataShards` first transmissions, so a peer
+ * rebuilds up to `parityShards` lost segments of a group without waiting
+ * for a retransmit. Both ends must be native engines with `fec`; a
+ * KcpSession peer drops the parity datagrams.
+ */
+export interface NativeKcpFecOptions {
+  /** Segments per parity group, 1-64 (default 8). */
+  dataShards?: number;
+  /** Parity datagrams per group, 1-32 (default 2); the start value when adaptive. */
+  parityShards?: number;
+  /**
+   * Set the parity count from the loss the peer measures and reports, from
+   * one up to `maxParityShards` (default `dataShards`).
+   */
+  adaptive?: boolean;
+  maxParityShards?: number;
+}
+
+export interface NativeKcpFecSessionStats {
+  /** Parity per group this session sends now. */
+  parityShards: number;
+  /** Datagram loss before repair on the send path, as the peer reports it. */
+  lossRate: number;
+  /** The same, measured here on the receive path. */
+  receiveLossRate: number;
+  /** Segments rebuilt from parity instead of resent. */
+  recovered: number;
+}
+
+/** Engine-wide counters reported by the native KCP engine. */
+export interface NativeKcpEngineStats {
+  sessions: number;
+  datagramsIn: number;
+  datagramsOut: number;
+  /** sendmmsg calls; datagramsPerSend above 1 means datagrams were batched. */
+  sendCalls: number;
+  datagramsPerSend: number;
+  retransmits: number;
+  fastResends: number;
+  /** Malformed, foreign-conv or out-of-window datagrams. */
+  dropped: number;
+  /** Datagrams `impairment.loss` kept off the wire; present with it. */
+  impairedDrops?: number;
+  /** Present with `fec`; `kernel` is the GF(256) kernel in use ("ssse3", "neon" or "scalar"). */
+  fec?: {
+    dataShards: number;
+    adaptive: boolean;
+    parityOut: number;
+    parityIn: number;
+    recovered: number;
+    kernel: string;
+  };
+}
+
+/** Counters from the libsocket addon's batched UDP socket. */
+export interface NativeUdpSocketStats {
+  datagramsIn: number;
+  /** recvmmsg batches delivered; datagramsIn / batchesIn is the batch size. */
+  batchesIn: number;
+  datagramsOut: number;
+  /** Receive blocks allocated vs. taken back from the pool. */
+  blocksAllocated: number;
+  blocksReused: number;
+  /** True when UDP GRO was requested and the kernel accepted it. */
+  gro: boolean;
+}
+
 export interface QWTlsOptions {
   enabled?: boolean;
   key?: string | Buffer;
@@ -34,6 +1464,28 @@ export interface QWTlsOptions {
   rejectUnauthorized?: boolean;
   servername?: string;
   passphrase?: string;
+  /**
+   * Native lws client: reuse TLS sessions across connections to the same
+   * host:port in this process (default true).
+   */
+  sessionCache?: boolean;
+  /** Native lws server: issue session tickets (default true). */
+  sessionTickets?: boolean;
+  /** Native lws server: 48-byte ticket key shared by servers that should resume each other's sessions. */
+  ticketKeys?: Buffer;
+  /** Native lws server: session lifetime in seconds (default 300). */
+  sessionTimeout?: number;
+  /**
+   * Native lws (Linux, OpenSSL 3): let the kernel encrypt TLS records. Falls
+   * back to user space when unsupported; `ktlsSend`/`ktlsRecv` in the TLS
+   * info show whether it engaged. Pooled clients set it on the pool.
+   */
+  ktls?: boolean;
+  /**
+   * Native lws client: credentials from `createTlsContext()`, shared with
+   * every connection given the same handle. Replaces ca/cert/key/passphrase/ktls.
+   */
+  context?: NativeTlsContext;
   /**
    * Export TLS keying material to bind with negentropic handshake results.
    */
@@ -100,18 +1552,216 @@ export interface QWormholeReconnectOptions {
   maxAttempts: number;
 }
 
+/**
+ * Same-host transport over a Unix socket (libsocket backend, Linux): the
+ * client maps a memfd holding one ring per direction and hands it to the
+ * server with its first bytes; frames then bypass the socket, and an
+ * eventfd wakes a side only when its ring goes from empty to non-empty (or
+ * a full one drains). The server must listen with `sharedMemory` as well.
+ */
+export interface NativeSharedMemoryOptions {
+  /** Bytes per direction, rounded up to a power of two (default 1 MiB, 64 KiB-256 MiB). */
+  ringBytes?: number;
+}
+
 export interface NativeSocketOptions {
   host: string;
   port: number;
+  /** libsocket backend only. Connects a Unix stream socket instead of TCP. */
+  path?: string;
+  /** With `path`: exchange frames through shared-memory rings. */
+  sharedMemory?: boolean | NativeSharedMemoryOptions;
   useTls?: boolean;
   alpn?: string[];
   subprotocols?: string[];
   headers?: Record<string, string>;
   connectTimeoutMs?: number;
   idleTimeoutMs?: number;
+  /**
+   * Bound before connect on both backends: SO_BINDTODEVICE where permitted
+   * and the interface's address as the source.
+   */
   interfaceName?: string;
   localAddress?: string;
   localPort?: number;
+  /**
+   * lws backend only. "length-prefixed" makes the native client add the 4-byte
+   * header on send and decode RX into whole frames on its service thread,
+   * delivered as "message" events (and one frame per recv()).
+   */
+  framing?: FramingMode;
+  /** Largest native-decoded frame before the connection errors (default 4 MiB). */
+  maxFrameLength?: number;
+  /**
+   * lws backend only. How received bytes reach JS: "events" via the event
+   * handler, "pull" via recv(), "auto" (default) events once a handler is set.
+   */
+  delivery?: "auto" | "events" | "pull";
+  /**
+   * Unconsumed RX bytes after which the native client stops reading from the
+   * socket until JS drains below half of it (default 8 MiB).
+   */
+  rxHighWaterMark?: number;
+  /**
+   * lws backend only. Event deliveries queued for the JS thread after which
+   * the client stops reading, as for rxHighWaterMark (default: no cap).
+   */
+  maxPendingEvents?: number;
+  /**
+   * lws backend only. Send `heartbeatPayload` as-is whenever nothing has
+   * been written for this long, from a service-thread timer. Ignored with
+   * `mux`. `idleTimeoutMs` is enforced by the same timer.
+   */
+  heartbeatIntervalMs?: number;
+  heartbeatPayload?: Buffer;
+  /**
+   * TCP only. Applied before connect() on lws; on libsocket once the
+   * connect is in flight, too late for buffer sizes to shape the window
+   * scale. Read the effective values with `getSocketOptions()`.
+   */
+  socketOptions?: NativeSocketTuning | NativeSocketTuningPreset;
+  /**
+   * How long a resolved host is reused by later connects, across clients
+   * (default 30000; 0 always looks it up). Concurrent connects to one host
+   * share a single lookup either way.
+   */
+  dnsCacheTtlMs?: number;
+  /**
+   * libsocket backend only. Delay before the next address races the
+   * previous one, RFC 8305 "Connection Attempt Delay" (default 250, 10-2000).
+   * lws tries the next address only once an attempt fails.
+   */
+  happyEyeballsDelayMs?: number;
+  /**
+   * lws backend only. Queued send bytes at which send() returns false and a
+   * "backpressure" event fires; "drain" follows once flushed (default 5 MiB).
+   */
+  maxBackpressureBytes?: number;
+  /**
+   * lws backend only. sendMany() writes Buffers of 16 KiB or more straight
+   * from JS memory, holding a reference until written. Callers must not
+   * mutate those Buffers until the send completes (e.g. after "drain").
+   */
+  zeroCopySend?: boolean;
+  /**
+   * lws backend only. Hold the service-thread wakeup a send() or sendMany()
+   * needs until setImmediate, so a burst of sends in one macrotask costs a
+   * single wakeup. Adds up to one event-loop turn of send latency.
+   */
+  deferWakeups?: boolean;
+  /**
+   * lws backend only. "node" services the connection from Node's own event
+   * loop (lws's libuv event-lib on a foreign loop) instead of a service
+   * thread, so events reach the handler without a thread hop, at the end of
+   * the same loop iteration. Needs libwebsockets built with LWS_WITH_LIBUV;
+   * connect() throws otherwise. Not for pooled clients. A resolver cache
+   * miss resolves on the JS thread. "uv" keeps the service thread but runs
+   * it on a libuv loop of its own, so sockets are watched by IOCP on Windows
+   * (lws's default loop there is poll()); same build requirement. Default
+   * "thread".
+   */
+  loop?: "thread" | "node" | "uv";
+  /**
+   * lws backend only. Demultiplex mux frames natively: received streams
+   * arrive as "mux" events and muxOpen()/muxWrite()/muxClose() frame
+   * outbound data. Locally opened stream ids are odd.
+   */
+  mux?: boolean | NativeMuxOptions;
+  /**
+   * lws backend only. Connect with a WebSocket upgrade and exchange
+   * WebSocket messages, one per frame; `framing` is ignored.
+   */
+  websocket?: boolean | NativeWebSocketOptions;
+  /**
+   * lws backend only, with `framing: "length-prefixed"`. Enables the
+   * native AEAD stage; call `setSessionKey()` once the session key is
+   * agreed. Disables `zeroCopySend`.
+   */
+  seal?: boolean | NativeSealOptions;
+  /**
+   * lws backend only, with `framing: "length-prefixed"`: number every frame
+   * and drop replayed ones natively. The server must enable it too.
+   * Disables `zeroCopySend`.
+   */
+  sequence?: boolean | NativeSequenceOptions;
+  /**
+   * lws backend only, with `sequence`: keep unacked frames so that calling
+   * connect() again on this client resumes the session losslessly. Ignored
+   * with mux, websocket or seal.
+   */
+  resumable?: boolean | NativeResumableOptions;
+  /**
+   * lws backend only: redial natively after a drop, with backoff, hedged
+   * connects and a warm standby; see NativeReconnectOptions.
+   */
+  reconnect?: boolean | NativeReconnectOptions;
+  /**
+   * lws backend only, with `framing: "length-prefixed"` and without `mux`:
+   * accept chunked messages as "stream" events and send them with
+   * sendStream(). Caps `maxFrameLength` below the chunk bit; the server
+   * must enable it too.
+   */
+  streaming?: boolean;
+  /**
+   * lws backend only, with `framing: "length-prefixed"` and without mux or
+   * websocket: rebuild the server's broadcastDelta() patches into whole
+   * snapshots before they are delivered. Caps `maxFrameLength` below the
+   * delta bit; the server must enable it too.
+   */
+  delta?: boolean | NativeDeltaOptions;
+  /**
+   * lws backend only, with `framing: "length-prefixed"` and without mux or
+   * websocket: trail every frame sent with a CRC32C (SSE4.2 or ARMv8 CRC
+   * where the CPU has it) and check the trailers of frames received. A
+   * mismatch fails the connection. Caps `maxFrameLength` below the flag
+   * bit and turns off `zeroCopySend`, sendFile() and attachSendRing().
+   */
+  integrity?: boolean;
+  /**
+   * lws backend only: delay, jitter, a bandwidth cap and write stalls on
+   * this client's frames, seeded, for benchmarks (see
+   * NativeImpairmentOptions). `loss` is ignored on TCP.
+   */
+  impairment?: NativeImpairmentOptions;
+  /**
+   * lws backend only: hold small frames natively for a microsecond
+   * deadline so bursts share one write. Ignored by libsocket.
+   */
+  coalesce?: boolean | NativeCoalesceOptions;
+  /**
+   * lws backend only, with `framing: "length-prefixed"` and without `mux`:
+   * native request/response correlation for `rpcRequest()`. Frames carry
+   * the 16-byte header of encodeRpcFrame(); responses to outstanding
+   * requests are matched natively and arrive as batched "rpc" events, and
+   * everything else stays a "message".
+   */
+  rpc?: boolean;
+  /**
+   * lws backend: encode non-Buffer `send()`/`sendMany()` values (strings
+   * included) in the addon, as the server's `nativeCodec` does.
+   */
+  nativeCodec?: "json" | "cbor";
+  /**
+   * lws backend, with `nativeCodec`: "message" events carry the frame
+   * decoded with that codec as `value` instead of `data`. Frames the addon
+   * cannot decode (CBOR tags, integers past 2^53, invalid JSON) keep `data`.
+   */
+  nativeDecode?: boolean;
+  /**
+   * lws backend: classify received frames natively into a rolling type
+   * histogram, read from `getStats().messageTypes`.
+   */
+  messageTypes?: boolean | NativeMessageTypeOptions;
+  /** lws backend, dedicated service thread only: where it runs. */
+  cpuAffinity?: NativeCpuAffinity;
+  /** lws backend: keep the service thread on this NUMA node's CPUs. */
+  numaNode?: number;
+  /**
+   * lws backend: a signer from `createHandshakeSigner()`. Each connect writes
+   * a freshly signed handshake as the first frame, before anything sent.
+   * Ignored with `mux`.
+   */
+  handshake?: NativeHandshakeSigner;
   /**
    * Optional TLS configuration. Mirrors the public TLS options so native bindings can wrap TLS sockets.
    */
@@ -134,12 +1784,22 @@ export interface QWormholeSocketLike {
   once?(event: string, cb: (...args: any[]) => void): this;
   off?(event: string, cb: (...args: any[]) => void): this;
   getPeerCertificate?(detailed?: boolean): unknown;
+  /** Native sockets only: forward tuning to the underlying lws client. */
+  setNativeTuning?(tuning: NativeLwsTuning): NativeLwsTuning | undefined;
+  /** Native lws sockets only: hand slice/rate control to the service thread. */
+  setNativeFlowPolicy?(
+    policy: NativeFlowPolicy | null,
+  ): NativeFlowDiagnostics | null | undefined;
+  getNativeFlowDiagnostics?(): NativeFlowDiagnostics | null | undefined;
   getTlsInfo?: () =>
     | {
         alpnProtocol?: string;
         protocol?: string;
         cipher?: string;
         authorized?: boolean;
+        sessionReused?: boolean;
+        ktlsSend?: boolean;
+        ktlsRecv?: boolean;
         peerFingerprint?: string;
         peerFingerprint256?: string;
       }
@@ -158,9 +1818,11 @@ export type QWormholeSocketFactory = (
 
 export interface INativeTcpClient {
   connect(opts: NativeSocketOptions | { host: string; port: number }): void;
-  send(data: string | Buffer): void; // queues and flushes via LWS writable callbacks
+  send(data: string | Buffer): boolean | void; // false above maxBackpressureBytes (lws)
   sendMany?(data: Array<string | Buffer>): number | void;
+  sendv?(data: Array<string | Buffer>): boolean;
   recv(maxBytes?: number): Buffer; // drains from the recv ring buffer; empty Buffer if none
+  recvInto?(buffer: Buffer, offset?: number): number; // same, into a caller-owned buffer
   isConnected?(): boolean;
   supportsEventStream?(): boolean;
   getTlsInfo?():
@@ -169,6 +1831,9 @@ export interface INativeTcpClient {
         protocol?: string;
         cipher?: string;
         authorized?: boolean;
+        sessionReused?: boolean;
+        ktlsSend?: boolean;
+        ktlsRecv?: boolean;
         peerFingerprint?: string;
         peerFingerprint256?: string;
       }
@@ -178,6 +1843,9 @@ export interface INativeTcpClient {
     label: string,
     context?: Buffer,
   ): Buffer | undefined;
+  setTuning?(tuning: NativeLwsTuning): NativeLwsTuning | undefined;
+  getServiceStats?(): NativeServiceStats | undefined;
+  getStats?(): NativeClientTransportStats | undefined;
   close(): void;
   backend?: NativeBackend;
 }
@@ -185,6 +1853,11 @@ export interface INativeTcpClient {
 export interface QWormholeCommonOptions<TMessage = unknown> {
   host: string;
   port: number;
+  /**
+   * Unix domain socket path for same-host IPC; host/port are ignored when set.
+   * A leading "@" (or NUL) names a socket in the Linux abstract namespace.
+   */
+  path?: string;
   /**
    * Optional TLS settings; when provided, connections wrap Node's tls module.
    */
@@ -208,6 +1881,7 @@ export interface QWormholeCommonOptions<TMessage = unknown> {
   connectTimeoutMs?: number;
   /**
    * Optional outbound rate limit (bytes per second). When set, writes are queued and drained respecting this limit.
+   * The native lws server applies it per connection inside its write loop.
    */
   rateLimitBytesPerSec?: number;
   /**
@@ -223,6 +1897,19 @@ export interface QWormholeCommonOptions<TMessage = unknown> {
    * Enable FlowController fast path (BatchFramer-driven when safe).
    */
   flowFastPath?: boolean;
+  /**
+   * Native lws sockets: push the FlowController's slice bounds and rate to
+   * the service thread, which adapts the slice from TCP_INFO and the send
+   * queue (default true). Set false to keep the JS-driven write budget only.
+   */
+  nativeFlowControl?: boolean;
+  /**
+   * Hold the send queue in the lws addon's PriorityScheduler (per-priority
+   * lanes of Buffer references) instead of a JS array, with
+   * `rateLimitBytesPerSec` applied as messages leave it. Falls back to the
+   * JS queue when the addon is not loaded.
+   */
+  nativeScheduler?: boolean;
   /**
    * Optional protocol version string to send/expect during handshake.
    */
@@ -238,6 +1925,8 @@ export interface QWormholeCommonOptions<TMessage = unknown> {
   handshakeSigner?: () => Record<string, unknown>;
   /**
    * Optional heartbeat interval (ms). When set, the client sends a small ping payload periodically.
+   * The native lws server sends it (serialized once, `{type:"ping"}` by default)
+   * on connections nothing has been written to for this long.
    */
   heartbeatIntervalMs?: number;
   /**
@@ -253,6 +1942,10 @@ export interface QWormholeCommonOptions<TMessage = unknown> {
   maxBackpressureBytes?: number;
   keepAlive?: boolean;
   keepAliveDelayMs?: number;
+  /**
+   * Close connections idle this long (ms). The native lws server counts only
+   * received bytes and emits "timeout" before closing.
+   */
   idleTimeoutMs?: number;
   reconnect?: Partial<QWormholeReconnectOptions>;
   serializer?: Serializer;
@@ -295,6 +1988,21 @@ export interface QWormholeClientOptions<
   socketHighWaterMark?: number;
   /** Optional socket factory for custom transports (e.g., native bindings). */
   socketFactory?: QWormholeSocketFactory;
+  /**
+   * Offer `caps.compression` in the handshake (requires `protocolVersion`
+   * and length-prefixed framing) and inflate the frames a native server
+   * sends compressed. The client itself sends frames uncompressed. With a
+   * `handshakeSigner`, put `caps: { compression: "deflate" }` in the signed
+   * payload instead.
+   */
+  compression?: boolean | FrameCompressionOptions;
+  /**
+   * Offer `caps.integrity: "crc32c"` in the handshake (requires
+   * `protocolVersion` and length-prefixed framing) and check the CRC32C
+   * trailers a native server then puts on its frames; a mismatch is an
+   * "error". The client's own frames go out without trailers.
+   */
+  integrity?: boolean;
 }
 
 export interface QWormholeServerOptions<
@@ -304,8 +2012,59 @@ export interface QWormholeServerOptions<
   /**
    * Enables shard-friendly listener binding where the OS may distribute
    * inbound connections across multiple workers bound to the same host/port.
+   * Honoured by the TS server and both native backends (lws: not on Windows).
    */
   reusePort?: boolean;
+  /**
+   * libsocket server on Linux: "cpu" attaches a classic BPF program to the
+   * SO_REUSEPORT group that picks member `cpu % reusePortGroupSize`, keeping
+   * a connection on the shard serving the CPU that received it. Other
+   * backends, and "hash" (the default), leave it to the kernel hash.
+   */
+  reusePortSteering?: "hash" | "cpu";
+  /** Members of the SO_REUSEPORT group; WorkerShardedServer sets its worker count. */
+  reusePortGroupSize?: number;
+  /**
+   * listen(2) backlog; the kernel caps it at net.core.somaxconn. Defaults
+   * to SOMAXCONN on the native backends and Node's 511 on the TS server.
+   */
+  listenBacklog?: number;
+  /**
+   * Native servers: TCP_FASTOPEN queue length on the listener, so clients
+   * with a cookie send data in the SYN. 0 (default) leaves it off.
+   */
+  tcpFastOpen?: number;
+  /**
+   * Native servers on Linux: TCP_DEFER_ACCEPT. A connection is handed over
+   * only once its first bytes arrive, or after about this many seconds.
+   */
+  deferAcceptSecs?: number;
+  /**
+   * Native libsocket server on Linux: writes carrying a frame of at least
+   * this many bytes use MSG_ZEROCOPY, with the frames held until the kernel
+   * reports the send complete. 0 (default) leaves it off.
+   */
+  zeroCopyMinBytes?: number;
+  /**
+   * Native libsocket server with `path`: Unix clients that connect with
+   * `sharedMemory` move their stream onto memfd rings. Writes to a Unix
+   * connection wait for its first bytes, which say whether it did.
+   */
+  sharedMemory?: boolean;
+  /**
+   * Native libsocket server on Linux: SO_TIMESTAMPING on TCP connections.
+   * Messages carry `timestamps`, one send at a time per connection is
+   * stamped for getTimestampStats(), and syncClock() estimates a client's
+   * clock offset. "hardware" adds NIC stamps where the NIC already has
+   * them switched on; true is "software".
+   */
+  timestamping?: boolean | "software" | "hardware";
+  /**
+   * IPv6 listeners (host "::", "" on the native backends, or an IPv6
+   * address) accept IPv4 peers too unless this is true. "0.0.0.0" is
+   * always IPv4 only.
+   */
+  ipv6Only?: boolean;
   /** When true, handshake payloads are emitted through the normal message event stream. */
   emitHandshakeMessages?: boolean;
   /**
@@ -325,6 +2084,264 @@ export interface QWormholeServerOptions<
    * payload is received; returning false closes the connection.
    */
   verifyHandshake?: (payload: unknown) => boolean | Promise<boolean>;
+  /**
+   * Native lws server only: slice received frames out of pooled receive slabs
+   * and deliver them as external Buffers instead of copying every frame.
+   * A retained message Buffer keeps its whole slab alive until it is collected.
+   */
+  zeroCopyReceive?: boolean;
+  /**
+   * Native lws server only: hold the service-thread wakeup that sendTo(),
+   * broadcast() and sendBatch() need until setImmediate, so a burst of sends
+   * in one macrotask costs a single wakeup.
+   */
+  deferWakeups?: boolean;
+  /**
+   * Native lws server only: deliver frames through one SharedArrayBuffer
+   * ring per service thread (4 MiB by default) that JS drains on a single
+   * notification, instead of a "message" event and Buffer copy per frame.
+   * Message Buffers are views into the ring, valid until the handler
+   * returns; copy what you keep. A full ring falls back to events in order.
+   */
+  receiveRing?: boolean | { capacityBytes?: number };
+  /** Native lws server only: receive slab size in bytes (default 64 KiB). */
+  rxSlabBytes?: number;
+  /**
+   * Native lws server only: deliver the frames decoded in one service pass as
+   * a single batch instead of one thread-safe call per frame. The public
+   * `message` event is unchanged.
+   */
+  batchMessages?: boolean;
+  /** Native lws server only: flush a batch early once it holds this many frames (default 1024). */
+  messageBatchMax?: number;
+  /**
+   * Native lws server only: message deliveries queued for the JS thread (a
+   * batch counts once) at which connections stop being read until the queue
+   * falls below half. Off by default; the queue itself is unbounded.
+   */
+  maxPendingEvents?: number;
+  /** Native lws server only: the same cap on the bytes those deliveries carry. */
+  maxPendingEventBytes?: number;
+  /**
+   * Native lws server only: received bytes one connection may have in JS at
+   * once. Past it the server stops reading that connection, so TCP
+   * throttles the sender, and resumes at half. Off by default.
+   */
+  rxBudgetBytes?: number;
+  /**
+   * How rxBudgetBytes gets bytes back: "finalizer" (default) when a message
+   * Buffer is garbage collected, "ack" only through `ack(id, bytes)`.
+   */
+  rxBudgetRelease?: "finalizer" | "ack";
+  /**
+   * Native lws server only: connections one source address may hold (IPv6
+   * per /64). Extra connections are closed at accept, before JS sees them.
+   */
+  maxConnectionsPerIp?: number;
+  /**
+   * Native lws server only: accepts per second one source address may make,
+   * as a token bucket holding `acceptBurstPerIp` (default: one second's worth).
+   */
+  acceptRatePerIp?: number;
+  acceptBurstPerIp?: number;
+  /**
+   * Native lws server only: socket options for every accepted connection,
+   * reported back in `getConnectionStats(id).socketOptions`.
+   */
+  socketOptions?: NativeSocketTuning | NativeSocketTuningPreset;
+  /**
+   * Native lws server only: low-latency write scheduling. Sets
+   * TCP_NOTSENT_LOWAT to this many bytes and hands each connection only
+   * enough to top the kernel's unsent bytes up to it. The rest stays in the
+   * server's send queue, so a frame queued later is not stuck behind
+   * megabytes already in the socket. Costs throughput on bulk streams.
+   */
+  lowLatencyWriteBytes?: number;
+  /**
+   * Native lws server only: keep latency/size histograms per connection for
+   * `getConnectionStats()` (about 20 KiB each). Server-wide histograms from
+   * `getStats()` are always kept.
+   */
+  connectionStats?: boolean;
+  /**
+   * Native lws server only: time each connection's RX and writable
+   * callbacks on the service threads, for `getCostlyConnections()` and
+   * `getConnectionStats(id).cost`. Two clock reads per callback.
+   */
+  costAccounting?: boolean;
+  /**
+   * Native lws server only: sample TCP_INFO (RTT, cwnd, retransmits, pacing
+   * rate) for every connection this often, on the service threads. Read it
+   * from `getConnectionStats(id).tcpPath` or all at once with
+   * `getPathSnapshot()`. Off by default; at least 10 ms.
+   */
+  tcpInfoIntervalMs?: number;
+  /**
+   * Native lws server only: encode non-Buffer payloads in the addon instead
+   * of calling `serializer` first. "json" matches `defaultSerializer`, "cbor"
+   * matches `createCborSerializer()`; values the native encoder does not cover
+   * (Dates, Maps, BigInts, class instances) still go through `serializer`.
+   */
+  nativeCodec?: "json" | "cbor";
+  /**
+   * Native lws server only, with `nativeCodec`: decode inbound frames in the
+   * addon and emit them without calling `deserializer`. "json" matches
+   * `jsonDeserializer`, "cbor" `createCborDeserializer()`; frames the addon
+   * cannot decode (CBOR tags, integers past 2^53, invalid JSON) still go
+   * through `deserializer`, as do all frames under `rxBudget` acks.
+   */
+  nativeDecode?: boolean;
+  /**
+   * Native lws server only: classify received frames natively into a
+   * rolling type histogram per connection, read from
+   * `getConnectionStats(id).messageTypes`.
+   */
+  messageTypes?: boolean | NativeMessageTypeOptions;
+  /**
+   * Native lws server only: admit handshakes in the addon. Each verified
+   * handshake is matched against the policy table and answered with a signed
+   * `handshake-ack` frame (see `verifyHandshakeAck()`) before the connection
+   * is announced, so no JS runs per handshake. Requires `protocolVersion` and
+   * cannot be combined with `verifyHandshake`.
+   */
+  nativeHandshake?: NativeHandshakeOptions;
+  /**
+   * Native lws server only: verify handshakes (base64, entropy hash, Ed25519)
+   * on this many worker threads instead of the service thread. The
+   * connection's reads pause until its verdict is in. 0 (default) verifies inline.
+   */
+  handshakeVerifyThreads?: number;
+  /** Native lws server only: handshakes queued beyond this are refused (default 1024). */
+  handshakeVerifyQueueMax?: number;
+  /**
+   * Native lws server only: public keys remembered after a successful verify,
+   * so a reconnect skips the entropy hash and key parsing (default 1024, 0 disables).
+   */
+  handshakeCacheSize?: number;
+  /**
+   * Hold handshakes to the SCP schemas in src/schema/scp.ts, compiled into
+   * the lws addon (`pnpm run native:handshake-schema`). A frame with a
+   * publicKey and no resumeProof must match the negentropic schema, others
+   * the handshake schema. The lws server checks on the service thread before
+   * signature work; the TS server checks with the addon, when it is loaded,
+   * before JSON.parse. Off by default: without it the lws server also takes
+   * nIndex as a numeric string.
+   */
+  strictHandshake?: boolean;
+  /**
+   * Native lws server only: cap on the bytes per second written across all
+   * connections, enforced alongside the per-connection `rateLimitBytesPerSec`.
+   */
+  globalRateLimitBytesPerSec?: number;
+  /** Native lws server only: burst for `globalRateLimitBytesPerSec` (defaults to one second's worth). */
+  globalRateLimitBurstBytes?: number;
+  /**
+   * Native lws server only: number of libwebsockets service threads. Accepted
+   * connections are spread across threads and each thread services its own.
+   * Capped by the LWS_MAX_SMP value libwebsockets was built with.
+   */
+  serviceThreads?: number;
+  /** Native lws server only: per-thread fd limit passed to libwebsockets (0 = divide the process limit). */
+  fdLimitPerThread?: number;
+  /**
+   * Native lws server only. "uv" runs each service thread on a libuv loop of
+   * its own instead of lws's default loop, which on Windows is poll(); libuv
+   * uses IOCP there and epoll/kqueue elsewhere. Needs libwebsockets built
+   * with LWS_WITH_LIBUV; the constructor throws otherwise. Default "thread".
+   */
+  loop?: "thread" | "uv";
+  /**
+   * Native lws server only: demultiplex mux frames on the service thread.
+   * Streams arrive as "mux" events instead of "message"; write with
+   * `muxOpen`/`muxWrite`/`muxClose`. Locally opened stream ids are even.
+   */
+  mux?: boolean | NativeMuxOptions;
+  /**
+   * Native lws server only: deflate large outbound frames for connections
+   * whose handshake offered `caps.compression`, and inflate the flagged
+   * frames they send. Needs `protocolVersion` and length-prefixed framing;
+   * with `nativeHandshake` the ack echoes the accepted caps.
+   */
+  compression?: boolean | FrameCompressionOptions;
+  /**
+   * Native lws server only: accept WebSocket upgrades instead of raw TCP.
+   * Each message is one frame; strings and JSON go out as text messages.
+   * Plain HTTP requests get 426.
+   */
+  websocket?: boolean | NativeWebSocketOptions;
+  /**
+   * Native lws server only, with length-prefixed framing: enables the
+   * native AEAD stage; `setSessionKey(id, key)` keys each connection.
+   * Disables `zeroCopyReceive`.
+   */
+  seal?: boolean | NativeSealOptions;
+  /**
+   * Native lws server only, with length-prefixed framing: number every
+   * frame and drop replayed ones before they reach JS. Clients must enable
+   * it too. Disables `zeroCopyReceive`.
+   */
+  sequence?: boolean | NativeSequenceOptions;
+  /**
+   * Native lws server only, with `sequence`: keep each client's session
+   * for `ttlMs` after it disconnects so a resumable client picks it up
+   * where it left off; emits "resumable" as each hello is answered. Clients
+   * must enable it too. Ignored with mux, websocket or seal.
+   */
+  resumable?: boolean | NativeResumableOptions;
+  /**
+   * Native lws server only, with length-prefixed framing and without mux:
+   * chunked messages arrive as "stream" events, and sendStream() sends
+   * them. Clients must enable it too.
+   */
+  streaming?: boolean;
+  /**
+   * Native lws server only, with length-prefixed framing and without mux
+   * or websocket: broadcastDelta() sends keyed snapshots as patches against
+   * what each connection was last sent. Clients must enable it too.
+   */
+  delta?: boolean | NativeDeltaOptions;
+  /**
+   * Native lws server only, with length-prefixed framing and without mux:
+   * check CRC32C trailers on the frames clients flag with one, and trail
+   * frames sent to connections whose handshake offered
+   * `caps.integrity: "crc32c"` (every connection when there is no
+   * `protocolVersion`). A mismatch closes the connection. Turns off
+   * `zeroCopyReceive` and sendFile().
+   */
+  integrity?: boolean;
+  /**
+   * Native lws server only: delay, jitter, a bandwidth cap and write
+   * stalls on what each connection sends, seeded, for benchmarks (see
+   * NativeImpairmentOptions). `loss` is ignored on TCP.
+   */
+  impairment?: NativeImpairmentOptions;
+  /**
+   * Native lws server only: run a change-point detector per connection
+   * over read jitter, TCP RTT and retransmits, and emit "anomaly" when one
+   * shifts regime and again when it returns. Samples TCP_INFO every
+   * `tcpInfoIntervalMs` (100 when unset).
+   */
+  anomalyDetection?: boolean | NativeAnomalyOptions;
+  /**
+   * Native lws server only: serve OpenMetrics text on a port of its own
+   * from native counters and histograms, plus any registerMetrics() series.
+   */
+  metrics?: NativeMetricsOptions;
+  /**
+   * Native lws server only: an HTTP/2 RPC gateway on a port of its own;
+   * see NativeGatewayOptions and attachGatewayRpcServer().
+   */
+  gateway?: NativeGatewayOptions;
+  /**
+   * Native lws server only: more listeners beside `host`/`port`, each a
+   * vhost on the server's one lws context (see NativeListenEndpointOptions).
+   * Connections report which one accepted them as `endpoint`.
+   */
+  endpoints?: NativeListenEndpointOptions[];
+  /** Native lws server: where service threads run (see `serviceThreads`). */
+  cpuAffinity?: NativeCpuAffinity;
+  /** Native lws server: keep service threads on this NUMA node's CPUs. */
+  numaNode?: number;
 }
 
 export interface QWormholeClientEvents<TMessage = unknown> {
@@ -343,6 +2360,10 @@ export interface QWormholeServerConnection {
   socket: net.Socket;
   remoteAddress?: string;
   remotePort?: number;
+  /** IPv4 peers of a dual-stack listener are reported unmapped, as "IPv4". */
+  remoteFamily?: string;
+  /** Native lws server: the listener that accepted it, "default" or an `endpoints` name. */
+  endpoint?: string;
   backpressured: boolean;
   handshake?: {
     version?: string;
@@ -373,6 +2394,9 @@ export interface QWormholeServerConnection {
     tls?: {
       alpnProtocol?: string | false;
       authorized?: boolean;
+      sessionReused?: boolean;
+      ktlsSend?: boolean;
+      ktlsRecv?: boolean;
       peerFingerprint256?: string;
       peerFingerprint?: string;
       tlsSessionKey?: string;
@@ -391,15 +2415,48 @@ export interface QWormholeServerConnection {
 export interface QWormholeServerEvents<TMessage = unknown> {
   listening: net.AddressInfo;
   connection: QWormholeServerConnection;
-  message: { client: QWormholeServerConnection; data: TMessage };
+  message: {
+    client: QWormholeServerConnection;
+    data: TMessage;
+    /** `timestamping` (libsocket); absent on frames held for verifyHandshake. */
+    timestamps?: NativeRxTimestamps;
+  };
   backpressure: {
     client: QWormholeServerConnection;
     queuedBytes: number;
     threshold: number;
   };
   drain: { client: QWormholeServerConnection };
-  close: void;
-  clientClosed: { client: QWormholeServerConnection; hadError: boolean };
+  /** Native lws server: idleTimeoutMs passed with nothing received; clientClosed follows. */
+  timeout: { client: QWormholeServerConnection };
+  /** Carries a drain report after a native graceful shutdown. */
+  close: NativeShutdownReport | void;
+  /** `migrated`: handed to another shard by detachConnection(), still open. */
+  clientClosed: {
+    client: QWormholeServerConnection;
+    hadError: boolean;
+    migrated?: boolean;
+  };
+  /** Native lws server with `mux`: streams decoded from one read. */
+  mux: NativeMuxEvent & { client: QWormholeServerConnection };
+  /** Native lws server with `resumable`: a client's hello was answered. */
+  resumable: {
+    client: QWormholeServerConnection;
+    /** Session token, hex. */
+    session: string;
+    resumed: boolean;
+    replayedFrames: number;
+  };
+  /** Native lws server with `streaming`: one chunk of a streamed message. */
+  stream: NativeStreamChunk & { client: QWormholeServerConnection };
+  /** Native lws server with `gateway`: the requests one service pass completed. */
+  gatewayRequests: NativeGatewayRequest[];
+  /**
+   * Native lws server with `anomalyDetection`: a metric changed regime.
+   * Connections that close with anomalies raised get a clearing event
+   * first.
+   */
+  anomaly: NativeAnomalyEvent & { client: QWormholeServerConnection };
   error: Error;
 }
 
@@ -428,6 +2485,7 @@ export interface FlowTrustSnapshot {
 
 export interface SendOptions {
   priority?: number; // lower number = higher priority
+  ttlMs?: number; // native lws server: dropped if still queued after this
 }
 // QWormhole/src/node/peer-types.ts
 
@@ -0,0 +1,106 @@
+import { randomBytes, randomInt } from "node:crypto";
+import { threadId } from "node:worker_threads";
+import { getNativeIdService, type NativeIdService } from "../core/NativeTCPClient";
+
+/**
+ * Cooperative ids: 64-bit values that sort by creation time, laid out as
+ * 41 bits of ms since 2024-01-01, a 10-bit sequence, a 9-bit node and a
+ * 4-bit lane. The lws addon gives every generating thread its own lane,
+ * so an id costs a clock read and a counter bump; without it this isolate
+ * is one lane (its worker threadId) and the same arithmetic runs on
+ * BigInts. 16-byte ids are the 64-bit id big endian plus 8 random bytes
+ * per process (per isolate in JS), unique without assigned node numbers.
+ * Nothing is formatted until formatId() is asked for a string.
+ */
+
+const ID_EPOCH_MS = 1704067200000;
+const LANE_BITS = 4n;
+const SEQUENCE_SHIFT = 13n;
+const TIME_SHIFT = 23n;
+const SEQUENCE_STEP = 1n << SEQUENCE_SHIFT;
+const NODE_LANE_MASK = SEQUENCE_STEP - 1n;
+const MAX_NODE = 511;
+export const WIDE_ID_BYTES = 16;
+
+let native: NativeIdService | null | undefined;
+const nativeIds = (): NativeIdService | null => {
+  if (native === undefined) native = getNativeIdService();
+  return native;
+};
+
+let jsNode = BigInt(randomInt(MAX_NODE + 1));
+const jsLane = BigInt(threadId % 15);
+const jsSalt = randomBytes(8);
+let jsLast = 0n;
+
+const jsNextId = (): bigint => {
+  const since = BigInt(Math.max(0, Date.now() - ID_EPOCH_MS));
+  const floor = (since << TIME_SHIFT) | (jsNode << LANE_BITS) | jsLane;
+  const next = jsLast + SEQUENCE_STEP;
+  jsLast = (jsLast ^ floor) & NODE_LANE_MASK || next < floor ? floor : next;
+  return jsLast;
+};
+
+/** This thread's next id, unique in the process and increasing per thread. */
+export const nextId = (): bigint => nativeIds()?.nextId() ?? jsNextId();
+
+/**
+ * Writes 16-byte ids into `buffer` from `offset`, as many as fit unless
+ * `count` is given, and returns how many it wrote. Preallocate once and
+ * slice ids out instead of allocating one per message.
+ */
+export const fillIds = (buffer: Buffer, offset = 0, count?: number): number => {
+  const ids = nativeIds();
+  if (ids) return count === undefined ? ids.fillIds(buffer, offset) : ids.fillIds(buffer, offset, count);
+  if (offset > buffer.length) throw new RangeError("fillIds offset is past the end of the buffer");
+  const fit = Math.floor((buffer.length - offset) / WIDE_ID_BYTES);
+  const total = Math.min(fit, count ?? fit);
+  for (let i = 0; i < total; i += 1) {
+    const at = offset + i * WIDE_ID_BYTES;
+    buffer.writeBigUInt64BE(jsNextId(), at);
+    jsSalt.copy(buffer, at + 8);
+  }
+  return total;
+};
+
+/** The 9-bit node number ids carry from now on; random until set. */
+export const setIdNode = (node: number): void => {
+  if (!Number.isInteger(node) || node < 0 || node > MAX_NODE) {
+    throw new RangeError(`setIdNode(node) takes 0..${MAX_NODE}`);
+  }
+  nativeIds()?.setIdNode(node);
+  jsNode = BigInt(node);
+};
+
+const CROCKFORD = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+/**
+ * Crockford base32 of an id: 13 characters for a 64-bit id, 26 for a
+ * 16-byte one (left-padded to whole characters, as ULIDs are), so strings
+ * sort like the ids they came from.
+ */
+export const formatId = (id: bigint | Uint8Array): string => {
+  let bytes: Uint8Array;
+  if (typeof id === "bigint") {
+    bytes = Buffer.allocUnsafe(8);
+    (bytes as Buffer).writeBigUInt64BE(BigInt.asUintN(64, id));
+  } else {
+    bytes = id;
+  }
+  const bits = bytes.length * 8;
+  const chars = Math.ceil(bits / 5);
+  const pad = chars * 5 - bits;
+  let out = "";
+  for (let i = 0; i < chars; i += 1) {
+    let value = 0;
+    for (let k = 0; k < 5; k += 1) {
+      const bit = i * 5 + k - pad;
+      value = (value << 1) | (bit < 0 ? 0 : (bytes[bit >> 3]! >> (7 - (bit & 7))) & 1);
+    }
+    out += CROCKFORD[value];
+  }
+  return out;
+};
+
+/** nextId() formatted, for the places that need a string id right away. */
+export const nextIdString = (): string => formatId(nextId());
@@ -1,6 +1,7 @@
 // Auto-generated index for utils
 export * from './crypto';
 export * from './errors';
+export * from './ids';
 export * from './negentropic-diagnostics';
 export * from './netUtils';
 export * from './randomId';
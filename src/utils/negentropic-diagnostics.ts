@@ -2,7 +2,8 @@
 // References: https://github.com/gsknnft/NegentropicCouplingTheory/tree/dev
 
 import { Buffer } from "node:buffer";
-import type { Payload } from "src/types/types";
+import type { NativeMessageTypeStats, Payload } from "src/types/types";
+import { getNativeEntropyKernel } from "../core/NativeTCPClient";
 
 export type MessageType = string;
 
@@ -45,6 +46,34 @@ export function shannonEntropy(hist: Record<MessageType, number>): number {
   return entropy;
 }
 
+// Below this a JS loop beats the cost of crossing into the addon.
+const NATIVE_ENTROPY_MIN_BYTES = 256;
+let nativeEntropy: ((data: Uint8Array | string) => number) | null | undefined;
+
+/**
+ * Shannon entropy of a payload in bits per byte (0..8). Uses the native
+ * kernel when the lws addon is loaded, so it is cheap enough to run on every
+ * frame rather than a sample.
+ */
+export function byteEntropy(bytes: Uint8Array): number {
+  const len = bytes.length;
+  if (len === 0) return 0;
+  if (len >= NATIVE_ENTROPY_MIN_BYTES) {
+    if (nativeEntropy === undefined) nativeEntropy = getNativeEntropyKernel();
+    if (nativeEntropy) return nativeEntropy(bytes);
+  }
+  const counts = new Uint32Array(256);
+  for (let i = 0; i < len; i++) counts[bytes[i]]++;
+  let entropy = 0;
+  for (let b = 0; b < 256; b++) {
+    const count = counts[b];
+    if (count === 0) continue;
+    const p = count / len;
+    entropy -= p * Math.log2(p);
+  }
+  return entropy;
+}
+
 export function negentropy(hist: Record<MessageType, number>): number {
   const n = Object.keys(hist).length;
   if (n === 0) return 0;
@@ -85,6 +114,8 @@ export interface NegentropicSnapshot {
   coherence: Coherence;
   velocity: Velocity;
   sampleCount: number;
+  /** Bits per byte of the last binary payload passed to recordPayload(). */
+  payloadEntropy?: number;
 }
 
 const DEFAULT_SNAPSHOT: NegentropicSnapshot = {
@@ -109,6 +140,9 @@ export class NegentropicDiagnostics {
 
   recordPayload(payload: Payload | undefined): void {
     this.recordMessageType(inferMessageType(payload));
+    if (payload instanceof Uint8Array) {
+      this.snapshot = { ...this.snapshot, payloadEntropy: byteEntropy(payload) };
+    }
   }
 
   recordMessageType(messageType: MessageType | undefined): void {
@@ -145,10 +179,34 @@ export class NegentropicDiagnostics {
       coherence: mapCoherence(neganticIndex),
       velocity: mapVelocity(Math.abs(entropyVelocity)),
       sampleCount: this.histogram.total(),
+      payloadEntropy: this.snapshot.payloadEntropy,
     };
   }
 }
 
+/**
+ * A NegentropicSnapshot from the `messageTypes` stats the lws client and
+ * server keep natively, classified on the service thread for every frame,
+ * so diagnostics can stay on at full traffic rates. Reading the stats
+ * advances `entropyVelocity`, so read them from one place.
+ */
+export function nativeNegentropicSnapshot(
+  stats: NativeMessageTypeStats,
+): NegentropicSnapshot {
+  const neganticIndex = Number.isFinite(stats.negentropy) ? stats.negentropy : 0;
+  return {
+    histogram: stats.histogram,
+    entropy: stats.entropy,
+    negentropy: stats.negentropy,
+    neganticIndex,
+    entropyVelocity: stats.entropyVelocity,
+    coherence: mapCoherence(neganticIndex),
+    velocity: mapVelocity(Math.abs(stats.entropyVelocity)),
+    sampleCount: stats.sampleCount,
+    payloadEntropy: stats.payloadEntropy,
+  };
+}
+
 export function inferMessageType(payload: Payload | undefined): MessageType {
   if (typeof payload === "string") return "string";
   if (typeof payload === "number") return "number";
@@ -1,5 +1,9 @@
 import os from 'node:os';
 
+/** Maps the "@name" abstract-namespace spelling to the "\0name" form Node's net expects. */
+export const toUnixSocketPath = (path: string): string =>
+  path.startsWith('@') ? `\0${path.slice(1)}` : path;
+
 export const resolveInterfaceAddress = (interfaceName?: string): string | undefined => {
   if (!interfaceName) return undefined;
   const iface = os.networkInterfaces()[interfaceName];
@@ -0,0 +1,145 @@
+import { EventEmitter } from "node:events";
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+type NativeEvent = { type: string; data?: Buffer; hadError?: boolean };
+
+// One fake lws client per member; cwnd sets the capacity getPathSample() reports.
+const members: Array<{
+  emit: (evt: NativeEvent) => void;
+  sent: Buffer[];
+  cwnd: number;
+}> = [];
+
+class MemberClient extends FakeTcpClientWrapper<NativeEvent> {
+  private readonly member = {
+    emit: (evt: NativeEvent) => this.handler?.(evt),
+    sent: [] as Buffer[],
+    cwnd: 10,
+  };
+
+  constructor() {
+    super();
+    members.push(this.member);
+  }
+
+  send(data: Buffer) {
+    this.member.sent.push(Buffer.from(data));
+    return true;
+  }
+  getPathSample() {
+    return { rttUs: 1000, cwnd: this.member.cwnd, mss: 1000, deliveryRate: 0 };
+  }
+  recv() {
+    return Buffer.alloc(0);
+  }
+}
+
+const withLwsBinding = () =>
+  withBinding(bindingFactory, "qwormhole_lws", { TcpClientWrapper: MemberClient });
+
+describe("connection bundle", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    members.length = 0;
+  });
+
+  it("stripes frames by path capacity and reassembles them in order", async () => {
+    withLwsBinding();
+    vi.useFakeTimers();
+    try {
+      const { ConnectionBundle, ConnectionBundleAcceptor } = await import(
+        "../src/core/connection-bundle.js"
+      );
+      const bundle = new ConnectionBundle({
+        host: "peer",
+        port: 9000,
+        paths: [{ interfaceName: "wg0" }, { interfaceName: "wg1" }],
+        weightIntervalMs: 10,
+      });
+      const connected = bundle.connect();
+      members.forEach(member => member.emit({ type: "connect" }));
+      await connected;
+      members[0].cwnd = 30;
+      vi.advanceTimersByTime(10);
+
+      for (let i = 0; i < 400; i += 1) bundle.send(Buffer.from(`m${i}`));
+      const [fast, slow] = members.map(member => member.sent.length - 1);
+      expect(fast + slow).toBe(400);
+      expect(fast / slow).toBeGreaterThan(2.5);
+      expect(fast / slow).toBeLessThan(3.5);
+
+      const server = new EventEmitter();
+      const acceptor = new ConnectionBundleAcceptor(server, { native: false });
+      const received: string[] = [];
+      acceptor.on("bundle", joined => {
+        expect(joined.paths).toBe(2);
+        joined.on("message", data => received.push(data.toString()));
+      });
+      const clients = members.map((_, i) => ({ id: `c${i}` }));
+      // Introduce both members, then deliver the slow path first.
+      members.forEach((member, i) =>
+        server.emit("message", { client: clients[i], data: member.sent[0] }),
+      );
+      for (const i of [1, 0]) {
+        for (const frame of members[i].sent.slice(1)) {
+          server.emit("message", { client: clients[i], data: frame });
+        }
+      }
+      expect(received).toEqual(Array.from({ length: 400 }, (_, i) => `m${i}`));
+    } finally {
+      vi.useRealTimers();
+    }
+  });
+
+  it("stops waiting for frames a lost member had in flight", async () => {
+    bindingFactory.mockImplementation(() => {
+      throw new Error("not found");
+    });
+    const { ConnectionBundleAcceptor } = await import("../src/core/connection-bundle.js");
+    const server = new EventEmitter();
+    const acceptor = new ConnectionBundleAcceptor(server);
+    const received: string[] = [];
+    let closed = false;
+    acceptor.on("bundle", bundle => {
+      bundle.on("message", data => received.push(data.toString()));
+      bundle.on("close", () => (closed = true));
+    });
+    const hello = (index: number) => {
+      const frame = Buffer.alloc(24);
+      frame.writeUInt32BE(0x51574231, 0);
+      frame.fill(7, 4, 20);
+      frame.writeUInt16BE(index, 20);
+      frame.writeUInt16BE(2, 22);
+      return frame;
+    };
+    const frame = (seq: number, text: string) => {
+      const out = Buffer.alloc(8 + text.length);
+      out.writeUInt32BE(seq, 4);
+      out.write(text, 8);
+      return out;
+    };
+    const a = { id: "a" };
+    const b = { id: "b" };
+    server.emit("message", { client: a, data: hello(0) });
+    server.emit("message", { client: b, data: hello(1) });
+    server.emit("message", { client: a, data: frame(0, "zero") });
+    server.emit("message", { client: a, data: frame(2, "two") });
+    server.emit("message", { client: a, data: frame(3, "three") });
+    expect(received).toEqual(["zero"]);
+
+    server.emit("clientClosed", { client: b });
+    expect(received).toEqual(["zero", "two", "three"]);
+    server.emit("message", { client: a, data: frame(4, "four") });
+    expect(received).toEqual(["zero", "two", "three", "four"]);
+    server.emit("clientClosed", { client: a });
+    expect(closed).toBe(true);
+  });
+});
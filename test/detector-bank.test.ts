@@ -0,0 +1,103 @@
+import { describe, it, expect, vi } from "vitest";
+import { ResonanceDetector } from "../src/coherence/c-detector";
+import {
+  CommitmentDetector,
+  sumConfigDelta,
+} from "../src/coherence/commitment-detector";
+import {
+  DETECTOR_COMMITMENT,
+  DETECTOR_INPUT_FIELDS,
+  DETECTOR_OUTPUT_FIELDS,
+  DETECTOR_RESONANCE,
+  JsDetectorBank,
+  writeDetectorRow,
+} from "../src/coherence/detector-bank";
+
+const lcg = (seed: number) => {
+  let state = seed;
+  return () => (state = (state * 1103515245 + 12345) % 2147483648) / 2147483648;
+};
+
+// Stable stretches, spikes and config changes for one peer.
+const makeSamples = (seed: number, steps: number) => {
+  const rnd = lcg(seed);
+  return Array.from({ length: steps }, () => {
+    const stable = rnd() < 0.85;
+    const spike = rnd() < 0.15;
+    return {
+      m: stable ? 0.87 + (rnd() - 0.5) * 0.01 : rnd(),
+      v: stable ? 0.003 * (rnd() - 0.5) : rnd() * 0.05,
+      sample: {
+        latencyP95: spike ? 200 + rnd() * 200 : 100 + rnd() * 5,
+        errRate: spike ? 0.2 : 0.01,
+        latency_var: spike ? 1 : 0.01 * rnd(),
+      },
+      config: { batch_size: Math.floor(rnd() * 4) * 8 },
+    };
+  });
+};
+
+describe("DetectorBank", () => {
+  it("raises the events CommitmentDetector and ResonanceDetector do", () => {
+    vi.spyOn(console, "log").mockImplementation(() => {});
+    const peers = 8;
+    const steps = 150;
+    const clock = lcg(3);
+    let now = 1_000_000;
+    const streams = Array.from({ length: peers }, (_, i) => makeSamples(7 + i, steps));
+    const commitment = streams.map(() => new CommitmentDetector(() => now));
+    const resonance = streams.map(() => new ResonanceDetector());
+    const bank = new JsDetectorBank();
+    const input = new Float64Array(peers * DETECTOR_INPUT_FIELDS.length);
+    const out = new Float64Array(peers * DETECTOR_OUTPUT_FIELDS.length);
+    let commits = 0;
+    let resonances = 0;
+    for (let step = 0; step < steps; step += 1) {
+      // Gaps past the 5 s horizon now and then.
+      now += clock() < 0.1 ? 3000 : 100 + clock() * 400;
+      const expected: number[] = [];
+      streams.forEach((stream, peer) => {
+        const { m, v, sample, config } = stream[step];
+        const before = [commitment[peer].getEvents().length, resonance[peer].getEvents().length];
+        commitment[peer].detectCommitment(m, v, sample, config, now);
+        resonance[peer].detectResonance(m, v, sample, config);
+        expected.push(
+          (commitment[peer].getEvents().length > before[0] ? DETECTOR_COMMITMENT : 0) |
+            (resonance[peer].getEvents().length > before[1] ? DETECTOR_RESONANCE : 0),
+        );
+        const previous = stream[step - 1]?.config;
+        writeDetectorRow(input, peer, m, v, sample, previous ? sumConfigDelta(previous, config) : NaN);
+      });
+      bank.tick(now, input, out);
+      const flags = expected.map((_, peer) => out[peer * DETECTOR_OUTPUT_FIELDS.length]);
+      expect(flags).toEqual(expected);
+      commits += expected.filter(f => f & DETECTOR_COMMITMENT).length;
+      resonances += expected.filter(f => f & DETECTOR_RESONANCE).length;
+    }
+    expect(commits).toBeGreaterThan(0);
+    expect(resonances).toBeGreaterThan(0);
+    vi.restoreAllMocks();
+  });
+
+  it("updates every peer from one tick and skips NaN rows", () => {
+    const bank = new JsDetectorBank({ resonance: { window: 3 } });
+    const input = new Float64Array(3 * 6);
+    const out = new Float64Array(3 * 7);
+    for (let i = 0; i < 3; i += 1) {
+      writeDetectorRow(input, 0, 0.9, 0, { latency_var: 0.01 });
+      writeDetectorRow(input, 1, 0.2, 0.5);
+      input[12] = NaN;
+      bank.tick(1000 + i * 100, input, out);
+    }
+    expect(bank.peers()).toBe(3);
+    expect(out[0] & DETECTOR_RESONANCE).toBe(DETECTOR_RESONANCE);
+    expect(out[7]).toBe(0);
+    expect(out[14]).toBe(0);
+    expect(Number.isNaN(out[15])).toBe(true);
+
+    bank.reset(0);
+    bank.tick(1300, input, out);
+    expect(out[0]).toBe(0);
+    expect(() => bank.tick(1400, input, new Float64Array(7))).toThrow(RangeError);
+  });
+});
@@ -6,6 +6,7 @@ import {
   deriveEntropyPolicy,
   computeEntropyMetrics,
   mergeEntropyPolicies,
+  buildEntropyPolicyTable,
   ENTROPY_THRESHOLDS,
   BATCH_SIZES,
 } from "../src/handshake/entropy-policy";
@@ -148,6 +149,21 @@ describe("Entropy Policy", () => {
     });
   });
 
+  describe("buildEntropyPolicyTable", () => {
+    it("lists one admitting row per mode, highest threshold first", () => {
+      const table = buildEntropyPolicyTable();
+      expect(table.map(row => row.mode)).toEqual([
+        "trust-zero",
+        "trust-light",
+        "immune",
+        "paranoia",
+      ]);
+      expect(table.map(row => row.minNIndex)).toEqual([0.85, 0.65, 0.4, 0]);
+      expect(table.every(row => row.admit)).toBe(true);
+      expect(table[2]).toMatchObject(deriveEntropyPolicy({ negIndex: 0.5 }));
+    });
+  });
+
   describe("Constants", () => {
     it("has correct threshold values", () => {
       expect(ENTROPY_THRESHOLDS.TRUST_ZERO).toBe(0.85);
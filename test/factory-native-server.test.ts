@@ -54,4 +54,29 @@ describe("createQWormholeServer transport selection", () => {
     expect(result.nativeBackend).toBe(null);
     expect(nativeServerMock.NativeQWormholeServer).not.toHaveBeenCalled();
   });
+
+  it("keeps reusePort on the native options for sharded listeners", async () => {
+    nativeServerMock.getNativeServerBackend.mockReturnValue("lws");
+    nativeServerMock.isNativeServerAvailable.mockReturnValue(true);
+    nativeServerMock.NativeQWormholeServer.mockImplementation(
+      function FakeNativeServer(this: any) {
+        this.listen = vi.fn();
+      },
+    );
+
+    const { createQWormholeServer } = await import("../src/core/factory");
+
+    const result = createQWormholeServer({
+      host: "127.0.0.1",
+      port: 9100,
+      reusePort: true,
+      preferNative: true,
+    } as any);
+
+    expect(result.mode).toBe("native-lws");
+    expect(nativeServerMock.NativeQWormholeServer).toHaveBeenCalledWith(
+      expect.objectContaining({ reusePort: true }),
+      "lws",
+    );
+  });
 });
@@ -24,6 +24,7 @@ vi.mock("../src/core/NativeTCPClient", () => {
   return {
     NativeTcpClient: NativeTcpClientMock,
     isNativeAvailable: isNativeAvailableMock,
+    isNativeLibsocketAvailable: vi.fn(() => true),
     getNativeBackend: getNativeBackendMock,
   };
 });
@@ -69,6 +70,35 @@ describe("createQWormholeClient", () => {
     expect(result.nativeBackend).toBe("lws");
   });
 
+  it("routes Unix socket paths to the libsocket backend", () => {
+    const result = createQWormholeClient({
+      path: "/tmp/qwormhole.sock",
+      preferNative: true,
+      nativeRaw: true,
+    });
+    expect(result.client).toBeInstanceOf(NativeTcpClientMock);
+    expect((result.client as { backend: string }).backend).toBe("libsocket");
+    expect(result.mode).toBe("native-libsocket");
+    expect(result.nativeBackend).toBe("libsocket");
+  });
+
+  it("takes the libsocket rings for sharedMemory without preferNative", () => {
+    const result = createQWormholeClient({
+      path: "/tmp/qwormhole.sock",
+      sharedMemory: { ringBytes: 1 << 20 },
+    });
+    expect(result.client).toBeInstanceOf(QWormholeClient);
+    expect(result.mode).toBe("native-libsocket");
+    expect(result.nativeBackend).toBe("libsocket");
+    expect(createQWormholeClient({ ...defaultOptions, sharedMemory: true }).mode).toBe("ts");
+  });
+
+  it("rejects options without host/port or path", () => {
+    expect(() => createQWormholeClient({} as CreateClientOptions<Buffer>)).toThrow(
+      /host and port, or path/,
+    );
+  });
+
   it("returns QWormholeClient when preferNative is false", () => {
     const result = createQWormholeClient({
       ...defaultOptions,
@@ -116,4 +146,16 @@ describe("createQWormholeServer", () => {
     expect(result.server).toBeInstanceOf(QWormholeServer);
     expect(result.mode).toBe("ts");
   });
+
+  it("refuses sharedMemory without the native libsocket server", () => {
+    expect(() =>
+      createQWormholeServer({
+        host: "",
+        port: 0,
+        path: "/tmp/qwormhole-shm.sock",
+        sharedMemory: true,
+        detectNative: false,
+      }),
+    ).toThrow(/sharedMemory needs the native libsocket server/);
+  });
 });
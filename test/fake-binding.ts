@@ -0,0 +1,70 @@
+import { EventEmitter } from "node:events";
+import { vi, type Mock } from "vitest";
+
+/**
+ * Stand-ins for the addon classes, for suites that mock `bindings` to check
+ * what the TS wrappers hand the addon. Each fake remembers its latest
+ * instance in `last`, on the class that was constructed, so a suite can
+ * subclass one with the methods its feature calls and read that subclass's
+ * own `last`.
+ */
+
+export type NativeEventHandler<E = { type: string }> = (evt: E) => void;
+
+export class FakeServerWrapper extends EventEmitter {
+  static last: FakeServerWrapper | undefined;
+
+  constructor(public readonly options: Record<string, unknown>) {
+    super();
+    (this.constructor as { last?: FakeServerWrapper }).last = this;
+  }
+
+  listen(): Promise<Record<string, unknown>> {
+    return Promise.resolve({ address: "127.0.0.1", family: "IPv4", port: 0 });
+  }
+
+  close() {
+    return Promise.resolve();
+  }
+}
+
+export class FakeTcpClientWrapper<E = { type: string }> {
+  static last: FakeTcpClientWrapper | undefined;
+  handler?: NativeEventHandler<E>;
+  connect = vi.fn();
+
+  constructor() {
+    (this.constructor as { last?: FakeTcpClientWrapper<E> }).last = this;
+  }
+
+  setEventHandler(handler: NativeEventHandler<E>) {
+    this.handler = handler;
+  }
+  send(_data?: Buffer) {
+    return true;
+  }
+  close() {}
+}
+
+/**
+ * Makes the mocked `bindings` load `exports` for addon `name` and throw, as
+ * for a missing build, for any other.
+ */
+export const withBinding = (
+  bindingFactory: Mock,
+  name: string,
+  exports: Record<string, unknown> = {
+    QWormholeServerWrapper: FakeServerWrapper,
+    TcpClientWrapper: FakeTcpClientWrapper,
+  },
+) => {
+  bindingFactory.mockImplementation(
+    (arg: string | { module_root: string; bindings: string }) => {
+      const bindingName = typeof arg === "string" ? arg : arg.bindings;
+      if (bindingName === name) {
+        return exports;
+      }
+      throw new Error("not found");
+    },
+  );
+};
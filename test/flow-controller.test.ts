@@ -265,6 +265,52 @@ describe("FlowController", () => {
     const diagnostics = controller.getDiagnostics();
     expect(diagnostics.sliceHistory.length).toBe(4); // init + 3 changes
   });
+
+  it("derives the native write budget from framer caps", () => {
+    const policy = createTestPolicy();
+    const controller = new FlowController(policy);
+
+    const tuning = controller.resolveNativeTuning(true);
+    expect(tuning.maxWritesPerWritable).toBe(
+      controller.resolveFramerCaps(true).maxBuffers,
+    );
+    expect(tuning.maxWritesPerWritable).toBeGreaterThanOrEqual(1);
+  });
+
+  it("hands native flow control the session bounds and reports it back", () => {
+    const controller = new FlowController(createTestPolicy());
+
+    const bounds = controller.resolveNativeFlowPolicy(true);
+    expect(bounds.minSlice).toBe(4);
+    expect(bounds.maxSlice).toBeLessThanOrEqual(64);
+    expect(bounds.preferredSlice).toBeGreaterThanOrEqual(bounds.minSlice);
+    expect(bounds.preferredSlice).toBeLessThanOrEqual(bounds.maxSlice);
+    expect(bounds.rateBytesPerSec).toBe(10 * 1024 * 1024);
+    expect(bounds.burstBytes).toBe(256 * 1024);
+
+    expect(controller.getDiagnostics().native).toBeUndefined();
+    const native = {
+      sliceSize: 8,
+      minSlice: 4,
+      maxSlice: 64,
+      preferredSlice: 16,
+      rateBytesPerSec: 0,
+      rttUs: 900,
+      minRttUs: 400,
+      rttVarUs: 100,
+      sendBufferBytes: 65536,
+      sendQueuedBytes: 52000,
+      queueDepthBytes: 4096,
+      samples: 3,
+      sliceIncreases: 0,
+      sliceDecreases: 1,
+      rateWaits: 0,
+    };
+    controller.setNativeDiagnosticsSource(() => native);
+    expect(controller.getDiagnostics().native).toEqual(native);
+    controller.setNativeDiagnosticsSource(() => null);
+    expect(controller.getDiagnostics().native).toBeUndefined();
+  });
 });
 
 describe("deriveSessionFlowPolicy", () => {
@@ -1,5 +1,11 @@
 import { describe, it, expect, vi, beforeEach } from 'vitest';
-import { LengthPrefixedFramer } from '../src/core/framing';
+import zlib from 'node:zlib';
+import {
+  CHECKSUM_FRAME_FLAG,
+  COMPRESSED_FRAME_FLAG,
+  LengthPrefixedFramer,
+  crc32c,
+} from '../src/core/framing';
 
 function makeBuffer(str: string): Buffer {
   return Buffer.from(str, 'utf8');
@@ -102,4 +108,59 @@ describe('LengthPrefixedFramer', () => {
     expect(onMessage).toHaveBeenCalledTimes(1);
     expect(onMessage).toHaveBeenCalledWith(payload);
   });
-});
\ No newline at end of file
+
+  it('should inflate frames flagged compressed when inflate is set', () => {
+    const dictionary = makeBuffer('"type":"message"');
+    const inflating = new LengthPrefixedFramer({
+      inflate: payload => zlib.inflateRawSync(payload, { dictionary }),
+    });
+    const body = makeBuffer('{"type":"message","body":"' + 'x'.repeat(200) + '"}');
+    const deflated = zlib.deflateRawSync(body, { dictionary });
+    const header = Buffer.alloc(4);
+    header.writeUInt32BE((COMPRESSED_FRAME_FLAG | deflated.length) >>> 0, 0);
+
+    const onMessage = vi.fn();
+    inflating.on('message', onMessage);
+    inflating.push(Buffer.concat([header, deflated, inflating.encode(makeBuffer('plain'))]));
+
+    expect(onMessage).toHaveBeenCalledTimes(2);
+    expect(onMessage.mock.calls[0][0]).toEqual(body);
+    expect(onMessage.mock.calls[1][0]).toEqual(makeBuffer('plain'));
+  });
+
+  it('should check and strip CRC32C trailers when checksums is set', () => {
+    expect(crc32c(makeBuffer('123456789'))).toBe(0xe3069283);
+    const checked = new LengthPrefixedFramer({ checksums: true, preferNative: false });
+    const payload = makeBuffer('intact');
+    const frame = Buffer.alloc(4 + payload.length + 4);
+    frame.writeUInt32BE((CHECKSUM_FRAME_FLAG | (payload.length + 4)) >>> 0, 0);
+    payload.copy(frame, 4);
+    frame.writeUInt32BE(crc32c(frame.subarray(0, 4 + payload.length)), 4 + payload.length);
+
+    const onMessage = vi.fn();
+    const onError = vi.fn();
+    checked.on('message', onMessage);
+    checked.on('error', onError);
+    checked.push(Buffer.concat([frame, checked.encode(makeBuffer('plain'))]));
+    expect(onMessage.mock.calls.map(([data]) => data.toString())).toEqual(['intact', 'plain']);
+
+    frame[5] ^= 0x01;
+    checked.push(frame);
+    expect(onMessage).toHaveBeenCalledTimes(2);
+    expect(onError.mock.calls[0][0].message).toBe('Frame checksum mismatch');
+  });
+
+  it('should emit error when a compressed frame fails to inflate', () => {
+    const inflating = new LengthPrefixedFramer({
+      inflate: payload => zlib.inflateRawSync(payload),
+    });
+    const header = Buffer.alloc(4);
+    header.writeUInt32BE((COMPRESSED_FRAME_FLAG | 3) >>> 0, 0);
+
+    const onError = vi.fn();
+    inflating.on('error', onError);
+    inflating.push(Buffer.concat([header, Buffer.from([0xff, 0xff, 0xff])]));
+
+    expect(onError).toHaveBeenCalledTimes(1);
+  });
+});
@@ -0,0 +1,48 @@
+import { describe, it, expect } from "vitest";
+import { growthTrend } from "../src/telemetry/growth-trend";
+
+// Deterministic noise, so the assertions do not depend on the run.
+const noise = (seed: number) => () => {
+  seed = (seed * 1103515245 + 12345) % 2 ** 31;
+  return seed / 2 ** 31;
+};
+
+const times = Array.from({ length: 1440 }, (_, i) => i * 5000);
+const MB = 1024 * 1024;
+
+describe("growthTrend", () => {
+  it("flags a steady creep under noise", () => {
+    const rnd = noise(1);
+    const creep = times.map((_, i) => 100 * MB + i * 10_000 + rnd() * 4 * MB);
+    const trend = growthTrend(times, creep, { minAbsoluteGrowth: MB });
+    expect(trend.growing).toBe(true);
+    expect(trend.pValue).toBeLessThan(1e-6);
+    expect(trend.slopePerHour).toBeGreaterThan(6 * MB);
+  });
+
+  it("passes flat, sawtooth and plateaued series", () => {
+    const rnd = noise(2);
+    const flat = times.map(() => 100 * MB + rnd() * 4 * MB);
+    // Churn: connections come and go and their memory with them.
+    const sawtooth = times.map((_, i) => 100 * MB + (i % 60) * 100_000 + rnd() * MB);
+    // Pools filling during the warmup, then holding.
+    const plateau = times.map((_, i) => 100 * MB + Math.min(i, 200) * 100_000 + rnd() * MB);
+    for (const series of [flat, sawtooth, plateau]) {
+      expect(growthTrend(times, series, { minAbsoluteGrowth: MB }).growing).toBe(false);
+    }
+  });
+
+  it("needs the growth to be large as well as significant", () => {
+    const slight = times.map((_, i) => 100 * MB + i * 100);
+    const trend = growthTrend(times, slight);
+    expect(trend.pValue).toBeLessThan(1e-6);
+    expect(trend.relativeGrowth).toBeLessThan(0.05);
+    expect(trend.growing).toBe(false);
+  });
+
+  it("handles mostly-zero counters and short series", () => {
+    const idle = times.map((_, i) => (i % 97 === 0 ? 3 : 0));
+    expect(growthTrend(times, idle).growing).toBe(false);
+    expect(growthTrend([0, 1], [1, 2])).toMatchObject({ points: 2, growing: false });
+  });
+});
@@ -0,0 +1,86 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+describe("cooperative ids", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    bindingFactory.mockImplementation(() => {
+      throw new Error("not found");
+    });
+  });
+
+  it("issues increasing ids and formats them only on request", async () => {
+    const { nextId, fillIds, formatId, setIdNode, WIDE_ID_BYTES } = await import(
+      "../src/utils/ids.js"
+    );
+    const ids = Array.from({ length: 5000 }, () => nextId());
+    expect(new Set(ids).size).toBe(ids.length);
+    expect(ids.every((id, i) => i === 0 || id > ids[i - 1])).toBe(true);
+
+    setIdNode(7);
+    expect(Number((nextId() >> 4n) & 511n)).toBe(7);
+    expect(() => setIdNode(512)).toThrow(RangeError);
+
+    const buffer = Buffer.alloc(WIDE_ID_BYTES * 3 + 5);
+    expect(fillIds(buffer, 5)).toBe(3);
+    expect(fillIds(Buffer.alloc(64), 0, 2)).toBe(2);
+    const first = buffer.subarray(5, 5 + WIDE_ID_BYTES);
+    const second = buffer.subarray(5 + WIDE_ID_BYTES, 5 + 2 * WIDE_ID_BYTES);
+    expect(Buffer.compare(first, second)).toBe(-1);
+    expect(first.subarray(8).equals(second.subarray(8))).toBe(true);
+
+    expect(formatId(0n)).toBe("0000000000000");
+    expect(formatId(2n ** 64n - 1n)).toBe("FZZZZZZZZZZZZ");
+    expect(formatId(first)).toHaveLength(26);
+    expect(formatId(ids[0]) < formatId(ids[1])).toBe(true);
+  });
+
+  it("uses the native id service when the lws addon provides one", async () => {
+    const nextId = vi.fn(() => 42n);
+    const fillIds = vi.fn(() => 1);
+    withBinding(bindingFactory, "qwormhole_lws", {
+      TcpClientWrapper: class {},
+      nextId,
+      fillIds,
+      setIdNode: vi.fn(),
+    });
+    const ids = await import("../src/utils/ids.js");
+    expect(ids.nextId()).toBe(42n);
+    expect(ids.fillIds(Buffer.alloc(16))).toBe(1);
+    expect(fillIds).toHaveBeenCalledWith(expect.any(Buffer), 0);
+  });
+
+  it("correlates attachRpcClient requests with cooperative ids", async () => {
+    const { EventEmitter } = await import("node:events");
+    const { attachRpcClient } = await import("../src/http/rpc.js");
+    const sent: Array<{ id: string }> = [];
+    const client = Object.assign(new EventEmitter(), {
+      send: vi.fn(async (envelope: { id: string }) => {
+        sent.push(envelope);
+      }),
+    });
+    const rpc = attachRpcClient(client as never);
+    const pending = [0, 1].map(() =>
+      rpc.request({ method: "GET", path: "/" } as never, undefined, 0),
+    );
+    expect(sent).toHaveLength(2);
+    expect(sent[0].id).toMatch(/^[0-9A-HJKMNP-TV-Z]{13}$/);
+    expect(sent[0].id < sent[1].id).toBe(true);
+
+    client.emit("message", {
+      v: 1,
+      kind: "response",
+      id: sent[1].id,
+      status: { statusCode: 200 },
+    });
+    await expect(pending[1]).resolves.toMatchObject({ status: { statusCode: 200 } });
+    rpc.dispose();
+  });
+});
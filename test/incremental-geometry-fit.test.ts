@@ -0,0 +1,76 @@
+import { describe, it, expect, vi } from "vitest";
+import type { CoherenceSample } from "../src/coherence/types";
+
+vi.mock("bindings", () => ({
+  default: () => {
+    throw new Error("not found");
+  },
+}));
+
+const trajectory = (steps: number): CoherenceSample[] =>
+  Array.from({ length: steps }, (_, t) => ({
+    t: t * 50,
+    state: {
+      M: 0.8 + 0.1 * Math.sin(t / 7),
+      V: 0.05 * Math.cos(t / 5),
+      R: 0.7 + 0.2 * Math.sin(t / 11 + 1),
+      H: 1,
+      confidence: 1,
+    },
+  }));
+
+describe("IncrementalGeometryFit", () => {
+  it("matches fitGeometry and certifyGeometry over the sliding window", async () => {
+    const {
+      IncrementalGeometryFit,
+      buildSample,
+      buildSamples,
+      certifyGeometry,
+      fitGeometry,
+    } = await import("../src/coherence/field-stability.js");
+
+    for (const model of ["quadratic", "cubic"] as const) {
+      const window = 40;
+      const incremental = new IncrementalGeometryFit(window, {
+        model,
+        regularization: 1e-6,
+      });
+      const buffer = trajectory(200);
+      for (let i = 1; i < buffer.length; i += 1) {
+        incremental.push(buildSample(buffer[i - 1], buffer[i])!);
+      }
+      expect(incremental.size).toBe(window);
+
+      const samples = buildSamples(buffer).slice(-window);
+      expect(incremental.samples()).toEqual(samples);
+      const batch = fitGeometry(samples, { model, regularization: 1e-6 });
+      const fit = incremental.fit();
+      for (let i = 0; i < 3; i += 1) {
+        for (let j = 0; j < 3; j += 1) {
+          expect(fit.Q[i][j]).toBeCloseTo(batch.Q[i][j], 5);
+        }
+        expect(fit.b[i]).toBeCloseTo(batch.b[i], 5);
+        expect(fit.stats.r2[i]).toBeCloseTo(batch.stats.r2[i], 8);
+        expect(fit.stats.mse[i]).toBeCloseTo(batch.stats.mse[i], 8);
+      }
+
+      const certified = certifyGeometry(fit, incremental.samples(), 1e-6);
+      const expected = certifyGeometry(batch, samples, 1e-6);
+      expect(certified.stability.violations).toBe(expected.stability.violations);
+      expect(certified.stability.stable).toBe(expected.stability.stable);
+      expect(certified.health).toBeCloseTo(expected.health, 6);
+    }
+  });
+
+  it("starts over after reset", async () => {
+    const { IncrementalGeometryFit, buildSample } = await import(
+      "../src/coherence/field-stability.js"
+    );
+    const incremental = new IncrementalGeometryFit(8);
+    const buffer = trajectory(4);
+    incremental.push(buildSample(buffer[0], buffer[1])!);
+    incremental.reset();
+    expect(incremental.size).toBe(0);
+    expect(() => incremental.fit()).toThrow(/at least one sample/);
+  });
+});
@@ -0,0 +1,179 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+type Emit = (event: string, payload?: unknown) => boolean;
+
+class FakeKcpEngine {
+  static last: FakeKcpEngine | undefined;
+  emit?: Emit;
+  sent: Array<{ key: string; data: Buffer }> = [];
+  closed = false;
+
+  constructor(public readonly opts: Record<string, unknown>) {
+    FakeKcpEngine.last = this;
+  }
+
+  async bind() {
+    this.emit?.("listening", { address: "0.0.0.0", port: 40123 });
+    return { address: "0.0.0.0", port: 40123, family: "IPv4" };
+  }
+
+  connect(address: string, port: number) {
+    return `${address}:${port}`;
+  }
+
+  send(key: string, data: Buffer) {
+    this.sent.push({ key, data });
+    return true;
+  }
+
+  closeSession() {}
+
+  close() {
+    this.closed = true;
+    this.emit?.("close");
+  }
+
+  getSession() {
+    return undefined;
+  }
+
+  getStats() {
+    return { sessions: 0 };
+  }
+}
+
+const withEngine = () =>
+  withBinding(bindingFactory, "qwormhole", {
+    TcpClientWrapper: vi.fn(),
+    QWormholeKcpEngine: FakeKcpEngine,
+  });
+
+describe("native KCP server", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeKcpEngine.last = undefined;
+  });
+
+  it("reports unavailability without the libsocket addon", async () => {
+    bindingFactory.mockImplementation(() => {
+      throw new Error("missing");
+    });
+    const { isNativeKcpAvailable, NativeKcpServer } =
+      await import("../src/transports/kcp/kcp-native.js");
+
+    expect(isNativeKcpAvailable()).toBe(false);
+    expect(() => new NativeKcpServer({ conv: 1, listenPort: 0 })).toThrow(
+      /libsocket/,
+    );
+  });
+
+  it("passes KCP config through to the engine", async () => {
+    withEngine();
+    const { NativeKcpServer } =
+      await import("../src/transports/kcp/kcp-native.js");
+
+    const server = new NativeKcpServer({
+      conv: 7,
+      listenPort: 0,
+      mtu: 1200,
+      nodelay: { resend: 3 },
+    });
+    expect(await server.start()).toBe(40123);
+    expect(server.getPort()).toBe(40123);
+
+    const opts = FakeKcpEngine.last!.opts;
+    expect(opts).toMatchObject({ conv: 7, mtu: 1200, type: "udp4" });
+    expect(opts.nodelay).toMatchObject({ nodelay: 1, interval: 10, resend: 3 });
+    expect(opts.fec).toBeUndefined();
+  });
+
+  it("forwards fec options to the engine", async () => {
+    withEngine();
+    const { NativeKcpServer } =
+      await import("../src/transports/kcp/kcp-native.js");
+
+    new NativeKcpServer({
+      conv: 1,
+      listenPort: 0,
+      fec: { dataShards: 10, parityShards: 3, adaptive: true },
+    });
+    expect(FakeKcpEngine.last!.opts.fec).toEqual({
+      dataShards: 10,
+      parityShards: 3,
+      adaptive: true,
+    });
+  });
+
+  it("routes engine sessions and messages through a mux", async () => {
+    withEngine();
+    const { NativeKcpServer } =
+      await import("../src/transports/kcp/kcp-native.js");
+    const { MuxSession } = await import("../src/transports/mux/mux-session.js");
+
+    const server = new NativeKcpServer({ conv: 1, listenPort: 0 });
+    await server.start();
+    const engine = FakeKcpEngine.last!;
+
+    const sessions: Array<{ key: string; mux: InstanceType<typeof MuxSession> }> =
+      [];
+    server.on("session", s => sessions.push(s));
+    engine.emit!("session", { key: "10.0.0.2:5000", address: "10.0.0.2", port: 5000 });
+    expect(sessions).toHaveLength(1);
+
+    const streams: unknown[] = [];
+    sessions[0].mux.on("stream", s => streams.push(s));
+
+    // A peer mux opens a stream; its bytes arrive as one engine message.
+    const peerFrames: Uint8Array[] = [];
+    const peer = new MuxSession(buf => peerFrames.push(buf));
+    peer.createStream();
+    engine.emit!("messages", [
+      {
+        session: "10.0.0.2:5000",
+        address: "10.0.0.2",
+        port: 5000,
+        data: Buffer.concat(peerFrames),
+      },
+    ]);
+    expect(streams).toHaveLength(1);
+
+    // Our side's frames go out through engine.send on the same key.
+    sessions[0].mux.createStream();
+    expect(engine.sent.map(s => s.key)).toEqual(["10.0.0.2:5000"]);
+
+    const ended: string[] = [];
+    server.on("session:end", (key: string) => ended.push(key));
+    engine.emit!("session:end", { key: "10.0.0.2:5000", reason: "idle" });
+    expect(ended).toEqual(["10.0.0.2:5000"]);
+
+    const closed = vi.fn();
+    server.on("close", closed);
+    server.stop();
+    expect(engine.closed).toBe(true);
+    expect(closed).toHaveBeenCalledOnce();
+  });
+
+  it("hands back a usable mux for outbound sessions", async () => {
+    withEngine();
+    const { NativeKcpServer } =
+      await import("../src/transports/kcp/kcp-native.js");
+
+    const server = new NativeKcpServer({ conv: 1, listenPort: 0 });
+    await server.start();
+    const { key, mux } = server.connect("127.0.0.1", 9000);
+    expect(key).toBe("127.0.0.1:9000");
+
+    const seen: unknown[] = [];
+    server.on("session", s => seen.push(s));
+    FakeKcpEngine.last!.emit!("session", { key, outbound: true });
+    expect(seen).toEqual([{ key, mux }]);
+  });
+});
@@ -0,0 +1,94 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+const nativeHistogram = {
+  recordBatch: vi.fn(),
+  summary: vi.fn(() => ({
+    count: 3,
+    min: 1,
+    max: 3,
+    mean: 2,
+    p50: 2,
+    p90: 3,
+    p99: 3,
+    p999: 3,
+  })),
+  buckets: vi.fn(() => new Float64Array([1, 1.01, 2, 3, 3.02, 1])),
+  reset: vi.fn(),
+};
+const NativeLatencyHistogram = vi.fn(() => nativeHistogram);
+
+const withLatencyHistogram = (enabled: boolean) =>
+  withBinding(
+    bindingFactory,
+    "qwormhole_lws",
+    enabled
+      ? { TcpClientWrapper: class {}, LatencyHistogram: NativeLatencyHistogram }
+      : { TcpClientWrapper: class {} },
+  );
+
+describe("LatencyHistogram", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    NativeLatencyHistogram.mockClear();
+    Object.values(nativeHistogram).forEach(fn => fn.mockClear());
+  });
+
+  it("reports quantiles within a bucket of the exact value", async () => {
+    withLatencyHistogram(false);
+    const { LatencyHistogram } = await import("../src/telemetry/latency-histogram.js");
+    const histogram = new LatencyHistogram();
+    expect(histogram.native).toBe(false);
+    for (let i = 1; i <= 10_000; i += 1) histogram.record(i / 1000);
+    histogram.record(NaN);
+
+    const summary = histogram.summary();
+    expect(summary.count).toBe(10_000);
+    expect(summary.min).toBeCloseTo(0.001, 6);
+    expect(summary.max).toBeCloseTo(10, 6);
+    expect(summary.mean).toBeCloseTo(5.0005, 3);
+    for (const [value, expected] of [
+      [summary.p50, 5],
+      [summary.p90, 9],
+      [summary.p99, 9.9],
+      [summary.p999, 9.99],
+    ]) {
+      expect(Math.abs(value - expected) / expected).toBeLessThan(0.008);
+    }
+
+    const buckets = histogram.buckets();
+    expect(buckets.reduce((sum, [, , count]) => sum + count, 0)).toBe(10_000);
+    for (const [lower, upper] of buckets) expect(upper).toBeGreaterThan(lower);
+
+    histogram.reset();
+    expect(histogram.summary()).toMatchObject({ count: 0, p99: 0, max: 0 });
+  });
+
+  it("hands batches to the addon's histogram when it is loaded", async () => {
+    withLatencyHistogram(true);
+    const { LatencyHistogram } = await import("../src/telemetry/latency-histogram.js");
+    const histogram = new LatencyHistogram();
+    expect(histogram.native).toBe(true);
+    histogram.record(1);
+    histogram.record(2);
+    histogram.record(3);
+    expect(nativeHistogram.recordBatch).not.toHaveBeenCalled();
+
+    expect(histogram.summary().p99).toBe(3);
+    const [values, count] = nativeHistogram.recordBatch.mock.calls[0];
+    expect(count).toBe(3);
+    expect(Array.from(values.subarray(0, count))).toEqual([1, 2, 3]);
+    expect(histogram.buckets()).toEqual([
+      [1, 1.01, 2],
+      [3, 3.02, 1],
+    ]);
+    expect(new LatencyHistogram({ native: false }).native).toBe(false);
+  });
+});
@@ -1,7 +1,10 @@
 import { afterEach, beforeEach, describe, expect, it, vi } from "vitest";
 import { spawn } from "node:child_process";
+import { EventEmitter } from "node:events";
+import { QWormholeClient } from "../src/client";
 import {
   createNoopAdapter,
+  createPersistentAdapter,
   createQwormTorchAdapter,
   createRpcAdapter,
   createSpawnAdapter,
@@ -93,6 +96,88 @@ describe("mlAdapter", () => {
     await expect(adapter.run({})).rejects.toThrow("spawn failure");
   });
 
+  it("persistent adapter pipelines typed batches through one child", async () => {
+    const batches: number[] = [];
+    const schemas = new Map<number, string[]>();
+    let child: QWormholeClient<Buffer> | undefined;
+    (spawn as ReturnType<typeof vi.fn>).mockImplementation(
+      (_command: string, _args: string[], opts: { env: NodeJS.ProcessEnv }) => {
+        const proc = Object.assign(new EventEmitter(), { kill: vi.fn() });
+        const peer = new QWormholeClient<Buffer>({
+          host: "127.0.0.1",
+          port: 0,
+          path: opts.env.QWORMHOLE_ML_SOCKET,
+          deserializer: (data: Buffer) => data,
+        });
+        peer.on("message", (frame: Buffer) => {
+          if (frame[0] === 1) {
+            const names: string[] = [];
+            let offset = 12;
+            for (let i = 0; i < frame.readUInt32LE(8); i += 1) {
+              const length = frame.readUInt16LE(offset);
+              names.push(frame.toString("utf8", offset + 2, offset + 2 + length));
+              offset += 2 + length;
+            }
+            schemas.set(frame.readUInt32LE(4), names);
+            return;
+          }
+          const count = frame.readUInt16LE(2);
+          batches.push(count);
+          const replies: Buffer[] = [];
+          let offset = 8;
+          for (let i = 0; i < count; i += 1) {
+            const id = frame.readUInt32LE(offset);
+            const schemaId = frame.readUInt32LE(offset + 4);
+            const length = frame.readUInt32LE(offset + 8);
+            offset += 16;
+            let sum = 0;
+            for (let v = 0; v < length; v += 1) sum += frame.readDoubleLE(offset + v * 8);
+            offset += length * 8;
+            const reply = Buffer.alloc(32);
+            reply.writeUInt32LE(id, 0);
+            reply.writeUInt32LE(16, 8);
+            reply.writeDoubleLE(sum, 16);
+            reply.writeDoubleLE(schemas.get(schemaId)?.length ?? 0, 24);
+            replies.unshift(reply);
+          }
+          const header = Buffer.alloc(8);
+          header[0] = 3;
+          header[1] = 1;
+          header.writeUInt16LE(count, 2);
+          void peer.send(Buffer.concat([header, ...replies]));
+        });
+        child = peer;
+        void peer.connect();
+        return proc;
+      },
+    );
+
+    const adapter = createPersistentAdapter({ command: "python3", args: ["-m", "scorer"] });
+    const [named, raw] = await Promise.all([
+      adapter.run({ latencyMs: [1, 2, 3], label: "edge" }),
+      adapter.infer(new Float64Array([4, 5])),
+    ]);
+    expect(named).toEqual({ adapter: "persistent", values: [6, 3] });
+    expect(raw).toEqual({ adapter: "persistent", values: [9, 0] });
+    expect(batches).toEqual([2]);
+    expect(schemas.get(1)).toEqual(["latencyMs.0", "latencyMs.1", "latencyMs.2"]);
+
+    await expect(adapter.run({ latencyMs: [7, 8, 9] })).resolves.toEqual({
+      adapter: "persistent",
+      values: [24, 3],
+    });
+    expect(spawn).toHaveBeenCalledTimes(1);
+    expect(schemas.size).toBe(1);
+
+    await child!.disconnect();
+    await adapter.close();
+    await expect(adapter.run({ value: 1 })).rejects.toThrow(/closed/);
+  });
+
+  it("persistent adapter requires a command", () => {
+    expect(() => createPersistentAdapter({ command: "" })).toThrow(/command/);
+  });
+
   it("rpc adapter posts JSON", async () => {
     const fetchMock = vi.fn().mockResolvedValue({
       ok: true,
@@ -0,0 +1,55 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class AdoptServer extends FakeServerWrapper {
+  static last: AdoptServer | undefined;
+  adoptSocket = vi.fn(() => true);
+
+  broadcast() {}
+}
+
+const withServerBinding = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: AdoptServer });
+
+describe("native server socket adoption", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    AdoptServer.last = undefined;
+  });
+
+  it("hands the descriptor to lws and drops the Node socket", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0 },
+      "lws",
+    );
+    const socket = { _handle: { fd: 42 }, destroy: vi.fn() };
+
+    expect(server.adoptSocket(socket as never)).toBe(true);
+    expect(AdoptServer.last!.adoptSocket).toHaveBeenCalledWith(42);
+    expect(socket.destroy).toHaveBeenCalledOnce();
+  });
+
+  it("rejects sockets without a descriptor", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0 },
+      "lws",
+    );
+    expect(() => server.adoptSocket({ destroy: vi.fn() } as never)).toThrow(
+      /file descriptor/,
+    );
+    expect(AdoptServer.last!.adoptSocket).not.toHaveBeenCalled();
+  });
+});
@@ -0,0 +1,68 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+const snapshot = { id: "conn-1", handle: 1, remoteAddress: "127.0.0.1", remotePort: 4000 };
+
+describe("native anomaly detection", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeServerWrapper.last = undefined;
+  });
+
+  it("forwards regime changes into the governance signal store", async () => {
+    withBinding(bindingFactory, "qwormhole_lws");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    const { createGovernanceSignalStore } = await import(
+      "../src/coherence/governance-signals.js"
+    );
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, anomalyDetection: { threshold: 6 } },
+      "lws",
+    );
+    const native = FakeServerWrapper.last!;
+    expect(native.options.anomalyDetection).toEqual({ threshold: 6 });
+
+    const store = createGovernanceSignalStore({ regime: "coherent" });
+    const events: Array<{ metric: string; raised: boolean }> = [];
+    server.on("anomaly", event => {
+      events.push({ metric: event.metric, raised: event.raised });
+      store.applyAnomaly(event);
+    });
+    native.emit("connection", snapshot);
+
+    native.emit("anomaly", { client: snapshot, metric: "jitter", raised: true, value: 900, baseline: 80 });
+    expect(store.get()?.regime).toBe("turbulent");
+    native.emit("anomaly", { client: snapshot, metric: "rtt", raised: true, value: 40000, baseline: 900 });
+    expect(store.get()?.regime).toBe("unstable");
+    native.emit("anomaly", { client: snapshot, metric: "rtt", raised: false, value: 950, baseline: 900 });
+    expect(store.get()?.regime).toBe("turbulent");
+
+    native.emit("clientClosed", { client: snapshot });
+    expect(events).toEqual([
+      { metric: "jitter", raised: true },
+      { metric: "rtt", raised: true },
+      { metric: "rtt", raised: false },
+      { metric: "jitter", raised: false },
+    ]);
+    expect(store.get()?.regime).toBe("coherent");
+  });
+
+  it("refuses anomalyDetection on libsocket", async () => {
+    withBinding(bindingFactory, "qwormhole");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    expect(
+      () =>
+        new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, anomalyDetection: true },
+          "libsocket",
+        ),
+    ).toThrow(/anomalyDetection/);
+  });
+});
@@ -0,0 +1,98 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class RingServer extends FakeServerWrapper {
+  static last: RingServer | undefined;
+  attachBroadcastRing = vi.fn(() => true);
+
+  broadcast() {}
+}
+
+class FakeBroadcastRing {
+  published: Buffer[] = [];
+
+  constructor(public readonly options: { capacityBytes?: number }) {}
+
+  name() {
+    return "/qwormhole-ring-test";
+  }
+
+  publish(data: Buffer) {
+    this.published.push(data);
+    return true;
+  }
+
+  close() {}
+
+  getStats() {
+    return { capacityBytes: 4096, published: 0, bytes: 0, rejected: 0 };
+  }
+}
+
+describe("native broadcast ring", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    RingServer.last = undefined;
+  });
+
+  it("opens the ring from the lws addon", async () => {
+    withBinding(bindingFactory, "qwormhole_lws", {
+      QWormholeServerWrapper: RingServer,
+      BroadcastRing: FakeBroadcastRing,
+    });
+    const { createNativeBroadcastRing } =
+      await import("../src/core/native-server.js");
+    const ring = createNativeBroadcastRing(1 << 20) as unknown as
+      | FakeBroadcastRing
+      | null;
+    expect(ring).toBeInstanceOf(FakeBroadcastRing);
+    expect(ring!.options).toEqual({ capacityBytes: 1 << 20 });
+  });
+
+  it("returns null when the addon has no ring", async () => {
+    withBinding(bindingFactory, "qwormhole_lws", {
+      QWormholeServerWrapper: RingServer,
+    });
+    const { createNativeBroadcastRing } =
+      await import("../src/core/native-server.js");
+    expect(createNativeBroadcastRing()).toBeNull();
+  });
+
+  it("attaches lws servers to a ring by name", async () => {
+    withBinding(bindingFactory, "qwormhole_lws", {
+      QWormholeServerWrapper: RingServer,
+    });
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0 },
+      "lws",
+    );
+    expect(server.attachBroadcastRing("/qwormhole-ring-test")).toBe(true);
+    expect(RingServer.last!.attachBroadcastRing).toHaveBeenCalledWith(
+      "/qwormhole-ring-test",
+    );
+  });
+
+  it("rejects rings on backends without them", async () => {
+    withBinding(bindingFactory, "qwormhole", {
+      QWormholeServerWrapper: FakeServerWrapper,
+    });
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0 },
+      "libsocket",
+    );
+    expect(() => server.attachBroadcastRing("/qwormhole-ring-test")).toThrow(
+      /lws/,
+    );
+  });
+});
@@ -0,0 +1,202 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+const kernels = {
+  normalizeRows: vi.fn((matrix: Float64Array, rows: number, cols: number) => {
+    for (let i = 0; i < rows; i += 1) {
+      const row = matrix.subarray(i * cols, (i + 1) * cols);
+      const sum = row.reduce((acc, v) => acc + Math.max(0, v), 0);
+      row.forEach((v, j) => (row[j] = Math.max(0, v) / sum));
+    }
+    return matrix;
+  }),
+  matVec: vi.fn((matrix: Float64Array, vector: Float64Array, rows: number) => {
+    const out = new Float64Array(rows);
+    for (let i = 0; i < rows; i += 1) {
+      for (let j = 0; j < vector.length; j += 1) {
+        out[i] += matrix[i * vector.length + j] * vector[j];
+      }
+    }
+    return out;
+  }),
+  nboSweeps: vi.fn((base: Float64Array) => ({
+    offsets: new Float64Array(base.length).fill(0.1),
+    epiplexityPerNode: new Float64Array(base.length).fill(0.01),
+  })),
+  vectorStats: vi.fn((a: Float64Array, b?: Float64Array) => {
+    let dot = 0;
+    let sumSqA = 0;
+    let sumSqB = 0;
+    let distSq = 0;
+    a.forEach((x, i) => {
+      const y = b ? b[i] : 0;
+      dot += x * y;
+      sumSqA += x * x;
+      sumSqB += y * y;
+      distSq += (x - y) * (x - y);
+    });
+    return { dot, sumSqA, sumSqB, distSq };
+  }),
+  superformulaRadii: vi.fn(
+    (angles: Float64Array, params: Float64Array) =>
+      new Float64Array((angles.length * params.length) / 6).fill(0.5),
+  ),
+  superformulaLoss: vi.fn(
+    (_angles: Float64Array, _radii: Float64Array, params: Float64Array) =>
+      new Float64Array(params.length / 6).fill(0.25),
+  ),
+  superformulaSearch: vi.fn(
+    (
+      _angles: Float64Array,
+      _radii: Float64Array,
+      seeds: Float64Array,
+    ) => {
+      const out = new Float64Array((seeds.length / 6) * 7);
+      for (let i = 0; i < seeds.length / 6; i += 1) {
+        out.set(seeds.subarray(i * 6, i * 6 + 6), i * 7);
+        out[i * 7 + 6] = 0.1 * (i + 1);
+      }
+      return out;
+    },
+  ),
+};
+
+const withKernels = (enabled: boolean) =>
+  withBinding(
+    bindingFactory,
+    "qwormhole_lws",
+    enabled ? { TcpClientWrapper: class {}, ...kernels } : { TcpClientWrapper: class {} },
+  );
+
+const field = (n: number) =>
+  Array.from({ length: n }, (_, i) => 0.05 + 0.01 * (i % 5));
+const ring = (n: number) =>
+  Array.from({ length: n }, (_, i) =>
+    Array.from({ length: n }, (_, j) => (j === (i + 1) % n ? 2 : 0)),
+  );
+
+describe("native coherence math", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    Object.values(kernels).forEach(kernel => kernel.mockClear());
+  });
+
+  it("routes large fields through the kernels in row-major form", async () => {
+    withKernels(true);
+    const { nboVectorized, normalizeTopologyRows } = await import(
+      "../src/coherence/nbo.js"
+    );
+    const n = 16;
+    const topology = normalizeTopologyRows(ring(n));
+    expect(kernels.normalizeRows).toHaveBeenCalledWith(
+      expect.any(Float64Array),
+      n,
+      n,
+    );
+    expect(topology[0][1]).toBe(1);
+
+    const result = nboVectorized(field(n), topology, field(n), {
+      bounds: [0.2, -0.2],
+    });
+    expect(kernels.matVec).toHaveBeenCalledOnce();
+    expect(kernels.nboSweeps.mock.calls[0][1]).toMatchObject({
+      lo: -0.2,
+      hi: 0.2,
+      coordSweeps: 4,
+    });
+    expect(result.vector.stableStateVector).toEqual(new Array(n).fill(0.1));
+    expect(result.vector.epiplexityPerNode).toEqual(new Array(n).fill(0.01));
+  });
+
+  it("keeps small fields and native: false on the JS path", async () => {
+    withKernels(true);
+    const { nboVectorized } = await import("../src/coherence/nbo.js");
+    nboVectorized(field(4), ring(4), field(4));
+    nboVectorized(field(16), ring(16), field(16), { native: false });
+    expect(kernels.matVec).not.toHaveBeenCalled();
+    expect(kernels.nboSweeps).not.toHaveBeenCalled();
+  });
+
+  it("uses vectorStats for long vectors and falls back without the addon", async () => {
+    withKernels(true);
+    const invariants = await import("../src/coherence/invariants.js");
+    const a = Array.from({ length: 64 }, (_, i) => i % 3);
+    const b = Array.from({ length: 64 }, (_, i) => (i + 1) % 3);
+    const cosine = invariants.cosineSimilarity(a, b);
+    expect(invariants.euclideanDistance(a, a)).toBe(0);
+    expect(invariants.computeSignalPower(a)).toBeCloseTo(
+      a.reduce((acc, v) => acc + v * v, 0) / a.length,
+      12,
+    );
+    expect(kernels.vectorStats).toHaveBeenCalledTimes(3);
+
+    vi.resetModules();
+    withKernels(false);
+    const fallback = await import("../src/coherence/invariants.js");
+    expect(fallback.cosineSimilarity(a, b)).toBeCloseTo(cosine, 5);
+  });
+
+  it("runs the superformula seed searches as one native batch", async () => {
+    withKernels(true);
+    const sf = await import("../src/coherence/superformula.js");
+    const points = sf.generateSuperformulaPoints(
+      { m: 5, n1: 2, n2: 3, n3: 3, a: 1, b: 1 },
+      48,
+    );
+    const fit = sf.fitSuperformula(points, {
+      seeds: 4,
+      iterations: 20,
+      lossMode: "huber",
+      huberDelta: 0.2,
+    });
+    expect(kernels.superformulaSearch).toHaveBeenCalledOnce();
+    const [angles, radii, seeds, iterations, huberDelta] =
+      kernels.superformulaSearch.mock.calls[0] as unknown as [
+        Float64Array,
+        Float64Array,
+        Float64Array,
+        number,
+        number,
+      ];
+    expect(angles).toHaveLength(48);
+    expect(radii).toHaveLength(48);
+    expect(Array.from(seeds.subarray(0, 6))).toEqual([4, 2, 2, 2, 1, 1]);
+    expect([iterations, huberDelta]).toEqual([20, 0.2]);
+    expect(fit.seedResults.map(result => result.fitError)).toEqual([
+      0.1, 0.2, 0.30000000000000004, 0.4,
+    ]);
+    expect(fit.seedResults[0].params).toEqual({
+      m: 4,
+      n1: 2,
+      n2: 2,
+      n3: 2,
+      a: 1,
+      b: 1,
+    });
+
+    const params = [{ m: 4, n1: 2, n2: 2, n3: 2, a: 1, b: 1 }];
+    expect(sf.generateSuperformulaRadii(params, 8)).toHaveLength(8);
+    expect(Array.from(sf.computeLossBatch(points, params, "mae", 0.15))).toEqual([
+      0.25,
+    ]);
+  });
+
+  it("keeps the JS superformula search without the addon", async () => {
+    withKernels(false);
+    const sf = await import("../src/coherence/superformula.js");
+    const params = { m: 5, n1: 2, n2: 3, n3: 3, a: 1, b: 1 };
+    const points = sf.generateSuperformulaPoints(params, 48);
+    const radii = sf.generateSuperformulaRadii([params], 48);
+    expect(Array.from(radii)).toEqual(points.map(point => point.radius));
+    const fit = sf.fitSuperformula(points, { seeds: 4, iterations: 20, randomSeed: 1 });
+    expect(fit.seedResults).toHaveLength(4);
+    expect(fit.seedResults[0].fitError).toBeLessThan(0.2);
+  });
+});
@@ -0,0 +1,80 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class DirectoryServer extends FakeServerWrapper {
+  static last: DirectoryServer | undefined;
+  attachConnectionDirectory = vi.fn(() => true);
+  // Pretend "remote-1" lives on another shard and everything else is unknown.
+  sendTo = vi.fn((id: string) => id === "remote-1");
+
+  broadcast() {}
+}
+
+class FakeConnectionDirectory {
+  constructor(
+    public readonly options: {
+      shards: number;
+      slots?: number;
+      inboxBytes?: number;
+    },
+  ) {}
+
+  names() {
+    return { directory: "/qwormhole-dir-test", inboxes: ["/a", "/b"] };
+  }
+}
+
+const withLwsBinding = () =>
+  withBinding(bindingFactory, "qwormhole_lws", {
+    QWormholeServerWrapper: DirectoryServer,
+    ConnectionDirectory: FakeConnectionDirectory,
+  });
+
+describe("native connection directory", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    DirectoryServer.last = undefined;
+    withLwsBinding();
+  });
+
+  it("creates the directory with the shard count", async () => {
+    const { createNativeConnectionDirectory } =
+      await import("../src/core/native-server.js");
+    const directory = createNativeConnectionDirectory({
+      shards: 2,
+      inboxBytes: 1 << 20,
+    }) as unknown as FakeConnectionDirectory;
+    expect(directory).toBeInstanceOf(FakeConnectionDirectory);
+    expect(directory.options).toEqual({ shards: 2, inboxBytes: 1 << 20 });
+  });
+
+  it("joins the directory and reports forwarded sends", async () => {
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0 },
+      "lws",
+    );
+    const link = { directory: "/qwormhole-dir-test", inboxes: ["/a", "/b"] };
+    expect(server.attachConnectionDirectory({ ...link, shard: 1 })).toBe(true);
+    expect(DirectoryServer.last!.attachConnectionDirectory).toHaveBeenCalledWith(
+      { ...link, shard: 1 },
+    );
+
+    const payload = Buffer.from("hi");
+    expect(server.sendTo("remote-1", payload, { priority: 2 })).toBe(true);
+    expect(DirectoryServer.last!.sendTo).toHaveBeenCalledWith(
+      "remote-1",
+      payload,
+      { priority: 2 },
+    );
+    expect(server.sendTo("nobody", payload)).toBe(false);
+  });
+});
@@ -0,0 +1,67 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+// Two connections laid out as the addon lays them out: one buffer, widest
+// columns first.
+const fakeSnapshot = () => {
+  const count = 2;
+  const buffer = new ArrayBuffer(count * 55);
+  const addresses = new Uint8Array(buffer, count * 39, count * 16);
+  addresses.set([0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 127, 0, 0, 1], 0);
+  addresses.set([0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 9], 16);
+  const snapshot = {
+    count,
+    handles: new Float64Array(buffer, 0, count),
+    queuedBytes: new Float64Array(buffer, count * 8, count),
+    bytesReceived: new Float64Array(buffer, count * 16, count),
+    bytesSent: new Float64Array(buffer, count * 24, count),
+    rttUs: new Uint32Array(buffer, count * 32, count),
+    remotePorts: new Uint16Array(buffer, count * 36, count),
+    flags: new Uint8Array(buffer, count * 38, count),
+    addresses,
+  };
+  snapshot.handles.set([1, 2 ** 33 + 2]);
+  snapshot.queuedBytes.set([0, 65536]);
+  snapshot.rttUs.set([40, 900]);
+  snapshot.remotePorts.set([40000, 40001]);
+  snapshot.flags.set([8, 1 | 8 | 16]);
+  return snapshot;
+};
+
+class SnapshotServer extends FakeServerWrapper {
+  getConnectionsSnapshot() {
+    return fakeSnapshot();
+  }
+}
+
+describe("native connections snapshot", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+  });
+
+  it("hands back the addon's typed arrays and decodes addresses and flags", async () => {
+    withBinding(bindingFactory, "qwormhole_lws", { QWormholeServerWrapper: SnapshotServer });
+    const { NativeQWormholeServer, NativeConnectionFlag, snapshotRemoteAddress } = await import(
+      "../src/core/native-server.js"
+    );
+    const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+    const snapshot = server.getConnectionsSnapshot()!;
+    expect(snapshot.count).toBe(2);
+    expect([...snapshot.handles]).toEqual([1, 2 ** 33 + 2]);
+    expect(snapshotRemoteAddress(snapshot, 0)).toBe("127.0.0.1");
+    expect(snapshotRemoteAddress(snapshot, 1)).toBe("2001:db8::9");
+
+    const backpressured = [...snapshot.flags.keys()].filter(
+      i => snapshot.flags[i] & NativeConnectionFlag.Backpressured,
+    );
+    expect(backpressured).toEqual([1]);
+    expect(snapshot.rttUs[backpressured[0]]).toBe(900);
+  });
+});
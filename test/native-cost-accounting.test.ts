@@ -0,0 +1,68 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+const costly = [
+  {
+    id: "client-7",
+    handle: 7,
+    cpuUs: 1500,
+    rxCpuUs: 1200,
+    txCpuUs: 300,
+    rxCalls: 4000,
+    txCalls: 90,
+    bytesReceived: 64_000,
+    bytesSent: 8000,
+    framesReceived: 4000,
+    framesSent: 90,
+    cpuNsPerByte: 20.8,
+    ageMs: 5000,
+  },
+];
+
+class CostServer extends FakeServerWrapper {
+  static last: CostServer | undefined;
+  limits: Array<number | undefined> = [];
+
+  getCostlyConnections(limit?: number) {
+    this.limits.push(limit);
+    return this.options.costAccounting ? costly.slice(0, limit ?? 10) : undefined;
+  }
+}
+
+const withCosts = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: CostServer });
+
+describe("native cost accounting", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    CostServer.last = undefined;
+  });
+
+  it("passes costAccounting through and returns the costliest connections", async () => {
+    withCosts("qwormhole_lws");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, costAccounting: true },
+      "lws",
+    );
+    const native = CostServer.last!;
+    expect(native.options.costAccounting).toBe(true);
+    expect(server.getCostlyConnections(5)).toEqual(costly);
+    expect(server.getCostlyConnections()).toEqual(costly);
+    expect(native.limits).toEqual([5, undefined]);
+  });
+
+  it("is undefined without costAccounting", async () => {
+    withCosts("qwormhole_lws");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+    expect(server.getCostlyConnections()).toBeUndefined();
+  });
+});
@@ -0,0 +1,57 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class DeltaServer extends FakeServerWrapper {
+  static last: DeltaServer | undefined;
+  broadcastDelta = vi.fn();
+}
+
+const withDelta = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: DeltaServer });
+
+describe("native delta broadcasts", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    DeltaServer.last = undefined;
+  });
+
+  it("hands keyed snapshots to the addon as Buffers", async () => {
+    withDelta("qwormhole_lws");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      {
+        host: "127.0.0.1",
+        port: 7000,
+        framing: "length-prefixed",
+        delta: { maxKeys: 8, keyframeInterval: 16 },
+      },
+      "lws",
+    );
+    const native = DeltaServer.last!;
+    expect(native.options.delta).toEqual({ maxKeys: 8, keyframeInterval: 16 });
+
+    const snapshot = Buffer.from("tick-1");
+    server.broadcastDelta("book", snapshot);
+    server.broadcastDelta("book", { bid: 1, ask: 2 });
+    expect(native.broadcastDelta).toHaveBeenNthCalledWith(1, "book", snapshot);
+    const [key, data] = native.broadcastDelta.mock.calls[1];
+    expect(key).toBe("book");
+    expect(Buffer.isBuffer(data)).toBe(true);
+    expect(JSON.parse(data.toString())).toEqual({ bid: 1, ask: 2 });
+  });
+
+  it("refuses delta on libsocket", async () => {
+    withDelta("qwormhole");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    expect(
+      () => new NativeQWormholeServer({ host: "127.0.0.1", port: 0, delta: true }, "libsocket"),
+    ).toThrow(/delta broadcasts/);
+  });
+});
@@ -0,0 +1,98 @@
+import { EventEmitter } from "node:events";
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+const mdnsFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+vi.mock("multicast-dns", () => ({
+  default: mdnsFactory,
+}));
+
+type Emit = (event: string, payload?: unknown) => boolean;
+
+class FakeDiscovery {
+  static last: FakeDiscovery | undefined;
+  emit?: Emit;
+  announced: Buffer[] = [];
+  closed = false;
+
+  constructor(public readonly opts: Record<string, unknown>) {
+    FakeDiscovery.last = this;
+  }
+
+  async start() {
+    return { group: "239.255.67.71", port: 43221, family: "IPv4" };
+  }
+
+  announce(data: Buffer) {
+    this.announced.push(data);
+  }
+
+  getStats() {
+    return { datagramsIn: 3, filtered: 1, duplicates: 0, selfEchoes: 0, emitted: 2 };
+  }
+
+  close() {
+    this.closed = true;
+  }
+}
+
+const self = { id: "self", host: "10.0.0.1", port: 7000, negentropicIndex: 0.4 };
+
+describe("native discovery", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    mdnsFactory.mockReset();
+    FakeDiscovery.last = undefined;
+    withBinding(bindingFactory, "qwormhole", {
+      TcpClientWrapper: vi.fn(),
+      QWormholeDiscovery: FakeDiscovery,
+    });
+  });
+
+  it("announces through the responder and parses only its batches", async () => {
+    const { DiscoveryModule } = await import("../src/node/discovery.js");
+    const node = Object.assign(new EventEmitter(), { getSelfPeer: () => self });
+    const discovery = new DiscoveryModule(node as never, {
+      port: 43221,
+      native: true,
+      batchMs: 20,
+    });
+    const ready = new Promise(resolve => node.once("discovery:ready", resolve));
+    discovery.start();
+    await ready;
+
+    const native = FakeDiscovery.last!;
+    expect(mdnsFactory).not.toHaveBeenCalled();
+    expect(native.opts).toMatchObject({
+      port: 43221,
+      batchMs: 20,
+      prefix: '{"magic":"SIGILNET_DISCOVERY_v1",',
+    });
+    const packet = native.announced[0].toString();
+    expect(packet.startsWith(native.opts.prefix as string)).toBe(true);
+    expect(JSON.parse(packet)).toMatchObject({ id: "self", port: 7000 });
+
+    const found: string[] = [];
+    discovery.on("peer:discovered", peer => found.push(`${peer.id}@${peer.address}`));
+    const announcement = (id: string, port: number) =>
+      Buffer.from(
+        JSON.stringify({ magic: "SIGILNET_DISCOVERY_v1", id, host: "10.0.0.9", port }),
+      );
+    native.emit!("peers", [
+      { data: announcement("a", 7001), address: "10.0.0.9", port: 43221 },
+      { data: announcement("b", 7002), address: "10.0.0.9", port: 43221 },
+    ]);
+    expect(found).toEqual(["a@10.0.0.9:7001", "b@10.0.0.9:7002"]);
+    expect(discovery.getStats()).toMatchObject({ filtered: 1, emitted: 2 });
+
+    discovery.stop();
+    expect(native.closed).toBe(true);
+  });
+});
@@ -0,0 +1,98 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+import type { QWormholeServerConnection } from "../src/types/types";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+const endpoints = [
+  {
+    name: "default",
+    address: "127.0.0.1",
+    family: "IPv4",
+    port: 7000,
+    tls: false,
+    connections: 0,
+    accepted: 0,
+  },
+  {
+    name: "mesh",
+    address: "0.0.0.0",
+    family: "IPv4",
+    port: 7443,
+    tls: true,
+    connections: 1,
+    accepted: 1,
+  },
+];
+
+class EndpointServer extends FakeServerWrapper {
+  static last: EndpointServer | undefined;
+
+  listen() {
+    return Promise.resolve({ address: "127.0.0.1", family: "IPv4", port: 7000, endpoints });
+  }
+
+  getEndpoints() {
+    return endpoints;
+  }
+}
+
+const withEndpoints = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: EndpointServer });
+
+describe("native server endpoints", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    EndpointServer.last = undefined;
+  });
+
+  it("passes endpoints through and tags connections with theirs", async () => {
+    withEndpoints("qwormhole_lws");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    const mesh = {
+      name: "mesh",
+      host: "0.0.0.0",
+      port: 7443,
+      tls: { cert: "cert", key: "key", ca: "ca", requestCert: true },
+    };
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 7000, endpoints: [mesh] },
+      "lws",
+    );
+    const native = EndpointServer.last!;
+    expect(native.options.endpoints).toEqual([mesh]);
+
+    await server.listen();
+    expect(server.getEndpoints()).toEqual(endpoints);
+
+    const seen: QWormholeServerConnection[] = [];
+    server.on("connection", client => seen.push(client));
+    native.emit("connection", {
+      id: "conn-1",
+      handle: 1,
+      remoteAddress: "10.0.0.2",
+      remotePort: 50000,
+      remoteFamily: "IPv4",
+      endpoint: "mesh",
+    });
+    expect(seen).toHaveLength(1);
+    expect(seen[0].endpoint).toBe("mesh");
+  });
+
+  it("refuses endpoints on libsocket", async () => {
+    withEndpoints("qwormhole");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    expect(
+      () =>
+        new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, endpoints: [{ port: 7443 }] },
+          "libsocket",
+        ),
+    ).toThrow(/multiple endpoints/);
+  });
+});
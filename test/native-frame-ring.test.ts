@@ -0,0 +1,130 @@
+import { EventEmitter } from "node:events";
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class FakeFrameRing {
+  static last: FakeFrameRing | undefined;
+  static sendLimit = Infinity;
+  frames: Buffer[] = [];
+  flushed: Buffer[] = [];
+  flush = vi.fn((fd: number) => {
+    void fd;
+    const queued = Buffer.concat(this.frames);
+    const sent = Math.min(queued.length, FakeFrameRing.sendLimit);
+    this.flushed.push(queued.subarray(0, sent));
+    this.frames = sent < queued.length ? [queued.subarray(sent)] : [];
+    return sent;
+  });
+
+  constructor(public readonly options: Record<string, unknown>) {
+    FakeFrameRing.last = this;
+  }
+
+  append(payload: Buffer) {
+    const header = Buffer.alloc(4);
+    header.writeUInt32BE(payload.length, 0);
+    this.frames.push(header, payload);
+    return true;
+  }
+
+  take() {
+    const queued = Buffer.concat(this.frames);
+    this.frames = [];
+    return queued;
+  }
+
+  pending() {
+    return { frames: 0, bytes: Buffer.concat(this.frames).length };
+  }
+
+  clear() {
+    this.frames = [];
+  }
+}
+
+const fakeSocket = () =>
+  Object.assign(new EventEmitter(), {
+    _handle: { fd: 7 },
+    destroyed: false,
+    writableLength: 0,
+    write: vi.fn(() => true),
+  });
+
+describe("BatchFramer native ring", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeFrameRing.last = undefined;
+    FakeFrameRing.sendLimit = Infinity;
+    withBinding(bindingFactory, "qwormhole_lws", {
+      TcpClientWrapper: class {},
+      FrameRing: FakeFrameRing,
+    });
+  });
+
+  it("flushes a batch with one native send on the descriptor", async () => {
+    const { BatchFramer } = await import("../src/core/batch-framer.js");
+    const framer = new BatchFramer({
+      nativeRing: { capacityBytes: 4096 },
+      flushIntervalMs: 0,
+    });
+    const socket = fakeSocket();
+    framer.attachSocket(socket as never);
+
+    framer.encodeToBatch(Buffer.from("one"));
+    framer.encodeToBatch(Buffer.from("two"));
+    expect(framer.pendingBatchSize).toBe(2);
+    await framer.flushBatch();
+
+    const ring = FakeFrameRing.last!;
+    expect(ring.options).toEqual({ capacityBytes: 4096 });
+    expect(ring.flush).toHaveBeenCalledOnce();
+    expect(ring.flush).toHaveBeenCalledWith(7);
+    expect(ring.flushed[0].length).toBe(14);
+    expect(socket.write).not.toHaveBeenCalled();
+    const stats = framer.getStats();
+    expect(stats.totalFrames).toBe(2);
+    expect(stats.totalFlushes).toBe(1);
+    expect(stats.totalBytes).toBe(14);
+    expect(stats.pendingFrames).toBe(0);
+    expect(stats.maxPendingFrames).toBe(2);
+  });
+
+  it("hands what the kernel left to socket.write, in order", async () => {
+    const { BatchFramer } = await import("../src/core/batch-framer.js");
+    const framer = new BatchFramer({ nativeRing: true, flushIntervalMs: 0 });
+    const socket = fakeSocket();
+    framer.attachSocket(socket as never);
+    FakeFrameRing.sendLimit = 5;
+
+    framer.encodeToBatch(Buffer.from("abc"));
+    framer.encodeToBatch(Buffer.from("def"));
+    await framer.flushBatch();
+
+    const rest = socket.write.mock.calls[0][0] as unknown as Buffer;
+    expect(Buffer.concat([FakeFrameRing.last!.flushed[0], rest])).toEqual(
+      Buffer.from([0, 0, 0, 3, 97, 98, 99, 0, 0, 0, 3, 100, 101, 102]),
+    );
+    expect(framer.getStats().copyAllocations).toBe(1);
+  });
+
+  it("writes through the socket while its own queue is busy", async () => {
+    const { BatchFramer } = await import("../src/core/batch-framer.js");
+    const framer = new BatchFramer({ nativeRing: true, flushIntervalMs: 0 });
+    const socket = fakeSocket();
+    socket.writableLength = 128;
+    framer.attachSocket(socket as never);
+
+    framer.encodeToBatch(Buffer.from("x"));
+    await framer.flushBatch();
+
+    expect(FakeFrameRing.last!.flush).not.toHaveBeenCalled();
+    expect(socket.write).toHaveBeenCalledOnce();
+  });
+});
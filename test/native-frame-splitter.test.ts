@@ -0,0 +1,132 @@
+import zlib from "node:zlib";
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+type SplitResult = {
+  frames: Buffer[];
+  compressed?: number[];
+  oversized?: number;
+  corrupt?: number;
+};
+
+class FakeFrameSplitter {
+  static last: FakeFrameSplitter | undefined;
+  static next: SplitResult = { frames: [] };
+  push = vi.fn((): SplitResult => FakeFrameSplitter.next);
+  reset = vi.fn();
+  buffered = vi.fn(() => 0);
+
+  constructor(public readonly options: Record<string, unknown>) {
+    FakeFrameSplitter.last = this;
+  }
+}
+
+const withSplitterBinding = () =>
+  withBinding(bindingFactory, "qwormhole_lws", {
+    TcpClientWrapper: class {},
+    FrameSplitter: FakeFrameSplitter,
+  });
+
+describe("native frame splitter", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeFrameSplitter.last = undefined;
+    FakeFrameSplitter.next = { frames: [] };
+    withSplitterBinding();
+  });
+
+  it("emits the splitter's frames and inflates the flagged ones", async () => {
+    const { LengthPrefixedFramer } = await import("../src/core/framing.js");
+    const framer = new LengthPrefixedFramer({ inflate: zlib.inflateRawSync });
+    expect(FakeFrameSplitter.last!.options).toEqual({
+      maxFrameLength: 4 * 1024 * 1024,
+      compressedFlag: true,
+    });
+
+    const onMessage = vi.fn();
+    framer.on("message", onMessage);
+    FakeFrameSplitter.next = {
+      frames: [Buffer.from("plain"), zlib.deflateRawSync(Buffer.from("packed"))],
+      compressed: [1],
+    };
+    const chunk = Buffer.alloc(8);
+    framer.push(chunk);
+
+    expect(FakeFrameSplitter.last!.push).toHaveBeenCalledWith(chunk);
+    expect(onMessage.mock.calls.map(([frame]) => frame.toString())).toEqual([
+      "plain",
+      "packed",
+    ]);
+  });
+
+  it("reports an oversized prefix after the frames before it", async () => {
+    const { LengthPrefixedFramer } = await import("../src/core/framing.js");
+    const framer = new LengthPrefixedFramer({ maxFrameLength: 16 });
+    const onMessage = vi.fn();
+    const onError = vi.fn();
+    framer.on("message", onMessage);
+    framer.on("error", onError);
+    FakeFrameSplitter.next = { frames: [Buffer.from("ok")], oversized: 64 };
+
+    framer.push(Buffer.alloc(4));
+
+    expect(onMessage).toHaveBeenCalledOnce();
+    expect(onError.mock.calls[0][0].message).toBe(
+      "Frame length 64 exceeds limit 16",
+    );
+  });
+
+  it("asks for checksum checks and reports a corrupt frame", async () => {
+    const { LengthPrefixedFramer } = await import("../src/core/framing.js");
+    const framer = new LengthPrefixedFramer({ checksums: true });
+    expect(FakeFrameSplitter.last!.options).toEqual({
+      maxFrameLength: 4 * 1024 * 1024,
+      compressedFlag: false,
+      checksumFlag: true,
+    });
+    const onMessage = vi.fn();
+    const onError = vi.fn();
+    framer.on("message", onMessage);
+    framer.on("error", onError);
+    FakeFrameSplitter.next = { frames: [Buffer.from("ok")], corrupt: 1 };
+
+    framer.push(Buffer.alloc(12));
+
+    expect(onMessage).toHaveBeenCalledOnce();
+    expect(onError.mock.calls[0][0].message).toBe("Frame checksum mismatch");
+  });
+
+  it("feeds BatchFramer through the splitter too", async () => {
+    const { BatchFramer } = await import("../src/core/batch-framer.js");
+    const framer = new BatchFramer({ maxFrameLength: 1024 });
+    const onMessage = vi.fn();
+    framer.on("message", onMessage);
+    FakeFrameSplitter.next = { frames: [Buffer.from("a"), Buffer.from("b")] };
+
+    framer.push(Buffer.alloc(10));
+    expect(onMessage).toHaveBeenCalledTimes(2);
+    expect(framer.getStats().maxInBufferBytes).toBe(10);
+
+    framer.reset();
+    expect(FakeFrameSplitter.last!.reset).toHaveBeenCalled();
+  });
+
+  it("stays in TS with preferNative: false", async () => {
+    const { LengthPrefixedFramer } = await import("../src/core/framing.js");
+    const framer = new LengthPrefixedFramer({ preferNative: false });
+    const onMessage = vi.fn();
+    framer.on("message", onMessage);
+
+    framer.push(framer.encode(Buffer.from("ts")));
+
+    expect(FakeFrameSplitter.last).toBeUndefined();
+    expect(onMessage.mock.calls[0][0].toString()).toBe("ts");
+  });
+});
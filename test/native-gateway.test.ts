@@ -0,0 +1,89 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class GatewayServer extends FakeServerWrapper {
+  static last: GatewayServer | undefined;
+  responses: unknown[][] = [];
+
+  getGatewayPort() {
+    return 8443;
+  }
+
+  respondGateway(...args: unknown[]) {
+    this.responses.push(args);
+    return true;
+  }
+}
+
+const withGateway = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: GatewayServer });
+
+describe("native HTTP/2 gateway", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    GatewayServer.last = undefined;
+  });
+
+  it("answers each request of a batch through respondGateway", async () => {
+    withGateway("qwormhole_lws");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    const { attachGatewayRpcServer } = await import("../src/http/rpc.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, gateway: { port: 0, path: "/rpc", maxStreams: 64 } },
+      "lws",
+    );
+    const native = GatewayServer.last!;
+    expect(native.options.gateway).toEqual({ port: 0, path: "/rpc", maxStreams: 64 });
+    expect(server.getGatewayPort()).toBe(8443);
+
+    const seen: string[] = [];
+    const detach = attachGatewayRpcServer(
+      server,
+      async (body, ctx) => {
+        seen.push(ctx.path);
+        if (ctx.path === "/rpc/fail") throw new Error("boom");
+        return { status: 200, body: Buffer.concat([Buffer.from("echo:"), body]) };
+      },
+      { contentType: "application/x-qwormhole-rpc" },
+    );
+
+    native.emit("gatewayRequests", [
+      { id: 256, path: "/rpc/echo", body: Buffer.from("a") },
+      { id: 513, path: "/rpc/fail", contentType: "text/plain", body: Buffer.alloc(0) },
+    ]);
+    await vi.waitFor(() => expect(native.responses).toHaveLength(2));
+
+    expect(seen).toEqual(["/rpc/echo", "/rpc/fail"]);
+    const byId = new Map(native.responses.map(args => [args[0], args.slice(1)]));
+    expect(byId.get(256)).toEqual([
+      200,
+      Buffer.from("echo:a"),
+      "application/x-qwormhole-rpc",
+    ]);
+    expect(byId.get(513)).toEqual([500, "boom", "text/plain; charset=utf-8"]);
+
+    detach();
+    native.emit("gatewayRequests", [{ id: 769, path: "/rpc/echo", body: Buffer.from("b") }]);
+    await new Promise(resolve => setImmediate(resolve));
+    expect(native.responses).toHaveLength(2);
+  });
+
+  it("refuses a gateway on libsocket", async () => {
+    withGateway("qwormhole");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    expect(
+      () =>
+        new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, gateway: { port: 8443 } },
+          "libsocket",
+        ),
+    ).toThrow(/HTTP\/2 gateway/);
+  });
+});
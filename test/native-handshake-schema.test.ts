@@ -0,0 +1,47 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+const validateHandshake = vi.fn((frame: Uint8Array | string) =>
+  String(frame).includes('"handshake"') ? null : "Handshake does not match the schema: type is required",
+);
+
+const withValidator = (name: string) =>
+  withBinding(bindingFactory, name, {
+    QWormholeServerWrapper: FakeServerWrapper,
+    ...(name === "qwormhole_lws" ? { validateHandshake } : {}),
+  });
+
+describe("native handshake schema", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    validateHandshake.mockClear();
+  });
+
+  it("exposes the addon's validator", async () => {
+    withValidator("qwormhole_lws");
+    const { getNativeHandshakeValidator } = await import("../src/core/NativeTCPClient.js");
+    const validate = getNativeHandshakeValidator()!;
+    expect(validate('{"type":"handshake"}')).toBeNull();
+    expect(validate('{"version":"1"}', "handshake")).toMatch(/type is required/);
+    expect(validateHandshake).toHaveBeenLastCalledWith('{"version":"1"}', "handshake");
+  });
+
+  it("refuses strictHandshake on libsocket", async () => {
+    withValidator("qwormhole");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    expect(
+      () =>
+        new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, strictHandshake: true },
+          "libsocket",
+        ),
+    ).toThrow(/strictHandshake/);
+  });
+});
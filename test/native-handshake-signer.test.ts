@@ -0,0 +1,84 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class FakeHandshakeSigner {
+  static last: FakeHandshakeSigner | undefined;
+  sign = vi.fn((ts?: number) => Buffer.from(JSON.stringify({ type: "handshake", ts })));
+
+  constructor(public readonly options: Record<string, unknown>) {
+    FakeHandshakeSigner.last = this;
+  }
+
+  describe() {
+    return { publicKey: "spki", negHash: "abcd", nIndex: 0.002, nonce: "nonce" };
+  }
+}
+
+const withSigner = (name: string) =>
+  withBinding(bindingFactory, name, {
+    TcpClientWrapper: FakeTcpClientWrapper,
+    ...(name === "qwormhole_lws" ? { HandshakeSigner: FakeHandshakeSigner } : {}),
+  });
+
+describe("native handshake signer", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeHandshakeSigner.last = undefined;
+    FakeTcpClientWrapper.last = undefined;
+  });
+
+  it("loads the key once and hands the signer to connect()", async () => {
+    withSigner("qwormhole_lws");
+    const { NativeTcpClient, createHandshakeSigner } =
+      await import("../src/core/NativeTCPClient.js");
+    const signer = createHandshakeSigner({
+      signingKey: "a2V5",
+      version: "1.0.0",
+      tags: { zone: "eu", weight: 2 },
+    });
+    expect(FakeHandshakeSigner.last!.options).toEqual({
+      signingKey: "a2V5",
+      version: "1.0.0",
+      tags: { zone: "eu", weight: 2 },
+    });
+    expect(signer.info).toEqual({
+      publicKey: "spki",
+      negHash: "abcd",
+      nIndex: 0.002,
+      nonce: "nonce",
+    });
+    expect(JSON.parse(signer.sign(42).toString())).toEqual({ type: "handshake", ts: 42 });
+
+    const client = new NativeTcpClient("lws");
+    client.connect({
+      host: "127.0.0.1",
+      port: 9000,
+      framing: "length-prefixed",
+      handshake: signer,
+    });
+    expect(FakeTcpClientWrapper.last!.connect).toHaveBeenCalledWith(
+      expect.objectContaining({ handshake: FakeHandshakeSigner.last }),
+    );
+  });
+
+  it("refuses native handshakes on libsocket", async () => {
+    withSigner("qwormhole_lws");
+    const { createHandshakeSigner } = await import("../src/core/NativeTCPClient.js");
+    const signer = createHandshakeSigner({ signingKey: "a2V5" });
+
+    vi.resetModules();
+    withSigner("qwormhole");
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient.js");
+    const client = new NativeTcpClient("libsocket");
+    expect(() =>
+      client.connect({ host: "127.0.0.1", port: 9000, handshake: signer }),
+    ).toThrow(/native handshakes/);
+  });
+});
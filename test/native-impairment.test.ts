@@ -0,0 +1,80 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class FakeKcpEngine {
+  static last: FakeKcpEngine | undefined;
+
+  constructor(public readonly options: Record<string, unknown>) {
+    FakeKcpEngine.last = this;
+  }
+
+  getStats() {
+    return { sessions: 0, dropped: 0, impairedDrops: 4 };
+  }
+}
+
+const withEngines = (name: string) =>
+  withBinding(bindingFactory, name, {
+    QWormholeServerWrapper: FakeServerWrapper,
+    TcpClientWrapper: FakeTcpClientWrapper,
+    QWormholeKcpEngine: FakeKcpEngine,
+  });
+
+const impairment = {
+  delayMs: 20,
+  jitterMs: 5,
+  distribution: "normal" as const,
+  bandwidthBytesPerSec: 1_000_000,
+  stallEveryMs: 500,
+  stallMs: 50,
+  seed: 7,
+};
+
+describe("native impairment", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeServerWrapper.last = undefined;
+    FakeTcpClientWrapper.last = undefined;
+    FakeKcpEngine.last = undefined;
+  });
+
+  it("passes impairment to the lws server and client", async () => {
+    withEngines("qwormhole_lws");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    new NativeQWormholeServer({ host: "127.0.0.1", port: 0, impairment }, "lws");
+    expect(FakeServerWrapper.last!.options.impairment).toEqual(impairment);
+
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient.js");
+    const client = new NativeTcpClient("lws");
+    client.connect({ host: "127.0.0.1", port: 9000, impairment });
+    expect(FakeTcpClientWrapper.last!.connect).toHaveBeenCalledWith(
+      expect.objectContaining({ impairment }),
+    );
+  });
+
+  it("gives the KCP engine its loss and refuses impairment on libsocket TCP", async () => {
+    withEngines("qwormhole");
+    const { NativeKcpServer } = await import("../src/transports/kcp/kcp-native.js");
+    const kcp = new NativeKcpServer({ listenPort: 0, impairment: { loss: 0.1, seed: 3 } });
+    expect(FakeKcpEngine.last!.options.impairment).toEqual({ loss: 0.1, seed: 3 });
+    expect(kcp.getStats().impairedDrops).toBe(4);
+
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    expect(
+      () => new NativeQWormholeServer({ host: "127.0.0.1", port: 0, impairment }, "libsocket"),
+    ).toThrow(/impairment/);
+
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient.js");
+    const client = new NativeTcpClient("libsocket");
+    expect(() => client.connect({ host: "127.0.0.1", port: 9000, impairment })).toThrow(
+      /impairment/,
+    );
+  });
+});
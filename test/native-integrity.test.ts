@@ -0,0 +1,48 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+describe("native frame integrity", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeServerWrapper.last = undefined;
+    FakeTcpClientWrapper.last = undefined;
+  });
+
+  it("passes integrity to the lws server and client", async () => {
+    withBinding(bindingFactory, "qwormhole_lws");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, framing: "length-prefixed", integrity: true },
+      "lws",
+    );
+    expect(FakeServerWrapper.last!.options.integrity).toBe(true);
+
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient.js");
+    const client = new NativeTcpClient("lws");
+    client.connect({ host: "127.0.0.1", port: 9000, framing: "length-prefixed", integrity: true });
+    expect(FakeTcpClientWrapper.last!.connect).toHaveBeenCalledWith(
+      expect.objectContaining({ integrity: true }),
+    );
+  });
+
+  it("refuses integrity on libsocket", async () => {
+    withBinding(bindingFactory, "qwormhole");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    expect(
+      () => new NativeQWormholeServer({ host: "127.0.0.1", port: 0, integrity: true }, "libsocket"),
+    ).toThrow(/integrity/);
+
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient.js");
+    const client = new NativeTcpClient("libsocket");
+    expect(() => client.connect({ host: "127.0.0.1", port: 9000, integrity: true })).toThrow(
+      /native framing/,
+    );
+  });
+});
@@ -0,0 +1,67 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class MetricsServer extends FakeServerWrapper {
+  static last: MetricsServer | undefined;
+  registered: unknown[] = [];
+
+  registerMetrics(metrics: unknown[]) {
+    this.registered.push(...metrics);
+    return new Float64Array(new SharedArrayBuffer(metrics.length * 8));
+  }
+
+  getMetricsPort() {
+    return 9464;
+  }
+}
+
+const withMetrics = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: MetricsServer });
+
+describe("native metrics endpoint", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    MetricsServer.last = undefined;
+  });
+
+  it("passes metrics to the lws server and hands back JS metric slots", async () => {
+    withMetrics("qwormhole_lws");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, metrics: { port: 0, path: "/scrape" } },
+      "lws",
+    );
+    const native = MetricsServer.last!;
+    expect(native.options.metrics).toEqual({ port: 0, path: "/scrape" });
+    expect(server.getMetricsPort()).toBe(9464);
+
+    const definitions = [
+      { name: "app_jobs", type: "counter" as const, help: "Jobs run." },
+      { name: "app_queue_depth", type: "gauge" as const, labels: { queue: "io" } },
+    ];
+    const slots = server.registerMetrics(definitions)!;
+    expect(native.registered).toEqual(definitions);
+    expect(slots).toHaveLength(2);
+    slots[0] += 1;
+    expect(slots[0]).toBe(1);
+  });
+
+  it("refuses metrics on libsocket", async () => {
+    withMetrics("qwormhole");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    expect(
+      () =>
+        new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, metrics: { port: 9464 } },
+          "libsocket",
+        ),
+    ).toThrow(/metrics/);
+  });
+});
@@ -0,0 +1,93 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+const state = Buffer.from("QWMIGR01state");
+
+class MigratingServer extends FakeServerWrapper {
+  static last: MigratingServer | undefined;
+  adoptSocket = vi.fn(() => true);
+  detachConnection = vi.fn((id: string) =>
+    Promise.resolve(id === "conn-1" ? { id, fd: 77, state } : null),
+  );
+
+  broadcast() {}
+}
+
+const withServerBinding = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: MigratingServer });
+
+describe("native connection migration", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    MigratingServer.last = undefined;
+  });
+
+  it("detaches a connection and reports it closed as migrated", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0 },
+      "lws",
+    );
+    const closed = vi.fn();
+    server.on("clientClosed", closed);
+    MigratingServer.last!.emit("connection", {
+      id: "conn-1",
+      remoteAddress: "127.0.0.1",
+      remotePort: 5000,
+    });
+
+    await expect(server.detachConnection("conn-1")).resolves.toEqual({
+      id: "conn-1",
+      fd: 77,
+      state,
+    });
+    expect(closed).toHaveBeenCalledOnce();
+    expect(closed.mock.calls[0][0]).toMatchObject({
+      hadError: false,
+      migrated: true,
+    });
+    expect(server.getConnection("conn-1")).toBeUndefined();
+
+    await expect(server.detachConnection("conn-2")).resolves.toBeUndefined();
+    expect(closed).toHaveBeenCalledOnce();
+  });
+
+  it("resumes from a raw handle and closes it", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0 },
+      "lws",
+    );
+    const handle = { fd: 9, close: vi.fn() };
+
+    expect(server.adoptSocket(handle, state)).toBe(true);
+    expect(MigratingServer.last!.adoptSocket).toHaveBeenCalledWith(9, state);
+    expect(handle.close).toHaveBeenCalledOnce();
+  });
+
+  it("needs the lws backend", async () => {
+    withServerBinding("qwormhole");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0 },
+      "libsocket",
+    );
+    delete (MigratingServer.last as { detachConnection?: unknown })
+      .detachConnection;
+    await expect(server.detachConnection("conn-1")).rejects.toThrow(
+      /lws server backend/,
+    );
+  });
+});
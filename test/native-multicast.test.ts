@@ -0,0 +1,102 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+type Emit = (event: string, payload?: unknown) => boolean;
+
+class FakeMulticast {
+  static last: FakeMulticast | undefined;
+  emit?: Emit;
+  sent: Buffer[] = [];
+  closed = false;
+
+  constructor(public readonly opts: Record<string, unknown>) {
+    FakeMulticast.last = this;
+  }
+
+  async start() {
+    return { group: "239.255.67.72", port: 43222, family: "IPv4", sourceId: 7 };
+  }
+
+  send(data: Buffer) {
+    this.sent.push(data);
+    return this.sent.length - 1;
+  }
+
+  getStats() {
+    return { framesSent: this.sent.length };
+  }
+
+  close() {
+    this.closed = true;
+  }
+}
+
+const withMulticast = (multicast: boolean) =>
+  withBinding(bindingFactory, "qwormhole", {
+    TcpClientWrapper: FakeTcpClientWrapper,
+    ...(multicast ? { QWormholeMulticast: FakeMulticast } : {}),
+  });
+
+describe("native multicast channel", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeMulticast.last = undefined;
+  });
+
+  it("sends frames and routes ordered batches and losses", async () => {
+    withMulticast(true);
+    const { createMulticastChannel, isNativeMulticastAvailable } = await import(
+      "../src/transports/udp/multicast-channel.js"
+    );
+    expect(isNativeMulticastAvailable()).toBe(true);
+    const channel = createMulticastChannel({ port: 43222, windowFrames: 512 });
+    const native = FakeMulticast.last!;
+    expect(native.opts).toEqual({ port: 43222, windowFrames: 512 });
+    await expect(channel.start()).resolves.toMatchObject({ sourceId: 7 });
+
+    expect(channel.send("tick")).toBe(0);
+    expect(channel.send(Buffer.from("tock"))).toBe(1);
+    expect(native.sent.map(data => data.toString())).toEqual(["tick", "tock"]);
+
+    const messages: Array<[string, number]> = [];
+    const losses: unknown[] = [];
+    let batches = 0;
+    channel.on("message", (data: Buffer, info: { seq: number }) =>
+      messages.push([data.toString(), info.seq]),
+    );
+    channel.on("messages", () => (batches += 1));
+    channel.on("loss", loss => losses.push(loss));
+    const from = { source: 9, address: "10.0.0.9", port: 40000 };
+    native.emit!("messages", [
+      { ...from, seq: 4, data: Buffer.from("a") },
+      { ...from, seq: 5, data: Buffer.from("b") },
+    ]);
+    native.emit!("loss", { ...from, from: 6, count: 3 });
+    expect(messages).toEqual([
+      ["a", 4],
+      ["b", 5],
+    ]);
+    expect(batches).toBe(1);
+    expect(losses).toEqual([{ ...from, from: 6, count: 3 }]);
+
+    channel.close();
+    expect(native.closed).toBe(true);
+    expect(channel.send("late")).toBe(false);
+  });
+
+  it("throws without the libsocket addon's channel", async () => {
+    withMulticast(false);
+    const { NativeMulticastChannel, isNativeMulticastAvailable } = await import(
+      "../src/transports/udp/multicast-channel.js"
+    );
+    expect(isNativeMulticastAvailable()).toBe(false);
+    expect(() => new NativeMulticastChannel()).toThrow(/libsocket backend/);
+  });
+});
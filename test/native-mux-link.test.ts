@@ -0,0 +1,143 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class MuxLinkClient extends FakeTcpClientWrapper<Record<string, unknown>> {
+  static instances: MuxLinkClient[] = [];
+  nextStream = 1;
+  muxOpen = vi.fn(() => {
+    const id = this.nextStream;
+    this.nextStream += 2;
+    return id;
+  });
+  muxWrite = vi.fn((_streamId: number, _data: Buffer) => true);
+  muxClose = vi.fn(() => true);
+
+  constructor() {
+    super();
+    MuxLinkClient.instances.push(this);
+  }
+}
+
+class MuxLinkServer extends FakeServerWrapper {
+  static last: MuxLinkServer | undefined;
+  muxWrite = vi.fn(() => true);
+  muxClose = vi.fn(() => true);
+
+  broadcast() {}
+}
+
+const frame = (payload: string) => {
+  const body = Buffer.from(payload);
+  const header = Buffer.alloc(4);
+  header.writeUInt32BE(body.length, 0);
+  return Buffer.concat([header, body]);
+};
+
+describe("native mux link", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    MuxLinkClient.instances = [];
+    MuxLinkServer.last = undefined;
+    withBinding(bindingFactory, "qwormhole_lws", {
+      TcpClientWrapper: MuxLinkClient,
+      QWormholeServerWrapper: MuxLinkServer,
+    });
+  });
+
+  it("carries many sockets as streams of one connection", async () => {
+    const { NativeMuxLink } = await import("../src/core/native-mux-link.js");
+    const link = new NativeMuxLink({ host: "127.0.0.1", port: 9000, mux: { window: 65536 } });
+    const a = link.socketFactory({ host: "ignored", port: 1 });
+    const b = link.socketFactory({ host: "ignored", port: 1 });
+    const connecting = Promise.all([
+      (a as unknown as { connect(): Promise<void> }).connect(),
+      (b as unknown as { connect(): Promise<void> }).connect(),
+    ]);
+
+    expect(MuxLinkClient.instances).toHaveLength(1);
+    const native = MuxLinkClient.instances[0]!;
+    expect(native.connect).toHaveBeenCalledTimes(1);
+    expect(native.connect).toHaveBeenCalledWith(
+      expect.objectContaining({ host: "127.0.0.1", port: 9000, mux: { window: 65536 } }),
+    );
+    native.handler!({ type: "connect" });
+    await connecting;
+    expect(link.streamCount).toBe(2);
+
+    const received: Record<string, Buffer[]> = { a: [], b: [] };
+    a.on("data", data => received.a.push(data));
+    b.on("data", data => received.b.push(data));
+    a.write(Buffer.from("to-a"));
+    expect(native.muxWrite).toHaveBeenCalledWith(1, Buffer.from("to-a"));
+
+    native.handler!({
+      type: "mux",
+      streams: [
+        { streamId: 3, data: Buffer.from("for-b") },
+        { streamId: 1, data: Buffer.from("for-a") },
+      ],
+    });
+    expect(received).toEqual({ a: [Buffer.from("for-a")], b: [Buffer.from("for-b")] });
+
+    native.muxWrite.mockReturnValueOnce(false);
+    expect(b.write(Buffer.from("held"))).toBe(false);
+    const drained = vi.fn();
+    b.on("drain", drained);
+    native.handler!({ type: "mux", resumed: [3] });
+    expect(drained).toHaveBeenCalledTimes(1);
+
+    const closedA = vi.fn();
+    a.on("close", closedA);
+    a.end();
+    expect(native.muxClose).toHaveBeenCalledWith(1, false);
+    expect(closedA).toHaveBeenCalledWith(false);
+
+    const closedB = vi.fn();
+    b.on("close", closedB);
+    native.handler!({ type: "close", hadError: true });
+    expect(closedB).toHaveBeenCalledWith(true);
+    expect(link.streamCount).toBe(0);
+
+    // The next socket reconnects.
+    void (link.socket() as unknown as { connect(): Promise<void> }).connect();
+    expect(MuxLinkClient.instances).toHaveLength(2);
+    link.close();
+  });
+
+  it("splits each server stream into its client's frames", async () => {
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    const { attachMuxLinkServer } = await import("../src/core/native-mux-link.js");
+    const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0, mux: true }, "lws");
+    const native = MuxLinkServer.last!;
+    const messages: Array<{ streamId: number; data: string }> = [];
+    attachMuxLinkServer(server, message => {
+      messages.push({ streamId: message.streamId, data: message.data.toString() });
+      message.reply(Buffer.from(`ack:${message.data}`));
+    });
+
+    native.emit("connection", { id: "c1", remoteAddress: "127.0.0.1", remotePort: 5000 });
+    const hello = frame("hello");
+    native.emit("mux", {
+      client: { id: "c1" },
+      opened: [1, 3],
+      streams: [
+        { streamId: 1, data: hello.subarray(0, 3) },
+        { streamId: 3, data: frame("other") },
+      ],
+    });
+    native.emit("mux", { client: { id: "c1" }, streams: [{ streamId: 1, data: hello.subarray(3) }] });
+
+    expect(messages).toEqual([
+      { streamId: 3, data: "other" },
+      { streamId: 1, data: "hello" },
+    ]);
+    expect(native.muxWrite).toHaveBeenCalledWith("c1", 1, frame("ack:hello"));
+  });
+});
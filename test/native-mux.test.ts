@@ -0,0 +1,141 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+import { MuxFramer } from "../src/transports/mux/mux-framer";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+describe("mux framer", () => {
+  it("keeps the wire layout the native demuxer decodes", () => {
+    const framer = new MuxFramer();
+    const hex = (frame: Parameters<MuxFramer["encode"]>[0]) =>
+      Buffer.from(framer.encode(frame)).toString("hex");
+
+    expect(hex({ type: "open", streamId: 1 })).toBe("000100");
+    expect(
+      hex({ type: "data", streamId: 300, payload: Uint8Array.of(1, 2, 3) }),
+    ).toBe("01ac0203010203");
+    expect(hex({ type: "window", streamId: 5, window: 70000 })).toBe(
+      "0405f0a204",
+    );
+    expect(hex({ type: "reset", streamId: 2 })).toBe("030200");
+  });
+
+  it("round-trips frames through decode", () => {
+    const framer = new MuxFramer();
+    const payload = new Uint8Array(200).fill(7);
+    const bytes = Buffer.concat([
+      framer.encode({ type: "data", streamId: 9, payload }),
+      framer.encode({ type: "window", streamId: 9, window: 4096 }),
+    ]);
+    const frames = framer.decode(bytes);
+    expect(frames).toHaveLength(2);
+    expect(frames[0]).toMatchObject({ type: "data", streamId: 9 });
+    expect(Buffer.from(frames[0].payload!)).toEqual(Buffer.from(payload));
+    expect(frames[1]).toEqual({ type: "window", streamId: 9, window: 4096 });
+  });
+});
+
+class MuxServer extends FakeServerWrapper {
+  static last: MuxServer | undefined;
+  muxWrite = vi.fn(() => true);
+  muxOpen = vi.fn(() => 2);
+  muxClose = vi.fn(() => true);
+
+  broadcast() {}
+}
+
+describe("native server mux", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    MuxServer.last = undefined;
+    withBinding(bindingFactory, "qwormhole_lws", { QWormholeServerWrapper: MuxServer });
+  });
+
+  it("routes mux events to the managed connection", async () => {
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, mux: { window: 65536 } },
+      "lws",
+    );
+    const native = MuxServer.last!;
+    expect(native.options.mux).toEqual({ window: 65536 });
+
+    const events: Array<Record<string, unknown>> = [];
+    server.on("mux", event => events.push(event as never));
+    const snapshot = {
+      id: "conn-1",
+      handle: 1,
+      remoteAddress: "127.0.0.1",
+      remotePort: 4000,
+    };
+    native.emit("connection", snapshot);
+    native.emit("mux", {
+      client: snapshot,
+      opened: [1],
+      streams: [{ streamId: 1, data: Buffer.from("hi") }],
+    });
+
+    expect(events).toHaveLength(1);
+    expect(events[0].opened).toEqual([1]);
+    expect((events[0].client as { id: string }).id).toBe("conn-1");
+
+    expect(server.muxOpen(1)).toBe(2);
+    expect(server.muxWrite(1, 2, Buffer.from("yo"))).toBe(true);
+    expect(native.muxWrite).toHaveBeenCalledWith(1, 2, Buffer.from("yo"));
+    server.muxClose(1, 2, true);
+    expect(native.muxClose).toHaveBeenCalledWith(1, 2, true);
+  });
+
+  it("reports stalled writes and passes resumed streams through", async () => {
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, mux: { window: 4096, grant: "release" } },
+      "lws",
+    );
+    const native = MuxServer.last!;
+    expect(native.options.mux).toEqual({ window: 4096, grant: "release" });
+
+    const events: Array<Record<string, unknown>> = [];
+    server.on("mux", event => events.push(event as never));
+    const snapshot = { id: "conn-3", remoteAddress: "127.0.0.1", remotePort: 2 };
+    native.emit("connection", snapshot);
+
+    native.muxWrite.mockReturnValueOnce(false);
+    expect(server.muxWrite("conn-3", 2, Buffer.alloc(8192))).toBe(false);
+    native.emit("mux", { client: snapshot, resumed: [2] });
+    expect(events[0].resumed).toEqual([2]);
+  });
+
+  it("holds mux events until verifyHandshake accepts", async () => {
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    let accept!: (ok: boolean) => void;
+    const server = new NativeQWormholeServer(
+      {
+        host: "127.0.0.1",
+        port: 0,
+        mux: true,
+        verifyHandshake: () => new Promise<boolean>(r => (accept = r)),
+      },
+      "lws",
+    );
+    const native = MuxServer.last!;
+    const events: unknown[] = [];
+    server.on("mux", event => events.push(event));
+
+    const snapshot = { id: "conn-2", remoteAddress: "::1", remotePort: 1 };
+    native.emit("connection", snapshot);
+    native.emit("mux", { client: snapshot, closed: [{ streamId: 3, reset: false }] });
+    expect(events).toHaveLength(0);
+
+    accept(true);
+    await vi.waitFor(() => expect(events).toHaveLength(1));
+  });
+});
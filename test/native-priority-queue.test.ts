@@ -0,0 +1,112 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class FakeScheduler {
+  static last: FakeScheduler | undefined;
+  items: Array<{ data: Buffer; priority: number }> = [];
+  gated = false;
+  resetStats = vi.fn();
+
+  constructor(public readonly options: Record<string, unknown>) {
+    FakeScheduler.last = this;
+  }
+
+  enqueue(data: Buffer, priority = 0) {
+    const at = this.items.findIndex(item => item.priority > priority);
+    this.items.splice(at < 0 ? this.items.length : at, 0, { data, priority });
+  }
+
+  dequeue() {
+    return this.gated ? undefined : this.items.shift()?.data;
+  }
+
+  dequeueMany(maxItems: number) {
+    if (this.gated) return [];
+    return this.items.splice(0, maxItems).map(item => item.data);
+  }
+
+  waitMs() {
+    return this.gated ? 12 : 0;
+  }
+
+  length() {
+    return this.items.length;
+  }
+
+  getStats() {
+    return {
+      length: this.items.length,
+      maxLength: 3,
+      totalEnqueued: 3,
+      totalDequeued: 0,
+      bytes: 9,
+      maxBytes: 9,
+      bytesEnqueued: 9,
+      bytesDequeued: 0,
+      rateWaits: 1,
+    };
+  }
+
+  clear() {
+    this.items = [];
+  }
+}
+
+const withScheduler = (scheduler?: typeof FakeScheduler) =>
+  withBinding(bindingFactory, "qwormhole_lws", {
+    TcpClientWrapper: class {},
+    PriorityScheduler: scheduler,
+  });
+
+describe("native priority queue", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeScheduler.last = undefined;
+  });
+
+  it("keeps PriorityQueue ordering and stats over the native lanes", async () => {
+    withScheduler(FakeScheduler);
+    const { createNativePriorityQueue } = await import("../src/core/qos.js");
+    const queue = createNativePriorityQueue({
+      rateBytesPerSec: 1000,
+      overheadBytes: 4,
+    })!;
+    expect(FakeScheduler.last!.options).toEqual({
+      rateBytesPerSec: 1000,
+      overheadBytes: 4,
+    });
+
+    queue.enqueue(Buffer.from("low"), 5);
+    queue.enqueue("hi!" as never, -1);
+    queue.enqueue(Buffer.from("mid"));
+    expect(queue.length).toBe(3);
+    expect(queue.dequeueMany(2).map(b => b.toString())).toEqual(["hi!", "mid"]);
+
+    const stats = queue.snapshot({ reset: true });
+    expect(stats).not.toHaveProperty("rateWaits");
+    expect(stats.totalEnqueued).toBe(3);
+    expect(FakeScheduler.last!.resetStats).toHaveBeenCalledOnce();
+  });
+
+  it("reports the rate wait and falls back without the addon", async () => {
+    withScheduler(FakeScheduler);
+    const { createNativePriorityQueue } = await import("../src/core/qos.js");
+    const queue = createNativePriorityQueue()!;
+    queue.enqueue(Buffer.from("x"));
+    FakeScheduler.last!.gated = true;
+    expect(queue.dequeueMany(8)).toEqual([]);
+    expect(queue.waitMs()).toBe(12);
+
+    vi.resetModules();
+    withScheduler(undefined);
+    const qos = await import("../src/core/qos.js");
+    expect(qos.createNativePriorityQueue()).toBeNull();
+  });
+});
@@ -0,0 +1,62 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+type NativeEvent = { type: string; attempt?: number; endpoint?: number };
+
+class ReconnectClient extends FakeTcpClientWrapper<NativeEvent> {
+  static last: ReconnectClient | undefined;
+
+  rpcRequest() {
+    return 1;
+  }
+}
+
+const withReconnect = (name: string) =>
+  withBinding(bindingFactory, name, { TcpClientWrapper: ReconnectClient });
+
+const reconnect = {
+  initialDelayMs: 50,
+  maxDelayMs: 2000,
+  endpoints: [{ host: "10.0.0.2", port: 9001 }],
+  hedgeDelayMs: 250,
+  standby: true,
+};
+
+describe("native reconnect", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    ReconnectClient.last = undefined;
+  });
+
+  it("forwards reconnect to the lws client and fails rpcs across a redial", async () => {
+    withReconnect("qwormhole_lws");
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient.js");
+    const client = new NativeTcpClient("lws");
+    client.connect({ host: "127.0.0.1", port: 9000, framing: "length-prefixed", reconnect });
+    const native = ReconnectClient.last!;
+    expect(native.connect).toHaveBeenCalledWith(expect.objectContaining({ reconnect }));
+
+    const events: NativeEvent[] = [];
+    client.setEventHandler(evt => events.push(evt));
+    const pending = client.rpcRequest(Buffer.from("a"));
+    native.handler!({ type: "reconnecting", attempt: 1, endpoint: 1 });
+    await expect(pending).rejects.toThrow(/dropped/);
+    expect(events).toEqual([{ type: "reconnecting", attempt: 1, endpoint: 1 }]);
+  });
+
+  it("refuses reconnect on libsocket", async () => {
+    withReconnect("qwormhole");
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient.js");
+    const client = new NativeTcpClient("libsocket");
+    expect(() => client.connect({ host: "127.0.0.1", port: 9000, reconnect: true })).toThrow(
+      /reconnect/,
+    );
+  });
+});
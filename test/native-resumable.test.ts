@@ -0,0 +1,79 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+describe("native resumable sessions", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeServerWrapper.last = undefined;
+    FakeTcpClientWrapper.last = undefined;
+  });
+
+  it("routes resumable events to the managed connection", async () => {
+    withBinding(bindingFactory, "qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      {
+        host: "127.0.0.1",
+        port: 0,
+        framing: "length-prefixed",
+        sequence: true,
+        resumable: { bufferBytes: 1 << 20, ttlMs: 5000 },
+      },
+      "lws",
+    );
+    const native = FakeServerWrapper.last!;
+    expect(native.options.resumable).toEqual({ bufferBytes: 1 << 20, ttlMs: 5000 });
+
+    const events: Array<Record<string, unknown>> = [];
+    server.on("resumable", event => events.push(event as never));
+    const snapshot = { id: "conn-1", handle: 1, remoteAddress: "127.0.0.1", remotePort: 4000 };
+    native.emit("connection", snapshot);
+    native.emit("resumable", {
+      client: snapshot,
+      session: "00112233445566778899aabbccddeeff",
+      resumed: true,
+      replayedFrames: 3,
+    });
+    native.emit("resumable", { client: { id: "gone" }, session: "", resumed: false, replayedFrames: 0 });
+
+    expect(events).toHaveLength(1);
+    expect((events[0].client as { id: string }).id).toBe("conn-1");
+    expect(events[0]).toMatchObject({ resumed: true, replayedFrames: 3 });
+  });
+
+  it("forwards resumable to the lws client and refuses it on libsocket", async () => {
+    withBinding(bindingFactory, "qwormhole_lws");
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient.js");
+    const client = new NativeTcpClient("lws");
+    client.connect({
+      host: "127.0.0.1",
+      port: 9000,
+      framing: "length-prefixed",
+      sequence: true,
+      resumable: { ackEvery: 16 },
+    });
+    expect(FakeTcpClientWrapper.last!.connect).toHaveBeenCalledWith(
+      expect.objectContaining({ sequence: true, resumable: { ackEvery: 16 } }),
+    );
+
+    vi.resetModules();
+    withBinding(bindingFactory, "qwormhole");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    expect(
+      () =>
+        new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, resumable: true },
+          "libsocket",
+        ),
+    ).toThrow(/resumable/);
+  });
+});
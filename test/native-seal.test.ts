@@ -0,0 +1,95 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class SealServer extends FakeServerWrapper {
+  static last: SealServer | undefined;
+  setSessionKey = vi.fn(() => true);
+  rekey = vi.fn(() => true);
+
+  broadcast() {}
+}
+
+const withServerBinding = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: SealServer });
+
+describe("native server seal", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    SealServer.last = undefined;
+  });
+
+  it("passes seal options through to the lws wrapper", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    new NativeQWormholeServer(
+      {
+        host: "127.0.0.1",
+        port: 0,
+        framing: "length-prefixed",
+        seal: { cipher: "aes-256-gcm" },
+      },
+      "lws",
+    );
+    expect(SealServer.last!.options.seal).toEqual({
+      cipher: "aes-256-gcm",
+    });
+  });
+
+  it("installs Base64 session keys as raw bytes", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, framing: "length-prefixed", seal: true },
+      "lws",
+    );
+    const key = Buffer.alloc(32, 7);
+    expect(server.setSessionKey("conn-1", key.toString("base64"))).toBe(true);
+
+    const [id, installed] = SealServer.last!.setSessionKey.mock
+      .calls[0] as unknown as [string, Buffer];
+    expect(id).toBe("conn-1");
+    expect(Buffer.isBuffer(installed)).toBe(true);
+    expect(installed.equals(key)).toBe(true);
+  });
+
+  it("forwards rekey requests per connection", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      {
+        host: "127.0.0.1",
+        port: 0,
+        framing: "length-prefixed",
+        seal: { rekeyAfterFrames: 1 << 20 },
+      },
+      "lws",
+    );
+    const native = SealServer.last!;
+    expect(native.options.seal).toEqual({ rekeyAfterFrames: 1 << 20 });
+    expect(server.rekey("conn-1")).toBe(true);
+    expect(native.rekey).toHaveBeenCalledWith("conn-1");
+  });
+
+  it("rejects seal on the libsocket backend", async () => {
+    withServerBinding("qwormhole");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    expect(
+      () =>
+        new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, framing: "length-prefixed", seal: true },
+          "libsocket",
+        ),
+    ).toThrow(/seal/);
+  });
+});
@@ -0,0 +1,59 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class SequenceServer extends FakeServerWrapper {
+  static last: SequenceServer | undefined;
+
+  broadcast() {}
+}
+
+const withServerBinding = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: SequenceServer });
+
+describe("native server sequence numbers", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    SequenceServer.last = undefined;
+  });
+
+  it("passes the replay window through to the lws wrapper", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    new NativeQWormholeServer(
+      {
+        host: "127.0.0.1",
+        port: 0,
+        framing: "length-prefixed",
+        sequence: { window: 4096 },
+      },
+      "lws",
+    );
+    expect(SequenceServer.last!.options.sequence).toEqual({ window: 4096 });
+  });
+
+  it("rejects sequence numbers on the libsocket backend", async () => {
+    withServerBinding("qwormhole");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    expect(
+      () =>
+        new NativeQWormholeServer(
+          {
+            host: "127.0.0.1",
+            port: 0,
+            framing: "length-prefixed",
+            sequence: true,
+          },
+          "libsocket",
+        ),
+    ).toThrow(/sequence/);
+  });
+});
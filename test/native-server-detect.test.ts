@@ -35,6 +35,51 @@ describe("native server detection", () => {
     );
   });
 
+  it("loads each addon once for client and server", async () => {
+    bindingFactory.mockImplementation(
+      (arg: string | { module_root: string; bindings: string }) => {
+        const bindingName = typeof arg === "string" ? arg : arg.bindings;
+        if (bindingName === "qwormhole_lws") {
+          return { QWormholeServerWrapper: vi.fn(), TcpClientWrapper: vi.fn() };
+        }
+        throw new Error("not found");
+      },
+    );
+
+    const { isNativeServerAvailable } = await import("../src/core/native-server.js");
+    const { isNativeAvailable } = await import("../src/core/NativeTCPClient.js");
+
+    expect(isNativeServerAvailable()).toBe(true);
+    expect(isNativeAvailable()).toBe(true);
+    expect(isNativeServerAvailable("libsocket")).toBe(true);
+    const loads = bindingFactory.mock.calls.map(([arg]) =>
+      typeof arg === "string" ? arg : arg.bindings,
+    );
+    expect(loads.filter(name => name === "qwormhole_lws")).toHaveLength(1);
+    expect(loads.filter(name => name === "qwormhole")).toHaveLength(1);
+  });
+
+  it("takes both backends from the combined addon when it is built", async () => {
+    const lws = { QWormholeServerWrapper: vi.fn(), TcpClientWrapper: vi.fn() };
+    const libsocket = { QWormholeServerWrapper: vi.fn(), TcpClientWrapper: vi.fn() };
+    bindingFactory.mockImplementation(
+      (arg: string | { module_root: string; bindings: string }) => {
+        const bindingName = typeof arg === "string" ? arg : arg.bindings;
+        if (bindingName === "qwormhole_native") {
+          return { lws, libsocket, backends: ["lws", "libsocket"] };
+        }
+        throw new Error("not found");
+      },
+    );
+
+    const { getNativeServerBackend } = await import("../src/core/native-server.js");
+    const { getNativeBackend } = await import("../src/core/NativeTCPClient.js");
+
+    expect(getNativeServerBackend("libsocket")).toBe("libsocket");
+    expect(getNativeBackend()).toBe("lws");
+    expect(bindingFactory).toHaveBeenCalledTimes(1);
+  });
+
   it("returns false when bindings are missing", async () => {
     bindingFactory.mockImplementation(() => {
       const err = new Error("missing");
@@ -75,4 +120,29 @@ describe("native server detection", () => {
       delete process.env.QWORMHOLE_NATIVE_SERVER_PREFERRED;
     }
   });
+
+  it("rejects lws-only options on the libsocket server backend", async () => {
+    const wrapper = vi.fn();
+    bindingFactory.mockImplementation(
+      (arg: string | { module_root: string; bindings: string }) => {
+        const bindingName = typeof arg === "string" ? arg : arg.bindings;
+        if (bindingName === "qwormhole") {
+          return { QWormholeServerWrapper: wrapper };
+        }
+        throw new Error("not found");
+      },
+    );
+
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+
+    expect(
+      () =>
+        new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, tls: { enabled: true } },
+          "libsocket",
+        ),
+    ).toThrow(/libsocket server backend/);
+    expect(wrapper).not.toHaveBeenCalled();
+  });
 });
@@ -1,6 +1,95 @@
 import { describe, expect, it, beforeAll, afterAll, vi } from "vitest";
-import { QWormholeClient, textDeserializer } from "../src";
-import { NativeQWormholeServer, isNativeServerAvailable } from "../src/core/native-server";
+import { generateKeyPairSync } from "node:crypto";
+import dgram from "node:dgram";
+import { EventEmitter } from "node:events";
+import fs from "node:fs";
+import http2 from "node:http2";
+import net from "node:net";
+import os from "node:os";
+import path from "node:path";
+import { Worker } from "node:worker_threads";
+import {
+  QWormholeClient,
+  attachGatewayRpcServer,
+  buildEntropyPolicyTable,
+  createNegentropicHandshake,
+  createCborDeserializer,
+  createCborSerializer,
+  textDeserializer,
+  verifyHandshakeAck,
+  verifyNegentropicHandshake,
+} from "../src";
+import {
+  ConnectionBundle,
+  ConnectionBundleAcceptor,
+  type BundleConnection,
+} from "../src/core/connection-bundle";
+import { cosineSimilarity } from "../src/coherence/invariants";
+import {
+  NATIVE_MATRIX_MIN_ROWS,
+  normalizeRowsNative,
+} from "../src/coherence/native-math";
+import { normalizeTopologyRows } from "../src/coherence/nbo";
+import {
+  generateSuperformulaPoints,
+  generateSuperformulaRadii,
+} from "../src/coherence/superformula";
+import { BatchFramer } from "../src/core/batch-framer";
+import { LengthPrefixedFramer } from "../src/core/framing";
+import { NativeMuxLink, attachMuxLinkServer } from "../src/core/native-mux-link";
+import { createNativePriorityQueue } from "../src/core/qos";
+import { DiscoveryModule } from "../src/node/discovery";
+import {
+  NativeQWormholeServer,
+  NativeConnectionFlag,
+  NativeSendStatus,
+  NativeTelemetryKind,
+  createNativeBroadcastRing,
+  createNativeConnectionDirectory,
+  drainNativeTransportTelemetry,
+  isNativeServerAvailable,
+  readPathSnapshot,
+  snapshotRemoteAddress,
+} from "../src/core/native-server";
+import {
+  NativeTcpClient,
+  createHandshakeSigner,
+  createNativeFrameSplitter,
+  getNativeDiscovery,
+  getNativeBufferPoolStats,
+  getNativeHandshakeValidator,
+  getNativeIdService,
+  getNativeServiceProfile,
+  getNativeServiceProfileFolded,
+  setNativeServiceProfiling,
+} from "../src/core/NativeTCPClient";
+import {
+  createSecureStreams,
+  isNativeSecureStreamsAvailable,
+} from "../src/core/secure-streams";
+import { attachBinaryRpcServer, attachNativeRpcClient } from "../src/http/rpc";
+import { LatencyHistogram } from "../src/telemetry/latency-histogram";
+import {
+  TelemetryTraceRecorder,
+  openTelemetryTrace,
+} from "../src/telemetry/trace-recorder";
+import { startTransportCoherencePipeline } from "../src/core/transport-coherence-pipeline";
+import { NativeKcpServer, isNativeKcpAvailable } from "../src/transports/kcp/kcp-native";
+import type { MuxStream } from "../src/transports/mux/mux-stream";
+import {
+  NativeUnixDatagramSocket,
+  isNativeUnixDgramAvailable,
+} from "../src/transports/udp/unix-dgram";
+import {
+  NativeDatagramSocket,
+  isNativeUdpAvailable,
+} from "../src/transports/udp/native-udp";
+import {
+  createMulticastChannel,
+  isNativeMulticastAvailable,
+} from "../src/transports/udp/multicast-channel";
+import type { NativeSocketOptions } from "../src/types/types";
+import { WIDE_ID_BYTES, fillIds, nextId, setIdNode } from "../src/utils/ids";
 /**
  * Native server smoke test - validates that the native server wrapper works
  * when the native addon is available. This test is skipped if native is not built.
@@ -27,6 +116,45 @@ const waitForEvent = <T>(
   });
 };
 
+type NativeClientEvent = Parameters<Parameters<NativeTcpClient["setEventHandler"]>[0]>[0];
+
+// An lws NativeTcpClient with events delivered to JS: every event is kept,
+// next(type) waits for the following one of a type, connect() for "connect".
+// close() releases the handler, so each connect() installs it again.
+const lwsClient = (options: NativeSocketOptions) => {
+  const client = new NativeTcpClient("lws");
+  const events: NativeClientEvent[] = [];
+  const waiters: Array<{ type: string; resolve: (evt: NativeClientEvent) => void }> = [];
+  const record = (evt: NativeClientEvent) => {
+    events.push(evt);
+    for (const waiter of waiters.filter(w => w.type === evt.type)) {
+      waiters.splice(waiters.indexOf(waiter), 1);
+      waiter.resolve(evt);
+    }
+  };
+  const next = (type: string, timeoutMs = TEST_WAIT_MS * 5) =>
+    new Promise<NativeClientEvent>((resolve, reject) => {
+      const timer = setTimeout(
+        () => reject(new Error(`Timeout waiting for native "${type}" event`)),
+        timeoutMs,
+      );
+      waiters.push({
+        type,
+        resolve: evt => {
+          clearTimeout(timer);
+          resolve(evt);
+        },
+      });
+    });
+  const connect = async () => {
+    const connected = next("connect");
+    client.setEventHandler(record);
+    client.connect({ delivery: "events", ...options });
+    await connected;
+  };
+  return { client, events, next, connect };
+};
+
 describe("Native Server Smoke Test", async () => {
   const nativeAvailable = isNativeServerAvailable();
   describe.skipIf(!nativeAvailable)("with native server", () => {
@@ -104,6 +232,64 @@ describe("Native Server Smoke Test", async () => {
       expect(messageReceived).toHaveBeenCalled();
     });
 
+    it("reports write coalescing stats", () => {
+      if (!server) throw new Error("Server not initialized");
+
+      const stats = server.getWriteStats();
+      expect(stats).toBeDefined();
+      expect(stats!.writeCalls).toBeGreaterThanOrEqual(1);
+      expect(stats!.framesWritten).toBeGreaterThanOrEqual(stats!.writeCalls);
+    });
+
+    it("counts accepted connections", () => {
+      if (!server) throw new Error("Server not initialized");
+
+      const stats = server.getAcceptStats();
+      expect(stats).toBeDefined();
+      expect(stats!.accepted).toBeGreaterThanOrEqual(1);
+      expect(stats!.batches).toBeGreaterThanOrEqual(1);
+      expect(stats!.maxBatch).toBeGreaterThanOrEqual(1);
+    });
+
+    it("reports transport histograms", () => {
+      if (!server) throw new Error("Server not initialized");
+
+      const stats = server.getStats();
+      expect(stats).toBeDefined();
+      expect(stats!.connections).toBe(server.getConnectionCount());
+      expect(stats!.writablePasses).toBeGreaterThanOrEqual(1);
+      expect(stats!.lwsWrites).toBeGreaterThanOrEqual(1);
+      expect(stats!.rxCallbacks).toBeGreaterThanOrEqual(1);
+      expect(stats!.tsfnPayloads).toBeGreaterThanOrEqual(1);
+      expect(stats!.queuedWriteAllocs).toBeGreaterThanOrEqual(1);
+      expect(stats!.enqueueToWireUs.count).toBeGreaterThanOrEqual(1);
+      expect(stats!.rxToEmitUs.count).toBeGreaterThanOrEqual(1);
+      expect(stats!.enqueueToWireUs.p99).toBeGreaterThanOrEqual(
+        stats!.enqueueToWireUs.p50,
+      );
+    });
+
+    it("stays asleep while idle", async () => {
+      if (!server) throw new Error("Server not initialized");
+
+      server.getServiceStats();
+      await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+      const stats = server.getServiceStats();
+      expect(stats).toBeDefined();
+      // A 1 ms polling loop would report ~1000/s here.
+      expect(stats!.wakeupsPerSec).toBeLessThan(100);
+    });
+
+    it("reports service busy time and the JS delivery queue", () => {
+      if (!server) throw new Error("Server not initialized");
+
+      const stats = server.getServiceStats();
+      expect(stats!.serviceBusyUs!.count).toBeGreaterThanOrEqual(1);
+      expect(stats!.tsfnPending).toBeGreaterThanOrEqual(0);
+      expect(stats!.tsfnPendingPeak).toBeGreaterThanOrEqual(1);
+      expect(stats!.jsLagPauses).toBe(0);
+    });
+
     it("reports correct connection count", () => {
       if (!server) throw new Error("Server not initialized");
 
@@ -127,6 +313,2695 @@ describe("Native Server Smoke Test", async () => {
     });
   });
 
+  describe.skipIf(!nativeAvailable)("with zero-copy receive", () => {
+    it("delivers framed messages sliced from receive slabs", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer: textDeserializer,
+        zeroCopyReceive: true,
+        rxSlabBytes: 4096,
+      });
+      const address = await server.listen();
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      const received: string[] = [];
+      server.on("message", ({ data }) => {
+        received.push(String(data));
+      });
+      try {
+        await client.connect();
+        for (let i = 0; i < 3; i++) {
+          client.send(`slab-${i}`);
+        }
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(received).toEqual(["slab-0", "slab-1", "slab-2"]);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("stops reading a connection past rxBudgetBytes until acked", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer: textDeserializer,
+        rxBudgetBytes: 64,
+        rxBudgetRelease: "ack",
+      });
+      const address = await server.listen();
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      const received: string[] = [];
+      let clientId = "";
+      server.on("message", ({ client: peer, data }) => {
+        clientId = peer.id;
+        received.push(String(data));
+      });
+      const settle = () => new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+      try {
+        await client.connect();
+        for (const payload of ["a".repeat(40), "b".repeat(40), "c".repeat(40)]) {
+          client.send(payload);
+          await settle();
+        }
+        expect(received).toHaveLength(2);
+        const stats = server.getConnectionStats(clientId);
+        expect(stats?.rxPaused).toBe(true);
+        expect(stats?.rxHeldBytes).toBeGreaterThanOrEqual(80);
+
+        expect(server.ack(clientId, 80)).toBe(true);
+        await settle();
+        expect(received).toHaveLength(3);
+        expect(server.pause("conn-unknown")).toBe(false);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("refuses connections past maxConnectionsPerIp at accept", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        maxConnectionsPerIp: 1,
+      });
+      const address = await server.listen();
+      const connections: string[] = [];
+      server.on("connection", peer => connections.push(peer.id));
+      const clients = [0, 1].map(
+        () =>
+          new QWormholeClient({
+            host: "127.0.0.1",
+            port: address.port,
+            reconnect: { enabled: false },
+          }),
+      );
+      try {
+        await clients[0].connect();
+        await clients[1].connect().catch(() => undefined);
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(connections).toHaveLength(1);
+        expect(server.getStats()?.peerLimits).toMatchObject({
+          tracked: 1,
+          connectionCapRejects: 1,
+          acceptRateRejects: 0,
+        });
+      } finally {
+        await Promise.all(clients.map(client => client.disconnect()));
+        await server.close();
+      }
+    });
+
+    it("applies socketOptions at adopt and reports the effective values", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        socketOptions: { noDelay: true, receiveBufferBytes: 256 * 1024 },
+      });
+      const address = await server.listen();
+      const connected = new Promise<string>(resolve =>
+        server.on("connection", peer => resolve(peer.id)),
+      );
+      const client = new QWormholeClient({ host: "127.0.0.1", port: address.port });
+      try {
+        await client.connect();
+        const report = server.getConnectionStats(await connected)?.socketOptions;
+        expect(report?.noDelay).toBe(true);
+        expect(report?.receiveBufferBytes).toBeGreaterThanOrEqual(256 * 1024);
+        expect(report?.rejected).toEqual([]);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it.runIf(process.platform === "linux")(
+      "caps the kernel pacing rate and reports the egress qdisc",
+      async () => {
+        const server = new NativeQWormholeServer({
+          host: "127.0.0.1",
+          port: 0,
+          socketOptions: { pacingRateBytesPerSec: 1_000_000 },
+        });
+        const address = await server.listen();
+        const connected = new Promise<string>(resolve =>
+          server.on("connection", peer => resolve(peer.id)),
+        );
+        const client = new QWormholeClient({ host: "127.0.0.1", port: address.port });
+        try {
+          await client.connect();
+          const report = server.getConnectionStats(await connected)?.socketOptions;
+          expect(report?.pacingRateBytesPerSec).toBe(1_000_000);
+          // Loopback has no queueing discipline to pace with.
+          expect(report?.pacingQdisc).toBe("noqueue");
+          expect(report?.rejected).toEqual([]);
+        } finally {
+          await client.disconnect();
+          await server.close();
+        }
+      },
+    );
+
+    it("delivers everything under lowLatencyWriteBytes scheduling", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        lowLatencyWriteBytes: 16 * 1024,
+      });
+      const address = await server.listen();
+      const connected = new Promise<string>(resolve =>
+        server.on("connection", peer => resolve(peer.id)),
+      );
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      const received: string[] = [];
+      client.on("message", message => received.push(String(message)));
+      try {
+        await client.connect();
+        const id = await connected;
+        const payload = "x".repeat(8 * 1024);
+        for (let i = 0; i < 64; i += 1) server.broadcast(payload);
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS * 4));
+        expect(received).toHaveLength(64);
+        expect(server.getConnectionStats(id)?.socketOptions?.notSentLowatBytes).toBe(16 * 1024);
+        expect(server.getStats()?.lowLatencyWrites?.unsentCapBytes).toBe(16 * 1024);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("streams a file range with sendFile", async () => {
+      const dir = fs.mkdtempSync(path.join(os.tmpdir(), "qw-sendfile-"));
+      const file = path.join(dir, "snapshot.bin");
+      const body = Buffer.alloc(3 * 256 * 1024 + 17, 0);
+      for (let i = 0; i < body.length; i += 1) body[i] = i % 251;
+      fs.writeFileSync(file, body);
+      const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 });
+      const address = await server.listen();
+      const connected = new Promise<string>(resolve =>
+        server.on("connection", peer => resolve(peer.id)),
+      );
+      const client = new QWormholeClient<Buffer>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: (data: Buffer) => data,
+      });
+      const received: Buffer[] = [];
+      client.on("message", message => received.push(Buffer.from(message)));
+      try {
+        await client.connect();
+        const id = await connected;
+        server.broadcast("before");
+        expect(server.sendFile(id, file, 100)).toBe(true);
+        expect(server.sendFile(id, file, 0, 1000, { frameBytes: 400 })).toBe(true);
+        server.broadcast("after");
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS * 4));
+        expect(received).toHaveLength(6);
+        expect(received[1].equals(body.subarray(100))).toBe(true);
+        expect(received.slice(2, 5).map(frame => frame.length)).toEqual([400, 400, 200]);
+        expect(Buffer.concat(received.slice(2, 5)).equals(body.subarray(0, 1000))).toBe(true);
+        expect(() => server.sendFile(id, file, body.length + 1)).toThrow(/offset/);
+      } finally {
+        await client.disconnect();
+        await server.close();
+        fs.rmSync(dir, { recursive: true, force: true });
+      }
+    });
+
+    it("recycles send buffers through the native buffer pools", async () => {
+      const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 });
+      const address = await server.listen();
+      const client = new QWormholeClient<Buffer>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: (data: Buffer) => data,
+      });
+      let received = 0;
+      client.on("message", () => (received += 1));
+      try {
+        await client.connect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        const before = getNativeBufferPoolStats();
+        expect(before).not.toBeNull();
+        const payload = Buffer.alloc(2000, 7);
+        for (let round = 0; round < 4; round += 1) {
+          for (let i = 0; i < 64; i += 1) server.broadcast(payload);
+          await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        }
+        expect(received).toBe(256);
+        const after = getNativeBufferPoolStats()!;
+        expect(after.hits).toBeGreaterThan(before!.hits);
+        expect(after.hitRate).toBeGreaterThan(0);
+        expect(after.cachedBytes).toBeLessThanOrEqual(after.limitBytes * after.pools);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("profiles service-thread callbacks on demand", async () => {
+      const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 });
+      const address = await server.listen();
+      const client = new QWormholeClient<Buffer>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: (data: Buffer) => data,
+      });
+      try {
+        expect(setNativeServiceProfiling(true)).toBe(true);
+        await client.connect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        for (let i = 0; i < 32; i += 1) client.send(Buffer.alloc(64, i));
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        setNativeServiceProfiling(false);
+
+        const profile = getNativeServiceProfile()!;
+        expect(profile.enabled).toBe(false);
+        expect(profile.sites.RAW_ADOPT?.count).toBeGreaterThan(0);
+        expect(profile.sites.RAW_RX?.count).toBeGreaterThan(0);
+        expect(profile.sites.frame_decode?.count).toBeGreaterThan(0);
+        expect(getNativeServiceProfileFolded()).toMatch(/^server;RAW_RX;frame_decode \d+$/m);
+      } finally {
+        setNativeServiceProfiling(false);
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("reports connection memory and compacts idle connections", async () => {
+      const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 });
+      const address = await server.listen();
+      const connected = new Promise<{ id: string; remoteAddress?: string }>(resolve =>
+        server.on("connection", peer => resolve(peer)),
+      );
+      const client = new QWormholeClient<Buffer>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: (data: Buffer) => data,
+      });
+      let received = 0;
+      client.on("message", () => (received += 1));
+      try {
+        await client.connect();
+        const peer = await connected;
+        expect(peer.remoteAddress).toBe("127.0.0.1");
+        server.broadcast(Buffer.alloc(32 * 1024, 1));
+        // Long enough for one quiet trim interval to pass on the service thread.
+        await new Promise(resolve => setTimeout(resolve, 2500));
+        expect(received).toBe(1);
+        const memory = server.getStats()?.connectionMemory;
+        expect(memory?.bytesPerConnection).toBeGreaterThan(0);
+        expect(memory?.idleCompactions).toBeGreaterThan(0);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    }, 10_000);
+
+    it("sends a batch of (id, payload) pairs in one call", async () => {
+      const server = new NativeQWormholeServer<string>({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer: textDeserializer,
+      });
+      const address = await server.listen();
+      const ids: string[] = [];
+      server.on("connection", peer => ids.push(peer.id));
+      const clients = [0, 1].map(
+        () =>
+          new QWormholeClient<string>({
+            host: "127.0.0.1",
+            port: address.port,
+            deserializer: textDeserializer,
+          }),
+      );
+      const received: string[][] = [[], []];
+      clients.forEach((client, index) =>
+        client.on("message", message => received[index].push(String(message))),
+      );
+      try {
+        for (const client of clients) await client.connect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(ids).toHaveLength(2);
+        const statuses = server.sendBatch(
+          [ids[0], ids[1], "conn-unknown", ids[0]],
+          ["a1", "b1", "nobody", "a2"],
+        );
+        expect(Array.from(statuses)).toEqual([
+          NativeSendStatus.Queued,
+          NativeSendStatus.Queued,
+          NativeSendStatus.Unknown,
+          NativeSendStatus.Queued,
+        ]);
+        const packed = Buffer.from("b2a3");
+        server.sendBatch([ids[1], ids[0]], {
+          buffer: packed,
+          offsets: Uint32Array.from([0, 2, 4]),
+        });
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS * 2));
+        expect(received[0]).toEqual(["a1", "a2", "a3"]);
+        expect(received[1]).toEqual(["b1", "b2"]);
+        expect(() => server.sendBatch([ids[0]], ["x", "y"])).toThrow(/one payload per id/);
+      } finally {
+        for (const client of clients) await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("publishes to native topic subscribers", async () => {
+      const server = new NativeQWormholeServer<string>({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer: textDeserializer,
+      });
+      const address = await server.listen();
+      const ids: string[] = [];
+      server.on("connection", peer => ids.push(peer.id));
+      const clients = [0, 1].map(
+        () =>
+          new QWormholeClient<string>({
+            host: "127.0.0.1",
+            port: address.port,
+            deserializer: textDeserializer,
+          }),
+      );
+      const received: string[][] = [[], []];
+      clients.forEach((client, index) =>
+        client.on("message", message => received[index].push(String(message))),
+      );
+      try {
+        for (const client of clients) await client.connect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(server.subscribe(ids[0], "news")).toBe(true);
+        expect(server.subscribe(ids[0], "news")).toBe(false);
+        expect(server.subscribe(ids[1], "news")).toBe(true);
+        expect(server.subscribe(ids[1], "sports")).toBe(true);
+        expect(server.subscribe("conn-unknown", "news")).toBe(false);
+        expect(server.publish("news", Buffer.from("n1"))).toBe(2);
+        expect(server.publish("sports", Buffer.from("s1"))).toBe(1);
+        expect(server.publish("weather", Buffer.from("w1"))).toBe(0);
+        expect(server.unsubscribe(ids[1], "news")).toBe(true);
+        expect(server.publish("news", Buffer.from("n2"))).toBe(1);
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS * 2));
+        expect(received[0]).toEqual(["n1", "n2"]);
+        expect(received[1]).toEqual(["n1", "s1"]);
+        expect(server.getStats()).toMatchObject({ topics: 2, subscriptions: 2 });
+        await clients[1].disconnect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(server.getStats()).toMatchObject({ topics: 1, subscriptions: 1 });
+        expect(server.unsubscribe(ids[0])).toBe(1);
+      } finally {
+        for (const client of clients) await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("conflates queued sends that share a key", async () => {
+      const server = new NativeQWormholeServer<string>({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer: textDeserializer,
+        deferWakeups: true,
+      });
+      const address = await server.listen();
+      const ids: string[] = [];
+      server.on("connection", peer => ids.push(peer.id));
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      const received: string[] = [];
+      client.on("message", message => received.push(String(message)));
+      try {
+        await client.connect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        // Deferred wakeups keep all four queued until the next turn.
+        server.sendTo(ids[0], "price-1", { conflate: "price" });
+        server.sendTo(ids[0], "trade", { conflate: 7 });
+        server.sendTo(ids[0], "price-2", { conflate: "price" });
+        server.sendTo(ids[0], "price-3", { conflate: "price" });
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS * 2));
+        expect(received).toEqual(["price-3", "trade"]);
+        expect(server.getWriteStats()?.framesConflated).toBe(2);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("drops queued frames that outlive their ttlMs", async () => {
+      const server = new NativeQWormholeServer<string>({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer: textDeserializer,
+        deferWakeups: true,
+      });
+      const address = await server.listen();
+      const ids: string[] = [];
+      server.on("connection", peer => ids.push(peer.id));
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      const received: string[] = [];
+      client.on("message", message => received.push(String(message)));
+      try {
+        await client.connect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        // A zero ttl expires before the deferred writable pass comes round.
+        server.sendTo(ids[0], "stale", { ttlMs: 0 });
+        server.broadcast("stale-too", { ttlMs: 0 });
+        server.sendTo(ids[0], "fresh", { ttlMs: 60_000 });
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS * 2));
+        expect(received).toEqual(["fresh"]);
+        expect(server.getConnectionStats(ids[0])?.framesExpired).toBe(2);
+        expect(server.getWriteStats()?.framesExpired).toBe(2);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("folds a burst of deferred sends into one service wakeup", async () => {
+      const server = new NativeQWormholeServer<string>({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer: textDeserializer,
+        deferWakeups: true,
+      });
+      const address = await server.listen();
+      const ids: string[] = [];
+      server.on("connection", peer => ids.push(peer.id));
+      const clients = [0, 1, 2, 3].map(
+        () =>
+          new QWormholeClient<string>({
+            host: "127.0.0.1",
+            port: address.port,
+            deserializer: textDeserializer,
+          }),
+      );
+      const received: string[] = [];
+      clients.forEach(client => client.on("message", message => received.push(String(message))));
+      try {
+        for (const client of clients) await client.connect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(ids).toHaveLength(4);
+        const before = server.getServiceStats()?.wakesCoalesced ?? 0;
+        // One writable per connection to schedule, so four wake requests
+        // and a single setImmediate signal.
+        ids.forEach((id, index) => server.sendTo(id, `m${index}`));
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS * 2));
+        expect(received.sort()).toEqual(["m0", "m1", "m2", "m3"]);
+        expect(server.getServiceStats()?.wakesCoalesced).toBeGreaterThanOrEqual(before + 3);
+      } finally {
+        for (const client of clients) await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("delivers frames through a shared receive ring, in order past overflow", async () => {
+      const server = new NativeQWormholeServer<string>({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer: textDeserializer,
+        receiveRing: { capacityBytes: 1024 },
+      });
+      const address = await server.listen();
+      const received: string[] = [];
+      server.on("message", ({ data }) => received.push(String(data)));
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      try {
+        await client.connect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        const sent: string[] = [];
+        for (let i = 0; i < 200; i += 1) {
+          // Every tenth frame is larger than the whole ring.
+          const message = i % 10 === 9 ? `big${i}:${"x".repeat(2000)}` : `m${i}`;
+          sent.push(message);
+          client.send(message);
+        }
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS * 3));
+        expect(received).toEqual(sent);
+        const ring = server.getStats()?.receiveRing;
+        expect(ring?.records).toBeGreaterThan(0);
+        expect(ring?.overflows).toBeGreaterThan(0);
+        expect(ring?.notifications).toBeLessThanOrEqual(ring?.records ?? 0);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("sends heartbeats and times out idle connections natively", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer: textDeserializer,
+        idleTimeoutMs: 300,
+        heartbeatIntervalMs: 50,
+        heartbeatPayload: Buffer.from("hb"),
+      });
+      const address = await server.listen();
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      const heartbeats: string[] = [];
+      client.on("message", message => heartbeats.push(String(message)));
+      const timedOut = new Promise<string>(resolve =>
+        server.once("timeout", ({ client: peer }) => resolve(peer.id)),
+      );
+      const closed = new Promise<string>(resolve =>
+        server.once("clientClosed", ({ client: peer }) => resolve(peer.id)),
+      );
+      try {
+        await client.connect();
+        const id = await timedOut;
+        expect(await closed).toBe(id);
+        expect(heartbeats.length).toBeGreaterThan(0);
+        expect(heartbeats.every(message => message === "hb")).toBe(true);
+        const stats = server.getStats();
+        expect(stats?.idleTimeouts).toBe(1);
+        expect(stats?.heartbeatsSent).toBeGreaterThan(0);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!nativeAvailable)("with native cbor codec", () => {
+    it("encodes object broadcasts the way the JS cbor serializer does", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        serializer: createCborSerializer(),
+        nativeCodec: "cbor",
+      });
+      const address = await server.listen();
+      const client = new QWormholeClient<unknown>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: createCborDeserializer(),
+      });
+      const received: unknown[] = [];
+      client.on("message", message => {
+        received.push(message);
+      });
+      const payload = {
+        op: "tick",
+        seq: 70000,
+        delta: -1.5,
+        ratio: 0.1,
+        tags: ["a", "b"],
+        nested: { ok: true, none: null },
+      };
+      try {
+        await client.connect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        server.broadcast(payload);
+        // Not covered natively; falls back to the JS serializer.
+        server.broadcast({ at: new Date(0) });
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(received[0]).toEqual(payload);
+        expect(received[1]).toEqual({ at: new Date(0) });
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("decodes inbound envelopes natively and leaves tagged frames to the deserializer", async () => {
+      const deserialize = createCborDeserializer();
+      const deserializer = vi.fn((data: Buffer) => deserialize(data));
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer,
+        nativeCodec: "cbor",
+        nativeDecode: true,
+      });
+      const address = await server.listen();
+      const client = new QWormholeClient<unknown>({
+        host: "127.0.0.1",
+        port: address.port,
+        serializer: createCborSerializer(),
+      });
+      const received: unknown[] = [];
+      server.on("message", ({ data }) => received.push(data));
+      const envelope = {
+        v: 1,
+        kind: "request",
+        id: "r-1",
+        req: { host: "example.test", port: 443, path: "/" },
+        body: Buffer.from("hi"),
+      };
+      try {
+        await client.connect();
+        await client.send(envelope);
+        await client.send({ at: new Date(0) });
+        const deadline = Date.now() + TEST_WAIT_MS * 5;
+        while (received.length < 2 && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        expect(received[0]).toEqual(envelope);
+        expect(received[1]).toEqual({ at: new Date(0) });
+        expect(deserializer).toHaveBeenCalledTimes(1);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("classifies received frames into a native type histogram", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        messageTypes: { window: 4, entropyEvery: 1 },
+      });
+      const address = await server.listen();
+      const connected = new Promise<string>(resolve =>
+        server.on("connection", peer => resolve(peer.id)),
+      );
+      const client = new QWormholeClient<unknown>({ host: "127.0.0.1", port: address.port });
+      let received = 0;
+      server.on("message", () => (received += 1));
+      try {
+        await client.connect();
+        const id = await connected;
+        const payloads = [{ type: "old" }, { type: "ping" }, { type: "ping" }, { event: "join" }, "hi"];
+        for (const payload of payloads) await client.send(payload);
+        const deadline = Date.now() + TEST_WAIT_MS * 5;
+        while (received < 5 && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        const stats = server.getConnectionStats(id)?.messageTypes;
+        expect(stats?.frames).toBe(5);
+        expect(stats?.histogram).toEqual({ ping: 2, "event:join": 1, string: 1 });
+        expect(stats?.entropy).toBeCloseTo(1.5, 10);
+        expect(stats?.entropySamples).toBe(5);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!nativeAvailable)("with priority lanes", () => {
+    it("lets a priority-0 frame overtake queued bulk frames", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+      });
+      const address = await server.listen();
+      const connected = waitForEvent<{
+        send: (payload: unknown, options?: { priority?: number }) => Promise<void>;
+      }>(server, "connection");
+      const client = new QWormholeClient<Buffer>({
+        host: "127.0.0.1",
+        port: address.port,
+      });
+      const received: string[] = [];
+      client.on("message", message => {
+        received.push(message.length === 4 ? message.toString() : "bulk");
+      });
+      try {
+        await client.connect();
+        const conn = await connected;
+        const bulk = Buffer.alloc(256 * 1024, 0x61);
+        for (let i = 0; i < 64; i++) {
+          void conn.send(bulk, { priority: 3 });
+        }
+        void conn.send(Buffer.from("ping"), { priority: 0 });
+        const deadline = Date.now() + TEST_WAIT_MS * 25;
+        while (received.length < 65 && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        expect(received).toHaveLength(65);
+        expect(received.indexOf("ping")).toBeLessThan(64);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!nativeAvailable)("with native rate limiting", () => {
+    it("paces writes to rateLimitBytesPerSec", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        rateLimitBytesPerSec: 100_000,
+        rateLimitBurstBytes: 10_000,
+      });
+      const address = await server.listen();
+      const connected = waitForEvent<{ send: (payload: unknown) => Promise<void> }>(
+        server,
+        "connection",
+      );
+      const client = new QWormholeClient<Buffer>({
+        host: "127.0.0.1",
+        port: address.port,
+      });
+      let received = 0;
+      client.on("message", () => {
+        received += 1;
+      });
+      try {
+        await client.connect();
+        const conn = await connected;
+        const started = Date.now();
+        for (let i = 0; i < 10; i++) {
+          void conn.send(Buffer.alloc(10_000, 0x62));
+        }
+        const deadline = started + 5_000;
+        while (received < 10 && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        expect(received).toBe(10);
+        // ~100 KB at 100 KB/s after a 10 KB burst.
+        expect(Date.now() - started).toBeGreaterThan(600);
+        expect(server.getWriteStats()?.rateLimitedWaits ?? 0).toBeGreaterThan(0);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!nativeAvailable)("with native handshake responder", () => {
+    it("acks handshakes natively with a signed policy", async () => {
+      const { privateKey, publicKey } = generateKeyPairSync("ed25519");
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        protocolVersion: "1.0.0",
+        nativeHandshake: {
+          signingKey: privateKey.export({ format: "der", type: "pkcs8" }),
+        },
+      });
+      const address = await server.listen();
+      const connected = waitForEvent<{ handshake?: { policy?: { mode: string } } }>(
+        server,
+        "connection",
+      );
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        protocolVersion: "1.0.0",
+        deserializer: textDeserializer,
+      });
+      const acked = waitForEvent<string>(client, "message");
+      try {
+        await client.connect();
+        const conn = await connected;
+        const ack = JSON.parse(await acked);
+        expect(ack.type).toBe("handshake-ack");
+        expect(
+          verifyHandshakeAck(ack, {
+            publicKey: publicKey
+              .export({ format: "der", type: "spki" })
+              .toString("base64"),
+          }),
+        ).toBe(true);
+        expect(conn.handshake?.policy?.mode).toBe(ack.policy.mode);
+        expect(server.getStats()?.handshakeAcks).toBe(1);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("refuses handshakes the policy table does not admit", async () => {
+      const { privateKey } = generateKeyPairSync("ed25519");
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        protocolVersion: "1.0.0",
+        nativeHandshake: {
+          signingKey: privateKey.export({ format: "der", type: "pkcs8" }),
+        },
+      });
+      server.on("error", () => {});
+      expect(
+        server.setHandshakePolicy(
+          buildEntropyPolicyTable().map(row => ({ ...row, admit: false })),
+        ),
+      ).toBe(4);
+      const address = await server.listen();
+      const client = new QWormholeClient<Buffer>({
+        host: "127.0.0.1",
+        port: address.port,
+        protocolVersion: "1.0.0",
+      });
+      client.on("error", () => {});
+      try {
+        await client.connect();
+        await waitForEvent(client, "close");
+        // The client may already be reconnecting; each attempt is refused.
+        expect(server.getStats()?.handshakeRejects ?? 0).toBeGreaterThanOrEqual(1);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!nativeAvailable)("with handshake verify workers", () => {
+    it("parks frames behind the handshake and delivers them in order", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        protocolVersion: "1.0.0",
+        handshakeVerifyThreads: 2,
+        deserializer: textDeserializer,
+      });
+      const address = await server.listen();
+      const received: string[] = [];
+      server.on("message", ({ data }) => {
+        received.push(data as string);
+      });
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        protocolVersion: "1.0.0",
+        deserializer: textDeserializer,
+      });
+      try {
+        await client.connect();
+        for (let i = 0; i < 5; i++) void client.send(`m${i}`);
+        const deadline = Date.now() + TEST_WAIT_MS * 10;
+        while (received.length < 5 && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        expect(received).toEqual(["m0", "m1", "m2", "m3", "m4"]);
+        const verify = server.getStats()?.handshakeVerify;
+        expect(verify?.verifyUs.count).toBe(1);
+        expect(verify?.overflows).toBe(0);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!nativeAvailable)("with graceful shutdown", () => {
+    it("flushes queued data and the close hint before closing", async () => {
+      const server = new NativeQWormholeServer({
+        host: "127.0.0.1",
+        port: 0,
+        deserializer: textDeserializer,
+      });
+      const address = await server.listen();
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      const received: string[] = [];
+      client.on("message", message => {
+        received.push(String(message));
+      });
+      try {
+        await client.connect();
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        const closed = waitForEvent<unknown>(server, "close");
+        server.broadcast("last-words");
+        await server.shutdown(TEST_WAIT_MS * 5, { closeHint: "goodbye" });
+        const report = (await closed) as {
+          graceful: boolean;
+          drainedBytes: number;
+          timedOut: boolean;
+        };
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(received).toEqual(["last-words", "goodbye"]);
+        expect(report.graceful).toBe(true);
+        expect(report.timedOut).toBe(false);
+        expect(report.drainedBytes).toBeGreaterThan(0);
+      } finally {
+        await client.disconnect();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with frame integrity", () => {
+    it("fails a connection on a frame whose CRC32C trailer does not match", async () => {
+      const server = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, framing: "length-prefixed", integrity: true },
+        "lws",
+      );
+      const address = await server.listen();
+      const errors: string[] = [];
+      server.on("error", err => errors.push(err.message));
+      const socket = net.connect(address.port, "127.0.0.1");
+      try {
+        await waitForEvent(socket, "connect");
+        // The length word counts the trailer and carries the checksum flag.
+        const payload = Buffer.from("corrupted");
+        const frame = Buffer.alloc(4 + payload.length + 4);
+        frame.writeUInt32BE((payload.length + 4) | 0x04000000, 0);
+        payload.copy(frame, 4);
+        frame.writeUInt32BE(0xdeadbeef, 4 + payload.length);
+        const closed = waitForEvent(socket, "close");
+        socket.write(frame);
+        await closed;
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(errors).toContain("Frame checksum mismatch");
+        expect(server.getStats()?.integrity).toMatchObject({ framesChecked: 1, mismatches: 1 });
+      } finally {
+        socket.destroy();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with resumable sessions", () => {
+    it("resumes the session of a client that reconnects", async () => {
+      const options = {
+        host: "127.0.0.1",
+        port: 0,
+        framing: "length-prefixed" as const,
+        sequence: true,
+        resumable: true,
+      };
+      const server = new NativeQWormholeServer(options, "lws");
+      const address = await server.listen();
+      const hellos: Array<{ session: string; resumed: boolean }> = [];
+      server.on("resumable", event => hellos.push(event));
+      const peer = lwsClient({ ...options, port: address.port });
+      const settle = () => new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+      try {
+        await peer.connect();
+        await settle();
+        peer.client.close();
+        await settle();
+        await peer.connect();
+        await settle();
+        expect(hellos.map(hello => hello.resumed)).toEqual([false, true]);
+        expect(hellos[1].session).toBe(hellos[0].session);
+        expect(server.getStats()?.resumable).toMatchObject({ resumed: 1, fresh: 1 });
+      } finally {
+        peer.client.close();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with streaming messages", () => {
+    it("streams a message past maxFrameLength as ordered chunks", async () => {
+      const server = new NativeQWormholeServer(
+        {
+          host: "127.0.0.1",
+          port: 0,
+          framing: "length-prefixed",
+          streaming: true,
+          maxFrameLength: 1024,
+        },
+        "lws",
+      );
+      const address = await server.listen();
+      const chunks: Array<{ streamId: number; first: boolean; last: boolean; data: Buffer }> = [];
+      server.on("stream", chunk => chunks.push(chunk));
+      const peer = lwsClient({
+        host: "127.0.0.1",
+        port: address.port,
+        framing: "length-prefixed",
+        streaming: true,
+      });
+      try {
+        await peer.connect();
+        const message = Buffer.from(Array.from({ length: 4096 }, (_, i) => i & 0xff));
+        const streamId = await peer.client.sendStream([message], { chunkBytes: 1000 });
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(chunks.every(chunk => chunk.streamId === streamId)).toBe(true);
+        expect(chunks.map(chunk => [chunk.first, chunk.last])).toEqual([
+          [true, false],
+          [false, false],
+          [false, false],
+          [false, false],
+          [false, true],
+        ]);
+        expect(Buffer.concat(chunks.map(chunk => chunk.data))).toEqual(message);
+      } finally {
+        peer.client.close();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("libsocket"))("with receive timestamps", () => {
+    it.runIf(process.platform === "linux")(
+      "stamps received messages and syncs a client's clock",
+      async () => {
+        const server = new NativeQWormholeServer(
+          {
+            host: "127.0.0.1",
+            port: 0,
+            deserializer: textDeserializer,
+            timestamping: "software",
+          },
+          "libsocket",
+        );
+        const address = await server.listen();
+        const client = new QWormholeClient<string>({
+          host: "127.0.0.1",
+          port: address.port,
+          deserializer: textDeserializer,
+        });
+        const stamped = waitForEvent<{
+          client: { id: string };
+          timestamps?: { kernelUs: number; nativeUs: number; emittedUs: number };
+        }>(server, "message");
+        try {
+          await client.connect();
+          client.send("stamped");
+          const message = await stamped;
+          const { kernelUs, nativeUs, emittedUs } = message.timestamps!;
+          expect(kernelUs).toBeGreaterThan(0);
+          expect(nativeUs).toBeGreaterThanOrEqual(kernelUs);
+          expect(emittedUs).toBeGreaterThanOrEqual(nativeUs);
+          expect(server.getTimestampStats()).toMatchObject({ mode: "software" });
+          expect(server.getTimestampStats()?.rxStamped).toBeGreaterThanOrEqual(1);
+
+          // One clock on both ends: the offset is noise within the round trip.
+          const clock = await server.syncClock(message.client.id);
+          expect(clock.samples).toBe(1);
+          expect(clock.rttUs).toBeGreaterThan(0);
+          expect(Math.abs(clock.offsetUs)).toBeLessThan(50_000);
+        } finally {
+          await client.disconnect();
+          await server.close();
+        }
+      },
+    );
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with link impairment", () => {
+    it("holds frames in the delay line for delayMs", async () => {
+      const server = new NativeQWormholeServer(
+        {
+          host: "127.0.0.1",
+          port: 0,
+          deserializer: textDeserializer,
+          impairment: { delayMs: 100, seed: 1 },
+        },
+        "lws",
+      );
+      const address = await server.listen();
+      const connected = waitForEvent<{ id: string }>(server, "connection");
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      try {
+        await client.connect();
+        const peer = await connected;
+        const received = waitForEvent<string>(client, "message");
+        const sentAt = performance.now();
+        server.sendTo(peer.id, "delayed");
+        expect(String(await received)).toBe("delayed");
+        // Timers may round the last millisecond or so either way.
+        expect(performance.now() - sentAt).toBeGreaterThanOrEqual(90);
+        const impairment = server.getStats()?.impairment;
+        expect(impairment?.framesDelayed).toBeGreaterThanOrEqual(1);
+        expect(impairment?.maxDelayUs).toBeGreaterThanOrEqual(90_000);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with anomaly detection", () => {
+    it("raises a jitter anomaly once the gaps between reads start swinging", async () => {
+      const server = new NativeQWormholeServer(
+        {
+          host: "127.0.0.1",
+          port: 0,
+          anomalyDetection: { threshold: 2, slack: 0, warmup: 2 },
+        },
+        "lws",
+      );
+      const address = await server.listen();
+      const anomalies: Array<{ metric: string; raised: boolean }> = [];
+      server.on("anomaly", event => anomalies.push({ metric: event.metric, raised: event.raised }));
+      const jitterRaised = () => anomalies.some(event => event.metric === "jitter");
+      const sleep = (ms: number) => new Promise(resolve => setTimeout(resolve, ms));
+      const frame = Buffer.from([0, 0, 0, 1, 0x78]);
+      const socket = net.connect(address.port, "127.0.0.1");
+      socket.setNoDelay(true);
+      try {
+        await waitForEvent(socket, "connect");
+        // Jitter is averaged over blocks of sixteen reads: two steady
+        // blocks to learn from, then gaps alternating between 2 and 40 ms.
+        for (let i = 0; i < 40; i++) {
+          socket.write(frame);
+          await sleep(2);
+        }
+        for (let i = 0; i < 96 && !jitterRaised(); i++) {
+          socket.write(frame);
+          await sleep(i % 2 === 0 ? 40 : 2);
+        }
+        await sleep(TEST_WAIT_MS);
+        expect(anomalies).toContainEqual({ metric: "jitter", raised: true });
+        expect(server.getStats()?.anomalies?.raised).toBeGreaterThanOrEqual(1);
+      } finally {
+        socket.destroy();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with a metrics endpoint", () => {
+    it("serves native counters and registered JS slots to a scrape", async () => {
+      const server = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, metrics: { port: 0, path: "/scrape" } },
+        "lws",
+      );
+      await server.listen();
+      try {
+        const slots = server.registerMetrics([
+          { name: "app_jobs", type: "counter", help: "Jobs run." },
+          { name: "app_queue_depth", type: "gauge", labels: { queue: "io" } },
+        ])!;
+        slots[0] = 3;
+        slots[1] = 7.5;
+
+        const port = server.getMetricsPort();
+        expect(port).toBeGreaterThan(0);
+        const response = await fetch(`http://127.0.0.1:${port}/scrape`);
+        expect(response.status).toBe(200);
+        const body = await response.text();
+        expect(body).toMatch(/^qwormhole_connections 0$/m);
+        expect(body).toMatch(/^# HELP app_jobs Jobs run\.$/m);
+        expect(body).toMatch(/^app_jobs_total 3$/m);
+        expect(body).toMatch(/^app_queue_depth\{queue="io"\} 7\.5$/m);
+        expect(body.endsWith("# EOF\n")).toBe(true);
+      } finally {
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with cost accounting", () => {
+    it("charges a tiny-frame client more per byte than a bulk one", async () => {
+      const server = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, costAccounting: true },
+        "lws",
+      );
+      const address = await server.listen();
+      let messages = 0;
+      server.on("message", () => {
+        messages += 1;
+      });
+      const tiny = net.connect(address.port, "127.0.0.1");
+      const bulk = net.connect(address.port, "127.0.0.1");
+      tiny.setNoDelay(true);
+      try {
+        await Promise.all([waitForEvent(tiny, "connect"), waitForEvent(bulk, "connect")]);
+        const payload = Buffer.alloc(64 * 1024, 0x61);
+        const header = Buffer.alloc(4);
+        header.writeUInt32BE(payload.length);
+        bulk.write(Buffer.concat([header, payload]));
+        for (let i = 0; i < 50; i++) {
+          tiny.write(Buffer.from([0, 0, 0, 1, 0x78]));
+          await new Promise(resolve => setTimeout(resolve, 1));
+        }
+        const deadline = Date.now() + TEST_WAIT_MS * 10;
+        while (messages < 51 && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        expect(messages).toBe(51);
+
+        const costly = server.getCostlyConnections(5)!;
+        expect(costly).toHaveLength(2);
+        expect(costly[0].cpuUs).toBeGreaterThanOrEqual(costly[1].cpuUs);
+        const tinyRow = costly.find(row => row.framesReceived === 50)!;
+        const bulkRow = costly.find(row => row.framesReceived === 1)!;
+        expect(tinyRow.bytesReceived).toBe(250);
+        expect(bulkRow.bytesReceived).toBe(4 + payload.length);
+        expect(tinyRow.rxCalls).toBeGreaterThan(1);
+        expect(tinyRow.cpuNsPerByte).toBeGreaterThan(bulkRow.cpuNsPerByte);
+        expect(server.getCostlyConnections(1)).toHaveLength(1);
+      } finally {
+        tiny.destroy();
+        bulk.destroy();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with a native handshake signer", () => {
+    it("signs handshakes the TS verifier and the native responder accept", async () => {
+      const clientKey = generateKeyPairSync("ed25519");
+      const serverKey = generateKeyPairSync("ed25519");
+      const signer = createHandshakeSigner({
+        signingKey: clientKey.privateKey.export({ format: "der", type: "pkcs8" }),
+        version: "1.0.0",
+        tags: { zone: "eu", weight: 2 },
+      });
+      const publicKey = clientKey.publicKey
+        .export({ format: "der", type: "spki" })
+        .toString("base64");
+      expect(signer.info.publicKey).toBe(publicKey);
+      const signed = JSON.parse(signer.sign(1234).toString());
+      expect(signed).toMatchObject({
+        type: "handshake",
+        ts: 1234,
+        version: "1.0.0",
+        nonce: signer.info.nonce,
+        tags: { zone: "eu", weight: 2 },
+      });
+      expect(verifyNegentropicHandshake(signed)).toBe(true);
+
+      const server = new NativeQWormholeServer(
+        {
+          host: "127.0.0.1",
+          port: 0,
+          protocolVersion: "1.0.0",
+          nativeHandshake: {
+            signingKey: serverKey.privateKey.export({ format: "der", type: "pkcs8" }),
+          },
+        },
+        "lws",
+      );
+      const address = await server.listen();
+      const connected = waitForEvent<{ handshake?: { policy?: unknown } }>(server, "connection");
+      const peer = lwsClient({
+        host: "127.0.0.1",
+        port: address.port,
+        framing: "length-prefixed",
+        handshake: signer,
+      });
+      try {
+        const acked = peer.next("message");
+        await peer.connect();
+        const conn = await connected;
+        const ack = JSON.parse((await acked).data!.toString());
+        expect(
+          verifyHandshakeAck(ack, {
+            publicKey: serverKey.publicKey
+              .export({ format: "der", type: "spki" })
+              .toString("base64"),
+            nonce: signer.info.nonce,
+          }),
+        ).toBe(true);
+        expect(conn.handshake?.policy).toBeDefined();
+        expect(server.getStats()?.handshakeAcks).toBe(1);
+      } finally {
+        peer.client.close();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with strict handshakes", () => {
+    it("holds handshakes to the compiled schemas", async () => {
+      const handshake = createNegentropicHandshake({ version: "1.0.0" });
+      const loose = JSON.stringify({ ...handshake, nIndex: String(handshake.nIndex) });
+      const validate = getNativeHandshakeValidator()!;
+      expect(validate(JSON.stringify(handshake))).toBeNull();
+      expect(validate(loose)).toEqual(expect.any(String));
+
+      const server = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, protocolVersion: "1.0.0", strictHandshake: true },
+        "lws",
+      );
+      server.on("error", () => {});
+      const address = await server.listen();
+      const connected = waitForEvent(server, "connection");
+      const client = new QWormholeClient<Buffer>({
+        host: "127.0.0.1",
+        port: address.port,
+        protocolVersion: "1.0.0",
+      });
+      const socket = net.connect(address.port, "127.0.0.1");
+      try {
+        await client.connect();
+        await connected;
+        expect(server.getStats()?.handshakeRejects ?? 0).toBe(0);
+
+        const header = Buffer.alloc(4);
+        header.writeUInt32BE(Buffer.byteLength(loose));
+        await waitForEvent(socket, "connect");
+        const closed = waitForEvent(socket, "close");
+        socket.write(Buffer.concat([header, Buffer.from(loose)]));
+        await closed;
+        expect(server.getStats()?.handshakeRejects).toBe(1);
+      } finally {
+        socket.destroy();
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with an HTTP/2 gateway", () => {
+    it("answers POSTs through the RPC handler and rejects the rest natively", async () => {
+      const server = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, gateway: { port: 0, path: "/rpc" } },
+        "lws",
+      );
+      await server.listen();
+      const detach = attachGatewayRpcServer(
+        server,
+        async body => ({ status: 200, body: Buffer.concat([Buffer.from("echo:"), body]) }),
+        { contentType: "application/x-qwormhole-rpc" },
+      );
+      const session = http2.connect(`http://127.0.0.1:${server.getGatewayPort()}`);
+      session.on("error", () => {});
+      const request = (method: string, path: string, body?: string) =>
+        new Promise<{ status: number; type?: string; body: string }>((resolve, reject) => {
+          const stream = session.request({ ":method": method, ":path": path });
+          let status = 0;
+          let type: string | undefined;
+          const chunks: Buffer[] = [];
+          stream.on("response", headers => {
+            status = Number(headers[":status"]);
+            type = headers["content-type"] as string | undefined;
+          });
+          stream.on("data", chunk => chunks.push(chunk));
+          stream.on("end", () => resolve({ status, type, body: Buffer.concat(chunks).toString() }));
+          stream.on("error", reject);
+          stream.end(body);
+        });
+      try {
+        const answers = await Promise.all([
+          request("POST", "/rpc/echo", "a"),
+          request("POST", "/rpc/echo", "b"),
+        ]);
+        expect(answers).toEqual([
+          { status: 200, type: "application/x-qwormhole-rpc", body: "echo:a" },
+          { status: 200, type: "application/x-qwormhole-rpc", body: "echo:b" },
+        ]);
+        expect((await request("POST", "/elsewhere", "c")).status).toBe(404);
+        expect((await request("GET", "/rpc/echo")).status).toBe(405);
+        expect(server.getGatewayStats()).toMatchObject({
+          requests: 2,
+          responses: 2,
+          rejected: 2,
+          orphaned: 0,
+        });
+      } finally {
+        session.close();
+        detach();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeSecureStreamsAvailable())("with Secure Streams", () => {
+    it("connects a raw policy stream and carries data both ways", async () => {
+      const peer = net.createServer(socket => {
+        socket.on("data", data => socket.write(Buffer.concat([Buffer.from("echo:"), data])));
+      });
+      await new Promise<void>(resolve => peer.listen(0, "127.0.0.1", resolve));
+      const { port } = peer.address() as net.AddressInfo;
+      const streams = createSecureStreams({
+        policy: {
+          release: "1",
+          product: "qwormhole",
+          "schema-version": 1,
+          retry: [{ default: { backoff: [100], conceal: 1, jitterpc: 0 } }],
+          s: [{ echo: { endpoint: "127.0.0.1", port, protocol: "raw", tls: false, retry: "default" } }],
+        },
+      });
+      try {
+        const stream = streams.open("echo");
+        const states: string[] = [];
+        const received: Buffer[] = [];
+        stream.on("state", state => states.push(state));
+        stream.on("data", data => received.push(data));
+        expect(stream.write("ping")).toBe(true);
+        const deadline = Date.now() + TEST_WAIT_MS * 10;
+        while (Buffer.concat(received).length < 9 && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        expect(Buffer.concat(received).toString()).toBe("echo:ping");
+        expect(states).toContain("connected");
+        expect(streams.getStats()).toMatchObject({ streams: 1, created: 1, connected: 1 });
+        expect(streams.getStats()?.txBytes).toBeGreaterThanOrEqual(4);
+        expect(streams.getStats()?.rxBytes).toBeGreaterThanOrEqual(9);
+      } finally {
+        streams.close();
+        await new Promise(resolve => peer.close(resolve));
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with extra endpoints", () => {
+    it("accepts on every listener and tags connections with theirs", async () => {
+      const server = new NativeQWormholeServer(
+        {
+          host: "127.0.0.1",
+          port: 0,
+          endpoints: [{ name: "internal", host: "127.0.0.1", port: 0 }],
+        },
+        "lws",
+      );
+      await server.listen();
+      const listeners = server.getEndpoints()!;
+      expect(listeners.map(endpoint => endpoint.name)).toEqual(["default", "internal"]);
+      const internal = listeners[1];
+      expect(internal.port).toBeGreaterThan(0);
+      expect(internal.port).not.toBe(listeners[0].port);
+
+      const connected = waitForEvent<{ endpoint?: string }>(server, "connection");
+      const socket = net.connect(internal.port, "127.0.0.1");
+      try {
+        expect((await connected).endpoint).toBe("internal");
+        expect(server.getEndpoints()).toMatchObject([
+          { name: "default", connections: 0, accepted: 0 },
+          { name: "internal", connections: 1, accepted: 1, tls: false },
+        ]);
+      } finally {
+        socket.destroy();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with delta broadcasts", () => {
+    it("patches the second version and the client rebuilds it", async () => {
+      const server = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, framing: "length-prefixed", delta: true },
+        "lws",
+      );
+      const address = await server.listen();
+      const connected = waitForEvent(server, "connection");
+      const peer = lwsClient({
+        host: "127.0.0.1",
+        port: address.port,
+        framing: "length-prefixed",
+        delta: true,
+      });
+      try {
+        await peer.connect();
+        await connected;
+        const first = Buffer.from(Array.from({ length: 512 }, (_, i) => i & 0xff));
+        const second = Buffer.from(first);
+        second[100] ^= 0xff;
+
+        let received = peer.next("message");
+        server.broadcastDelta("book", first);
+        expect((await received).data).toEqual(first);
+        received = peer.next("message");
+        server.broadcastDelta("book", second);
+        expect((await received).data).toEqual(second);
+
+        expect(server.getStats()?.delta).toMatchObject({ keys: 1, fullFrames: 1, patchFrames: 1 });
+        expect(server.getStats()?.delta?.bytesSaved).toBeGreaterThan(0);
+        expect(peer.client.getStats()?.delta).toEqual({
+          fullFrames: 1,
+          patchFrames: 1,
+          mismatches: 0,
+        });
+      } finally {
+        peer.client.close();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeMulticastAvailable())("with a multicast channel", () => {
+    it.runIf(process.platform === "linux")(
+      "sends to the group, keeps a repair window and heartbeats after a send",
+      async () => {
+        const port = 40000 + Math.floor(Math.random() * 20000);
+        const channel = createMulticastChannel({
+          group: "239.255.67.99",
+          port,
+          interface: "lo",
+          heartbeatMs: 20,
+        });
+        try {
+          const joined = await channel.start();
+          expect(joined).toMatchObject({ group: "239.255.67.99", port, family: "IPv4" });
+          expect(joined.sourceId).toEqual(expect.any(Number));
+          expect(channel.send("tick")).toBe(0);
+          expect(channel.send(Buffer.from("tock"))).toBe(1);
+          await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+          const stats = channel.getStats();
+          expect(stats).toMatchObject({ framesSent: 2, sendFailures: 0, windowFrames: 2 });
+          expect(stats.bytesSent).toBeGreaterThanOrEqual(8);
+          expect(stats.heartbeatsSent).toBeGreaterThanOrEqual(1);
+          // Loopback never hands a node its own frames.
+          expect(stats.framesDelivered).toBe(0);
+        } finally {
+          channel.close();
+        }
+      },
+    );
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with native reconnect", () => {
+    it("redials to the next endpoint when the server goes away", async () => {
+      const primary = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+      const backup = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, deserializer: textDeserializer },
+        "lws",
+      );
+      const primaryAddress = await primary.listen();
+      const backupAddress = await backup.listen();
+      const peer = lwsClient({
+        host: "127.0.0.1",
+        port: primaryAddress.port,
+        framing: "length-prefixed",
+        reconnect: {
+          initialDelayMs: 20,
+          maxDelayMs: 100,
+          endpoints: [{ host: "127.0.0.1", port: backupAddress.port }],
+        },
+      });
+      try {
+        await peer.connect();
+        const accepted = waitForEvent(backup, "connection", TEST_WAIT_MS * 15);
+        const redialled = peer.next("reconnecting", TEST_WAIT_MS * 15);
+        const reconnected = peer.next("connect", TEST_WAIT_MS * 15);
+        await primary.close();
+        await Promise.all([redialled, reconnected, accepted]);
+        expect(peer.events.filter(evt => evt.type === "close")).toEqual([]);
+
+        const received = waitForEvent<{ data: string }>(backup, "message");
+        peer.client.send(Buffer.from("after"));
+        expect((await received).data).toBe("after");
+        const stats = peer.client.getStats()?.reconnect;
+        expect(stats?.attempts).toBeGreaterThanOrEqual(1);
+        expect(stats?.reconnects).toBe(1);
+        expect(stats?.endpoint).toBe(1);
+      } finally {
+        peer.client.close();
+        await backup.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with native mux", () => {
+    it("carries streams both ways between the lws client and server", async () => {
+      const server = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, framing: "length-prefixed", mux: true },
+        "lws",
+      );
+      const address = await server.listen();
+      const events: Array<{ id: string; opened?: number[]; data: string[] }> = [];
+      server.on("mux", event =>
+        events.push({
+          id: event.client.id,
+          opened: event.opened,
+          data: (event.streams ?? []).map(stream => `${stream.streamId}:${stream.data}`),
+        }),
+      );
+      const peer = lwsClient({
+        host: "127.0.0.1",
+        port: address.port,
+        framing: "length-prefixed",
+        mux: true,
+      });
+      try {
+        await peer.connect();
+        const clientStream = peer.client.muxOpen()!;
+        expect(clientStream % 2).toBe(1);
+        expect(peer.client.muxWrite(clientStream, Buffer.from("hello"))).toBe(true);
+        const deadline = Date.now() + TEST_WAIT_MS * 10;
+        while (events.length === 0 && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        expect(events[0]).toMatchObject({
+          opened: [clientStream],
+          data: [`${clientStream}:hello`],
+        });
+
+        const serverStream = server.muxOpen(events[0].id)!;
+        expect(serverStream % 2).toBe(0);
+        const reply = peer.next("mux");
+        expect(server.muxWrite(events[0].id, serverStream, Buffer.from("yo"))).toBe(true);
+        const received = await reply;
+        expect(received.opened).toEqual([serverStream]);
+        expect(received.streams?.map(stream => [stream.streamId, String(stream.data)])).toEqual([
+          [serverStream, "yo"],
+        ]);
+      } finally {
+        peer.client.close();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with native WebSocket", () => {
+    it("speaks RFC 6455 to a standard WebSocket client", async () => {
+      const server = new NativeQWormholeServer(
+        {
+          host: "127.0.0.1",
+          port: 0,
+          websocket: { protocol: "qw-test" },
+          deserializer: textDeserializer,
+        },
+        "lws",
+      );
+      const address = await server.listen();
+      const connected = waitForEvent(server, "connection");
+      const received = waitForEvent<{ data: string }>(server, "message");
+      const socket = new WebSocket(`ws://127.0.0.1:${address.port}/`, "qw-test");
+      const once = <T extends Event>(event: string) =>
+        new Promise<T>(resolve =>
+          socket.addEventListener(event, evt => resolve(evt as T), { once: true }),
+        );
+      try {
+        await once("open");
+        expect(socket.protocol).toBe("qw-test");
+        await connected;
+        socket.send("hello");
+        expect((await received).data).toBe("hello");
+
+        const reply = once<MessageEvent>("message");
+        server.broadcast("hi");
+        expect((await reply).data).toBe("hi");
+
+        const plain = await fetch(`http://127.0.0.1:${address.port}/`);
+        expect(plain.status).toBe(426);
+      } finally {
+        socket.close();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with native seal", () => {
+    it("encrypts frames both ways and survives a rekey", async () => {
+      const server = new NativeQWormholeServer(
+        {
+          host: "127.0.0.1",
+          port: 0,
+          framing: "length-prefixed",
+          seal: true,
+          deserializer: textDeserializer,
+        },
+        "lws",
+      );
+      const address = await server.listen();
+      const connected = waitForEvent<{ id: string }>(server, "connection");
+      const peer = lwsClient({
+        host: "127.0.0.1",
+        port: address.port,
+        framing: "length-prefixed",
+        seal: true,
+      });
+      try {
+        await peer.connect();
+        const { id } = await connected;
+        const key = Buffer.alloc(32, 0x5a);
+        peer.client.setSessionKey(key);
+        expect(server.setSessionKey(id, key.toString("base64"))).toBe(true);
+
+        const received = waitForEvent<{ data: string }>(server, "message");
+        peer.client.send(Buffer.from("secret"));
+        expect((await received).data).toBe("secret");
+
+        expect(server.rekey(id)).toBe(true);
+        const reply = peer.next("message");
+        server.broadcast("after rekey");
+        expect(String((await reply).data)).toBe("after rekey");
+
+        expect(server.getStats()?.seal).toMatchObject({
+          framesSealed: 1,
+          framesOpened: 1,
+          failures: 0,
+          rekeys: 1,
+        });
+        expect(peer.client.getStats()?.seal).toMatchObject({
+          framesSealed: 1,
+          framesOpened: 1,
+          failures: 0,
+          peerRekeys: 1,
+        });
+      } finally {
+        peer.client.close();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with sequence numbers", () => {
+    it("drops duplicate and stale frames before they reach JS", async () => {
+      const server = new NativeQWormholeServer(
+        {
+          host: "127.0.0.1",
+          port: 0,
+          framing: "length-prefixed",
+          sequence: { window: 64 },
+          deserializer: textDeserializer,
+        },
+        "lws",
+      );
+      const address = await server.listen();
+      const received: string[] = [];
+      server.on("message", ({ data }) => received.push(data as string));
+      const errors: string[] = [];
+      server.on("error", error => errors.push(error.message));
+      const numbered = (sequence: number, text: string) => {
+        const payload = Buffer.from(text);
+        const frame = Buffer.alloc(4 + payload.length + 8);
+        frame.writeUInt32BE((payload.length + 8) | 0x20000000, 0);
+        payload.copy(frame, 4);
+        frame.writeBigUInt64BE(BigInt(sequence), 4 + payload.length);
+        return frame;
+      };
+      const socket = net.connect(address.port, "127.0.0.1");
+      try {
+        await waitForEvent(socket, "connect");
+        socket.write(
+          Buffer.concat([
+            numbered(0, "a"),
+            numbered(1, "b"),
+            numbered(1, "b again"),
+            numbered(200, "c"),
+            numbered(5, "too old"),
+          ]),
+        );
+        const deadline = Date.now() + TEST_WAIT_MS * 10;
+        while (received.length < 3 && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        await new Promise(resolve => setTimeout(resolve, TEST_WAIT_MS));
+        expect(received).toEqual(["a", "b", "c"]);
+        expect(server.getStats()?.sequence).toMatchObject({
+          framesAccepted: 3,
+          duplicates: 1,
+          stale: 1,
+        });
+
+        // Once numbered, an unnumbered frame closes the connection.
+        const closed = waitForEvent(socket, "close");
+        socket.write(Buffer.from([0, 0, 0, 1, 0x78]));
+        await closed;
+        expect(errors).toContain("Frame without a valid sequence number");
+      } finally {
+        socket.destroy();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with socket adoption", () => {
+    it("serves a connection accepted by a Node listener", async () => {
+      const server = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, deserializer: textDeserializer },
+        "lws",
+      );
+      await server.listen();
+      const adopted: boolean[] = [];
+      const front = net.createServer({ pauseOnConnect: true }, socket => {
+        adopted.push(server.adoptSocket(socket));
+      });
+      await new Promise<void>(resolve => front.listen(0, "127.0.0.1", resolve));
+      const connected = waitForEvent(server, "connection");
+      const received = waitForEvent<{ data: string }>(server, "message");
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: (front.address() as net.AddressInfo).port,
+        deserializer: textDeserializer,
+      });
+      try {
+        await client.connect();
+        await connected;
+        expect(adopted).toEqual([true]);
+        void client.send("routed");
+        expect((await received).data).toBe("routed");
+        const reply = waitForEvent<string>(client, "message");
+        server.broadcast("adopted");
+        expect(await reply).toBe("adopted");
+        expect(server.getConnectionCount()).toBe(1);
+      } finally {
+        await client.disconnect();
+        await new Promise(resolve => front.close(resolve));
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with a broadcast ring", () => {
+    it.runIf(process.platform !== "win32")(
+      "fans one published frame out through every attached server",
+      async () => {
+        const ring = createNativeBroadcastRing(1 << 16)!;
+        const servers = [0, 1].map(
+          () => new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws"),
+        );
+        const clients: Array<QWormholeClient<string>> = [];
+        try {
+          for (const server of servers) {
+            const address = await server.listen();
+            expect(server.attachBroadcastRing(ring.name())).toBe(true);
+            const connected = waitForEvent(server, "connection");
+            const client = new QWormholeClient<string>({
+              host: "127.0.0.1",
+              port: address.port,
+              deserializer: textDeserializer,
+            });
+            clients.push(client);
+            await client.connect();
+            await connected;
+          }
+          const received = clients.map(client => waitForEvent<string>(client, "message"));
+          expect(ring.publish(Buffer.from("tick"))).toBe(true);
+          expect(await Promise.all(received)).toEqual(["tick", "tick"]);
+          expect(ring.getStats()).toMatchObject({ published: 1, rejected: 0 });
+          expect(ring.publish(Buffer.alloc((1 << 15) + 1))).toBe(false);
+          for (const server of servers) {
+            expect(server.getStats()?.broadcastRing).toMatchObject({ frames: 1, laps: 0 });
+          }
+        } finally {
+          for (const client of clients) await client.disconnect();
+          for (const server of servers) await server.close();
+          ring.close();
+        }
+      },
+    );
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with a connection directory", () => {
+    it.runIf(process.platform !== "win32")(
+      "forwards sendTo() to the shard holding the connection",
+      async () => {
+        const directory = createNativeConnectionDirectory({ shards: 2 })!;
+        const names = directory.names();
+        const front = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+        const owner = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+        await front.listen();
+        const address = await owner.listen();
+        expect(front.attachConnectionDirectory({ ...names, shard: 0 })).toBe(true);
+        expect(owner.attachConnectionDirectory({ ...names, shard: 1 })).toBe(true);
+        const connected = waitForEvent<{ id: string }>(owner, "connection");
+        const client = new QWormholeClient<string>({
+          host: "127.0.0.1",
+          port: address.port,
+          deserializer: textDeserializer,
+        });
+        try {
+          await client.connect();
+          const { id } = await connected;
+          expect(directory.lookup(id)).toBe(1);
+
+          const received = waitForEvent<string>(client, "message");
+          expect(front.sendTo(id, Buffer.from("via shard 0"))).toBe(true);
+          expect(await received).toBe("via shard 0");
+          expect(front.getStats()?.connectionDirectory).toMatchObject({
+            shard: 0,
+            forwarded: 1,
+          });
+          expect(owner.getStats()?.connectionDirectory).toMatchObject({
+            shard: 1,
+            delivered: 1,
+          });
+          expect(front.sendTo("nobody", Buffer.from("lost"))).toBe(false);
+        } finally {
+          await client.disconnect();
+          await front.close();
+          await owner.close();
+          directory.close();
+        }
+      },
+    );
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with connection migration", () => {
+    it.runIf(process.platform !== "win32")(
+      "moves a live connection to another server without the client noticing",
+      async () => {
+        const from = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+        const to = new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, deserializer: textDeserializer },
+          "lws",
+        );
+        const address = await from.listen();
+        await to.listen();
+        const connected = waitForEvent<{ id: string }>(from, "connection");
+        const client = new QWormholeClient<string>({
+          host: "127.0.0.1",
+          port: address.port,
+          deserializer: textDeserializer,
+        });
+        const clientClosed = vi.fn();
+        client.on("close", clientClosed);
+        try {
+          await client.connect();
+          const { id } = await connected;
+          const left = waitForEvent<{ migrated?: boolean }>(from, "clientClosed");
+          const detached = (await from.detachConnection(id))!;
+          expect((await left).migrated).toBe(true);
+
+          const adopted = waitForEvent(to, "connection");
+          expect(to.adoptSocket(detached.fd, detached.state)).toBe(true);
+          fs.closeSync(detached.fd);
+          await adopted;
+
+          const received = waitForEvent<{ data: string }>(to, "message");
+          void client.send("still here");
+          expect((await received).data).toBe("still here");
+          const reply = waitForEvent<string>(client, "message");
+          to.broadcast("moved");
+          expect(await reply).toBe("moved");
+          expect(from.getConnectionCount()).toBe(0);
+          expect(clientClosed).not.toHaveBeenCalled();
+        } finally {
+          await client.disconnect();
+          await from.close();
+          await to.close();
+        }
+      },
+    );
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with worker delivery", () => {
+    // Attaches sink 0 through the TS wrapper, relays each frame back as text.
+    const sinkWorker = `
+      const { parentPort, workerData } = require("node:worker_threads");
+      import(workerData.entry).then(native => {
+        const attached = native.attachNativeMessageSink(workerData.token, 0, messages => {
+          for (const { id, data } of messages) {
+            parentPort.postMessage({ id, data: Buffer.from(data).toString() });
+          }
+        });
+        parentPort.postMessage({ attached });
+        parentPort.once("message", () => {
+          native.detachNativeMessageSink(workerData.token, 0);
+          parentPort.close();
+        });
+      });
+    `;
+
+    it("posts received frames straight to the worker that attached", async () => {
+      const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+      const address = await server.listen();
+      const token = server.enableWorkerDelivery(1);
+      const worker = new Worker(sinkWorker, {
+        eval: true,
+        execArgv: ["--import", "tsx"],
+        workerData: {
+          token,
+          entry: new URL("../src/core/native-server.ts", import.meta.url).href,
+        },
+      });
+      const exited = new Promise<void>(resolve => worker.once("exit", () => resolve()));
+      const onMainThread = vi.fn();
+      server.on("message", onMainThread);
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      try {
+        expect(await waitForEvent<{ attached: boolean }>(worker, "message")).toEqual({
+          attached: true,
+        });
+        const connected = waitForEvent<{ id: string }>(server, "connection");
+        await client.connect();
+        const { id } = await connected;
+
+        const relayed = waitForEvent<{ id: string; data: string }>(worker, "message");
+        void client.send("to-worker");
+        expect(await relayed).toEqual({ id, data: "to-worker" });
+        expect(onMainThread).not.toHaveBeenCalled();
+        expect(server.getStats()?.workerDelivery).toMatchObject({
+          workers: 1,
+          attached: 1,
+          delivered: 1,
+          fallbacks: 0,
+        });
+      } finally {
+        worker.postMessage("stop");
+        await exited;
+        server.disableWorkerDelivery();
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with TCP path telemetry", () => {
+    it.runIf(process.platform === "linux")(
+      "samples TCP_INFO for each connection on the service thread",
+      async () => {
+        const server = new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, tcpInfoIntervalMs: 20 },
+          "lws",
+        );
+        const address = await server.listen();
+        const connected = waitForEvent<{ id: string }>(server, "connection");
+        const client = new QWormholeClient<string>({
+          host: "127.0.0.1",
+          port: address.port,
+          deserializer: textDeserializer,
+        });
+        try {
+          await client.connect();
+          const { id } = await connected;
+          const received = waitForEvent(server, "message");
+          void client.send("sample me");
+          await received;
+
+          const deadline = Date.now() + TEST_WAIT_MS * 5;
+          while (!server.getConnectionStats(id)?.tcpPath && Date.now() < deadline) {
+            await new Promise(resolve => setTimeout(resolve, 10));
+          }
+          const reading = server.getConnectionStats(id)!.tcpPath!;
+          expect(reading.mss).toBeGreaterThan(0);
+          expect(reading.cwnd).toBeGreaterThan(0);
+          expect(reading.sampledAt).toBeGreaterThan(Date.now() - 60_000);
+
+          const paths = [...readPathSnapshot(server.getPathSnapshot()!).values()];
+          expect(paths).toHaveLength(1);
+          expect(paths[0].mss).toBe(reading.mss);
+        } finally {
+          await client.disconnect();
+          await server.close();
+        }
+      },
+    );
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with transport telemetry", () => {
+    const connectedPair = async () => {
+      const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+      const address = await server.listen();
+      const connected = waitForEvent(server, "connection");
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      await client.connect();
+      await connected;
+      return { server, client };
+    };
+
+    it("records each service-thread flush for any thread to drain", async () => {
+      const { server, client } = await connectedPair();
+      try {
+        const token = server.enableTransportTelemetry({ capacity: 64 });
+        const received = waitForEvent<string>(client, "message");
+        server.broadcast("flush me");
+        expect(await received).toBe("flush me");
+
+        const out = new Float64Array(64 * 4);
+        const count = drainNativeTransportTelemetry(token, out);
+        expect(count).toBeGreaterThanOrEqual(1);
+        expect(out[0]).toBe(NativeTelemetryKind.Flush);
+        expect(out[2]).toBeGreaterThan(0);
+        expect(out[3]).toBeGreaterThanOrEqual(1);
+        server.disableTransportTelemetry();
+        expect(drainNativeTransportTelemetry(token, out)).toBe(-1);
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+
+    it("scores the flushes in a worker and publishes them", async () => {
+      const { server, client } = await connectedPair();
+      const pipeline = startTransportCoherencePipeline(server, { intervalMs: 10 });
+      try {
+        for (let i = 0; i < 3; i += 1) {
+          const received = waitForEvent<string>(client, "message");
+          server.broadcast(`frame-${i}`);
+          await received;
+        }
+        const deadline = Date.now() + TEST_WAIT_MS * 10;
+        while (!pipeline.read()?.sampleCount.flushes && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        const reading = pipeline.read()!;
+        expect(reading.seq).toBeGreaterThanOrEqual(1);
+        expect(reading.sampleCount.flushes).toBeGreaterThanOrEqual(1);
+        expect(Number.isFinite(reading.transportSNI)).toBe(true);
+      } finally {
+        await pipeline.close();
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with a connection bundle", () => {
+    it("stripes one ordered stream over two member connections", async () => {
+      const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+      const address = await server.listen();
+      const acceptor = new ConnectionBundleAcceptor(server);
+      const received: string[] = [];
+      const joined = waitForEvent<BundleConnection>(acceptor, "bundle");
+      const bundle = new ConnectionBundle({ host: "127.0.0.1", port: address.port });
+      try {
+        await bundle.connect();
+        const joinedBundle = await joined;
+        expect(joinedBundle.paths).toBe(2);
+        joinedBundle.on("message", data => received.push(data.toString()));
+
+        const expected = Array.from({ length: 200 }, (_, i) => `m${i}`);
+        for (const text of expected) bundle.send(text);
+        const deadline = Date.now() + TEST_WAIT_MS * 5;
+        while (received.length < expected.length && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        expect(received).toEqual(expected);
+        const stats = bundle.stats();
+        expect(stats.map(path => path.open)).toEqual([true, true]);
+        expect(stats.reduce((sum, path) => sum + path.framesSent, 0)).toBe(200);
+      } finally {
+        bundle.close();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with native RPC", () => {
+    it("matches responses on the client's service thread", async () => {
+      const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+      const address = await server.listen();
+      const detach = attachBinaryRpcServer(server as never, body =>
+        body.toString() === "missing"
+          ? { status: 404, body: Buffer.from("no such thing") }
+          : { status: 200, body: Buffer.concat([body, Buffer.from("-pong")]) },
+      );
+      const peer = lwsClient({
+        host: "127.0.0.1",
+        port: address.port,
+        framing: "length-prefixed",
+        rpc: true,
+      });
+      try {
+        await peer.connect();
+        const rpc = attachNativeRpcClient(peer.client);
+        const [ok, failed] = await Promise.allSettled([
+          rpc.request(Buffer.from("ping"), 1000),
+          rpc.request(Buffer.from("missing"), 1000),
+        ]);
+        expect(ok).toMatchObject({ status: "fulfilled", value: { status: 200 } });
+        expect((ok as PromiseFulfilledResult<{ body: Buffer }>).value.body.toString()).toBe(
+          "ping-pong",
+        );
+        expect(failed).toMatchObject({ status: "rejected" });
+        expect((failed as PromiseRejectedResult).reason.message).toBe("no such thing");
+        expect(peer.client.getStats()?.rpc).toMatchObject({
+          requests: 2,
+          responses: 2,
+          timeouts: 0,
+        });
+      } finally {
+        detach();
+        peer.client.close();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with connection snapshots", () => {
+    it("reads every connection in one pass", async () => {
+      const server = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, deserializer: textDeserializer },
+        "lws",
+      );
+      const address = await server.listen();
+      const ids: string[] = [];
+      server.on("connection", ({ id }) => ids.push(id));
+      const dial = () =>
+        new Promise<net.Socket>((resolve, reject) => {
+          const socket = net.connect(address.port, "127.0.0.1", () => resolve(socket));
+          socket.once("error", reject);
+        });
+      const sockets: net.Socket[] = [];
+      try {
+        sockets.push(await dial(), await dial());
+        const deadline = Date.now() + TEST_WAIT_MS * 5;
+        while (ids.length < 2 && Date.now() < deadline) {
+          await new Promise(resolve => setTimeout(resolve, 10));
+        }
+        const received = waitForEvent<{ client: { id: string } }>(server, "message");
+        const frame = Buffer.alloc(9);
+        frame.writeUInt32BE(5, 0);
+        frame.write("hello", 4);
+        sockets[0].write(frame);
+        const talker = (await received).client.id;
+        const quiet = ids.find(id => id !== talker)!;
+        expect(server.pause(quiet)).toBe(true);
+
+        const snapshot = server.getConnectionsSnapshot()!;
+        expect(snapshot.count).toBe(2);
+        const rows = Array.from({ length: snapshot.count }, (_, i) => i);
+        expect(rows.map(i => snapshot.remotePorts[i]).sort()).toEqual(
+          sockets.map(socket => socket.localPort).sort(),
+        );
+        expect(rows.map(i => snapshotRemoteAddress(snapshot, i))).toEqual([
+          "127.0.0.1",
+          "127.0.0.1",
+        ]);
+        const row = (socket: net.Socket) =>
+          rows.find(i => snapshot.remotePorts[i] === socket.localPort)!;
+        expect(snapshot.bytesReceived[row(sockets[0])]).toBeGreaterThanOrEqual(frame.length);
+        expect(snapshot.flags[row(sockets[1])] & NativeConnectionFlag.Paused).toBeTruthy();
+        expect(snapshot.flags[row(sockets[0])] & NativeConnectionFlag.Paused).toBeFalsy();
+      } finally {
+        sockets.forEach(socket => socket.destroy());
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with a shared mux link", () => {
+    it("carries several clients as streams of one connection", async () => {
+      const server = new NativeQWormholeServer(
+        { host: "127.0.0.1", port: 0, mux: true },
+        "lws",
+      );
+      const address = await server.listen();
+      const detach = attachMuxLinkServer(server, message => {
+        message.reply(Buffer.from(`ack:${message.data}`));
+      });
+      const link = new NativeMuxLink({ host: "127.0.0.1", port: address.port });
+      const clients = ["a", "b"].map(
+        () =>
+          new QWormholeClient<string>({
+            host: "127.0.0.1",
+            port: address.port,
+            deserializer: textDeserializer,
+            socketFactory: link.socketFactory,
+          }),
+      );
+      try {
+        await Promise.all(clients.map(client => client.connect()));
+        expect(link.streamCount).toBe(2);
+        expect(server.getConnectionCount()).toBe(1);
+
+        const replies = clients.map(client => waitForEvent<string>(client, "message"));
+        void clients[0].send("from-a");
+        void clients[1].send("from-b");
+        expect(await Promise.all(replies)).toEqual(["ack:from-a", "ack:from-b"]);
+      } finally {
+        await Promise.all(clients.map(client => client.disconnect()));
+        link.close();
+        detach();
+        await server.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeKcpAvailable())("with native KCP", () => {
+    it("carries a mux stream between two engines over loopback", async () => {
+      const a = new NativeKcpServer({ conv: 9, listenPort: 0, host: "127.0.0.1" });
+      const b = new NativeKcpServer({ conv: 9, listenPort: 0, host: "127.0.0.1" });
+      try {
+        await a.start();
+        const port = await b.start();
+        const received = new Promise<string>((resolve, reject) => {
+          const timer = setTimeout(
+            () => reject(new Error("Timeout waiting for KCP stream data")),
+            TEST_WAIT_MS * 5,
+          );
+          b.on("session", ({ mux }) =>
+            mux.on("stream", (stream: MuxStream) =>
+              stream.on("data", (data: Uint8Array) => {
+                clearTimeout(timer);
+                resolve(Buffer.from(data).toString());
+              }),
+            ),
+          );
+        });
+        const { mux } = a.connect("127.0.0.1", port);
+        mux.createStream().write(Buffer.from("over kcp"));
+        expect(await received).toBe("over kcp");
+        expect(a.getStats().sessions).toBe(1);
+        expect(b.getStats().sessions).toBe(1);
+        expect(b.getStats().datagramsIn).toBeGreaterThanOrEqual(1);
+      } finally {
+        a.stop();
+        b.stop();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeUdpAvailable())("with a native datagram socket", () => {
+    it("exchanges datagrams with a node:dgram peer", async () => {
+      const socket = new NativeDatagramSocket();
+      const peer = dgram.createSocket("udp4");
+      try {
+        await waitForEvent(socket.bind(0, "127.0.0.1"), "listening");
+        await new Promise<void>(resolve => peer.bind(0, "127.0.0.1", resolve));
+        const port = socket.address().port;
+
+        const seen: string[] = [];
+        const both = new Promise<void>(resolve =>
+          socket.on("message", (msg: Buffer) => {
+            seen.push(msg.toString());
+            if (seen.length === 2) resolve();
+          }),
+        );
+        peer.send("one", port, "127.0.0.1");
+        peer.send("two", port, "127.0.0.1");
+        await both;
+        expect(seen.sort()).toEqual(["one", "two"]);
+
+        const echoed = waitForEvent<Buffer>(peer, "message");
+        const reply = Buffer.from("back");
+        socket.send(reply, 0, reply.length, peer.address().port, "127.0.0.1");
+        expect((await echoed).toString()).toBe("back");
+        expect(socket.getStats()).toMatchObject({ datagramsIn: 2, datagramsOut: 1 });
+      } finally {
+        socket.close();
+        peer.close();
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with the native frame splitter", () => {
+    it("splits chunks that cut across frames like the TS framer", () => {
+      const encoder = new LengthPrefixedFramer({ preferNative: false });
+      const stream = Buffer.concat(
+        ["alpha", "", "beta".repeat(300), "gamma"].map(text => encoder.encode(Buffer.from(text))),
+      );
+      const chunks = [stream.subarray(0, 3), stream.subarray(3, 11), stream.subarray(11, 700)];
+      chunks.push(stream.subarray(700));
+
+      const splitter = createNativeFrameSplitter({ maxFrameLength: 4096 })!;
+      expect(splitter).not.toBeNull();
+      const frames = chunks.flatMap(chunk => splitter.push(chunk).frames);
+      expect(splitter.buffered()).toBe(0);
+
+      const tsFrames: Buffer[] = [];
+      encoder.on("message", frame => tsFrames.push(Buffer.from(frame)));
+      chunks.forEach(chunk => encoder.push(chunk));
+      expect(frames).toEqual(tsFrames);
+      expect(frames.map(frame => frame.length)).toEqual([5, 0, 1200, 5]);
+
+      const limited = new LengthPrefixedFramer({ maxFrameLength: 16 });
+      const errors: Error[] = [];
+      limited.on("error", err => errors.push(err));
+      limited.push(encoder.encode(Buffer.alloc(64)));
+      expect(errors.map(err => err.message)).toEqual(["Frame length 64 exceeds limit 16"]);
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with a native frame ring", () => {
+    it.runIf(process.platform !== "win32")(
+      "sends a batch straight from the native slab on the socket's descriptor",
+      async () => {
+        const chunks: Buffer[] = [];
+        const sink = net.createServer(socket => socket.on("data", chunk => chunks.push(chunk)));
+        await new Promise<void>(resolve => sink.listen(0, "127.0.0.1", resolve));
+        const { port } = sink.address() as net.AddressInfo;
+        const socket = net.connect(port, "127.0.0.1");
+        await waitForEvent(socket, "connect");
+        try {
+          const framer = new BatchFramer({ nativeRing: true, flushIntervalMs: 0 });
+          framer.attachSocket(socket);
+          framer.encodeToBatch(Buffer.from("abc"));
+          framer.encodeToBatch(Buffer.from("def"));
+          await framer.flushBatch();
+
+          const deadline = Date.now() + TEST_WAIT_MS * 5;
+          while (Buffer.concat(chunks).length < 14 && Date.now() < deadline) {
+            await new Promise(resolve => setTimeout(resolve, 10));
+          }
+          expect(Buffer.concat(chunks)).toEqual(
+            Buffer.from([0, 0, 0, 3, 97, 98, 99, 0, 0, 0, 3, 100, 101, 102]),
+          );
+          // The bytes never went through the Node stream.
+          expect(socket.bytesWritten).toBe(0);
+          expect(framer.getStats()).toMatchObject({ totalFrames: 2, totalFlushes: 1 });
+        } finally {
+          socket.destroy();
+          await new Promise(resolve => sink.close(resolve));
+        }
+      },
+    );
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with the native send queue", () => {
+    it("orders lanes natively and gates them with the token bucket", () => {
+      const lanes = createNativePriorityQueue()!;
+      lanes.enqueue(Buffer.from("low"), 5);
+      lanes.enqueue(Buffer.from("first"), -1);
+      lanes.enqueue(Buffer.from("mid"));
+      lanes.enqueue(Buffer.from("second"), -1);
+      expect(lanes.dequeueMany(8).map(b => b.toString())).toEqual([
+        "first",
+        "second",
+        "mid",
+        "low",
+      ]);
+
+      // 96 bytes plus a 4-byte prefix: exactly one burst of 100.
+      const gated = createNativePriorityQueue({
+        rateBytesPerSec: 1000,
+        burstBytes: 100,
+        overheadBytes: 4,
+      })!;
+      gated.enqueue(Buffer.alloc(96));
+      gated.enqueue(Buffer.alloc(96));
+      expect(gated.dequeueMany(8)).toHaveLength(1);
+      expect(gated.length).toBe(1);
+      const wait = gated.waitMs();
+      expect(wait).toBeGreaterThan(50);
+      expect(wait).toBeLessThanOrEqual(100);
+      expect(gated.snapshot().totalDequeued).toBe(1);
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with native coherence kernels", () => {
+    it("matches the JS math on fields large enough to use them", () => {
+      const n = NATIVE_MATRIX_MIN_ROWS;
+      const matrix = Array.from({ length: n }, (_, i) =>
+        Array.from({ length: n }, (_, j) => (j === (i + 1) % n ? 3 : j === i ? -1 : 0.5)),
+      );
+      expect(normalizeRowsNative(matrix)).not.toBeNull();
+      const topology = normalizeTopologyRows(matrix);
+      for (const row of topology) {
+        expect(row.reduce((sum, v) => sum + v, 0)).toBeCloseTo(1, 12);
+        expect(Math.min(...row)).toBe(0);
+      }
+      expect(topology[0][1]).toBeCloseTo(3 / (3 + 0.5 * (n - 2)), 12);
+
+      const a = Array.from({ length: 64 }, (_, i) => (i % 7) - 3);
+      const b = Array.from({ length: 64 }, (_, i) => ((i * 3) % 5) - 2);
+      const dot = a.reduce((sum, x, i) => sum + x * b[i], 0);
+      const norm = (v: number[]) => Math.sqrt(v.reduce((sum, x) => sum + x * x, 0));
+      expect(cosineSimilarity(a, b)).toBeCloseTo(dot / (norm(a) * norm(b)), 12);
+
+      const params = { m: 5, n1: 2, n2: 3, n3: 3, a: 1, b: 1 };
+      const radii = generateSuperformulaRadii([params], 48);
+      generateSuperformulaPoints(params, 48).forEach((point, i) =>
+        expect(radii[i]).toBeCloseTo(point.radius, 12),
+      );
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with a native trace recorder", () => {
+    it("writes a memory-mapped trace the reader views in place", () => {
+      const dir = fs.mkdtempSync(path.join(os.tmpdir(), "qwtrace-"));
+      const file = path.join(dir, "native.qwtrace");
+      try {
+        // Starts small so the mapping has to grow.
+        const recorder = new TelemetryTraceRecorder(file, { blockRows: 4, initialBytes: 256 });
+        expect(recorder.native).toBe(true);
+        for (let i = 0; i < 10; i += 1) {
+          recorder.record("flush", [100 + i, 1024 * i, 2], "lws");
+        }
+        recorder.record("backpressure", [104]);
+        recorder.close();
+
+        const trace = openTelemetryTrace(file);
+        expect(trace.indexed).toBe(true);
+        expect(trace.blocks.map(block => [block.schema, block.rows])).toEqual([
+          ["flush", 4],
+          ["flush", 4],
+          ["flush", 2],
+          ["backpressure", 1],
+        ]);
+        expect(Array.from(trace.column("flush", "bytes", "lws"))).toEqual(
+          Array.from({ length: 10 }, (_, i) => 1024 * i),
+        );
+      } finally {
+        fs.rmSync(dir, { recursive: true, force: true });
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("lws"))("with a native latency histogram", () => {
+    it("agrees with the JS histogram to within a bucket", () => {
+      const native = new LatencyHistogram();
+      const js = new LatencyHistogram({ native: false });
+      expect(native.native).toBe(true);
+      for (let i = 1; i <= 10_000; i += 1) {
+        native.record(i / 1000);
+        js.record(i / 1000);
+      }
+
+      const got = native.summary();
+      const want = js.summary();
+      expect(got.count).toBe(10_000);
+      expect(got.min).toBeCloseTo(want.min, 6);
+      expect(got.max).toBeCloseTo(want.max, 6);
+      expect(got.mean).toBeCloseTo(want.mean, 3);
+      for (const q of ["p50", "p90", "p99", "p999"] as const) {
+        expect(Math.abs(got[q] - want[q]) / want[q]).toBeLessThan(0.01);
+      }
+      expect(native.buckets().reduce((sum, [, , count]) => sum + count, 0)).toBe(10_000);
+
+      native.reset();
+      expect(native.summary()).toMatchObject({ count: 0, max: 0 });
+    });
+  });
+
+  describe.skipIf(!getNativeDiscovery())("with native discovery", () => {
+    it.runIf(process.platform === "linux")(
+      "filters the group natively and hands over only foreign announcements",
+      async () => {
+        const group = "239.255.67.98";
+        const port = 40000 + Math.floor(Math.random() * 20000);
+        const self = { id: "self", host: "127.0.0.1", port: 7000, negentropicIndex: 0.4 };
+        const node = Object.assign(new EventEmitter(), { getSelfPeer: () => self });
+        const discovery = new DiscoveryModule(node as never, {
+          port,
+          group,
+          interface: "lo",
+          native: true,
+          batchMs: 10,
+        });
+        const peer = dgram.createSocket("udp4");
+        try {
+          const ready = waitForEvent(node, "discovery:ready");
+          discovery.start();
+          await ready;
+          await new Promise<void>(resolve => peer.bind(0, "127.0.0.1", resolve));
+          peer.setMulticastInterface("127.0.0.1");
+
+          const found = waitForEvent<{ id: string }>(discovery, "peer:discovered");
+          peer.send("not an announcement", port, group);
+          peer.send(
+            JSON.stringify({ magic: "SIGILNET_DISCOVERY_v1", id: "other", host: "127.0.0.1", port: 7001 }),
+            port,
+            group,
+          );
+          expect((await found).id).toBe("other");
+
+          const deadline = Date.now() + TEST_WAIT_MS * 5;
+          while (!discovery.getStats()?.selfEchoes && Date.now() < deadline) {
+            await new Promise(resolve => setTimeout(resolve, 10));
+          }
+          expect(discovery.getStats()).toMatchObject({ filtered: 1, emitted: 1 });
+          expect(discovery.getStats()!.selfEchoes).toBeGreaterThanOrEqual(1);
+        } finally {
+          discovery.stop();
+          peer.close();
+        }
+      },
+    );
+  });
+
+  describe.skipIf(!getNativeIdService())("with the native id service", () => {
+    it("issues time-ordered ids from the addon", () => {
+      const ids = Array.from({ length: 10_000 }, () => nextId());
+      expect(new Set(ids).size).toBe(ids.length);
+      expect(ids.every((id, i) => i === 0 || id > ids[i - 1])).toBe(true);
+      // 41 bits of ms since 2024-01-01 on top.
+      const issuedAt = Number(ids[0] >> 23n) + Date.UTC(2024, 0, 1);
+      expect(Math.abs(issuedAt - Date.now())).toBeLessThan(5000);
+
+      setIdNode(5);
+      expect(Number((nextId() >> 4n) & 511n)).toBe(5);
+
+      const buffer = Buffer.alloc(WIDE_ID_BYTES * 3);
+      expect(fillIds(buffer)).toBe(3);
+      const wide = [0, 1, 2].map(i => buffer.subarray(i * WIDE_ID_BYTES, (i + 1) * WIDE_ID_BYTES));
+      expect(Buffer.compare(wide[0], wide[1])).toBe(-1);
+      expect(Buffer.compare(wide[1], wide[2])).toBe(-1);
+      expect(wide[0].subarray(8).equals(wide[2].subarray(8))).toBe(true);
+    });
+  });
+
+  describe.skipIf(!isNativeUnixDgramAvailable())("with a native unix datagram socket", () => {
+    it("delivers batched datagrams with the sender's path", async () => {
+      const dir = fs.mkdtempSync(path.join(os.tmpdir(), "qwdgram-"));
+      const collector = new NativeUnixDatagramSocket();
+      const reporter = new NativeUnixDatagramSocket();
+      try {
+        const collectorPath = path.join(dir, "collector.sock");
+        const reporterPath = path.join(dir, "reporter.sock");
+        await waitForEvent(collector.bind(collectorPath), "listening");
+        await waitForEvent(reporter.bind(reporterPath), "listening");
+
+        const seen: Array<{ data: string; path: string }> = [];
+        const both = new Promise<void>(resolve =>
+          collector.on("message", (msg: Buffer, info: { path: string }) => {
+            seen.push({ data: msg.toString(), path: info.path });
+            if (seen.length === 2) resolve();
+          }),
+        );
+        reporter.send("cpu=3", collectorPath);
+        reporter.send(Buffer.from("mem=7"), collectorPath);
+        await both;
+        expect(seen).toEqual([
+          { data: "cpu=3", path: reporterPath },
+          { data: "mem=7", path: reporterPath },
+        ]);
+        expect(reporter.getStats()).toMatchObject({ datagramsOut: 2 });
+        expect(collector.getStats()).toMatchObject({ datagramsIn: 2 });
+      } finally {
+        collector.close();
+        reporter.close();
+        fs.rmSync(dir, { recursive: true, force: true });
+      }
+    });
+  });
+
+  describe.skipIf(!isNativeServerAvailable("libsocket"))("with a dual-stack listener", () => {
+    it("reports IPv4 peers of an IPv6 listener unmapped", async () => {
+      const server = new NativeQWormholeServer(
+        { host: "::", port: 0, deserializer: textDeserializer },
+        "libsocket",
+      );
+      const address = await server.listen();
+      expect(address.address).toBe("::");
+      expect(address.family).toBe("IPv6");
+      const client = new QWormholeClient<string>({
+        host: "127.0.0.1",
+        port: address.port,
+        deserializer: textDeserializer,
+      });
+      try {
+        const connected = waitForEvent<{ remoteAddress?: string; remoteFamily?: string }>(
+          server,
+          "connection",
+        );
+        await client.connect();
+        const connection = await connected;
+        expect(connection.remoteAddress).toBe("127.0.0.1");
+        expect(connection.remoteFamily).toBe("IPv4");
+      } finally {
+        await client.disconnect();
+        await server.close();
+      }
+    });
+  });
+
   describe.skipIf(nativeAvailable)("without native server", () => {
     it("skips tests when native server is unavailable", () => {
       console.log("[native-server-smoke] Native server not available, skipping tests");
@@ -0,0 +1,104 @@
+import { describe, it, expect } from "vitest";
+import {
+  NativeStatsStreamDecoder,
+  openNativeStatsStream,
+  STATS_STREAM_PROTOCOL,
+  type NativeStatsStreamSchema,
+} from "../src/core/native-stats-stream.js";
+
+const schema: NativeStatsStreamSchema = {
+  type: "qw:stats-schema",
+  version: 1,
+  intervalMs: 50,
+  global: ["connections", "bytesWritten"],
+  connection: ["bytesSent", "queuedBytes"],
+};
+
+// The server's framing: header, then zigzag varint deltas.
+const frame = (
+  at: number,
+  first: boolean,
+  global: number[],
+  changed: Array<[number, number[]]>,
+  closed: number[],
+): Uint8Array => {
+  const out: number[] = [1, first ? 1 : 0, 0, 0];
+  const stamp = new DataView(new ArrayBuffer(8));
+  stamp.setFloat64(0, at, true);
+  out.push(...new Uint8Array(stamp.buffer));
+  const varint = (value: number) => {
+    while (value >= 0x80) {
+      out.push((value % 128) | 0x80);
+      value = Math.floor(value / 128);
+    }
+    out.push(value);
+  };
+  const delta = (value: number) => varint(value < 0 ? -value * 2 - 1 : value * 2);
+  global.forEach(delta);
+  varint(changed.length);
+  for (const [handle, deltas] of changed) {
+    varint(handle);
+    deltas.forEach(delta);
+  }
+  varint(closed.length);
+  closed.forEach(varint);
+  return new Uint8Array(out);
+};
+
+describe("native stats stream", () => {
+  it("sums deltas into running global and per-connection values", () => {
+    const decoder = new NativeStatsStreamDecoder(schema);
+    const handle = 2 ** 40 + 3;
+    const one = decoder.decode(
+      frame(1000, true, [2, 5_000_000_000], [[7, [10, 64]], [handle, [1, 0]]], []),
+    );
+    expect(one).toMatchObject({ atMs: 1000, first: true, changed: [7, handle], closed: [] });
+    expect(one.global).toEqual({ connections: 2, bytesWritten: 5_000_000_000 });
+    expect(one.connections.get(7)).toEqual({ bytesSent: 10, queuedBytes: 64 });
+
+    const two = decoder.decode(frame(1050, false, [-1, 200], [[7, [30, -64]]], [handle]));
+    expect(two.first).toBe(false);
+    expect(two.global).toEqual({ connections: 1, bytesWritten: 5_000_000_200 });
+    expect(two.connections.get(7)).toEqual({ bytesSent: 40, queuedBytes: 0 });
+    expect(two.connections.has(handle)).toBe(false);
+    expect(two.closed).toEqual([handle]);
+  });
+
+  it("rejects other versions and truncated frames", () => {
+    expect(() => new NativeStatsStreamDecoder({ ...schema, version: 2 })).toThrow(/version/);
+    const decoder = new NativeStatsStreamDecoder(schema);
+    expect(() => decoder.decode(frame(0, true, [1, 1], [], []).subarray(0, 13))).toThrow(
+      /Truncated/,
+    );
+  });
+
+  it("reads the schema message and then decodes binary frames", () => {
+    const frames: number[] = [];
+    class FakeSocket extends EventTarget {
+      static last: FakeSocket;
+      binaryType = "blob";
+      constructor(
+        readonly url: string,
+        readonly protocol: string,
+      ) {
+        super();
+        FakeSocket.last = this;
+      }
+      deliver(data: unknown) {
+        this.dispatchEvent(Object.assign(new Event("message"), { data }));
+      }
+    }
+    openNativeStatsStream(
+      "ws://127.0.0.1:9464/",
+      update => frames.push(update.global.connections),
+      FakeSocket as never,
+    );
+    const socket = FakeSocket.last;
+    expect(socket.protocol).toBe(STATS_STREAM_PROTOCOL);
+    expect(socket.binaryType).toBe("arraybuffer");
+    socket.deliver(frame(0, true, [1, 0], [], []).buffer);
+    socket.deliver(JSON.stringify(schema));
+    socket.deliver(frame(0, true, [3, 0], [], []).buffer);
+    expect(frames).toEqual([3]);
+  });
+});
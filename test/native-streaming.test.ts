@@ -0,0 +1,161 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+type Chunk = { streamId: number; data: string; bits: number };
+
+class StreamServer extends FakeServerWrapper {
+  static last: StreamServer | undefined;
+  chunks: Array<Chunk & { id: string | number }> = [];
+  pressured = false;
+
+  sendStreamChunk(id: string | number, streamId: number, data: Buffer, bits: number) {
+    if (id === "gone") return undefined;
+    this.chunks.push({ id, streamId, data: data.toString(), bits });
+    return !this.pressured;
+  }
+}
+
+type NativeEvent = { type: string; data?: Buffer };
+
+class StreamClient extends FakeTcpClientWrapper<NativeEvent> {
+  static last: StreamClient | undefined;
+  chunks: Chunk[] = [];
+  pressured = false;
+
+  rpcRequest() {
+    return 1;
+  }
+  sendStreamChunk(streamId: number, data: Buffer, bits: number) {
+    this.chunks.push({ streamId, data: data.toString(), bits });
+    return !this.pressured;
+  }
+}
+
+const withStreams = (name: string) =>
+  withBinding(bindingFactory, name, {
+    QWormholeServerWrapper: StreamServer,
+    TcpClientWrapper: StreamClient,
+  });
+
+const chunkFrame = (streamId: number, bits: number, data: string) => {
+  const frame = Buffer.alloc(8 + data.length);
+  frame.writeUInt32BE(streamId, 0);
+  frame[4] = bits;
+  frame.write(data, 8);
+  return frame;
+};
+
+describe("native streaming", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    StreamServer.last = undefined;
+    StreamClient.last = undefined;
+  });
+
+  it("routes stream chunks and waits for drain between chunks", async () => {
+    withStreams("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, framing: "length-prefixed", streaming: true },
+      "lws",
+    );
+    const native = StreamServer.last!;
+    expect(native.options.streaming).toBe(true);
+
+    const events: Array<Record<string, unknown>> = [];
+    server.on("stream", event => events.push(event as never));
+    const snapshot = { id: "conn-1", handle: 1, remoteAddress: "127.0.0.1", remotePort: 4000 };
+    native.emit("connection", snapshot);
+    native.emit("stream", {
+      client: snapshot,
+      streamId: 7,
+      first: true,
+      last: false,
+      aborted: false,
+      data: Buffer.from("abc"),
+    });
+    native.emit("stream", { client: { id: "gone" }, streamId: 1, data: Buffer.alloc(0) });
+    expect(events).toHaveLength(1);
+    expect((events[0].client as { id: string }).id).toBe("conn-1");
+    expect(events[0]).toMatchObject({ streamId: 7, first: true, last: false });
+
+    native.pressured = true;
+    let done = false;
+    const sent = server.sendStream("conn-1", [Buffer.from("hello"), "world"], { chunkBytes: 4 }).then(id => {
+      done = true;
+      return id;
+    });
+    await new Promise(resolve => setImmediate(resolve));
+    expect(done).toBe(false);
+    expect(native.chunks).toHaveLength(1);
+    native.pressured = false;
+    native.emit("drain", { client: snapshot });
+    await expect(sent).resolves.toBe(1);
+    expect(native.chunks.map(c => [c.data, c.bits])).toEqual([
+      ["hell", 1],
+      ["o", 0],
+      ["worl", 0],
+      ["d", 2],
+    ]);
+
+    await expect(server.sendStream("gone", ["x"])).rejects.toThrow(/Unknown connection/);
+  });
+
+  it("chunks client streams, decodes stream events and aborts on a failing source", async () => {
+    withStreams("qwormhole_lws");
+    const { NativeTcpClient, NativeEventCode } = await import("../src/core/NativeTCPClient.js");
+    const client = new NativeTcpClient("lws");
+    client.connect({ host: "127.0.0.1", port: 9000, framing: "length-prefixed", streaming: true });
+    const native = StreamClient.last!;
+    expect(native.connect).toHaveBeenCalledWith(expect.objectContaining({ streaming: true }));
+
+    const received: Array<Record<string, unknown>> = [];
+    client.setEventHandler(evt => received.push(evt as never));
+    native.handler!({ type: "stream", data: chunkFrame(3, 2, "tail") });
+    expect(received[0]).toMatchObject({ type: "stream", streamId: 3, first: false, last: true });
+    expect((received[0].data as Buffer).toString()).toBe("tail");
+
+    await expect(client.sendStream([])).resolves.toBe(1);
+    expect(native.chunks).toEqual([{ streamId: 1, data: "", bits: 3 }]);
+
+    native.chunks = [];
+    native.pressured = true;
+    const sent = client.sendStream(["abcdef"], { chunkBytes: 3 });
+    await new Promise(resolve => setImmediate(resolve));
+    expect(native.chunks).toHaveLength(1);
+    native.handler!({ type: "drain" });
+    await expect(sent).resolves.toBe(2);
+    expect(native.chunks.map(c => c.bits)).toEqual([1, 2]);
+
+    native.chunks = [];
+    native.pressured = false;
+    async function* failing() {
+      yield "one";
+      yield "two";
+      throw new Error("source failed");
+    }
+    await expect(client.sendStream(failing(), { chunkBytes: 8 })).rejects.toThrow("source failed");
+    expect(native.chunks.map(c => [c.data, c.bits])).toEqual([
+      ["one", 1],
+      ["", 4],
+    ]);
+    expect(NativeEventCode.Stream).toBe(11);
+  });
+
+  it("refuses streaming on libsocket", async () => {
+    withStreams("qwormhole");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    expect(
+      () => new NativeQWormholeServer({ host: "127.0.0.1", port: 0, streaming: true }, "libsocket"),
+    ).toThrow(/streaming/);
+  });
+});
@@ -0,0 +1,54 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+const sample = [
+  // handle, sampledAt, rtt, rttVar, minRtt, cwnd, mss, unacked, lost,
+  // retransmits, pacingRate, deliveryRate
+  7, 1_700_000_000_000, 850, 120, 400, 10, 1448, 2, 0, 1, 2_500_000, 1_800_000,
+  9, 1_700_000_000_001, 9000, 3000, 410, 4, 1448, 4, 1, 6, 400_000, 250_000,
+];
+
+class PathServer extends FakeServerWrapper {
+  static last: PathServer | undefined;
+  getPathSnapshot = vi.fn(() => Float64Array.from(sample));
+
+  broadcast() {}
+}
+
+describe("native TCP path telemetry", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    withBinding(bindingFactory, "qwormhole_lws", {
+      QWormholeServerWrapper: PathServer,
+    });
+  });
+
+  it("passes the sampling interval and unpacks the snapshot", async () => {
+    const { NativeQWormholeServer, NativePathField, readPathSnapshot } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, tcpInfoIntervalMs: 250 },
+      "lws",
+    );
+    expect(PathServer.last!.options.tcpInfoIntervalMs).toBe(250);
+
+    const snapshot = server.getPathSnapshot()!;
+    expect(snapshot.length).toBe(2 * NativePathField.Stride);
+    const paths = readPathSnapshot(snapshot);
+    expect([...paths.keys()]).toEqual([7, 9]);
+    expect(paths.get(7)).toMatchObject({ rttUs: 850, minRttUs: 400, cwnd: 10 });
+    expect(paths.get(9)).toMatchObject({
+      rttVarUs: 3000,
+      lost: 1,
+      retransmits: 6,
+      deliveryRate: 250_000,
+    });
+  });
+});
@@ -0,0 +1,96 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class StampServer extends FakeServerWrapper {
+  static last: StampServer | undefined;
+  probes: Array<{ id: string | number; probe: number; data: string }> = [];
+  samples: number[][] = [];
+
+  getTimestampStats() {
+    return { mode: "software", rxStamped: 3 };
+  }
+
+  sendClockProbe(id: string | number, probe: number, data: Buffer) {
+    this.probes.push({ id, probe, data: data.toString() });
+    return true;
+  }
+
+  addClockSample(_id: string | number, probe: number, t2: number, t3: number, t4: number) {
+    this.samples.push([probe, t2, t3, t4]);
+    return { offsetUs: 25, rttUs: 80, samples: this.samples.length };
+  }
+}
+
+const withStamps = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: StampServer });
+
+const snapshot = { id: "conn-1", handle: 1, remoteAddress: "127.0.0.1", remotePort: 4000 };
+const stamps = { kernelUs: 1000, nativeUs: 1010, emittedUs: 1012 };
+
+describe("native timestamping", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    StampServer.last = undefined;
+  });
+
+  it("forwards receive stamps and answers syncClock() from the reply", async () => {
+    withStamps("qwormhole");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    const { encodeClockReply } = await import("../src/core/native-timestamps.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, timestamping: "software" },
+      "libsocket",
+    );
+    const native = StampServer.last!;
+    expect(native.options.timestamping).toBe("software");
+    expect(server.getTimestampStats()).toMatchObject({ mode: "software", rxStamped: 3 });
+
+    const messages: Array<Record<string, unknown>> = [];
+    server.on("message", event => messages.push(event as never));
+    native.emit("connection", snapshot);
+    native.emit("message", { client: snapshot, data: Buffer.from("hi"), timestamps: stamps });
+    expect(messages[0].timestamps).toEqual(stamps);
+
+    const synced = server.syncClock("conn-1");
+    expect(native.probes).toEqual([
+      { id: "conn-1", probe: 1, data: '{"type":"qw:clock","probe":1}' },
+    ]);
+    native.emit("message", {
+      client: snapshot,
+      data: encodeClockReply(1, 1500, 1501),
+      timestamps: stamps,
+    });
+    await expect(synced).resolves.toEqual({ offsetUs: 25, rttUs: 80, samples: 1 });
+    expect(native.samples).toEqual([[1, 1500, 1501, 1000]]);
+    expect(messages).toHaveLength(1);
+
+    const late = server.syncClock("conn-1", { timeoutMs: 5 });
+    await expect(late).rejects.toThrow(/timed out/);
+    await expect(server.syncClock("gone")).rejects.toThrow(/Unknown connection/);
+  });
+
+  it("cuts latency at each stamp and refuses timestamping on lws", async () => {
+    const { readClockProbe, splitLatency } = await import("../src/core/native-timestamps.js");
+    expect(readClockProbe(Buffer.from('{"type":"qw:clock","probe":4}'))).toMatchObject({ probe: 4 });
+    expect(readClockProbe(Buffer.from('{"type":"ping"}'))).toBeUndefined();
+    expect(splitLatency(500, stamps, 1100)).toEqual({
+      wireMs: 0.5,
+      kernelMs: 0.01,
+      nativeMs: 0.002,
+      jsMs: 0.088,
+    });
+
+    withStamps("qwormhole_lws");
+    const { NativeQWormholeServer } = await import("../src/core/native-server.js");
+    expect(
+      () => new NativeQWormholeServer({ host: "127.0.0.1", port: 0, timestamping: true }, "lws"),
+    ).toThrow(/timestamping/);
+  });
+});
@@ -0,0 +1,125 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+type Emit = (event: string, payload?: unknown) => boolean;
+
+class FakeUdpSocket {
+  static last: FakeUdpSocket | undefined;
+  emit?: Emit;
+  batches: unknown[][] = [];
+  closed = false;
+
+  constructor(public readonly opts: Record<string, unknown>) {
+    FakeUdpSocket.last = this;
+  }
+
+  async bind() {
+    this.emit?.("listening", this.address());
+    return this.address();
+  }
+
+  address() {
+    return { address: "0.0.0.0", port: 41000, family: "IPv4" };
+  }
+
+  send() {
+    return true;
+  }
+
+  sendBatch(datagrams: unknown[]) {
+    this.batches.push(datagrams);
+    return datagrams.length;
+  }
+
+  sendSegments() {
+    return 0;
+  }
+
+  getStats() {
+    return { datagramsIn: 0, batchesIn: 0, datagramsOut: 0 };
+  }
+
+  close() {
+    this.closed = true;
+    this.emit?.("close");
+  }
+}
+
+describe("native datagram socket", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeUdpSocket.last = undefined;
+    withBinding(bindingFactory, "qwormhole", {
+      TcpClientWrapper: vi.fn(),
+      QWormholeUdpSocket: FakeUdpSocket,
+    });
+  });
+
+  it("coalesces a tick's sends into one sendBatch", async () => {
+    const { NativeDatagramSocket } =
+      await import("../src/transports/udp/native-udp.js");
+    const socket = new NativeDatagramSocket({ batchSize: 64 });
+    const listening = vi.fn();
+    socket.on("listening", listening);
+    socket.bind(0);
+    expect(FakeUdpSocket.last!.opts).toMatchObject({ port: 0, batchSize: 64 });
+
+    const payload = Buffer.from("abcdef");
+    socket.send(payload, 0, 3, 9000, "10.0.0.1");
+    socket.send(payload, 3, 3, 9001, "10.0.0.2");
+    expect(FakeUdpSocket.last!.batches).toHaveLength(0);
+
+    await Promise.resolve();
+    expect(listening).toHaveBeenCalledOnce();
+    const [batch] = FakeUdpSocket.last!.batches as Array<
+      Array<{ data: Buffer; port: number; address: string }>
+    >;
+    expect(batch.map(d => d.data.toString())).toEqual(["abc", "def"]);
+    expect(batch.map(d => d.port)).toEqual([9000, 9001]);
+  });
+
+  it("delivers native batches as dgram-style messages", async () => {
+    const { NativeDatagramSocket } =
+      await import("../src/transports/udp/native-udp.js");
+    const socket = new NativeDatagramSocket();
+    socket.bind(0);
+    const seen: Array<{ data: string; port: number; size: number }> = [];
+    const batches = vi.fn();
+    socket.on("message", (msg: Buffer, rinfo: { port: number; size: number }) =>
+      seen.push({ data: msg.toString(), port: rinfo.port, size: rinfo.size }),
+    );
+    socket.on("messages", batches);
+
+    FakeUdpSocket.last!.emit!("messages", [
+      { data: Buffer.from("one"), address: "10.0.0.1", port: 1 },
+      { data: Buffer.from("two!"), address: "10.0.0.1", port: 2 },
+    ]);
+    expect(batches).toHaveBeenCalledOnce();
+    expect(seen).toEqual([
+      { data: "one", port: 1, size: 3 },
+      { data: "two!", port: 2, size: 4 },
+    ]);
+
+    socket.close();
+    expect(FakeUdpSocket.last!.closed).toBe(true);
+  });
+
+  it("falls back to node:dgram without the addon", async () => {
+    bindingFactory.mockImplementation(() => {
+      throw new Error("missing");
+    });
+    const { createDatagramSocket, isNativeUdpAvailable, NativeDatagramSocket } =
+      await import("../src/transports/udp/native-udp.js");
+    expect(isNativeUdpAvailable()).toBe(false);
+    const socket = createDatagramSocket({ native: true });
+    expect(socket).not.toBeInstanceOf(NativeDatagramSocket);
+    socket.close();
+  });
+});
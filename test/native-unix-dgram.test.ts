@@ -0,0 +1,120 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+type Emit = (event: string, payload?: unknown) => boolean;
+
+class FakeUnixDgram {
+  static last: FakeUnixDgram | undefined;
+  emit?: Emit;
+  batches: unknown[][] = [];
+  closed = false;
+
+  constructor(public readonly opts: Record<string, unknown>) {
+    FakeUnixDgram.last = this;
+  }
+
+  async bind() {
+    this.emit?.("listening", this.address());
+    return this.address();
+  }
+
+  address() {
+    return { path: String(this.opts.path ?? ""), receiveBufferBytes: 0, sendBufferBytes: 0 };
+  }
+
+  send() {
+    return true;
+  }
+
+  sendBatch(datagrams: unknown[]) {
+    this.batches.push(datagrams);
+    return datagrams.length;
+  }
+
+  getStats() {
+    return { datagramsIn: 0, batchesIn: 0, datagramsOut: 0, wouldBlock: 0, maxDgramQlen: 512 };
+  }
+
+  close() {
+    this.closed = true;
+    this.emit?.("close");
+  }
+}
+
+describe("native unix datagram socket", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeUnixDgram.last = undefined;
+    withBinding(bindingFactory, "qwormhole", {
+      TcpClientWrapper: vi.fn(),
+      QWormholeUnixDgram: FakeUnixDgram,
+    });
+  });
+
+  it("coalesces a tick's sends into one sendBatch", async () => {
+    const { NativeUnixDatagramSocket } = await import("../src/transports/udp/unix-dgram.js");
+    const socket = new NativeUnixDatagramSocket({ batchSize: 64, receiveBufferBytes: 1 << 20 });
+    const listening = vi.fn();
+    socket.on("listening", listening);
+    socket.bind("\0qwormhole-telemetry");
+    expect(FakeUnixDgram.last!.opts).toMatchObject({
+      path: "\0qwormhole-telemetry",
+      batchSize: 64,
+      receiveBufferBytes: 1 << 20,
+    });
+
+    socket.send("cpu=3", "/run/collector.sock");
+    socket.send(Buffer.from("mem=7"));
+    expect(FakeUnixDgram.last!.batches).toHaveLength(0);
+
+    await Promise.resolve();
+    expect(listening).toHaveBeenCalledOnce();
+    const [batch] = FakeUnixDgram.last!.batches as Array<Array<{ data: Buffer; path?: string }>>;
+    expect(batch.map(d => d.data.toString())).toEqual(["cpu=3", "mem=7"]);
+    expect(batch.map(d => d.path)).toEqual(["/run/collector.sock", undefined]);
+    expect(socket.getStats()).toMatchObject({ maxDgramQlen: 512 });
+  });
+
+  it("delivers native batches with the sender path", async () => {
+    const { NativeUnixDatagramSocket } = await import("../src/transports/udp/unix-dgram.js");
+    const socket = new NativeUnixDatagramSocket();
+    socket.bind("/tmp/qwormhole.sock");
+    const seen: Array<{ data: string; path: string; size: number }> = [];
+    const batches = vi.fn();
+    socket.on("message", (msg: Buffer, info: { path: string; size: number }) =>
+      seen.push({ data: msg.toString(), path: info.path, size: info.size }),
+    );
+    socket.on("messages", batches);
+
+    FakeUnixDgram.last!.emit!("messages", [
+      { data: Buffer.from("one"), path: "/tmp/a.sock" },
+      { data: Buffer.from("two!"), path: "" },
+    ]);
+    expect(batches).toHaveBeenCalledOnce();
+    expect(seen).toEqual([
+      { data: "one", path: "/tmp/a.sock", size: 3 },
+      { data: "two!", path: "", size: 4 },
+    ]);
+
+    socket.close();
+    expect(FakeUnixDgram.last!.closed).toBe(true);
+  });
+
+  it("throws without the addon", async () => {
+    bindingFactory.mockImplementation(() => {
+      throw new Error("missing");
+    });
+    const { createUnixDatagramSocket, isNativeUnixDgramAvailable } = await import(
+      "../src/transports/udp/unix-dgram.js"
+    );
+    expect(isNativeUnixDgramAvailable()).toBe(false);
+    expect(() => createUnixDatagramSocket()).toThrow(/libsocket/);
+  });
+});
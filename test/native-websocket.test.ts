@@ -0,0 +1,75 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class WebSocketServer extends FakeServerWrapper {
+  static last: WebSocketServer | undefined;
+
+  broadcast() {}
+}
+
+const withServerBinding = (name: string) =>
+  withBinding(bindingFactory, name, { QWormholeServerWrapper: WebSocketServer });
+
+describe("native server websocket mode", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    WebSocketServer.last = undefined;
+  });
+
+  it("passes websocket options through to the lws wrapper", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    new NativeQWormholeServer(
+      {
+        host: "127.0.0.1",
+        port: 0,
+        websocket: { protocol: "qw-test", deflate: true, fragmentBytes: 16384 },
+      },
+      "lws",
+    );
+    expect(WebSocketServer.last!.options.websocket).toEqual({
+      protocol: "qw-test",
+      deflate: true,
+      fragmentBytes: 16384,
+    });
+  });
+
+  it("delivers each websocket message as a server message", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0, websocket: true },
+      "lws",
+    );
+    const native = WebSocketServer.last!;
+    const messages: unknown[] = [];
+    server.on("message", event => messages.push((event as { data: unknown }).data));
+
+    const snapshot = { id: "ws-1", remoteAddress: "127.0.0.1", remotePort: 1 };
+    native.emit("connection", snapshot);
+    native.emit("message", { client: snapshot, data: Buffer.from("hello") });
+    expect(messages).toHaveLength(1);
+  });
+
+  it("rejects websocket mode on the libsocket backend", async () => {
+    withServerBinding("qwormhole");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    expect(
+      () =>
+        new NativeQWormholeServer(
+          { host: "127.0.0.1", port: 0, websocket: true },
+          "libsocket",
+        ),
+    ).toThrow(/WebSocket/);
+  });
+});
@@ -0,0 +1,87 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class WorkerServer extends FakeServerWrapper {
+  static last: WorkerServer | undefined;
+  enableWorkerDelivery = vi.fn(() => "qwsink-test-1");
+  disableWorkerDelivery = vi.fn();
+
+  broadcast() {}
+}
+
+const attachMessageSink = vi.fn(() => true);
+const detachMessageSink = vi.fn(() => true);
+
+const withServerBinding = (name: string) =>
+  withBinding(
+    bindingFactory,
+    name,
+    name === "qwormhole_lws"
+      ? {
+          QWormholeServerWrapper: WorkerServer,
+          attachMessageSink,
+          detachMessageSink,
+        }
+      : { QWormholeServerWrapper: FakeServerWrapper },
+  );
+
+describe("native worker delivery", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    attachMessageSink.mockClear();
+    detachMessageSink.mockClear();
+    WorkerServer.last = undefined;
+  });
+
+  it("hands out the native token for workers to attach with", async () => {
+    withServerBinding("qwormhole_lws");
+    const { NativeQWormholeServer } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0 },
+      "lws",
+    );
+
+    expect(server.enableWorkerDelivery(4)).toBe("qwsink-test-1");
+    expect(WorkerServer.last!.enableWorkerDelivery).toHaveBeenCalledWith(4);
+    server.disableWorkerDelivery();
+    expect(WorkerServer.last!.disableWorkerDelivery).toHaveBeenCalledOnce();
+  });
+
+  it("attaches and detaches sinks through the lws addon", async () => {
+    withServerBinding("qwormhole_lws");
+    const { attachNativeMessageSink, detachNativeMessageSink } =
+      await import("../src/core/native-server.js");
+    const onMessages = vi.fn();
+
+    expect(attachNativeMessageSink("qwsink-test-1", 2, onMessages)).toBe(true);
+    expect(attachMessageSink).toHaveBeenCalledWith(
+      "qwsink-test-1",
+      2,
+      onMessages,
+    );
+    expect(detachNativeMessageSink("qwsink-test-1", 2)).toBe(true);
+    expect(detachMessageSink).toHaveBeenCalledWith("qwsink-test-1", 2);
+  });
+
+  it("needs the lws backend", async () => {
+    withServerBinding("qwormhole");
+    const { NativeQWormholeServer, attachNativeMessageSink } =
+      await import("../src/core/native-server.js");
+    const server = new NativeQWormholeServer(
+      { host: "127.0.0.1", port: 0 },
+      "libsocket",
+    );
+    expect(() => server.enableWorkerDelivery(2)).toThrow(/lws server backend/);
+    expect(() => attachNativeMessageSink("qwsink-test-1", 0, vi.fn())).toThrow(
+      /lws server backend/,
+    );
+  });
+});
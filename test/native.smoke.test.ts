@@ -108,4 +108,230 @@ describe("NativeTcpClient coverage", () => {
     );
     client.close();
   });
+
+  it("passes coalesce through and forwards per-send flush", async () => {
+    const bindingsMock = vi.fn(
+      (nameOrOpts: string | { bindings: string }) => {
+        const name =
+          typeof nameOrOpts === "string" ? nameOrOpts : nameOrOpts.bindings;
+        if (name === "qwormhole_lws") {
+          return { TcpClientWrapper: MockTcpClientWrapper };
+        }
+        throw new Error("not found");
+      },
+    );
+    vi.stubGlobal("bindings", bindingsMock);
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient");
+    const client = new NativeTcpClient();
+    client.connect({
+      host: "example.com",
+      port: 8080,
+      coalesce: { maxDelayUs: 150, maxBytes: 8192 },
+    });
+    expect(mockImpl.connect).toHaveBeenCalledWith(
+      expect.objectContaining({ coalesce: { maxDelayUs: 150, maxBytes: 8192 } }),
+    );
+    client.send("tick");
+    client.send("urgent", { flush: true });
+    expect(mockImpl.send.mock.calls).toEqual([["tick"], ["urgent", { flush: true }]]);
+    client.close();
+  });
+
+  it("forwards native framing options to the lws binding only", async () => {
+    let lwsAvailable = true;
+    const bindingsMock = vi.fn(
+      (nameOrOpts: string | { bindings: string }) => {
+        const name =
+          typeof nameOrOpts === "string" ? nameOrOpts : nameOrOpts.bindings;
+        if (name === (lwsAvailable ? "qwormhole_lws" : "qwormhole")) {
+          return { TcpClientWrapper: MockTcpClientWrapper };
+        }
+        throw new Error("not found");
+      },
+    );
+    vi.stubGlobal("bindings", bindingsMock);
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient");
+    const client = new NativeTcpClient();
+    client.connect({
+      host: "example.com",
+      port: 8080,
+      framing: "length-prefixed",
+      maxFrameLength: 1024,
+      delivery: "events",
+      rxHighWaterMark: 65_536,
+      zeroCopySend: true,
+      loop: "node",
+    });
+    expect(mockImpl.connect).toHaveBeenCalledWith(
+      expect.objectContaining({
+        framing: "length-prefixed",
+        maxFrameLength: 1024,
+        delivery: "events",
+        rxHighWaterMark: 65_536,
+        zeroCopySend: true,
+        loop: "node",
+      }),
+    );
+
+    lwsAvailable = false;
+    const libsocket = new NativeTcpClient("libsocket");
+    expect(libsocket.backend).toBe("libsocket");
+    expect(() =>
+      libsocket.connect({
+        host: "example.com",
+        port: 8080,
+        framing: "length-prefixed",
+      }),
+    ).toThrow(/native framing/);
+  });
+
+  it("maps native send backpressure onto adapter write/drain", async () => {
+    let handler: ((evt: Record<string, unknown>) => void) | undefined;
+    const eventImpl = {
+      ...mockImpl,
+      send: vi.fn(() => false),
+      sendMany: vi.fn((items: unknown[]) => items.length),
+      isConnected: vi.fn(() => false),
+      setEventHandler: vi.fn((fn: (evt: Record<string, unknown>) => void) => {
+        handler = fn;
+      }),
+    };
+    const bindingsMock = vi.fn(
+      (nameOrOpts: string | { bindings: string }) => {
+        const name =
+          typeof nameOrOpts === "string" ? nameOrOpts : nameOrOpts.bindings;
+        if (name === "qwormhole_lws") {
+          return {
+            TcpClientWrapper: vi.fn(function EventClientCtor() {
+              return eventImpl;
+            }),
+          };
+        }
+        throw new Error("not found");
+      },
+    );
+    vi.stubGlobal("bindings", bindingsMock);
+    const { NativeSocketAdapter } = await import("../src/core/native-socket");
+    const socket = new NativeSocketAdapter({ host: "example.com", port: 8080 });
+    expect(socket.write(Buffer.from("x"))).toBe(false);
+
+    handler?.({ type: "backpressure", queuedBytes: 4096, threshold: 1024 });
+    expect(socket.writableLength).toBe(4096);
+
+    const drained = vi.fn();
+    socket.on("drain", drained);
+    handler?.({ type: "drain" });
+    expect(drained).toHaveBeenCalledTimes(1);
+    expect(socket.writableLength).toBe(0);
+
+    socket.cork();
+    expect(socket.write(Buffer.from("a"))).toBe(true);
+    expect(socket.write(Buffer.from("b"))).toBe(true);
+    socket.uncork();
+    expect(eventImpl.sendMany).toHaveBeenCalledWith([
+      Buffer.from("a"),
+      Buffer.from("b"),
+    ]);
+    socket.destroy();
+  });
+
+  it("prefers numeric event codes when the binding offers them", async () => {
+    type CodeHandler = (code: number, data?: Buffer, arg?: unknown) => void;
+    let handler: CodeHandler | undefined;
+    const eventImpl = {
+      ...mockImpl,
+      isConnected: vi.fn(() => false),
+      setEventHandler: vi.fn(),
+      setEventCodeHandler: vi.fn((fn: CodeHandler) => {
+        handler = fn;
+      }),
+    };
+    const bindingsMock = vi.fn(
+      (nameOrOpts: string | { bindings: string }) => {
+        const name =
+          typeof nameOrOpts === "string" ? nameOrOpts : nameOrOpts.bindings;
+        if (name === "qwormhole_lws") {
+          return {
+            TcpClientWrapper: vi.fn(function EventClientCtor() {
+              return eventImpl;
+            }),
+          };
+        }
+        throw new Error("not found");
+      },
+    );
+    vi.stubGlobal("bindings", bindingsMock);
+    const { NativeSocketAdapter } = await import("../src/core/native-socket");
+    const { NativeEventCode } = await import("../src/core/NativeTCPClient");
+    const socket = new NativeSocketAdapter({ host: "example.com", port: 8080 });
+    expect(eventImpl.setEventCodeHandler).toHaveBeenCalledTimes(1);
+    expect(eventImpl.setEventHandler).not.toHaveBeenCalled();
+
+    const received: Buffer[] = [];
+    socket.on("data", chunk => received.push(chunk));
+    handler?.(NativeEventCode.Data, Buffer.from("hi"));
+    expect(received).toEqual([Buffer.from("hi")]);
+
+    handler?.(NativeEventCode.Backpressure, undefined, 2048, 1024);
+    expect(socket.writableLength).toBe(2048);
+    handler?.(NativeEventCode.Drain, undefined);
+    expect(socket.writableLength).toBe(0);
+
+    const closed = vi.fn();
+    socket.on("close", closed);
+    handler?.(NativeEventCode.Close, undefined, true);
+    expect(closed).toHaveBeenCalledWith(true);
+    socket.destroy();
+  });
+
+  it("spreads pooled clients across pool threads", async () => {
+    const poolHandles: Array<{ opts?: Record<string, unknown> }> = [];
+    const MockTcpClientPool = vi.fn(function MockTcpClientPoolCtor(
+      opts?: Record<string, unknown>,
+    ) {
+      const handle = { opts, close: vi.fn(), getServiceStats: vi.fn() };
+      poolHandles.push(handle);
+      return handle;
+    });
+    const bindingsMock = vi.fn(
+      (nameOrOpts: string | { bindings: string }) => {
+        const name =
+          typeof nameOrOpts === "string" ? nameOrOpts : nameOrOpts.bindings;
+        if (name === "qwormhole_lws") {
+          return {
+            TcpClientWrapper: MockTcpClientWrapper,
+            TcpClientPool: MockTcpClientPool,
+          };
+        }
+        throw new Error("not found");
+      },
+    );
+    vi.stubGlobal("bindings", bindingsMock);
+    const { NativeClientPool, NativeTcpClient } =
+      await import("../src/core/NativeTCPClient");
+    const pool = new NativeClientPool({ threads: 2, tls: { ca: "ca-pem" } });
+    expect(pool.threads).toBe(2);
+    expect(poolHandles[0].opts).toEqual({ tlsCa: Buffer.from("ca-pem") });
+
+    for (let i = 0; i < 3; i++) {
+      const client = new NativeTcpClient(undefined, pool);
+      client.connect({
+        host: "example.com",
+        port: 8080,
+        useTls: true,
+        tls: { ca: "per-client", servername: "peer" },
+      });
+    }
+    const pools = mockImpl.connect.mock.calls.map(
+      call => (call[0] as { pool: unknown }).pool,
+    );
+    expect(pools).toEqual([poolHandles[0], poolHandles[1], poolHandles[0]]);
+    expect(mockImpl.connect.mock.calls[0][0]).not.toHaveProperty("tlsCa");
+    expect(mockImpl.connect.mock.calls[0][0]).toHaveProperty(
+      "tlsServername",
+      "peer",
+    );
+    pool.close();
+    expect(() => pool.acquire()).toThrow(/closed/);
+  });
 });
@@ -11,6 +11,11 @@ type NativeBindingClient = {
   connect: (...args: any[]) => void;
   send: (data: string | Buffer) => void;
   recv: (length?: number) => Buffer;
+  recvInto?: (buffer: Buffer, offset?: number) => number;
+  sendv?: (data: Array<string | Buffer>) => boolean;
+  attachSendRing?: (ring: Uint8Array) => boolean;
+  kickSendRing?: () => void;
+  getConnectTimings?: () => Record<string, unknown> | undefined;
   close: () => void;
 };
 
@@ -39,6 +44,11 @@ function registerBinding(name: string) {
     connect = client.connect;
     send = client.send;
     recv = client.recv;
+    recvInto = client.recvInto;
+    sendv = client.sendv;
+    attachSendRing = client.attachSendRing;
+    kickSendRing = client.kickSendRing;
+    getConnectTimings = client.getConnectTimings;
     close = client.close;
   }
 
@@ -78,6 +88,27 @@ describe("native binding loader", () => {
     });
   });
 
+  it("forwards service-thread placement to the lws backend", async () => {
+    const client = registerBinding("qwormhole_lws");
+    const native = await importNative();
+    const tcp = new native.NativeTcpClient();
+    tcp.connect({ host: "localhost", port: 1234, cpuAffinity: "auto", numaNode: 1 });
+    expect(client.connect).toHaveBeenCalledWith(
+      expect.objectContaining({ cpuAffinity: "auto", numaNode: 1 }),
+    );
+  });
+
+  it("forwards interface binding to both backends", async () => {
+    const lwsClient = registerBinding("qwormhole_lws");
+    const libsocketClient = registerBinding("qwormhole");
+    const native = await importNative();
+    const binding = { interfaceName: "wg0", localAddress: "10.0.0.2", localPort: 4000 };
+    new native.NativeTcpClient("lws").connect({ host: "peer", port: 1, ...binding });
+    new native.NativeTcpClient("libsocket").connect({ host: "peer", port: 2, ...binding });
+    expect(lwsClient.connect).toHaveBeenCalledWith(expect.objectContaining(binding));
+    expect(libsocketClient.connect).toHaveBeenCalledWith(expect.objectContaining(binding));
+  });
+
   it("serializes TLS options for the lws backend", async () => {
     const client = registerBinding("qwormhole_lws");
     const native = await importNative();
@@ -125,6 +156,133 @@ describe("native binding loader", () => {
     expect(client.connect).toHaveBeenCalledWith("mesh.sigil", 8000);
   });
 
+  it("returns the libsocket connect promise and forwards flow limits", async () => {
+    const client = registerBinding("qwormhole");
+    const failed = Promise.reject(new Error("refused"));
+    (client.connect as ReturnType<typeof vi.fn>).mockReturnValueOnce(failed);
+    const native = await importNative();
+    const tcp = new native.NativeTcpClient();
+    const pending = tcp.connect({ host: "mesh.sigil", port: 7001 });
+    expect(pending).toBe(failed);
+    await expect(pending).rejects.toThrow("refused");
+
+    tcp.connect({
+      host: "mesh.sigil",
+      port: 7002,
+      maxBackpressureBytes: 1024,
+      rxHighWaterMark: 2048,
+    });
+    expect(client.connect).toHaveBeenLastCalledWith({
+      host: "mesh.sigil",
+      port: 7002,
+      maxBackpressureBytes: 1024,
+      rxHighWaterMark: 2048,
+    });
+  });
+
+  it("forwards resolver and Happy Eyeballs options and reads connect timings", async () => {
+    const client = registerBinding("qwormhole");
+    const timings = { dnsMs: 0.4, dnsCached: true, attempts: 2, tcpMs: 1.5 };
+    client.getConnectTimings = vi.fn(() => timings);
+    const native = await importNative();
+    const tcp = new native.NativeTcpClient();
+    expect(tcp.getConnectTimings()).toBe(timings);
+
+    tcp.connect({
+      host: "mesh.sigil",
+      port: 7003,
+      connectTimeoutMs: 2000,
+      dnsCacheTtlMs: 0,
+      happyEyeballsDelayMs: 100,
+    });
+    expect(client.connect).toHaveBeenLastCalledWith({
+      host: "mesh.sigil",
+      port: 7003,
+      connectTimeoutMs: 2000,
+      dnsCacheTtlMs: 0,
+      happyEyeballsDelayMs: 100,
+    });
+
+    const lws = registerBinding("qwormhole_lws");
+    vi.resetModules();
+    const lwsNative = await importNative();
+    const lwsTcp = new lwsNative.NativeTcpClient("lws");
+    expect(lwsTcp.getConnectTimings()).toBeUndefined();
+    lwsTcp.connect({ host: "mesh.sigil", port: 7004, dnsCacheTtlMs: 5000 });
+    expect(lws.connect).toHaveBeenLastCalledWith(
+      expect.objectContaining({ host: "mesh.sigil", dnsCacheTtlMs: 5000 }),
+    );
+  });
+
+  it("sendv prefers the binding and falls back to sendMany/send", async () => {
+    const client = registerBinding("qwormhole");
+    const native = await importNative();
+    const tcp = new native.NativeTcpClient();
+    const chunks = [Buffer.from("hdr"), Buffer.from("body")];
+    expect(tcp.sendv(chunks)).toBe(true);
+    expect(client.send).toHaveBeenCalledTimes(2);
+
+    const sendv = vi.fn(() => false);
+    client.sendv = sendv;
+    const gathered = new native.NativeTcpClient();
+    expect(gathered.sendv(chunks)).toBe(false);
+    expect(sendv).toHaveBeenCalledWith(chunks);
+  });
+
+  it("frames send ring writes in shared memory and kicks only an empty ring", async () => {
+    const client = registerBinding("qwormhole_lws");
+    let attached: Uint8Array | undefined;
+    client.attachSendRing = vi.fn((ring: Uint8Array) => {
+      attached = ring;
+      return true;
+    });
+    client.kickSendRing = vi.fn();
+    const native = await importNative();
+    const tcp = new native.NativeTcpClient();
+    const ring = tcp.createSendRing({ capacityBytes: 12 });
+    expect(ring.capacity).toBe(16);
+    expect(attached?.buffer).toBe(ring.buffer);
+
+    const header = new Int32Array(ring.buffer, 0, 16);
+    const data = new Uint8Array(ring.buffer, 64);
+    expect(ring.write("abc")).toBe(true);
+    expect(ring.write(Buffer.from("d"))).toBe(true);
+    expect(client.kickSendRing).toHaveBeenCalledTimes(1);
+    expect(Array.from(data.subarray(0, 7))).toEqual([0, 0, 0, 3, 97, 98, 99]);
+    expect(ring.pending()).toBe(12);
+
+    // The service thread took everything; the next write wraps and kicks.
+    Atomics.store(header, 1, 12);
+    expect(ring.write("efgh")).toBe(true);
+    expect(client.kickSendRing).toHaveBeenCalledTimes(2);
+    expect(Array.from(data.subarray(12, 16))).toEqual([0, 0, 0, 4]);
+    expect(Buffer.from(data.subarray(0, 4)).toString()).toBe("efgh");
+    expect(ring.write(Buffer.alloc(9))).toBe(false);
+
+    Atomics.store(header, 3, 1);
+    expect(ring.closed).toBe(true);
+    expect(ring.write("x")).toBe(false);
+  });
+
+  it("recvInto uses the binding when present and falls back to recv()", async () => {
+    const client = registerBinding("qwormhole");
+    const native = await importNative();
+    const tcp = new native.NativeTcpClient();
+    const slab = Buffer.alloc(8, 0);
+    expect(tcp.recvInto(slab, 2)).toBe(2);
+    expect(slab.subarray(2, 4).toString()).toBe("ok");
+    expect(client.recv).toHaveBeenLastCalledWith(6);
+    expect(tcp.recvInto(slab, 8)).toBe(0);
+
+    const recvInto = vi.fn((buffer: Buffer, offset?: number) =>
+      buffer.write("xyz", offset ?? 0),
+    );
+    client.recvInto = recvInto;
+    const withInto = new native.NativeTcpClient();
+    expect(withInto.recvInto(slab)).toBe(3);
+    expect(recvInto).toHaveBeenCalledWith(slab, 0);
+  });
+
   it("throws when TLS requested on libsocket backend", async () => {
     registerBinding("qwormhole");
     const native = await importNative();
@@ -7,7 +7,12 @@ import {
   createNegentropicHandshake,
   verifyNegentropicHandshake,
 } from "../src/index.js";
-import { computeNIndex } from "../src/handshake/negentropic-handshake.js";
+import { createHmac, generateKeyPairSync, sign } from "node:crypto";
+import {
+  computeNIndex,
+  createResumedHandshake,
+  verifyHandshakeAck,
+} from "../src/handshake/negentropic-handshake.js";
 
 describe("computeNIndex", () => {
   const adversarialBase64 = fc.oneof(
@@ -106,3 +111,71 @@ describe("Negentropic handshake", () => {
     await server.close();
   });
 });
+
+describe("verifyHandshakeAck", () => {
+  const { publicKey, privateKey } = generateKeyPairSync("ed25519");
+  const publicKeyB64 = publicKey
+    .export({ format: "der", type: "spki" })
+    .toString("base64");
+  // Keys in sorted order, matching the native responder's canonical form.
+  const unsigned = {
+    nonce: "bm9uY2U=",
+    policy: { batchSize: 8, mode: "immune" },
+    publicKey: publicKeyB64,
+    ts: 1_700_000_000_000,
+    type: "handshake-ack",
+    version: "1.0.0",
+  };
+  const ack = {
+    ...unsigned,
+    signature: sign(null, Buffer.from(JSON.stringify(unsigned)), privateKey).toString(
+      "base64",
+    ),
+  };
+
+  it("accepts a correctly signed ack", () => {
+    expect(verifyHandshakeAck(ack)).toBe(true);
+    expect(
+      verifyHandshakeAck(ack, { publicKey: publicKeyB64, nonce: "bm9uY2U=" }),
+    ).toBe(true);
+  });
+
+  it("rejects tampered, mis-keyed or unbound acks", () => {
+    expect(verifyHandshakeAck({ ...ack, version: "2.0.0" })).toBe(false);
+    expect(verifyHandshakeAck(ack, { publicKey: "AAAA" })).toBe(false);
+    expect(verifyHandshakeAck(ack, { nonce: "b3RoZXI=" })).toBe(false);
+    expect(verifyHandshakeAck({ type: "handshake" })).toBe(false);
+  });
+});
+
+describe("createResumedHandshake", () => {
+  it("binds the token to the session's exporter material", () => {
+    const hs = createNegentropicHandshake({ version: "1.0.0" });
+    const token = Buffer.alloc(32, 7).toString("base64");
+    const keyMaterial = Buffer.alloc(32, 3);
+    const resumed = createResumedHandshake({
+      resume: { token, expires: 1_900_000_000_000 },
+      handshake: hs,
+      keyMaterial,
+      version: "1.0.0",
+    });
+    expect(resumed).toMatchObject({
+      type: "handshake",
+      version: "1.0.0",
+      publicKey: hs.publicKey,
+      negHash: hs.negHash,
+      resumeExpires: 1_900_000_000_000,
+    });
+    expect(resumed).not.toHaveProperty("signature");
+    const expected = createHmac("sha256", Buffer.from(token, "base64"))
+      .update(keyMaterial)
+      .digest("base64");
+    expect(resumed.resumeProof).toBe(expected);
+    const other = createResumedHandshake({
+      resume: { token, expires: 1_900_000_000_000 },
+      handshake: hs,
+      keyMaterial: Buffer.alloc(32, 4),
+    });
+    expect(other.resumeProof).not.toBe(expected);
+  });
+});
@@ -8,6 +8,8 @@ import {
   Velocity,
   NegentropicDiagnostics,
   inferMessageType,
+  byteEntropy,
+  nativeNegentropicSnapshot,
 } from "../src/utils/negentropic-diagnostics";
 import { describe, it, expect } from "vitest";
 
@@ -50,4 +52,40 @@ describe("Negentropic Diagnostics", () => {
     expect(inferMessageType({ event: "pong" })).toBe("event:pong");
     expect(inferMessageType({ action: "sync" })).toBe("action:sync");
   });
+  it("computes byte entropy in bits per byte", () => {
+    expect(byteEntropy(new Uint8Array(0))).toBe(0);
+    expect(byteEntropy(Buffer.alloc(1024, 7))).toBe(0);
+    const uniform = Buffer.alloc(4096);
+    for (let i = 0; i < uniform.length; i++) uniform[i] = i & 0xff;
+    expect(byteEntropy(uniform)).toBeCloseTo(8, 10);
+    expect(byteEntropy(Buffer.from("abab"))).toBeCloseTo(1, 10);
+  });
+  it("maps native message-type stats onto a snapshot", () => {
+    const snapshot = nativeNegentropicSnapshot({
+      frames: 10,
+      sampleCount: 4,
+      histogram: { ping: 2, "event:join": 2 },
+      entropy: 1,
+      negentropy: 0,
+      entropyVelocity: 1.2,
+      entropySamples: 1,
+      entropyHistogram: [0, 0, 0, 1, 0, 0, 0, 0],
+      payloadEntropy: 3.5,
+    });
+    expect(snapshot).toMatchObject({
+      histogram: { ping: 2, "event:join": 2 },
+      sampleCount: 4,
+      coherence: Coherence.Low,
+      velocity: Velocity.Fast,
+      payloadEntropy: 3.5,
+    });
+  });
+  it("tracks entropy of binary payloads", () => {
+    const diag = new NegentropicDiagnostics(16);
+    diag.recordPayload(Buffer.from("abab"));
+    diag.recordPayload("text");
+    expect(diag.getSnapshot().payloadEntropy).toBeCloseTo(1, 10);
+    diag.reset();
+    expect(diag.getSnapshot().payloadEntropy).toBeUndefined();
+  });
 });
@@ -0,0 +1,99 @@
+import fs from "node:fs";
+import os from "node:os";
+import path from "node:path";
+import { describe, it, expect, vi, beforeEach, afterEach } from "vitest";
+import type { Peer } from "../src/types/sigilnet.types";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+const samplePeer = (origin: string, lastSeen = Date.now()): Peer => ({
+  id: origin,
+  origin,
+  sigil: "Σ",
+  ed25519PublicKey: "pub",
+  x25519PublicKey: "xpub",
+  host: "127.0.0.1",
+  port: 1234,
+  trustLevel: 0.5,
+  lastSeen,
+  metrics: { entropy: 0.5, coherence: 0.5 },
+  latency: 0,
+});
+
+describe("peer store", () => {
+  let dir: string;
+
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    bindingFactory.mockImplementation(() => {
+      throw new Error("not found");
+    });
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), "qw-peers-"));
+  });
+
+  afterEach(() => {
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  it("appends records, compacts dead ones and survives a torn tail", async () => {
+    const { openPeerStore } = await import("../src/registry/peer-store.js");
+    const file = path.join(dir, "peers.qwpeers");
+    const store = openPeerStore(file, { compactMinBytes: 256 });
+    store.put("a", "one");
+    store.put("b", Buffer.from("two"));
+    expect(store.delete("b")).toBe(true);
+    expect(store.delete("b")).toBe(false);
+    const before = store.stats().logBytes;
+    store.put("a", "uno");
+    expect(store.stats().logBytes).toBeGreaterThan(before);
+    expect(store.get("a")?.toString()).toBe("uno");
+    expect(store.get("b")).toBeNull();
+
+    for (let i = 0; i < 40; i += 1) store.put("a", `value-${i}`);
+    const stats = store.stats();
+    expect(stats.compactions).toBeGreaterThan(0);
+    expect(stats.count).toBe(1);
+    store.close();
+    expect(() => store.get("a")).toThrow(/closed/);
+
+    fs.appendFileSync(file, Buffer.from([0x51, 0x57, 0x50, 0x52, 1, 2]));
+    const reopened = openPeerStore(file);
+    expect(reopened.entries().map(([key, value]) => [key, value.toString()])).toEqual([
+      ["a", "value-39"],
+    ]);
+    reopened.put("c", "three");
+    reopened.close();
+    expect(openPeerStore(file).keys()).toEqual(["a", "c"]);
+  });
+
+  it("backs the peer registry with one record per change", async () => {
+    const { PeerRegistry } = await import("../src/registry/index.js");
+    const registryPath = path.join(dir, "nested", "peers.qwpeers");
+    const registry = new PeerRegistry({ registryPath, storage: "log" });
+    await registry.initialize();
+    await registry.registerPeer(samplePeer("p1"));
+    await registry.registerPeer(samplePeer("p2"));
+    await registry.updateTrustLevel("p2", 0.9);
+    registry.close();
+
+    const reopened = new PeerRegistry({ registryPath, storage: "log" });
+    await reopened.initialize();
+    expect(reopened.peers.size).toBe(0);
+    expect(reopened.getPeer("p2")?.trustLevel).toBe(0.9);
+    expect(reopened.getTrustedPeers(0.8).map(peer => peer.origin)).toEqual(["p2"]);
+    expect(await reopened.removePeer("p1")).toBe(true);
+    reopened.peers.get("p2")!.lastSeen = 0;
+    await reopened.save();
+    expect(await reopened.cleanupStalePeers(1000)).toBe(1);
+    reopened.close();
+
+    const last = new PeerRegistry({ registryPath, storage: "log" });
+    expect(last.getAllPeers()).toHaveLength(0);
+    last.close();
+  });
+});
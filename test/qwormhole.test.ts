@@ -11,6 +11,8 @@ import type {
   QWormholeServerConnection,
 } from "../src/types/types.js";
 import net from "node:net";
+import os from "node:os";
+import path from "node:path";
 import { CreateClientOptions } from "../src/core/factory.js";
 
 if (typeof vi !== "undefined" && process.env.TEST_NATIVE_MOCK === "true") {
@@ -57,6 +59,59 @@ describe("QWormhole client/server", () => {
     client.disconnect();
   });
 
+  it("exchanges messages over a Unix domain socket", async () => {
+    const socketPath = path.join(
+      os.tmpdir(),
+      `qwormhole-${process.pid}-${Date.now()}.sock`,
+    );
+    const unixServer = new QWormholeServer<string>({
+      host: "127.0.0.1",
+      port: 0,
+      path: socketPath,
+      deserializer: textDeserializer,
+    });
+    const address = await unixServer.listen();
+    expect(address.family).toBe("unix");
+    expect(address.address).toBe(socketPath);
+    try {
+      const received = new Promise<string>(resolve => {
+        unixServer.once("message", ({ data }) => resolve(data));
+      });
+      const { client } = createQWormholeClient<string>({
+        path: socketPath,
+        forceTs: true,
+        deserializer: textDeserializer,
+      });
+      const tsClient = client as QWormholeClient<string>;
+      await tsClient.connect();
+      tsClient.send("hello-unix");
+      expect(await received).toBe("hello-unix");
+      tsClient.disconnect();
+    } finally {
+      await unixServer.close();
+    }
+  });
+
+  it("broadcastTo only reaches the listed connections", async () => {
+    const connected = new Promise<QWormholeServerConnection>(resolve => {
+      server.once("connection", resolve);
+    });
+    const target = new QWormholeClient<string>({
+      host: "127.0.0.1",
+      port,
+      deserializer: textDeserializer,
+    });
+    await target.connect();
+    const targetConn = await connected;
+
+    const received = new Promise<string>(resolve => {
+      target.once("message", data => resolve(data));
+    });
+    expect(server.broadcastTo([targetConn.id, "missing-id"], "subset")).toBe(1);
+    expect(await received).toBe("subset");
+    target.disconnect();
+  });
+
   it("factory selects TS when native is unavailable", async () => {
     const options = {
       host: "127.0.0.1",
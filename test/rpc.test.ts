@@ -0,0 +1,102 @@
+import { EventEmitter } from "node:events";
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+type NativeEvent = { type: string; responses?: Array<{ id: number; status: number; body: Buffer }> };
+
+class RpcTcpClient extends FakeTcpClientWrapper<NativeEvent> {
+  static last: RpcTcpClient | undefined;
+  requests: Array<{ payload: Buffer; timeoutMs?: number }> = [];
+
+  rpcRequest(payload: Buffer, timeoutMs?: number) {
+    this.requests.push({ payload, timeoutMs });
+    return this.requests.length;
+  }
+  recv() {
+    return Buffer.alloc(0);
+  }
+}
+
+describe("binary rpc", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    RpcTcpClient.last = undefined;
+    withBinding(bindingFactory, "qwormhole_lws", { TcpClientWrapper: RpcTcpClient });
+  });
+
+  it("round-trips frames and answers requests on a server", async () => {
+    const { encodeRpcFrame, decodeRpcFrame, attachBinaryRpcServer } = await import(
+      "../src/http/rpc.js"
+    );
+    const request = encodeRpcFrame("request", 2n ** 40n + 7n, 0, Buffer.from("ping"));
+    expect(request.length).toBe(20);
+    expect(decodeRpcFrame(request)).toEqual({
+      kind: "request",
+      status: 0,
+      id: 2n ** 40n + 7n,
+      body: Buffer.from("ping"),
+    });
+    expect(decodeRpcFrame(Buffer.from("not an rpc frame"))).toBeNull();
+
+    const server = new EventEmitter();
+    const sent: Buffer[] = [];
+    const client = { backpressured: false, send: async (frame: Buffer) => void sent.push(frame) };
+    const detach = attachBinaryRpcServer(server as never, body => ({
+      status: 200,
+      body: Buffer.concat([body, Buffer.from("-pong")]),
+    }));
+    server.emit("message", { client, data: request });
+    await new Promise(resolve => setImmediate(resolve));
+    expect(decodeRpcFrame(sent[0])).toMatchObject({
+      kind: "response",
+      status: 200,
+      id: 2n ** 40n + 7n,
+    });
+    expect(decodeRpcFrame(sent[0])?.body.toString()).toBe("ping-pong");
+    detach();
+  });
+
+  it("settles native completions delivered in one batch", async () => {
+    const { NativeTcpClient } = await import("../src/core/NativeTCPClient.js");
+    const { attachNativeRpcClient } = await import("../src/http/rpc.js");
+    const client = new NativeTcpClient("lws");
+    const messages: string[] = [];
+    client.setEventHandler(evt => messages.push(evt.type));
+    const rpc = attachNativeRpcClient(client);
+
+    const ok = rpc.request(Buffer.from("a"), 250);
+    const failed = rpc.request(Buffer.from("b"));
+    const timedOut = client.rpcRequest(Buffer.from("c"), 10);
+    const native = RpcTcpClient.last!;
+    expect(native.requests.map(r => [r.payload.toString(), r.timeoutMs])).toEqual([
+      ["a", 250],
+      ["b", 5000],
+      ["c", 10],
+    ]);
+
+    native.handler!({
+      type: "rpc",
+      responses: [
+        { id: 3, status: 0, body: Buffer.alloc(0) },
+        { id: 1, status: 200, body: Buffer.from("A") },
+        { id: 2, status: 404, body: Buffer.from("missing") },
+      ],
+    });
+    native.handler!({ type: "message" });
+    await expect(ok).resolves.toEqual({ status: 200, body: Buffer.from("A") });
+    await expect(failed).rejects.toThrow("missing");
+    await expect(timedOut).rejects.toThrow(/timed out/);
+    expect(messages).toEqual(["message"]);
+
+    const pending = client.rpcRequest(Buffer.from("d"));
+    native.handler!({ type: "close" });
+    await expect(pending).rejects.toThrow(/closed/);
+  });
+});
@@ -0,0 +1,109 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeTcpClientWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class FakeSecureStreams {
+  static last: FakeSecureStreams | undefined;
+  handler?: (events: unknown[]) => void;
+  next = 1;
+  create = vi.fn(() => this.next++);
+  write = vi.fn(() => true);
+  setMetadata = vi.fn(() => true);
+  requestTx = vi.fn();
+  destroy = vi.fn();
+  close = vi.fn();
+
+  constructor(public readonly options: { policy: string }) {
+    FakeSecureStreams.last = this;
+  }
+
+  setEventHandler(fn: (events: unknown[]) => void) {
+    this.handler = fn;
+  }
+
+  getStats() {
+    return { streams: this.next - 1 };
+  }
+}
+
+const withSecureStreams = (secureStreams: boolean) =>
+  withBinding(bindingFactory, "qwormhole_lws", {
+    TcpClientWrapper: FakeTcpClientWrapper,
+    ...(secureStreams ? { SecureStreams: FakeSecureStreams } : {}),
+  });
+
+const policy = {
+  release: "1",
+  product: "qwormhole",
+  "schema-version": 1,
+  retry: [{ default: { backoff: [100, 200], conceal: 2, jitterpc: 20 } }],
+  s: [{ api: { endpoint: "${host}", port: 443, protocol: "h2", tls: true, retry: "default" } }],
+};
+
+describe("native Secure Streams", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    FakeSecureStreams.last = undefined;
+  });
+
+  it("opens policy streams and routes their batched events", async () => {
+    withSecureStreams(true);
+    const { createSecureStreams, isNativeSecureStreamsAvailable } = await import(
+      "../src/core/secure-streams.js"
+    );
+    expect(isNativeSecureStreamsAvailable()).toBe(true);
+    const streams = createSecureStreams({ policy });
+    const native = FakeSecureStreams.last!;
+    expect(JSON.parse(native.options.policy)).toEqual(policy);
+
+    const a = streams.open("api", { metadata: { host: "example.com" } });
+    const b = streams.open("api");
+    expect(native.create).toHaveBeenNthCalledWith(1, "api", { host: "example.com" });
+    expect(streams.streamCount).toBe(2);
+
+    a.write(Buffer.from("req"));
+    expect(native.write).toHaveBeenCalledWith(a.id, Buffer.from("req"));
+
+    const states: string[] = [];
+    const messages: string[] = [];
+    a.on("state", state => states.push(state));
+    a.on("message", message => messages.push(message.toString()));
+    let bClosed = false;
+    b.on("close", () => (bClosed = true));
+    native.handler!([
+      { id: a.id, type: "state", state: "connected", ack: 0 },
+      { id: a.id, type: "data", data: Buffer.from("he"), som: true, eom: false },
+      { id: a.id, type: "data", data: Buffer.from("llo"), som: false, eom: true },
+      { id: b.id, type: "state", state: "destroying", ack: 0 },
+    ]);
+    expect(states).toEqual(["connected"]);
+    expect(a.state).toBe("connected");
+    expect(messages).toEqual(["hello"]);
+    expect(bClosed).toBe(true);
+    expect(streams.streamCount).toBe(1);
+
+    a.close();
+    expect(native.destroy).toHaveBeenCalledWith(a.id);
+    expect(a.write("late")).toBe(false);
+    streams.close();
+    expect(native.close).toHaveBeenCalled();
+    expect(() => streams.open("api")).toThrow(/closed/);
+  });
+
+  it("throws without a Secure Streams build", async () => {
+    withSecureStreams(false);
+    const { NativeSecureStreams, isNativeSecureStreamsAvailable } = await import(
+      "../src/core/secure-streams.js"
+    );
+    expect(isNativeSecureStreamsAvailable()).toBe(false);
+    expect(() => new NativeSecureStreams({ policy: "{}" })).toThrow(
+      /LWS_WITH_SECURE_STREAMS/,
+    );
+  });
+});
@@ -166,6 +166,45 @@ describe("QWormholeServer handshake rejection", () => {
     await server.close();
   });
 
+  it("holds keyed handshakes to the negentropic schema with strictHandshake", async () => {
+    const server = new QWormholeServer<any>({
+      host: "127.0.0.1",
+      port: 0,
+      framing: "length-prefixed",
+      protocolVersion: "1.0.0",
+      deserializer: jsonDeserializer,
+      strictHandshake: true,
+    });
+    const address = await server.listen();
+
+    const errorSeen = new Promise<boolean>(resolve => {
+      server.once("error", () => resolve(true));
+    });
+    const closed = new Promise<boolean>(resolve => {
+      server.once("clientClosed", ({ hadError }) => resolve(hadError));
+    });
+
+    const framer = new LengthPrefixedFramer();
+    const socket = net.createConnection(address.port, address.address);
+    // A public key but no signature, nonce or ts.
+    const unsigned = { type: "handshake", version: "1.0.0", publicKey: "a2V5" };
+    socket.write(framer.encode(Buffer.from(JSON.stringify(unsigned))));
+
+    const hadError = await Promise.race([
+      closed,
+      new Promise<boolean>(resolve => setTimeout(() => resolve(false), 800)),
+    ]);
+    const err = await Promise.race([
+      errorSeen,
+      new Promise<boolean>(resolve => setTimeout(() => resolve(false), 800)),
+    ]);
+    expect(hadError).toBe(true);
+    expect(err).toBe(true);
+    expect(server.getConnectionCount()).toBe(0);
+    socket.destroy();
+    await server.close();
+  });
+
   it(
     "rejects invalid negentropic handshake signatures",
     { timeout: 8000 },
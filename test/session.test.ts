@@ -87,6 +87,7 @@ import {
   encryptForPeer,
   encryptPayload,
   generateSessionKeyPair,
+  PeerCryptoCache,
 } from "../src/session";
 
 describe("session", () => {
@@ -152,4 +153,25 @@ describe("session", () => {
     const decrypted = decryptFromPeer(encrypted, mySecret, theirPublic);
     expect(decrypted).toBe("test");
   });
+
+  it("derives each peer's box key once and batches over it", () => {
+    const cache = new PeerCryptoCache(2);
+    const mySecret = Buffer.from([4, 5, 6]).toString("base64");
+    const theirPublic = Buffer.from([1, 2, 3]).toString("base64");
+    const encrypted = cache.encryptMany(["a", { b: 1 }], mySecret, theirPublic);
+    expect(encrypted).toHaveLength(2);
+    expect(cache.decryptMany(encrypted, mySecret, theirPublic)).toEqual(["test", "test"]);
+    expect(beforeFn).toHaveBeenCalledTimes(1);
+    expect(boxAfter).toHaveBeenCalledTimes(2);
+    expect(cache.getStats()).toMatchObject({ size: 1, hits: 1, misses: 1 });
+
+    cache.sharedKey(mySecret, Buffer.from([7]).toString("base64"));
+    cache.sharedKey(mySecret, Buffer.from([8]).toString("base64"));
+    expect(cache.getStats().size).toBe(2);
+    cache.forgetPeer(Buffer.from([8]).toString("base64"));
+    expect(cache.getStats().size).toBe(1);
+    expect(cache.decryptMany([{ ciphertext: "!!", nonce: "!!" }], mySecret, theirPublic)).toEqual([
+      null,
+    ]);
+  });
 });
@@ -0,0 +1,60 @@
+import { describe, it, expect } from "vitest";
+import { pickShard, shardLoadScore } from "../src/sharding/shard-balance";
+import type { WorkerShardStats } from "../src/sharding/worker-sharded-server";
+
+const shard = (
+  shardIndex: number,
+  extra: Partial<WorkerShardStats> = {},
+): WorkerShardStats => ({
+  shardIndex,
+  processId: 1000 + shardIndex,
+  listening: true,
+  connections: 0,
+  messagesIn: 0,
+  bytesIn: 0,
+  errors: 0,
+  ...extra,
+});
+
+const fresh = () => ({ cursor: 0, pending: new Map<number, number>() });
+
+describe("shard balance", () => {
+  it("scores lag and queued bytes alongside connections", () => {
+    expect(shardLoadScore(shard(0, { connections: 3 }), 2)).toBe(5);
+    expect(
+      shardLoadScore(
+        shard(0, { queuedBytes: 128 * 1024, loopLagMs: 4, serviceLagUs: 1500 }),
+      ),
+    ).toBe(7.5);
+  });
+
+  it("round-robins when asked to", () => {
+    const shards = [shard(0, { connections: 99 }), shard(1)];
+    const state = fresh();
+    const picks = [0, 1, 2].map(
+      () => pickShard(shards, "round-robin", state)!.shardIndex,
+    );
+    expect(picks).toEqual([0, 1, 0]);
+  });
+
+  it("avoids a lagging shard under least-loaded", () => {
+    const shards = [
+      shard(0, { connections: 2, loopLagMs: 250 }),
+      shard(1, { connections: 5 }),
+      shard(2, { connections: 4 }),
+    ];
+    const state = fresh();
+    expect(pickShard(shards, "least-loaded", state)!.shardIndex).toBe(2);
+    state.pending.set(2, 3);
+    expect(pickShard(shards, "least-loaded", state)!.shardIndex).toBe(1);
+  });
+
+  it("takes the lighter of two distinct random shards", () => {
+    const shards = [shard(0, { connections: 9 }), shard(1), shard(2)];
+    const draws = [0.1, 0.1];
+    const random = () => draws.shift()!;
+    // First draw picks shard 0; the second skips past it to shard 1.
+    expect(pickShard(shards, "p2c", fresh(), random)!.shardIndex).toBe(1);
+    expect(pickShard([], "p2c", fresh())).toBeUndefined();
+  });
+});
@@ -0,0 +1,73 @@
+import { describe, it, expect } from "vitest";
+import { readShardStatsBoard } from "../src/sharding/shard-stats-board";
+import type {
+  NativeShardStatsBoard,
+  NativeShardStatsPage,
+} from "../src/core/native-server";
+import type { WorkerShardStats } from "../src/sharding/worker-sharded-server";
+
+const page = (
+  shardIndex: number,
+  seq: number,
+  extra: Partial<NativeShardStatsPage> = {},
+): NativeShardStatsPage => ({
+  shardIndex,
+  processId: 1000 + shardIndex,
+  seq,
+  updatedAt: 0,
+  messagesIn: 0,
+  bytesIn: 0,
+  connections: 0,
+  errors: 0,
+  queuedBytes: 0,
+  loopLagMs: 0,
+  serviceLagUs: 0,
+  ...extra,
+});
+
+const boardOf = (pages: Array<NativeShardStatsPage | null>) =>
+  ({ read: () => pages }) as unknown as NativeShardStatsBoard;
+
+const ready = (shardIndex: number): WorkerShardStats => ({
+  shardIndex,
+  processId: 1000 + shardIndex,
+  listening: true,
+  address: { address: "127.0.0.1", family: "IPv4", port: 9000 },
+  connections: 0,
+  messagesIn: 0,
+  bytesIn: 0,
+  errors: 0,
+});
+
+describe("shard stats board", () => {
+  it("folds fresh pages into ready shards", () => {
+    const stats = new Map([
+      [0, ready(0)],
+      [1, ready(1)],
+    ]);
+    const seen = new Map<number, number>();
+    const pages = [
+      page(0, 2, { connections: 7, messagesIn: 40, loopLagMs: 1.5 }),
+      null,
+    ];
+
+    expect(readShardStatsBoard(boardOf(pages), stats, seen)).toEqual([0]);
+    expect(stats.get(0)).toMatchObject({
+      listening: true,
+      address: { port: 9000 },
+      connections: 7,
+      messagesIn: 40,
+      loopLagMs: 1.5,
+    });
+    expect(stats.get(1)!.connections).toBe(0);
+    // Same seq again: nothing new to report.
+    expect(readShardStatsBoard(boardOf(pages), stats, seen)).toEqual([]);
+  });
+
+  it("ignores pages left by a shard that is gone", () => {
+    const stats = new Map([[0, ready(0)]]);
+    const stale = page(0, 4, { processId: 42, connections: 99 });
+    expect(readShardStatsBoard(boardOf([stale]), stats, new Map())).toEqual([]);
+    expect(stats.get(0)!.connections).toBe(0);
+  });
+});
@@ -7,6 +7,7 @@ const sessionMocks = vi.hoisted(() => ({
   })),
   encryptForPeer: vi.fn(() => ({ ciphertext: "c", nonce: "n" })),
   decryptFromPeer: vi.fn(() => "decrypted"),
+  deriveSealKey: vi.fn(() => "seal-key"),
 }));
 const sovereignHashMock = vi.hoisted(() => vi.fn(() => "session-id"));
 
@@ -14,6 +15,7 @@ vi.mock("../src/session", () => ({
   generateSessionKeyPair: sessionMocks.generateSessionKeyPair,
   encryptForPeer: sessionMocks.encryptForPeer,
   decryptFromPeer: sessionMocks.decryptFromPeer,
+  deriveSealKey: sessionMocks.deriveSealKey,
 }));
 
 vi.mock("../src/utils/crypto", () => ({
@@ -149,6 +151,26 @@ describe("SovereignTunnel", () => {
     expect(decrypted).toBe("decrypted");
   });
 
+  it("derives the native seal key only for established sessions", () => {
+    const tunnel = new SovereignTunnel(registry, 1000);
+    const session = {
+      sessionId: "s",
+      peerOrigin: peer.origin,
+      myX25519SecretKey: "sec",
+      myX25519PublicKey: "pub",
+      peerX25519PublicKey: "peer-pub",
+      established: false,
+      createdAt: Date.now(),
+      lastActivity: 0,
+    };
+    tunnel.sessions.set(peer.origin, session);
+    expect(tunnel.sealKeyFor(peer.origin)).toBeNull();
+
+    session.established = true;
+    expect(tunnel.sealKeyFor(peer.origin)).toBe("seal-key");
+    expect(sessionMocks.deriveSealKey).toHaveBeenCalledWith("sec", "peer-pub");
+  });
+
   it("cleanupExpiredSessions removes stale sessions", () => {
     const now = Date.now();
     vi.setSystemTime(now);
@@ -0,0 +1,117 @@
+import fs from "node:fs";
+import os from "node:os";
+import path from "node:path";
+import { describe, it, expect, vi, beforeEach, afterEach } from "vitest";
+import { withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+const nativeRecorder = {
+  append: vi.fn(() => 64),
+  stats: vi.fn(() => ({ blocks: 1, bytes: 200 })),
+  close: vi.fn(),
+};
+const TraceRecorder = vi.fn(() => nativeRecorder);
+
+const withTraceRecorder = (enabled: boolean) =>
+  withBinding(
+    bindingFactory,
+    "qwormhole_lws",
+    enabled ? { TcpClientWrapper: class {}, TraceRecorder } : { TcpClientWrapper: class {} },
+  );
+
+describe("telemetry traces", () => {
+  let dir: string;
+
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    TraceRecorder.mockClear();
+    Object.values(nativeRecorder).forEach(fn => fn.mockClear());
+    dir = fs.mkdtempSync(path.join(os.tmpdir(), "qwtrace-"));
+  });
+
+  afterEach(() => {
+    fs.rmSync(dir, { recursive: true, force: true });
+  });
+
+  it("writes columnar blocks readers view in place", async () => {
+    withTraceRecorder(false);
+    const { TelemetryTraceRecorder, openTelemetryTrace } = await import(
+      "../src/telemetry/trace-recorder.js"
+    );
+    const file = path.join(dir, "capture.qwtrace");
+    const recorder = new TelemetryTraceRecorder(file, { blockRows: 4 });
+    expect(recorder.native).toBe(false);
+    for (let i = 0; i < 10; i += 1) {
+      recorder.record("flush", [100 + i, 1024 * i, 2], "lws");
+    }
+    recorder.record("backpressure", [104]);
+    recorder.writeBlock("histogram", [[0, 1], [1, 2], [7, 3]], "loopDelayMs");
+    recorder.close();
+
+    const trace = openTelemetryTrace(file);
+    expect(trace.indexed).toBe(true);
+    expect(trace.blocks.map(block => [block.schema, block.label, block.rows])).toEqual([
+      ["flush", "lws", 4],
+      ["flush", "lws", 4],
+      ["histogram", "loopDelayMs", 2],
+      ["flush", "lws", 2],
+      ["backpressure", "", 1],
+    ]);
+    expect(trace.blocks[0]).toMatchObject({ t0: 100, t1: 103 });
+    expect(Array.from(trace.column("flush", "bytes", "lws"))).toEqual(
+      Array.from({ length: 10 }, (_, i) => 1024 * i),
+    );
+    expect(Array.from(trace.column("histogram", "count"))).toEqual([7, 3]);
+  });
+
+  it("appends to an existing trace and scans one without an index", async () => {
+    withTraceRecorder(false);
+    const { TelemetryTraceRecorder } = await import("../src/telemetry/trace-recorder.js");
+    const { readTelemetryTrace } = await import("../src/telemetry/trace-format.js");
+    const file = path.join(dir, "bench.qwtrace");
+    for (const run of [1, 2]) {
+      const recorder = new TelemetryTraceRecorder(file);
+      recorder.record("benchScenario", [8, run, 0, 1000, run * 100, 1, 0.8, 0.7, 0.2], "ts");
+      recorder.close();
+    }
+    const bytes = fs.readFileSync(file);
+    expect(Array.from(readTelemetryTrace(bytes).column("benchScenario", "msgsPerSec"))).toEqual([
+      100, 200,
+    ]);
+
+    // A capture cut off before close(): no index offset, same blocks.
+    bytes.writeBigUInt64LE(0n, 24);
+    const scanned = readTelemetryTrace(bytes);
+    expect(scanned.indexed).toBe(false);
+    expect(scanned.blocks).toHaveLength(2);
+    expect(() => readTelemetryTrace(Buffer.alloc(64))).toThrow(/telemetry trace/);
+  });
+
+  it("hands blocks to the native recorder when the addon is loaded", async () => {
+    withTraceRecorder(true);
+    const { TelemetryTraceRecorder } = await import("../src/telemetry/trace-recorder.js");
+    const file = path.join(dir, "native.qwtrace");
+    const recorder = new TelemetryTraceRecorder(file, { initialBytes: 1 << 16 });
+    expect(recorder.native).toBe(true);
+    expect(TraceRecorder).toHaveBeenCalledWith({ path: file, initialBytes: 1 << 16 });
+
+    recorder.record("slice", [10, 512]);
+    recorder.record("slice", [12, 256]);
+    recorder.close();
+    expect(nativeRecorder.append).toHaveBeenCalledWith(
+      3,
+      "",
+      new Float64Array([10, 12, 512, 256]),
+      2,
+      10,
+      12,
+    );
+    expect(nativeRecorder.close).toHaveBeenCalledOnce();
+  });
+});
@@ -35,6 +35,8 @@ interface Scenario {
   preferNativeServer: boolean;
   clientMode: Mode;
   serverBackend?: NativeBackend;
+  /** Native lws server event loop; see QWormholeServerOptions.loop. */
+  serverLoop?: "uv";
 }
 
 type ScenarioResult = {
@@ -78,6 +80,11 @@ type ScenarioResult = {
   kcpRttMs?: number;
   kcpLossRate?: number;
   kcpPending?: number;
+  messageLatency?: MessageLatencySummary;
+  /** QWORMHOLE_BENCH_TIMESTAMPING (libsocket server): messageLatency cut at each stamp. */
+  latencySplit?: LatencySplitSummary;
+  /** lws getStats() cost counters over the measured messages. */
+  nativeCosts?: { server?: NativeCostCounters; client?: NativeCostCounters };
   repeatStats?: {
     runs: number;
     successfulRuns: number;
@@ -95,9 +102,46 @@ type ScenarioResult = {
       best?: number;
       worst?: number;
     };
+    samples?: {
+      msgsPerSec: number[];
+      p99Ms: number[];
+      allocBytesPerMsg: number[];
+      writeCallsPerMsg: number[];
+    };
   };
 };
 
+type NativeCostCounters = {
+  queuedWriteAllocs: number;
+  rxFrameAllocs: number;
+  tsfnPayloads: number;
+  lwsWrites: number;
+  rxCallbacks: number;
+};
+
+/** One-way client-to-server latency of the measured messages, in ms. */
+type MessageLatencySummary = {
+  count: number;
+  p50Ms: number;
+  p90Ms: number;
+  p99Ms: number;
+  p999Ms: number;
+  maxMs: number;
+  meanMs: number;
+  /** Stamped with the scheduled send time rather than the actual one. */
+  openLoop: boolean;
+  targetRate?: number;
+  native: boolean;
+  /** [lowerMs, upperMs, count] per non-empty bucket. */
+  buckets?: Array<[number, number, number]>;
+};
+
+/** p50/p99/mean ms per slice of splitLatency(). */
+type LatencySplitSummary = Record<
+  "wire" | "kernel" | "native" | "js",
+  { p50Ms: number; p99Ms: number; meanMs: number }
+>;
+
 type BatchFlushStats = {
   flushes: number;
   totalBuffers: number;
@@ -191,6 +235,17 @@ type ScenarioDiagnostics = {
     nativeSendManyBytes: number;
     nativeSendCalls: number;
   };
+  /**
+   * Process-wide (bench server and clients) from markMeasured(), or from
+   * the start of the scope when a path never calls it.
+   */
+  resources?: {
+    allocatedBytes: number;
+    userCpuMs: number;
+    systemCpuMs: number;
+    voluntaryContextSwitches: number;
+    involuntaryContextSwitches: number;
+  };
   flow?: FlowControllerDiagnostics;
   clientFlow?: FlowControllerDiagnostics;
   clientBatch?: BatchFramerStats;
@@ -207,6 +262,8 @@ type DiagnosticsExtras = {
 };
 
 type DiagnosticsScope = {
+  /** Restart the resource counters once warmup is done. */
+  markMeasured?: () => void;
   stop: (extras?: DiagnosticsExtras) => ScenarioDiagnostics;
 };
 
@@ -214,6 +271,9 @@ export {
   CoherenceDecisionSample,
   Scenario,
   ScenarioResult,
+  MessageLatencySummary,
+  LatencySplitSummary,
+  NativeCostCounters,
   ScenarioDiagnostics,
   DiagnosticsScope,
   DiagnosticsExtras,
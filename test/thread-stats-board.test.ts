@@ -0,0 +1,61 @@
+import { describe, it, expect } from "vitest";
+import { readShardStatsBoard } from "../src/sharding/shard-stats-board";
+import {
+  allocateThreadStatsBuffer,
+  createThreadStatsBoard,
+} from "../src/sharding/thread-stats-board";
+import type { WorkerShardStats } from "../src/sharding/worker-sharded-server";
+
+const ready = (shardIndex: number): WorkerShardStats => ({
+  shardIndex,
+  processId: process.pid,
+  listening: true,
+  connections: 0,
+  messagesIn: 0,
+  bytesIn: 0,
+  errors: 0,
+});
+
+describe("thread stats board", () => {
+  it("reads what each shard's page writer wrote", () => {
+    const buffer = allocateThreadStatsBuffer(2);
+    const owner = createThreadStatsBoard(buffer);
+    const shard1 = createThreadStatsBoard(buffer, 1);
+
+    expect(owner.read()).toEqual([null, null]);
+    expect(shard1.write({ connections: 3, messagesIn: 12, loopLagMs: 0.5 })).toBe(
+      true,
+    );
+    const [first, second] = owner.read();
+    expect(first).toBeNull();
+    expect(second).toMatchObject({
+      shardIndex: 1,
+      processId: process.pid,
+      seq: 1,
+      connections: 3,
+      messagesIn: 12,
+      loopLagMs: 0.5,
+    });
+  });
+
+  it("folds into shard stats like the native board", () => {
+    const buffer = allocateThreadStatsBuffer(2);
+    const owner = createThreadStatsBoard(buffer);
+    const stats = new Map([
+      [0, ready(0)],
+      [1, ready(1)],
+    ]);
+    const seen = new Map<number, number>();
+
+    createThreadStatsBoard(buffer, 0).write({ connections: 5, bytesIn: 64 });
+    expect(readShardStatsBoard(owner, stats, seen)).toEqual([0]);
+    expect(stats.get(0)).toMatchObject({ listening: true, connections: 5 });
+    expect(readShardStatsBoard(owner, stats, seen)).toEqual([]);
+  });
+
+  it("rejects writes outside the buffer and from the owner", () => {
+    const buffer = allocateThreadStatsBuffer(1);
+    expect(createThreadStatsBoard(buffer).write({ connections: 1 })).toBe(false);
+    expect(createThreadStatsBoard(buffer, 4).write({ connections: 1 })).toBe(false);
+  });
+});
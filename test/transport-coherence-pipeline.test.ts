@@ -0,0 +1,149 @@
+import { describe, it, expect, vi, beforeEach } from "vitest";
+import { FakeServerWrapper, withBinding } from "./fake-binding";
+
+const bindingFactory = vi.fn();
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
+
+class TelemetryServer extends FakeServerWrapper {
+  static last: TelemetryServer | undefined;
+  enableTransportTelemetry = vi.fn(() => "qwtel-test-1");
+  disableTransportTelemetry = vi.fn();
+
+  broadcast() {}
+}
+
+const drainTransportTelemetry = vi.fn((_token: string, out: Float64Array) => {
+  out.set([1, 1000, 4096, 4, 2, 1000, 0, 0]);
+  return 2;
+});
+
+// Stands in for the native accumulator with whatever components it is handed.
+class FakeCoherenceAccumulator {
+  static components = new Float64Array(12);
+  ingest = vi.fn();
+  drain = vi.fn(() => 0);
+  reset = vi.fn();
+
+  constructor(public readonly options: { historySize?: number }) {}
+
+  components(out = new Float64Array(12)) {
+    out.set(FakeCoherenceAccumulator.components);
+    return out;
+  }
+}
+
+const withLwsBinding = (accumulator = false) =>
+  withBinding(bindingFactory, "qwormhole_lws", {
+    QWormholeServerWrapper: TelemetryServer,
+    drainTransportTelemetry,
+    ...(accumulator ? { CoherenceAccumulator: FakeCoherenceAccumulator } : {}),
+  });
+
+// Flushes every 5 ms of four 1 KiB frames; every tenth pass backpressured.
+const records = (count: number) => {
+  const out = new Float64Array(count * 4);
+  for (let i = 0; i < count; i += 1) {
+    out.set(i % 10 === 9 ? [2, 1000 + i * 5, 0, 0] : [1, 1000 + i * 5, 4096, 4], i * 4);
+  }
+  return out;
+};
+
+describe("transport coherence pipeline", () => {
+  beforeEach(() => {
+    vi.resetModules();
+    bindingFactory.mockReset();
+    drainTransportTelemetry.mockClear();
+    TelemetryServer.last = undefined;
+  });
+
+  it("turns telemetry records into capped coherence histories", async () => {
+    withLwsBinding();
+    const { TransportTelemetryHistory } = await import(
+      "../src/core/transport-coherence-pipeline.js"
+    );
+    const history = new TransportTelemetryHistory(16);
+    history.ingest(records(40), 40);
+    const input = history.input();
+    expect(input.flushHistory).toHaveLength(16);
+    expect(input.flushHistory[0]).toEqual({ timestamp: 1110, bytes: 4096, frames: 4 });
+    expect(input.sliceHistory[0]).toEqual({ timestamp: 1110, size: 1024 });
+    expect(input.backpressureHistory).toEqual([1045, 1095, 1145, 1195]);
+  });
+
+  it("composes native accumulator components into the same snapshot", async () => {
+    withLwsBinding(true);
+    const {
+      TRANSPORT_COHERENCE_COMPONENT_FIELDS,
+      TransportCoherenceAccumulator,
+      TransportTelemetryHistory,
+    } = await import("../src/core/transport-coherence-pipeline.js");
+    const { computeTransportCoherence, measureTransportCoherence } = await import(
+      "../src/core/transport-coherence.js"
+    );
+    const history = new TransportTelemetryHistory(32);
+    history.ingest(records(60), 60);
+    const measured = measureTransportCoherence(history.input());
+    FakeCoherenceAccumulator.components = Float64Array.from(
+      TRANSPORT_COHERENCE_COMPONENT_FIELDS,
+      field => measured[field],
+    );
+
+    const accumulator = TransportCoherenceAccumulator.create(32)!;
+    expect(accumulator).not.toBeNull();
+    expect(accumulator.components()).toEqual(measured);
+    const runtime = { gcPauseMaxMs: 4, payloadEntropy: 6.5 };
+    expect(accumulator.snapshot(runtime)).toEqual(
+      computeTransportCoherence({ ...history.input(), ...runtime }),
+    );
+  });
+
+  it("has no accumulator without the native one", async () => {
+    withLwsBinding();
+    const { TransportCoherenceAccumulator } = await import(
+      "../src/core/transport-coherence-pipeline.js"
+    );
+    expect(TransportCoherenceAccumulator.create()).toBeNull();
+  });
+
+  it("publishes snapshots through the shared buffer", async () => {
+    withLwsBinding();
+    const pipeline = await import("../src/core/transport-coherence-pipeline.js");
+    const { computeTransportCoherence } = await import(
+      "../src/core/transport-coherence.js"
+    );
+    const history = new pipeline.TransportTelemetryHistory(64);
+    history.ingest(records(40), 40);
+    const snapshot = computeTransportCoherence(history.input());
+
+    const buffer = pipeline.allocateTransportCoherenceBuffer();
+    expect(pipeline.readTransportCoherence(buffer)).toBeNull();
+    pipeline.writeTransportCoherence(buffer, snapshot);
+    pipeline.writeTransportCoherence(buffer, snapshot);
+    const { diagnostics: _diagnostics, pathRegularity: _path, ...numbers } = snapshot;
+    expect(pipeline.readTransportCoherence(buffer)).toMatchObject({
+      ...numbers,
+      seq: 2,
+    });
+  });
+
+  it("enables native telemetry and drains it through the lws addon", async () => {
+    withLwsBinding();
+    const { NativeQWormholeServer, drainNativeTransportTelemetry } = await import(
+      "../src/core/native-server.js"
+    );
+    const server = new NativeQWormholeServer({ host: "127.0.0.1", port: 0 }, "lws");
+
+    expect(server.enableTransportTelemetry({ capacity: 512 })).toBe("qwtel-test-1");
+    expect(TelemetryServer.last!.enableTransportTelemetry).toHaveBeenCalledWith({
+      capacity: 512,
+    });
+    const out = new Float64Array(8);
+    expect(drainNativeTransportTelemetry("qwtel-test-1", out)).toBe(2);
+    expect(Array.from(out)).toEqual([1, 1000, 4096, 4, 2, 1000, 0, 0]);
+    server.disableTransportTelemetry();
+    expect(TelemetryServer.last!.disableTransportTelemetry).toHaveBeenCalledOnce();
+  });
+});
@@ -51,4 +51,27 @@ describe("computeTransportCoherence", () => {
     expect(snapshot.transportSPI).toBeLessThan(0.55);
     expect(snapshot.transportMetastability).toBeGreaterThan(0.45);
   });
+
+  it("scores a measured TCP path when one is given", () => {
+    const base = {
+      sliceHistory: [],
+      flushHistory: [],
+      backpressureHistory: [],
+    };
+    expect(computeTransportCoherence(base).pathRegularity).toBeUndefined();
+
+    const quiet = computeTransportCoherence({
+      ...base,
+      path: { rttUs: 210, rttVarUs: 20, minRttUs: 200, cwnd: 10, lost: 0 },
+    });
+    const congested = computeTransportCoherence({
+      ...base,
+      path: { rttUs: 4000, rttVarUs: 1800, minRttUs: 200, cwnd: 10, lost: 4 },
+    });
+    expect(quiet.pathRegularity).toBeGreaterThan(0.9);
+    expect(congested.pathRegularity).toBeLessThan(0.4);
+    expect(congested.diagnostics.some(d => d.startsWith("path_regularity:"))).toBe(
+      true,
+    );
+  });
 });
@@ -1,6 +1,11 @@
 import { beforeEach, describe, expect, it, vi } from "vitest";
 
 const execMock = vi.hoisted(() => vi.fn());
+const bindingFactory = vi.hoisted(() => vi.fn());
+
+vi.mock("bindings", () => ({
+  default: bindingFactory,
+}));
 
 vi.mock("node:child_process", () => ({
   exec: execMock,
@@ -18,6 +23,10 @@ describe("wireGuardAdapter", () => {
   beforeEach(async () => {
     execMock.mockReset();
     execMock.mockResolvedValue({ stdout: "", stderr: "" });
+    bindingFactory.mockReset();
+    bindingFactory.mockImplementation(() => {
+      throw new Error("not found");
+    });
     vi.resetModules();
     ({ wireGuardAdapter: adapter } =
       await import("../src/adapters/wireguard-adapter"));
@@ -65,6 +74,15 @@ describe("wireGuardAdapter", () => {
     });
   });
 
+  it("reads exact byte counts from the piped all-interfaces form", async () => {
+    execMock.mockResolvedValueOnce({
+      stdout: "wg0\tpeerA=\t123456789\t42\n",
+    });
+    expect(await adapter.getStats()).toEqual([
+      { interface: "wg0", peer: "peerA=", received: 123456789, sent: 42 },
+    ]);
+  });
+
   it("returns empty stats when wg command fails", async () => {
     execMock.mockRejectedValueOnce(new Error("wg missing"));
     const stats = await adapter.getStats();
@@ -75,4 +93,82 @@ describe("wireGuardAdapter", () => {
     await adapter.teardown();
     expect(execMock).toHaveBeenCalledWith("sudo wg-quick down wg0");
   });
+
+  it("reads peers over netlink and reports changes between polls", async () => {
+    const key = Buffer.alloc(32, 7);
+    const peer = {
+      publicKey: key,
+      endpoint: { address: "203.0.113.5", port: 51820, family: "IPv4" },
+      lastHandshakeMs: 1000,
+      rxBytes: 2 ** 40 + 1,
+      txBytes: 5,
+      persistentKeepaliveSecs: 25,
+      protocolVersion: 1,
+      allowedIps: ["10.0.0.2/32"],
+    };
+    class FakeWireGuard {
+      listDevices() {
+        return ["wg0"];
+      }
+      getDevice(name: string) {
+        return { name, ifindex: 4, listenPort: 51820, fwmark: 0, peers: [{ ...peer }] };
+      }
+      setPeer = vi.fn();
+      close() {}
+    }
+    const wireGuard = new FakeWireGuard();
+    bindingFactory.mockImplementation(
+      (arg: string | { module_root: string; bindings: string }) => {
+        const bindingName = typeof arg === "string" ? arg : arg.bindings;
+        if (bindingName === "qwormhole") {
+          return {
+            TcpClientWrapper: vi.fn(),
+            QWormholeWireGuard: class {
+              constructor() {
+                return wireGuard;
+              }
+            },
+          };
+        }
+        throw new Error("not found");
+      },
+    );
+    vi.resetModules();
+    ({ wireGuardAdapter: adapter } =
+      await import("../src/adapters/wireguard-adapter"));
+
+    expect(await adapter.getStats()).toEqual([
+      {
+        peer: key.toString("base64"),
+        received: 2 ** 40 + 1,
+        sent: 5,
+        interface: "wg0",
+        lastHandshakeMs: 1000,
+        endpoint: "203.0.113.5:51820",
+      },
+    ]);
+    expect(execMock).not.toHaveBeenCalled();
+
+    await adapter.setPeer!("wg0", {
+      publicKey: key.toString("base64"),
+      allowedIps: ["10.0.0.3/32"],
+    });
+    expect(wireGuard.setPeer).toHaveBeenCalledWith("wg0", {
+      publicKey: key,
+      allowedIps: ["10.0.0.3/32"],
+    });
+
+    vi.useFakeTimers();
+    try {
+      const events: string[] = [];
+      const stop = adapter.watch!(event => events.push(event.type), { intervalMs: 100 });
+      peer.lastHandshakeMs = 2000;
+      peer.endpoint = { address: "198.51.100.9", port: 51820, family: "IPv4" };
+      vi.advanceTimersByTime(100);
+      expect(events).toEqual(["handshake", "endpoint"]);
+      stop();
+    } finally {
+      vi.useRealTimers();
+    }
+  });
 });